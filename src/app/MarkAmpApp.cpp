@@ -6,6 +6,7 @@
 #include "core/Config.h"
 #include "core/ContextKeyService.h"
 #include "core/DecorationService.h"
+#include "core/DeferredStartup.h"
 #include "core/DiagnosticsService.h"
 #include "core/EnvironmentService.h"
 #include "core/EventBus.h"
@@ -26,6 +27,7 @@
 #include "core/QuickPickService.h"
 #include "core/RecentWorkspaces.h"
 #include "core/SnippetEngine.h"
+#include "core/StartupTimeline.h"
 #include "core/StatusBarItemService.h"
 #include "core/TaskRunnerService.h"
 #include "core/TerminalService.h"
@@ -53,11 +55,17 @@ bool MarkAmpApp::OnInit()
         return false;
     }
 
+    // Everything up to frame->Show() is the critical path; see StartupTimeline
+    startup_timeline_ = std::make_unique<core::StartupTimeline>();
+
     SetAppName("MarkAmp");
     SetVendorName("MarkAmp");
 
     // 1. Initialize logging
-    core::initLogger();
+    {
+        auto stage = startup_timeline_->measure("logger");
+        core::initLogger();
+    }
     MARKAMP_LOG_INFO("MarkAmp v{}.{}.{} starting...",
                      MARKAMP_VERSION_MAJOR,
                      MARKAMP_VERSION_MINOR,
@@ -68,52 +76,160 @@ bool MarkAmpApp::OnInit()
                      wxPlatformInfo::Get().GetOperatingSystemDescription().ToStdString());
 
     // 2. Create core services
-    event_bus_ = std::make_unique<core::EventBus>();
+    {
+        auto stage = startup_timeline_->measure("event_bus");
+        event_bus_ = std::make_unique<core::EventBus>();
+    }
     MARKAMP_LOG_DEBUG("EventBus initialized");
 
     // 3. Load configuration
-    config_ = std::make_unique<core::Config>();
-    auto loadResult = config_->load();
-    if (!loadResult)
     {
-        MARKAMP_LOG_WARN("Config load failed: {}", loadResult.error());
+        auto stage = startup_timeline_->measure("config");
+        config_ = std::make_unique<core::Config>();
+        auto loadResult = config_->load();
+        if (!loadResult)
+        {
+            MARKAMP_LOG_WARN("Config load failed: {}", loadResult.error());
+        }
+        else
+        {
+            MARKAMP_LOG_INFO("Configuration loaded");
+        }
     }
-    else
+
     {
-        MARKAMP_LOG_INFO("Configuration loaded");
-    }
+        auto stage = startup_timeline_->measure("app_state");
 
-    // 3b. Initialize recent workspaces
-    recent_workspaces_ = std::make_unique<core::RecentWorkspaces>(*config_);
-    MARKAMP_LOG_DEBUG("RecentWorkspaces initialized");
+        // 3b. Initialize recent workspaces
+        recent_workspaces_ = std::make_unique<core::RecentWorkspaces>(*config_);
+        MARKAMP_LOG_DEBUG("RecentWorkspaces initialized");
 
-    // 4. Initialize app state manager
-    state_manager_ = std::make_unique<core::AppStateManager>(*event_bus_);
-    MARKAMP_LOG_DEBUG("AppStateManager initialized");
+        // 4. Initialize app state manager
+        state_manager_ = std::make_unique<core::AppStateManager>(*event_bus_);
+        MARKAMP_LOG_DEBUG("AppStateManager initialized");
 
-    // 5. Initialize command history
-    command_history_ = std::make_unique<core::CommandHistory>();
-    MARKAMP_LOG_DEBUG("CommandHistory initialized");
+        // 5. Initialize command history
+        command_history_ = std::make_unique<core::CommandHistory>();
+        MARKAMP_LOG_DEBUG("CommandHistory initialized");
 
-    // 6. Create platform abstraction
-    platform_ = platform::create_platform();
-    MARKAMP_LOG_DEBUG("Platform abstraction initialized");
+        // 6. Create platform abstraction
+        platform_ = platform::create_platform();
+        MARKAMP_LOG_DEBUG("Platform abstraction initialized");
+    }
 
-    // 7. Initialize theme system
-    theme_registry_ = std::make_unique<core::ThemeRegistry>();
-    auto themeResult = theme_registry_->initialize();
-    if (!themeResult)
+    // 7. Initialize theme system. Built-in themes are enough for the first
+    // frame; the user theme cache is opened by the deferred startup thread.
     {
-        MARKAMP_LOG_WARN("ThemeRegistry init failed: {}", themeResult.error());
+        auto stage = startup_timeline_->measure("themes");
+        theme_registry_ = std::make_unique<core::ThemeRegistry>();
+        theme_registry_->initialize_builtin();
+        theme_engine_ = std::make_unique<core::ThemeEngine>(*event_bus_, *theme_registry_);
     }
-    MARKAMP_LOG_DEBUG("ThemeRegistry initialized with {} themes",
-                      theme_registry_->list_themes().size());
-
-    theme_engine_ = std::make_unique<core::ThemeEngine>(*event_bus_, *theme_registry_);
     MARKAMP_LOG_DEBUG("ThemeEngine initialized with theme: {}",
                       theme_engine_->current_theme().name);
 
-    // 8. Initialize extension API services
+    deferred_startup_ = std::make_unique<core::DeferredStartup>(*startup_timeline_);
+    pending_theme_cache_ = std::make_shared<core::ThemeCache>();
+    deferred_startup_->add("user_themes",
+                           [theme_cache = pending_theme_cache_]()
+                           {
+                               auto opened = core::ThemeRegistry::open_user_theme_cache();
+                               if (!opened)
+                               {
+                                   MARKAMP_LOG_WARN("Could not load user themes: {}",
+                                                    opened.error());
+                                   return;
+                               }
+                               *theme_cache = std::move(*opened);
+                           });
+
+    // 8. Extension API services are only needed once plugins activate, so
+    // they are constructed on the deferred startup thread.
+    deferred_startup_->add("extension_services", [this]() { create_extension_services(); });
+
+    // 9. Initialize plugin system. Registration stays on the critical path:
+    // the UI checks feature flags while it is built. Activation waits for the
+    // extension services (see finish_deferred_startup).
+    {
+        auto stage = startup_timeline_->measure("plugins");
+        feature_registry_ = std::make_unique<core::FeatureRegistry>(*event_bus_, *config_);
+        plugin_manager_ = std::make_unique<core::PluginManager>(*event_bus_, *config_);
+        core::register_builtin_plugins(*plugin_manager_, *feature_registry_);
+    }
+    MARKAMP_LOG_INFO("Plugin system initialized: {} plugins, {} features",
+                     plugin_manager_->plugin_count(),
+                     feature_registry_->feature_count());
+
+    {
+        auto stage = startup_timeline_->measure("renderers");
+
+        // 10. Initialize Mermaid renderer (before MainFrame so it can be injected).
+        // mmdc is looked up on first use by the preview worker, not here.
+        const auto mermaid_cache_dir = core::Config::config_directory() / "cache" / "mermaid";
+        mermaid_renderer_ = std::make_shared<core::MermaidRenderer>(mermaid_cache_dir);
+        MARKAMP_LOG_INFO("MermaidRenderer initialized (cache: {})", mermaid_cache_dir.string());
+
+        // 11. Initialize Math renderer (before MainFrame so it can be injected)
+        math_renderer_ = std::make_shared<core::MathRenderer>();
+        MARKAMP_LOG_INFO("MathRenderer initialized (available: {})",
+                         math_renderer_->is_available() ? "yes" : "no");
+    }
+
+    // 12. Create and show the main frame (with frameless custom chrome)
+    {
+        auto stage = startup_timeline_->measure("main_frame");
+        auto* frame = new ui::MainFrame("MarkAmp",
+                                        wxDefaultPosition,
+                                        wxSize(kDefaultWidth, kDefaultHeight),
+                                        event_bus_.get(),
+                                        config_.get(),
+                                        recent_workspaces_.get(),
+                                        platform_.get(),
+                                        theme_engine_.get(),
+                                        feature_registry_.get(),
+                                        mermaid_renderer_.get(),
+                                        math_renderer_.get());
+
+        frame->Show(true);
+        SetTopWindow(frame);
+    }
+
+    // 12. Publish app ready event
+    core::events::AppReadyEvent readyEvent;
+    event_bus_->publish(readyEvent);
+
+    // 13. Bind idle handler to drain queued and fast-path EventBus events.
+    // The first idle event also marks first paint and starts deferred startup.
+    Bind(wxEVT_IDLE, &MarkAmpApp::OnIdle, this);
+    MARKAMP_LOG_INFO("MarkAmp critical startup complete ({:.1f} ms)",
+                     startup_timeline_->critical_path_ms());
+
+    return true;
+}
+
+void MarkAmpApp::OnIdle(wxIdleEvent& event)
+{
+    if (deferred_startup_ && !deferred_startup_->started())
+    {
+        // The first idle event follows the initial paint of the shown frame
+        startup_timeline_->mark_first_paint();
+        deferred_startup_->start(
+            [this]()
+            {
+                CallAfter([this]() { finish_deferred_startup(); });
+            });
+    }
+
+    if (event_bus_)
+    {
+        event_bus_->process_queued();
+        event_bus_->drain_fast_queue();
+    }
+    event.Skip();
+}
+
+void MarkAmpApp::create_extension_services()
+{
     context_key_service_ = std::make_unique<core::ContextKeyService>();
     output_channel_service_ = std::make_unique<core::OutputChannelService>();
     diagnostics_service_ = std::make_unique<core::DiagnosticsService>();
@@ -136,95 +252,79 @@ bool MarkAmpApp::OnInit()
     terminal_service_ = std::make_unique<core::TerminalService>();
     task_runner_service_ = std::make_unique<core::TaskRunnerService>();
     MARKAMP_LOG_INFO("Extension API services initialized (21 services)");
+}
 
-    // 9. Initialize plugin system
-    feature_registry_ = std::make_unique<core::FeatureRegistry>(*event_bus_, *config_);
-    plugin_manager_ = std::make_unique<core::PluginManager>(*event_bus_, *config_);
-
-    // Wire extension services into PluginManager
-    core::PluginManager::ExtensionServices ext_services{};
-    ext_services.context_key_service = context_key_service_.get();
-    ext_services.output_channel_service = output_channel_service_.get();
-    ext_services.diagnostics_service = diagnostics_service_.get();
-    ext_services.decoration_service = decoration_service_.get();
-    ext_services.webview_service = webview_service_.get();
-    ext_services.file_system_provider_registry = file_system_provider_registry_.get();
-    ext_services.language_provider_registry = language_provider_registry_.get();
-    ext_services.tree_data_provider_registry = tree_data_provider_registry_.get();
-    ext_services.snippet_engine = snippet_engine_.get();
-    ext_services.workspace_service = workspace_service_.get();
-    ext_services.text_editor_service = text_editor_service_.get();
-    ext_services.progress_service = progress_service_.get();
-    ext_services.extension_event_bus = extension_event_bus_.get();
-    ext_services.environment_service = environment_service_.get();
-    ext_services.notification_service = notification_service_.get();
-    ext_services.status_bar_item_service = status_bar_item_service_.get();
-    ext_services.input_box_service = input_box_service_.get();
-    ext_services.quick_pick_service = quick_pick_service_.get();
-    ext_services.grammar_engine = grammar_engine_.get();
-    ext_services.terminal_service = terminal_service_.get();
-    ext_services.task_runner_service = task_runner_service_.get();
-    plugin_manager_->set_extension_services(ext_services);
-    plugin_manager_->set_status_bar_service(status_bar_item_service_.get());
-    plugin_manager_->set_tree_registry(tree_data_provider_registry_.get());
-
-    core::register_builtin_plugins(*plugin_manager_, *feature_registry_);
-    plugin_manager_->activate_all();
-    MARKAMP_LOG_INFO("Plugin system initialized: {} plugins, {} features",
-                     plugin_manager_->plugin_count(),
-                     feature_registry_->feature_count());
-
-    // 10. Initialize Mermaid renderer (before MainFrame so it can be injected)
-    mermaid_renderer_ = std::make_shared<core::MermaidRenderer>();
-    MARKAMP_LOG_INFO("MermaidRenderer initialized (available: {})",
-                     mermaid_renderer_->is_available() ? "yes" : "no");
-
-    // 11. Initialize Math renderer (before MainFrame so it can be injected)
-    math_renderer_ = std::make_shared<core::MathRenderer>();
-    MARKAMP_LOG_INFO("MathRenderer initialized (available: {})",
-                     math_renderer_->is_available() ? "yes" : "no");
-
-    // 12. Create and show the main frame (with frameless custom chrome)
-    auto* frame = new ui::MainFrame("MarkAmp",
-                                    wxDefaultPosition,
-                                    wxSize(kDefaultWidth, kDefaultHeight),
-                                    event_bus_.get(),
-                                    config_.get(),
-                                    recent_workspaces_.get(),
-                                    platform_.get(),
-                                    theme_engine_.get(),
-                                    feature_registry_.get(),
-                                    mermaid_renderer_.get(),
-                                    math_renderer_.get());
-
-    frame->Show(true);
-    SetTopWindow(frame);
-
-    // 12. Publish app ready event
-    core::events::AppReadyEvent readyEvent;
-    event_bus_->publish(readyEvent);
+void MarkAmpApp::finish_deferred_startup()
+{
+    if (!deferred_startup_ || !plugin_manager_)
+    {
+        return; // Shutting down
+    }
+    deferred_startup_->wait();
 
-    // 13. Bind idle handler to drain queued and fast-path EventBus events
-    Bind(wxEVT_IDLE, &MarkAmpApp::OnIdle, this);
+    {
+        auto stage = startup_timeline_->measure("activate_plugins", core::StartupPhase::Deferred);
+        theme_registry_->add_cached_themes(std::move(pending_theme_cache_));
+
+        // Wire extension services into PluginManager
+        core::PluginManager::ExtensionServices ext_services{};
+        ext_services.context_key_service = context_key_service_.get();
+        ext_services.output_channel_service = output_channel_service_.get();
+        ext_services.diagnostics_service = diagnostics_service_.get();
+        ext_services.decoration_service = decoration_service_.get();
+        ext_services.webview_service = webview_service_.get();
+        ext_services.file_system_provider_registry = file_system_provider_registry_.get();
+        ext_services.language_provider_registry = language_provider_registry_.get();
+        ext_services.tree_data_provider_registry = tree_data_provider_registry_.get();
+        ext_services.snippet_engine = snippet_engine_.get();
+        ext_services.workspace_service = workspace_service_.get();
+        ext_services.text_editor_service = text_editor_service_.get();
+        ext_services.progress_service = progress_service_.get();
+        ext_services.extension_event_bus = extension_event_bus_.get();
+        ext_services.environment_service = environment_service_.get();
+        ext_services.notification_service = notification_service_.get();
+        ext_services.status_bar_item_service = status_bar_item_service_.get();
+        ext_services.input_box_service = input_box_service_.get();
+        ext_services.quick_pick_service = quick_pick_service_.get();
+        ext_services.grammar_engine = grammar_engine_.get();
+        ext_services.terminal_service = terminal_service_.get();
+        ext_services.task_runner_service = task_runner_service_.get();
+        plugin_manager_->set_extension_services(ext_services);
+        plugin_manager_->set_status_bar_service(status_bar_item_service_.get());
+        plugin_manager_->set_tree_registry(tree_data_provider_registry_.get());
+        plugin_manager_->activate_all();
+
+        // Extension grammars are loaded now; let the editor colour their fences
+        // and show the decorations extensions set on the open file
+        if (auto* frame = dynamic_cast<ui::MainFrame*>(GetTopWindow()); frame != nullptr)
+        {
+            frame->SetGrammarEngine(grammar_engine_.get());
+            frame->SetDecorationService(decoration_service_.get());
+        }
+    }
+    MARKAMP_LOG_INFO("ThemeRegistry: {} themes loaded", theme_registry_->theme_count());
     MARKAMP_LOG_INFO("MarkAmp initialization complete");
 
-    return true;
-}
-
-void MarkAmpApp::OnIdle(wxIdleEvent& event)
-{
-    if (event_bus_)
+    MARKAMP_LOG_INFO("{}", startup_timeline_->report());
+    if (startup_timeline_->critical_path_ms() > core::StartupTimeline::kCriticalPathBudgetMs)
     {
-        event_bus_->process_queued();
-        event_bus_->drain_fast_queue();
+        MARKAMP_LOG_WARN("Critical startup path took {:.1f} ms, over the {:.0f} ms budget",
+                         startup_timeline_->critical_path_ms(),
+                         core::StartupTimeline::kCriticalPathBudgetMs);
     }
-    event.Skip();
 }
 
 int MarkAmpApp::OnExit()
 {
     MARKAMP_LOG_INFO("MarkAmp shutting down...");
 
+    // Let background startup work finish before tearing anything down
+    if (deferred_startup_)
+    {
+        deferred_startup_->wait();
+        deferred_startup_.reset();
+    }
+
     // Publish shutdown event
     if (event_bus_)
     {
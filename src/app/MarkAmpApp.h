@@ -20,6 +20,9 @@ class ThemeRegistry;
 class ThemeEngine;
 class PluginManager;
 class FeatureRegistry;
+class StartupTimeline;
+class DeferredStartup;
+class ThemeCache;
 
 // Extension API services (P1–P4)
 class ContextKeyService;
@@ -72,6 +75,18 @@ public:
     static constexpr int kMinHeight = 600;
 
 private:
+    /// Construct the extension API services (deferred startup thread).
+    void create_extension_services();
+
+    /// Register user themes, wire the extension services and activate
+    /// plugins once the deferred startup tasks are done (UI thread).
+    void finish_deferred_startup();
+
+    // Startup staging: timeline of every stage and work deferred past first paint
+    std::unique_ptr<core::StartupTimeline> startup_timeline_;
+    std::unique_ptr<core::DeferredStartup> deferred_startup_;
+    std::shared_ptr<core::ThemeCache> pending_theme_cache_;
+
     // Core services (owned by the app, lifetime-managed)
     std::unique_ptr<core::EventBus> event_bus_;
     std::unique_ptr<core::Config> config_;
@@ -67,7 +67,9 @@ void AppStateManager::update_content(const std::string& content)
 {
     state_.active_file_content = content;
     events::EditorContentChangedEvent evt;
-    evt.content = content;
+    evt.version = ++content_version_;
+    evt.full_replace = true;
+    evt.snapshot = LazyDocumentSnapshot::from_content(evt.version, content);
     event_bus_.publish_fast(evt);
 }
 
@@ -4,6 +4,7 @@
 #include "Events.h"
 #include "Types.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -51,6 +52,7 @@ public:
 private:
     AppState state_;
     EventBus& event_bus_;
+    uint64_t content_version_{0};
 };
 
 } // namespace markamp::core
@@ -1,10 +1,170 @@
 #include "AsyncHighlighter.h"
 
+#include "GrammarEngine.h"
+
+#include <array>
 #include <chrono>
+#include <optional>
 
 namespace markamp::core
 {
 
+namespace
+{
+
+constexpr std::size_t kMaxFenceIndent = 3;
+constexpr std::size_t kMinFenceLength = 3;
+constexpr uint32_t kOutsideFence = 0;
+
+/// An open ``` / ~~~ code fence while lexing Markdown.
+struct OpenFence
+{
+    char marker{'`'};
+    std::size_t length{0};
+    std::string language; // First word of the info string
+    uint32_t state{0};    // State recorded for lines inside this block
+};
+
+/// Offset of the first non-space byte, or npos if indented too far.
+auto fence_indent(std::string_view line) -> std::size_t
+{
+    std::size_t pos = 0;
+    while (pos < line.size() && line[pos] == ' ')
+    {
+        ++pos;
+    }
+    return pos <= kMaxFenceIndent ? pos : std::string_view::npos;
+}
+
+/// Length of the run of `marker` starting at `pos`.
+auto marker_run(std::string_view line, std::size_t pos, char marker) -> std::size_t
+{
+    auto end = line.find_first_not_of(marker, pos);
+    if (end == std::string_view::npos)
+    {
+        end = line.size();
+    }
+    return end - pos;
+}
+
+/// FNV-1a over the fence's identity; never kOutsideFence or all-ones.
+auto fence_state(const OpenFence& fence) -> uint32_t
+{
+    uint32_t hash = 2166136261U;
+    auto mix = [&hash](unsigned char byte)
+    {
+        hash ^= byte;
+        hash *= 16777619U;
+    };
+    mix(static_cast<unsigned char>(fence.marker));
+    mix(static_cast<unsigned char>(std::min<std::size_t>(fence.length, 255)));
+    for (const char ch : fence.language)
+    {
+        mix(static_cast<unsigned char>(ch));
+    }
+    return (hash & 0x7FFFFFFEU) | 1U;
+}
+
+auto parse_open_fence(std::string_view line) -> std::optional<OpenFence>
+{
+    const auto pos = fence_indent(line);
+    if (pos == std::string_view::npos || pos >= line.size())
+    {
+        return std::nullopt;
+    }
+    const char marker = line[pos];
+    if (marker != '`' && marker != '~')
+    {
+        return std::nullopt;
+    }
+    const auto length = marker_run(line, pos, marker);
+    if (length < kMinFenceLength)
+    {
+        return std::nullopt;
+    }
+
+    auto info = line.substr(pos + length);
+    if (marker == '`' && info.find('`') != std::string_view::npos)
+    {
+        return std::nullopt; // Inline code span, not a fence (CommonMark)
+    }
+
+    OpenFence fence;
+    fence.marker = marker;
+    fence.length = length;
+    const auto lang_start = info.find_first_not_of(" \t");
+    if (lang_start != std::string_view::npos)
+    {
+        info.remove_prefix(lang_start);
+        fence.language = std::string(info.substr(0, info.find_first_of(" \t\r{")));
+    }
+    fence.state = fence_state(fence);
+    return fence;
+}
+
+auto is_closing_fence(std::string_view line, const OpenFence& fence) -> bool
+{
+    const auto pos = fence_indent(line);
+    if (pos == std::string_view::npos || pos >= line.size())
+    {
+        return false;
+    }
+    const auto length = marker_run(line, pos, fence.marker);
+    if (length < fence.length)
+    {
+        return false;
+    }
+    return line.find_first_not_of(" \t\r", pos + length) == std::string_view::npos;
+}
+
+/// Closest TokenType for a TextMate scope. Prefixes match whole scope
+/// segments; more specific ones come first.
+auto token_type_for_scope(std::string_view scope) -> TokenType
+{
+    struct ScopePrefix
+    {
+        std::string_view prefix;
+        TokenType type;
+    };
+    static constexpr std::array kPrefixes{
+        ScopePrefix{"comment", TokenType::Comment},
+        ScopePrefix{"punctuation.definition.comment", TokenType::Comment},
+        ScopePrefix{"string", TokenType::String},
+        ScopePrefix{"punctuation.definition.string", TokenType::String},
+        ScopePrefix{"constant.numeric", TokenType::Number},
+        ScopePrefix{"constant", TokenType::Constant},
+        ScopePrefix{"keyword.operator", TokenType::Operator},
+        ScopePrefix{"keyword.control.directive", TokenType::Preprocessor},
+        ScopePrefix{"meta.preprocessor", TokenType::Preprocessor},
+        ScopePrefix{"keyword", TokenType::Keyword},
+        ScopePrefix{"storage.type", TokenType::Type},
+        ScopePrefix{"storage", TokenType::Keyword},
+        ScopePrefix{"entity.name.function", TokenType::Function},
+        ScopePrefix{"support.function", TokenType::Function},
+        ScopePrefix{"entity.name.tag", TokenType::Tag},
+        ScopePrefix{"entity.other.attribute-name", TokenType::Attribute},
+        ScopePrefix{"entity.name", TokenType::Type},
+        ScopePrefix{"support.type.property-name", TokenType::Property},
+        ScopePrefix{"variable.other.property", TokenType::Property},
+        ScopePrefix{"variable.other.member", TokenType::Property},
+        ScopePrefix{"support.type", TokenType::Type},
+        ScopePrefix{"support.class", TokenType::Type},
+        ScopePrefix{"variable", TokenType::Variable},
+        ScopePrefix{"punctuation", TokenType::Punctuation},
+    };
+    for (const auto& [prefix, type] : kPrefixes)
+    {
+        if (scope.starts_with(prefix) &&
+            (scope.size() == prefix.size() || scope[prefix.size()] == '.'))
+        {
+            return type;
+        }
+    }
+    return TokenType::Text;
+}
+
+} // namespace
+
 AsyncHighlighter::AsyncHighlighter(ResultCallback on_result)
     : on_result_(std::move(on_result))
     , worker_([this]() { worker_loop(); })
@@ -26,6 +186,8 @@ void AsyncHighlighter::set_content(const std::string& content, const std::string
 
     {
         std::lock_guard lock(content_mutex_);
+        markdown_mode_ = false;
+        markdown_content_.reset();
         content_ = content;
         language_ = language;
         line_states_.clear();
@@ -60,6 +222,65 @@ void AsyncHighlighter::notify_edit(std::size_t start_line, std::size_t /* end_li
     (void)start_line;
 }
 
+auto AsyncHighlighter::set_markdown(std::shared_ptr<const std::string> content) -> uint64_t
+{
+    if (!running_.load(std::memory_order_acquire))
+    {
+        return version();
+    }
+
+    uint64_t ver = 0;
+    {
+        std::lock_guard lock(content_mutex_);
+        markdown_mode_ = true;
+        markdown_content_ = std::move(content);
+        full_relex_ = true;
+        has_pending_edit_ = false;
+        ver = version_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        markdown_version_ = ver;
+        (void)coalescing_.submit(ver);
+    }
+    wake_worker();
+    return ver;
+}
+
+auto AsyncHighlighter::update_markdown(std::shared_ptr<const std::string> content, LineEdit edit)
+    -> uint64_t
+{
+    if (!running_.load(std::memory_order_acquire))
+    {
+        return version();
+    }
+
+    uint64_t ver = 0;
+    {
+        std::lock_guard lock(content_mutex_);
+        if (!markdown_mode_)
+        {
+            markdown_mode_ = true;
+            full_relex_ = true;
+        }
+        markdown_content_ = std::move(content);
+        if (!full_relex_)
+        {
+            // Edits the worker has not picked up yet are folded together
+            pending_edit_ = has_pending_edit_ ? pending_edit_.merged_with(edit) : edit;
+            has_pending_edit_ = true;
+        }
+        ver = version_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        markdown_version_ = ver;
+        (void)coalescing_.submit(ver);
+    }
+    wake_worker();
+    return ver;
+}
+
+void AsyncHighlighter::set_grammar_engine(const GrammarEngine* grammars)
+{
+    std::lock_guard lock(content_mutex_);
+    grammars_ = grammars;
+}
+
 auto AsyncHighlighter::version() const noexcept -> uint64_t
 {
     return version_.load(std::memory_order_acquire);
@@ -102,6 +323,17 @@ void AsyncHighlighter::worker_loop()
             break;
         }
 
+        bool markdown = false;
+        {
+            std::lock_guard lock(content_mutex_);
+            markdown = markdown_mode_;
+        }
+        if (markdown)
+        {
+            tokenize_markdown();
+            continue;
+        }
+
         auto ver = coalescing_.current_version();
         auto task_cancel = coalescing_.submit(ver);
 
@@ -173,6 +405,262 @@ void AsyncHighlighter::tokenize_range(std::size_t start_line, uint64_t ver, Canc
     }
 }
 
+void AsyncHighlighter::tokenize_markdown()
+{
+    std::shared_ptr<const std::string> content;
+    LineEdit edit;
+    bool full = false;
+    uint64_t ver = 0;
+    {
+        std::lock_guard lock(content_mutex_);
+        if (!markdown_content_ || (!has_pending_edit_ && !full_relex_))
+        {
+            return;
+        }
+        content = markdown_content_;
+        ver = markdown_version_;
+        edit = pending_edit_;
+        full = full_relex_;
+        has_pending_edit_ = false;
+        full_relex_ = false;
+        pass_grammars_ = grammars_;
+    }
+
+    const auto lines = split_lines(*content);
+
+    if (!full)
+    {
+        // Replace the edited lines' states with unknowns; an edit that does
+        // not fit the previously lexed text falls back to a full pass
+        const auto old_end = static_cast<std::ptrdiff_t>(edit.end_line) - edit.line_delta;
+        full = edit.end_line < edit.first_line || edit.end_line > lines.size() ||
+               old_end < static_cast<std::ptrdiff_t>(edit.first_line) ||
+               old_end > static_cast<std::ptrdiff_t>(fence_states_.size());
+        if (!full)
+        {
+            const auto first = static_cast<std::ptrdiff_t>(edit.first_line);
+            fence_states_.erase(fence_states_.begin() + first, fence_states_.begin() + old_end);
+            fence_states_.insert(
+                fence_states_.begin() + first, edit.end_line - edit.first_line, kUnknownState);
+            full = fence_states_.size() != lines.size();
+        }
+    }
+    if (full)
+    {
+        fence_states_.assign(lines.size(), kUnknownState);
+        edit = LineEdit{0, lines.size(), 0};
+    }
+
+    // Resume from a line that starts outside any fence
+    auto start = edit.first_line;
+    while (start > 0 && fence_states_[start - 1] != kOutsideFence)
+    {
+        --start;
+    }
+
+    HighlightResult result;
+    result.version = ver;
+    result.start_line = start;
+
+    std::optional<OpenFence> fence;
+    std::size_t block_first = 0; // First code line of the open block
+    std::size_t line = start;
+    bool superseded = false;
+    for (; line < lines.size(); ++line)
+    {
+        if (line > start && (line - start) % kCancelCheckLines == 0 &&
+            markdown_pass_superseded(ver))
+        {
+            superseded = true;
+            break;
+        }
+
+        auto kind = HighlightLineKind::Markdown;
+        if (!fence)
+        {
+            fence = parse_open_fence(lines[line]);
+            if (fence)
+            {
+                kind = HighlightLineKind::FenceMarker;
+                block_first = line + 1;
+            }
+        }
+        else if (is_closing_fence(lines[line], *fence))
+        {
+            kind = HighlightLineKind::FenceMarker;
+            tokenize_block(lines, block_first, line, fence->language, result);
+            fence.reset();
+        }
+        else
+        {
+            kind = HighlightLineKind::Code;
+        }
+        result.line_kinds.push_back(kind);
+        result.tokens.emplace_back();
+
+        // Convergence: past the edit, outside any fence, same as last time
+        const uint32_t state = fence ? fence->state : kOutsideFence;
+        const uint32_t previous = fence_states_[line];
+        fence_states_[line] = state;
+        if (line >= edit.end_line && state == kOutsideFence && previous == kOutsideFence)
+        {
+            ++line;
+            break;
+        }
+    }
+
+    if (superseded)
+    {
+        // Publish whole blocks only; the open block and everything not yet
+        // lexed are folded into the next pass
+        const auto covered = fence ? block_first - 1 : line;
+        result.line_kinds.resize(covered - start);
+        result.tokens.resize(covered - start);
+        result.end_line = covered;
+        requeue_lines(covered, std::max(line, edit.end_line));
+    }
+    else
+    {
+        if (fence)
+        {
+            // Unterminated fence: the block runs to the end of the document
+            tokenize_block(lines, block_first, lines.size(), fence->language, result);
+        }
+        result.end_line = line;
+    }
+
+    if (on_result_ && result.end_line > result.start_line)
+    {
+        on_result_(std::move(result));
+    }
+}
+
+void AsyncHighlighter::tokenize_block(const std::vector<std::string_view>& lines,
+                                      std::size_t first,
+                                      std::size_t last,
+                                      const std::string& language,
+                                      HighlightResult& result)
+{
+    if (first >= last || language.empty())
+    {
+        return;
+    }
+    if (!highlighter_.is_supported(language))
+    {
+        tokenize_grammar_block(lines, first, last, language, result);
+        return;
+    }
+
+    // Lines are views into one buffer, so the block is a single contiguous view
+    const char* block_begin = lines[first].data();
+    const auto& tail = lines[last - 1];
+    const std::string_view block(block_begin,
+                                 static_cast<std::size_t>(tail.data() + tail.size() - block_begin));
+    auto offset_of = [&](std::size_t line_index)
+    { return static_cast<std::size_t>(lines[line_index].data() - block_begin); };
+
+    highlighter_.tokenize_soa(block, language, block_tokens_);
+    std::size_t line = first;
+    for (std::size_t index = 0; index < block_tokens_.size(); ++index)
+    {
+        const auto type = block_tokens_.types[index];
+        if (type == TokenType::Text || type == TokenType::Whitespace)
+        {
+            continue;
+        }
+        const auto token_start = block_tokens_.starts[index];
+        const auto token_end = token_start + block_tokens_.lengths[index];
+        while (line + 1 < last && token_start >= offset_of(line + 1))
+        {
+            ++line;
+        }
+
+        // Multi-line tokens (block comments, raw strings) are split per line
+        for (auto piece_line = line; piece_line < last; ++piece_line)
+        {
+            const auto line_begin = offset_of(piece_line);
+            if (line_begin >= token_end)
+            {
+                break;
+            }
+            const auto piece_start = std::max(token_start, line_begin);
+            const auto piece_end = std::min(token_end, line_begin + lines[piece_line].size());
+            if (piece_end > piece_start)
+            {
+                result.tokens[piece_line - result.start_line].push_back(
+                    Token{type, {}, piece_start - line_begin, piece_end - piece_start});
+            }
+        }
+    }
+}
+
+void AsyncHighlighter::tokenize_grammar_block(const std::vector<std::string_view>& lines,
+                                              std::size_t first,
+                                              std::size_t last,
+                                              const std::string& language,
+                                              HighlightResult& result)
+{
+    if (pass_grammars_ == nullptr)
+    {
+        return;
+    }
+    const auto scope = pass_grammars_->scope_for_language(language);
+    if (scope.empty())
+    {
+        return;
+    }
+
+    // The rule stack carries multi-line constructs from one line to the next
+    GrammarState state;
+    for (auto line = first; line < last; ++line)
+    {
+        auto line_result = pass_grammars_->tokenize_line(scope, lines[line], state);
+        auto& line_tokens = result.tokens[line - result.start_line];
+        for (const auto& token : line_result.tokens)
+        {
+            const auto type = token_type_for_scope(token.scope);
+            if (type == TokenType::Text || token.end_index <= token.start_index)
+            {
+                continue;
+            }
+            const auto start = static_cast<std::size_t>(token.start_index);
+            const auto length = static_cast<std::size_t>(token.end_index - token.start_index);
+            line_tokens.push_back(Token{type, {}, start, length});
+        }
+        state = std::move(line_result.end_state);
+    }
+}
+
+auto AsyncHighlighter::markdown_pass_superseded(uint64_t ver) const noexcept -> bool
+{
+    return !running_.load(std::memory_order_acquire) || !coalescing_.is_current(ver);
+}
+
+void AsyncHighlighter::requeue_lines(std::size_t first, std::size_t end)
+{
+    {
+        std::lock_guard lock(content_mutex_);
+        if (full_relex_ || !markdown_mode_)
+        {
+            return;
+        }
+        // Newer pending edits are relative to the text this pass lexed
+        const LineEdit remainder{first, end, 0};
+        pending_edit_ = has_pending_edit_ ? remainder.merged_with(pending_edit_) : remainder;
+        has_pending_edit_ = true;
+    }
+    wake_worker();
+}
+
+void AsyncHighlighter::wake_worker()
+{
+    {
+        std::lock_guard lock(work_mutex_);
+        has_work_.store(true, std::memory_order_release);
+    }
+    work_cv_.notify_one();
+}
+
 auto AsyncHighlighter::split_lines(const std::string& content) -> std::vector<std::string_view>
 {
     std::vector<std::string_view> lines;
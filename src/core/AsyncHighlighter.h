@@ -3,18 +3,24 @@
 #include "CoalescingTask.h"
 #include "SyntaxHighlighter.h"
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
 namespace markamp::core
 {
 
+class GrammarEngine;
+
 /// Per-line lexer state for incremental re-tokenization.
 /// When a line's end-state matches the previously stored state,
 /// re-lexing can stop (convergence).
@@ -24,6 +30,14 @@ struct LineState
     uint64_t version{0};    // document version when this line was last tokenized
 };
 
+/// Role of a line in Markdown mode (see AsyncHighlighter::set_markdown).
+enum class HighlightLineKind : uint8_t
+{
+    Markdown,    // Prose; not tokenized
+    FenceMarker, // Opening or closing ``` / ~~~ line
+    Code         // Inside a fenced code block
+};
+
 /// Result of an async highlighting pass.
 struct HighlightResult
 {
@@ -31,6 +45,52 @@ struct HighlightResult
     std::size_t start_line{0};              // first line re-tokenized
     std::size_t end_line{0};                // last line re-tokenized (exclusive)
     std::vector<std::vector<Token>> tokens; // tokens per line for the affected range
+    // Markdown mode only: one entry per line in [start_line, end_line). Token
+    // starts are relative to their line, `text` is left empty, and Text /
+    // Whitespace tokens are omitted.
+    std::vector<HighlightLineKind> line_kinds;
+};
+
+/// Lines [first_line, end_line) of the new text replace the corresponding
+/// old lines; the document gained `line_delta` lines overall. Over-wide
+/// ranges are fine (more lines are re-lexed); the delta must be exact.
+struct LineEdit
+{
+    std::size_t first_line{0};
+    std::size_t end_line{0};
+    std::ptrdiff_t line_delta{0};
+
+    /// First old line past the replaced range.
+    [[nodiscard]] auto old_end_line() const noexcept -> std::size_t
+    {
+        return static_cast<std::size_t>(static_cast<std::ptrdiff_t>(end_line) - line_delta);
+    }
+
+    /// Where old line boundary `line` sits after this edit (boundaries
+    /// inside the replaced range move to its end).
+    [[nodiscard]] auto map_boundary(std::size_t line) const noexcept -> std::size_t
+    {
+        if (line <= first_line)
+        {
+            return line;
+        }
+        if (line >= old_end_line())
+        {
+            return static_cast<std::size_t>(static_cast<std::ptrdiff_t>(line) + line_delta);
+        }
+        return end_line;
+    }
+
+    /// Combine with a later edit expressed in post-`*this` coordinates.
+    [[nodiscard]] auto merged_with(const LineEdit& later) const noexcept -> LineEdit
+    {
+        LineEdit merged;
+        merged.first_line = std::min(first_line, later.first_line);
+        merged.end_line =
+            std::max({later.map_boundary(end_line), later.end_line, merged.first_line});
+        merged.line_delta = line_delta + later.line_delta;
+        return merged;
+    }
 };
 
 /// Background incremental syntax highlighter.
@@ -43,6 +103,19 @@ struct HighlightResult
 /// HighlightResult. The UI thread can then apply the tokens if the
 /// version still matches the current document.
 ///
+/// In Markdown mode (set_markdown / update_markdown) only the contents of
+/// fenced code blocks are tokenized, each in its fence's language. The
+/// worker keeps the fence state at the end of every line; after an edit it
+/// re-lexes from the start of the enclosing block and stops at the first
+/// line past the edit whose end state is unchanged and outside any fence,
+/// so results cover only the lines whose highlighting can have changed.
+/// Fences in a language the built-in lexers do not know are tokenized with
+/// the TextMate grammar an extension contributed for it, if any (see
+/// set_grammar_engine()).
+/// Every pass publishes what it lexed, even if superseded or cancelled
+/// part-way, tagged with the version of the text it read; the unfinished
+/// remainder is folded into the next pass.
+///
 /// Patterns implemented:
 ///   #5  Asynchronous syntax highlighting with incremental tokenization
 ///   #8  Work coalescing and cancellation (latest-wins)
@@ -62,12 +135,29 @@ public:
     auto operator=(AsyncHighlighter&&) -> AsyncHighlighter& = delete;
 
     /// Set the full document content and language. Triggers a full re-lex.
+    /// Leaves Markdown mode.
     void set_content(const std::string& content, const std::string& language);
 
     /// Notify the highlighter that lines [start_line, end_line) were edited.
     /// Triggers an incremental re-lex from start_line.
     void notify_edit(std::size_t start_line, std::size_t end_line);
 
+    /// Switch to Markdown mode with new content: fenced code blocks are
+    /// tokenized in their info-string language. Triggers a full re-lex.
+    /// Returns the version results for `content` will carry.
+    auto set_markdown(std::shared_ptr<const std::string> content) -> uint64_t;
+
+    /// Markdown mode: replace the content after `edit` and re-lex only until
+    /// the fence state converges. Pending edits are merged if the worker
+    /// has not picked them up yet.
+    /// Returns the version results for `content` will carry.
+    auto update_markdown(std::shared_ptr<const std::string> content, LineEdit edit) -> uint64_t;
+
+    /// Tokenize fences in languages without a built-in lexer with the
+    /// grammars `grammars` maps them to (nullptr: leave them plain). Takes
+    /// effect from the next pass; `grammars` must outlive this object.
+    void set_grammar_engine(const GrammarEngine* grammars);
+
     /// Get the current document version.
     [[nodiscard]] auto version() const noexcept -> uint64_t;
 
@@ -84,19 +174,64 @@ private:
     std::vector<LineState> line_states_;
     mutable std::mutex content_mutex_;
 
-    std::thread worker_;
+    // Markdown mode (GUARDED_BY(content_mutex_))
+    bool markdown_mode_{false};
+    std::shared_ptr<const std::string> markdown_content_;
+    uint64_t markdown_version_{0};
+    LineEdit pending_edit_;
+    bool has_pending_edit_{false};
+    bool full_relex_{false};
+    const GrammarEngine* grammars_{nullptr};
+
+    // Worker thread: fence state at the end of each line of the last content
+    // lexed in Markdown mode (0 = outside any fence)
+    std::vector<uint32_t> fence_states_;
+    TokenArraySoA block_tokens_; // Reused by tokenize_block()
+    const GrammarEngine* pass_grammars_{nullptr}; // grammars_ when the pass started
+    static constexpr uint32_t kUnknownState = 0xFFFFFFFFU;
+    static constexpr std::size_t kCancelCheckLines = 256;
+
     std::mutex work_mutex_;
     std::condition_variable work_cv_;
     std::atomic<uint64_t> version_{0};
     std::atomic<bool> has_work_{false};
     std::atomic<bool> running_{true};
 
+    // Declared last: the worker starts after everything above is constructed
+    std::thread worker_;
+
     /// Background worker entry point.
     void worker_loop();
 
     /// Perform incremental tokenization from start_line.
     void tokenize_range(std::size_t start_line, uint64_t ver, CancelToken cancel);
 
+    /// Markdown mode: re-lex the pending edit until convergence.
+    void tokenize_markdown();
+
+    /// Markdown mode: whether the running pass should stop early.
+    [[nodiscard]] auto markdown_pass_superseded(uint64_t ver) const noexcept -> bool;
+
+    /// Tokenize lines [first, last) of one fenced block into `result`.
+    void tokenize_block(const std::vector<std::string_view>& lines,
+                        std::size_t first,
+                        std::size_t last,
+                        const std::string& language,
+                        HighlightResult& result);
+
+    /// Tokenize lines [first, last) of one fenced block with the grammar
+    /// contributed for `language`, if there is one.
+    void tokenize_grammar_block(const std::vector<std::string_view>& lines,
+                                std::size_t first,
+                                std::size_t last,
+                                const std::string& language,
+                                HighlightResult& result);
+
+    /// Queue lines [first, end) of the last lexed text for another pass.
+    void requeue_lines(std::size_t first, std::size_t end);
+
+    void wake_worker();
+
     /// Split content into lines.
     [[nodiscard]] static auto split_lines(const std::string& content)
         -> std::vector<std::string_view>;
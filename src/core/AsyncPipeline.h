@@ -35,9 +35,13 @@ class AsyncPipeline
 {
 public:
     using Processor = std::function<std::optional<Output>(const Input&, CancelToken)>;
+    using ResultNotifier = std::function<void()>;
 
-    explicit AsyncPipeline(Processor processor)
+    /// @param on_result  Optional hook invoked on the worker thread after a
+    ///                   result was queued, e.g. to wake the UI thread.
+    explicit AsyncPipeline(Processor processor, ResultNotifier on_result = {})
         : processor_(std::move(processor))
+        , on_result_(std::move(on_result))
         , stop_requested_(false)
         , worker_([this] { worker_loop(); })
     {
@@ -127,13 +131,18 @@ private:
                 auto result = processor_(input, cancel);
                 if (result.has_value() && coalescer_.is_current(version))
                 {
-                    [[maybe_unused]] auto pushed = results_.try_push(std::move(result.value()));
+                    auto pushed = results_.try_push(std::move(result.value()));
+                    if (pushed && on_result_)
+                    {
+                        on_result_();
+                    }
                 }
             }
         }
     }
 
     Processor processor_;
+    ResultNotifier on_result_;
     CoalescingTask coalescer_;
     SPSCQueue<Output, QueueCapacity> results_;
 
@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <deque>
 #include <list>
 #include <stdexcept>
 #include <string>
@@ -122,6 +123,130 @@ private:
     std::size_t total_size_{0};
 };
 
+/// Chunked FIFO byte buffer: appends at the back, drops from the front.
+///
+/// Like ChunkedBuffer the text lives in fixed-size chunks, so appending
+/// never moves what is already stored; dropping a prefix only advances a
+/// head offset and frees chunks once they are fully consumed. Memory stays
+/// proportional to what is retained, which suits capped logs.
+///
+/// Pattern implemented: #39 Memory locality via chunked storage
+template <std::size_t ChunkSize = 65536> // 64KB default
+class ChunkedRingBuffer
+{
+public:
+    ChunkedRingBuffer() = default;
+
+    /// Append text to the back of the buffer.
+    void append(std::string_view text)
+    {
+        while (!text.empty())
+        {
+            if (chunks_.empty() || chunks_.back().size() == ChunkSize)
+            {
+                chunks_.emplace_back();
+                chunks_.back().reserve(ChunkSize);
+            }
+
+            auto& chunk = chunks_.back();
+            auto to_copy = std::min(ChunkSize - chunk.size(), text.size());
+            chunk.append(text.data(), to_copy);
+            size_ += to_copy;
+            text.remove_prefix(to_copy);
+        }
+    }
+
+    /// Drop the first `length` bytes (all of them if `length` >= size()).
+    void drop_front(std::size_t length)
+    {
+        length = std::min(length, size_);
+        size_ -= length;
+        while (length > 0)
+        {
+            auto available = chunks_.front().size() - head_;
+            if (length < available)
+            {
+                head_ += length;
+                return;
+            }
+            length -= available;
+            chunks_.pop_front();
+            head_ = 0;
+        }
+        if (size_ == 0)
+        {
+            clear();
+        }
+    }
+
+    /// Visit the bytes in [offset, offset + length) chunk by chunk, without
+    /// copying. Offsets are relative to the current front.
+    template <typename Visitor>
+    void for_each_span(std::size_t offset, std::size_t length, Visitor&& visit) const
+    {
+        if (offset >= size_)
+        {
+            return;
+        }
+        length = std::min(length, size_ - offset);
+        offset += head_;
+        for (const auto& chunk : chunks_)
+        {
+            if (length == 0)
+            {
+                break;
+            }
+            if (offset >= chunk.size())
+            {
+                offset -= chunk.size();
+                continue;
+            }
+            auto span = std::min(chunk.size() - offset, length);
+            visit(std::string_view(chunk).substr(offset, span));
+            length -= span;
+            offset = 0;
+        }
+    }
+
+    /// Read `length` bytes starting at `offset` from the front.
+    [[nodiscard]] auto read(std::size_t offset, std::size_t length) const -> std::string
+    {
+        std::string result;
+        result.reserve(std::min(length, size_));
+        for_each_span(offset, length, [&result](std::string_view span) { result += span; });
+        return result;
+    }
+
+    /// Retained bytes.
+    [[nodiscard]] auto size() const noexcept -> std::size_t
+    {
+        return size_;
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool
+    {
+        return size_ == 0;
+    }
+
+    /// Number of chunks allocated.
+    [[nodiscard]] auto chunk_count() const noexcept -> std::size_t
+    {
+        return chunks_.size();
+    }
+
+    void clear()
+    {
+        chunks_.clear();
+        head_ = 0;
+        size_ = 0;
+    }
+
+private:
+    std::deque<std::string> chunks_;
+    std::size_t head_{0}; // Consumed bytes of the front chunk
+    std::size_t size_{0};
+};
+
 /// LRU cache with a byte-size cap (instead of entry count).
 ///
 /// Evicts by byte size rather than entry count, suitable for
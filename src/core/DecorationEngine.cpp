@@ -0,0 +1,414 @@
+#include "DecorationEngine.h"
+
+#include "StringUtils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <map>
+
+namespace markamp::core
+{
+
+namespace
+{
+
+constexpr auto kNoEnd = std::numeric_limits<uint32_t>::max();
+
+auto run(std::size_t start, std::size_t length, OverlayKind kind) -> StyleRun
+{
+    return StyleRun{static_cast<uint32_t>(start),
+                    static_cast<uint32_t>(length),
+                    static_cast<uint16_t>(kind)};
+}
+
+/// The line without its line ending.
+auto strip_eol(std::string_view line) -> std::string_view
+{
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+    {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+/// A frontmatter fence: "---" followed only by spaces and the line ending.
+auto is_fence(std::string_view line) -> bool
+{
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r' || line.back() == ' '))
+    {
+        line.remove_suffix(1);
+    }
+    return line == "---";
+}
+
+/// Word characters as Scintilla counts them for whole-word search.
+auto is_word_char(char chr) -> bool
+{
+    const auto byte = static_cast<unsigned char>(chr);
+    return byte >= 0x80 || std::isalnum(byte) != 0 || chr == '_';
+}
+
+void sort_runs(std::vector<StyleRun>& runs)
+{
+    std::stable_sort(runs.begin(),
+                     runs.end(),
+                     [](const StyleRun& lhs, const StyleRun& rhs)
+                     { return lhs.start < rhs.start; });
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Document tracking
+// ═══════════════════════════════════════════════════════
+
+void DecorationEngine::reset(std::size_t line_count)
+{
+    ids_.initialize(line_count);
+    scanned_.clear();
+    applied_.clear();
+    frontmatter_end_ = kNoFrontmatter;
+    frontmatter_dirty_ = true;
+}
+
+void DecorationEngine::on_lines_changed(std::size_t line, std::ptrdiff_t lines_added)
+{
+    if (ids_.size() == 0)
+    {
+        ids_.initialize(1);
+    }
+    line = std::min(line, ids_.size() - 1);
+    forget_line(line);
+
+    if (lines_added > 0)
+    {
+        ids_.on_insert(line + 1, static_cast<std::size_t>(lines_added));
+    }
+    else if (lines_added < 0)
+    {
+        const auto removed =
+            std::min(static_cast<std::size_t>(-lines_added), ids_.size() - line - 1);
+        for (auto index = line + 1; index <= line + removed; ++index)
+        {
+            scanned_.erase(ids_.get(index));
+            applied_.erase(ids_.get(index));
+        }
+        ids_.on_erase(line + 1, removed);
+    }
+
+    // Only edits up to the closing fence (or the scan limit) can move it
+    const auto frontmatter_reach =
+        frontmatter_end_ != kNoFrontmatter ? frontmatter_end_ : kFrontmatterScanLines;
+    if (line <= frontmatter_reach)
+    {
+        frontmatter_dirty_ = true;
+    }
+}
+
+void DecorationEngine::set_caret_line(std::size_t line)
+{
+    caret_line_ = line;
+}
+
+void DecorationEngine::set_highlight_word(std::string word)
+{
+    if (word.size() < kMinHighlightWordLength)
+    {
+        word.clear();
+    }
+    if (word != word_)
+    {
+        word_ = std::move(word);
+        ++generation_;
+    }
+}
+
+void DecorationEngine::set_trailing_whitespace(bool enabled)
+{
+    if (enabled != trailing_whitespace_)
+    {
+        trailing_whitespace_ = enabled;
+        ++generation_;
+    }
+}
+
+void DecorationEngine::set_extension_decorations(const DecorationService& service,
+                                                 const std::string& file_uri)
+{
+    std::map<std::size_t, std::vector<StyleRun>> lines;
+    for (const auto& [handle, ranges] : service.get_file_decorations(file_uri))
+    {
+        const auto* options = service.get_options(handle);
+        const bool whole_line = options != nullptr && options->is_whole_line;
+        const auto style_id = static_cast<uint16_t>(
+            kExtensionStyleBase +
+            std::min<DecorationTypeHandle>(handle, UINT16_MAX - kExtensionStyleBase));
+
+        for (const auto& range : ranges)
+        {
+            if (range.start_line < 0 || range.end_line < range.start_line)
+            {
+                continue;
+            }
+            for (int line = range.start_line; line <= range.end_line; ++line)
+            {
+                const auto begin = whole_line || line != range.start_line
+                                       ? 0U
+                                       : static_cast<uint32_t>(std::max(0, range.start_character));
+                const auto end = whole_line || line != range.end_line
+                                     ? kNoEnd
+                                     : static_cast<uint32_t>(std::max(0, range.end_character));
+                if (end > begin)
+                {
+                    lines[static_cast<std::size_t>(line)].push_back(
+                        StyleRun{begin, end - begin, style_id});
+                }
+            }
+        }
+    }
+
+    extension_runs_.invalidate_all();
+    for (auto& [line, runs] : lines)
+    {
+        sort_runs(runs);
+        extension_runs_.update_line(line, std::move(runs));
+    }
+    ++generation_;
+}
+
+void DecorationEngine::invalidate_all() noexcept
+{
+    ++generation_;
+}
+
+// ═══════════════════════════════════════════════════════
+// Viewport update
+// ═══════════════════════════════════════════════════════
+
+auto DecorationEngine::update(std::size_t first_line, std::size_t last_line, const LineText& text)
+    -> std::vector<LineDecorations>
+{
+    std::vector<LineDecorations> result;
+    const auto count = ids_.size();
+    if (count == 0)
+    {
+        return result;
+    }
+    if (frontmatter_dirty_)
+    {
+        update_frontmatter(text);
+    }
+
+    const auto begin = first_line > kViewportMargin ? first_line - kViewportMargin : 0;
+    const auto end = std::min(count, last_line + kViewportMargin);
+    for (auto line = begin; line < end; ++line)
+    {
+        const auto id = ids_.get(line);
+        const bool caret_line = line == caret_line_;
+        const auto applied = applied_.find(id);
+        if (applied != applied_.end() && applied->second.generation == generation_ &&
+            applied->second.caret_line == caret_line)
+        {
+            continue;
+        }
+
+        const auto line_text = text(line);
+        const auto hash = fnv1a_64(line_text);
+        auto [cached, inserted] = scanned_.try_emplace(id);
+        if (inserted || cached->second.hash != hash)
+        {
+            cached->second.hash = hash;
+            cached->second.runs = scan_line(line_text);
+            ++stats_.lines_scanned;
+        }
+
+        LineDecorations decorated{line, {}};
+        auto& runs = decorated.runs;
+        if (frontmatter_end_ != kNoFrontmatter && line <= frontmatter_end_)
+        {
+            runs.push_back(run(0, line_text.size(), OverlayKind::YamlFrontmatter));
+        }
+        for (const auto& scanned : cached->second.runs)
+        {
+            if (scanned.style_id == static_cast<uint16_t>(OverlayKind::TrailingWhitespace) &&
+                (!trailing_whitespace_ || caret_line))
+            {
+                continue;
+            }
+            runs.push_back(scanned);
+        }
+        if (!word_.empty())
+        {
+            find_word(strip_eol(line_text), word_, runs);
+        }
+        for (auto extension : extension_runs_.get_line(line))
+        {
+            if (extension.start >= line_text.size())
+            {
+                continue;
+            }
+            extension.length = std::min<uint32_t>(
+                extension.length, static_cast<uint32_t>(line_text.size()) - extension.start);
+            runs.push_back(extension);
+        }
+        sort_runs(runs);
+
+        applied_[id] = AppliedLine{generation_, caret_line};
+        result.push_back(std::move(decorated));
+    }
+    stats_.lines_emitted += result.size();
+    return result;
+}
+
+void DecorationEngine::forget_line(std::size_t line)
+{
+    applied_.erase(ids_.get(line));
+}
+
+void DecorationEngine::update_frontmatter(const LineText& text)
+{
+    frontmatter_dirty_ = false;
+    const auto count = ids_.size();
+
+    auto end = kNoFrontmatter;
+    if (count >= 3 && is_fence(text(0)))
+    {
+        for (std::size_t line = 1; line < std::min(count, kFrontmatterScanLines); ++line)
+        {
+            if (is_fence(text(line)))
+            {
+                end = line;
+                break;
+            }
+        }
+    }
+    if (end == frontmatter_end_)
+    {
+        return;
+    }
+
+    // Lines entering or leaving the block
+    const auto old_end = frontmatter_end_ != kNoFrontmatter ? frontmatter_end_ + 1 : 0;
+    const auto new_end = end != kNoFrontmatter ? end + 1 : 0;
+    for (std::size_t line = 0; line < std::min(count, std::max(old_end, new_end)); ++line)
+    {
+        forget_line(line);
+    }
+    frontmatter_end_ = end;
+}
+
+// ═══════════════════════════════════════════════════════
+// Line scanning
+// ═══════════════════════════════════════════════════════
+
+auto DecorationEngine::scan_line(std::string_view line) -> std::vector<StyleRun>
+{
+    line = strip_eol(line);
+    std::vector<StyleRun> runs;
+
+    // Task checkboxes: "- [ ]", "- [x]", "- [X]"
+    constexpr std::string_view kTaskMarker = "- [";
+    for (auto pos = line.find(kTaskMarker); pos != std::string_view::npos;
+         pos = line.find(kTaskMarker, pos + 3))
+    {
+        if (pos + 5 <= line.size() &&
+            (line[pos + 3] == ' ' || line[pos + 3] == 'x' || line[pos + 3] == 'X') &&
+            line[pos + 4] == ']')
+        {
+            runs.push_back(run(pos, 5, OverlayKind::TaskCheckbox));
+        }
+    }
+
+    // Footnote references: "[^identifier]"
+    for (auto pos = line.find("[^"); pos != std::string_view::npos;)
+    {
+        const auto close = line.find(']', pos + 2);
+        if (close == std::string_view::npos)
+        {
+            break;
+        }
+        runs.push_back(run(pos, close - pos + 1, OverlayKind::Footnote));
+        pos = line.find("[^", close + 1);
+    }
+
+    // Inline HTML tags: "<tag ...>" or "</tag>"
+    for (auto pos = line.find('<'); pos != std::string_view::npos;)
+    {
+        const auto close = line.find('>', pos + 1);
+        if (close == std::string_view::npos)
+        {
+            break;
+        }
+        const char first = line[pos + 1];
+        if (std::isalpha(static_cast<unsigned char>(first)) != 0 || first == '/')
+        {
+            runs.push_back(run(pos, close - pos + 1, OverlayKind::HtmlTag));
+        }
+        pos = line.find('<', close + 1);
+    }
+
+    // Nested blockquote markers ("> > "), from depth 2
+    int depth = 0;
+    std::size_t marker_end = 0;
+    while (marker_end < line.size())
+    {
+        if (line[marker_end] == '>')
+        {
+            ++depth;
+            ++marker_end;
+            if (marker_end < line.size() && line[marker_end] == ' ')
+            {
+                ++marker_end;
+            }
+        }
+        else if (line[marker_end] == ' ')
+        {
+            ++marker_end;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (depth >= 2)
+    {
+        runs.push_back(run(0, marker_end, OverlayKind::BlockquoteNest));
+    }
+
+    // Trailing whitespace
+    auto content_end = line.size();
+    while (content_end > 0 && (line[content_end - 1] == ' ' || line[content_end - 1] == '\t'))
+    {
+        --content_end;
+    }
+    if (content_end < line.size())
+    {
+        runs.push_back(
+            run(content_end, line.size() - content_end, OverlayKind::TrailingWhitespace));
+    }
+
+    sort_runs(runs);
+    return runs;
+}
+
+void DecorationEngine::find_word(std::string_view line,
+                                 std::string_view word,
+                                 std::vector<StyleRun>& out)
+{
+    if (word.empty())
+    {
+        return;
+    }
+    for (auto pos = line.find(word); pos != std::string_view::npos; pos = line.find(word, pos + 1))
+    {
+        const auto end = pos + word.size();
+        if ((pos == 0 || !is_word_char(line[pos - 1])) &&
+            (end == line.size() || !is_word_char(line[end])))
+        {
+            out.push_back(run(pos, word.size(), OverlayKind::WordHighlight));
+        }
+    }
+}
+
+} // namespace markamp::core
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "DecorationService.h"
+#include "StableLineId.h"
+#include "StyleRunStore.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace markamp::core
+{
+
+/// Built-in editor overlay layers, used as StyleRun::style_id.
+enum class OverlayKind : uint16_t
+{
+    YamlFrontmatter = 1,
+    TaskCheckbox,
+    Footnote,
+    HtmlTag,
+    BlockquoteNest,
+    TrailingWhitespace,
+    WordHighlight,
+};
+
+/// The overlays of one line, replacing whatever the line showed before.
+struct LineDecorations
+{
+    std::size_t line{0};
+    std::vector<StyleRun> runs; // Line-relative byte ranges, sorted by start
+};
+
+/// Computes the editor's overlay indicators (YAML frontmatter, task
+/// checkboxes, footnotes, inline HTML, nested blockquotes, trailing
+/// whitespace, occurrences of the word under the caret) and extension
+/// decorations for the lines around the viewport only.
+///
+/// Scanned overlays are cached per line, keyed by the line's StableLineId
+/// and a hash of its text, so a line is re-scanned only after it changed.
+/// The engine also remembers which lines the editor already shows current
+/// decorations for: update() returns just the lines in the window that
+/// were edited, scrolled into view for the first time, or affected by a
+/// caret, word or setting change. Extension decorations from the
+/// DecorationService are bucketed per line into a StyleRunStore and emitted
+/// through the same path.
+///
+/// Pattern implemented: #13 Viewport virtualization
+/// Pattern implemented: #26 Stable IDs for UI elements and caches
+class DecorationEngine
+{
+public:
+    /// Lines decorated above and below the visible range.
+    static constexpr std::size_t kViewportMargin = 50;
+
+    /// YAML frontmatter must close within this many lines.
+    static constexpr std::size_t kFrontmatterScanLines = 100;
+
+    /// Extension runs use style_id = kExtensionStyleBase + decoration type.
+    static constexpr uint16_t kExtensionStyleBase = 0x100;
+
+    /// Words shorter than this are not highlighted (they flood the view).
+    static constexpr std::size_t kMinHighlightWordLength = 2;
+
+    /// Text of a line, including its line ending. The view only needs to
+    /// stay valid until the next call, so it can borrow the editor's buffer.
+    using LineText = std::function<std::string_view(std::size_t line)>;
+
+    /// Start over with `line_count` undecorated lines.
+    void reset(std::size_t line_count);
+
+    /// The document changed on `line`, and `lines_added` lines were inserted
+    /// after it (removed, if negative). Call once per modification, in order.
+    void on_lines_changed(std::size_t line, std::ptrdiff_t lines_added);
+
+    /// Trailing whitespace is not shown on the caret line.
+    void set_caret_line(std::size_t line);
+
+    /// Highlight whole-word, case-sensitive occurrences of `word`.
+    void set_highlight_word(std::string word);
+
+    void set_trailing_whitespace(bool enabled);
+
+    /// Re-bucket the extension decorations of `file_uri`.
+    void set_extension_decorations(const DecorationService& service, const std::string& file_uri);
+
+    /// Forget what the editor shows, e.g. after its indicators were reset.
+    void invalidate_all() noexcept;
+
+    /// Decorations for the lines in [first_line, last_line) widened by
+    /// kViewportMargin that are not already shown as they should be. The
+    /// returned lines are considered applied.
+    [[nodiscard]] auto update(std::size_t first_line, std::size_t last_line, const LineText& text)
+        -> std::vector<LineDecorations>;
+
+    /// Built-in overlays found in one line (everything except frontmatter
+    /// and word occurrences, which depend on other lines or the caret).
+    [[nodiscard]] static auto scan_line(std::string_view line) -> std::vector<StyleRun>;
+
+    /// Whole-word, case-sensitive occurrences of `word` in `line`.
+    static void find_word(std::string_view line, std::string_view word, std::vector<StyleRun>& out);
+
+    [[nodiscard]] auto line_count() const noexcept -> std::size_t
+    {
+        return ids_.size();
+    }
+
+    struct Stats
+    {
+        std::size_t lines_scanned{0}; // Cache misses
+        std::size_t lines_emitted{0};
+    };
+
+    [[nodiscard]] auto stats() const noexcept -> const Stats&
+    {
+        return stats_;
+    }
+
+private:
+    struct CachedLine
+    {
+        uint64_t hash{0};
+        std::vector<StyleRun> runs;
+    };
+
+    /// What the editor shows for a line.
+    struct AppliedLine
+    {
+        uint64_t generation{0};
+        bool caret_line{false};
+    };
+
+    void forget_line(std::size_t line);
+    void update_frontmatter(const LineText& text);
+
+    LineIdMap ids_;
+    std::unordered_map<StableLineId, CachedLine> scanned_;
+    std::unordered_map<StableLineId, AppliedLine> applied_;
+    StyleRunStore extension_runs_;
+
+    /// Bumped by every change that alters the lines' decorations wholesale.
+    uint64_t generation_{1};
+    std::size_t caret_line_{0};
+    std::string word_;
+    bool trailing_whitespace_{true};
+
+    /// Last line of the YAML frontmatter block, if the document has one.
+    static constexpr std::size_t kNoFrontmatter = static_cast<std::size_t>(-1);
+    std::size_t frontmatter_end_{kNoFrontmatter};
+    bool frontmatter_dirty_{true};
+
+    Stats stats_;
+};
+
+} // namespace markamp::core
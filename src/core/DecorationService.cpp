@@ -4,6 +4,7 @@ namespace markamp::core
 {
 
 const std::vector<DecorationRange> DecorationService::kEmptyRanges;
+const DecorationService::FileDecorations DecorationService::kEmptyFile;
 
 auto DecorationService::create_decoration_type(DecorationOptions options) -> DecorationTypeHandle
 {
@@ -34,6 +35,13 @@ auto DecorationService::get_decorations(const std::string& file_uri,
     return type_it != file_it->second.end() ? type_it->second : kEmptyRanges;
 }
 
+auto DecorationService::get_file_decorations(const std::string& file_uri) const
+    -> const FileDecorations&
+{
+    auto file_it = decorations_.find(file_uri);
+    return file_it != decorations_.end() ? file_it->second : kEmptyFile;
+}
+
 auto DecorationService::get_options(DecorationTypeHandle type_handle) const
     -> const DecorationOptions*
 {
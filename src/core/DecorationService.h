@@ -56,6 +56,11 @@ public:
                                        DecorationTypeHandle type_handle) const
         -> const std::vector<DecorationRange>&;
 
+    /// Ranges of every decoration type set for a file.
+    using FileDecorations = std::unordered_map<DecorationTypeHandle, std::vector<DecorationRange>>;
+    [[nodiscard]] auto get_file_decorations(const std::string& file_uri) const
+        -> const FileDecorations&;
+
     /// Get decoration options for a type handle.
     [[nodiscard]] auto get_options(DecorationTypeHandle type_handle) const
         -> const DecorationOptions*;
@@ -76,11 +81,10 @@ private:
     std::unordered_map<DecorationTypeHandle, DecorationOptions> types_;
 
     /// file_uri → (type_handle → ranges)
-    std::unordered_map<std::string,
-                       std::unordered_map<DecorationTypeHandle, std::vector<DecorationRange>>>
-        decorations_;
+    std::unordered_map<std::string, FileDecorations> decorations_;
 
     static const std::vector<DecorationRange> kEmptyRanges;
+    static const FileDecorations kEmptyFile;
 
     std::vector<std::pair<std::size_t, ChangeListener>> listeners_;
     std::size_t next_listener_id_{0};
@@ -0,0 +1,81 @@
+#include "DeferredStartup.h"
+
+#include "Logger.h"
+
+#include <exception>
+
+namespace markamp::core
+{
+
+DeferredStartup::DeferredStartup(StartupTimeline& timeline)
+    : timeline_(timeline)
+{
+}
+
+DeferredStartup::~DeferredStartup()
+{
+    wait();
+}
+
+void DeferredStartup::add(std::string name, Task task)
+{
+    if (started_.load(std::memory_order_acquire))
+    {
+        MARKAMP_LOG_WARN("DeferredStartup: '{}' added after start, ignored", name);
+        return;
+    }
+    tasks_.emplace_back(std::move(name), std::move(task));
+}
+
+void DeferredStartup::start(Task on_complete)
+{
+    if (started_.exchange(true, std::memory_order_acq_rel))
+    {
+        return;
+    }
+    worker_ = std::thread([this, on_complete = std::move(on_complete)]() mutable
+                          { run(std::move(on_complete)); });
+}
+
+void DeferredStartup::wait()
+{
+    if (worker_.joinable())
+    {
+        worker_.join();
+    }
+}
+
+auto DeferredStartup::started() const noexcept -> bool
+{
+    return started_.load(std::memory_order_acquire);
+}
+
+auto DeferredStartup::finished() const noexcept -> bool
+{
+    return finished_.load(std::memory_order_acquire);
+}
+
+void DeferredStartup::run(Task on_complete)
+{
+    for (auto& [name, task] : tasks_)
+    {
+        try
+        {
+            auto stage = timeline_.measure(name, StartupPhase::Background);
+            task();
+        }
+        catch (const std::exception& ex)
+        {
+            MARKAMP_LOG_ERROR("Deferred startup task '{}' failed: {}", name, ex.what());
+        }
+    }
+    tasks_.clear();
+
+    if (on_complete)
+    {
+        on_complete();
+    }
+    finished_.store(true, std::memory_order_release);
+}
+
+} // namespace markamp::core
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "StartupTimeline.h"
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace markamp::core
+{
+
+/// Startup work that does not have to finish before the first frame.
+///
+/// Tasks are queued with add() during OnInit and run in order on one
+/// background thread once start() is called, each timed as a Background
+/// stage. A task that throws is logged and skipped; the rest still run.
+/// `on_complete` runs on the background thread after the last task, so
+/// callers that touch UI state post it back to the UI thread themselves.
+///
+/// Pattern implemented: #18 Predictable I/O never on the hot path
+class DeferredStartup
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit DeferredStartup(StartupTimeline& timeline);
+
+    /// Joins the background thread; queued tasks still run to completion.
+    ~DeferredStartup();
+
+    // Non-copyable, non-movable
+    DeferredStartup(const DeferredStartup&) = delete;
+    auto operator=(const DeferredStartup&) -> DeferredStartup& = delete;
+    DeferredStartup(DeferredStartup&&) = delete;
+    auto operator=(DeferredStartup&&) -> DeferredStartup& = delete;
+
+    /// Queue a named task. Ignored once start() has been called.
+    void add(std::string name, Task task);
+
+    /// Run the queued tasks on the background thread. Only the first call
+    /// has an effect.
+    void start(Task on_complete = {});
+
+    /// Block until every task (and `on_complete`) has run.
+    void wait();
+
+    /// Whether start() has been called.
+    [[nodiscard]] auto started() const noexcept -> bool;
+
+    /// Whether every task (and `on_complete`) has run.
+    [[nodiscard]] auto finished() const noexcept -> bool;
+
+private:
+    StartupTimeline& timeline_;
+    std::vector<std::pair<std::string, Task>> tasks_; // Owned by the worker after start()
+    std::thread worker_;
+    std::atomic<bool> started_{false};
+    std::atomic<bool> finished_{false};
+
+    void run(Task on_complete);
+};
+
+} // namespace markamp::core
@@ -0,0 +1,121 @@
+#include "DocumentLoader.h"
+
+#include <algorithm>
+
+namespace markamp::core
+{
+
+auto LoadedDocument::text() const noexcept -> std::string_view
+{
+    if (encoding.encoding == Encoding::Utf16LE || encoding.encoding == Encoding::Utf16BE ||
+        encoding.encoding == Encoding::Unknown)
+    {
+        return converted;
+    }
+    return file.bytes().substr(bom_bytes);
+}
+
+auto load_document(const std::filesystem::path& path, std::size_t map_threshold)
+    -> std::expected<std::shared_ptr<const LoadedDocument>, std::string>
+{
+    auto file = MappedFile::open(path, map_threshold);
+    if (!file)
+    {
+        return std::unexpected(file.error());
+    }
+
+    auto document = std::make_shared<LoadedDocument>();
+    document->file = std::move(*file);
+    const auto bytes = document->file.bytes();
+    document->encoding = detect_encoding(bytes);
+    document->bom_bytes = bom_length(bytes, document->encoding.encoding);
+    if (document->encoding.encoding == Encoding::Utf16LE ||
+        document->encoding.encoding == Encoding::Utf16BE ||
+        document->encoding.encoding == Encoding::Unknown)
+    {
+        document->converted =
+            to_utf8(bytes.substr(document->bom_bytes), document->encoding.encoding);
+    }
+    document->has_crlf = document->text().find("\r\n") != std::string_view::npos;
+    return document;
+}
+
+auto next_text_chunk_end(std::string_view text, std::size_t offset, std::size_t max_bytes)
+    -> std::size_t
+{
+    if (offset >= text.size() || text.size() - offset <= max_bytes)
+    {
+        return text.size();
+    }
+    const auto limit = offset + std::max<std::size_t>(max_bytes, 1);
+
+    // Last newline in the second half of the window keeps pieces large
+    const auto half = offset + max_bytes / 2;
+    const auto newline = text.substr(half, limit - half).rfind('\n');
+    if (newline != std::string_view::npos)
+    {
+        return half + newline + 1;
+    }
+
+    // Otherwise back up to the start of a UTF-8 sequence
+    auto end = limit;
+    while (end > offset && (static_cast<unsigned char>(text[end]) & 0xC0U) == 0x80U)
+    {
+        --end;
+    }
+    if (end == offset)
+    {
+        // A single character longer than max_bytes (only with tiny limits)
+        end = limit;
+        while (end < text.size() && (static_cast<unsigned char>(text[end]) & 0xC0U) == 0x80U)
+        {
+            ++end;
+        }
+    }
+    return end;
+}
+
+DocumentLoader::DocumentLoader(const std::filesystem::path& path,
+                               ReadyCallback on_ready,
+                               ErrorCallback on_error)
+    : worker_(
+          [this, path, ready_cb = std::move(on_ready), error_cb = std::move(on_error)]()
+          {
+              auto document = load_document(path, MappedFile::kNeverMap);
+              if (!cancelled_.load(std::memory_order_acquire))
+              {
+                  if (document && ready_cb)
+                  {
+                      ready_cb(std::move(*document));
+                  }
+                  else if (!document && error_cb)
+                  {
+                      error_cb(document.error());
+                  }
+              }
+              complete_.store(true, std::memory_order_release);
+          })
+{
+}
+
+DocumentLoader::~DocumentLoader()
+{
+    cancel();
+}
+
+void DocumentLoader::cancel()
+{
+    cancelled_.store(true, std::memory_order_release);
+    if (worker_.joinable())
+    {
+        worker_.join();
+    }
+    complete_.store(true, std::memory_order_release);
+}
+
+auto DocumentLoader::is_complete() const noexcept -> bool
+{
+    return complete_.load(std::memory_order_acquire);
+}
+
+} // namespace markamp::core
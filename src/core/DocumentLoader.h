@@ -0,0 +1,91 @@
+#pragma once
+
+#include "EncodingDetector.h"
+#include "MappedFile.h"
+
+#include <atomic>
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace markamp::core
+{
+
+/// A file opened for editing: its bytes, their encoding, and the UTF-8
+/// text to show.
+struct LoadedDocument
+{
+    MappedFile file;
+    DetectedEncoding encoding;
+    std::size_t bom_bytes{0};
+    std::string converted; // UTF-8 text when the file is not UTF-8 / ASCII
+    bool has_crlf{false};
+
+    /// UTF-8 text without BOM. Points into the mapping (no copy) unless
+    /// the file had to be converted.
+    [[nodiscard]] auto text() const noexcept -> std::string_view;
+};
+
+/// Open `path` for editing: map or read it (see MappedFile), detect the
+/// encoding on the bytes in place, and convert only if it is not UTF-8.
+[[nodiscard]] auto load_document(const std::filesystem::path& path,
+                                 std::size_t map_threshold = MappedFile::kDefaultMapThreshold)
+    -> std::expected<std::shared_ptr<const LoadedDocument>, std::string>;
+
+/// End of the piece of `text` that starts at `offset` and is at most
+/// `max_bytes` long (longer only if a single UTF-8 character is). Prefers
+/// to end after a newline and never splits a UTF-8 sequence, so each piece
+/// can be inserted into an editor on its own.
+[[nodiscard]] auto next_text_chunk_end(std::string_view text,
+                                       std::size_t offset,
+                                       std::size_t max_bytes) -> std::size_t;
+
+/// Runs load_document() on a background thread.
+///
+/// Exactly one of the callbacks runs, on the worker thread, unless the
+/// load is cancelled first. Unlike AsyncFileLoader, which copies the file
+/// out in fixed chunks, the whole document is delivered at once as a
+/// shared buffer; the caller decides how fast to feed it to the UI (see
+/// next_text_chunk_end()). The file is read into memory, never mapped:
+/// the caller keeps the text across many UI ticks, and a mapping would
+/// fault (SIGBUS) if another process truncated the file meanwhile.
+///
+/// Pattern implemented: #18 Predictable I/O never on the hot path
+class DocumentLoader
+{
+public:
+    using ReadyCallback = std::function<void(std::shared_ptr<const LoadedDocument>)>;
+    using ErrorCallback = std::function<void(std::string)>;
+
+    /// Start loading `path` asynchronously.
+    DocumentLoader(const std::filesystem::path& path,
+                   ReadyCallback on_ready,
+                   ErrorCallback on_error);
+
+    ~DocumentLoader();
+
+    // Non-copyable, non-movable
+    DocumentLoader(const DocumentLoader&) = delete;
+    auto operator=(const DocumentLoader&) -> DocumentLoader& = delete;
+    DocumentLoader(DocumentLoader&&) = delete;
+    auto operator=(DocumentLoader&&) -> DocumentLoader& = delete;
+
+    /// Cancel the load and wait for the worker; no callback runs after
+    /// this returns.
+    void cancel();
+
+    /// Check if loading is complete (either success, failure or cancelled).
+    [[nodiscard]] auto is_complete() const noexcept -> bool;
+
+private:
+    std::atomic<bool> cancelled_{false};
+    std::atomic<bool> complete_{false};
+    std::thread worker_;
+};
+
+} // namespace markamp::core
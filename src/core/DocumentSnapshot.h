@@ -2,7 +2,9 @@
 
 #include "SyntaxHighlighter.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -63,4 +65,102 @@ private:
     std::shared_ptr<DocumentSnapshot> current_; // GUARDED_BY(mutex_)
 };
 
+// ═══════════════════════════════════════════════════════
+// Edit deltas and lazily materialised snapshots
+// ═══════════════════════════════════════════════════════
+
+/// One text modification, in UTF-8 byte offsets of the document as it was
+/// immediately before this edit was applied.
+struct TextDelta
+{
+    std::size_t offset{0};
+    std::size_t removed_length{0};
+    std::string inserted_text;
+};
+
+/// Shared handle to the document text at a given version, materialised on
+/// first request.
+///
+/// Change notifications carry one of these instead of the full text: a
+/// subscriber that only needs to know *that* something changed never pays for
+/// a copy, and all subscribers that do need the text share a single
+/// immutable DocumentSnapshot. Once the source document moves on, expire()
+/// drops the producer; a handle that was never pulled then yields nullptr
+/// (a newer notification is on its way).
+///
+/// The producer runs on the thread calling get() — for editor-backed handles
+/// that is the UI thread. A materialised snapshot may be shared freely.
+class LazyDocumentSnapshot
+{
+public:
+    using Producer = std::function<std::shared_ptr<const std::string>()>;
+
+    LazyDocumentSnapshot(uint64_t version, Producer producer)
+        : version_(version)
+        , producer_(std::move(producer))
+    {
+    }
+
+    /// Handle around text that is already in memory.
+    [[nodiscard]] static auto from_content(uint64_t version, std::string content)
+        -> std::shared_ptr<LazyDocumentSnapshot>
+    {
+        auto handle = std::make_shared<LazyDocumentSnapshot>(version, nullptr);
+        handle->snapshot_ = std::make_shared<const DocumentSnapshot>(DocumentSnapshot{
+            .version = version,
+            .content = std::make_shared<const std::string>(std::move(content)),
+            .tokens = nullptr});
+        return handle;
+    }
+
+    [[nodiscard]] auto version() const noexcept -> uint64_t
+    {
+        return version_;
+    }
+
+    /// Materialise (once) and return the snapshot, or nullptr if it expired
+    /// before anyone asked for it.
+    [[nodiscard]] auto get() const -> std::shared_ptr<const DocumentSnapshot>
+    {
+        std::lock_guard lock(mutex_);
+        if (!snapshot_ && producer_)
+        {
+            auto content = producer_();
+            producer_ = nullptr;
+            if (content)
+            {
+                snapshot_ = std::make_shared<const DocumentSnapshot>(DocumentSnapshot{
+                    .version = version_, .content = std::move(content), .tokens = nullptr});
+            }
+        }
+        return snapshot_;
+    }
+
+    /// Shorthand for get()->content; nullptr if expired.
+    [[nodiscard]] auto content() const -> std::shared_ptr<const std::string>
+    {
+        auto snapshot = get();
+        return snapshot ? snapshot->content : nullptr;
+    }
+
+    [[nodiscard]] auto is_materialized() const -> bool
+    {
+        std::lock_guard lock(mutex_);
+        return snapshot_ != nullptr;
+    }
+
+    /// The source document changed; stop offering this version.
+    void expire()
+    {
+        std::lock_guard lock(mutex_);
+        producer_ = nullptr;
+    }
+
+private:
+    uint64_t version_;
+    mutable std::mutex mutex_;
+    mutable Producer producer_;                                // GUARDED_BY(mutex_)
+    mutable std::shared_ptr<const DocumentSnapshot> snapshot_; // GUARDED_BY(mutex_)
+};
+
 } // namespace markamp::core
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "TextSpan.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace markamp::core
+{
+
+/// Process-wide count of document text copied out of editor buffers
+/// (snapshots, saves, journal checkpoints). Benchmarks and diagnostics
+/// compare it before and after an operation to report bytes copied per
+/// keystroke.
+class TextCopyCounter
+{
+public:
+    static void record(std::size_t bytes) noexcept
+    {
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        copies_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static auto bytes() noexcept -> uint64_t
+    {
+        return bytes_.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static auto copies() noexcept -> uint64_t
+    {
+        return copies_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static inline std::atomic<uint64_t> bytes_{0};
+    static inline std::atomic<uint64_t> copies_{0};
+};
+
+/// Yields the lines of a text as zero-copy TextSpans, each including its
+/// line ending. A final line without one is yielded too; the empty line
+/// after a trailing newline is not.
+class TextLineIterator
+{
+public:
+    TextLineIterator(std::string_view text, std::size_t first_line) noexcept
+        : text_(text)
+        , line_(first_line)
+    {
+    }
+
+    [[nodiscard]] auto has_next() const noexcept -> bool
+    {
+        return offset_ < text_.size();
+    }
+
+    /// The next line; an empty span once has_next() is false.
+    [[nodiscard]] auto next() noexcept -> TextSpan
+    {
+        if (!has_next())
+        {
+            return TextSpan{.data = {}, .logical_line = line_};
+        }
+        const auto newline = text_.find('\n', offset_);
+        const auto end = newline == std::string_view::npos ? text_.size() : newline + 1;
+        TextSpan span{.data = std::span<const char>(text_.data() + offset_, end - offset_),
+                      .logical_line = line_};
+        offset_ = end;
+        ++line_;
+        return span;
+    }
+
+private:
+    std::string_view text_;
+    std::size_t offset_{0};
+    std::size_t line_;
+};
+
+/// Read-only view of editor text, borrowed from the editor's own buffer.
+///
+/// The bytes stay valid only until the document changes, so a view records
+/// the document version it was taken at and a pointer to the owner's live
+/// version: valid() turns false on the next edit and text() then returns an
+/// empty view instead of dangling bytes. Views are for the UI thread and
+/// the current call; to keep text or hand it to another thread, take a
+/// snapshot(), which is the one counted copy.
+///
+/// Pattern implemented: #23 Zero-copy text iteration for rendering
+class DocumentTextView
+{
+public:
+    DocumentTextView() = default;
+
+    /// `text` must stay unchanged while `*live_version` equals `version`.
+    DocumentTextView(std::string_view text,
+                     uint64_t version,
+                     const uint64_t* live_version,
+                     std::size_t first_line = 0) noexcept
+        : text_(text)
+        , version_(version)
+        , live_version_(live_version)
+        , first_line_(first_line)
+    {
+    }
+
+    [[nodiscard]] auto valid() const noexcept -> bool
+    {
+        return live_version_ != nullptr && *live_version_ == version_;
+    }
+
+    [[nodiscard]] auto version() const noexcept -> uint64_t
+    {
+        return version_;
+    }
+
+    /// The borrowed bytes; empty once the document has moved on.
+    [[nodiscard]] auto text() const noexcept -> std::string_view
+    {
+        return valid() ? text_ : std::string_view{};
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t
+    {
+        return text().size();
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool
+    {
+        return text().empty();
+    }
+
+    /// The lines of the view, numbered from the line it starts on.
+    [[nodiscard]] auto lines() const noexcept -> TextLineIterator
+    {
+        return {text(), first_line_};
+    }
+
+    /// An owned copy (counted by TextCopyCounter).
+    [[nodiscard]] auto to_string() const -> std::string
+    {
+        const auto bytes = text();
+        TextCopyCounter::record(bytes.size());
+        return std::string(bytes);
+    }
+
+    /// Immutable copy that may outlive the view and cross threads; null if
+    /// the view is no longer valid.
+    [[nodiscard]] auto snapshot() const -> std::shared_ptr<const std::string>
+    {
+        if (!valid())
+        {
+            return nullptr;
+        }
+        return std::make_shared<const std::string>(to_string());
+    }
+
+private:
+    std::string_view text_;
+    uint64_t version_{0};
+    const uint64_t* live_version_{nullptr};
+    std::size_t first_line_{0};
+};
+
+} // namespace markamp::core
@@ -0,0 +1,522 @@
+#include "EditJournal.h"
+
+#include "DocumentLoader.h"
+#include "Logger.h"
+#include "StringUtils.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <io.h>
+#endif
+
+namespace markamp::core
+{
+
+namespace
+{
+
+// File: kMagic, then records. Record: u64 payload size, u64 FNV-1a of the
+// payload, payload. Payload: u8 kind, u64 version, then per kind
+//   base:       u64 file size, i64 file time
+//   checkpoint: the whole text
+//   edit:       u64 offset, u64 bytes removed, bytes inserted
+// Integers are little-endian.
+constexpr std::string_view kMagic = "MKJRNL01";
+constexpr std::size_t kRecordHeaderBytes = 16;
+constexpr std::size_t kPayloadHeaderBytes = 9;
+constexpr std::size_t kEditFieldBytes = 16;
+
+enum class RecordKind : std::uint8_t
+{
+    kBase = 1,
+    kCheckpoint = 2,
+    kEdit = 3,
+};
+
+void put_u64(std::string& out, std::uint64_t value)
+{
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        out.push_back(static_cast<char>((value >> shift) & 0xFFU));
+    }
+}
+
+[[nodiscard]] auto get_u64(std::string_view bytes, std::size_t offset) -> std::uint64_t
+{
+    std::uint64_t value = 0;
+    for (std::size_t index = 0; index < 8; ++index)
+    {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[offset + index]))
+                 << (index * 8);
+    }
+    return value;
+}
+
+/// One framed record: `fields` (fixed-size, already encoded) then `bytes`.
+[[nodiscard]] auto make_record(RecordKind kind,
+                               std::uint64_t version,
+                               std::string_view fields,
+                               std::string_view bytes) -> std::string
+{
+    std::string record(kRecordHeaderBytes, '\0');
+    record.reserve(kRecordHeaderBytes + kPayloadHeaderBytes + fields.size() + bytes.size());
+    record.push_back(static_cast<char>(kind));
+    put_u64(record, version);
+    record.append(fields);
+    record.append(bytes);
+
+    const std::string_view payload(record.data() + kRecordHeaderBytes,
+                                   record.size() - kRecordHeaderBytes);
+    std::string header;
+    put_u64(header, payload.size());
+    put_u64(header, fnv1a_64(payload));
+    std::copy(header.begin(), header.end(), record.begin());
+    return record;
+}
+
+[[nodiscard]] auto open_file(const std::filesystem::path& path, const wchar_t* wide_mode,
+                             const char* mode) -> std::FILE*
+{
+#if defined(_WIN32)
+    static_cast<void>(mode);
+    return ::_wfopen(path.c_str(), wide_mode);
+#else
+    static_cast<void>(wide_mode);
+    return std::fopen(path.c_str(), mode);
+#endif
+}
+
+/// Flush stdio buffers and ask the OS to put the bytes on disk.
+[[nodiscard]] auto sync_file(std::FILE* file) -> bool
+{
+    if (std::fflush(file) != 0)
+    {
+        return false;
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    return ::fsync(::fileno(file)) == 0;
+#elif defined(_WIN32)
+    return ::_commit(::_fileno(file)) == 0;
+#else
+    return true;
+#endif
+}
+
+} // anonymous namespace
+
+auto JournalBase::of(const std::filesystem::path& path) -> std::optional<JournalBase>
+{
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+    const auto time = std::filesystem::last_write_time(path, error);
+    if (error)
+    {
+        return std::nullopt;
+    }
+    return JournalBase{size, static_cast<std::int64_t>(time.time_since_epoch().count())};
+}
+
+void EditJournal::FileCloser::operator()(std::FILE* file) const noexcept
+{
+    if (file != nullptr)
+    {
+        std::fclose(file);
+    }
+}
+
+EditJournal::~EditJournal()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    if (writer_.joinable())
+    {
+        writer_.join();
+    }
+}
+
+auto EditJournal::journal_path(const std::filesystem::path& document) -> std::filesystem::path
+{
+    auto journal = document;
+    journal += kExtension;
+    return journal;
+}
+
+// ═══════════════════════════════════════════════════════
+// Logging (calling thread)
+// ═══════════════════════════════════════════════════════
+
+auto EditJournal::is_open(const std::filesystem::path& document) const -> bool
+{
+    std::lock_guard lock(mutex_);
+    return entries_.contains(document.string());
+}
+
+void EditJournal::start(const std::filesystem::path& document, const JournalBase& base)
+{
+    {
+        std::lock_guard lock(mutex_);
+        entries_[document.string()] =
+            Entry{.compact_bytes = std::max<std::size_t>(kCompactMinBytes, base.size)};
+    }
+    enqueue(Op{.kind = OpKind::kStart, .journal = journal_path(document), .base = base});
+}
+
+void EditJournal::append(const std::filesystem::path& document,
+                         std::uint64_t version,
+                         TextDelta delta)
+{
+    {
+        std::lock_guard lock(mutex_);
+        const auto entry = entries_.find(document.string());
+        if (entry == entries_.end())
+        {
+            return;
+        }
+        entry->second.version = version;
+        entry->second.logged_bytes += kRecordHeaderBytes + kPayloadHeaderBytes +
+                                      kEditFieldBytes + delta.inserted_text.size();
+    }
+    enqueue(Op{.kind = OpKind::kAppend,
+               .journal = journal_path(document),
+               .version = version,
+               .delta = std::move(delta)});
+}
+
+void EditJournal::checkpoint(const std::filesystem::path& document,
+                             std::shared_ptr<const std::string> text)
+{
+    if (text == nullptr)
+    {
+        return;
+    }
+    std::uint64_t version = 0;
+    {
+        std::lock_guard lock(mutex_);
+        auto& entry = entries_[document.string()];
+        version = entry.version;
+        entry.logged_bytes = 0;
+        entry.compact_bytes = std::max(kCompactMinBytes, text->size());
+    }
+    enqueue(Op{.kind = OpKind::kCheckpoint,
+               .journal = journal_path(document),
+               .version = version,
+               .text = std::move(text)});
+}
+
+void EditJournal::discard(const std::filesystem::path& document)
+{
+    {
+        std::lock_guard lock(mutex_);
+        entries_.erase(document.string());
+    }
+    enqueue(Op{.kind = OpKind::kDiscard, .journal = journal_path(document)});
+}
+
+auto EditJournal::needs_checkpoint(const std::filesystem::path& document) const -> bool
+{
+    std::lock_guard lock(mutex_);
+    const auto entry = entries_.find(document.string());
+    return entry != entries_.end() && entry->second.logged_bytes > entry->second.compact_bytes;
+}
+
+void EditJournal::flush()
+{
+    std::unique_lock lock(mutex_);
+    if (!writer_.joinable())
+    {
+        return;
+    }
+    const auto target = ++flush_requested_;
+    work_cv_.notify_one();
+    flushed_cv_.wait(lock, [this, target] { return flush_done_ >= target; });
+}
+
+auto EditJournal::stats() const -> Stats
+{
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+void EditJournal::enqueue(Op op)
+{
+    {
+        std::lock_guard lock(mutex_);
+        if (stopping_)
+        {
+            return;
+        }
+        ops_.push_back(std::move(op));
+        if (!writer_.joinable())
+        {
+            writer_ = std::thread([this]() { run_writer(); });
+        }
+    }
+    work_cv_.notify_one();
+}
+
+// ═══════════════════════════════════════════════════════
+// Writing (writer thread)
+// ═══════════════════════════════════════════════════════
+
+void EditJournal::run_writer()
+{
+    std::unique_lock lock(mutex_);
+    while (true)
+    {
+        // Wakes for work, for a flush, or to sync what the last batch wrote
+        work_cv_.wait_for(lock,
+                          kSyncInterval,
+                          [this]
+                          {
+                              return stopping_ || !ops_.empty() ||
+                                     flush_requested_ != flush_done_;
+                          });
+        std::deque<Op> batch;
+        batch.swap(ops_);
+        const bool stopping = stopping_;
+        const auto flush_target = flush_requested_;
+        const bool flushing = flush_target != flush_done_;
+        lock.unlock();
+
+        for (auto& op : batch)
+        {
+            apply(op);
+        }
+        if (stopping || flushing ||
+            std::chrono::steady_clock::now() - last_sync_ >= kSyncInterval)
+        {
+            sync_pending();
+        }
+
+        lock.lock();
+        stats_ = written_;
+        flush_done_ = flush_target;
+        flushed_cv_.notify_all();
+        if (stopping && ops_.empty())
+        {
+            return;
+        }
+    }
+}
+
+void EditJournal::apply(Op& op)
+{
+    const auto key = op.journal.string();
+    switch (op.kind)
+    {
+    case OpKind::kStart:
+    {
+        files_.erase(key);
+        FileHandle file(open_file(op.journal, L"wb", "wb"));
+        if (file == nullptr)
+        {
+            MARKAMP_LOG_WARN("Cannot create edit journal: {}", key);
+            return;
+        }
+        files_[key] = std::move(file);
+        std::string fields;
+        put_u64(fields, op.base.size);
+        put_u64(fields, static_cast<std::uint64_t>(op.base.mtime));
+        write_record(op.journal, kMagic);
+        write_record(op.journal, make_record(RecordKind::kBase, 0, fields, {}));
+        break;
+    }
+    case OpKind::kAppend:
+    {
+        std::string fields;
+        put_u64(fields, op.delta.offset);
+        put_u64(fields, op.delta.removed_length);
+        write_record(op.journal,
+                     make_record(RecordKind::kEdit, op.version, fields, op.delta.inserted_text));
+        ++written_.records;
+        break;
+    }
+    case OpKind::kCheckpoint:
+    {
+        // Written aside and renamed over the journal: a crash leaves
+        // either the old journal or the new one
+        auto temporary = op.journal;
+        temporary += ".tmp";
+        {
+            FileHandle file(open_file(temporary, L"wb", "wb"));
+            const auto record = make_record(RecordKind::kCheckpoint, op.version, {}, *op.text);
+            if (file == nullptr ||
+                std::fwrite(kMagic.data(), 1, kMagic.size(), file.get()) != kMagic.size() ||
+                std::fwrite(record.data(), 1, record.size(), file.get()) != record.size() ||
+                !sync_file(file.get()))
+            {
+                MARKAMP_LOG_WARN("Cannot write edit journal checkpoint: {}", key);
+                file.reset();
+                std::error_code remove_error;
+                std::filesystem::remove(temporary, remove_error);
+                return;
+            }
+            written_.bytes_written += kMagic.size() + record.size();
+        }
+        files_.erase(key);
+        unsynced_.erase(key);
+        std::error_code rename_error;
+        std::filesystem::rename(temporary, op.journal, rename_error);
+        if (rename_error)
+        {
+            MARKAMP_LOG_WARN("Cannot replace edit journal {}: {}", key, rename_error.message());
+            return;
+        }
+        FileHandle file(open_file(op.journal, L"ab", "ab"));
+        if (file != nullptr)
+        {
+            files_[key] = std::move(file);
+        }
+        ++written_.checkpoints;
+        break;
+    }
+    case OpKind::kDiscard:
+    {
+        files_.erase(key);
+        unsynced_.erase(key);
+        std::error_code remove_error;
+        std::filesystem::remove(op.journal, remove_error);
+        break;
+    }
+    }
+}
+
+void EditJournal::write_record(const std::filesystem::path& journal, std::string_view record)
+{
+    const auto key = journal.string();
+    const auto file = files_.find(key);
+    if (file == files_.end())
+    {
+        return; // Not started, or given up on after a failed write
+    }
+    if (std::fwrite(record.data(), 1, record.size(), file->second.get()) != record.size())
+    {
+        // Later records would follow a gap: stop here, recovery ends at the tear
+        MARKAMP_LOG_WARN("Edit journal write failed, no longer logging: {}", key);
+        files_.erase(file);
+        unsynced_.erase(key);
+        return;
+    }
+    written_.bytes_written += record.size();
+    unsynced_.insert(key);
+}
+
+void EditJournal::sync_pending()
+{
+    for (const auto& key : unsynced_)
+    {
+        const auto file = files_.find(key);
+        if (file != files_.end() && !sync_file(file->second.get()))
+        {
+            MARKAMP_LOG_WARN("Cannot sync edit journal: {}", key);
+        }
+        ++written_.syncs;
+    }
+    unsynced_.clear();
+    last_sync_ = std::chrono::steady_clock::now();
+}
+
+// ═══════════════════════════════════════════════════════
+// Recovery
+// ═══════════════════════════════════════════════════════
+
+auto EditJournal::recover(const std::filesystem::path& document)
+    -> std::expected<RecoveredDocument, std::string>
+{
+    const auto journal = journal_path(document);
+    std::ifstream in(journal, std::ios::binary);
+    if (!in.is_open())
+    {
+        return std::unexpected("No edit journal for " + document.string());
+    }
+    const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (!data.starts_with(kMagic))
+    {
+        return std::unexpected("Not an edit journal: " + journal.string());
+    }
+
+    RecoveredDocument result;
+    bool has_text = false;
+    std::size_t offset = kMagic.size();
+    while (data.size() - offset >= kRecordHeaderBytes)
+    {
+        // A record cut short or garbled by a crash ends the journal
+        const auto size = get_u64(data, offset);
+        if (size < kPayloadHeaderBytes || size > data.size() - offset - kRecordHeaderBytes)
+        {
+            break;
+        }
+        const std::string_view payload(data.data() + offset + kRecordHeaderBytes, size);
+        if (fnv1a_64(payload) != get_u64(data, offset + 8))
+        {
+            break;
+        }
+        offset += kRecordHeaderBytes + size;
+
+        const auto kind = static_cast<RecordKind>(payload[0]);
+        const auto body = payload.substr(kPayloadHeaderBytes);
+        if (kind == RecordKind::kBase)
+        {
+            if (body.size() < 16)
+            {
+                return std::unexpected("Malformed edit journal: " + journal.string());
+            }
+            const JournalBase base{get_u64(body, 0), static_cast<std::int64_t>(get_u64(body, 8))};
+            if (JournalBase::of(document) != base)
+            {
+                return std::unexpected(document.string() +
+                                       " was changed on disk after its edit journal started");
+            }
+            auto loaded = load_document(document);
+            if (!loaded)
+            {
+                return std::unexpected(loaded.error());
+            }
+            result.text.assign((*loaded)->text());
+            has_text = true;
+        }
+        else if (kind == RecordKind::kCheckpoint)
+        {
+            result.text.assign(body);
+            has_text = true;
+        }
+        else if (kind == RecordKind::kEdit && has_text && body.size() >= kEditFieldBytes)
+        {
+            const auto position = get_u64(body, 0);
+            const auto removed = get_u64(body, 8);
+            if (position > result.text.size() || removed > result.text.size() - position)
+            {
+                return std::unexpected("Edit journal does not match its text: " +
+                                       journal.string());
+            }
+            result.text.replace(position, removed, body.substr(kEditFieldBytes));
+            ++result.edits;
+        }
+        else
+        {
+            return std::unexpected("Malformed edit journal: " + journal.string());
+        }
+        result.version = get_u64(payload, 1);
+    }
+
+    if (!has_text)
+    {
+        return std::unexpected("Edit journal is empty: " + journal.string());
+    }
+    return result;
+}
+
+} // namespace markamp::core
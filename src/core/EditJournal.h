@@ -0,0 +1,184 @@
+#pragma once
+
+#include "DocumentSnapshot.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace markamp::core
+{
+
+/// The file on disk that a journal's edits apply to, identified the way
+/// external changes are detected: by size and modification time.
+struct JournalBase
+{
+    std::uintmax_t size{0};
+    std::int64_t mtime{0}; // file_time_type ticks
+
+    /// Size and time of `path` now; nullopt if it cannot be read.
+    [[nodiscard]] static auto of(const std::filesystem::path& path) -> std::optional<JournalBase>;
+
+    [[nodiscard]] auto operator==(const JournalBase&) const -> bool = default;
+};
+
+/// Unsaved text rebuilt from a journal.
+struct RecoveredDocument
+{
+    std::string text;
+    std::uint64_t version{0}; // Editor version of the last record
+    std::size_t edits{0};     // Edit records replayed
+};
+
+/// Crash-safe, append-only log of unsaved edits, one file per document
+/// (`<path>.markamp-journal`, next to it).
+///
+/// A journal starts either from the file on disk (a base record naming its
+/// size and time) or from a checkpoint holding the whole text, and then
+/// gains one small record per edit: offset, bytes removed, bytes inserted
+/// and the editor version. Records are written on a background thread and
+/// synced at most once per kSyncInterval, so typing costs a queue push and
+/// the disk sees bytes in proportion to what was typed, not to file size.
+/// Every record carries its length and checksum; a record torn by a crash
+/// ends the journal rather than corrupting the recovered text.
+///
+/// Once a journal has logged more than its document's size (and at least
+/// kCompactMinBytes), needs_checkpoint() asks for the text so the journal
+/// can be rewritten as one checkpoint — atomically, through a temporary
+/// file. Saving or closing a document discards its journal; recover()
+/// replays one left behind by a crash.
+///
+/// The public methods are for one (UI) thread; writes happen in order.
+///
+/// Pattern implemented: #18 Predictable I/O never on the hot path
+class EditJournal
+{
+public:
+    static constexpr std::string_view kExtension = ".markamp-journal";
+    static constexpr auto kSyncInterval = std::chrono::milliseconds(1000);
+    static constexpr std::size_t kCompactMinBytes = static_cast<std::size_t>(1024) * 1024;
+
+    EditJournal() = default;
+
+    /// Writes and syncs everything queued, then stops the writer.
+    ~EditJournal();
+
+    // Non-copyable, non-movable
+    EditJournal(const EditJournal&) = delete;
+    auto operator=(const EditJournal&) -> EditJournal& = delete;
+    EditJournal(EditJournal&&) = delete;
+    auto operator=(EditJournal&&) -> EditJournal& = delete;
+
+    [[nodiscard]] static auto journal_path(const std::filesystem::path& document)
+        -> std::filesystem::path;
+
+    /// Whether `document` has a journal that edits can be appended to.
+    [[nodiscard]] auto is_open(const std::filesystem::path& document) const -> bool;
+
+    /// Start a new journal whose edits apply to the file on disk, which
+    /// `base` describes. Replaces any journal `document` had.
+    void start(const std::filesystem::path& document, const JournalBase& base);
+
+    /// Log one edit; ignored unless the journal is open.
+    void append(const std::filesystem::path& document, std::uint64_t version, TextDelta delta);
+
+    /// Replace the journal with the whole current text (and open it).
+    void checkpoint(const std::filesystem::path& document, std::shared_ptr<const std::string> text);
+
+    /// The edits are saved, or abandoned: delete the journal.
+    void discard(const std::filesystem::path& document);
+
+    /// The journal has grown past its document; checkpoint() it.
+    [[nodiscard]] auto needs_checkpoint(const std::filesystem::path& document) const -> bool;
+
+    /// Block until every queued record is written and synced.
+    void flush();
+
+    /// Rebuild the unsaved text of `document` from its journal, replaying
+    /// the edits onto its checkpoint or onto the file on disk (read as the
+    /// editor reads it). Fails if there is no journal, or if the file was
+    /// changed since the journal was started.
+    [[nodiscard]] static auto recover(const std::filesystem::path& document)
+        -> std::expected<RecoveredDocument, std::string>;
+
+    struct Stats
+    {
+        std::size_t records{0};
+        std::size_t checkpoints{0};
+        std::size_t syncs{0};
+        std::uint64_t bytes_written{0};
+    };
+
+    [[nodiscard]] auto stats() const -> Stats;
+
+private:
+    enum class OpKind : std::uint8_t
+    {
+        kStart,
+        kAppend,
+        kCheckpoint,
+        kDiscard,
+    };
+
+    struct Op
+    {
+        OpKind kind{OpKind::kAppend};
+        std::filesystem::path journal;
+        std::uint64_t version{0};
+        JournalBase base{};
+        TextDelta delta{};
+        std::shared_ptr<const std::string> text{};
+    };
+
+    /// What the calling thread knows about an open journal.
+    struct Entry
+    {
+        std::uint64_t version{0};     // Last version logged
+        std::size_t logged_bytes{0};  // Since the base or checkpoint
+        std::size_t compact_bytes{0}; // Checkpoint once logged_bytes passes this
+    };
+
+    struct FileCloser
+    {
+        void operator()(std::FILE* file) const noexcept;
+    };
+    using FileHandle = std::unique_ptr<std::FILE, FileCloser>;
+
+    void enqueue(Op op);
+    void run_writer();
+    void apply(Op& op);
+    void write_record(const std::filesystem::path& journal, std::string_view record);
+    void sync_pending();
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable flushed_cv_;
+    std::unordered_map<std::string, Entry> entries_; // GUARDED_BY(mutex_) By document
+    std::deque<Op> ops_;                             // GUARDED_BY(mutex_)
+    std::uint64_t flush_requested_{0};               // GUARDED_BY(mutex_)
+    std::uint64_t flush_done_{0};                    // GUARDED_BY(mutex_)
+    bool stopping_{false};                           // GUARDED_BY(mutex_)
+    Stats stats_;                                    // GUARDED_BY(mutex_)
+    std::thread writer_;                             // Started on the first write
+
+    // Writer thread only
+    std::unordered_map<std::string, FileHandle> files_; // By journal path
+    std::unordered_set<std::string> unsynced_;
+    std::chrono::steady_clock::time_point last_sync_{};
+    Stats written_; // Copied to stats_ after each batch
+};
+
+} // namespace markamp::core
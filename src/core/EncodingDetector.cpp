@@ -1,16 +1,47 @@
 #include "EncodingDetector.h"
 
+#include <cstdint>
+#include <cstring>
+
 namespace markamp::core
 {
 
 namespace
 {
 
+constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+
+/// Offset of the first byte at or after `from` with the high bit set
+/// (data.size() if none), eight bytes per step.
+auto skip_ascii(std::string_view data, std::size_t from) -> std::size_t
+{
+    while (from + sizeof(uint64_t) <= data.size())
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, data.data() + from, sizeof(word));
+        if ((word & kHighBits) != 0)
+        {
+            break;
+        }
+        from += sizeof(word);
+    }
+    while (from < data.size() && static_cast<unsigned char>(data[from]) <= 0x7F)
+    {
+        ++from;
+    }
+    return from;
+}
+
 auto is_valid_utf8(std::string_view data) -> bool
 {
     std::size_t i = 0;
     while (i < data.size())
     {
+        i = skip_ascii(data, i);
+        if (i >= data.size())
+        {
+            break;
+        }
         auto byte = static_cast<unsigned char>(data[i]);
 
         int continuation_bytes = 0;
@@ -58,15 +89,67 @@ auto is_valid_utf8(std::string_view data) -> bool
 
 auto is_ascii_only(std::string_view data) -> bool
 {
-    for (char ch : data)
+    return skip_ascii(data, 0) == data.size();
+}
+
+void append_utf8(std::string& out, uint32_t code_point)
+{
+    if (code_point < 0x80)
+    {
+        out += static_cast<char>(code_point);
+    }
+    else if (code_point < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else if (code_point < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+auto utf16_to_utf8(std::string_view data, bool big_endian) -> std::string
+{
+    constexpr uint32_t kReplacement = 0xFFFD;
+    std::string out;
+    out.reserve(data.size() / 2 + data.size() / 8);
+    auto unit_at = [&data, big_endian](std::size_t offset) -> uint32_t
+    {
+        const auto first = static_cast<unsigned char>(data[offset]);
+        const auto second = static_cast<unsigned char>(data[offset + 1]);
+        return big_endian ? ((uint32_t{first} << 8) | second) : ((uint32_t{second} << 8) | first);
+    };
+    std::size_t offset = 0;
+    for (; offset + 1 < data.size(); offset += 2)
     {
-        auto byte = static_cast<unsigned char>(ch);
-        if (byte > 0x7F)
+        const uint32_t unit = unit_at(offset);
+        if (unit >= 0xD800 && unit <= 0xDBFF && offset + 3 < data.size())
         {
-            return false;
+            const uint32_t low = unit_at(offset + 2);
+            if (low >= 0xDC00 && low <= 0xDFFF)
+            {
+                append_utf8(out, 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00));
+                offset += 2;
+                continue;
+            }
         }
+        append_utf8(out, (unit >= 0xD800 && unit <= 0xDFFF) ? kReplacement : unit);
     }
-    return true;
+    if (offset < data.size())
+    {
+        append_utf8(out, kReplacement); // Odd trailing byte
+    }
+    return out;
 }
 
 } // anonymous namespace
@@ -128,6 +211,47 @@ auto strip_bom(const std::string& content, Encoding enc) -> std::string
     return content;
 }
 
+auto bom_length(std::string_view raw_bytes, Encoding enc) -> std::size_t
+{
+    std::size_t length = 0;
+    if (enc == Encoding::Utf8Bom)
+    {
+        length = 3;
+    }
+    else if (enc == Encoding::Utf16LE || enc == Encoding::Utf16BE)
+    {
+        length = 2;
+    }
+    return raw_bytes.size() >= length ? length : 0;
+}
+
+auto to_utf8(std::string_view text, Encoding enc) -> std::string
+{
+    switch (enc)
+    {
+        case Encoding::Utf16LE:
+            return utf16_to_utf8(text, false);
+        case Encoding::Utf16BE:
+            return utf16_to_utf8(text, true);
+        case Encoding::Unknown:
+        {
+            // Not UTF-8: read it as Latin-1, which maps every byte
+            std::string out;
+            out.reserve(text.size() + text.size() / 4);
+            for (const char character : text)
+            {
+                append_utf8(out, static_cast<unsigned char>(character));
+            }
+            return out;
+        }
+        case Encoding::Utf8:
+        case Encoding::Utf8Bom:
+        case Encoding::Ascii:
+            break;
+    }
+    return std::string(text);
+}
+
 auto encoding_display_name(Encoding enc) -> std::string
 {
     switch (enc)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 
@@ -28,6 +29,15 @@ struct DetectedEncoding
 /// Strip BOM prefix from content if present.
 [[nodiscard]] auto strip_bom(const std::string& content, Encoding enc) -> std::string;
 
+/// Length of the BOM that starts `raw_bytes` for `enc` (0 if none), so
+/// callers can skip it without copying.
+[[nodiscard]] auto bom_length(std::string_view raw_bytes, Encoding enc) -> std::size_t;
+
+/// Convert text (BOM already removed) to UTF-8. UTF-16 is decoded, with
+/// U+FFFD for unpaired surrogates; Unknown is read as Latin-1. UTF-8 and
+/// ASCII are returned unchanged.
+[[nodiscard]] auto to_utf8(std::string_view text, Encoding enc) -> std::string;
+
 /// Get display name for an encoding.
 [[nodiscard]] auto encoding_display_name(Encoding enc) -> std::string;
 
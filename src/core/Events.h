@@ -1,7 +1,11 @@
 #pragma once
 
+#include "DocumentSnapshot.h"
 #include "EventBus.h"
+#include "FileChange.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -76,6 +80,11 @@ MARKAMP_DECLARE_EVENT_WITH_FIELDS(ActiveFileChangedEvent)
 std::string file_id;
 MARKAMP_DECLARE_EVENT_END;
 
+/// Batched, coalesced changes below watched directories (FileWatcherService).
+MARKAMP_DECLARE_EVENT_WITH_FIELDS(FileSystemChangedEvent)
+std::vector<FileChange> changes; // At most one per path, in the order first seen
+MARKAMP_DECLARE_EVENT_END;
+
 // ============================================================================
 // View events
 // ============================================================================
@@ -118,8 +127,28 @@ int column;
 int selection_length{0};
 MARKAMP_DECLARE_EVENT_END;
 
+// Published after edits settle. Describes the change as deltas rather than
+// carrying the document; subscribers that need the text pull it from
+// `snapshot` (materialised once, shared by everyone who asks).
 MARKAMP_DECLARE_EVENT_WITH_FIELDS(EditorContentChangedEvent)
-std::string content;
+uint64_t version{0};            // Document version after all deltas are applied
+std::vector<TextDelta> deltas;  // Edits since the previous event, in order
+bool full_replace{false};       // Deltas omitted (load, tab switch, very large batch)
+std::shared_ptr<const LazyDocumentSnapshot> snapshot;
+
+/// Document text at `version`, or nullptr if it was superseded before
+/// anyone pulled it (a newer event follows).
+[[nodiscard]] auto content() const -> std::shared_ptr<const std::string>
+{
+    return snapshot ? snapshot->content() : nullptr;
+}
+MARKAMP_DECLARE_EVENT_END;
+
+// Published synchronously for every user edit (not for loads or content
+// replacement), before any debouncing; for the crash journal.
+MARKAMP_DECLARE_EVENT_WITH_FIELDS(EditorTextEditedEvent)
+uint64_t version{0}; // Document version after this edit
+TextDelta delta;
 MARKAMP_DECLARE_EVENT_END;
 
 MARKAMP_DECLARE_EVENT_WITH_FIELDS(EditorStatsChangedEvent)
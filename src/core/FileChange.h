@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+namespace markamp::core
+{
+
+enum class FileChangeKind
+{
+    Created,
+    Modified,
+    Deleted,
+    Renamed
+};
+
+/// One change to an entry below a watched directory.
+struct FileChange
+{
+    FileChangeKind kind{FileChangeKind::Modified};
+    std::string path;     // The entry; its new path for renames
+    std::string old_path; // Renames only
+    bool is_directory{false};
+};
+
+} // namespace markamp::core
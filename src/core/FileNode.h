@@ -22,6 +22,7 @@ struct FileNode
     std::vector<FileNode> children;     // Only for folders
     bool is_open{false};                // Folder toggle state
     bool filter_visible{true};          // Sidebar filter visibility
+    bool children_loaded{true};         // False until a lazily scanned folder is listed
 
     // Helpers
     [[nodiscard]] auto is_folder() const -> bool;
@@ -33,4 +34,12 @@ struct FileNode
     [[nodiscard]] auto extension() const -> std::string;
 };
 
+/// The immediate children of one folder, as produced by a directory scan:
+/// folders first, then files, each group sorted case-insensitively.
+struct DirectoryListing
+{
+    std::string path; // Id of the folder listed
+    std::vector<FileNode> children;
+};
+
 } // namespace markamp::core
@@ -1,5 +1,7 @@
 #include "FileSystem.h"
 
+#include "Events.h"
+#include "FileWatcher.h"
 #include "Logger.h"
 
 #include <wx/dirdlg.h>
@@ -29,10 +31,10 @@ const std::set<std::string> FileSystem::kExcludedDirectories = {"node_modules",
 
 // ── Constructor / Destructor ──
 
-FileSystem::FileSystem(EventBus& event_bus)
+FileSystem::FileSystem(EventBus& event_bus, FileWatcherService* file_watcher)
     : event_bus_(event_bus)
+    , file_watcher_(file_watcher)
 {
-    (void)event_bus_; // Will be used for file events in later phases
 }
 
 FileSystem::~FileSystem() = default;
@@ -163,26 +165,53 @@ auto FileSystem::list_directory(const std::filesystem::path& path)
 auto FileSystem::watch_file(const std::filesystem::path& path, std::function<void()> callback)
     -> Subscription
 {
-    std::filesystem::file_time_type mtime{};
-    try
+    if (file_watcher_ == nullptr)
     {
-        if (std::filesystem::exists(path))
-        {
-            mtime = std::filesystem::last_write_time(path);
-        }
+        MARKAMP_LOG_WARN("Cannot watch {}: no file watcher service", path.string());
+        return {};
     }
-    catch (const std::exception&)
+
+    std::error_code error;
+    const auto absolute = std::filesystem::absolute(path, error).lexically_normal();
+    if (error)
     {
-        // File may not exist yet, that's fine
+        MARKAMP_LOG_WARN("Cannot watch {}: {}", path.string(), error.message());
+        return {};
     }
 
-    auto id = next_watch_id_++;
-    watch_entries_.push_back({path, mtime, std::move(callback), id});
+    // Watch the folder rather than the file: saving through a temporary
+    // file and a rename replaces the file, which would end a watch on it
+    auto folder_watch = file_watcher_->watch(absolute.parent_path(), false);
+    if (!folder_watch)
+    {
+        MARKAMP_LOG_WARN("Cannot watch {}: {}", path.string(), folder_watch.error());
+        return {};
+    }
 
-    // Return a subscription that removes the watch when destroyed
+    auto changes = event_bus_.subscribe<events::FileSystemChangedEvent>(
+        [target = absolute.string(),
+         callback = std::move(callback)](const events::FileSystemChangedEvent& event)
+        {
+            const bool touched = std::any_of(event.changes.begin(),
+                                             event.changes.end(),
+                                             [&target](const FileChange& change) {
+                                                 return change.path == target &&
+                                                        change.kind != FileChangeKind::Deleted;
+                                             });
+            if (touched)
+            {
+                callback();
+            }
+        });
+
+    // Subscription takes a copyable function; share the two tokens
+    auto tokens = std::make_shared<std::pair<Subscription, Subscription>>(
+        std::move(*folder_watch), std::move(changes));
     return Subscription(
-        [this, id]() {
-            std::erase_if(watch_entries_, [id](const WatchEntry& entry) { return entry.id == id; });
+        [tokens]()
+        {
+            tokens->second.cancel();
+            tokens->first.cancel();
         });
 }
 
@@ -6,6 +6,7 @@
 #include "IFileSystem.h"
 
 #include <filesystem>
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -18,13 +19,18 @@ class wxTimerEvent;
 namespace markamp::core
 {
 
+class FileWatcherService;
+
 /// Concrete file system implementation.
 /// Reads/writes files from disk, scans directories to FileNode trees,
-/// tracks file watches via polling timer.
+/// watches files through the app's event-driven FileWatcherService.
 class FileSystem : public IFileSystem
 {
 public:
-    explicit FileSystem(EventBus& event_bus);
+    /// `file_watcher` is the app's watcher service, shared so that a change
+    /// is published once however many parts of the app watch its folder.
+    /// Without one, watch_file() cannot watch.
+    explicit FileSystem(EventBus& event_bus, FileWatcherService* file_watcher = nullptr);
     ~FileSystem() override;
 
     // ── IFileSystem interface ──
@@ -70,17 +76,8 @@ public:
 private:
     EventBus& event_bus_;
 
-    // ── File watching ──
-    struct WatchEntry
-    {
-        std::filesystem::path path;
-        std::filesystem::file_time_type last_modified;
-        std::function<void()> callback;
-        std::size_t id{0};
-    };
-
-    std::vector<WatchEntry> watch_entries_;
-    std::size_t next_watch_id_{1};
+    // ── File watching ── (not owned)
+    FileWatcherService* file_watcher_{nullptr};
 
     // Directory scan helper
     void scan_recursive(const std::filesystem::path& dir_path,
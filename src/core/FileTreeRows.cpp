@@ -0,0 +1,193 @@
+#include "FileTreeRows.h"
+
+#include <utility>
+
+namespace markamp::core
+{
+
+namespace
+{
+
+void flatten_children(std::vector<FileNode>& nodes,
+                      int depth,
+                      std::vector<FileTreeRow>& rows,
+                      std::vector<FileNode*>* unloaded_open)
+{
+    for (auto& node : nodes)
+    {
+        if (!node.filter_visible)
+        {
+            continue;
+        }
+        rows.push_back({&node, depth, FileTreeRowKind::Node});
+        if (!node.is_folder() || !node.is_open)
+        {
+            continue;
+        }
+
+        if (!node.children_loaded)
+        {
+            rows.push_back({&node, depth + 1, FileTreeRowKind::Loading});
+            if (unloaded_open != nullptr)
+            {
+                unloaded_open->push_back(&node);
+            }
+            continue;
+        }
+
+        const auto before = rows.size();
+        flatten_children(node.children, depth + 1, rows, unloaded_open);
+        if (rows.size() == before)
+        {
+            rows.push_back({&node, depth + 1, FileTreeRowKind::Empty});
+        }
+    }
+}
+
+} // anonymous namespace
+
+void flatten_file_tree(std::vector<FileNode>& roots,
+                       std::vector<FileTreeRow>& rows,
+                       std::vector<FileNode*>* unloaded_open)
+{
+    rows.clear();
+    flatten_children(roots, 0, rows, unloaded_open);
+}
+
+void index_file_tree(std::vector<FileNode>& nodes, FileNodeIndex& index)
+{
+    for (auto& node : nodes)
+    {
+        index[node.id] = &node;
+        if (node.is_folder())
+        {
+            index_file_tree(node.children, index);
+        }
+    }
+}
+
+void merge_file_nodes(std::vector<FileNode>& current,
+                      std::vector<FileNode> fresh,
+                      FileNodeIndex& index)
+{
+    std::unordered_map<std::string, FileNode*> previous;
+    previous.reserve(current.size());
+    for (auto& node : current)
+    {
+        previous.emplace(node.id, &node);
+    }
+
+    for (auto& node : fresh)
+    {
+        const auto found = previous.find(node.id);
+        if (found == previous.end())
+        {
+            continue;
+        }
+        FileNode& old = *found->second;
+        if (node.is_folder() && old.is_folder())
+        {
+            // Moving the vector keeps the grandchildren (and their index
+            // entries) where they are
+            node.children = std::move(old.children);
+            node.children_loaded = old.children_loaded;
+            node.is_open = old.is_open;
+            previous.erase(found);
+        }
+    }
+
+    // Whatever is left did not survive: drop it and its subtree
+    FileNodeIndex removed;
+    for (const auto& [id, node] : previous)
+    {
+        removed[id] = node;
+        index_file_tree(node->children, removed);
+    }
+    for (const auto& [id, node] : removed)
+    {
+        const auto entry = index.find(id);
+        if (entry != index.end() && entry->second == node)
+        {
+            index.erase(entry);
+        }
+    }
+
+    current = std::move(fresh);
+    index_file_tree(current, index);
+}
+
+auto apply_directory_listing(FileNodeIndex& index, DirectoryListing& listing) -> bool
+{
+    const auto found = index.find(listing.path);
+    if (found == index.end())
+    {
+        return false;
+    }
+    FileNode& folder = *found->second;
+    if (!folder.is_folder())
+    {
+        return false;
+    }
+    if (!folder.children_loaded)
+    {
+        folder.children = std::move(listing.children);
+        folder.children_loaded = true;
+        index_file_tree(folder.children, index);
+        return true;
+    }
+    merge_file_nodes(folder.children, std::move(listing.children), index);
+    return true;
+}
+
+auto apply_directory_listing(FileNodeIndex& index, DirectoryListing& listing, HeldListings& held)
+    -> bool
+{
+    const auto found = index.find(listing.path);
+    if (found == index.end())
+    {
+        // Its parent's listing has not been applied yet
+        auto path = listing.path;
+        held.insert_or_assign(std::move(path), std::move(listing));
+        return false;
+    }
+    FileNode& folder = *found->second;
+    if (!apply_directory_listing(index, listing))
+    {
+        return false;
+    }
+    apply_held_listings(folder.children, index, held);
+    return true;
+}
+
+auto apply_held_listings(std::vector<FileNode>& nodes, FileNodeIndex& index, HeldListings& held)
+    -> bool
+{
+    bool applied = false;
+    for (auto& node : nodes)
+    {
+        if (held.empty())
+        {
+            break;
+        }
+        if (!node.is_folder())
+        {
+            continue;
+        }
+        const auto found = held.find(node.id);
+        if (found == held.end())
+        {
+            continue;
+        }
+        auto listing = std::move(found->second);
+        held.erase(found);
+        if (apply_directory_listing(index, listing))
+        {
+            // Only the children just listed can have held listings waiting
+            apply_held_listings(node.children, index, held);
+            applied = true;
+        }
+    }
+    return applied;
+}
+
+} // namespace markamp::core
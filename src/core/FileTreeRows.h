@@ -0,0 +1,75 @@
+#pragma once
+
+#include "FileNode.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace markamp::core
+{
+
+enum class FileTreeRowKind
+{
+    Node,
+    Empty,  // Placeholder under an open folder with nothing to show
+    Loading // Placeholder under an open folder whose listing has not arrived
+};
+
+/// One drawn row of the file tree.
+struct FileTreeRow
+{
+    FileNode* node{nullptr}; // The node, or the open folder a placeholder belongs to
+    int depth{0};
+    FileTreeRowKind kind{FileTreeRowKind::Node};
+};
+
+/// Flatten the tree into the rows a tree view draws, top to bottom: nodes
+/// that pass the filter, descending only into open folders. Cost is linear
+/// in the number of rows, not the size of the tree, so a view can rebuild
+/// it on every expand/collapse and then paint and hit-test just the rows
+/// in its viewport by index. Open folders that still need listing are
+/// appended to `unloaded_open` when given.
+void flatten_file_tree(std::vector<FileNode>& roots,
+                       std::vector<FileTreeRow>& rows,
+                       std::vector<FileNode*>* unloaded_open = nullptr);
+
+/// Node id → node. Entries stay valid while the vectors holding the nodes
+/// are not resized or reassigned.
+using FileNodeIndex = std::unordered_map<std::string, FileNode*>;
+
+/// Add `nodes` and all their descendants to `index`.
+void index_file_tree(std::vector<FileNode>& nodes, FileNodeIndex& index);
+
+/// Replace `current` with a fresh listing of the same folder, carrying the
+/// open state and loaded children of folders present in both over, and
+/// keep `index` in step: removed subtrees leave it, new nodes join it.
+void merge_file_nodes(std::vector<FileNode>& current,
+                      std::vector<FileNode> fresh,
+                      FileNodeIndex& index);
+
+/// Give a folder in `index` its listed children and index them. A folder
+/// that is already loaded is re-listed with merge_file_nodes(), so a
+/// refresh after a change on disk keeps what the user had expanded.
+/// Returns false when the folder is unknown.
+auto apply_directory_listing(FileNodeIndex& index, DirectoryListing& listing) -> bool;
+
+/// Listings whose folder was not in the index when they arrived, by folder
+/// id. Scanner workers deliver independently, so a folder's listing can
+/// come in before its parent's.
+using HeldListings = std::unordered_map<std::string, DirectoryListing>;
+
+/// Like apply_directory_listing(), but a listing of an unknown folder is
+/// kept in `held` rather than dropped, and held listings of the folder's
+/// children are applied along with it. Returns false when the listing was
+/// held (or the id names a file).
+auto apply_directory_listing(FileNodeIndex& index, DirectoryListing& listing, HeldListings& held)
+    -> bool;
+
+/// Apply the held listings of folders among `nodes`, then of their children
+/// in turn. Call after adding nodes to the index by other means, such as a
+/// merge_file_nodes() of the top level. Returns true when any was applied.
+auto apply_held_listings(std::vector<FileNode>& nodes, FileNodeIndex& index, HeldListings& held)
+    -> bool;
+
+} // namespace markamp::core
@@ -0,0 +1,979 @@
+#include "FileWatcher.h"
+
+#include "Events.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace markamp::core
+{
+
+namespace
+{
+
+/// Absolute, normalized, without a trailing separator: the form paths are
+/// reported in, so subscribers can compare them as strings.
+auto normalize_directory(const std::filesystem::path& directory) -> std::string
+{
+    std::error_code error;
+    auto absolute = std::filesystem::absolute(directory, error);
+    std::string text = (error ? directory : absolute).lexically_normal().string();
+    while (text.size() > 1 && text.back() == '/')
+    {
+        text.pop_back();
+    }
+    return text;
+}
+
+auto is_within(const std::string& path, const std::string& root) -> bool
+{
+    if (path.size() <= root.size() || path.compare(0, root.size(), root) != 0)
+    {
+        return false;
+    }
+    return root.back() == '/' || path[root.size()] == '/';
+}
+
+auto is_hidden(const std::filesystem::path& path) -> bool
+{
+    const auto name = path.filename().string();
+    return !name.empty() && name[0] == '.';
+}
+
+auto join(const std::string& directory, std::string_view name) -> std::string
+{
+    std::string path = directory;
+    if (path.empty() || path.back() != '/')
+    {
+        path += '/';
+    }
+    path += name;
+    return path;
+}
+
+} // anonymous namespace
+
+// ═══════════════════════════════════════════════════════
+// FileChangeCoalescer
+// ═══════════════════════════════════════════════════════
+
+void FileChangeCoalescer::add(FileChange change)
+{
+    if (change.kind == FileChangeKind::Renamed)
+    {
+        const auto source = by_path_.find(change.old_path);
+        if (source != by_path_.end())
+        {
+            const std::size_t index = source->second;
+            const FileChange& earlier = changes_[index];
+            if (earlier.kind == FileChangeKind::Created)
+            {
+                // Never seen at its old name: just a creation at the new one
+                change.kind = FileChangeKind::Created;
+                change.old_path.clear();
+                drop(index);
+            }
+            else if (earlier.kind == FileChangeKind::Renamed)
+            {
+                change.old_path = earlier.old_path;
+                if (change.old_path == change.path)
+                {
+                    change.kind = FileChangeKind::Modified;
+                    change.old_path.clear();
+                }
+                drop(index);
+            }
+            else if (earlier.kind == FileChangeKind::Modified)
+            {
+                drop(index); // The rename makes readers look at the file anyway
+            }
+        }
+    }
+
+    const auto found = by_path_.find(change.path);
+    if (found == by_path_.end())
+    {
+        push(std::move(change));
+        return;
+    }
+
+    const std::size_t index = found->second;
+    FileChange& earlier = changes_[index];
+    earlier.is_directory = change.is_directory;
+    switch (change.kind)
+    {
+        case FileChangeKind::Modified:
+        case FileChangeKind::Created:
+            if (earlier.kind == FileChangeKind::Deleted)
+            {
+                earlier.kind = FileChangeKind::Modified;
+            }
+            break;
+        case FileChangeKind::Deleted:
+            if (earlier.kind == FileChangeKind::Created)
+            {
+                drop(index);
+            }
+            else if (earlier.kind == FileChangeKind::Renamed)
+            {
+                // The entry that was renamed here is gone after all
+                std::string original = earlier.old_path;
+                drop(index);
+                add({FileChangeKind::Deleted, std::move(original), {}, change.is_directory});
+            }
+            else
+            {
+                earlier.kind = FileChangeKind::Deleted;
+            }
+            break;
+        case FileChangeKind::Renamed:
+            earlier = std::move(change);
+            break;
+    }
+}
+
+auto FileChangeCoalescer::take() -> std::vector<FileChange>
+{
+    std::vector<FileChange> result;
+    result.reserve(live_);
+    for (auto& change : changes_)
+    {
+        if (!change.path.empty())
+        {
+            result.push_back(std::move(change));
+        }
+    }
+    changes_.clear();
+    by_path_.clear();
+    live_ = 0;
+    return result;
+}
+
+void FileChangeCoalescer::push(FileChange change)
+{
+    by_path_[change.path] = changes_.size();
+    changes_.push_back(std::move(change));
+    ++live_;
+}
+
+void FileChangeCoalescer::drop(std::size_t index)
+{
+    by_path_.erase(changes_[index].path);
+    changes_[index].path.clear();
+    --live_;
+}
+
+// ═══════════════════════════════════════════════════════
+// inotify backend
+// ═══════════════════════════════════════════════════════
+
+#if defined(__linux__)
+
+namespace
+{
+
+class InotifyWatcherBackend final : public IFileWatcherBackend
+{
+public:
+    InotifyWatcherBackend(int inotify_fd, int wake_fd)
+        : inotify_fd_(inotify_fd)
+        , wake_fd_(wake_fd)
+    {
+    }
+
+    ~InotifyWatcherBackend() override
+    {
+        ::close(inotify_fd_);
+        ::close(wake_fd_);
+    }
+
+    InotifyWatcherBackend(const InotifyWatcherBackend&) = delete;
+    auto operator=(const InotifyWatcherBackend&) -> InotifyWatcherBackend& = delete;
+    InotifyWatcherBackend(InotifyWatcherBackend&&) = delete;
+    auto operator=(InotifyWatcherBackend&&) -> InotifyWatcherBackend& = delete;
+
+    [[nodiscard]] auto add_watch(const std::filesystem::path& directory, bool recursive)
+        -> std::expected<void, std::string> override
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(directory, error))
+        {
+            return std::unexpected("Not a directory: " + directory.string());
+        }
+        const std::string root = normalize_directory(directory);
+        const int wd = ::inotify_add_watch(inotify_fd_, root.c_str(), kMask);
+        if (wd < 0)
+        {
+            return std::unexpected("inotify_add_watch failed for " + root + ": " +
+                                   std::strerror(errno));
+        }
+
+        const std::lock_guard lock(mutex_);
+        record_watch(wd, root);
+        auto& root_recursive = roots_[root];
+        root_recursive = root_recursive || recursive;
+        if (recursive)
+        {
+            // Walking a big workspace takes a while: leave it to wait()
+            pending_trees_.push_back(root);
+            interrupt();
+        }
+        return {};
+    }
+
+    void remove_watch(const std::filesystem::path& directory) override
+    {
+        const std::string root = normalize_directory(directory);
+        const std::lock_guard lock(mutex_);
+        roots_.erase(root);
+        std::vector<std::string> uncovered;
+        for (const auto& [path, wd] : path_wds_)
+        {
+            if (!is_covered(path))
+            {
+                uncovered.push_back(path);
+            }
+        }
+        for (const auto& path : uncovered)
+        {
+            remove_directory(path);
+        }
+    }
+
+    void wait(std::chrono::milliseconds timeout, std::vector<FileChange>& out) override
+    {
+        add_pending_trees();
+        std::array<pollfd, 2> fds{{{inotify_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}}};
+        const int timeout_ms = timeout.count() < 0 ? -1 : static_cast<int>(timeout.count());
+        if (::poll(fds.data(), fds.size(), timeout_ms) <= 0)
+        {
+            return;
+        }
+        if ((fds[1].revents & POLLIN) != 0)
+        {
+            std::uint64_t count = 0;
+            [[maybe_unused]] const auto ignored = ::read(wake_fd_, &count, sizeof(count));
+            add_pending_trees();
+        }
+        if ((fds[0].revents & POLLIN) != 0)
+        {
+            drain(out);
+        }
+    }
+
+    void interrupt() override
+    {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const auto ignored = ::write(wake_fd_, &one, sizeof(one));
+    }
+
+private:
+    static constexpr std::uint32_t kMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB |
+                                           IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+    struct PendingMove
+    {
+        std::string path;
+        bool is_directory{false};
+    };
+
+    int inotify_fd_;
+    int wake_fd_;
+
+    std::mutex mutex_;
+    std::unordered_map<int, std::string> wd_paths_;  // GUARDED_BY(mutex_)
+    std::unordered_map<std::string, int> path_wds_;  // GUARDED_BY(mutex_)
+    std::map<std::string, bool> roots_;              // GUARDED_BY(mutex_) root → recursive
+    std::vector<std::string> pending_trees_;         // GUARDED_BY(mutex_) roots to walk
+
+    // Only touched by wait()
+    std::unordered_map<std::uint32_t, PendingMove> moves_;
+    std::vector<std::string> new_trees_; // Folders created or moved in, to watch
+
+    /// Watches made by a walk are published under mutex_ this many at a
+    /// time, so add_watch() and remove_watch() never wait for a whole tree.
+    static constexpr std::size_t kPublishBatch = 256;
+
+    void add_pending_trees()
+    {
+        std::vector<std::string> roots;
+        {
+            const std::lock_guard lock(mutex_);
+            for (auto& root : std::exchange(pending_trees_, {}))
+            {
+                const auto found = roots_.find(root);
+                if (found != roots_.end() && found->second)
+                {
+                    roots.push_back(std::move(root));
+                }
+            }
+        }
+        for (const auto& root : roots)
+        {
+            add_tree(root, false, nullptr);
+        }
+    }
+
+    void record_watch(int wd, const std::string& directory)
+    {
+        wd_paths_[wd] = directory;
+        path_wds_[directory] = wd;
+    }
+
+    /// Publish watches added outside the lock. A tree whose root was
+    /// unwatched while it was being walked is dropped again.
+    void publish_watches(std::vector<std::pair<int, std::string>>& batch)
+    {
+        const std::lock_guard lock(mutex_);
+        for (const auto& [wd, path] : batch)
+        {
+            if (is_covered(path))
+            {
+                record_watch(wd, path);
+            }
+            else if (!path_wds_.contains(path))
+            {
+                ::inotify_rm_watch(inotify_fd_, wd);
+            }
+        }
+        batch.clear();
+    }
+
+    void remove_directory(const std::string& directory)
+    {
+        const auto found = path_wds_.find(directory);
+        if (found == path_wds_.end())
+        {
+            return;
+        }
+        ::inotify_rm_watch(inotify_fd_, found->second);
+        wd_paths_.erase(found->second);
+        path_wds_.erase(found);
+    }
+
+    /// Watch every non-hidden folder below `root` (and `root` itself with
+    /// `include_root`). With `created`, also report everything found as
+    /// created: entries made in a new folder before its watch was in place
+    /// would otherwise go unnoticed. Runs without mutex_ held; the watches
+    /// are published in batches of kPublishBatch.
+    void add_tree(const std::string& root, bool include_root, std::vector<FileChange>* created)
+    {
+        namespace fs = std::filesystem;
+        std::vector<std::pair<int, std::string>> batch;
+        bool warned = false;
+        auto watch = [&](const std::string& path)
+        {
+            const int wd = ::inotify_add_watch(inotify_fd_, path.c_str(), kMask);
+            if (wd < 0)
+            {
+                if (!warned)
+                {
+                    // Typically ENOSPC: fs.inotify.max_user_watches is exhausted
+                    MARKAMP_LOG_WARN("Cannot watch {}: {}", path, std::strerror(errno));
+                    warned = true;
+                }
+                return;
+            }
+            batch.emplace_back(wd, path);
+            if (batch.size() >= kPublishBatch)
+            {
+                publish_watches(batch);
+            }
+        };
+
+        if (include_root)
+        {
+            watch(root);
+        }
+        std::error_code error;
+        fs::recursive_directory_iterator iter(root, fs::directory_options::skip_permission_denied,
+                                              error);
+        for (const fs::recursive_directory_iterator end; !error && iter != end;
+             iter.increment(error))
+        {
+            std::error_code type_error;
+            const bool is_directory = iter->is_directory(type_error) && !iter->is_symlink();
+            if (is_directory && is_hidden(iter->path()))
+            {
+                iter.disable_recursion_pending();
+                continue;
+            }
+            const std::string path = iter->path().string();
+            if (created != nullptr)
+            {
+                created->push_back({FileChangeKind::Created, path, {}, is_directory});
+            }
+            if (is_directory)
+            {
+                watch(path);
+            }
+        }
+        publish_watches(batch);
+    }
+
+    /// Re-key the watches of a renamed folder and everything below it.
+    void rename_tree(const std::string& from, const std::string& to)
+    {
+        std::vector<std::pair<std::string, int>> moved;
+        for (const auto& [path, wd] : path_wds_)
+        {
+            if (path == from || is_within(path, from))
+            {
+                moved.emplace_back(path, wd);
+            }
+        }
+        for (const auto& [path, wd] : moved)
+        {
+            std::string renamed = to + path.substr(from.size());
+            path_wds_.erase(path);
+            path_wds_[renamed] = wd;
+            wd_paths_[wd] = std::move(renamed);
+        }
+    }
+
+    void remove_tree(const std::string& directory)
+    {
+        std::vector<std::string> removed;
+        for (const auto& [path, wd] : path_wds_)
+        {
+            if ((path == directory || is_within(path, directory)) && !roots_.contains(path))
+            {
+                removed.push_back(path);
+            }
+        }
+        for (const auto& path : removed)
+        {
+            remove_directory(path);
+        }
+    }
+
+    [[nodiscard]] auto is_covered(const std::string& path) const -> bool
+    {
+        return std::any_of(roots_.begin(),
+                           roots_.end(),
+                           [&path](const auto& root)
+                           {
+                               return path == root.first ||
+                                      (root.second && is_within(path, root.first));
+                           });
+    }
+
+    /// True when a folder at `path` should get watches of its own.
+    [[nodiscard]] auto is_watched_recursively(const std::string& path) const -> bool
+    {
+        if (is_hidden(path))
+        {
+            return false;
+        }
+        return std::any_of(roots_.begin(),
+                           roots_.end(),
+                           [&path](const auto& root)
+                           { return root.second && is_within(path, root.first); });
+    }
+
+    void drain(std::vector<FileChange>& out)
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            drain_events(out);
+        }
+
+        // New folders are walked without the lock; their events queue up
+        // in the kernel until the next drain, after the watches are known
+        for (const auto& path : std::exchange(new_trees_, {}))
+        {
+            add_tree(path, true, &out);
+        }
+    }
+
+    void drain_events(std::vector<FileChange>& out)
+    {
+        alignas(inotify_event) std::array<char, 64 * 1024> buffer{};
+        while (true)
+        {
+            const auto length = ::read(inotify_fd_, buffer.data(), buffer.size());
+            if (length <= 0)
+            {
+                break; // EAGAIN: drained
+            }
+            for (std::size_t offset = 0; offset < static_cast<std::size_t>(length);)
+            {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+                offset += sizeof(inotify_event) + event->len;
+                handle(*event, out);
+            }
+        }
+
+        // A move whose other half never arrived crossed the watched trees
+        for (auto& [cookie, move] : moves_)
+        {
+            if (move.is_directory)
+            {
+                remove_tree(move.path);
+            }
+            out.push_back({FileChangeKind::Deleted, std::move(move.path), {}, move.is_directory});
+        }
+        moves_.clear();
+    }
+
+    void handle(const inotify_event& event, std::vector<FileChange>& out)
+    {
+        if ((event.mask & IN_Q_OVERFLOW) != 0)
+        {
+            // Events were lost: ask for a re-list of everything watched
+            MARKAMP_LOG_WARN("inotify queue overflowed; reporting watched roots as modified");
+            for (const auto& [root, recursive] : roots_)
+            {
+                out.push_back({FileChangeKind::Modified, root, {}, true});
+            }
+            return;
+        }
+        const auto directory = wd_paths_.find(event.wd);
+        if (directory == wd_paths_.end())
+        {
+            return;
+        }
+        if ((event.mask & IN_IGNORED) != 0)
+        {
+            path_wds_.erase(directory->second);
+            wd_paths_.erase(directory);
+            return;
+        }
+        if (event.len == 0)
+        {
+            return; // About the watched folder itself; its parent reports it
+        }
+
+        std::string path = join(directory->second, event.name);
+        const bool is_directory = (event.mask & IN_ISDIR) != 0;
+
+        if ((event.mask & IN_CREATE) != 0)
+        {
+            out.push_back({FileChangeKind::Created, path, {}, is_directory});
+            if (is_directory && is_watched_recursively(path))
+            {
+                new_trees_.push_back(std::move(path));
+            }
+        }
+        else if ((event.mask & IN_DELETE) != 0)
+        {
+            out.push_back({FileChangeKind::Deleted, std::move(path), {}, is_directory});
+        }
+        else if ((event.mask & (IN_MODIFY | IN_ATTRIB)) != 0)
+        {
+            out.push_back({FileChangeKind::Modified, std::move(path), {}, is_directory});
+        }
+        else if ((event.mask & IN_MOVED_FROM) != 0)
+        {
+            moves_[event.cookie] = PendingMove{std::move(path), is_directory};
+        }
+        else if ((event.mask & IN_MOVED_TO) != 0)
+        {
+            handle_moved_to(event.cookie, std::move(path), is_directory, out);
+        }
+    }
+
+    void handle_moved_to(std::uint32_t cookie,
+                         std::string path,
+                         bool is_directory,
+                         std::vector<FileChange>& out)
+    {
+        const auto source = moves_.find(cookie);
+        if (source == moves_.end())
+        {
+            // Moved in from outside the watched trees
+            out.push_back({FileChangeKind::Created, path, {}, is_directory});
+            if (is_directory && is_watched_recursively(path))
+            {
+                new_trees_.push_back(std::move(path));
+            }
+            return;
+        }
+
+        std::string old_path = std::move(source->second.path);
+        moves_.erase(source);
+        if (is_directory)
+        {
+            rename_tree(old_path, path);
+            if (!is_watched_recursively(path))
+            {
+                remove_tree(path);
+            }
+            else if (!path_wds_.contains(path))
+            {
+                new_trees_.push_back(path);
+            }
+        }
+        out.push_back(
+            {FileChangeKind::Renamed, std::move(path), std::move(old_path), is_directory});
+    }
+};
+
+} // anonymous namespace
+
+auto make_inotify_watcher_backend() -> std::unique_ptr<IFileWatcherBackend>
+{
+    const int inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0)
+    {
+        MARKAMP_LOG_WARN("inotify unavailable: {}", std::strerror(errno));
+        return nullptr;
+    }
+    const int wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd < 0)
+    {
+        ::close(inotify_fd);
+        return nullptr;
+    }
+    return std::make_unique<InotifyWatcherBackend>(inotify_fd, wake_fd);
+}
+
+#else
+
+auto make_inotify_watcher_backend() -> std::unique_ptr<IFileWatcherBackend>
+{
+    return nullptr;
+}
+
+#endif
+
+// ═══════════════════════════════════════════════════════
+// Polling backend
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+
+class PollingWatcherBackend final : public IFileWatcherBackend
+{
+public:
+    explicit PollingWatcherBackend(std::chrono::milliseconds interval)
+        : interval_(interval)
+        , next_poll_(std::chrono::steady_clock::now() + interval)
+    {
+    }
+
+    [[nodiscard]] auto add_watch(const std::filesystem::path& directory, bool recursive)
+        -> std::expected<void, std::string> override
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(directory, error))
+        {
+            return std::unexpected("Not a directory: " + directory.string());
+        }
+        const std::string root = normalize_directory(directory);
+        auto snapshot = take_snapshot(root, recursive);
+
+        const std::lock_guard lock(mutex_);
+        auto& watched = roots_[root];
+        watched.recursive = watched.recursive || recursive;
+        watched.snapshot = std::move(snapshot);
+        return {};
+    }
+
+    void remove_watch(const std::filesystem::path& directory) override
+    {
+        const std::string root = normalize_directory(directory);
+        const std::lock_guard lock(mutex_);
+        roots_.erase(root);
+    }
+
+    void wait(std::chrono::milliseconds timeout, std::vector<FileChange>& out) override
+    {
+        const auto now = std::chrono::steady_clock::now();
+        std::unique_lock lock(mutex_);
+        auto deadline = next_poll_;
+        if (timeout.count() >= 0)
+        {
+            deadline = std::min(deadline, now + timeout);
+        }
+        cv_.wait_until(lock, deadline, [this] { return interrupted_; });
+        if (std::exchange(interrupted_, false) || std::chrono::steady_clock::now() < next_poll_)
+        {
+            return;
+        }
+
+        std::vector<std::pair<std::string, bool>> roots;
+        for (const auto& [root, watched] : roots_)
+        {
+            roots.emplace_back(root, watched.recursive);
+        }
+        lock.unlock();
+
+        std::vector<std::pair<std::string, Snapshot>> snapshots;
+        for (const auto& [root, recursive] : roots)
+        {
+            snapshots.emplace_back(root, take_snapshot(root, recursive));
+        }
+
+        lock.lock();
+        for (auto& [root, snapshot] : snapshots)
+        {
+            const auto watched = roots_.find(root);
+            if (watched != roots_.end())
+            {
+                diff(watched->second.snapshot, snapshot, out);
+                watched->second.snapshot = std::move(snapshot);
+            }
+        }
+        next_poll_ = std::chrono::steady_clock::now() + interval_;
+    }
+
+    void interrupt() override
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            interrupted_ = true;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    struct Entry
+    {
+        std::filesystem::file_time_type mtime{};
+        std::uintmax_t size{0};
+        bool is_directory{false};
+    };
+    using Snapshot = std::map<std::string, Entry>;
+
+    struct Root
+    {
+        bool recursive{false};
+        Snapshot snapshot;
+    };
+
+    std::chrono::milliseconds interval_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool interrupted_{false};                        // GUARDED_BY(mutex_)
+    std::chrono::steady_clock::time_point next_poll_; // GUARDED_BY(mutex_)
+    std::map<std::string, Root> roots_;              // GUARDED_BY(mutex_)
+
+    static auto take_snapshot(const std::string& root, bool recursive) -> Snapshot
+    {
+        namespace fs = std::filesystem;
+        Snapshot snapshot;
+        auto record = [&snapshot](const fs::directory_entry& entry)
+        {
+            std::error_code error;
+            Entry info;
+            info.is_directory = entry.is_directory(error);
+            info.mtime = entry.last_write_time(error);
+            info.size = info.is_directory ? 0 : entry.file_size(error);
+            snapshot.emplace(entry.path().string(), info);
+            return info.is_directory;
+        };
+
+        std::error_code error;
+        if (!recursive)
+        {
+            fs::directory_iterator iter(root, fs::directory_options::skip_permission_denied, error);
+            for (const fs::directory_iterator end; !error && iter != end; iter.increment(error))
+            {
+                record(*iter);
+            }
+            return snapshot;
+        }
+        fs::recursive_directory_iterator iter(root, fs::directory_options::skip_permission_denied,
+                                              error);
+        for (const fs::recursive_directory_iterator end; !error && iter != end;
+             iter.increment(error))
+        {
+            if (record(*iter) && is_hidden(iter->path()))
+            {
+                iter.disable_recursion_pending();
+            }
+        }
+        return snapshot;
+    }
+
+    static void diff(const Snapshot& before, const Snapshot& after, std::vector<FileChange>& out)
+    {
+        for (const auto& [path, entry] : after)
+        {
+            const auto old = before.find(path);
+            if (old == before.end())
+            {
+                out.push_back({FileChangeKind::Created, path, {}, entry.is_directory});
+            }
+            else if (!entry.is_directory &&
+                     (old->second.mtime != entry.mtime || old->second.size != entry.size))
+            {
+                out.push_back({FileChangeKind::Modified, path, {}, false});
+            }
+        }
+        for (const auto& [path, entry] : before)
+        {
+            if (!after.contains(path))
+            {
+                out.push_back({FileChangeKind::Deleted, path, {}, entry.is_directory});
+            }
+        }
+    }
+};
+
+} // anonymous namespace
+
+auto make_polling_watcher_backend(std::chrono::milliseconds interval)
+    -> std::unique_ptr<IFileWatcherBackend>
+{
+    return std::make_unique<PollingWatcherBackend>(interval);
+}
+
+auto make_file_watcher_backend() -> std::unique_ptr<IFileWatcherBackend>
+{
+    if (auto native = make_inotify_watcher_backend())
+    {
+        return native;
+    }
+    constexpr std::chrono::milliseconds kPollInterval{2000};
+    return make_polling_watcher_backend(kPollInterval);
+}
+
+// ═══════════════════════════════════════════════════════
+// FileWatcherService
+// ═══════════════════════════════════════════════════════
+
+FileWatcherService::FileWatcherService(EventBus& event_bus,
+                                       std::unique_ptr<IFileWatcherBackend> backend,
+                                       std::chrono::milliseconds debounce)
+    : event_bus_(event_bus)
+    , backend_(std::move(backend))
+    , debounce_(debounce)
+{
+    thread_ = std::thread([this]() { run(); });
+}
+
+FileWatcherService::~FileWatcherService()
+{
+    stopping_.store(true, std::memory_order_release);
+    backend_->interrupt();
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+auto FileWatcherService::watch(const std::filesystem::path& directory, bool recursive)
+    -> std::expected<Subscription, std::string>
+{
+    auto key = std::make_pair(normalize_directory(directory), recursive);
+    {
+        const std::lock_guard lock(watch_mutex_);
+        auto& count = watch_counts_[key];
+        if (count == 0)
+        {
+            auto added = backend_->add_watch(key.first, recursive);
+            if (!added)
+            {
+                watch_counts_.erase(key);
+                return std::unexpected(added.error());
+            }
+        }
+        ++count;
+    }
+    return Subscription([this, key = std::move(key)]() { unwatch(key); });
+}
+
+void FileWatcherService::set_wake_callback(std::function<void()> callback)
+{
+    const std::lock_guard lock(wake_mutex_);
+    wake_callback_ = std::move(callback);
+}
+
+void FileWatcherService::unwatch(const std::pair<std::string, bool>& key)
+{
+    const std::lock_guard lock(watch_mutex_);
+    const auto found = watch_counts_.find(key);
+    if (found == watch_counts_.end() || --found->second > 0)
+    {
+        return;
+    }
+    watch_counts_.erase(found);
+    backend_->remove_watch(key.first);
+
+    // The same folder may still be watched with the other recursion mode
+    const auto other = watch_counts_.find({key.first, !key.second});
+    if (other != watch_counts_.end())
+    {
+        [[maybe_unused]] auto restored = backend_->add_watch(key.first, other->first.second);
+    }
+}
+
+void FileWatcherService::run()
+{
+    using clock = std::chrono::steady_clock;
+    std::vector<FileChange> raw;
+    FileChangeCoalescer pending;
+    clock::time_point first_change{};
+    clock::time_point last_change{};
+
+    while (!stopping_.load(std::memory_order_acquire))
+    {
+        // Sleep until the kernel has news unless a burst is being held back
+        std::chrono::milliseconds timeout{-1};
+        if (!pending.empty())
+        {
+            const auto deadline = std::min(last_change + debounce_, first_change + kMaxLatency);
+            timeout = std::max(std::chrono::milliseconds{0},
+                               std::chrono::ceil<std::chrono::milliseconds>(deadline -
+                                                                            clock::now()));
+        }
+        backend_->wait(timeout, raw);
+        if (stopping_.load(std::memory_order_acquire))
+        {
+            break;
+        }
+
+        const auto now = clock::now();
+        if (!raw.empty())
+        {
+            if (pending.empty())
+            {
+                first_change = now;
+            }
+            last_change = now;
+            for (auto& change : raw)
+            {
+                pending.add(std::move(change));
+            }
+            raw.clear();
+        }
+        if (!pending.empty() &&
+            (now - last_change >= debounce_ || now - first_change >= kMaxLatency))
+        {
+            publish(pending.take());
+        }
+    }
+}
+
+void FileWatcherService::publish(std::vector<FileChange> changes)
+{
+    MARKAMP_LOG_DEBUG("File watcher: {} change(s)", changes.size());
+    events::FileSystemChangedEvent event;
+    event.changes = std::move(changes);
+    event_bus_.queue(std::move(event));
+
+    const std::lock_guard lock(wake_mutex_);
+    if (wake_callback_)
+    {
+        wake_callback_();
+    }
+}
+
+} // namespace markamp::core
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "EventBus.h"
+#include "FileChange.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace markamp::core
+{
+
+// ═══════════════════════════════════════════════════════
+// FileChangeCoalescer
+// ═══════════════════════════════════════════════════════
+
+/// Folds a burst of raw changes into at most one change per path, keeping
+/// the order in which paths were first touched:
+///   created + modified        → created
+///   created + deleted         → nothing
+///   deleted + created         → modified (the file was replaced)
+///   modified/renamed + deleted → deleted (of the original path)
+///   a → b, then b → c         → a → c
+///   created a, then a → b     → created b
+class FileChangeCoalescer
+{
+public:
+    void add(FileChange change);
+
+    [[nodiscard]] auto empty() const -> bool
+    {
+        return live_ == 0;
+    }
+    [[nodiscard]] auto size() const -> std::size_t
+    {
+        return live_;
+    }
+
+    /// The coalesced changes; leaves the coalescer empty.
+    [[nodiscard]] auto take() -> std::vector<FileChange>;
+
+private:
+    std::vector<FileChange> changes_; // Dropped slots have an empty path
+    std::unordered_map<std::string, std::size_t> by_path_;
+    std::size_t live_{0};
+
+    void push(FileChange change);
+    void drop(std::size_t index);
+};
+
+// ═══════════════════════════════════════════════════════
+// Watcher backends
+// ═══════════════════════════════════════════════════════
+
+/// Source of raw change notifications for watched directories. One thread
+/// calls wait(); add_watch(), remove_watch() and interrupt() may be called
+/// from any thread at the same time.
+class IFileWatcherBackend
+{
+public:
+    virtual ~IFileWatcherBackend() = default;
+
+    /// Watch the entries of `directory`. With `recursive`, also every
+    /// non-hidden folder below it, including folders created later; a
+    /// backend may set those up on its wait() thread, so a large tree does
+    /// not hold up the caller.
+    [[nodiscard]] virtual auto add_watch(const std::filesystem::path& directory, bool recursive)
+        -> std::expected<void, std::string> = 0;
+
+    /// Stop watching `directory` (folders still covered by another watch
+    /// stay watched).
+    virtual void remove_watch(const std::filesystem::path& directory) = 0;
+
+    /// Block until changes arrive, `timeout` passes (negative: no limit) or
+    /// interrupt() is called, and append the changes to `out`.
+    virtual void wait(std::chrono::milliseconds timeout, std::vector<FileChange>& out) = 0;
+
+    /// Make a blocked (or the next) wait() return.
+    virtual void interrupt() = 0;
+};
+
+/// inotify backend: the kernel reports changes, so an idle workspace costs
+/// no wakeups. Returns nullptr off Linux or when inotify is unavailable.
+[[nodiscard]] auto make_inotify_watcher_backend() -> std::unique_ptr<IFileWatcherBackend>;
+
+/// Portable fallback that re-reads the watched trees every `interval` and
+/// reports the differences (renames show up as delete + create).
+[[nodiscard]] auto make_polling_watcher_backend(std::chrono::milliseconds interval)
+    -> std::unique_ptr<IFileWatcherBackend>;
+
+/// The native backend for this platform, or the polling fallback.
+[[nodiscard]] auto make_file_watcher_backend() -> std::unique_ptr<IFileWatcherBackend>;
+
+// ═══════════════════════════════════════════════════════
+// FileWatcherService
+// ═══════════════════════════════════════════════════════
+
+/// Watches directories on a background thread and publishes what changed
+/// as batched events::FileSystemChangedEvent on the EventBus.
+///
+/// Raw changes are coalesced per path and held until none has arrived for
+/// the debounce window (or kMaxLatency after the first of a burst, so a
+/// constantly busy tree still reports), then queued on the bus in one
+/// batch: a build or `git checkout` touching thousands of files becomes a
+/// handful of events instead of thousands. Events are delivered by
+/// EventBus::process_queued() on the main thread.
+///
+/// Pattern implemented: #18 Predictable I/O never on the hot path
+class FileWatcherService
+{
+public:
+    static constexpr std::chrono::milliseconds kDefaultDebounce{100};
+    static constexpr std::chrono::milliseconds kMaxLatency{1000};
+
+    explicit FileWatcherService(EventBus& event_bus,
+                                std::unique_ptr<IFileWatcherBackend> backend =
+                                    make_file_watcher_backend(),
+                                std::chrono::milliseconds debounce = kDefaultDebounce);
+    ~FileWatcherService();
+
+    // Non-copyable, non-movable
+    FileWatcherService(const FileWatcherService&) = delete;
+    auto operator=(const FileWatcherService&) -> FileWatcherService& = delete;
+    FileWatcherService(FileWatcherService&&) = delete;
+    auto operator=(FileWatcherService&&) -> FileWatcherService& = delete;
+
+    /// Watch `directory` (and, with `recursive`, everything below it) until
+    /// the returned subscription is destroyed. Watching the same directory
+    /// twice shares one backend watch. The subscription must not outlive
+    /// the service.
+    [[nodiscard]] auto watch(const std::filesystem::path& directory, bool recursive)
+        -> std::expected<Subscription, std::string>;
+
+    /// Called on the watcher thread after each batch is queued, e.g. to
+    /// wake an idle UI loop so it drains the bus.
+    void set_wake_callback(std::function<void()> callback);
+
+private:
+    EventBus& event_bus_;
+    std::unique_ptr<IFileWatcherBackend> backend_;
+    std::chrono::milliseconds debounce_;
+
+    std::mutex watch_mutex_;
+    std::map<std::pair<std::string, bool>, std::size_t> watch_counts_; // GUARDED_BY(watch_mutex_)
+
+    std::mutex wake_mutex_;
+    std::function<void()> wake_callback_; // GUARDED_BY(wake_mutex_)
+
+    std::atomic<bool> stopping_{false};
+    std::thread thread_;
+
+    void run();
+    void unwatch(const std::pair<std::string, bool>& key);
+    void publish(std::vector<FileChange> changes);
+};
+
+} // namespace markamp::core
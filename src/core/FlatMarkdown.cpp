@@ -0,0 +1,217 @@
+#include "FlatMarkdown.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace markamp::core
+{
+
+// ═══════════════════════════════════════════════════════
+// FlatMdNode helpers
+// ═══════════════════════════════════════════════════════
+
+auto FlatMdNode::plain_text() const -> std::string
+{
+    // Mirrors MdNode::plain_text(): a Text or Code node contributes its own
+    // text_content and hides its subtree
+    std::string result;
+    const auto* node = this;
+    const auto* const last = this + 1 + descendants;
+    while (node != last)
+    {
+        if (node->type == MdNodeType::Text || node->type == MdNodeType::Code)
+        {
+            result += node->text_content;
+            node += 1 + node->descendants;
+        }
+        else
+        {
+            ++node;
+        }
+    }
+    return result;
+}
+
+auto FlatMdNode::find_all(MdNodeType target_type) const -> std::vector<const FlatMdNode*>
+{
+    std::vector<const FlatMdNode*> results;
+    for (const auto* node = this; node != this + 1 + descendants; ++node)
+    {
+        if (node->type == target_type)
+        {
+            results.push_back(node);
+        }
+    }
+    return results;
+}
+
+// ═══════════════════════════════════════════════════════
+// FlatMarkdownDocument
+// ═══════════════════════════════════════════════════════
+
+FlatMarkdownDocument::FlatMarkdownDocument(std::size_t source_size)
+    : arena_(std::make_unique<std::pmr::monotonic_buffer_resource>())
+    , nodes_(arena_.get())
+{
+    // md4c produces roughly one node per 20-30 source bytes; reserving up
+    // front keeps regrowth (which the arena never reclaims) rare
+    nodes_.reserve(source_size / 24 + 16);
+    nodes_.emplace_back(); // Root
+}
+
+auto FlatMarkdownDocument::heading_count() const -> std::size_t
+{
+    return count_type(MdNodeType::Heading);
+}
+
+auto FlatMarkdownDocument::word_count() const -> std::size_t
+{
+    return count_words(root().plain_text());
+}
+
+auto FlatMarkdownDocument::has_mermaid() const -> bool
+{
+    return !mermaid_blocks.empty();
+}
+
+auto FlatMarkdownDocument::has_tables() const -> bool
+{
+    return count_type(MdNodeType::Table) != 0;
+}
+
+auto FlatMarkdownDocument::has_task_lists() const -> bool
+{
+    return count_type(MdNodeType::TaskListMarker) != 0;
+}
+
+auto FlatMarkdownDocument::find_all(MdNodeType target_type) const
+    -> std::vector<const FlatMdNode*>
+{
+    return root().find_all(target_type);
+}
+
+auto FlatMarkdownDocument::count_type(MdNodeType target_type) const -> std::size_t
+{
+    return static_cast<std::size_t>(std::count_if(nodes_.begin(),
+                                                  nodes_.end(),
+                                                  [target_type](const FlatMdNode& node)
+                                                  { return node.type == target_type; }));
+}
+
+// ═══════════════════════════════════════════════════════
+// FlatMarkdownBuilder
+// ═══════════════════════════════════════════════════════
+
+FlatMarkdownBuilder::FlatMarkdownBuilder(std::string_view source)
+    : source_(source)
+    , document_(source.size())
+{
+    open_.push_back(0);
+}
+
+auto FlatMarkdownBuilder::open(FlatMdNode node) -> FlatMdNode&
+{
+    auto& added = add(node);
+    open_.push_back(static_cast<std::uint32_t>(document_.nodes_.size() - 1));
+    return added;
+}
+
+auto FlatMarkdownBuilder::add(FlatMdNode node) -> FlatMdNode&
+{
+    node.descendants = 0;
+    return document_.nodes_.emplace_back(node);
+}
+
+auto FlatMarkdownBuilder::close() -> const FlatMdNode&
+{
+    auto& node = document_.nodes_[open_.back()];
+    if (has_pending_text_)
+    {
+        node.text_content = intern(pending_text_);
+        pending_text_.clear();
+        has_pending_text_ = false;
+    }
+    node.descendants = static_cast<std::uint32_t>(document_.nodes_.size() - open_.back() - 1);
+    if (open_.size() > 1)
+    {
+        open_.pop_back();
+    }
+    return node;
+}
+
+void FlatMarkdownBuilder::append_text(std::string_view text)
+{
+    if (text.empty())
+    {
+        return;
+    }
+    auto& current = document_.nodes_[open_.back()].text_content;
+    if (has_pending_text_)
+    {
+        pending_text_ += text;
+        return;
+    }
+    if (current.empty() && in_source(text))
+    {
+        current = text;
+        return;
+    }
+    if (!current.empty() && in_source(current))
+    {
+        // md4c emits line breaks of verbatim blocks from a static string;
+        // accept any run whose bytes continue the current view in the source
+        const auto* const next = current.data() + current.size();
+        const auto available = static_cast<std::size_t>(source_.data() + source_.size() - next);
+        if (text.size() <= available && std::memcmp(next, text.data(), text.size()) == 0)
+        {
+            current = std::string_view(current.data(), current.size() + text.size());
+            return;
+        }
+    }
+
+    pending_text_.assign(current);
+    pending_text_ += text;
+    has_pending_text_ = true;
+}
+
+auto FlatMarkdownBuilder::stable_text(std::string_view text) -> std::string_view
+{
+    if (text.empty() || in_source(text))
+    {
+        return text;
+    }
+    return intern(text);
+}
+
+auto FlatMarkdownBuilder::finish() -> FlatMarkdownDocument
+{
+    while (open_.size() > 1)
+    {
+        close();
+    }
+    close(); // Root
+    return std::move(document_);
+}
+
+auto FlatMarkdownBuilder::in_source(std::string_view text) const noexcept -> bool
+{
+    // Compare addresses as integers: the pointers may belong to different arrays
+    const auto begin = reinterpret_cast<std::uintptr_t>(source_.data());
+    const auto first = reinterpret_cast<std::uintptr_t>(text.data());
+    return first >= begin && first + text.size() <= begin + source_.size();
+}
+
+auto FlatMarkdownBuilder::intern(std::string_view text) -> std::string_view
+{
+    if (text.empty())
+    {
+        return {};
+    }
+    auto* copy = static_cast<char*>(document_.arena_->allocate(text.size(), 1));
+    std::memcpy(copy, text.data(), text.size());
+    document_.interned_bytes_ += text.size();
+    return {copy, text.size()};
+}
+
+} // namespace markamp::core
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace markamp::core
+{
+
+class FlatMdChildren;
+
+// ═══════════════════════════════════════════════════════
+// Flat AST node
+// ═══════════════════════════════════════════════════════
+
+/// Compact counterpart of MdNode. Fields have the same names and meaning,
+/// but text is a string_view into the Markdown source (or the document's
+/// arena when md4c produced text that is not in the source), and children
+/// are not stored in the node: a FlatMarkdownDocument keeps all nodes in
+/// one contiguous array in document (pre-)order, so a node's subtree is the
+/// `descendants` nodes that follow it.
+///
+/// A FlatMdNode is only meaningful in place inside its document's array.
+struct FlatMdNode
+{
+    MdNodeType type{MdNodeType::Document};
+    std::uint32_t descendants{0}; // Size of the subtree following this node
+
+    std::string_view text_content; // Text runs, code block and HTML contents
+    std::string_view language;     // Code blocks
+    std::string_view info_string;  // Code blocks
+    std::string_view url;          // Links and images
+    std::string_view title;        // Links and images
+
+    int heading_level{0};
+    int start_number{1};
+    MdAlignment alignment{MdAlignment::Default};
+    bool is_tight{false};
+    bool is_header{false};
+    bool is_checked{false};
+    bool is_display{false};
+
+    [[nodiscard]] auto children() const noexcept -> FlatMdChildren;
+
+    /// Same result as MdNode::plain_text() on the equivalent tree.
+    [[nodiscard]] auto plain_text() const -> std::string;
+
+    /// Nodes of `target_type` in this subtree, in document order.
+    [[nodiscard]] auto find_all(MdNodeType target_type) const -> std::vector<const FlatMdNode*>;
+};
+
+/// The direct children of a FlatMdNode; iteration skips over each child's
+/// subtree.
+class FlatMdChildren
+{
+public:
+    class Iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatMdNode;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const FlatMdNode*;
+        using reference = const FlatMdNode&;
+
+        Iterator() = default;
+        explicit Iterator(const FlatMdNode* node) noexcept
+            : node_(node)
+        {
+        }
+
+        auto operator*() const noexcept -> reference
+        {
+            return *node_;
+        }
+        auto operator->() const noexcept -> pointer
+        {
+            return node_;
+        }
+        auto operator++() noexcept -> Iterator&
+        {
+            node_ += 1 + node_->descendants;
+            return *this;
+        }
+        auto operator++(int) noexcept -> Iterator
+        {
+            auto previous = *this;
+            ++*this;
+            return previous;
+        }
+        auto operator==(const Iterator& other) const noexcept -> bool = default;
+
+    private:
+        const FlatMdNode* node_{nullptr};
+    };
+
+    FlatMdChildren(const FlatMdNode* first, const FlatMdNode* last) noexcept
+        : first_(first)
+        , last_(last)
+    {
+    }
+
+    [[nodiscard]] auto begin() const noexcept -> Iterator
+    {
+        return Iterator(first_);
+    }
+    [[nodiscard]] auto end() const noexcept -> Iterator
+    {
+        return Iterator(last_);
+    }
+    [[nodiscard]] auto empty() const noexcept -> bool
+    {
+        return first_ == last_;
+    }
+
+    /// Number of children (walks them).
+    [[nodiscard]] auto size() const noexcept -> std::size_t
+    {
+        return static_cast<std::size_t>(std::distance(begin(), end()));
+    }
+
+private:
+    const FlatMdNode* first_;
+    const FlatMdNode* last_;
+};
+
+inline auto FlatMdNode::children() const noexcept -> FlatMdChildren
+{
+    return {this + 1, this + 1 + descendants};
+}
+
+/// Uniform child access for code that walks either AST.
+[[nodiscard]] inline auto children_of(const MdNode& node) noexcept -> const std::vector<MdNode>&
+{
+    return node.children;
+}
+
+[[nodiscard]] inline auto children_of(const FlatMdNode& node) noexcept -> FlatMdChildren
+{
+    return node.children();
+}
+
+// ═══════════════════════════════════════════════════════
+// Flat parsed markdown document
+// ═══════════════════════════════════════════════════════
+
+/// Markdown AST stored as one contiguous array of FlatMdNode in a
+/// per-document monotonic arena, with text referencing the source.
+///
+/// Compared to MarkdownDocument there is no allocation per node or per
+/// text run, building never moves subtrees, and whole-tree queries are
+/// linear scans over the array. The Markdown source passed to the parser
+/// must outlive the document.
+///
+/// Pattern implemented: #9 Arena allocators + object pools
+class FlatMarkdownDocument
+{
+public:
+    FlatMarkdownDocument(FlatMarkdownDocument&&) noexcept = default;
+    ~FlatMarkdownDocument() = default;
+
+    // Nodes are allocated from arena_, so assignment would have to copy them
+    FlatMarkdownDocument(const FlatMarkdownDocument&) = delete;
+    auto operator=(const FlatMarkdownDocument&) -> FlatMarkdownDocument& = delete;
+    auto operator=(FlatMarkdownDocument&&) -> FlatMarkdownDocument& = delete;
+
+    /// The Document node; always present.
+    [[nodiscard]] auto root() const noexcept -> const FlatMdNode&
+    {
+        return nodes_.front();
+    }
+
+    /// All nodes in document order, root first.
+    [[nodiscard]] auto nodes() const noexcept -> std::span<const FlatMdNode>
+    {
+        return {nodes_.data(), nodes_.size()};
+    }
+
+    std::vector<std::string_view> mermaid_blocks; // Extracted mermaid sources
+    std::vector<std::string_view> code_languages; // Unique languages used
+
+    [[nodiscard]] auto heading_count() const -> std::size_t;
+    [[nodiscard]] auto word_count() const -> std::size_t;
+    [[nodiscard]] auto has_mermaid() const -> bool;
+    [[nodiscard]] auto has_tables() const -> bool;
+    [[nodiscard]] auto has_task_lists() const -> bool;
+    [[nodiscard]] auto find_all(MdNodeType target_type) const -> std::vector<const FlatMdNode*>;
+
+    /// Bytes held by the node array and text copied into the arena.
+    [[nodiscard]] auto memory_bytes() const noexcept -> std::size_t
+    {
+        return nodes_.capacity() * sizeof(FlatMdNode) + interned_bytes_;
+    }
+
+private:
+    friend class FlatMarkdownBuilder;
+
+    explicit FlatMarkdownDocument(std::size_t source_size);
+
+    [[nodiscard]] auto count_type(MdNodeType target_type) const -> std::size_t;
+
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena_;
+    std::pmr::vector<FlatMdNode> nodes_;
+    std::size_t interned_bytes_{0};
+};
+
+/// Builds a FlatMarkdownDocument from enter/leave events (see
+/// Md4cParser::parse_flat). References returned by the builder are valid
+/// until the next node is added.
+class FlatMarkdownBuilder
+{
+public:
+    /// `source` is the Markdown being parsed; text inside it is referenced,
+    /// anything else is copied into the document's arena.
+    explicit FlatMarkdownBuilder(std::string_view source);
+
+    /// Append `node` as the next child of the innermost open node and make
+    /// it the innermost open node.
+    auto open(FlatMdNode node) -> FlatMdNode&;
+
+    /// Append `node` as a leaf child of the innermost open node.
+    auto add(FlatMdNode node) -> FlatMdNode&;
+
+    /// Close the innermost open node and return it (the root stays open).
+    auto close() -> const FlatMdNode&;
+
+    /// Append `text` to the innermost open node's text_content. Consecutive
+    /// runs that continue each other in the source stay a single view.
+    void append_text(std::string_view text);
+
+    /// A view of `text` that outlives the builder: into the source when
+    /// `text` lies in it, otherwise into the arena.
+    [[nodiscard]] auto stable_text(std::string_view text) -> std::string_view;
+
+    [[nodiscard]] auto document() noexcept -> FlatMarkdownDocument&
+    {
+        return document_;
+    }
+
+    /// Close any open nodes and hand over the document.
+    [[nodiscard]] auto finish() -> FlatMarkdownDocument;
+
+private:
+    std::string_view source_;
+    FlatMarkdownDocument document_;
+    std::vector<std::uint32_t> open_; // Indices of open nodes, root first
+    std::string pending_text_;        // Text of the open node that is not one source view
+    bool has_pending_text_{false};
+
+    [[nodiscard]] auto in_source(std::string_view text) const noexcept -> bool;
+    [[nodiscard]] auto intern(std::string_view text) -> std::string_view;
+};
+
+} // namespace markamp::core
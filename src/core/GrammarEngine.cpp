@@ -1,24 +1,1579 @@
 #include "GrammarEngine.h"
 
+#include "Logger.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <regex>
+#include <shared_mutex>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+
 namespace markamp::core
 {
 
-auto GrammarEngine::load_grammar(const std::string& /*path*/) -> bool
+// ═══════════════════════════════════════════════════════
+// Compiled rule set
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+
+/// Where a pattern can start matching, from its leading anchor.
+enum class RegexAnchor : uint8_t
+{
+    None,      // Anywhere
+    LineStart, // `^`, `\A`: only at the start of the line
+    LineOrG,   // `(^|\G)`: at the line start or where the last match ended
+    GOnly      // `\G`: only where the last match ended
+};
+
+struct Regex
+{
+    std::regex re;
+    RegexAnchor anchor{RegexAnchor::None};
+    bool valid{false};
+};
+
+struct Capture
+{
+    std::size_t group{0};
+    std::string name;
+};
+
+enum class RuleKind : uint8_t
+{
+    Container,  // Only patterns / an include
+    Match,      // `match`
+    BeginEnd,   // `begin` + `end`
+    BeginWhile, // `begin` + `while`
+    External    // Include of another grammar, resolved when tokenizing
+};
+
+struct Rule
+{
+    RuleKind kind{RuleKind::Container};
+    std::string name;
+    std::string content_name;
+    int match{-1};          // regexes index of `match` or `begin`
+    int end{-1};            // regexes index of `end` or `while`
+    std::string end_source; // `end` / `while` with back-references to `begin`
+    bool apply_end_pattern_last{false};
+    std::vector<Capture> captures;     // `captures` / `beginCaptures`
+    std::vector<Capture> end_captures; // `endCaptures` / `whileCaptures`
+    std::vector<uint32_t> children;    // Patterns as written (includes unresolved)
+    std::vector<uint32_t> patterns;    // Children with containers expanded, in order
+    std::string external_scope;
+    std::string external_key; // Repository entry, empty for the grammar root
+};
+
+constexpr std::size_t kMaxDynamicRegexes = 1024;
+constexpr int kMaxExternalDepth = 8;
+
+} // namespace
+
+struct CompiledGrammar
+{
+    std::string scope_name;
+    std::vector<Rule> rules; // rules[0] is the grammar root
+    std::vector<Regex> regexes;
+    std::unordered_map<std::string, uint32_t> repository; // Top-level entries
+    std::size_t invalid_regexes{0};
+
+    // End patterns with back-references, compiled per distinct begin match
+    mutable std::mutex dynamic_mutex;
+    mutable std::unordered_map<std::string, std::shared_ptr<const Regex>> dynamic_regexes;
+};
+
+struct GrammarState::Frame
+{
+    std::shared_ptr<const Frame> parent;
+    std::shared_ptr<const CompiledGrammar> grammar;
+    uint32_t rule{0};
+    const Regex* end{nullptr};                // `end` / `while`, null if none
+    std::shared_ptr<const Regex> dynamic_end; // Owns `end` if it had back-references
+    std::string name_scope;                   // Scope of the begin / end matches
+    std::string content_scope;                // Scope between them
+    std::size_t depth{0};
+};
+
+auto GrammarState::depth() const noexcept -> std::size_t
+{
+    return top_ ? top_->depth : 0;
+}
+
+auto operator==(const GrammarState& lhs, const GrammarState& rhs) noexcept -> bool
+{
+    const auto* left = lhs.top_.get();
+    const auto* right = rhs.top_.get();
+    // The document start and an empty rule stack are the same state
+    if (left == nullptr && right != nullptr && right->depth == 0)
+    {
+        return true;
+    }
+    if (right == nullptr && left != nullptr && left->depth == 0)
+    {
+        return true;
+    }
+    while (left != right)
+    {
+        if (left == nullptr || right == nullptr || left->rule != right->rule ||
+            left->grammar != right->grammar || left->end != right->end ||
+            left->depth != right->depth)
+        {
+            return false;
+        }
+        left = left->parent.get();
+        right = right->parent.get();
+    }
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════
+// Oniguruma → ECMAScript pattern translation
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+
+struct TranslatedPattern
+{
+    std::string source;
+    RegexAnchor anchor{RegexAnchor::None};
+    bool icase{false};
+    bool ok{true};
+};
+
+/// Drop `(?x)` whitespace and `#` comments outside character classes.
+auto strip_extended(std::string_view pattern) -> std::string
+{
+    std::string out;
+    out.reserve(pattern.size());
+    bool in_class = false;
+    for (std::size_t i = 0; i < pattern.size(); ++i)
+    {
+        const char ch = pattern[i];
+        if (ch == '\\' && i + 1 < pattern.size())
+        {
+            const char next = pattern[++i];
+            if (!in_class && (next == ' ' || next == '#'))
+            {
+                out += next;
+            }
+            else
+            {
+                out += ch;
+                out += next;
+            }
+            continue;
+        }
+        if (in_class)
+        {
+            in_class = ch != ']';
+            out += ch;
+            continue;
+        }
+        if (ch == '[')
+        {
+            in_class = true;
+            out += ch;
+        }
+        else if (ch == '#')
+        {
+            while (i + 1 < pattern.size() && pattern[i + 1] != '\n')
+            {
+                ++i;
+            }
+        }
+        else if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r')
+        {
+            out += ch;
+        }
+    }
+    return out;
+}
+
+/// Index just past the group opening at `open`, or npos if unbalanced.
+auto skip_group(std::string_view pattern, std::size_t open) -> std::size_t
+{
+    int depth = 0;
+    bool in_class = false;
+    for (std::size_t i = open; i < pattern.size(); ++i)
+    {
+        const char ch = pattern[i];
+        if (ch == '\\')
+        {
+            ++i;
+        }
+        else if (in_class)
+        {
+            in_class = ch != ']';
+        }
+        else if (ch == '[')
+        {
+            in_class = true;
+        }
+        else if (ch == '(')
+        {
+            ++depth;
+        }
+        else if (ch == ')' && --depth == 0)
+        {
+            return i + 1;
+        }
+    }
+    return std::string_view::npos;
+}
+
+auto has_top_level_alternation(std::string_view pattern) -> bool
+{
+    int depth = 0;
+    bool in_class = false;
+    for (std::size_t i = 0; i < pattern.size(); ++i)
+    {
+        const char ch = pattern[i];
+        if (ch == '\\')
+        {
+            ++i;
+        }
+        else if (in_class)
+        {
+            in_class = ch != ']';
+        }
+        else if (ch == '[')
+        {
+            in_class = true;
+        }
+        else if (ch == '(')
+        {
+            ++depth;
+        }
+        else if (ch == ')')
+        {
+            --depth;
+        }
+        else if (ch == '|' && depth == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Whether `pattern[i]` starts a valid `{n}`, `{n,}` or `{n,m}` interval.
+auto is_interval(std::string_view pattern, std::size_t i) -> bool
+{
+    std::size_t j = i + 1;
+    const auto digits_from = j;
+    while (j < pattern.size() && pattern[j] >= '0' && pattern[j] <= '9')
+    {
+        ++j;
+    }
+    if (j == digits_from)
+    {
+        return false;
+    }
+    if (j < pattern.size() && pattern[j] == ',')
+    {
+        ++j;
+        while (j < pattern.size() && pattern[j] >= '0' && pattern[j] <= '9')
+        {
+            ++j;
+        }
+    }
+    return j < pattern.size() && pattern[j] == '}';
+}
+
+auto translate_pattern(std::string_view pattern) -> TranslatedPattern
+{
+    TranslatedPattern result;
+
+    // Leading global flags: (?x), (?i), (?ix), ...
+    bool extended = false;
+    while (pattern.starts_with("(?"))
+    {
+        std::size_t i = 2;
+        bool x_flag = false;
+        bool i_flag = false;
+        while (i < pattern.size() && (pattern[i] == 'x' || pattern[i] == 'i' || pattern[i] == 'm'))
+        {
+            x_flag = x_flag || pattern[i] == 'x';
+            i_flag = i_flag || pattern[i] == 'i';
+            ++i;
+        }
+        if (i == 2 || i >= pattern.size() || pattern[i] != ')')
+        {
+            break;
+        }
+        extended = extended || x_flag;
+        result.icase = result.icase || i_flag;
+        pattern.remove_prefix(i + 1);
+    }
+    const std::string stripped = extended ? strip_extended(pattern) : std::string(pattern);
+    std::string_view body = stripped;
+
+    // A leading anchor lets the scanner skip positions where it cannot match
+    std::string& out = result.source;
+    out.reserve(body.size() + 8);
+    if (!has_top_level_alternation(body))
+    {
+        if (body.starts_with("(^|\\G)") || body.starts_with("(\\G|^)"))
+        {
+            result.anchor = RegexAnchor::LineOrG;
+            out += "()"; // Keep the group numbering
+            body.remove_prefix(6);
+        }
+        else if (body.starts_with("(?:^|\\G)") || body.starts_with("(?:\\G|^)"))
+        {
+            result.anchor = RegexAnchor::LineOrG;
+            body.remove_prefix(8);
+        }
+        else if (body.starts_with("\\G"))
+        {
+            result.anchor = RegexAnchor::GOnly;
+            body.remove_prefix(2);
+        }
+        else if (body.starts_with("\\A"))
+        {
+            result.anchor = RegexAnchor::LineStart;
+            body.remove_prefix(2);
+        }
+        else if (body.starts_with("^"))
+        {
+            result.anchor = RegexAnchor::LineStart;
+            body.remove_prefix(1);
+        }
+    }
+
+    bool in_class = false;
+    int nested_classes = 0;
+    bool after_quantifier = false;
+    for (std::size_t i = 0; i < body.size(); ++i)
+    {
+        const char ch = body[i];
+        const char next = i + 1 < body.size() ? body[i + 1] : '\0';
+
+        if (ch == '\\')
+        {
+            after_quantifier = false;
+            if (i + 1 >= body.size())
+            {
+                out += "\\\\";
+                break;
+            }
+            ++i;
+            switch (next)
+            {
+                case 'h':
+                    out += in_class ? "0-9A-Fa-f" : "[0-9A-Fa-f]";
+                    break;
+                case 'H':
+                    result.ok = result.ok && !in_class;
+                    out += "[^0-9A-Fa-f]";
+                    break;
+                case 'A':
+                    out += in_class ? "A" : "^";
+                    break;
+                case 'z':
+                case 'Z':
+                    out += in_class ? std::string(1, next) : std::string("$");
+                    break;
+                case 'G':
+                    out += "(?!)"; // \G away from the start: assume no anchor here
+                    break;
+                case 'e':
+                    out += "\\x1B";
+                    break;
+                case 'x':
+                    if (i + 1 < body.size() && body[i + 1] == '{')
+                    {
+                        const auto close = body.find('}', i + 2);
+                        unsigned long value = 0;
+                        try
+                        {
+                            value = std::stoul(std::string(body.substr(i + 2, close - i - 2)),
+                                               nullptr,
+                                               16);
+                        }
+                        catch (const std::exception&)
+                        {
+                            result.ok = false;
+                        }
+                        char buffer[8];
+                        if (close == std::string_view::npos || value > 0xFFFF)
+                        {
+                            result.ok = false;
+                            break;
+                        }
+                        std::snprintf(buffer,
+                                      sizeof(buffer),
+                                      value <= 0xFF ? "\\x%02lX" : "\\u%04lX",
+                                      value);
+                        out += buffer;
+                        i = close;
+                    }
+                    else
+                    {
+                        out += "\\x";
+                    }
+                    break;
+                case 'p':
+                case 'P':
+                case 'K':
+                case 'R':
+                case 'X':
+                case 'k':
+                case 'g':
+                    result.ok = false; // Unicode properties, keep-out, named back-references
+                    out += '\\';
+                    out += next;
+                    break;
+                default:
+                    out += '\\';
+                    out += next;
+                    break;
+            }
+            continue;
+        }
+
+        if (in_class)
+        {
+            if (ch == '[' && next == ':')
+            {
+                const auto close = body.find(":]", i + 2);
+                if (close == std::string_view::npos)
+                {
+                    result.ok = false;
+                    break;
+                }
+                out += body.substr(i, close + 2 - i);
+                i = close + 1;
+            }
+            else if (ch == '[')
+            {
+                // Nested class: merged into the enclosing one
+                result.ok = result.ok && next != '^';
+                ++nested_classes;
+            }
+            else if (ch == ']' && nested_classes > 0)
+            {
+                --nested_classes;
+            }
+            else if (ch == '&' && next == '&')
+            {
+                result.ok = false; // Class intersection
+                out += ch;
+            }
+            else
+            {
+                in_class = ch != ']';
+                out += ch;
+            }
+            continue;
+        }
+
+        if (ch == '[')
+        {
+            in_class = true;
+            after_quantifier = false;
+            out += ch;
+            if (next == '^')
+            {
+                out += '^';
+                ++i;
+            }
+            if (i + 1 < body.size() && body[i + 1] == ']')
+            {
+                out += "\\]"; // Leading ']' is a literal
+                ++i;
+            }
+            continue;
+        }
+
+        if (ch == '(' && next == '?')
+        {
+            after_quantifier = false;
+            const char kind = i + 2 < body.size() ? body[i + 2] : '\0';
+            const char after_kind = i + 3 < body.size() ? body[i + 3] : '\0';
+            if (kind == '<' && (after_kind == '=' || after_kind == '!'))
+            {
+                // Lookbehind is not available: drop the assertion
+                const auto end = skip_group(body, i);
+                if (end == std::string_view::npos)
+                {
+                    result.ok = false;
+                    break;
+                }
+                i = end - 1;
+            }
+            else if (kind == '<' || (kind == 'P' && after_kind == '<'))
+            {
+                const auto close = body.find('>', i);
+                if (close == std::string_view::npos)
+                {
+                    result.ok = false;
+                    break;
+                }
+                out += '(';
+                i = close;
+            }
+            else if (kind == '>')
+            {
+                out += "(?:"; // Atomic group, approximated as plain
+                i += 2;
+            }
+            else if (kind == '#')
+            {
+                const auto close = body.find(')', i);
+                i = close == std::string_view::npos ? body.size() : close;
+            }
+            else if (kind == ':' || kind == '=' || kind == '!')
+            {
+                out += "(?";
+                out += kind;
+                i += 2;
+            }
+            else
+            {
+                // Scoped flags: (?i) toggles are dropped, (?i:...) becomes (?:...)
+                std::size_t j = i + 2;
+                while (j < body.size() &&
+                       (body[j] == 'i' || body[j] == 'x' || body[j] == 'm' || body[j] == '-'))
+                {
+                    ++j;
+                }
+                if (j < body.size() && body[j] == ')')
+                {
+                    i = j;
+                }
+                else if (j < body.size() && body[j] == ':')
+                {
+                    out += "(?:";
+                    i = j;
+                }
+                else
+                {
+                    result.ok = false;
+                    out += ch;
+                }
+            }
+            continue;
+        }
+
+        if (ch == '+' && after_quantifier)
+        {
+            after_quantifier = false; // Possessive: treated as greedy
+            continue;
+        }
+        if (ch == '?' && after_quantifier)
+        {
+            after_quantifier = false; // Lazy
+            out += ch;
+            continue;
+        }
+        if (ch == '{')
+        {
+            if (is_interval(body, i))
+            {
+                const auto close = body.find('}', i);
+                out += body.substr(i, close + 1 - i);
+                i = close;
+                after_quantifier = true;
+            }
+            else
+            {
+                out += "\\{";
+                after_quantifier = false;
+            }
+            continue;
+        }
+        if (ch == '}')
+        {
+            out += "\\}";
+            after_quantifier = false;
+            continue;
+        }
+
+        after_quantifier = ch == '*' || ch == '+' || ch == '?';
+        out += ch;
+    }
+    result.ok = result.ok && !in_class;
+    return result;
+}
+
+auto compile_regex(std::string_view pattern) -> Regex
+{
+    Regex regex;
+    auto translated = translate_pattern(pattern);
+    regex.anchor = translated.anchor;
+    if (!translated.ok)
+    {
+        return regex;
+    }
+    auto flags = std::regex::ECMAScript | std::regex::multiline | std::regex::optimize;
+    if (translated.icase)
+    {
+        flags |= std::regex::icase;
+    }
+    try
+    {
+        regex.re = std::regex(translated.source, flags);
+        regex.valid = true;
+    }
+    catch (const std::regex_error&)
+    {
+        regex.valid = false;
+    }
+    return regex;
+}
+
+/// Whether `pattern` refers to groups of a `begin` match (\1 ... \9).
+auto has_back_references(std::string_view pattern) -> bool
 {
-    // Stub: TextMate grammar loading not yet implemented.
-    // A full implementation would parse .tmLanguage.json and build tokenization rules.
+    for (std::size_t i = 0; i + 1 < pattern.size(); ++i)
+    {
+        if (pattern[i] == '\\')
+        {
+            if (pattern[i + 1] >= '1' && pattern[i + 1] <= '9')
+            {
+                return true;
+            }
+            ++i;
+        }
+    }
     return false;
 }
 
-auto GrammarEngine::get_grammar(const std::string& /*scope_name*/) const -> const Grammar*
+/// Replace \N in `pattern` with the escaped text of group N of `match`.
+auto resolve_back_references(std::string_view pattern, const std::cmatch& match) -> std::string
+{
+    std::string out;
+    out.reserve(pattern.size() + 16);
+    for (std::size_t i = 0; i < pattern.size(); ++i)
+    {
+        if (pattern[i] == '\\' && i + 1 < pattern.size())
+        {
+            const char next = pattern[i + 1];
+            if (next >= '1' && next <= '9')
+            {
+                const auto group = static_cast<std::size_t>(next - '0');
+                if (group < match.size() && match[group].matched)
+                {
+                    for (const char ch : match[group].str())
+                    {
+                        if (std::strchr("\\^$.|?*+()[]{}-/", ch) != nullptr)
+                        {
+                            out += '\\';
+                        }
+                        out += ch;
+                    }
+                }
+            }
+            else
+            {
+                out += pattern[i];
+                out += next;
+            }
+            ++i;
+            continue;
+        }
+        out += pattern[i];
+    }
+    return out;
+}
+
+auto dynamic_regex(const CompiledGrammar& grammar, const std::string& source)
+    -> std::shared_ptr<const Regex>
+{
+    std::lock_guard lock(grammar.dynamic_mutex);
+    auto found = grammar.dynamic_regexes.find(source);
+    if (found != grammar.dynamic_regexes.end())
+    {
+        return found->second;
+    }
+    if (grammar.dynamic_regexes.size() >= kMaxDynamicRegexes)
+    {
+        grammar.dynamic_regexes.clear(); // Live states keep their own regexes
+    }
+    auto regex = std::make_shared<const Regex>(compile_regex(source));
+    grammar.dynamic_regexes.emplace(source, regex);
+    return regex;
+}
+
+// ═══════════════════════════════════════════════════════
+// Grammar compilation
+// ═══════════════════════════════════════════════════════
+
+using Json = nlohmann::json;
+
+/// Builds a CompiledGrammar from parsed `.tmLanguage.json`. Every rule
+/// node is compiled once (include cycles resolve to the same rule id) and
+/// identical regex sources share one compiled regex.
+class GrammarCompiler
+{
+public:
+    explicit GrammarCompiler(CompiledGrammar& grammar)
+        : grammar_(grammar)
+    {
+    }
+
+    void compile_root(const Json& root)
+    {
+        std::vector<const Json*> repositories;
+        if (root.contains("repository") && root["repository"].is_object())
+        {
+            repositories.push_back(&root["repository"]);
+        }
+        root_ = &root;
+        compile(root, {});
+
+        // The root's "name" is a display name, not a scope
+        grammar_.rules[0].kind = RuleKind::Container;
+        grammar_.rules[0].name.clear();
+        grammar_.rules[0].content_name.clear();
+
+        if (!repositories.empty())
+        {
+            for (const auto& [key, entry] : repositories.front()->items())
+            {
+                grammar_.repository[key] = compile(entry, repositories);
+            }
+        }
+        flatten();
+    }
+
+private:
+    CompiledGrammar& grammar_;
+    const Json* root_{nullptr};
+    std::unordered_map<const Json*, uint32_t> compiled_;
+    std::unordered_map<std::string, int> regex_ids_;
+
+    auto compile(const Json& node, std::vector<const Json*> repositories) -> uint32_t
+    {
+        if (auto found = compiled_.find(&node); found != compiled_.end())
+        {
+            return found->second;
+        }
+        const auto id = static_cast<uint32_t>(grammar_.rules.size());
+        grammar_.rules.emplace_back();
+        compiled_.emplace(&node, id);
+        if (!node.is_object())
+        {
+            return id;
+        }
+
+        Rule rule;
+        const auto outer_repositories = repositories;
+        if (node.contains("repository") && node["repository"].is_object())
+        {
+            repositories.push_back(&node["repository"]);
+        }
+
+        rule.name = node.value("name", std::string{});
+        rule.content_name = node.value("contentName", std::string{});
+        if (node.contains("include") && node["include"].is_string())
+        {
+            rule.children.push_back(
+                resolve_include(node["include"].get<std::string>(), outer_repositories));
+        }
+        else if (node.contains("match") && node["match"].is_string())
+        {
+            rule.kind = RuleKind::Match;
+            rule.match = regex_id(node["match"].get<std::string>());
+            rule.captures = parse_captures(node, "captures");
+        }
+        else if (node.contains("begin") && node["begin"].is_string())
+        {
+            const bool has_while = node.contains("while") && node["while"].is_string();
+            rule.kind = has_while ? RuleKind::BeginWhile : RuleKind::BeginEnd;
+            rule.match = regex_id(node["begin"].get<std::string>());
+            const char* end_key = has_while ? "while" : "end";
+            if (node.contains(end_key) && node[end_key].is_string())
+            {
+                auto end_source = node[end_key].get<std::string>();
+                if (has_back_references(end_source))
+                {
+                    rule.end_source = std::move(end_source);
+                }
+                else
+                {
+                    rule.end = regex_id(end_source);
+                }
+            }
+            rule.captures = parse_captures(node, "beginCaptures");
+            rule.end_captures = parse_captures(node, has_while ? "whileCaptures" : "endCaptures");
+            if (rule.captures.empty())
+            {
+                rule.captures = parse_captures(node, "captures");
+            }
+            if (rule.end_captures.empty())
+            {
+                rule.end_captures = parse_captures(node, "captures");
+            }
+            const auto end_last = node.value("applyEndPatternLast", Json{});
+            rule.apply_end_pattern_last =
+                (end_last.is_boolean() && end_last.get<bool>()) ||
+                (end_last.is_number_integer() && end_last.get<int>() != 0);
+        }
+
+        if (node.contains("patterns") && node["patterns"].is_array())
+        {
+            for (const auto& child : node["patterns"])
+            {
+                rule.children.push_back(compile(child, repositories));
+            }
+        }
+        grammar_.rules[id] = std::move(rule);
+        return id;
+    }
+
+    auto resolve_include(const std::string& include, const std::vector<const Json*>& repositories)
+        -> uint32_t
+    {
+        if (include == "$self" || include == "$base")
+        {
+            return 0;
+        }
+        if (include.starts_with('#'))
+        {
+            const auto key = include.substr(1);
+            for (auto level = repositories.size(); level > 0; --level)
+            {
+                const auto& repository = *repositories[level - 1];
+                if (repository.contains(key))
+                {
+                    const auto visible = repositories.begin() + static_cast<std::ptrdiff_t>(level);
+                    return compile(repository[key],
+                                   std::vector<const Json*>(repositories.begin(), visible));
+                }
+            }
+            MARKAMP_LOG_DEBUG("Grammar {}: unresolved include {}", grammar_.scope_name, include);
+            return new_rule(Rule{});
+        }
+
+        const auto hash = include.find('#');
+        const auto scope = include.substr(0, hash);
+        const auto key = hash == std::string::npos ? std::string{} : include.substr(hash + 1);
+        if (scope == grammar_.scope_name)
+        {
+            if (key.empty())
+            {
+                return 0;
+            }
+            const auto* repository =
+                root_->contains("repository") ? &(*root_)["repository"] : nullptr;
+            if (repository != nullptr && repository->contains(key))
+            {
+                return compile((*repository)[key], {repository});
+            }
+            return new_rule(Rule{});
+        }
+
+        Rule external;
+        external.kind = RuleKind::External;
+        external.external_scope = scope;
+        external.external_key = key;
+        return new_rule(std::move(external));
+    }
+
+    auto new_rule(Rule rule) -> uint32_t
+    {
+        grammar_.rules.push_back(std::move(rule));
+        return static_cast<uint32_t>(grammar_.rules.size() - 1);
+    }
+
+    auto regex_id(const std::string& source) -> int
+    {
+        if (auto found = regex_ids_.find(source); found != regex_ids_.end())
+        {
+            return found->second;
+        }
+        const auto id = static_cast<int>(grammar_.regexes.size());
+        grammar_.regexes.push_back(compile_regex(source));
+        if (!grammar_.regexes.back().valid)
+        {
+            ++grammar_.invalid_regexes;
+            MARKAMP_LOG_DEBUG("Grammar {}: unsupported pattern {}", grammar_.scope_name, source);
+        }
+        regex_ids_.emplace(source, id);
+        return id;
+    }
+
+    static auto parse_captures(const Json& node, const char* key) -> std::vector<Capture>
+    {
+        std::vector<Capture> captures;
+        if (!node.contains(key) || !node[key].is_object())
+        {
+            return captures;
+        }
+        for (const auto& [group, capture] : node[key].items())
+        {
+            if (!capture.is_object() || !capture.contains("name") || !capture["name"].is_string())
+            {
+                continue;
+            }
+            try
+            {
+                captures.push_back({std::stoul(group), capture["name"].get<std::string>()});
+            }
+            catch (const std::exception&)
+            {
+                continue; // Non-numeric group key
+            }
+        }
+        // Outer groups open first, so painting in group order nests correctly
+        std::sort(captures.begin(),
+                  captures.end(),
+                  [](const Capture& lhs, const Capture& rhs) { return lhs.group < rhs.group; });
+        return captures;
+    }
+
+    /// Expand containers (includes, pattern-only rules) into flat candidate lists.
+    void flatten()
+    {
+        for (auto& rule : grammar_.rules)
+        {
+            std::unordered_set<uint32_t> seen;
+            std::vector<uint32_t> flat;
+            for (const auto child : rule.children)
+            {
+                expand(child, seen, flat);
+            }
+            rule.patterns = std::move(flat);
+        }
+    }
+
+    void expand(uint32_t id, std::unordered_set<uint32_t>& seen, std::vector<uint32_t>& flat) const
+    {
+        if (!seen.insert(id).second)
+        {
+            return; // Cycle or duplicate: a repeat could never win a tie anyway
+        }
+        const auto& rule = grammar_.rules[id];
+        if (rule.kind != RuleKind::Container)
+        {
+            flat.push_back(id);
+            return;
+        }
+        for (const auto child : rule.children)
+        {
+            expand(child, seen, flat);
+        }
+    }
+};
+
+// ═══════════════════════════════════════════════════════
+// Line tokenizer
+// ═══════════════════════════════════════════════════════
+
+using Frame = GrammarState::Frame;
+using FramePtr = std::shared_ptr<const Frame>;
+using GrammarLookup = std::function<std::shared_ptr<const CompiledGrammar>(const std::string&)>;
+
+/// One pattern that may match next.
+struct Candidate
+{
+    std::shared_ptr<const CompiledGrammar> grammar;
+    uint32_t rule{0};
+    const Regex* regex{nullptr};
+    bool is_end{false};
+};
+
+/// Last search result for a candidate within the current line.
+struct Search
+{
+    std::cmatch match;
+    std::size_t from{0};
+    bool cached{false};
+    bool found{false};
+};
+
+/// Candidates of one rule-stack top, with their search results.
+struct FrameScan
+{
+    const Frame* frame{nullptr};
+    std::vector<Candidate> candidates;
+    std::vector<Search> searches;
+};
+
+class LineTokenizer
+{
+public:
+    LineTokenizer(std::string_view line, const GrammarLookup& lookup)
+        : line_length_(line.size())
+        , lookup_(lookup)
+    {
+        text_.reserve(line.size() + 1);
+        text_.append(line);
+        text_ += '\n'; // Patterns may match the line end explicitly
+    }
+
+    auto run(FramePtr top) -> FramePtr
+    {
+        std::size_t pos = 0;
+        top = check_while_rules(std::move(top), pos);
+
+        while (true)
+        {
+            auto& scan = scan_for(*top);
+            std::size_t best = scan.candidates.size();
+            std::size_t best_start = 0;
+            for (std::size_t index = 0; index < scan.candidates.size(); ++index)
+            {
+                auto& search = scan.searches[index];
+                if (!find(*scan.candidates[index].regex, search, pos))
+                {
+                    continue;
+                }
+                const auto start = offset(search.match[0].first);
+                if (best == scan.candidates.size() || start < best_start)
+                {
+                    best = index;
+                    best_start = start;
+                }
+            }
+            if (best == scan.candidates.size())
+            {
+                emit(pos, line_length_, top->content_scope);
+                break;
+            }
+
+            const auto& candidate = scan.candidates[best];
+            const auto& match = scan.searches[best].match;
+            const auto start = best_start;
+            const auto end = offset(match[0].second);
+            const auto& rule = candidate.grammar->rules[candidate.rule];
+            emit(pos, start, top->content_scope);
+
+            if (candidate.is_end)
+            {
+                paint(match, top->name_scope, rule.end_captures);
+                const bool stuck = start == end && entered_at(top.get()) == pos;
+                forget(top.get());
+                top = top->parent;
+                if (stuck)
+                {
+                    // Pushed and popped without advancing: stop to avoid looping
+                    emit(end, line_length_, top->content_scope);
+                    break;
+                }
+            }
+            else if (rule.kind == RuleKind::Match || top->depth >= GrammarEngine::kMaxStackDepth)
+            {
+                paint(match, rule.name.empty() ? top->content_scope : rule.name, rule.captures);
+                if (start == end)
+                {
+                    emit(end, line_length_, top->content_scope);
+                    break;
+                }
+            }
+            else
+            {
+                auto frame = push(top, candidate, match);
+                paint(match, frame->name_scope, rule.captures);
+                entered_.emplace_back(frame.get(), pos);
+                top = std::move(frame);
+            }
+            pos = end;
+            anchor_ = end;
+        }
+        return top;
+    }
+
+    [[nodiscard]] auto tokens() -> std::vector<GrammarToken>&
+    {
+        return tokens_;
+    }
+
+private:
+    std::string text_;
+    std::size_t line_length_;
+    const GrammarLookup& lookup_;
+    std::size_t anchor_{std::string::npos}; // Where \G matches; none at line start
+    std::vector<GrammarToken> tokens_;
+    std::vector<FrameScan> scans_;
+    std::vector<std::pair<const Frame*, std::size_t>> entered_; // Frames pushed on this line
+    struct Segment
+    {
+        std::size_t start;
+        std::size_t end;
+        const std::string* scope;
+    };
+    std::vector<Segment> segments_;
+
+    [[nodiscard]] auto offset(const char* at) const -> std::size_t
+    {
+        return static_cast<std::size_t>(at - text_.data());
+    }
+
+    [[nodiscard]] auto entered_at(const Frame* frame) const -> std::size_t
+    {
+        for (const auto& [entered, pos] : entered_)
+        {
+            if (entered == frame)
+            {
+                return pos;
+            }
+        }
+        return std::string::npos;
+    }
+
+    /// Drops per-line state of a frame about to be popped. Once freed, its
+    /// address may be reused by a newly pushed frame, which must not inherit
+    /// the old scan or entry position.
+    void forget(const Frame* frame)
+    {
+        std::erase_if(scans_, [frame](const FrameScan& scan) { return scan.frame == frame; });
+        std::erase_if(entered_, [frame](const auto& entry) { return entry.first == frame; });
+    }
+
+    /// Begin-while rules stay open only while their condition matches at
+    /// the start of each line; the first that fails closes itself and
+    /// everything nested inside it.
+    auto check_while_rules(FramePtr top, std::size_t& pos) -> FramePtr
+    {
+        std::vector<FramePtr> stack;
+        for (auto frame = top; frame != nullptr; frame = frame->parent)
+        {
+            stack.push_back(frame);
+        }
+        for (auto it = stack.rbegin(); it != stack.rend(); ++it)
+        {
+            const auto& frame = *it;
+            const auto& rule = frame->grammar->rules[frame->rule];
+            if (rule.kind != RuleKind::BeginWhile)
+            {
+                continue;
+            }
+            Search search;
+            if (frame->end != nullptr && frame->end->valid &&
+                match_here(*frame->end, search, pos))
+            {
+                paint(search.match, frame->name_scope, rule.end_captures);
+                pos = offset(search.match[0].second);
+                anchor_ = pos;
+                continue;
+            }
+            return frame->parent;
+        }
+        return top;
+    }
+
+    auto push(const FramePtr& top, const Candidate& candidate, const std::cmatch& match) -> FramePtr
+    {
+        const auto& rule = candidate.grammar->rules[candidate.rule];
+        auto frame = std::make_shared<Frame>();
+        frame->parent = top;
+        frame->grammar = candidate.grammar;
+        frame->rule = candidate.rule;
+        frame->depth = top->depth + 1;
+        if (!rule.end_source.empty())
+        {
+            frame->dynamic_end =
+                dynamic_regex(*candidate.grammar, resolve_back_references(rule.end_source, match));
+            frame->end = frame->dynamic_end.get();
+        }
+        else if (rule.end >= 0)
+        {
+            frame->end = &candidate.grammar->regexes[static_cast<std::size_t>(rule.end)];
+        }
+        frame->name_scope = rule.name.empty() ? top->content_scope : rule.name;
+        frame->content_scope = rule.content_name.empty() ? frame->name_scope : rule.content_name;
+        return frame;
+    }
+
+    auto scan_for(const Frame& frame) -> FrameScan&
+    {
+        for (auto& scan : scans_)
+        {
+            if (scan.frame == &frame)
+            {
+                return scan;
+            }
+        }
+
+        FrameScan scan;
+        scan.frame = &frame;
+        const auto& rule = frame.grammar->rules[frame.rule];
+        const bool has_end = rule.kind == RuleKind::BeginEnd && frame.end != nullptr &&
+                             frame.end->valid;
+        if (has_end && !rule.apply_end_pattern_last)
+        {
+            scan.candidates.push_back({frame.grammar, frame.rule, frame.end, true});
+        }
+        collect(frame.grammar, rule.patterns, scan.candidates, 0);
+        if (has_end && rule.apply_end_pattern_last)
+        {
+            scan.candidates.push_back({frame.grammar, frame.rule, frame.end, true});
+        }
+        scan.searches.resize(scan.candidates.size());
+        scans_.push_back(std::move(scan));
+        return scans_.back();
+    }
+
+    void collect(const std::shared_ptr<const CompiledGrammar>& grammar,
+                 const std::vector<uint32_t>& patterns,
+                 std::vector<Candidate>& out,
+                 int depth)
+    {
+        for (const auto id : patterns)
+        {
+            const auto& rule = grammar->rules[id];
+            if (rule.kind != RuleKind::External)
+            {
+                const auto& regex = grammar->regexes[static_cast<std::size_t>(rule.match)];
+                if (regex.valid)
+                {
+                    out.push_back({grammar, id, &regex, false});
+                }
+                continue;
+            }
+            const auto target = depth < kMaxExternalDepth ? lookup_(rule.external_scope) : nullptr;
+            if (target == nullptr)
+            {
+                continue;
+            }
+            if (rule.external_key.empty())
+            {
+                collect(target, target->rules[0].patterns, out, depth + 1);
+            }
+            else if (auto entry = target->repository.find(rule.external_key);
+                     entry != target->repository.end())
+            {
+                const auto& target_rule = target->rules[entry->second];
+                if (target_rule.kind == RuleKind::Container)
+                {
+                    collect(target, target_rule.patterns, out, depth + 1);
+                }
+                else
+                {
+                    collect(target, std::vector<uint32_t>{entry->second}, out, depth + 1);
+                }
+            }
+        }
+    }
+
+    /// Earliest match of `regex` at or after `pos`, reusing the previous
+    /// search while its result is still ahead of `pos`.
+    auto find(const Regex& regex, Search& search, std::size_t pos) -> bool
+    {
+        switch (regex.anchor)
+        {
+            case RegexAnchor::LineStart:
+                if (pos != 0)
+                {
+                    return false;
+                }
+                return match_here(regex, search, pos);
+            case RegexAnchor::LineOrG:
+                if (pos != 0 && pos != anchor_)
+                {
+                    return false;
+                }
+                return match_here(regex, search, pos);
+            case RegexAnchor::GOnly:
+                if (pos != anchor_)
+                {
+                    return false;
+                }
+                return match_here(regex, search, pos);
+            case RegexAnchor::None:
+                break;
+        }
+
+        if (search.cached && search.from <= pos &&
+            (!search.found || offset(search.match[0].first) >= pos))
+        {
+            return search.found;
+        }
+        auto flags = std::regex_constants::match_default;
+        if (pos > 0)
+        {
+            flags |= std::regex_constants::match_prev_avail;
+        }
+        search.found = std::regex_search(std::as_const(text_).data() + pos,
+                                         std::as_const(text_).data() + text_.size(),
+                                         search.match,
+                                         regex.re,
+                                         flags);
+        search.from = pos;
+        search.cached = true;
+        return search.found;
+    }
+
+    /// Match `regex` starting exactly at `pos` (not cached: depends on \G).
+    auto match_here(const Regex& regex, Search& search, std::size_t pos) -> bool
+    {
+        auto flags = std::regex_constants::match_continuous;
+        if (pos > 0)
+        {
+            flags |= std::regex_constants::match_prev_avail;
+        }
+        search.cached = false;
+        search.found = std::regex_search(std::as_const(text_).data() + pos,
+                                         std::as_const(text_).data() + text_.size(),
+                                         search.match,
+                                         regex.re,
+                                         flags);
+        return search.found;
+    }
+
+    /// Emit a match in `scope`, with named capture groups painted over it.
+    void paint(const std::cmatch& match,
+               const std::string& scope,
+               const std::vector<Capture>& captures)
+    {
+        const auto start = offset(match[0].first);
+        const auto end = offset(match[0].second);
+        segments_.clear();
+        segments_.push_back({start, end, &scope});
+        for (const auto& capture : captures)
+        {
+            if (capture.group >= match.size() || !match[capture.group].matched ||
+                capture.name.empty())
+            {
+                continue;
+            }
+            const auto from = std::max(offset(match[capture.group].first), start);
+            const auto to = std::min(offset(match[capture.group].second), end);
+            if (from >= to)
+            {
+                continue;
+            }
+            overlay(from, to, &capture.name);
+        }
+        for (const auto& segment : segments_)
+        {
+            emit(segment.start, segment.end, *segment.scope);
+        }
+    }
+
+    void overlay(std::size_t from, std::size_t to, const std::string* scope)
+    {
+        std::vector<Segment> painted;
+        painted.reserve(segments_.size() + 2);
+        for (const auto& segment : segments_)
+        {
+            if (segment.end <= from || segment.start >= to)
+            {
+                painted.push_back(segment);
+                continue;
+            }
+            if (segment.start < from)
+            {
+                painted.push_back({segment.start, from, segment.scope});
+            }
+            painted.push_back({std::max(segment.start, from), std::min(segment.end, to), scope});
+            if (segment.end > to)
+            {
+                painted.push_back({to, segment.end, segment.scope});
+            }
+        }
+        segments_ = std::move(painted);
+    }
+
+    void emit(std::size_t start, std::size_t end, const std::string& scope)
+    {
+        end = std::min(end, line_length_);
+        if (start >= end)
+        {
+            return;
+        }
+        if (!tokens_.empty() && tokens_.back().end_index == static_cast<int>(start) &&
+            tokens_.back().scope == scope)
+        {
+            tokens_.back().end_index = static_cast<int>(end);
+            return;
+        }
+        tokens_.push_back({static_cast<int>(start), static_cast<int>(end), scope});
+    }
+};
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// GrammarEngine
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+
+auto lowercase_ascii(std::string_view text) -> std::string
+{
+    std::string lowered(text);
+    std::transform(lowered.begin(),
+                   lowered.end(),
+                   lowered.begin(),
+                   [](unsigned char chr) { return static_cast<char>(std::tolower(chr)); });
+    return lowered;
+}
+
+} // namespace
+
+auto GrammarEngine::load_grammar(const std::string& path) -> bool
+{
+    std::ifstream file_stream(path);
+    if (!file_stream.is_open())
+    {
+        MARKAMP_LOG_WARN("Cannot open grammar: {}", path);
+        return false;
+    }
+    std::ostringstream content;
+    content << file_stream.rdbuf();
+    return load_grammar_json(content.str(), path);
+}
+
+auto GrammarEngine::load_grammar_json(const std::string& json_text, const std::string& path)
+    -> bool
+{
+    Json root;
+    try
+    {
+        root = Json::parse(json_text);
+    }
+    catch (const Json::parse_error& err)
+    {
+        MARKAMP_LOG_WARN("Invalid grammar JSON {}: {}", path, err.what());
+        return false;
+    }
+    if (!root.is_object() || !root.contains("scopeName") || !root["scopeName"].is_string())
+    {
+        MARKAMP_LOG_WARN("Grammar {} has no scopeName", path);
+        return false;
+    }
+
+    auto compiled = std::make_shared<CompiledGrammar>();
+    compiled->scope_name = root["scopeName"].get<std::string>();
+    GrammarCompiler(*compiled).compile_root(root);
+    if (compiled->invalid_regexes > 0)
+    {
+        MARKAMP_LOG_DEBUG("Grammar {}: {} of {} patterns unsupported",
+                          compiled->scope_name,
+                          compiled->invalid_regexes,
+                          compiled->regexes.size());
+    }
+
+    Grammar grammar{.scope_name = compiled->scope_name,
+                    .name = root.value("name", compiled->scope_name),
+                    .path = path,
+                    .rules = std::move(compiled)};
+    std::unique_lock lock(mutex_);
+    if (auto found = grammar_index_.find(grammar.scope_name); found != grammar_index_.end())
+    {
+        grammars_[found->second] = std::move(grammar);
+    }
+    else
+    {
+        grammar_index_.emplace(grammar.scope_name, grammars_.size());
+        grammars_.push_back(std::move(grammar));
+    }
+    return true;
+}
+
+void GrammarEngine::set_language_scope(const std::string& language_id,
+                                       const std::string& scope_name)
+{
+    std::unique_lock lock(mutex_);
+    language_scopes_.insert_or_assign(lowercase_ascii(language_id), scope_name);
+}
+
+auto GrammarEngine::scope_for_language(std::string_view language_id) const -> std::string
+{
+    std::shared_lock lock(mutex_);
+    auto scope = language_scopes_.find(lowercase_ascii(language_id));
+    if (scope == language_scopes_.end() || !grammar_index_.contains(scope->second))
+    {
+        return {};
+    }
+    return scope->second;
+}
+
+auto GrammarEngine::get_grammar(const std::string& scope_name) const -> const Grammar*
 {
-    return nullptr;
+    auto found = grammar_index_.find(scope_name);
+    return found == grammar_index_.end() ? nullptr : &grammars_[found->second];
 }
 
-auto GrammarEngine::tokenize_line(const std::string& /*scope_name*/,
-                                  const std::string& /*line*/) const -> std::vector<GrammarToken>
+auto GrammarEngine::tokenize_line(const std::string& scope_name, const std::string& line) const
+    -> std::vector<GrammarToken>
 {
-    return {};
+    return tokenize_line(scope_name, std::string_view(line), GrammarState{}).tokens;
+}
+
+auto GrammarEngine::tokenize_line(const std::string& scope_name,
+                                  std::string_view line,
+                                  const GrammarState& state) const -> GrammarLineResult
+{
+    GrammarLineResult result;
+    auto top = state.top_;
+    if (top == nullptr)
+    {
+        auto grammar = find_compiled(scope_name);
+        if (grammar == nullptr)
+        {
+            return result;
+        }
+        auto root = std::make_shared<Frame>();
+        root->grammar = std::move(grammar);
+        root->name_scope = scope_name;
+        root->content_scope = scope_name;
+        top = std::move(root);
+    }
+
+    if (line.size() > kMaxLineLength)
+    {
+        result.tokens.push_back({0, static_cast<int>(line.size()), top->content_scope});
+        result.end_state.top_ = std::move(top);
+        return result;
+    }
+
+    const GrammarLookup lookup = [this](const std::string& scope) { return find_compiled(scope); };
+    LineTokenizer tokenizer(line, lookup);
+    result.end_state.top_ = tokenizer.run(std::move(top));
+    result.tokens = std::move(tokenizer.tokens());
+    return result;
+}
+
+auto GrammarEngine::retokenize(const std::string& scope_name,
+                               const std::vector<std::string_view>& lines,
+                               std::size_t first_line,
+                               std::size_t min_end_line,
+                               std::vector<GrammarLine>& cache) const -> std::size_t
+{
+    cache.resize(lines.size());
+    first_line = std::min(first_line, lines.size());
+    while (first_line > 0 && !cache[first_line - 1].valid)
+    {
+        --first_line;
+    }
+
+    GrammarState state = first_line > 0 ? cache[first_line - 1].end_state : GrammarState{};
+    for (auto line = first_line; line < lines.size(); ++line)
+    {
+        auto result = tokenize_line(scope_name, lines[line], state);
+        auto& entry = cache[line];
+        // Edited lines still hold the state they ended in before the edit
+        const bool converged = line + 1 >= min_end_line && entry.end_state.top_ != nullptr &&
+                               entry.end_state == result.end_state;
+        entry.tokens = std::move(result.tokens);
+        entry.end_state = result.end_state;
+        entry.valid = true;
+        state = std::move(result.end_state);
+        if (converged)
+        {
+            return line + 1;
+        }
+    }
+    return lines.size();
 }
 
 auto GrammarEngine::grammars() const -> const std::vector<Grammar>&
@@ -26,4 +1581,12 @@ auto GrammarEngine::grammars() const -> const std::vector<Grammar>&
     return grammars_;
 }
 
+auto GrammarEngine::find_compiled(const std::string& scope_name) const
+    -> std::shared_ptr<const CompiledGrammar>
+{
+    std::shared_lock lock(mutex_);
+    auto found = grammar_index_.find(scope_name);
+    return found == grammar_index_.end() ? nullptr : grammars_[found->second].rules;
+}
+
 } // namespace markamp::core
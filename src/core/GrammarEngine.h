@@ -1,7 +1,11 @@
 #pragma once
 
-#include <optional>
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace markamp::core
@@ -10,54 +14,153 @@ namespace markamp::core
 /// A tokenized scope from a grammar rule.
 struct GrammarToken
 {
-    int start_index{0}; ///< Start character offset within the line
-    int end_index{0};   ///< End character offset within the line
-    std::string scope;  ///< TextMate scope name (e.g. "keyword.control.markdown")
+    int start_index{0}; ///< Start byte offset within the line
+    int end_index{0};   ///< End byte offset within the line (exclusive)
+    std::string scope;  ///< Innermost TextMate scope (e.g. "keyword.control.markdown")
 };
 
+/// Rule set compiled from a grammar file (defined in GrammarEngine.cpp).
+struct CompiledGrammar;
+
 /// Represents a loaded TextMate grammar.
 struct Grammar
 {
     std::string scope_name; ///< Top-level scope (e.g. "source.markdown")
     std::string name;       ///< Human-readable name
     std::string path;       ///< File path to the grammar definition
+    std::shared_ptr<const CompiledGrammar> rules; ///< Regexes compiled once at load time
+};
+
+/// Rule stack at the end of a line, carried into the next one.
+///
+/// Opaque to callers; two equal states tokenize every following line
+/// identically, so re-tokenization after an edit can stop once a line ends
+/// in the same state as before (as with AsyncHighlighter's LineState).
+/// A default-constructed state is the start of a document.
+class GrammarState
+{
+public:
+    GrammarState() = default;
+
+    /// Number of rules open at the end of the line (0 at document start).
+    [[nodiscard]] auto depth() const noexcept -> std::size_t;
+
+    friend auto operator==(const GrammarState& lhs, const GrammarState& rhs) noexcept -> bool;
+
+    /// One open rule on the stack (defined in GrammarEngine.cpp).
+    struct Frame;
+
+private:
+    friend class GrammarEngine;
+    std::shared_ptr<const Frame> top_;
+};
+
+/// Tokens of one line and the rule stack it ends in.
+struct GrammarLineResult
+{
+    std::vector<GrammarToken> tokens;
+    GrammarState end_state;
 };
 
-/// Stub engine for TextMate grammar loading and tokenization.
+/// Per-line cache entry for GrammarEngine::retokenize().
 ///
-/// This is a P3 placeholder. MarkAmp currently uses its own `SyntaxHighlighter`
-/// for Markdown highlighting. Full TextMate grammar support would be needed for
-/// extensions that contribute language support (e.g. embedded code blocks).
+/// Clear `valid` on edited lines but keep their `end_state`: re-tokenizing
+/// stops where a line ends in the state it ended in before the edit.
+/// Inserted lines start from a default GrammarLine.
+struct GrammarLine
+{
+    std::vector<GrammarToken> tokens;
+    GrammarState end_state;
+    bool valid{false}; ///< False for lines never tokenized (or edited since)
+};
+
+/// TextMate grammar loader and line tokenizer.
 ///
-/// A complete implementation would:
-/// - Parse `.tmLanguage.json` files
-/// - Build regex-based tokenization rules
-/// - Support scope nesting and grammar injection
+/// Loads `.tmLanguage.json` grammars with match / begin-end / begin-while
+/// rules, captures, nested repositories and includes (`#name`, `$self`,
+/// `$base`, and other loaded grammars by scope name, optionally with
+/// `#name`). Every rule's regexes are compiled once at load time and the
+/// include graph is flattened into one candidate list per rule, so
+/// tokenizing a line only runs regex searches. Search results are reused
+/// within a line while they are still ahead of the scan position, and
+/// patterns anchored with `^` / `\G` are only tried where they can match.
 ///
-/// For now, all methods return empty/default results.
+/// Regexes run on std::regex, so Oniguruma syntax is translated when the
+/// grammar loads: `(?x)` / `(?i)` flags, `\h`, `\A`, `\z`, `\G`, named and
+/// atomic groups, and possessive quantifiers are mapped to ECMAScript
+/// equivalents; lookbehind assertions are dropped (the rule matches a
+/// little more eagerly). Patterns that still fail to compile never match.
+/// Grammar injections and `$N` substitutions in scope names are not
+/// supported.
+///
+/// tokenize_line(), retokenize() and scope_for_language() may run
+/// concurrently with each other and with loading (extensions can add
+/// grammars while editors are tokenizing). get_grammar() and grammars()
+/// return references into the registry and must not race with loading.
 class GrammarEngine
 {
 public:
     GrammarEngine() = default;
 
-    /// Load a grammar from a `.tmLanguage.json` file.
-    /// Stub: always returns false.
+    /// Load a grammar from a `.tmLanguage.json` file. A grammar with the
+    /// same scope name replaces the earlier one.
     auto load_grammar(const std::string& path) -> bool;
 
+    /// Load a grammar from `.tmLanguage.json` text; `path` is informational.
+    auto load_grammar_json(const std::string& json_text, const std::string& path = {}) -> bool;
+
+    /// Map a language ID (e.g. a fenced code block's info string) to the
+    /// scope name of its grammar. IDs are matched case-insensitively; a
+    /// later mapping for the same ID replaces the earlier one.
+    void set_language_scope(const std::string& language_id, const std::string& scope_name);
+
+    /// Scope name of the loaded grammar for `language_id`, or empty if the
+    /// language is unmapped or its grammar is not loaded.
+    [[nodiscard]] auto scope_for_language(std::string_view language_id) const -> std::string;
+
     /// Get a loaded grammar by scope name.
-    /// Stub: always returns nullptr.
     [[nodiscard]] auto get_grammar(const std::string& scope_name) const -> const Grammar*;
 
-    /// Tokenize a single line using the specified grammar.
-    /// Stub: always returns empty vector.
+    /// Tokenize a single line from the start of a document. Returns an
+    /// empty vector if the grammar is not loaded.
     [[nodiscard]] auto tokenize_line(const std::string& scope_name, const std::string& line) const
         -> std::vector<GrammarToken>;
 
+    /// Tokenize a line (without its newline) that follows `state`. Tokens
+    /// cover the whole line.
+    [[nodiscard]] auto tokenize_line(const std::string& scope_name,
+                                     std::string_view line,
+                                     const GrammarState& state) const -> GrammarLineResult;
+
+    /// Re-tokenize `lines` from `first_line` into `cache` (resized to
+    /// match), stopping at the first line at or past `min_end_line` whose
+    /// end state is unchanged. Starts earlier if the line before
+    /// `first_line` is not valid. Returns the line past the last one
+    /// re-tokenized.
+    auto retokenize(const std::string& scope_name,
+                    const std::vector<std::string_view>& lines,
+                    std::size_t first_line,
+                    std::size_t min_end_line,
+                    std::vector<GrammarLine>& cache) const -> std::size_t;
+
     /// List all loaded grammars.
     [[nodiscard]] auto grammars() const -> const std::vector<Grammar>&;
 
+    /// Longer lines are not tokenized: they get one token in the scope the
+    /// previous line ended in, and leave the state unchanged.
+    static constexpr std::size_t kMaxLineLength = 20000;
+
+    /// Begin rules past this nesting depth are ignored.
+    static constexpr std::size_t kMaxStackDepth = 128;
+
 private:
+    mutable std::shared_mutex mutex_; // Guards the three registries below
     std::vector<Grammar> grammars_;
+    std::unordered_map<std::string, std::size_t> grammar_index_; // scope name -> grammars_ index
+    std::unordered_map<std::string, std::string> language_scopes_; // lowercase ID -> scope name
+
+    [[nodiscard]] auto find_compiled(const std::string& scope_name) const
+        -> std::shared_ptr<const CompiledGrammar>;
 };
 
 } // namespace markamp::core
@@ -0,0 +1,189 @@
+#include "HighlightLineCache.h"
+
+#include <algorithm>
+
+namespace markamp::core
+{
+
+void HighlightLineCache::reset(std::size_t line_count, uint64_t version)
+{
+    lines_.assign(line_count, Line{});
+    edit_log_.clear();
+    reset_version_ = version;
+    sent_version_ = version;
+}
+
+void HighlightLineCache::on_lines_changed(std::size_t line, std::ptrdiff_t lines_added)
+{
+    if (lines_.empty())
+    {
+        lines_.resize(1);
+    }
+    line = std::min(line, lines_.size() - 1);
+    lines_[line].tokens.clear();
+
+    const auto next = lines_.begin() + static_cast<std::ptrdiff_t>(line) + 1;
+    if (lines_added > 0)
+    {
+        // New lines inside a block stay code-coloured until the result arrives
+        Line inserted;
+        if (next != lines_.end() && next->kind == HighlightLineKind::Code)
+        {
+            inserted.kind = HighlightLineKind::Code;
+        }
+        lines_.insert(next, static_cast<std::size_t>(lines_added), inserted);
+    }
+    else if (lines_added < 0)
+    {
+        const auto removable = static_cast<std::ptrdiff_t>(lines_.size() - line - 1);
+        lines_.erase(next, next + std::min(-lines_added, removable));
+    }
+
+    log_edit(LineEdit{line, line + 1 + static_cast<std::size_t>(std::max<std::ptrdiff_t>(lines_added, 0)),
+                      lines_added});
+}
+
+void HighlightLineCache::on_columns_changed(std::size_t line,
+                                            std::size_t column,
+                                            std::ptrdiff_t length_delta)
+{
+    log_edit(LineEdit{line, line + 1, 0});
+    if (line >= lines_.size() || length_delta == 0)
+    {
+        return;
+    }
+
+    auto& tokens = lines_[line].tokens;
+    if (length_delta > 0)
+    {
+        const auto inserted = static_cast<std::size_t>(length_delta);
+        for (auto& token : tokens)
+        {
+            if (token.start >= column)
+            {
+                token.start += inserted;
+            }
+            else if (token.start + token.length > column)
+            {
+                token.length += inserted; // Typed inside the token
+            }
+        }
+        return;
+    }
+
+    const auto removed = static_cast<std::size_t>(-length_delta);
+    auto map = [column, removed](std::size_t pos) -> std::size_t
+    {
+        if (pos < column)
+        {
+            return pos;
+        }
+        return pos >= column + removed ? pos - removed : column;
+    };
+    for (auto& token : tokens)
+    {
+        const auto start = map(token.start);
+        token.length = map(token.start + token.length) - start;
+        token.start = start;
+    }
+    std::erase_if(tokens, [](const Token& token) { return token.length == 0; });
+}
+
+auto HighlightLineCache::has_unsent_edit() const noexcept -> bool
+{
+    return !edit_log_.empty() && edit_log_.back().base_version == sent_version_;
+}
+
+auto HighlightLineCache::unsent_edit() const noexcept -> LineEdit
+{
+    return has_unsent_edit() ? edit_log_.back().edit : LineEdit{};
+}
+
+void HighlightLineCache::mark_sent(uint64_t version)
+{
+    sent_version_ = version;
+}
+
+auto HighlightLineCache::apply(const HighlightResult& result) -> std::pair<std::size_t, std::size_t>
+{
+    if (result.version < reset_version_)
+    {
+        return {0, 0};
+    }
+
+    // Results arrive in version order: edits this one already saw are done with
+    while (!edit_log_.empty() && edit_log_.front().base_version < result.version)
+    {
+        edit_log_.pop_front();
+    }
+
+    std::size_t first = lines_.size();
+    std::size_t last = 0;
+    const auto count = std::min(result.line_kinds.size(), result.tokens.size());
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        // Map the result line into current numbering; edited lines are skipped
+        std::size_t line = result.start_line + index;
+        bool live = true;
+        for (const auto& logged : edit_log_)
+        {
+            const auto& edit = logged.edit;
+            if (line < edit.first_line)
+            {
+                continue;
+            }
+            if (line >= edit.old_end_line())
+            {
+                line = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(line) + edit.line_delta);
+                continue;
+            }
+            live = false;
+            break;
+        }
+        if (!live || line >= lines_.size())
+        {
+            continue;
+        }
+
+        auto& target = lines_[line];
+        target.kind = result.line_kinds[index];
+        target.tokens = result.tokens[index];
+        target.dirty = true;
+        first = std::min(first, line);
+        last = std::max(last, line + 1);
+    }
+
+    if (first >= last)
+    {
+        return {0, 0};
+    }
+    return {first, last};
+}
+
+auto HighlightLineCache::line(std::size_t index) const noexcept -> const Line&
+{
+    static const Line kPlainLine;
+    return index < lines_.size() ? lines_[index] : kPlainLine;
+}
+
+void HighlightLineCache::mark_clean(std::size_t first, std::size_t last) noexcept
+{
+    last = std::min(last, lines_.size());
+    for (auto index = first; index < last; ++index)
+    {
+        lines_[index].dirty = false;
+    }
+}
+
+void HighlightLineCache::log_edit(const LineEdit& edit)
+{
+    // One entry per sent version: later edits fold into the open one
+    if (has_unsent_edit())
+    {
+        edit_log_.back().edit = edit_log_.back().edit.merged_with(edit);
+        return;
+    }
+    edit_log_.push_back(LoggedEdit{sent_version_, edit});
+}
+
+} // namespace markamp::core
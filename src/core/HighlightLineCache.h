@@ -0,0 +1,94 @@
+#pragma once
+
+#include "AsyncHighlighter.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace markamp::core
+{
+
+/// UI-thread copy of Markdown-mode AsyncHighlighter results, kept in the
+/// editor's current line numbering.
+///
+/// Results describe the text of the version they were lexed from, which the
+/// user may have edited since. The cache logs the line edits made after each
+/// version was sent and maps incoming result lines through them; lines that
+/// were edited in the meantime are skipped, since the newer pass re-lexes
+/// them anyway. Lines changed by a result stay `dirty` until mark_clean(),
+/// so the editor can restyle them lazily once they scroll into view.
+///
+/// Pattern implemented: #5 Asynchronous syntax highlighting with incremental tokenization
+class HighlightLineCache
+{
+public:
+    struct Line
+    {
+        HighlightLineKind kind{HighlightLineKind::Markdown};
+        bool dirty{false};
+        std::vector<Token> tokens; // Line-relative, see HighlightResult::line_kinds
+    };
+
+    /// Start over with `line_count` plain lines; results older than
+    /// `version` (the AsyncHighlighter::set_markdown() return) are ignored.
+    void reset(std::size_t line_count, uint64_t version);
+
+    /// The document changed on `line`, and `lines_added` lines were inserted
+    /// after it (removed, if negative). Call once per modification, in order.
+    void on_lines_changed(std::size_t line, std::ptrdiff_t lines_added);
+
+    /// Single-line edit: `length_delta` bytes were inserted (removed, if
+    /// negative) at `column`. Shifts the line's tokens to keep them aligned
+    /// until the re-lexed result arrives.
+    void on_columns_changed(std::size_t line, std::size_t column, std::ptrdiff_t length_delta);
+
+    /// Whether lines changed since the last mark_sent().
+    [[nodiscard]] auto has_unsent_edit() const noexcept -> bool;
+
+    /// The edits since the last mark_sent(), folded into one (for
+    /// AsyncHighlighter::update_markdown()).
+    [[nodiscard]] auto unsent_edit() const noexcept -> LineEdit;
+
+    /// The text including every edit so far was sent as `version`.
+    void mark_sent(uint64_t version);
+
+    /// Store a result. Returns the current lines it updated as [first, last),
+    /// or an empty range if the result was stale or entirely overwritten.
+    auto apply(const HighlightResult& result) -> std::pair<std::size_t, std::size_t>;
+
+    [[nodiscard]] auto line_count() const noexcept -> std::size_t
+    {
+        return lines_.size();
+    }
+
+    /// Line state; out-of-range lines read as plain Markdown.
+    [[nodiscard]] auto line(std::size_t index) const noexcept -> const Line&;
+
+    [[nodiscard]] auto is_dirty(std::size_t index) const noexcept -> bool
+    {
+        return index < lines_.size() && lines_[index].dirty;
+    }
+
+    /// Clear the dirty flag on lines [first, last).
+    void mark_clean(std::size_t first, std::size_t last) noexcept;
+
+private:
+    /// Edits made after `base_version` was sent (so missing from it).
+    struct LoggedEdit
+    {
+        uint64_t base_version{0};
+        LineEdit edit;
+    };
+
+    void log_edit(const LineEdit& edit);
+
+    std::vector<Line> lines_;
+    std::deque<LoggedEdit> edit_log_;
+    uint64_t reset_version_{0};
+    uint64_t sent_version_{0};
+};
+
+} // namespace markamp::core
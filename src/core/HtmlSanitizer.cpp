@@ -4,11 +4,39 @@
 
 #include <algorithm>
 #include <cctype>
-#include <sstream>
+#include <initializer_list>
 
 namespace markamp::core
 {
 
+namespace
+{
+
+auto to_lower_ascii(char chr) -> char
+{
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(chr)));
+}
+
+/// `prefix` must be lowercase.
+auto starts_with_ignoring_case(std::string_view text, std::string_view prefix) -> bool
+{
+    return text.size() >= prefix.size() &&
+           std::equal(prefix.begin(),
+                      prefix.end(),
+                      text.begin(),
+                      [](char lower, char chr) { return lower == to_lower_ascii(chr); });
+}
+
+/// `needle` must be lowercase.
+auto contains_ignoring_case(std::string_view text, std::string_view needle) -> bool
+{
+    auto equal = [](char chr, char lower) { return to_lower_ascii(chr) == lower; };
+    return needle.empty() ||
+           std::search(text.begin(), text.end(), needle.begin(), needle.end(), equal) != text.end();
+}
+
+} // anonymous namespace
+
 // ═══════════════════════════════════════════════════════
 // Construction
 // ═══════════════════════════════════════════════════════
@@ -213,23 +241,31 @@ void HtmlSanitizer::block_tag(const std::string& tag)
 auto HtmlSanitizer::sanitize(std::string_view html) const -> std::string
 {
     MARKAMP_PROFILE_SCOPE("HtmlSanitizer::sanitize");
+    std::string result;
+    result.reserve(html.size());
+    sanitize_into(html, result);
+    return result;
+}
+
+void HtmlSanitizer::sanitize_into(std::string_view html, std::string& output) const
+{
+    // Not profiled: called once per rendered block
 
     // New stability #36: input length limit (10MB) to prevent processing massive input
     constexpr size_t kMaxInputSize = 10 * 1024 * 1024;
     if (html.size() > kMaxInputSize)
     {
-        return std::string(html.substr(0, kMaxInputSize));
+        output.append(html.substr(0, kMaxInputSize));
+        return;
     }
 
     // Early return: if there's no '<', the input has no tags to sanitize
     if (html.find('<') == std::string_view::npos)
     {
-        return std::string(html);
+        output.append(html);
+        return;
     }
 
-    std::string result;
-    result.reserve(html.size());
-
     size_t pos = 0;
     // New stability #37: iteration cap to prevent infinite-loop-like processing
     constexpr size_t kMaxTagIterations = 100000;
@@ -239,7 +275,7 @@ auto HtmlSanitizer::sanitize(std::string_view html) const -> std::string
         if (++tag_iterations > kMaxTagIterations)
         {
             // Append remaining untouched and bail
-            result.append(html.substr(pos));
+            output.append(html.substr(pos));
             break;
         }
         // Find next tag
@@ -247,66 +283,40 @@ auto HtmlSanitizer::sanitize(std::string_view html) const -> std::string
         if (tag_start == std::string_view::npos)
         {
             // No more tags — append remaining text
-            result.append(html.substr(pos));
+            output.append(html.substr(pos));
             break;
         }
 
         // Append text before the tag
-        result.append(html.substr(pos, tag_start - pos));
+        output.append(html.substr(pos, tag_start - pos));
 
         // Find end of tag
         auto tag_end = html.find('>', tag_start);
         if (tag_end == std::string_view::npos)
         {
             // Malformed tag — treat rest as text and escape the <
-            result += "&lt;";
+            output += "&lt;";
             pos = tag_start + 1;
             continue;
         }
 
-        // Extract tag content (between < and >)
-        auto tag_content = html.substr(tag_start + 1, tag_end - tag_start - 1);
-
-        // Process the tag
-        auto sanitized = sanitize_tag(tag_content);
-        if (!sanitized.empty())
-        {
-            result += sanitized;
-        }
+        // Process the tag content (between < and >)
+        append_sanitized_tag(html.substr(tag_start + 1, tag_end - tag_start - 1), output);
 
         pos = tag_end + 1;
     }
-
-    return result;
 }
 
 // ═══════════════════════════════════════════════════════
 // Tag processing
 // ═══════════════════════════════════════════════════════
 
-auto HtmlSanitizer::sanitize_tag(std::string_view tag_content) const -> std::string
+void HtmlSanitizer::append_sanitized_tag(std::string_view tag_content, std::string& output) const
 {
-    if (tag_content.empty())
-    {
-        return {};
-    }
-
-    // Handle comments — strip them
-    if (tag_content.starts_with("!--"))
-    {
-        return {};
-    }
-
-    // Handle CDATA — strip
-    if (tag_content.starts_with("![CDATA["))
+    // Comments, CDATA and DOCTYPE are stripped
+    if (tag_content.empty() || tag_content.starts_with("!"))
     {
-        return {};
-    }
-
-    // Handle DOCTYPE — strip
-    if (tag_content.starts_with("!"))
-    {
-        return {};
+        return;
     }
 
     // Determine if closing tag
@@ -320,60 +330,50 @@ auto HtmlSanitizer::sanitize_tag(std::string_view tag_content) const -> std::str
         content = content.substr(0, content.size() - 1);
     }
 
-    // Extract tag name (first word)
+    // Extract tag name (first word); names of allowed tags fit the SSO buffer
     std::string tag_name;
     size_t name_end = 0;
     while (name_end < content.size() &&
            std::isspace(static_cast<unsigned char>(content[name_end])) == 0)
     {
-        tag_name += static_cast<char>(std::tolower(static_cast<unsigned char>(content[name_end])));
+        tag_name += to_lower_ascii(content[name_end]);
         ++name_end;
     }
 
     if (tag_name.empty())
     {
-        return {};
+        return;
     }
 
-    // Check if blocked
-    if (blocked_tags_.contains(tag_name))
+    // Check if blocked, then if allowed
+    if (blocked_tags_.contains(tag_name) || !is_tag_allowed(tag_name))
     {
-        return {};
+        return;
     }
 
-    // Check if allowed
-    if (!is_tag_allowed(tag_name))
-    {
-        return {};
-    }
+    auto attrs_part = content.substr(name_end);
 
     // Special check: input must be checkbox
-    if (tag_name == "input")
+    if (tag_name == "input" &&
+        (!contains_ignoring_case(attrs_part, "type") ||
+         !contains_ignoring_case(attrs_part, "checkbox")))
     {
-        auto attrs_str = content.substr(name_end);
-        std::string lower_attrs(attrs_str);
-        std::transform(lower_attrs.begin(),
-                       lower_attrs.end(),
-                       lower_attrs.begin(),
-                       [](unsigned char chr) { return std::tolower(chr); });
-        if (lower_attrs.find("type") == std::string::npos ||
-            lower_attrs.find("checkbox") == std::string::npos)
-        {
-            return {}; // Only checkbox inputs allowed
-        }
+        return; // Only checkbox inputs allowed
     }
 
-    // For closing tags, just return the tag
+    // For closing tags, just emit the tag
     if (is_closing)
     {
-        return "</" + tag_name + ">";
+        output += "</";
+        output += tag_name;
+        output += '>';
+        return;
     }
 
-    // Parse and filter attributes
-    std::string safe_attrs;
-    auto attrs_part = content.substr(name_end);
+    output += '<';
+    output += tag_name;
 
-    // Simple attribute parser
+    // Simple attribute parser; allowed attributes are appended as they are found
     size_t attr_pos = 0;
     // New stability #38: cap attribute count per tag to 50
     int attr_count = 0;
@@ -399,8 +399,7 @@ auto HtmlSanitizer::sanitize_tag(std::string_view tag_content) const -> std::str
                std::isspace(static_cast<unsigned char>(attrs_part[attr_pos])) == 0 &&
                attrs_part[attr_pos] != '=' && attrs_part[attr_pos] != '/')
         {
-            attr_name +=
-                static_cast<char>(std::tolower(static_cast<unsigned char>(attrs_part[attr_pos])));
+            attr_name += to_lower_ascii(attrs_part[attr_pos]);
             ++attr_pos;
         }
 
@@ -416,7 +415,7 @@ auto HtmlSanitizer::sanitize_tag(std::string_view tag_content) const -> std::str
             ++attr_pos;
         }
 
-        std::string attr_value;
+        std::string_view attr_value;
         if (attr_pos < attrs_part.size() && attrs_part[attr_pos] == '=')
         {
             ++attr_pos; // Skip =
@@ -431,14 +430,15 @@ auto HtmlSanitizer::sanitize_tag(std::string_view tag_content) const -> std::str
             if (attr_pos < attrs_part.size())
             {
                 const char quote = attrs_part[attr_pos];
+                size_t value_start = attr_pos;
                 if (quote == '"' || quote == '\'')
                 {
-                    ++attr_pos; // Skip opening quote
+                    value_start = ++attr_pos; // Skip opening quote
                     while (attr_pos < attrs_part.size() && attrs_part[attr_pos] != quote)
                     {
-                        attr_value += attrs_part[attr_pos];
                         ++attr_pos;
                     }
+                    attr_value = attrs_part.substr(value_start, attr_pos - value_start);
                     if (attr_pos < attrs_part.size())
                     {
                         ++attr_pos; // Skip closing quote
@@ -451,9 +451,9 @@ auto HtmlSanitizer::sanitize_tag(std::string_view tag_content) const -> std::str
                            std::isspace(static_cast<unsigned char>(attrs_part[attr_pos])) == 0 &&
                            attrs_part[attr_pos] != '>')
                     {
-                        attr_value += attrs_part[attr_pos];
                         ++attr_pos;
                     }
+                    attr_value = attrs_part.substr(value_start, attr_pos - value_start);
                 }
             }
         }
@@ -461,23 +461,19 @@ auto HtmlSanitizer::sanitize_tag(std::string_view tag_content) const -> std::str
         // Validate attribute
         if (is_attribute_allowed(tag_name, attr_name, attr_value))
         {
-            safe_attrs.append(" ");
-            safe_attrs.append(attr_name);
-            safe_attrs.append("=\"");
-            safe_attrs.append(attr_value);
-            safe_attrs.append("\"");
+            output += ' ';
+            output += attr_name;
+            output += "=\"";
+            output += attr_value;
+            output += '"';
         }
     }
 
-    // Reconstruct tag
-    std::string result = "<" + tag_name + safe_attrs;
     if (is_self_closing)
     {
-        result += " /";
+        output += " /";
     }
-    result += ">";
-
-    return result;
+    output += '>';
 }
 
 // ═══════════════════════════════════════════════════════
@@ -540,16 +536,9 @@ auto HtmlSanitizer::is_attribute_allowed(std::string_view tag,
     // Restrict class to safe prefixes (language-, mermaid-, token-, code-)
     if (attr == "class")
     {
-        // Allow common CSS class patterns, block script-like values
-        auto val_str = std::string(value);
-        std::string lower_val = val_str;
-        std::transform(lower_val.begin(),
-                       lower_val.end(),
-                       lower_val.begin(),
-                       [](unsigned char chr) { return std::tolower(chr); });
         // Block classes containing javascript or script
-        if (lower_val.find("javascript") != std::string::npos ||
-            lower_val.find("<script") != std::string::npos)
+        if (contains_ignoring_case(value, "javascript") ||
+            contains_ignoring_case(value, "<script"))
         {
             return false;
         }
@@ -560,67 +549,43 @@ auto HtmlSanitizer::is_attribute_allowed(std::string_view tag,
 
 auto HtmlSanitizer::is_safe_uri(std::string_view uri) -> bool
 {
-    // Normalize for comparison
-    std::string lower_uri(uri);
-    std::transform(lower_uri.begin(),
-                   lower_uri.end(),
-                   lower_uri.begin(),
-                   [](unsigned char chr) { return std::tolower(chr); });
-
     // Strip leading whitespace and control characters
     size_t start = 0;
-    while (start < lower_uri.size() &&
-           (std::isspace(static_cast<unsigned char>(lower_uri[start])) != 0 ||
-            static_cast<unsigned char>(lower_uri[start]) < 0x20))
+    while (start < uri.size() && (std::isspace(static_cast<unsigned char>(uri[start])) != 0 ||
+                                  static_cast<unsigned char>(uri[start]) < 0x20))
     {
         ++start;
     }
-    if (start > 0)
-    {
-        lower_uri = lower_uri.substr(start);
-    }
+    uri.remove_prefix(start);
 
     // Block dangerous URI schemes
-    if (lower_uri.starts_with("javascript:") || lower_uri.starts_with("vbscript:") ||
-        lower_uri.starts_with("data:text/html"))
+    if (starts_with_ignoring_case(uri, "javascript:") ||
+        starts_with_ignoring_case(uri, "vbscript:") ||
+        starts_with_ignoring_case(uri, "data:text/html"))
     {
         return false;
     }
 
     // Block data: URIs with SVG content (can contain scripts)
-    if (lower_uri.starts_with("data:image/svg"))
-    {
-        return false;
-    }
-
-    return true;
+    return !starts_with_ignoring_case(uri, "data:image/svg");
 }
 
 auto HtmlSanitizer::is_safe_style(std::string_view style) -> bool
 {
-    std::string lower_style(style);
-    std::transform(lower_style.begin(),
-                   lower_style.end(),
-                   lower_style.begin(),
-                   [](unsigned char chr) { return std::tolower(chr); });
-
-    // Block dangerous CSS constructs
-    if (lower_style.find("expression(") != std::string::npos ||
-        lower_style.find("javascript:") != std::string::npos ||
-        lower_style.find("vbscript:") != std::string::npos ||
-        lower_style.find("@import") != std::string::npos ||
-        lower_style.find("behavior:") != std::string::npos ||
-        lower_style.find("-moz-binding") != std::string::npos)
+    // Block dangerous CSS constructs, and url() (can lead to data exfiltration)
+    for (const std::string_view construct : {"expression(",
+                                             "javascript:",
+                                             "vbscript:",
+                                             "@import",
+                                             "behavior:",
+                                             "-moz-binding",
+                                             "url("})
     {
-        return false;
-    }
-
-    // Block url() in styles (can lead to data exfiltration)
-    if (lower_style.find("url(") != std::string::npos)
-    {
-        return false;
+        if (contains_ignoring_case(style, construct))
+        {
+            return false;
+        }
     }
-
     return true;
 }
 
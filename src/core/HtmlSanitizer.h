@@ -22,6 +22,11 @@ public:
     /// Safe HTML passes through unchanged.
     [[nodiscard]] auto sanitize(std::string_view html) const -> std::string;
 
+    /// Append the sanitized form of `html` to `output`. Does not allocate
+    /// beyond growing `output`, so callers can sanitize a document piece by
+    /// piece into one reused buffer. Each call must contain whole tags.
+    void sanitize_into(std::string_view html, std::string& output) const;
+
     /// Add a tag to the allowed set.
     void allow_tag(const std::string& tag);
 
@@ -49,8 +54,8 @@ private:
     /// Check if a style value is safe (no expression(), url(), import).
     [[nodiscard]] static auto is_safe_style(std::string_view style) -> bool;
 
-    /// Sanitize a single HTML tag, returning sanitized version or empty.
-    [[nodiscard]] auto sanitize_tag(std::string_view tag_content) const -> std::string;
+    /// Append the sanitized version of a single HTML tag (nothing if dropped).
+    void append_sanitized_tag(std::string_view tag_content, std::string& output) const;
 
     std::set<std::string, std::less<>> allowed_tags_;
     std::set<std::string, std::less<>> blocked_tags_;
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <expected>
+#include <functional>
+#include <optional>
 #include <string>
 #include <string_view>
 
@@ -17,6 +20,26 @@ public:
     [[nodiscard]] virtual auto render(std::string_view mermaid_source)
         -> std::expected<std::string, std::string> = 0;
     [[nodiscard]] virtual auto is_available() const -> bool = 0;
+
+    /// Non-blocking render: the result if it is ready, otherwise std::nullopt
+    /// after scheduling the diagram in the background. Renderers without a
+    /// background path render synchronously.
+    [[nodiscard]] virtual auto try_render(std::string_view mermaid_source)
+        -> std::optional<std::expected<std::string, std::string>>
+    {
+        return render(mermaid_source);
+    }
+
+    /// Register `callback` to run (on a background thread) each time a
+    /// diagram scheduled by try_render() finishes. Returns a handle for
+    /// remove_ready_listener().
+    virtual auto add_ready_listener(std::function<void()> /*callback*/) -> std::size_t
+    {
+        return 0;
+    }
+
+    /// Unregister a listener. Once this returns the callback no longer runs.
+    virtual void remove_ready_listener(std::size_t /*handle*/) {}
 };
 
 } // namespace markamp::core
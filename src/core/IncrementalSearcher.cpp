@@ -1,17 +1,28 @@
 #include "IncrementalSearcher.h"
 
+#include "Logger.h"
+#include "SearchPattern.h"
+
 #include <algorithm>
-#include <cctype>
+#include <condition_variable>
+#include <mutex>
 
 namespace markamp::core
 {
 
+IncrementalSearcher::IncrementalSearcher(std::size_t worker_count, std::size_t chunk_size)
+    : worker_count_(worker_count != 0 ? worker_count
+                                      : std::max(1U, std::thread::hardware_concurrency()))
+    , chunk_size_(std::max<std::size_t>(chunk_size, 1))
+{
+}
+
 IncrementalSearcher::~IncrementalSearcher()
 {
     cancel();
 }
 
-void IncrementalSearcher::search(const std::string& content,
+void IncrementalSearcher::search(std::string content,
                                  SearchConfig config,
                                  MatchCallback on_match,
                                  CompleteCallback on_complete)
@@ -25,7 +36,7 @@ void IncrementalSearcher::search(const std::string& content,
     searching_.store(true, std::memory_order_release);
     worker_ = std::thread(
         [this,
-         content_copy = content,
+         content_copy = std::move(content),
          cfg = std::move(config),
          match_cb = std::move(on_match),
          complete_cb = std::move(on_complete),
@@ -63,82 +74,145 @@ void IncrementalSearcher::search_worker(CancelToken cancel,
                                         CompleteCallback on_complete,
                                         uint64_t version)
 {
-    std::size_t total_matches = 0;
-    std::size_t line_number = 0;
-    std::size_t line_start = 0;
-
-    // Prepare needle for case-insensitive search
-    std::string needle = config.needle;
-    std::string search_content = content;
-    if (!config.case_sensitive)
+    auto pattern = SearchPattern::compile(config);
+    if (!pattern)
     {
-        std::transform(needle.begin(),
-                       needle.end(),
-                       needle.begin(),
-                       [](unsigned char character)
-                       { return static_cast<char>(std::tolower(character)); });
-        std::transform(search_content.begin(),
-                       search_content.end(),
-                       search_content.begin(),
-                       [](unsigned char character)
-                       { return static_cast<char>(std::tolower(character)); });
+        MARKAMP_LOG_WARN("Search not started: {}", pattern.error());
+        if (on_complete && coalescing_.is_current(version))
+        {
+            on_complete(0);
+        }
+        searching_.store(false, std::memory_order_release);
+        return;
     }
 
-    for (std::size_t idx = 0; idx < search_content.size(); ++idx)
+    // Split at line ends so no match crosses a chunk (a needle containing
+    // '\n' is scanned as one chunk)
+    const std::string_view text = content;
+    std::vector<std::size_t> bounds{0};
+    if (!pattern->spans_lines())
     {
-        if (cancel.stop_requested() || !coalescing_.is_current(version))
+        while (text.size() - bounds.back() > chunk_size_)
         {
-            searching_.store(false, std::memory_order_release);
-            return;
+            const auto cut = text.find('\n', bounds.back() + chunk_size_ - 1);
+            if (cut == std::string_view::npos)
+            {
+                break;
+            }
+            bounds.push_back(cut + 1);
         }
+    }
+    if (bounds.back() != text.size())
+    {
+        bounds.push_back(text.size());
+    }
+    const std::size_t chunk_count = bounds.size() - 1;
+
+    struct ChunkResult
+    {
+        std::vector<SearchHit> hits;
+        std::size_t newlines{0};
+        bool done{false};
+    };
+    std::vector<ChunkResult> results(chunk_count);
+    std::mutex results_mutex;
+    std::condition_variable results_cv;
+    std::atomic<std::size_t> next_chunk{0};
+    std::atomic<bool> aborted{false};
+    auto stopped = [&]
+    {
+        return aborted.load(std::memory_order_relaxed) || cancel.stop_requested() ||
+               !coalescing_.is_current(version);
+    };
 
-        // Track line boundaries
-        if (idx > 0 && content[idx - 1] == '\n')
+    // Claim and scan the next chunk; false once all are claimed. Chunks
+    // claimed after a stop are marked done without scanning.
+    auto scan_next_chunk = [&]() -> bool
+    {
+        const auto index = next_chunk.fetch_add(1, std::memory_order_relaxed);
+        if (index >= chunk_count)
+        {
+            return false;
+        }
+        ChunkResult result;
+        if (!stopped())
+        {
+            result.newlines = pattern->find_all(
+                text.substr(bounds[index], bounds[index + 1] - bounds[index]), result.hits);
+        }
+        result.done = true;
         {
-            ++line_number;
-            line_start = idx;
+            std::lock_guard lock(results_mutex);
+            results[index] = std::move(result);
         }
+        results_cv.notify_all();
+        return true;
+    };
+
+    std::vector<std::thread> helpers;
+    const auto helper_count = std::min(worker_count_, chunk_count) - (chunk_count > 0 ? 1 : 0);
+    helpers.reserve(helper_count);
+    for (std::size_t helper = 0; helper < helper_count; ++helper)
+    {
+        helpers.emplace_back(
+            [&scan_next_chunk]
+            {
+                while (scan_next_chunk())
+                {
+                }
+            });
+    }
 
-        // Check for match at current position
-        if (idx + needle.size() <= search_content.size() &&
-            search_content.compare(idx, needle.size(), needle) == 0)
+    // This thread scans too, but delivers finished chunks in order first
+    std::size_t total_matches = 0;
+    std::size_t line_base = 0;
+    for (std::size_t delivered = 0; delivered < chunk_count && !stopped(); ++delivered)
+    {
+        ChunkResult ready;
         {
-            // Check whole-word boundary if needed
-            if (config.whole_word)
+            std::unique_lock lock(results_mutex);
+            while (!results[delivered].done)
             {
-                bool left_boundary =
-                    (idx == 0) || !std::isalnum(static_cast<unsigned char>(content[idx - 1]));
-                bool right_boundary =
-                    (idx + needle.size() >= content.size()) ||
-                    !std::isalnum(static_cast<unsigned char>(content[idx + needle.size()]));
-                if (!left_boundary || !right_boundary)
+                lock.unlock();
+                if (!scan_next_chunk())
                 {
-                    continue;
+                    lock.lock();
+                    results_cv.wait(lock, [&] { return results[delivered].done; });
+                    break;
                 }
+                lock.lock();
             }
+            ready = std::move(results[delivered]);
+        }
 
-            ++total_matches;
-
-            // Find end of current line for context
-            auto line_end = content.find('\n', line_start);
-            if (line_end == std::string::npos)
+        const char* chunk_data = text.data() + bounds[delivered];
+        for (const auto& hit : ready.hits)
+        {
+            if (stopped())
             {
-                line_end = content.size();
+                break;
             }
-            std::string_view line_context(content.data() + line_start, line_end - line_start);
-
-            if (on_match)
+            ++total_matches;
+            if (on_match &&
+                !on_match(line_base + hit.line,
+                          hit.offset - hit.line_start,
+                          std::string_view(chunk_data + hit.line_start,
+                                           hit.line_end - hit.line_start)))
             {
-                bool should_continue = on_match(line_number, idx - line_start, line_context);
-                if (!should_continue)
-                {
-                    break;
-                }
+                aborted.store(true, std::memory_order_relaxed);
+                break;
             }
         }
+        line_base += ready.newlines;
+    }
+
+    aborted.store(true, std::memory_order_relaxed); // Let helpers drain unclaimed chunks
+    for (auto& helper : helpers)
+    {
+        helper.join();
     }
 
-    if (on_complete && coalescing_.is_current(version))
+    if (on_complete && !cancel.stop_requested() && coalescing_.is_current(version))
     {
         on_complete(total_matches);
     }
@@ -28,6 +28,7 @@ struct SearchConfig
     std::string needle;
     bool case_sensitive{true};
     bool whole_word{false};
+    bool use_regex{false}; // ECMAScript; matches never span lines
 };
 
 /// Background incremental searcher with progressive result delivery.
@@ -37,6 +38,12 @@ struct SearchConfig
 /// found, allowing the UI to update incrementally. Uses
 /// CoalescingTask so new searches cancel previous ones.
 ///
+/// Content larger than one chunk is split at line boundaries and the
+/// chunks are scanned by up to `worker_count` threads with SearchPattern
+/// (SIMD literal filter, or per-line regex). Matches are still delivered
+/// in document order: a chunk's matches go out once every chunk before it
+/// has been delivered.
+///
 /// Pattern implemented: #15 Incremental search with background indexing
 class IncrementalSearcher
 {
@@ -48,7 +55,11 @@ public:
     /// Callback when search is complete. Receives total match count.
     using CompleteCallback = std::function<void(std::size_t total_matches)>;
 
-    IncrementalSearcher() = default;
+    /// `worker_count` 0 uses one thread per hardware thread; `chunk_size`
+    /// is the number of bytes each scan task covers (rounded up to the
+    /// next line end).
+    explicit IncrementalSearcher(std::size_t worker_count = 0,
+                                 std::size_t chunk_size = kDefaultChunkSize);
     ~IncrementalSearcher();
 
     // Non-copyable, non-movable
@@ -57,8 +68,10 @@ public:
     IncrementalSearcher(IncrementalSearcher&&) = delete;
     auto operator=(IncrementalSearcher&&) -> IncrementalSearcher& = delete;
 
-    /// Start a new search. Cancels any in-flight search.
-    void search(const std::string& content,
+    /// Start a new search. Cancels any in-flight search. Pass the content
+    /// as an rvalue to avoid copying it. An invalid regex completes with
+    /// zero matches.
+    void search(std::string content,
                 SearchConfig config,
                 MatchCallback on_match,
                 CompleteCallback on_complete);
@@ -69,7 +82,11 @@ public:
     /// Check if a search is currently running.
     [[nodiscard]] auto is_searching() const noexcept -> bool;
 
+    static constexpr std::size_t kDefaultChunkSize = 4 * 1024 * 1024;
+
 private:
+    std::size_t worker_count_;
+    std::size_t chunk_size_;
     CoalescingTask coalescing_;
     std::thread worker_;
     std::atomic<bool> searching_{false};
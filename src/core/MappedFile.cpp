@@ -0,0 +1,133 @@
+#include "MappedFile.h"
+
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MARKAMP_HAS_MMAP 1
+#endif
+
+namespace markamp::core
+{
+
+namespace
+{
+
+[[nodiscard]] auto read_into(const std::filesystem::path& path, std::size_t size, std::string& out)
+    -> std::expected<void, std::string>
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return std::unexpected("Cannot open file: " + path.string());
+    }
+    out.resize(size);
+    if (size > 0 && !file.read(out.data(), static_cast<std::streamsize>(size)))
+    {
+        return std::unexpected("Read failed: " + path.string());
+    }
+    return {};
+}
+
+} // anonymous namespace
+
+auto MappedFile::open(const std::filesystem::path& path, std::size_t map_threshold)
+    -> std::expected<MappedFile, std::string>
+{
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        return std::unexpected("Cannot open file: " + path.string() + " (" + error.message() +
+                               ")");
+    }
+
+    MappedFile file;
+#if defined(MARKAMP_HAS_MMAP)
+    if (size >= map_threshold && size > 0)
+    {
+        const int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (descriptor < 0)
+        {
+            return std::unexpected("Cannot open file: " + path.string());
+        }
+        void* mapping =
+            ::mmap(nullptr, static_cast<std::size_t>(size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        ::close(descriptor); // The mapping keeps the file referenced
+        if (mapping != MAP_FAILED)
+        {
+            ::madvise(mapping, static_cast<std::size_t>(size), MADV_SEQUENTIAL);
+            file.mapping_ = mapping;
+            file.mapped_size_ = static_cast<std::size_t>(size);
+            return file;
+        }
+        // Some file systems cannot be mapped; read instead
+    }
+#else
+    (void)map_threshold;
+#endif
+
+    auto read = read_into(path, static_cast<std::size_t>(size), file.owned_);
+    if (!read)
+    {
+        return std::unexpected(read.error());
+    }
+    return file;
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mapping_(std::exchange(other.mapping_, nullptr))
+    , mapped_size_(std::exchange(other.mapped_size_, 0))
+    , owned_(std::move(other.owned_))
+{
+}
+
+auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile&
+{
+    if (this != &other)
+    {
+        unmap();
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        mapped_size_ = std::exchange(other.mapped_size_, 0);
+        owned_ = std::move(other.owned_);
+    }
+    return *this;
+}
+
+auto MappedFile::bytes() const noexcept -> std::string_view
+{
+    if (mapping_ != nullptr)
+    {
+        return {static_cast<const char*>(mapping_), mapped_size_};
+    }
+    return owned_;
+}
+
+auto MappedFile::is_mapped() const noexcept -> bool
+{
+    return mapping_ != nullptr;
+}
+
+void MappedFile::unmap() noexcept
+{
+#if defined(MARKAMP_HAS_MMAP)
+    if (mapping_ != nullptr)
+    {
+        ::munmap(mapping_, mapped_size_);
+    }
+#endif
+    mapping_ = nullptr;
+    mapped_size_ = 0;
+}
+
+} // namespace markamp::core
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace markamp::core
+{
+
+/// Read-only view of a whole file.
+///
+/// Files at or above the map threshold are memory-mapped (POSIX mmap,
+/// advised for sequential access), so opening them costs no read and no
+/// copy; pages fault in as the bytes are first touched. Smaller files, and
+/// every file on platforms without mmap, are read into an owned buffer.
+/// Either way bytes() stays valid, and unchanged, for the object's
+/// lifetime. A mapped file that is truncated by another process while
+/// mapped raises SIGBUS on access, as with any mmap reader.
+///
+/// Pattern implemented: #18 Predictable I/O never on the hot path
+class MappedFile
+{
+public:
+    static constexpr std::size_t kDefaultMapThreshold = static_cast<std::size_t>(1024) * 1024;
+    /// Threshold that reads every file into an owned buffer.
+    static constexpr std::size_t kNeverMap = std::numeric_limits<std::size_t>::max();
+
+    /// Open `path` and map or read all of it.
+    [[nodiscard]] static auto open(const std::filesystem::path& path,
+                                   std::size_t map_threshold = kDefaultMapThreshold)
+        -> std::expected<MappedFile, std::string>;
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+    /// The file's bytes.
+    [[nodiscard]] auto bytes() const noexcept -> std::string_view;
+
+    /// True if bytes() points into a memory mapping.
+    [[nodiscard]] auto is_mapped() const noexcept -> bool;
+
+private:
+    void* mapping_{nullptr};
+    std::size_t mapped_size_{0};
+    std::string owned_;
+
+    void unmap() noexcept;
+};
+
+} // namespace markamp::core
@@ -1,7 +1,7 @@
 #include "Types.h"
 
 #include <algorithm>
-#include <sstream>
+#include <cctype>
 
 namespace markamp::core
 {
@@ -83,20 +83,7 @@ auto MarkdownDocument::heading_count() const -> size_t
 
 auto MarkdownDocument::word_count() const -> size_t
 {
-    auto text = root.plain_text();
-    if (text.empty())
-    {
-        return 0;
-    }
-
-    std::istringstream stream(text);
-    size_t count = 0;
-    std::string word;
-    while (stream >> word)
-    {
-        ++count;
-    }
-    return count;
+    return count_words(root.plain_text());
 }
 
 auto MarkdownDocument::has_mermaid() const -> bool
@@ -119,4 +106,21 @@ auto MarkdownDocument::has_footnotes() const -> bool
     return has_footnotes_;
 }
 
+auto count_words(std::string_view text) -> std::size_t
+{
+    // Same word boundaries as `std::istringstream >> word` in the C locale
+    std::size_t count = 0;
+    bool in_word = false;
+    for (const auto ch : text)
+    {
+        const bool space = std::isspace(static_cast<unsigned char>(ch)) != 0;
+        if (!space && !in_word)
+        {
+            ++count;
+        }
+        in_word = !space;
+    }
+    return count;
+}
+
 } // namespace markamp::core
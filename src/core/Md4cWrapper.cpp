@@ -23,6 +23,204 @@ auto attr_to_string(const MD_ATTRIBUTE& attr) -> std::string
     return std::string(attr.text, attr.size);
 }
 
+auto attr_to_view(const MD_ATTRIBUTE& attr) -> std::string_view
+{
+    if (attr.text == nullptr || attr.size == 0)
+    {
+        return {};
+    }
+    return {attr.text, attr.size};
+}
+
+auto to_alignment(MD_ALIGN align) -> MdAlignment
+{
+    switch (align)
+    {
+        case MD_ALIGN_LEFT:
+            return MdAlignment::Left;
+        case MD_ALIGN_CENTER:
+            return MdAlignment::Center;
+        case MD_ALIGN_RIGHT:
+            return MdAlignment::Right;
+        default:
+            return MdAlignment::Default;
+    }
+}
+
+/// Set the type and attributes of a node for an md4c block (other than the
+/// document). Shared by the MdNode and FlatMdNode builders; `attr_text`
+/// converts an MD_ATTRIBUTE to the node's string type.
+template <typename Node, typename AttrText>
+void describe_block(Node& node, MD_BLOCKTYPE block_type, void* detail, AttrText attr_text)
+{
+    switch (block_type)
+    {
+        case MD_BLOCK_DOC:
+            node.type = MdNodeType::Document;
+            break;
+
+        case MD_BLOCK_P:
+            node.type = MdNodeType::Paragraph;
+            break;
+
+        case MD_BLOCK_QUOTE:
+            node.type = MdNodeType::BlockQuote;
+            break;
+
+        case MD_BLOCK_H:
+        {
+            auto* h_detail = static_cast<MD_BLOCK_H_DETAIL*>(detail);
+            node.type = MdNodeType::Heading;
+            node.heading_level = static_cast<int>(h_detail->level);
+            break;
+        }
+
+        case MD_BLOCK_UL:
+        {
+            auto* ul_detail = static_cast<MD_BLOCK_UL_DETAIL*>(detail);
+            node.type = MdNodeType::UnorderedList;
+            node.is_tight = ul_detail->is_tight != 0;
+            break;
+        }
+
+        case MD_BLOCK_OL:
+        {
+            auto* ol_detail = static_cast<MD_BLOCK_OL_DETAIL*>(detail);
+            node.type = MdNodeType::OrderedList;
+            node.start_number = static_cast<int>(ol_detail->start);
+            node.is_tight = ol_detail->is_tight != 0;
+            break;
+        }
+
+        case MD_BLOCK_LI:
+            // Task markers are added as a TaskListMarker child by the builder
+            node.type = MdNodeType::ListItem;
+            break;
+
+        case MD_BLOCK_HR:
+            node.type = MdNodeType::HorizontalRule;
+            break;
+
+        case MD_BLOCK_CODE:
+        {
+            auto* code_detail = static_cast<MD_BLOCK_CODE_DETAIL*>(detail);
+            node.language = attr_text(code_detail->lang);
+            node.info_string = attr_text(code_detail->info);
+
+            if (node.language == "mermaid")
+            {
+                node.type = MdNodeType::MermaidBlock;
+            }
+            else if (code_detail->fence_char != 0)
+            {
+                node.type = MdNodeType::FencedCodeBlock;
+            }
+            else
+            {
+                node.type = MdNodeType::CodeBlock;
+            }
+            break;
+        }
+
+        case MD_BLOCK_HTML:
+            node.type = MdNodeType::HtmlBlock;
+            break;
+
+        case MD_BLOCK_TABLE:
+            node.type = MdNodeType::Table;
+            break;
+
+        case MD_BLOCK_THEAD:
+            node.type = MdNodeType::TableHead;
+            break;
+
+        case MD_BLOCK_TBODY:
+            node.type = MdNodeType::TableBody;
+            break;
+
+        case MD_BLOCK_TR:
+            node.type = MdNodeType::TableRow;
+            break;
+
+        case MD_BLOCK_TH:
+        case MD_BLOCK_TD:
+        {
+            auto* td_detail = static_cast<MD_BLOCK_TD_DETAIL*>(detail);
+            node.type = MdNodeType::TableCell;
+            node.is_header = block_type == MD_BLOCK_TH;
+            node.alignment = to_alignment(td_detail->align);
+            break;
+        }
+    }
+}
+
+/// Span counterpart of describe_block().
+template <typename Node, typename AttrText>
+void describe_span(Node& node, MD_SPANTYPE span_type, void* detail, AttrText attr_text)
+{
+    switch (span_type)
+    {
+        case MD_SPAN_EM:
+            node.type = MdNodeType::Emphasis;
+            break;
+
+        case MD_SPAN_STRONG:
+            node.type = MdNodeType::Strong;
+            break;
+
+        case MD_SPAN_CODE:
+            node.type = MdNodeType::Code;
+            break;
+
+        case MD_SPAN_A:
+        {
+            auto* a_detail = static_cast<MD_SPAN_A_DETAIL*>(detail);
+            node.type = MdNodeType::Link;
+            node.url = attr_text(a_detail->href);
+            node.title = attr_text(a_detail->title);
+            break;
+        }
+
+        case MD_SPAN_IMG:
+        {
+            auto* img_detail = static_cast<MD_SPAN_IMG_DETAIL*>(detail);
+            node.type = MdNodeType::Image;
+            node.url = attr_text(img_detail->src);
+            node.title = attr_text(img_detail->title);
+            break;
+        }
+
+        case MD_SPAN_DEL:
+            node.type = MdNodeType::Strikethrough;
+            break;
+
+        case MD_SPAN_LATEXMATH:
+            node.type = MdNodeType::MathInline;
+            break;
+
+        case MD_SPAN_LATEXMATH_DISPLAY:
+            node.type = MdNodeType::MathDisplay;
+            node.is_display = true;
+            break;
+
+        default:
+            // Unsupported span types (WIKILINK, UNDERLINE)
+            node.type = MdNodeType::Text;
+            break;
+    }
+}
+
+/// Record a fenced code block language once.
+template <typename Text, typename Language>
+void track_language(std::vector<Text>& languages, const Language& language)
+{
+    if (!language.empty() &&
+        std::find(languages.begin(), languages.end(), language) == languages.end())
+    {
+        languages.emplace_back(language);
+    }
+}
+
 } // anonymous namespace
 
 // ═══════════════════════════════════════════════════════
@@ -147,171 +345,34 @@ void pop_node(Md4cParser::ParseState& state)
 
 void Md4cParser::on_enter_block(ParseState& state, MD_BLOCKTYPE block_type, void* detail)
 {
-    MdNode node;
-
-    switch (block_type)
+    if (block_type == MD_BLOCK_DOC)
     {
-        case MD_BLOCK_DOC:
-            // Already have root, just push it
-            state.node_stack.push_back(&state.document.root);
-            return;
-
-        case MD_BLOCK_P:
-            node.type = MdNodeType::Paragraph;
-            break;
-
-        case MD_BLOCK_QUOTE:
-            node.type = MdNodeType::BlockQuote;
-            break;
-
-        case MD_BLOCK_H:
-        {
-            auto* h_detail = static_cast<MD_BLOCK_H_DETAIL*>(detail);
-            node.type = MdNodeType::Heading;
-            node.heading_level = static_cast<int>(h_detail->level);
-            break;
-        }
-
-        case MD_BLOCK_UL:
-        {
-            auto* ul_detail = static_cast<MD_BLOCK_UL_DETAIL*>(detail);
-            node.type = MdNodeType::UnorderedList;
-            node.is_tight = ul_detail->is_tight != 0;
-            break;
-        }
-
-        case MD_BLOCK_OL:
-        {
-            auto* ol_detail = static_cast<MD_BLOCK_OL_DETAIL*>(detail);
-            node.type = MdNodeType::OrderedList;
-            node.start_number = static_cast<int>(ol_detail->start);
-            node.is_tight = ol_detail->is_tight != 0;
-            break;
-        }
-
-        case MD_BLOCK_LI:
-        {
-            auto* li_detail = static_cast<MD_BLOCK_LI_DETAIL*>(detail);
-            node.type = MdNodeType::ListItem;
-            if (li_detail->is_task != 0)
-            {
-                // We'll add a TaskListMarker child
-                MdNode marker;
-                marker.type = MdNodeType::TaskListMarker;
-                marker.is_checked = (li_detail->task_mark == 'x' || li_detail->task_mark == 'X');
-                node.children.push_back(std::move(marker));
-            }
-            break;
-        }
-
-        case MD_BLOCK_HR:
-            node.type = MdNodeType::HorizontalRule;
-            break;
-
-        case MD_BLOCK_CODE:
-        {
-            auto* code_detail = static_cast<MD_BLOCK_CODE_DETAIL*>(detail);
-            auto lang = attr_to_string(code_detail->lang);
-            auto info = attr_to_string(code_detail->info);
-
-            if (lang == "mermaid")
-            {
-                node.type = MdNodeType::MermaidBlock;
-            }
-            else if (code_detail->fence_char != 0)
-            {
-                node.type = MdNodeType::FencedCodeBlock;
-            }
-            else
-            {
-                node.type = MdNodeType::CodeBlock;
-            }
-
-            node.language = lang;
-            node.info_string = info;
-
-            // Track code language
-            if (!lang.empty())
-            {
-                auto& langs = state.document.code_languages;
-                if (std::find(langs.begin(), langs.end(), lang) == langs.end())
-                {
-                    langs.push_back(lang);
-                }
-            }
-
-            state.in_code_block = true;
-            state.current_code_block.clear();
-            state.current_code_language = lang;
-            break;
-        }
-
-        case MD_BLOCK_HTML:
-            node.type = MdNodeType::HtmlBlock;
-            break;
-
-        case MD_BLOCK_TABLE:
-            node.type = MdNodeType::Table;
-            break;
-
-        case MD_BLOCK_THEAD:
-            node.type = MdNodeType::TableHead;
-            break;
-
-        case MD_BLOCK_TBODY:
-            node.type = MdNodeType::TableBody;
-            break;
-
-        case MD_BLOCK_TR:
-            node.type = MdNodeType::TableRow;
-            break;
+        // Already have root, just push it
+        state.node_stack.push_back(&state.document.root);
+        return;
+    }
 
-        case MD_BLOCK_TH:
-        {
-            auto* td_detail = static_cast<MD_BLOCK_TD_DETAIL*>(detail);
-            node.type = MdNodeType::TableCell;
-            node.is_header = true;
-            switch (td_detail->align)
-            {
-                case MD_ALIGN_LEFT:
-                    node.alignment = MdAlignment::Left;
-                    break;
-                case MD_ALIGN_CENTER:
-                    node.alignment = MdAlignment::Center;
-                    break;
-                case MD_ALIGN_RIGHT:
-                    node.alignment = MdAlignment::Right;
-                    break;
-                default:
-                    node.alignment = MdAlignment::Default;
-                    break;
-            }
-            break;
-        }
+    MdNode node;
+    describe_block(node, block_type, detail, attr_to_string);
 
-        case MD_BLOCK_TD:
+    if (block_type == MD_BLOCK_LI)
+    {
+        auto* li_detail = static_cast<MD_BLOCK_LI_DETAIL*>(detail);
+        if (li_detail->is_task != 0)
         {
-            auto* td_detail = static_cast<MD_BLOCK_TD_DETAIL*>(detail);
-            node.type = MdNodeType::TableCell;
-            node.is_header = false;
-            switch (td_detail->align)
-            {
-                case MD_ALIGN_LEFT:
-                    node.alignment = MdAlignment::Left;
-                    break;
-                case MD_ALIGN_CENTER:
-                    node.alignment = MdAlignment::Center;
-                    break;
-                case MD_ALIGN_RIGHT:
-                    node.alignment = MdAlignment::Right;
-                    break;
-                default:
-                    node.alignment = MdAlignment::Default;
-                    break;
-            }
-            break;
+            MdNode marker;
+            marker.type = MdNodeType::TaskListMarker;
+            marker.is_checked = (li_detail->task_mark == 'x' || li_detail->task_mark == 'X');
+            node.children.push_back(std::move(marker));
         }
     }
+    else if (block_type == MD_BLOCK_CODE)
+    {
+        track_language(state.document.code_languages, node.language);
+        state.in_code_block = true;
+        state.current_code_block.clear();
+        state.current_code_language = node.language;
+    }
 
     push_node(state, std::move(node));
 }
@@ -352,58 +413,7 @@ void Md4cParser::on_leave_block(ParseState& state, MD_BLOCKTYPE block_type, void
 void Md4cParser::on_enter_span(ParseState& state, MD_SPANTYPE span_type, void* detail)
 {
     MdNode node;
-
-    switch (span_type)
-    {
-        case MD_SPAN_EM:
-            node.type = MdNodeType::Emphasis;
-            break;
-
-        case MD_SPAN_STRONG:
-            node.type = MdNodeType::Strong;
-            break;
-
-        case MD_SPAN_CODE:
-            node.type = MdNodeType::Code;
-            break;
-
-        case MD_SPAN_A:
-        {
-            auto* a_detail = static_cast<MD_SPAN_A_DETAIL*>(detail);
-            node.type = MdNodeType::Link;
-            node.url = attr_to_string(a_detail->href);
-            node.title = attr_to_string(a_detail->title);
-            break;
-        }
-
-        case MD_SPAN_IMG:
-        {
-            auto* img_detail = static_cast<MD_SPAN_IMG_DETAIL*>(detail);
-            node.type = MdNodeType::Image;
-            node.url = attr_to_string(img_detail->src);
-            node.title = attr_to_string(img_detail->title);
-            break;
-        }
-
-        case MD_SPAN_DEL:
-            node.type = MdNodeType::Strikethrough;
-            break;
-
-        case MD_SPAN_LATEXMATH:
-            node.type = MdNodeType::MathInline;
-            break;
-
-        case MD_SPAN_LATEXMATH_DISPLAY:
-            node.type = MdNodeType::MathDisplay;
-            node.is_display = true;
-            break;
-
-        default:
-            // Unsupported span types (WIKILINK, UNDERLINE)
-            node.type = MdNodeType::Text;
-            break;
-    }
-
+    describe_span(node, span_type, detail, attr_to_string);
     push_node(state, std::move(node));
 }
 
@@ -573,4 +583,156 @@ auto Md4cParser::parse(std::string_view markdown) -> std::expected<MarkdownDocum
     return std::move(state.document);
 }
 
+// ═══════════════════════════════════════════════════════
+// Flat AST
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+
+struct FlatParseState
+{
+    FlatMarkdownBuilder builder;
+    bool in_code_block{false};
+};
+
+auto flat_enter_block(MD_BLOCKTYPE type, void* detail, void* userdata) -> int
+{
+    auto& state = *static_cast<FlatParseState*>(userdata);
+    if (type == MD_BLOCK_DOC)
+    {
+        return 0; // The builder's root
+    }
+
+    FlatMdNode node;
+    describe_block(node,
+                   type,
+                   detail,
+                   [&state](const MD_ATTRIBUTE& attr)
+                   { return state.builder.stable_text(attr_to_view(attr)); });
+    const auto language = node.language;
+    state.builder.open(node);
+
+    if (type == MD_BLOCK_LI)
+    {
+        auto* li_detail = static_cast<MD_BLOCK_LI_DETAIL*>(detail);
+        if (li_detail->is_task != 0)
+        {
+            FlatMdNode marker;
+            marker.type = MdNodeType::TaskListMarker;
+            marker.is_checked = (li_detail->task_mark == 'x' || li_detail->task_mark == 'X');
+            state.builder.add(marker);
+        }
+    }
+    else if (type == MD_BLOCK_CODE)
+    {
+        track_language(state.builder.document().code_languages, language);
+        state.in_code_block = true;
+    }
+    return 0;
+}
+
+auto flat_leave_block(MD_BLOCKTYPE type, void* /*detail*/, void* userdata) -> int
+{
+    auto& state = *static_cast<FlatParseState*>(userdata);
+    if (type == MD_BLOCK_DOC)
+    {
+        return 0;
+    }
+
+    const auto& node = state.builder.close();
+    if (type == MD_BLOCK_CODE)
+    {
+        if (node.type == MdNodeType::MermaidBlock)
+        {
+            state.builder.document().mermaid_blocks.push_back(node.text_content);
+        }
+        state.in_code_block = false;
+    }
+    return 0;
+}
+
+auto flat_enter_span(MD_SPANTYPE type, void* detail, void* userdata) -> int
+{
+    auto& state = *static_cast<FlatParseState*>(userdata);
+    FlatMdNode node;
+    describe_span(node,
+                  type,
+                  detail,
+                  [&state](const MD_ATTRIBUTE& attr)
+                  { return state.builder.stable_text(attr_to_view(attr)); });
+    state.builder.open(node);
+    return 0;
+}
+
+auto flat_leave_span(MD_SPANTYPE /*type*/, void* /*detail*/, void* userdata) -> int
+{
+    static_cast<FlatParseState*>(userdata)->builder.close();
+    return 0;
+}
+
+auto flat_text(MD_TEXTTYPE type, const MD_CHAR* text, MD_SIZE size, void* userdata) -> int
+{
+    auto& state = *static_cast<FlatParseState*>(userdata);
+    const std::string_view run(text, size);
+    if (state.in_code_block)
+    {
+        state.builder.append_text(run);
+        return 0;
+    }
+
+    FlatMdNode node;
+    switch (type)
+    {
+        case MD_TEXT_BR:
+            node.type = MdNodeType::LineBreak;
+            break;
+
+        case MD_TEXT_SOFTBR:
+            node.type = MdNodeType::SoftBreak;
+            break;
+
+        case MD_TEXT_NULLCHAR:
+            node.type = MdNodeType::Text;
+            node.text_content = "\xEF\xBF\xBD"; // UTF-8 for U+FFFD
+            break;
+
+        default:
+            node.type = MdNodeType::Text;
+            node.text_content = state.builder.stable_text(run);
+            break;
+    }
+    state.builder.add(node);
+    return 0;
+}
+
+} // anonymous namespace
+
+auto Md4cParser::parse_flat(std::string_view markdown)
+    -> std::expected<FlatMarkdownDocument, std::string>
+{
+    FlatParseState state{FlatMarkdownBuilder(markdown)};
+
+    MD_PARSER md_parser{};
+    md_parser.abi_version = 0;
+    md_parser.flags = parser_flags_;
+    md_parser.enter_block = &flat_enter_block;
+    md_parser.leave_block = &flat_leave_block;
+    md_parser.enter_span = &flat_enter_span;
+    md_parser.leave_span = &flat_leave_span;
+    md_parser.text = &flat_text;
+    md_parser.debug_log = nullptr;
+    md_parser.syntax = nullptr;
+
+    int result =
+        md_parse(markdown.data(), static_cast<MD_SIZE>(markdown.size()), &md_parser, &state);
+
+    if (result != 0)
+    {
+        return std::unexpected("md4c parse error (code " + std::to_string(result) + ")");
+    }
+
+    return state.builder.finish();
+}
+
 } // namespace markamp::core
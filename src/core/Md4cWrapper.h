@@ -1,5 +1,6 @@
 #pragma once
 
+#include "FlatMarkdown.h"
 #include "Types.h"
 
 #include <expected>
@@ -30,6 +31,11 @@ public:
     [[nodiscard]] auto parse(std::string_view markdown)
         -> std::expected<MarkdownDocument, std::string>;
 
+    /// Parse markdown to the compact FlatMarkdownDocument AST. The result
+    /// references `markdown`, which must outlive it.
+    [[nodiscard]] auto parse_flat(std::string_view markdown)
+        -> std::expected<FlatMarkdownDocument, std::string>;
+
     // Parser state (used during a single parse call)
     struct ParseState
     {
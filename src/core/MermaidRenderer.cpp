@@ -1,13 +1,18 @@
 #include "MermaidRenderer.h"
 
+#include "Logger.h"
+#include "StringUtils.h"
+
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <fmt/format.h>
 #include <fstream>
 #include <functional>
+#include <system_error>
 
 #ifdef _WIN32
 #include <process.h>
@@ -104,25 +109,78 @@ auto make_temp_path(const std::string& extension) -> std::filesystem::path
         tmp_dir = std::filesystem::path("/tmp");
     }
     auto pid = static_cast<int>(getpid());
-    static int counter = 0;
+    static std::atomic<int> counter{0};
     auto filename = fmt::format("markamp_mermaid_{}_{}.{}", pid, ++counter, extension);
     return tmp_dir / filename;
 }
 
+/// True if `path` is a regular file the user may execute.
+auto is_executable(const std::filesystem::path& path) -> bool
+{
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(path, error))
+    {
+        return false;
+    }
+#ifdef _WIN32
+    return true;
+#else
+    using std::filesystem::perms;
+    const auto permissions = std::filesystem::status(path, error).permissions();
+    return !error &&
+           (permissions & (perms::owner_exec | perms::group_exec | perms::others_exec)) !=
+               perms::none;
+#endif
+}
+
 } // anonymous namespace
 
 MermaidRenderer::MermaidRenderer()
-    : mmdc_available_(detect_mmdc())
+    : MermaidRenderer(std::filesystem::path{})
 {
 }
 
+MermaidRenderer::MermaidRenderer(std::filesystem::path cache_dir,
+                                 std::string command,
+                                 std::size_t max_processes,
+                                 std::uintmax_t max_disk_bytes)
+    : cache_dir_(std::move(cache_dir))
+    , command_(std::move(command))
+    , max_processes_(max_processes)
+    , max_disk_bytes_(max_disk_bytes)
+    , svg_cache_(kMaxCacheBytes, &result_size)
+{
+    if (max_processes_ == 0)
+    {
+        max_processes_ =
+            std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, kMaxProcesses);
+    }
+}
+
+MermaidRenderer::~MermaidRenderer()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+        jobs_.clear();
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
 auto MermaidRenderer::is_available() const -> bool
 {
+    std::call_once(detect_once_, [this]() { mmdc_available_ = detect_mmdc(command_); });
     return mmdc_available_;
 }
 
 void MermaidRenderer::set_theme(const Theme& theme)
 {
+    // The theme is part of the cache key, so cached SVGs stay valid
+    std::lock_guard lock(mutex_);
     mermaid_theme_ = theme.is_dark() ? "dark" : "default";
     primary_color_ = theme.colors.accent_primary.to_hex();
     primary_text_color_ = theme.colors.text_main.to_hex();
@@ -130,18 +188,17 @@ void MermaidRenderer::set_theme(const Theme& theme)
     line_color_ = theme.colors.text_muted.to_hex();
     secondary_color_ = theme.colors.accent_secondary.to_hex();
     tertiary_color_ = theme.colors.bg_panel.to_hex();
-
-    // Invalidate cache — theme colors changed
-    clear_cache();
 }
 
 void MermaidRenderer::set_font_family(const std::string& font)
 {
+    std::lock_guard lock(mutex_);
     font_family_ = font;
 }
 
 auto MermaidRenderer::get_mermaid_config() const -> std::string
 {
+    std::lock_guard lock(mutex_);
     return fmt::format(
         R"({{
   "theme": "{}",
@@ -174,39 +231,295 @@ auto MermaidRenderer::render(std::string_view mermaid_source)
         return std::unexpected(std::string("Empty Mermaid source"));
     }
 
-    if (!mmdc_available_)
+    if (!is_available())
     {
         return std::unexpected(std::string("Mermaid CLI (mmdc) is not available. "
                                            "Install with: npm install -g @mermaid-js/mermaid-cli"));
     }
 
-    // Check cache
-    auto key = cache_key(mermaid_source);
-    auto cache_it = svg_cache_.find(key);
-    if (cache_it != svg_cache_.end())
+    auto config = get_mermaid_config();
+    const auto key = cache_key(mermaid_source, config);
     {
-        return cache_it->second;
+        std::unique_lock lock(mutex_);
+        // Rendering the same diagram twice would only waste a process
+        done_cv_.wait(lock, [&] { return !in_flight_.contains(key); });
+        if (auto result = cached(lock, key))
+        {
+            return *std::move(result);
+        }
+        ++stats_.processes_run;
     }
 
-    // Cache miss — render via CLI
-    auto result = render_via_mmdc(mermaid_source);
-    if (result.has_value())
+    // Cache miss — render via CLI on the calling thread
+    auto result = render_via_mmdc(mermaid_source, config);
+    if (result.has_value() && !cache_dir_.empty())
     {
-        // Evict oldest if at capacity
-        if (svg_cache_.size() >= kMaxCacheEntries && !cache_order_.empty())
+        save_svg(key, *result);
+    }
+    std::lock_guard lock(mutex_);
+    store(key, result);
+    return result;
+}
+
+auto MermaidRenderer::try_render(std::string_view mermaid_source)
+    -> std::optional<std::expected<std::string, std::string>>
+{
+    if (mermaid_source.empty() || !is_available())
+    {
+        return render(mermaid_source);
+    }
+
+    auto config = get_mermaid_config();
+    const auto key = cache_key(mermaid_source, config);
+    {
+        std::unique_lock lock(mutex_);
+        if (in_flight_.contains(key))
+        {
+            return std::nullopt;
+        }
+        if (auto result = cached(lock, key))
         {
-            svg_cache_.erase(cache_order_.front());
-            cache_order_.erase(cache_order_.begin());
+            return result;
         }
-        svg_cache_[key] = *result;
-        cache_order_.push_back(key);
+        // Another caller may have queued the diagram while the disk was read
+        if (!in_flight_.insert(key).second)
+        {
+            return std::nullopt;
+        }
+        ++unreported_jobs_;
+        jobs_.push_back(Job{key, std::string(mermaid_source), std::move(config)});
+        start_workers();
     }
+    work_cv_.notify_one();
+    return std::nullopt;
+}
 
-    return result;
+auto MermaidRenderer::add_ready_listener(std::function<void()> callback) -> std::size_t
+{
+    std::lock_guard lock(listeners_mutex_);
+    const auto handle = next_listener_id_++;
+    listeners_.emplace_back(handle, std::move(callback));
+    return handle;
 }
 
-auto MermaidRenderer::render_via_mmdc(std::string_view source)
-    -> std::expected<std::string, std::string>
+void MermaidRenderer::remove_ready_listener(std::size_t handle)
+{
+    std::lock_guard lock(listeners_mutex_);
+    std::erase_if(listeners_, [handle](const auto& listener) { return listener.first == handle; });
+}
+
+void MermaidRenderer::wait_idle()
+{
+    std::unique_lock lock(mutex_);
+    done_cv_.wait(lock, [this] { return unreported_jobs_ == 0; });
+}
+
+auto MermaidRenderer::stats() const -> Stats
+{
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+auto MermaidRenderer::cached(std::unique_lock<std::mutex>& lock, uint64_t key)
+    -> std::optional<Result>
+{
+    if (const auto* result = svg_cache_.get(key))
+    {
+        ++stats_.memory_hits;
+        return *result;
+    }
+    if (cache_dir_.empty())
+    {
+        return std::nullopt;
+    }
+
+    // Never hold the lock for file I/O: the UI thread looks diagrams up too
+    const auto file = cache_file(key);
+    lock.unlock();
+    auto svg = read_file(file);
+    if (svg.has_value() && !svg->empty())
+    {
+        // The modification time orders SVGs for pruning
+        std::error_code touch_error;
+        std::filesystem::last_write_time(
+            file, std::filesystem::file_time_type::clock::now(), touch_error);
+    }
+    lock.lock();
+
+    if (!svg.has_value() || svg->empty())
+    {
+        return std::nullopt;
+    }
+    ++stats_.disk_hits;
+    svg_cache_.put(key, *svg);
+    return Result(std::move(*svg));
+}
+
+void MermaidRenderer::store(uint64_t key, Result result)
+{
+    svg_cache_.put(key, std::move(result));
+}
+
+void MermaidRenderer::start_workers()
+{
+    // in_flight_ holds queued and running jobs; threads are kept for later misses
+    while (workers_.size() < std::min(max_processes_, in_flight_.size()))
+    {
+        workers_.emplace_back([this]() { run_worker(); });
+    }
+}
+
+void MermaidRenderer::run_worker()
+{
+    std::unique_lock lock(mutex_);
+    while (true)
+    {
+        work_cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+        if (stopping_)
+        {
+            return;
+        }
+        auto job = std::move(jobs_.front());
+        jobs_.pop_front();
+        ++stats_.processes_run;
+        lock.unlock();
+
+        auto result = render_via_mmdc(job.source, job.config);
+        if (result.has_value() && !cache_dir_.empty())
+        {
+            save_svg(job.key, *result);
+        }
+
+        lock.lock();
+        store(job.key, std::move(result));
+        in_flight_.erase(job.key);
+        done_cv_.notify_all();
+        lock.unlock();
+
+        // Listeners re-render, so they run once the result can be looked up
+        notify_ready();
+
+        lock.lock();
+        --unreported_jobs_;
+        done_cv_.notify_all();
+    }
+}
+
+void MermaidRenderer::notify_ready()
+{
+    std::lock_guard lock(listeners_mutex_);
+    for (const auto& [handle, callback] : listeners_)
+    {
+        callback();
+    }
+}
+
+auto MermaidRenderer::cache_file(uint64_t key) const -> std::filesystem::path
+{
+    return cache_dir_ / fmt::format("{:016x}.svg", key);
+}
+
+void MermaidRenderer::save_svg(uint64_t key, const std::string& svg)
+{
+    // Only successful renders go to disk: a failure may be fixed by
+    // installing or updating mmdc
+    const auto file = cache_file(key);
+    std::error_code error;
+    std::filesystem::create_directories(cache_dir_, error);
+
+    std::lock_guard disk_lock(disk_mutex_);
+    if (!disk_scanned_)
+    {
+        // SVGs left by earlier sessions
+        disk_scanned_ = true;
+        prune_disk_cache();
+    }
+
+    // Write to a temporary name first so a crash never leaves a torn SVG
+    auto temp = file;
+    temp += ".tmp";
+    if (!write_file(temp, svg))
+    {
+        MARKAMP_LOG_WARN("MermaidRenderer: cannot write {}", temp.string());
+        return;
+    }
+    std::filesystem::rename(temp, file, error);
+    if (error)
+    {
+        MARKAMP_LOG_WARN("MermaidRenderer: cannot store {}: {}", file.string(), error.message());
+        std::filesystem::remove(temp, error);
+        return;
+    }
+    disk_bytes_ += svg.size();
+    if (disk_bytes_ > max_disk_bytes_)
+    {
+        prune_disk_cache();
+    }
+}
+
+void MermaidRenderer::prune_disk_cache()
+{
+    struct CachedSvg
+    {
+        std::filesystem::path path;
+        std::filesystem::file_time_type used;
+        std::uintmax_t size{0};
+    };
+    std::vector<CachedSvg> svgs;
+    std::uintmax_t total = 0;
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(cache_dir_, error), end; !error && it != end;
+         it.increment(error))
+    {
+        std::error_code entry_error;
+        if (!it->is_regular_file(entry_error))
+        {
+            continue;
+        }
+        const auto size = it->file_size(entry_error);
+        const auto used = it->last_write_time(entry_error);
+        if (entry_error)
+        {
+            continue;
+        }
+        svgs.push_back({it->path(), used, size});
+        total += size;
+    }
+
+    std::size_t pruned = 0;
+    if (total > max_disk_bytes_)
+    {
+        std::sort(svgs.begin(),
+                  svgs.end(),
+                  [](const CachedSvg& lhs, const CachedSvg& rhs) { return lhs.used < rhs.used; });
+        const auto target = max_disk_bytes_ / 4 * 3;
+        for (const auto& cached_svg : svgs)
+        {
+            if (total <= target)
+            {
+                break;
+            }
+            if (std::filesystem::remove(cached_svg.path, error))
+            {
+                total -= cached_svg.size;
+                ++pruned;
+            }
+        }
+        MARKAMP_LOG_DEBUG("MermaidRenderer: pruned {} SVGs from {}", pruned, cache_dir_.string());
+    }
+    disk_bytes_ = total;
+
+    std::lock_guard lock(mutex_);
+    stats_.disk_pruned += pruned;
+}
+
+auto MermaidRenderer::result_size(const Result& result) -> size_t
+{
+    return result.has_value() ? result->size() : result.error().size();
+}
+
+auto MermaidRenderer::render_via_mmdc(std::string_view source, const std::string& config) const
+    -> Result
 {
     // Create temp files
     auto input_path = make_temp_path("mmd");
@@ -225,14 +538,14 @@ auto MermaidRenderer::render_via_mmdc(std::string_view source)
     }
 
     // Write config to temp file
-    auto config = get_mermaid_config();
     if (!write_file(config_path, config))
     {
         return std::unexpected(std::string("Failed to write Mermaid config to temp file"));
     }
 
     // Execute mmdc
-    auto cmd = fmt::format("mmdc -i \"{}\" -o \"{}\" -c \"{}\" --quiet 2>&1",
+    auto cmd = fmt::format("\"{}\" -i \"{}\" -o \"{}\" -c \"{}\" --quiet 2>&1",
+                           command_,
                            input_path.string(),
                            output_path.string(),
                            config_path.string());
@@ -262,45 +575,59 @@ auto MermaidRenderer::render_via_mmdc(std::string_view source)
     return sanitize_svg(*svg_result);
 }
 
-auto MermaidRenderer::detect_mmdc() -> bool
+auto MermaidRenderer::detect_mmdc(const std::string& command) -> bool
 {
+    // Searched in-process: spawning `which` cost a shell per launch
+    const std::filesystem::path path(command);
+    if (path.has_parent_path())
+    {
+        return is_executable(path);
+    }
 #ifdef _WIN32
-    auto exit_code = execute_command("where mmdc >NUL 2>&1");
+    constexpr char kPathSeparator = ';';
+    constexpr std::array<std::string_view, 4> kExtensions{"", ".cmd", ".exe", ".bat"};
 #else
-    auto exit_code = execute_command("which mmdc >/dev/null 2>&1");
+    constexpr char kPathSeparator = ':';
+    constexpr std::array<std::string_view, 1> kExtensions{""};
 #endif
-    return exit_code == 0;
+    const char* path_env = std::getenv("PATH");
+    std::string_view remaining = path_env != nullptr ? path_env : "";
+    while (!remaining.empty())
+    {
+        const auto separator = remaining.find(kPathSeparator);
+        const auto directory = remaining.substr(0, separator);
+        remaining = separator == std::string_view::npos ? std::string_view{}
+                                                        : remaining.substr(separator + 1);
+        if (directory.empty())
+        {
+            continue;
+        }
+        for (const auto extension : kExtensions)
+        {
+            auto candidate = std::filesystem::path(directory) / command;
+            candidate += extension;
+            if (is_executable(candidate))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
-auto MermaidRenderer::cache_key(std::string_view source) const -> size_t
+auto MermaidRenderer::cache_key(std::string_view source, std::string_view config) -> uint64_t
 {
-    // Improvement 23: proper hash_combine with all theme variables
-    auto hash_combine = [](size_t seed, size_t value) -> size_t
-    {
-        // Golden ratio constant for hash distribution (boost::hash_combine)
-        constexpr size_t kGoldenRatio = 0x9e3779b9;
-        seed ^= value + kGoldenRatio + (seed << 6) + (seed >> 2);
-        return seed;
-    };
-
-    const std::hash<std::string_view> sv_hash{};
-    const std::hash<std::string> str_hash{};
-
-    size_t seed = sv_hash(source);
-    seed = hash_combine(seed, str_hash(mermaid_theme_));
-    seed = hash_combine(seed, str_hash(primary_color_));
-    seed = hash_combine(seed, str_hash(primary_text_color_));
-    seed = hash_combine(seed, str_hash(primary_border_color_));
-    seed = hash_combine(seed, str_hash(line_color_));
-    seed = hash_combine(seed, str_hash(secondary_color_));
-    seed = hash_combine(seed, str_hash(tertiary_color_));
-    return seed;
+    // The config carries the theme, colors and font, so a theme switch
+    // changes the key instead of invalidating the cache
+    auto hash = fnv1a_64(config);
+    hash = fnv1a_64(std::string_view("\0", 1), hash);
+    return fnv1a_64(source, hash);
 }
 
 void MermaidRenderer::clear_cache()
 {
+    std::lock_guard lock(mutex_);
     svg_cache_.clear();
-    cache_order_.clear();
 }
 
 auto MermaidRenderer::sanitize_svg(const std::string& svg) -> std::string
@@ -404,7 +731,7 @@ auto MermaidRenderer::validate(std::string_view mermaid_source)
         return diagnostics;
     }
 
-    if (!mmdc_available_)
+    if (!is_available())
     {
         diagnostics.push_back(
             {0, "Mermaid CLI (mmdc) is not available", MermaidDiagnosticSeverity::Warning});
@@ -429,10 +756,10 @@ auto MermaidRenderer::validate(std::string_view mermaid_source)
         return diagnostics;
     }
 
-    auto config = get_mermaid_config();
-    write_file(config_path, config);
+    write_file(config_path, get_mermaid_config());
 
-    auto cmd = fmt::format("mmdc -i \"{}\" -o \"{}\" -c \"{}\" 2>\"{}\"",
+    auto cmd = fmt::format("\"{}\" -i \"{}\" -o \"{}\" -c \"{}\" 2>\"{}\"",
+                           command_,
                            input_path.string(),
                            output_path.string(),
                            config_path.string(),
@@ -508,7 +835,7 @@ auto MermaidRenderer::export_svg(std::string_view mermaid_source)
         return std::unexpected(std::string("Empty Mermaid source"));
     }
 
-    if (!mmdc_available_)
+    if (!is_available())
     {
         return std::unexpected(std::string("Mermaid CLI (mmdc) is not available"));
     }
@@ -532,7 +859,8 @@ auto MermaidRenderer::export_svg(std::string_view mermaid_source)
         return std::unexpected(std::string("Failed to write config"));
     }
 
-    auto cmd = fmt::format("mmdc -i \"{}\" -o \"{}\" -c \"{}\" --quiet 2>&1",
+    auto cmd = fmt::format("\"{}\" -i \"{}\" -o \"{}\" -c \"{}\" --quiet 2>&1",
+                           command_,
                            input_path.string(),
                            output_path.string(),
                            config_path.string());
@@ -554,7 +882,7 @@ auto MermaidRenderer::export_png(std::string_view mermaid_source, int width)
         return std::unexpected(std::string("Empty Mermaid source"));
     }
 
-    if (!mmdc_available_)
+    if (!is_available())
     {
         return std::unexpected(std::string("Mermaid CLI (mmdc) is not available"));
     }
@@ -578,7 +906,8 @@ auto MermaidRenderer::export_png(std::string_view mermaid_source, int width)
         return std::unexpected(std::string("Failed to write config"));
     }
 
-    auto cmd = fmt::format("mmdc -i \"{}\" -o \"{}\" -c \"{}\" -w {} --quiet 2>&1",
+    auto cmd = fmt::format("\"{}\" -i \"{}\" -o \"{}\" -c \"{}\" -w {} --quiet 2>&1",
+                           command_,
                            input_path.string(),
                            output_path.string(),
                            config_path.string(),
@@ -614,15 +943,15 @@ auto MermaidRenderer::export_png(std::string_view mermaid_source, int width)
 
 void MermaidRenderer::set_diagram_theme(const std::string& theme_name)
 {
+    std::lock_guard lock(mutex_);
     diagram_theme_override_ = theme_name;
 
-    // Apply the override to the internal mermaid theme
+    // Apply the override to the internal mermaid theme; it is part of the
+    // cache key, so diagrams of either theme stay cached
     if (!theme_name.empty())
     {
         mermaid_theme_ = theme_name;
     }
-
-    clear_cache();
 }
 
 auto MermaidRenderer::diagram_theme() const -> const std::string&
@@ -1,12 +1,22 @@
 #pragma once
 
+#include "ChunkedStorage.h"
 #include "IMermaidRenderer.h"
 #include "Theme.h"
 
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <thread>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace markamp::core
@@ -14,6 +24,20 @@ namespace markamp::core
 
 /// MermaidRenderer converts Mermaid diagram source to SVG using the mmdc CLI tool.
 /// Implements IMermaidRenderer. Uses temp files for I/O and caches PATH availability.
+///
+/// Rendered SVGs are keyed by a stable hash of the source and the Mermaid
+/// config (theme, colors, font), kept in a byte-capped memory LRU and, when
+/// a cache directory is given, on disk so they survive restarts and switching
+/// back to an earlier theme. The cache directory is capped in bytes: on the
+/// first write of a session, and whenever a write takes it over the cap, the
+/// least recently used SVGs are deleted. try_render() hands misses to a bounded pool of
+/// worker threads, each running one mmdc process at a time, so a document
+/// with many diagrams renders them in parallel off the calling thread.
+///
+/// mmdc is looked up on PATH in-process, on the first is_available() call
+/// rather than in the constructor.
+///
+/// Pattern implemented: #39 Memory locality — capped render caches
 
 /// Severity level for Mermaid diagram diagnostics.
 enum class MermaidDiagnosticSeverity
@@ -34,13 +58,40 @@ struct MermaidDiagnosticInfo
 class MermaidRenderer : public IMermaidRenderer
 {
 public:
+    /// Memory-only cache, mmdc from PATH.
     MermaidRenderer();
-    ~MermaidRenderer() override = default;
+
+    /// @param cache_dir      On-disk SVG cache; empty keeps SVGs in memory only.
+    /// @param command        mmdc executable: a name looked up on PATH, or a path.
+    /// @param max_processes  Concurrent mmdc processes; 0 picks
+    ///                       min(kMaxProcesses, hardware threads).
+    /// @param max_disk_bytes Cap on the size of `cache_dir`.
+    explicit MermaidRenderer(std::filesystem::path cache_dir,
+                             std::string command = "mmdc",
+                             std::size_t max_processes = 0,
+                             std::uintmax_t max_disk_bytes = kDefaultMaxDiskBytes);
+    ~MermaidRenderer() override;
+
+    // Non-copyable, non-movable
+    MermaidRenderer(const MermaidRenderer&) = delete;
+    auto operator=(const MermaidRenderer&) -> MermaidRenderer& = delete;
+    MermaidRenderer(MermaidRenderer&&) = delete;
+    auto operator=(MermaidRenderer&&) -> MermaidRenderer& = delete;
 
     // IMermaidRenderer interface
+    /// Blocks until the diagram is rendered (waiting for the pool if it is
+    /// already rendering the same diagram).
     [[nodiscard]] auto render(std::string_view mermaid_source)
         -> std::expected<std::string, std::string> override;
     [[nodiscard]] auto is_available() const -> bool override;
+    [[nodiscard]] auto try_render(std::string_view mermaid_source)
+        -> std::optional<std::expected<std::string, std::string>> override;
+    auto add_ready_listener(std::function<void()> callback) -> std::size_t override;
+    void remove_ready_listener(std::size_t handle) override;
+
+    /// Block until no diagram is queued or being rendered and listeners
+    /// have been told about every finished one.
+    void wait_idle();
 
     // Configuration
     void set_theme(const Theme& theme);
@@ -49,11 +100,28 @@ public:
     /// Generate Mermaid JSON config from current settings.
     [[nodiscard]] auto get_mermaid_config() const -> std::string;
 
-    /// Clear the SVG render cache (e.g. on theme change).
+    /// Clear the in-memory SVG cache. The on-disk cache is kept.
     void clear_cache();
 
-    /// Maximum number of cached SVG renders.
-    static constexpr size_t kMaxCacheEntries = 100;
+    /// Byte budget of the in-memory SVG cache.
+    static constexpr size_t kMaxCacheBytes = static_cast<size_t>(16) * 1024 * 1024;
+
+    /// Default byte budget of the on-disk SVG cache.
+    static constexpr std::uintmax_t kDefaultMaxDiskBytes =
+        static_cast<std::uintmax_t>(64) * 1024 * 1024;
+
+    /// Upper bound on concurrent mmdc processes.
+    static constexpr size_t kMaxProcesses = 4;
+
+    struct Stats
+    {
+        size_t memory_hits{0};
+        size_t disk_hits{0};
+        size_t processes_run{0}; // mmdc invocations by render() and the pool
+        size_t disk_pruned{0};   // SVGs deleted from the cache directory over the cap
+    };
+
+    [[nodiscard]] auto stats() const -> Stats;
 
     /// Sanitize SVG output: strip <script>, <foreignObject>, on* attributes.
     [[nodiscard]] static auto sanitize_svg(const std::string& svg) -> std::string;
@@ -79,17 +147,52 @@ public:
     [[nodiscard]] auto diagram_theme() const -> const std::string&;
 
 private:
-    /// Execute mmdc CLI to render Mermaid source to SVG.
-    [[nodiscard]] auto render_via_mmdc(std::string_view source)
-        -> std::expected<std::string, std::string>;
-
-    /// Detect whether mmdc is available on PATH.
-    [[nodiscard]] static auto detect_mmdc() -> bool;
+    using Result = std::expected<std::string, std::string>;
+
+    struct Job
+    {
+        uint64_t key{0};
+        std::string source;
+        std::string config;
+    };
+
+    /// Execute mmdc CLI to render Mermaid source to SVG with `config`.
+    [[nodiscard]] auto render_via_mmdc(std::string_view source, const std::string& config) const
+        -> Result;
+
+    /// Detect whether `command` is an executable file or is found on PATH.
+    [[nodiscard]] static auto detect_mmdc(const std::string& command) -> bool;
+
+    /// Stable cache key from source + Mermaid config (theme, colors, font).
+    [[nodiscard]] static auto cache_key(std::string_view source, std::string_view config)
+        -> uint64_t;
+
+    /// Memory, then disk. The disk is read with `lock` released, so callers
+    /// must re-check anything it guards. Counts the hit; nullopt on a miss.
+    [[nodiscard]] auto cached(std::unique_lock<std::mutex>& lock, uint64_t key)
+        -> std::optional<Result>;
+    /// Keep `result` in memory; callers write successful renders to disk
+    /// with save_svg() before taking the lock.
+    void store(uint64_t key, Result result);
+    void start_workers();
+    void run_worker();
+    void notify_ready();
+    [[nodiscard]] auto cache_file(uint64_t key) const -> std::filesystem::path;
+    void save_svg(uint64_t key, const std::string& svg);
+
+    /// Delete the least recently used SVGs until the cache directory is back
+    /// under three quarters of the cap. Requires disk_mutex_.
+    void prune_disk_cache();
+    [[nodiscard]] static auto result_size(const Result& result) -> size_t;
+
+    std::filesystem::path cache_dir_;
+    std::string command_;
+    size_t max_processes_{1};
+    std::uintmax_t max_disk_bytes_;
+
+    mutable std::once_flag detect_once_;
+    mutable bool mmdc_available_{false};
 
-    /// Compute cache key from source + theme config.
-    [[nodiscard]] auto cache_key(std::string_view source) const -> size_t;
-
-    bool mmdc_available_{false};
     std::string mermaid_theme_{"dark"};
     std::string font_family_{"JetBrains Mono"};
     std::string primary_color_{"#6C63FF"};
@@ -102,11 +205,28 @@ private:
     /// Diagram theme override (independent of editor theme)
     std::string diagram_theme_override_;
 
-    /// SVG cache: hash(source + theme) -> rendered SVG
-    std::unordered_map<size_t, std::string> svg_cache_;
-
-    /// Insertion order for LRU eviction
-    std::vector<size_t> cache_order_;
+    /// Guards the configuration, the cache and the job queue; never held
+    /// while mmdc runs. Preview workers of several panels share one renderer.
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    ByteCappedLRU<uint64_t, Result> svg_cache_; // GUARDED_BY(mutex_)
+    std::deque<Job> jobs_;                      // GUARDED_BY(mutex_)
+    std::unordered_set<uint64_t> in_flight_;    // GUARDED_BY(mutex_) Queued or rendering
+    size_t unreported_jobs_{0};                 // GUARDED_BY(mutex_) Listeners not yet called
+    Stats stats_;                               // GUARDED_BY(mutex_)
+    bool stopping_{false};                      // GUARDED_BY(mutex_)
+    std::vector<std::thread> workers_;          // Started on the first queued job
+
+    /// Serializes writes to and pruning of the cache directory.
+    std::mutex disk_mutex_;
+    std::uintmax_t disk_bytes_{0}; // GUARDED_BY(disk_mutex_) As of the last prune
+    bool disk_scanned_{false};     // GUARDED_BY(disk_mutex_) Startup prune done
+
+    /// Serializes listener callbacks against remove_ready_listener().
+    std::mutex listeners_mutex_;
+    std::vector<std::pair<size_t, std::function<void()>>> listeners_;
+    size_t next_listener_id_{1};
 };
 
 } // namespace markamp::core
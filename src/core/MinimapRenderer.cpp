@@ -0,0 +1,278 @@
+#include "MinimapRenderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace markamp::core
+{
+
+namespace
+{
+
+auto image_bytes(const MinimapImage& image) -> std::size_t
+{
+    return image.rgb.size() + sizeof(MinimapImage);
+}
+
+void fill(MinimapImage& image, Color color)
+{
+    for (std::size_t pixel = 0; pixel + 2 < image.rgb.size(); pixel += 3)
+    {
+        image.rgb[pixel] = color.r;
+        image.rgb[pixel + 1] = color.g;
+        image.rgb[pixel + 2] = color.b;
+    }
+}
+
+} // namespace
+
+MinimapRenderer::MinimapRenderer(std::size_t max_bytes)
+    : tiles_(max_bytes, &image_bytes)
+    , stamps_(1, 0)
+{
+}
+
+// ═══════════════════════════════════════════════════════
+// Configuration and invalidation
+// ═══════════════════════════════════════════════════════
+
+void MinimapRenderer::set_geometry(int width, int line_height)
+{
+    width = std::max(1, width);
+    line_height = std::clamp(line_height, 1, kMaxLineHeight);
+    if (width != width_ || line_height != line_height_)
+    {
+        width_ = width;
+        line_height_ = line_height;
+        invalidate_all();
+    }
+}
+
+void MinimapRenderer::set_palette(std::vector<Color> style_colors, Color background)
+{
+    palette_ = std::move(style_colors);
+    background_ = background;
+    invalidate_all();
+}
+
+void MinimapRenderer::reset(std::size_t line_count)
+{
+    line_count_ = std::max<std::size_t>(1, line_count);
+    invalidate_all();
+}
+
+void MinimapRenderer::on_lines_changed(std::size_t line, std::ptrdiff_t lines_added)
+{
+    if (lines_added == 0)
+    {
+        invalidate_lines(line, line + 1);
+        return;
+    }
+
+    const auto old_count = line_count_;
+    if (lines_added > 0)
+    {
+        line_count_ += static_cast<std::size_t>(lines_added);
+    }
+    else
+    {
+        const auto removed = static_cast<std::size_t>(-lines_added);
+        line_count_ = removed < line_count_ ? line_count_ - removed : 1;
+    }
+
+    // Everything from the edited line down moved
+    const auto first_tile = std::min(line, line_count_ - 1) / kTileLines;
+    stamps_.resize(tile_count(), 0);
+    restamp_tiles(first_tile, tile_count());
+    mark_dirty(line, std::max(old_count, line_count_));
+}
+
+void MinimapRenderer::invalidate_lines(std::size_t first_line, std::size_t last_line)
+{
+    last_line = std::min(last_line, line_count_);
+    if (first_line >= last_line)
+    {
+        return;
+    }
+    restamp_tiles(first_line / kTileLines, (last_line - 1) / kTileLines + 1);
+    mark_dirty(first_line, last_line);
+}
+
+auto MinimapRenderer::take_dirty_lines() -> std::pair<std::size_t, std::size_t>
+{
+    if (dirty_first_ == kNoDirtyLine)
+    {
+        return {0, 0};
+    }
+    const std::pair<std::size_t, std::size_t> dirty{dirty_first_, dirty_last_};
+    dirty_first_ = kNoDirtyLine;
+    dirty_last_ = 0;
+    return dirty;
+}
+
+auto MinimapRenderer::tile_count() const noexcept -> std::size_t
+{
+    return (line_count_ + kTileLines - 1) / kTileLines;
+}
+
+void MinimapRenderer::restamp_tiles(std::size_t first_tile, std::size_t last_tile)
+{
+    last_tile = std::min(last_tile, stamps_.size());
+    for (auto index = first_tile; index < last_tile; ++index)
+    {
+        // Unused stamps: the old pixels become unreachable and age out
+        stamps_[index] = next_stamp_++;
+    }
+}
+
+void MinimapRenderer::mark_dirty(std::size_t first_line, std::size_t last_line)
+{
+    dirty_first_ = std::min(dirty_first_, first_line);
+    dirty_last_ = std::max(dirty_last_, last_line);
+}
+
+void MinimapRenderer::invalidate_all()
+{
+    tiles_.clear();
+    stamps_.assign(tile_count(), 0);
+    restamp_tiles(0, stamps_.size());
+    mark_dirty(0, line_count_);
+}
+
+// ═══════════════════════════════════════════════════════
+// Geometry
+// ═══════════════════════════════════════════════════════
+
+auto MinimapRenderer::scroll_top(std::size_t first_visible_line,
+                                 std::size_t visible_lines,
+                                 int view_height) const noexcept -> int
+{
+    const int overflow = content_height() - view_height;
+    if (overflow <= 0 || line_count_ <= visible_lines)
+    {
+        return 0;
+    }
+    const auto max_first = line_count_ - visible_lines;
+    const double ratio =
+        std::min(1.0, static_cast<double>(first_visible_line) / static_cast<double>(max_first));
+    return static_cast<int>(std::lround(ratio * overflow));
+}
+
+auto MinimapRenderer::line_at(int row) const noexcept -> std::size_t
+{
+    const auto line = static_cast<std::size_t>(std::max(0, row) / line_height_);
+    return std::min(line, line_count_ - 1);
+}
+
+// ═══════════════════════════════════════════════════════
+// Rendering
+// ═══════════════════════════════════════════════════════
+
+auto MinimapRenderer::paint_rows(int first_row, int row_count, const LineSource& source)
+    -> MinimapImage
+{
+    MinimapImage strip;
+    strip.width = width_;
+    strip.height = std::max(0, row_count);
+    strip.rgb.resize(static_cast<std::size_t>(strip.width) * static_cast<std::size_t>(strip.height) *
+                     3);
+    fill(strip, background_);
+
+    const auto row_bytes = static_cast<std::size_t>(width_) * 3;
+    const int tile_height = static_cast<int>(kTileLines) * line_height_;
+    const int end_row = std::min(first_row + strip.height, content_height());
+    int row = std::max(0, first_row);
+    while (row < end_row)
+    {
+        const auto index = static_cast<std::size_t>(row / tile_height);
+        const int tile_top = static_cast<int>(index) * tile_height;
+        const int rows = std::min(end_row, tile_top + tile_height) - row;
+        const auto& pixels = tile(index, source);
+        std::memcpy(strip.rgb.data() + static_cast<std::size_t>(row - first_row) * row_bytes,
+                    pixels.rgb.data() + static_cast<std::size_t>(row - tile_top) * row_bytes,
+                    static_cast<std::size_t>(rows) * row_bytes);
+        row += rows;
+    }
+    return strip;
+}
+
+auto MinimapRenderer::tile(std::size_t index, const LineSource& source) -> const MinimapImage&
+{
+    const auto key = stamps_[index];
+    if (const auto* cached = tiles_.get(key))
+    {
+        return *cached;
+    }
+    tiles_.put(key, render_tile(index, source));
+    return *tiles_.get(key);
+}
+
+auto MinimapRenderer::render_tile(std::size_t index, const LineSource& source) const
+    -> MinimapImage
+{
+    MinimapImage image;
+    image.width = width_;
+    image.height = static_cast<int>(kTileLines) * line_height_;
+    image.rgb.resize(static_cast<std::size_t>(image.width) * static_cast<std::size_t>(image.height) *
+                     3);
+    fill(image, background_);
+
+    const auto first = index * kTileLines;
+    const auto last = std::min(first + kTileLines, line_count_);
+    for (auto line = first; line < last; ++line)
+    {
+        rasterize_line(source(line), static_cast<int>(line - first) * line_height_, image);
+    }
+    ++stats_.tiles_rendered;
+    stats_.lines_rendered += last - first;
+    return image;
+}
+
+void MinimapRenderer::rasterize_line(const Line& line, int top, MinimapImage& image) const
+{
+    const auto row_bytes = static_cast<std::size_t>(image.width) * 3;
+    const Color fallback = palette_.empty() ? Color{128, 128, 128} : palette_.front();
+    auto run = line.runs.begin();
+    int column = 0;
+    for (std::size_t pos = 0; pos < line.text.size() && column < image.width; ++pos)
+    {
+        const char chr = line.text[pos];
+        if (chr == '\n' || chr == '\r')
+        {
+            break;
+        }
+        if (chr == '\t')
+        {
+            column = (column / kTabColumns + 1) * kTabColumns;
+            continue;
+        }
+        if (chr == ' ')
+        {
+            ++column;
+            continue;
+        }
+        if ((static_cast<unsigned char>(chr) & 0xC0U) == 0x80U)
+        {
+            continue; // UTF-8 continuation byte: same column
+        }
+
+        while (run != line.runs.end() && run->end() <= pos)
+        {
+            ++run;
+        }
+        const std::size_t style = run != line.runs.end() && run->start <= pos ? run->style_id : 0;
+        const Color color = style < palette_.size() ? palette_[style] : fallback;
+        for (int row = top; row < top + line_height_; ++row)
+        {
+            auto* pixel = image.rgb.data() + static_cast<std::size_t>(row) * row_bytes +
+                          static_cast<std::size_t>(column) * 3;
+            pixel[0] = color.r;
+            pixel[1] = color.g;
+            pixel[2] = color.b;
+        }
+        ++column;
+    }
+}
+
+} // namespace markamp::core
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "ChunkedStorage.h"
+#include "Color.h"
+#include "StyleRunStore.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace markamp::core
+{
+
+/// Opaque minimap pixels, 3 bytes (RGB) per pixel, row by row — the layout
+/// wxImage takes without conversion.
+struct MinimapImage
+{
+    int width{0};
+    int height{0};
+    std::vector<std::uint8_t> rgb;
+};
+
+/// Rasterizes the editor minimap: every line becomes a 1–2 px tall bar
+/// with one pixel per character column, coloured by the line's style runs,
+/// and whitespace left as background.
+///
+/// Lines are rendered in tiles of kTileLines lines that are kept in a
+/// byte-capped LRU. Each tile is keyed by a stamp that edits and restyles
+/// replace, so a changed tile is simply re-rendered on its next paint and
+/// the stale copy ages out of the cache. paint_rows() composes a strip of
+/// content rows from the tiles it covers, rendering only missing ones:
+/// a frame costs O(visible tiles) no matter how long the document is.
+///
+/// Pattern implemented: #13 Viewport virtualization
+/// Pattern implemented: #39 Memory locality — capped render caches
+class MinimapRenderer
+{
+public:
+    /// What the minimap needs of one line: its text (line ending optional)
+    /// and style runs over it. Bytes outside the runs use style 0.
+    struct Line
+    {
+        std::string_view text;
+        std::vector<StyleRun> runs;
+    };
+
+    /// Called while a tile renders; the text only needs to stay valid
+    /// until the next call.
+    using LineSource = std::function<Line(std::size_t line)>;
+
+    static constexpr std::size_t kTileLines = 64;
+    static constexpr std::size_t kMaxCacheBytes = static_cast<std::size_t>(2) * 1024 * 1024;
+    static constexpr int kTabColumns = 4;
+    static constexpr int kMaxLineHeight = 2;
+
+    explicit MinimapRenderer(std::size_t max_bytes = kMaxCacheBytes);
+
+    /// Pixel width (one column per pixel) and rows per line (1 or 2).
+    void set_geometry(int width, int line_height);
+
+    /// Colour of each style id; ids past the end use the first entry.
+    void set_palette(std::vector<Color> style_colors, Color background);
+
+    /// A new document of `line_count` lines: every tile is stale.
+    void reset(std::size_t line_count);
+
+    /// The text changed on `line`, and `lines_added` lines were inserted
+    /// after it (removed, if negative). Later lines move, so their tiles
+    /// are stale too.
+    void on_lines_changed(std::size_t line, std::ptrdiff_t lines_added);
+
+    /// Lines [first_line, last_line) were restyled.
+    void invalidate_lines(std::size_t first_line, std::size_t last_line);
+
+    /// Lines whose pixels changed since the last call, as [first, last);
+    /// empty if none did.
+    [[nodiscard]] auto take_dirty_lines() -> std::pair<std::size_t, std::size_t>;
+
+    /// Content row at the top of a `view_height` pixel tall minimap, so
+    /// that it scrolls in proportion to the editor.
+    [[nodiscard]] auto scroll_top(std::size_t first_visible_line,
+                                  std::size_t visible_lines,
+                                  int view_height) const noexcept -> int;
+
+    /// The line drawn at content row `row`.
+    [[nodiscard]] auto line_at(int row) const noexcept -> std::size_t;
+
+    /// Content rows [first_row, first_row + row_count), background past
+    /// the last line.
+    [[nodiscard]] auto paint_rows(int first_row, int row_count, const LineSource& source)
+        -> MinimapImage;
+
+    [[nodiscard]] auto line_count() const noexcept -> std::size_t
+    {
+        return line_count_;
+    }
+
+    [[nodiscard]] auto line_height() const noexcept -> int
+    {
+        return line_height_;
+    }
+
+    [[nodiscard]] auto width() const noexcept -> int
+    {
+        return width_;
+    }
+
+    [[nodiscard]] auto content_height() const noexcept -> int
+    {
+        return static_cast<int>(line_count_) * line_height_;
+    }
+
+    struct Stats
+    {
+        std::size_t tiles_rendered{0};
+        std::size_t lines_rendered{0};
+    };
+
+    [[nodiscard]] auto stats() const noexcept -> const Stats&
+    {
+        return stats_;
+    }
+
+    [[nodiscard]] auto cache_bytes() const noexcept -> std::size_t
+    {
+        return tiles_.current_bytes();
+    }
+
+private:
+    [[nodiscard]] auto tile_count() const noexcept -> std::size_t;
+    void restamp_tiles(std::size_t first_tile, std::size_t last_tile);
+    void mark_dirty(std::size_t first_line, std::size_t last_line);
+    void invalidate_all();
+    [[nodiscard]] auto tile(std::size_t index, const LineSource& source) -> const MinimapImage&;
+    [[nodiscard]] auto render_tile(std::size_t index, const LineSource& source) const
+        -> MinimapImage;
+    void rasterize_line(const Line& line, int top, MinimapImage& image) const;
+
+    ByteCappedLRU<std::uint64_t, MinimapImage> tiles_;
+    std::vector<std::uint64_t> stamps_; // Cache key of each tile's current pixels
+    std::uint64_t next_stamp_{1};
+
+    std::size_t line_count_{1};
+    int width_{120};
+    int line_height_{kMaxLineHeight};
+    std::vector<Color> palette_;
+    Color background_{0, 0, 0};
+
+    static constexpr std::size_t kNoDirtyLine = static_cast<std::size_t>(-1);
+    std::size_t dirty_first_{kNoDirtyLine};
+    std::size_t dirty_last_{0};
+
+    mutable Stats stats_;
+};
+
+} // namespace markamp::core
@@ -1,5 +1,6 @@
 #include "OutputChannelService.h"
 
+#include <algorithm>
 #include <utility>
 
 namespace markamp::core
@@ -7,8 +8,25 @@ namespace markamp::core
 
 // ── OutputChannel ──
 
-OutputChannel::OutputChannel(std::string name)
+namespace
+{
+
+/// Retained size after trimming to a cap: three quarters of it.
+constexpr auto low_water(std::size_t cap) -> std::size_t
+{
+    return cap - cap / 4;
+}
+
+auto count_newlines(std::string_view text) -> std::size_t
+{
+    return static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n'));
+}
+
+} // namespace
+
+OutputChannel::OutputChannel(std::string name, OutputLimits limits)
     : name_(std::move(name))
+    , limits_(limits)
 {
 }
 
@@ -19,25 +37,52 @@ auto OutputChannel::name() const -> const std::string&
 
 auto OutputChannel::content() const -> std::string
 {
-    return content_;
+    std::lock_guard lock(mutex_);
+    return text_.read(0, text_.size());
 }
 
-void OutputChannel::append(const std::string& text)
+void OutputChannel::append(std::string_view text)
 {
-    content_ += text;
-    fire_content_change();
+    OutputChange change;
+    {
+        std::lock_guard lock(mutex_);
+        change.begin = start_offset_ + text_.size();
+        text_.append(text);
+        newline_count_ += count_newlines(text);
+        trim_locked();
+        change.end = start_offset_ + text_.size();
+        change.first_retained = start_offset_;
+    }
+    fire_content_change(change);
 }
 
-void OutputChannel::append_line(const std::string& text)
+void OutputChannel::append_line(std::string_view text)
 {
-    content_ += text + "\n";
-    fire_content_change();
+    OutputChange change;
+    {
+        std::lock_guard lock(mutex_);
+        change.begin = start_offset_ + text_.size();
+        text_.append(text);
+        text_.append("\n");
+        newline_count_ += count_newlines(text) + 1;
+        trim_locked();
+        change.end = start_offset_ + text_.size();
+        change.first_retained = start_offset_;
+    }
+    fire_content_change(change);
 }
 
 void OutputChannel::clear()
 {
-    content_.clear();
-    fire_content_change();
+    OutputChange change;
+    {
+        std::lock_guard lock(mutex_);
+        start_offset_ += text_.size();
+        text_.clear();
+        newline_count_ = 0;
+        change = {start_offset_, start_offset_, start_offset_, true};
+    }
+    fire_content_change(change);
 }
 
 void OutputChannel::show()
@@ -55,8 +100,150 @@ auto OutputChannel::is_visible() const -> bool
     return visible_;
 }
 
+auto OutputChannel::read_since(OutputCursor& cursor) const -> OutputDelta
+{
+    std::lock_guard lock(mutex_);
+    const auto end = start_offset_ + text_.size();
+
+    OutputDelta delta;
+    if (cursor.start < start_offset_ || cursor.end < start_offset_ || cursor.end > end)
+    {
+        // Trimmed or cleared under the reader: it starts over
+        delta.reset = true;
+        delta.text = text_.read(0, text_.size());
+        cursor = {start_offset_, end};
+        return delta;
+    }
+
+    const auto from = static_cast<std::size_t>(cursor.end - start_offset_);
+    delta.text = text_.read(from, text_.size() - from);
+    cursor.end = end;
+    return delta;
+}
+
+auto OutputChannel::start_offset() const -> std::uint64_t
+{
+    std::lock_guard lock(mutex_);
+    return start_offset_;
+}
+
+auto OutputChannel::end_offset() const -> std::uint64_t
+{
+    std::lock_guard lock(mutex_);
+    return start_offset_ + text_.size();
+}
+
+auto OutputChannel::size() const -> std::size_t
+{
+    std::lock_guard lock(mutex_);
+    return text_.size();
+}
+
+auto OutputChannel::line_count() const -> std::size_t
+{
+    std::lock_guard lock(mutex_);
+    return newline_count_;
+}
+
+auto OutputChannel::limits() const -> OutputLimits
+{
+    std::lock_guard lock(mutex_);
+    return limits_;
+}
+
+void OutputChannel::set_limits(OutputLimits limits)
+{
+    OutputChange change;
+    {
+        std::lock_guard lock(mutex_);
+        limits_ = limits;
+        const auto before = start_offset_;
+        trim_locked();
+        if (start_offset_ == before)
+        {
+            return;
+        }
+        const auto end = start_offset_ + text_.size();
+        change = {end, end, start_offset_, false};
+    }
+    fire_content_change(change);
+}
+
+void OutputChannel::trim_locked()
+{
+    const bool over_bytes = limits_.max_bytes != 0 && text_.size() > limits_.max_bytes;
+    const bool over_lines = limits_.max_lines != 0 && newline_count_ > limits_.max_lines;
+    if (!over_bytes && !over_lines)
+    {
+        return;
+    }
+
+    // Bytes and lines that must go to get under the low-water marks
+    const std::size_t byte_target =
+        limits_.max_bytes != 0 ? low_water(limits_.max_bytes) : text_.size();
+    const std::size_t min_bytes = text_.size() > byte_target ? text_.size() - byte_target : 0;
+    const std::size_t line_target =
+        limits_.max_lines != 0 ? low_water(limits_.max_lines) : newline_count_;
+    const std::size_t min_lines = newline_count_ > line_target ? newline_count_ - line_target : 0;
+
+    // Cut after the first newline that satisfies both, in one pass
+    std::size_t cut = std::string::npos;
+    std::size_t lines = 0;
+    std::size_t position = 0;
+    text_.for_each_span(0,
+                        text_.size(),
+                        [&](std::string_view span)
+                        {
+                            for (std::size_t index = 0;
+                                 cut == std::string::npos && index < span.size();
+                                 ++index)
+                            {
+                                if (span[index] != '\n')
+                                {
+                                    continue;
+                                }
+                                ++lines;
+                                if (lines >= min_lines && position + index + 1 >= min_bytes)
+                                {
+                                    cut = position + index + 1;
+                                }
+                            }
+                            position += span.size();
+                        });
+
+    if (cut == std::string::npos)
+    {
+        // One line longer than the byte cap: cut inside it, on a UTF-8
+        // character boundary
+        cut = min_bytes;
+        std::string boundary;
+        while (cut < text_.size())
+        {
+            boundary = text_.read(cut, 1);
+            if ((static_cast<unsigned char>(boundary.front()) & 0xC0U) != 0x80U)
+            {
+                break;
+            }
+            ++cut;
+        }
+        lines = newline_count_ - count_newlines(text_.read(cut, text_.size() - cut));
+    }
+
+    text_.drop_front(cut);
+    start_offset_ += cut;
+    newline_count_ -= lines;
+}
+
 auto OutputChannel::on_content_change(ContentChangeListener listener) -> std::size_t
 {
+    return on_change([listener = std::move(listener)](const OutputChannel& channel,
+                                                      const OutputChange& /*change*/)
+                     { listener(channel); });
+}
+
+auto OutputChannel::on_change(ChangeListener listener) -> std::size_t
+{
+    std::lock_guard lock(listeners_mutex_);
     auto listener_id = next_listener_id_++;
     listeners_.emplace_back(listener_id, std::move(listener));
     return listener_id;
@@ -64,6 +251,7 @@ auto OutputChannel::on_content_change(ContentChangeListener listener) -> std::si
 
 void OutputChannel::remove_content_listener(std::size_t listener_id)
 {
+    std::lock_guard lock(listeners_mutex_);
     listeners_.erase(std::remove_if(listeners_.begin(),
                                     listeners_.end(),
                                     [listener_id](const auto& pair)
@@ -71,11 +259,12 @@ void OutputChannel::remove_content_listener(std::size_t listener_id)
                      listeners_.end());
 }
 
-void OutputChannel::fire_content_change()
+void OutputChannel::fire_content_change(const OutputChange& change)
 {
+    std::lock_guard lock(listeners_mutex_);
     for (const auto& [id, listener] : listeners_)
     {
-        listener(*this);
+        listener(*this, change);
     }
 }
 
@@ -83,8 +272,8 @@ void OutputChannel::fire_content_change()
 
 auto OutputChannelService::create_channel(const std::string& channel_name) -> OutputChannel*
 {
-    auto [inserted_it, inserted] =
-        channels_.emplace(channel_name, std::make_unique<OutputChannel>(channel_name));
+    auto [inserted_it, inserted] = channels_.emplace(
+        channel_name, std::make_unique<OutputChannel>(channel_name, default_limits_));
     return inserted_it->second.get();
 }
 
@@ -120,4 +309,9 @@ void OutputChannelService::set_active_channel(const std::string& channel_name)
     active_channel_ = channel_name;
 }
 
+void OutputChannelService::set_default_limits(OutputLimits limits)
+{
+    default_limits_ = limits;
+}
+
 } // namespace markamp::core
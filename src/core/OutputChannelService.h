@@ -1,44 +1,129 @@
 #pragma once
 
+#include "ChunkedStorage.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 namespace markamp::core
 {
 
+/// Retention caps of an output channel; 0 disables a cap.
+struct OutputLimits
+{
+    static constexpr std::size_t kDefaultMaxBytes = static_cast<std::size_t>(4) * 1024 * 1024;
+    static constexpr std::size_t kDefaultMaxLines = 50'000;
+
+    std::size_t max_bytes{kDefaultMaxBytes};
+    std::size_t max_lines{kDefaultMaxLines};
+};
+
+/// What one append or clear did to a channel. Offsets are absolute: they
+/// count every byte ever written, so they stay valid across trimming.
+struct OutputChange
+{
+    std::uint64_t begin{0};          // First appended byte
+    std::uint64_t end{0};            // One past the last appended byte
+    std::uint64_t first_retained{0}; // Older bytes were trimmed or cleared
+    bool cleared{false};
+};
+
+/// Position of a reader (e.g. a text view) in a channel: the absolute
+/// range of the channel's text it currently shows.
+struct OutputCursor
+{
+    std::uint64_t start{0};
+    std::uint64_t end{0};
+};
+
+/// Text a reader needs to catch up with a channel.
+struct OutputDelta
+{
+    bool reset{false}; // Part of what the reader shows is gone: replace it with `text`
+    std::string text;  // Otherwise: append `text`
+};
+
 /// An output channel that extensions can write to (equivalent to VS Code's OutputChannel).
+///
+/// Text is kept in a ChunkedRingBuffer capped by OutputLimits. Once a cap
+/// is exceeded whole lines are dropped from the front down to three
+/// quarters of the cap, so trimming happens once per quarter-cap of new
+/// output rather than on every append. Change listeners receive just the
+/// appended range and readers catch up with read_since(), so a view
+/// appends what is new instead of re-reading the whole channel.
+///
+/// Appends may come from any thread. Listeners run on the appending
+/// thread, outside the text lock, and must not add or remove listeners.
 class OutputChannel
 {
 public:
-    explicit OutputChannel(std::string name);
+    explicit OutputChannel(std::string name, OutputLimits limits = {});
 
     [[nodiscard]] auto name() const -> const std::string&;
+
+    /// Copy of the retained text. Views should prefer read_since().
     [[nodiscard]] auto content() const -> std::string;
 
-    void append(const std::string& text);
-    void append_line(const std::string& text);
+    void append(std::string_view text);
+    void append_line(std::string_view text);
     void clear();
     void show();
     void hide();
 
     [[nodiscard]] auto is_visible() const -> bool;
 
+    /// Text appended since `cursor`, advancing it to the end of the channel.
+    [[nodiscard]] auto read_since(OutputCursor& cursor) const -> OutputDelta;
+
+    /// Absolute offsets of the retained text.
+    [[nodiscard]] auto start_offset() const -> std::uint64_t;
+    [[nodiscard]] auto end_offset() const -> std::uint64_t;
+
+    /// Retained bytes and complete lines.
+    [[nodiscard]] auto size() const -> std::size_t;
+    [[nodiscard]] auto line_count() const -> std::size_t;
+
+    [[nodiscard]] auto limits() const -> OutputLimits;
+    void set_limits(OutputLimits limits);
+
     /// Listener for content changes.
     using ContentChangeListener = std::function<void(const OutputChannel& channel)>;
     auto on_content_change(ContentChangeListener listener) -> std::size_t;
+
+    /// Listener that is told which range changed.
+    using ChangeListener =
+        std::function<void(const OutputChannel& channel, const OutputChange& change)>;
+    auto on_change(ChangeListener listener) -> std::size_t;
+
+    /// Remove a listener added by on_content_change() or on_change(). Waits
+    /// for a running notification to finish.
     void remove_content_listener(std::size_t listener_id);
 
 private:
     std::string name_;
-    std::string content_;
-    bool visible_{false};
-    std::vector<std::pair<std::size_t, ContentChangeListener>> listeners_;
-    std::size_t next_listener_id_{0};
+    std::atomic<bool> visible_{false};
 
-    void fire_content_change();
+    mutable std::mutex mutex_;
+    ChunkedRingBuffer<> text_;      // GUARDED_BY(mutex_)
+    std::uint64_t start_offset_{0}; // GUARDED_BY(mutex_) Absolute offset of text_'s front
+    std::size_t newline_count_{0};  // GUARDED_BY(mutex_)
+    OutputLimits limits_;           // GUARDED_BY(mutex_)
+
+    std::mutex listeners_mutex_;
+    std::vector<std::pair<std::size_t, ChangeListener>> listeners_; // GUARDED_BY(listeners_mutex_)
+    std::size_t next_listener_id_{0};                               // GUARDED_BY(listeners_mutex_)
+
+    /// Drop whole lines from the front until both caps have headroom.
+    void trim_locked();
+    void fire_content_change(const OutputChange& change);
 };
 
 /// Service that manages all output channels (equivalent to VS Code's Output Panel backend).
@@ -65,9 +150,13 @@ public:
     /// Set the active channel.
     void set_active_channel(const std::string& channel_name);
 
+    /// Caps given to channels created from now on.
+    void set_default_limits(OutputLimits limits);
+
 private:
     std::unordered_map<std::string, std::unique_ptr<OutputChannel>> channels_;
     std::string active_channel_;
+    OutputLimits default_limits_;
 };
 
 } // namespace markamp::core
@@ -1,21 +1,258 @@
 #include "PieceTable.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iterator>
 #include <stdexcept>
 
 namespace markamp::core
 {
 
+namespace
+{
+
+/// Ownership ids for copy-on-write. Every table (and every copy) edits only
+/// nodes stamped with its current id; taking a copy retires the id.
+auto next_owner_id() -> uint64_t
+{
+    static std::atomic<uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+auto count_line_breaks(std::string_view text) -> std::size_t
+{
+    return static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n'));
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Tree node
+// ═══════════════════════════════════════════════════════
+
+struct PieceTable::Node
+{
+    uint64_t owner{0};
+    bool leaf{true};
+    std::size_t bytes{0};
+    std::size_t line_breaks{0};
+    std::size_t piece_total{0};
+    std::vector<Piece> pieces;     // Leaf only
+    std::vector<NodePtr> children; // Internal only
+
+    [[nodiscard]] auto fanout() const noexcept -> std::size_t
+    {
+        return leaf ? pieces.size() : children.size();
+    }
+
+    [[nodiscard]] auto min_fanout() const noexcept -> std::size_t
+    {
+        return leaf ? kMaxLeafPieces / 4 : kMaxChildren / 4;
+    }
+
+    void recompute() noexcept
+    {
+        bytes = 0;
+        line_breaks = 0;
+        if (leaf)
+        {
+            for (const auto& piece : pieces)
+            {
+                bytes += piece.length;
+                line_breaks += piece.line_breaks;
+            }
+            piece_total = pieces.size();
+            return;
+        }
+        piece_total = 0;
+        for (const auto& child : children)
+        {
+            bytes += child->bytes;
+            line_breaks += child->line_breaks;
+            piece_total += child->piece_total;
+        }
+    }
+};
+
+// ═══════════════════════════════════════════════════════
+// Construction and copy-on-write
+// ═══════════════════════════════════════════════════════
+
 PieceTable::PieceTable(std::string content)
-    : original_buffer_(std::move(content))
-    , total_size_(original_buffer_.size())
+    : original_buffer_(std::make_shared<const std::string>(std::move(content)))
+    , owner_(next_owner_id())
 {
-    if (!original_buffer_.empty())
+    // Split the original into bounded pieces so in-piece scans stay short
+    std::vector<Piece> pieces;
+    const auto total = original_buffer_->size();
+    pieces.reserve(total / kMaxPieceBytes + 1);
+    for (std::size_t offset = 0; offset < total; offset += kMaxPieceBytes)
     {
-        pieces_.push_back(Piece{BufferSource::Original, 0, original_buffer_.size()});
+        pieces.push_back(
+            make_piece(BufferSource::Original, offset, std::min(kMaxPieceBytes, total - offset)));
     }
+    root_ = build_tree(std::move(pieces));
 }
 
+PieceTable::PieceTable(const PieceTable& other)
+    : original_buffer_(other.original_buffer_)
+    , append_chunks_(other.append_chunks_)
+    , append_size_(other.append_size_)
+    , append_chunk_shared_(true)
+    , root_(other.root_)
+    , owner_(next_owner_id())
+{
+    // Every existing node is now shared: both sides must clone before editing
+    other.owner_ = next_owner_id();
+}
+
+auto PieceTable::operator=(const PieceTable& other) -> PieceTable&
+{
+    if (this != &other)
+    {
+        PieceTable copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+auto PieceTable::snapshot() const -> PieceTable
+{
+    return PieceTable(*this);
+}
+
+auto PieceTable::build_tree(std::vector<Piece> pieces) const -> NodePtr
+{
+    std::vector<NodePtr> level;
+    for (std::size_t i = 0; i < pieces.size() || level.empty(); i += kMaxLeafPieces)
+    {
+        auto leaf = std::make_shared<Node>();
+        leaf->owner = owner_;
+        const auto end = std::min(pieces.size(), i + kMaxLeafPieces);
+        leaf->pieces.assign(pieces.begin() + static_cast<std::ptrdiff_t>(std::min(i, end)),
+                            pieces.begin() + static_cast<std::ptrdiff_t>(end));
+        leaf->recompute();
+        level.push_back(std::move(leaf));
+    }
+
+    while (level.size() > 1)
+    {
+        std::vector<NodePtr> parents;
+        for (std::size_t i = 0; i < level.size(); i += kMaxChildren)
+        {
+            auto parent = std::make_shared<Node>();
+            parent->owner = owner_;
+            parent->leaf = false;
+            const auto end = std::min(level.size(), i + kMaxChildren);
+            parent->children.assign(level.begin() + static_cast<std::ptrdiff_t>(i),
+                                    level.begin() + static_cast<std::ptrdiff_t>(end));
+            parent->recompute();
+            parents.push_back(std::move(parent));
+        }
+        level = std::move(parents);
+    }
+    return level.front();
+}
+
+auto PieceTable::clone(const Node& node) const -> NodePtr
+{
+    auto copy = std::make_shared<Node>(node);
+    copy->owner = owner_;
+    return copy;
+}
+
+auto PieceTable::mutable_root() -> Node&
+{
+    if (root_->owner != owner_)
+    {
+        root_ = clone(*root_);
+    }
+    return *root_;
+}
+
+auto PieceTable::mutable_child(Node& parent, std::size_t index) -> Node&
+{
+    auto& child = parent.children[index];
+    if (child->owner != owner_)
+    {
+        child = clone(*child);
+    }
+    return *child;
+}
+
+// ═══════════════════════════════════════════════════════
+// Buffers
+// ═══════════════════════════════════════════════════════
+
+auto PieceTable::append_text(std::string_view text) -> std::vector<Piece>
+{
+    std::vector<Piece> slices;
+    while (!text.empty())
+    {
+        const bool chunk_full = !append_chunks_.empty() &&
+                                append_size_ - append_chunks_.back().start == kMaxPieceBytes;
+        if (append_chunks_.empty() || append_chunk_shared_ || chunk_full)
+        {
+            append_chunks_.push_back(
+                AppendChunk{append_size_, std::make_shared<char[]>(kMaxPieceBytes)});
+            append_chunk_shared_ = false;
+        }
+
+        auto& chunk = append_chunks_.back();
+        const auto fill = append_size_ - chunk.start;
+        const auto n = std::min(text.size(), kMaxPieceBytes - fill);
+        std::memcpy(chunk.data.get() + fill, text.data(), n);
+
+        slices.push_back(make_piece(BufferSource::Append, append_size_, n));
+        append_size_ += n;
+        text.remove_prefix(n);
+    }
+    return slices;
+}
+
+auto PieceTable::piece_text(const Piece& piece) const -> std::string_view
+{
+    if (piece.source == BufferSource::Original)
+    {
+        return std::string_view(*original_buffer_).substr(piece.offset, piece.length);
+    }
+
+    // Last chunk whose start is <= offset; pieces never straddle chunks
+    auto it = std::upper_bound(append_chunks_.begin(),
+                               append_chunks_.end(),
+                               piece.offset,
+                               [](std::size_t offset, const AppendChunk& chunk)
+                               { return offset < chunk.start; });
+    const auto& chunk = *std::prev(it);
+    return {chunk.data.get() + (piece.offset - chunk.start), piece.length};
+}
+
+auto PieceTable::make_piece(BufferSource source, std::size_t offset, std::size_t length) const
+    -> Piece
+{
+    Piece piece{source, offset, length, 0};
+    piece.line_breaks = count_line_breaks(piece_text(piece));
+    return piece;
+}
+
+auto PieceTable::can_extend(const Piece& previous, const Piece& next) const -> bool
+{
+    // Typing: consecutive inserts land back-to-back in the same append chunk
+    if (previous.source != BufferSource::Append || next.source != BufferSource::Append ||
+        previous.offset + previous.length != next.offset ||
+        previous.length + next.length > kMaxPieceBytes)
+    {
+        return false;
+    }
+    const auto& chunk = append_chunks_.back();
+    return previous.offset >= chunk.start && next.offset > chunk.start;
+}
+
+// ═══════════════════════════════════════════════════════
+// Editing
+// ═══════════════════════════════════════════════════════
+
 void PieceTable::insert(std::size_t offset, std::string_view text)
 {
     if (text.empty())
@@ -23,121 +260,276 @@ void PieceTable::insert(std::size_t offset, std::string_view text)
         return;
     }
 
-    // Record where in the append buffer this text starts
-    auto append_offset = append_buffer_.size();
-    append_buffer_.append(text);
+    offset = std::min(offset, size());
+    for (const auto& piece : append_text(text))
+    {
+        auto sibling = insert_into(mutable_root(), offset, piece);
+        if (sibling)
+        {
+            // Root split: grow the tree by one level
+            auto new_root = std::make_shared<Node>();
+            new_root->owner = owner_;
+            new_root->leaf = false;
+            new_root->children = {root_, std::move(sibling)};
+            new_root->recompute();
+            root_ = std::move(new_root);
+        }
+        offset += piece.length;
+    }
+}
+
+auto PieceTable::insert_into(Node& node, std::size_t offset, const Piece& piece) -> NodePtr
+{
+    if (node.leaf)
+    {
+        auto& pieces = node.pieces;
+        std::size_t idx = 0;
+        std::size_t pos = 0;
+        while (idx < pieces.size() && offset >= pos + pieces[idx].length)
+        {
+            pos += pieces[idx].length;
+            ++idx;
+        }
 
-    Piece new_piece{BufferSource::Append, append_offset, text.size()};
+        const auto inner = offset - pos;
+        if (inner == 0)
+        {
+            if (idx > 0 && can_extend(pieces[idx - 1], piece))
+            {
+                pieces[idx - 1].length += piece.length;
+                pieces[idx - 1].line_breaks += piece.line_breaks;
+            }
+            else
+            {
+                pieces.insert(pieces.begin() + static_cast<std::ptrdiff_t>(idx), piece);
+            }
+        }
+        else
+        {
+            // Split the existing piece at inner offset
+            const auto existing = pieces[idx];
+            auto left = make_piece(existing.source, existing.offset, inner);
+            Piece right{existing.source,
+                        existing.offset + inner,
+                        existing.length - inner,
+                        existing.line_breaks - left.line_breaks};
+
+            // Replace existing piece with [left, piece, right]
+            pieces[idx] = left;
+            pieces.insert(pieces.begin() + static_cast<std::ptrdiff_t>(idx) + 1, {piece, right});
+        }
 
-    if (pieces_.empty() || offset >= total_size_)
+        node.bytes += piece.length;
+        node.line_breaks += piece.line_breaks;
+        node.piece_total = pieces.size();
+        return pieces.size() > kMaxLeafPieces ? split_node(node) : nullptr;
+    }
+
+    // Prefer the left child at a boundary so typing can extend its last piece
+    std::size_t idx = 0;
+    std::size_t pos = 0;
+    while (idx + 1 < node.children.size() && offset > pos + node.children[idx]->bytes)
     {
-        // Append at end
-        pieces_.push_back(new_piece);
-        total_size_ += text.size();
-        return;
+        pos += node.children[idx]->bytes;
+        ++idx;
     }
 
-    auto [piece_idx, inner_offset] = find_piece(offset);
+    auto sibling = insert_into(mutable_child(node, idx), offset - pos, piece);
+    if (sibling)
+    {
+        node.children.insert(node.children.begin() + static_cast<std::ptrdiff_t>(idx) + 1,
+                             std::move(sibling));
+    }
+    node.recompute();
+    return node.children.size() > kMaxChildren ? split_node(node) : nullptr;
+}
 
-    if (inner_offset == 0)
+auto PieceTable::split_node(Node& node) const -> NodePtr
+{
+    auto right = std::make_shared<Node>();
+    right->owner = owner_;
+    right->leaf = node.leaf;
+
+    const auto half = node.fanout() / 2;
+    if (node.leaf)
     {
-        // Insert before the piece — no splitting needed
-        pieces_.insert(pieces_.begin() + static_cast<std::ptrdiff_t>(piece_idx), new_piece);
+        right->pieces.assign(std::make_move_iterator(node.pieces.begin() +
+                                                     static_cast<std::ptrdiff_t>(half)),
+                             std::make_move_iterator(node.pieces.end()));
+        node.pieces.resize(half);
     }
     else
     {
-        // Split the existing piece at inner_offset
-        auto& existing = pieces_[piece_idx];
-        Piece left{existing.source, existing.offset, inner_offset};
-        Piece right{
-            existing.source, existing.offset + inner_offset, existing.length - inner_offset};
-
-        // Replace existing piece with [left, new_piece, right]
-        pieces_[piece_idx] = left;
-        auto insert_pos = pieces_.begin() + static_cast<std::ptrdiff_t>(piece_idx) + 1;
-        pieces_.insert(insert_pos, {new_piece, right});
+        right->children.assign(std::make_move_iterator(node.children.begin() +
+                                                       static_cast<std::ptrdiff_t>(half)),
+                               std::make_move_iterator(node.children.end()));
+        node.children.resize(half);
     }
-
-    total_size_ += text.size();
+    node.recompute();
+    right->recompute();
+    return right;
 }
 
 void PieceTable::erase(std::size_t offset, std::size_t count)
 {
-    if (count == 0 || pieces_.empty())
+    if (count == 0 || root_->bytes == 0)
     {
         return;
     }
 
     // Clamp to actual content
-    if (offset >= total_size_)
+    if (offset >= size())
     {
         return;
     }
-    count = std::min(count, total_size_ - offset);
+    count = std::min(count, size() - offset);
 
-    auto end_offset = offset + count;
+    erase_from(mutable_root(), offset, count);
 
-    // Find the piece containing the start of the deletion
-    auto [start_idx, start_inner] = find_piece(offset);
-
-    // Find the piece containing the end of the deletion
-    auto [end_idx, end_inner] = find_piece(end_offset);
+    // Shrink the tree while the root has a single child
+    while (!root_->leaf && root_->children.size() == 1)
+    {
+        root_ = root_->children.front();
+    }
+    if (!root_->leaf && root_->children.empty())
+    {
+        root_ = build_tree({});
+    }
+}
 
-    // Build replacement pieces for the partially affected boundaries
-    std::vector<Piece> replacements;
+void PieceTable::erase_from(Node& node, std::size_t offset, std::size_t count)
+{
+    const auto end = offset + count;
 
-    // Left remnant of start piece (if deletion doesn't start at piece boundary)
-    if (start_inner > 0)
+    if (node.leaf)
     {
-        auto& start_piece = pieces_[start_idx];
-        replacements.push_back(Piece{start_piece.source, start_piece.offset, start_inner});
+        std::vector<Piece> kept;
+        kept.reserve(node.pieces.size() + 1);
+        std::size_t pos = 0;
+        for (const auto& piece : node.pieces)
+        {
+            const auto piece_start = pos;
+            const auto piece_end = pos + piece.length;
+            pos = piece_end;
+
+            if (piece_end <= offset || piece_start >= end)
+            {
+                kept.push_back(piece);
+                continue;
+            }
+
+            // Left remnant (deletion starts inside this piece)
+            if (piece_start < offset)
+            {
+                kept.push_back(make_piece(piece.source, piece.offset, offset - piece_start));
+            }
+            // Right remnant (deletion ends inside this piece)
+            if (piece_end > end)
+            {
+                kept.push_back(
+                    make_piece(piece.source, piece.offset + (end - piece_start), piece_end - end));
+            }
+        }
+        node.pieces = std::move(kept);
+        node.recompute();
+        return;
     }
 
-    // Right remnant of end piece (if deletion doesn't end at piece boundary)
-    if (end_idx < pieces_.size() && end_inner > 0)
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < node.children.size(); ++i)
     {
-        auto& end_piece = pieces_[end_idx];
-        if (end_inner < end_piece.length)
+        const auto child_start = pos;
+        const auto child_end = pos + node.children[i]->bytes;
+        pos = child_end;
+
+        if (child_end <= offset)
         {
-            replacements.push_back(Piece{
-                end_piece.source, end_piece.offset + end_inner, end_piece.length - end_inner});
+            continue;
         }
-        ++end_idx; // This piece is consumed
+        if (child_start >= end)
+        {
+            break;
+        }
+
+        const auto lo = std::max(offset, child_start) - child_start;
+        const auto hi = std::min(end, child_end) - child_start;
+        erase_from(mutable_child(node, i), lo, hi - lo);
     }
 
-    // Determine the range to erase: from start_idx to end_idx (exclusive)
-    auto erase_begin = pieces_.begin() + static_cast<std::ptrdiff_t>(start_idx);
-    auto erase_end =
-        pieces_.begin() + static_cast<std::ptrdiff_t>(std::min(end_idx, pieces_.size()));
+    rebalance_children(node);
+    node.recompute();
+}
+
+void PieceTable::rebalance_children(Node& node)
+{
+    auto& children = node.children;
+    std::size_t i = 0;
+    while (i < children.size())
+    {
+        if (children[i]->fanout() == 0)
+        {
+            children.erase(children.begin() + static_cast<std::ptrdiff_t>(i));
+            continue;
+        }
+        if (children.size() == 1 || children[i]->fanout() >= children[i]->min_fanout())
+        {
+            ++i;
+            continue;
+        }
+
+        // Underflow: merge with a neighbour, or split the pair evenly
+        const auto left_idx = (i + 1 < children.size()) ? i : i - 1;
+        auto& left = mutable_child(node, left_idx);
+        auto& right = mutable_child(node, left_idx + 1);
+        const auto max_fanout = left.leaf ? kMaxLeafPieces : kMaxChildren;
+
+        if (left.leaf)
+        {
+            left.pieces.insert(left.pieces.end(), right.pieces.begin(), right.pieces.end());
+            right.pieces.clear();
+        }
+        else
+        {
+            left.children.insert(left.children.end(),
+                                 std::make_move_iterator(right.children.begin()),
+                                 std::make_move_iterator(right.children.end()));
+            right.children.clear();
+        }
 
-    // Replace the affected range with the remnants
-    pieces_.erase(erase_begin, erase_end);
-    pieces_.insert(pieces_.begin() + static_cast<std::ptrdiff_t>(start_idx),
-                   replacements.begin(),
-                   replacements.end());
+        if (left.fanout() <= max_fanout)
+        {
+            left.recompute();
+            children.erase(children.begin() + static_cast<std::ptrdiff_t>(left_idx) + 1);
+            i = left_idx;
+            continue;
+        }
 
-    total_size_ -= count;
+        auto redistributed = split_node(left);
+        children[left_idx + 1] = std::move(redistributed);
+        i = left_idx + 1;
+    }
 }
 
+// ═══════════════════════════════════════════════════════
+// Queries
+// ═══════════════════════════════════════════════════════
+
 auto PieceTable::text() const -> std::string
 {
     std::string result;
-    result.reserve(total_size_);
-    for (const auto& piece : pieces_)
-    {
-        const auto& buf = buffer_for(piece.source);
-        result.append(buf, piece.offset, piece.length);
-    }
+    result.reserve(size());
+    auto remaining = size();
+    append_range(*root_, 0, remaining, result);
     return result;
 }
 
 auto PieceTable::substr(std::size_t offset, std::size_t count) const -> std::string
 {
-    if (offset >= total_size_)
+    if (offset >= size())
     {
         return {};
     }
-    count = std::min(count, total_size_ - offset);
+    count = std::min(count, size() - offset);
     if (count == 0)
     {
         return {};
@@ -145,81 +537,198 @@ auto PieceTable::substr(std::size_t offset, std::size_t count) const -> std::str
 
     std::string result;
     result.reserve(count);
+    append_range(*root_, offset, count, result);
+    return result;
+}
 
-    auto [piece_idx, inner_offset] = find_piece(offset);
-    std::size_t remaining = count;
-
-    for (auto i = piece_idx; i < pieces_.size() && remaining > 0; ++i)
+void PieceTable::append_range(const Node& node,
+                              std::size_t offset,
+                              std::size_t& remaining,
+                              std::string& out) const
+{
+    if (node.leaf)
     {
-        const auto& piece = pieces_[i];
-        const auto& buf = buffer_for(piece.source);
-
-        auto start = (i == piece_idx) ? inner_offset : std::size_t{0};
-        auto available = piece.length - start;
-        auto to_copy = std::min(available, remaining);
-
-        result.append(buf, piece.offset + start, to_copy);
-        remaining -= to_copy;
+        for (const auto& piece : node.pieces)
+        {
+            if (remaining == 0)
+            {
+                return;
+            }
+            if (offset >= piece.length)
+            {
+                offset -= piece.length;
+                continue;
+            }
+            const auto slice = piece_text(piece).substr(offset, remaining);
+            out.append(slice);
+            remaining -= slice.size();
+            offset = 0;
+        }
+        return;
     }
 
-    return result;
+    for (const auto& child : node.children)
+    {
+        if (remaining == 0)
+        {
+            return;
+        }
+        if (offset >= child->bytes)
+        {
+            offset -= child->bytes;
+            continue;
+        }
+        append_range(*child, offset, remaining, out);
+        offset = 0;
+    }
 }
 
 auto PieceTable::at(std::size_t offset) const -> char
 {
-    if (offset >= total_size_)
+    if (offset >= size())
     {
         throw std::out_of_range("PieceTable::at: offset out of range");
     }
 
-    auto [piece_idx, inner_offset] = find_piece(offset);
-    const auto& piece = pieces_[piece_idx];
-    const auto& buf = buffer_for(piece.source);
-    return buf[piece.offset + inner_offset];
+    const Node* node = root_.get();
+    while (!node->leaf)
+    {
+        for (const auto& child : node->children)
+        {
+            if (offset < child->bytes)
+            {
+                node = child.get();
+                break;
+            }
+            offset -= child->bytes;
+        }
+    }
+    for (const auto& piece : node->pieces)
+    {
+        if (offset < piece.length)
+        {
+            return piece_text(piece)[offset];
+        }
+        offset -= piece.length;
+    }
+    throw std::out_of_range("PieceTable::at: offset out of range");
 }
 
 auto PieceTable::size() const noexcept -> std::size_t
 {
-    return total_size_;
+    return root_->bytes;
 }
 
 auto PieceTable::empty() const noexcept -> bool
 {
-    return total_size_ == 0;
+    return root_->bytes == 0;
 }
 
-auto PieceTable::piece_count() const noexcept -> std::size_t
+auto PieceTable::line_count() const noexcept -> std::size_t
 {
-    return pieces_.size();
+    return root_->line_breaks + 1;
 }
 
-auto PieceTable::find_piece(std::size_t offset) const -> std::pair<std::size_t, std::size_t>
+auto PieceTable::line_start(std::size_t line) const -> std::size_t
 {
+    if (line == 0)
+    {
+        return 0;
+    }
+    if (line > root_->line_breaks)
+    {
+        return size();
+    }
+
+    // Find the byte after the line-th newline
+    auto breaks_to_skip = line;
     std::size_t pos = 0;
-    for (std::size_t i = 0; i < pieces_.size(); ++i)
+    const Node* node = root_.get();
+    while (!node->leaf)
+    {
+        for (const auto& child : node->children)
+        {
+            if (breaks_to_skip <= child->line_breaks)
+            {
+                node = child.get();
+                break;
+            }
+            breaks_to_skip -= child->line_breaks;
+            pos += child->bytes;
+        }
+    }
+    for (const auto& piece : node->pieces)
+    {
+        if (breaks_to_skip <= piece.line_breaks)
+        {
+            const auto text = piece_text(piece);
+            for (std::size_t i = 0; i < text.size(); ++i)
+            {
+                if (text[i] == '\n' && --breaks_to_skip == 0)
+                {
+                    return pos + i + 1;
+                }
+            }
+        }
+        breaks_to_skip -= piece.line_breaks;
+        pos += piece.length;
+    }
+    return size();
+}
+
+auto PieceTable::line_of_offset(std::size_t offset) const -> std::size_t
+{
+    offset = std::min(offset, size());
+
+    std::size_t line = 0;
+    const Node* node = root_.get();
+    while (!node->leaf)
+    {
+        std::size_t idx = 0;
+        while (idx + 1 < node->children.size() && offset >= node->children[idx]->bytes)
+        {
+            offset -= node->children[idx]->bytes;
+            line += node->children[idx]->line_breaks;
+            ++idx;
+        }
+        node = node->children[idx].get();
+    }
+    for (const auto& piece : node->pieces)
     {
-        if (offset < pos + pieces_[i].length)
+        if (offset < piece.length)
         {
-            return {i, offset - pos};
+            return line + count_line_breaks(piece_text(piece).substr(0, offset));
         }
-        pos += pieces_[i].length;
+        offset -= piece.length;
+        line += piece.line_breaks;
+    }
+    return line;
+}
+
+auto PieceTable::line(std::size_t line) const -> std::string
+{
+    if (line > root_->line_breaks)
+    {
+        return {};
     }
-    // offset == total_size_ — points past-the-end
-    return {pieces_.size(), 0};
+    const auto start = line_start(line);
+    const auto end = (line < root_->line_breaks) ? line_start(line + 1) - 1 : size();
+    return substr(start, end - start);
 }
 
-auto PieceTable::buffer_for(BufferSource source) const -> const std::string&
+auto PieceTable::piece_count() const noexcept -> std::size_t
 {
-    return (source == BufferSource::Original) ? original_buffer_ : append_buffer_;
+    return root_->piece_total;
 }
 
-void PieceTable::recalculate_size() noexcept
+auto PieceTable::tree_height() const noexcept -> std::size_t
 {
-    total_size_ = 0;
-    for (const auto& piece : pieces_)
+    std::size_t height = 1;
+    for (const Node* node = root_.get(); !node->leaf; node = node->children.front().get())
     {
-        total_size_ += piece.length;
+        ++height;
     }
+    return height;
 }
 
 } // namespace markamp::core
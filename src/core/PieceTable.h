@@ -2,9 +2,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
-#include <utility>
 #include <vector>
 
 namespace markamp::core
@@ -21,8 +21,9 @@ enum class BufferSource : uint8_t
 struct Piece
 {
     BufferSource source{BufferSource::Original};
-    std::size_t offset{0}; // byte offset within the source buffer
-    std::size_t length{0}; // number of bytes
+    std::size_t offset{0};      // byte offset within the source buffer
+    std::size_t length{0};      // number of bytes
+    std::size_t line_breaks{0}; // number of '\n' bytes in the slice (cached)
 };
 
 /// A piece table for efficient text editing.
@@ -32,15 +33,25 @@ struct Piece
 /// or the append buffer. Edits (insert/delete) only modify the piece
 /// sequence — the underlying buffers are immutable after creation.
 ///
-/// Complexity:
-///   insert() — O(pieces) for find + O(pieces) for vector shift
-///   erase()  — O(pieces)
+/// Pieces live in the leaves of a B-tree whose nodes cache their byte
+/// length and newline count, so every positional query descends one
+/// root-to-leaf path. No piece is longer than kMaxPieceBytes, which bounds
+/// the scan inside the final piece.
+///
+/// Complexity (n = pieces, k = bytes returned):
+///   insert() — O(log n)
+///   erase()  — O(log n + pieces removed)
+///   at()     — O(log n)
+///   substr() — O(log n + k)
 ///   text()   — O(total_bytes)
-///   substr() — O(pieces + requested_bytes)
-///   size()   — O(pieces)  (cached internally)
+///   line_start() / line_of_offset() — O(log n)
+///   size() / line_count() — O(1)  (cached in the root)
+///   snapshot() — O(1)
 ///
-/// For very large files with many edits, replace the std::vector<Piece>
-/// with a balanced tree (B-tree) for O(log n) indexing.
+/// Copies (and snapshot()) share the tree copy-on-write: nodes are cloned
+/// only when one side edits them, and the append buffer is chunked so bytes
+/// a snapshot references are never moved. A snapshot may therefore be handed
+/// to a background thread and read there while this table keeps editing.
 ///
 /// Pattern implemented: #3 Rope/piece-table text buffer
 class PieceTable
@@ -49,6 +60,13 @@ public:
     /// Construct from initial file content.
     explicit PieceTable(std::string content = "");
 
+    /// Copies share structure with the source; see snapshot().
+    PieceTable(const PieceTable& other);
+    auto operator=(const PieceTable& other) -> PieceTable&;
+    PieceTable(PieceTable&&) noexcept = default;
+    auto operator=(PieceTable&&) noexcept -> PieceTable& = default;
+    ~PieceTable() = default;
+
     /// Insert text at the given logical byte offset.
     void insert(std::size_t offset, std::string_view text);
 
@@ -61,7 +79,7 @@ public:
     /// Retrieve a substring from the logical buffer.
     [[nodiscard]] auto substr(std::size_t offset, std::size_t count) const -> std::string;
 
-    /// Character at a logical offset. O(pieces).
+    /// Character at a logical offset. O(log pieces).
     [[nodiscard]] auto at(std::size_t offset) const -> char;
 
     /// Total logical length in bytes.
@@ -70,24 +88,79 @@ public:
     /// Whether the buffer is empty.
     [[nodiscard]] auto empty() const noexcept -> bool;
 
+    /// Number of lines (newline count + 1).
+    [[nodiscard]] auto line_count() const noexcept -> std::size_t;
+
+    /// Byte offset of the first character of a 0-based line, or size() if
+    /// the line does not exist.
+    [[nodiscard]] auto line_start(std::size_t line) const -> std::size_t;
+
+    /// 0-based line containing the byte at `offset` (clamped to size()).
+    [[nodiscard]] auto line_of_offset(std::size_t offset) const -> std::size_t;
+
+    /// Text of a 0-based line without its trailing newline.
+    [[nodiscard]] auto line(std::size_t line) const -> std::string;
+
+    /// Frozen copy of the current text in O(1). The snapshot and this table
+    /// are independent afterwards; the snapshot is safe to read on another
+    /// thread while this one keeps editing.
+    [[nodiscard]] auto snapshot() const -> PieceTable;
+
     /// Number of pieces in the piece sequence (diagnostic).
     [[nodiscard]] auto piece_count() const noexcept -> std::size_t;
 
-private:
-    std::string original_buffer_;
-    std::string append_buffer_;
-    std::vector<Piece> pieces_;
-    std::size_t total_size_{0};
+    /// Levels in the piece tree, 1 for a single leaf (diagnostic).
+    [[nodiscard]] auto tree_height() const noexcept -> std::size_t;
 
-    /// Find which piece contains the given logical offset.
-    /// Returns {piece_index, offset_within_piece}.
-    [[nodiscard]] auto find_piece(std::size_t offset) const -> std::pair<std::size_t, std::size_t>;
+    static constexpr std::size_t kMaxPieceBytes = static_cast<std::size_t>(64) * 1024;
+    static constexpr std::size_t kMaxLeafPieces = 64;
+    static constexpr std::size_t kMaxChildren = 32;
 
-    /// Get a reference to the buffer for a given source.
-    [[nodiscard]] auto buffer_for(BufferSource source) const -> const std::string&;
-
-    /// Recalculate total_size_ from pieces.
-    void recalculate_size() noexcept;
+private:
+    struct Node;
+    using NodePtr = std::shared_ptr<Node>;
+
+    /// Fixed-capacity slab of the append buffer. Never reallocated, so
+    /// snapshots can keep reading the prefix they know about.
+    struct AppendChunk
+    {
+        std::size_t start{0}; // logical offset of data[0] in the append buffer
+        std::shared_ptr<char[]> data;
+    };
+
+    std::shared_ptr<const std::string> original_buffer_;
+    std::vector<AppendChunk> append_chunks_;
+    std::size_t append_size_{0};
+    bool append_chunk_shared_{false}; // Last chunk also belongs to another copy
+    NodePtr root_;
+    mutable uint64_t owner_{0}; // Nodes tagged with this id may be edited in place
+
+    /// Copy `text` into the append buffer; returns one piece per chunk touched.
+    [[nodiscard]] auto append_text(std::string_view text) -> std::vector<Piece>;
+
+    /// Build a piece over a buffer slice, counting its line breaks.
+    [[nodiscard]] auto make_piece(BufferSource source, std::size_t offset, std::size_t length) const
+        -> Piece;
+
+    /// The bytes a piece refers to.
+    [[nodiscard]] auto piece_text(const Piece& piece) const -> std::string_view;
+
+    [[nodiscard]] auto build_tree(std::vector<Piece> pieces) const -> NodePtr;
+    [[nodiscard]] auto clone(const Node& node) const -> NodePtr;
+    [[nodiscard]] auto mutable_root() -> Node&;
+    [[nodiscard]] auto mutable_child(Node& parent, std::size_t index) -> Node&;
+    [[nodiscard]] auto can_extend(const Piece& previous, const Piece& next) const -> bool;
+
+    /// Insert into a subtree; returns the new right sibling if `node` split.
+    [[nodiscard]] auto insert_into(Node& node, std::size_t offset, const Piece& piece) -> NodePtr;
+    [[nodiscard]] auto split_node(Node& node) const -> NodePtr;
+    void erase_from(Node& node, std::size_t offset, std::size_t count);
+    void rebalance_children(Node& node);
+
+    void append_range(const Node& node,
+                      std::size_t offset,
+                      std::size_t& remaining,
+                      std::string& out) const;
 };
 
 } // namespace markamp::core
@@ -3,6 +3,7 @@
 #include "Config.h"
 #include "EventBus.h"
 #include "Events.h"
+#include "GrammarEngine.h"
 #include "Logger.h"
 #include "ShortcutManager.h"
 #include "StatusBarItemService.h"
@@ -18,6 +19,23 @@
 namespace markamp::core
 {
 
+namespace
+{
+
+/// Manifest paths are relative to the extension, not to the working directory.
+auto resolve_contribution_path(const std::filesystem::path& install_dir, const std::string& path)
+    -> std::filesystem::path
+{
+    std::filesystem::path resolved{path};
+    if (resolved.is_relative() && !install_dir.empty())
+    {
+        resolved = install_dir / resolved;
+    }
+    return resolved.lexically_normal();
+}
+
+} // anonymous namespace
+
 PluginManager::PluginManager(EventBus& event_bus, Config& config)
     : event_bus_(event_bus)
     , config_(config)
@@ -62,12 +80,13 @@ auto PluginManager::register_plugin(std::unique_ptr<IPlugin> plugin) -> bool
     MARKAMP_LOG_INFO(
         "Registered plugin: {} v{}", plugin->manifest().name, plugin->manifest().version);
 
-    plugins_.push_back(PluginEntry{std::move(plugin), {}, std::nullopt});
+    plugins_.push_back(PluginEntry{std::move(plugin), {}, std::nullopt, {}});
     return true;
 }
 
-auto PluginManager::register_plugin(std::unique_ptr<IPlugin> plugin, ExtensionManifest ext_manifest)
-    -> bool
+auto PluginManager::register_plugin(std::unique_ptr<IPlugin> plugin,
+                                    ExtensionManifest ext_manifest,
+                                    std::filesystem::path install_dir) -> bool
 {
     if (!plugin)
     {
@@ -86,7 +105,8 @@ auto PluginManager::register_plugin(std::unique_ptr<IPlugin> plugin, ExtensionMa
                      ext_manifest.version,
                      ext_manifest.publisher);
 
-    plugins_.push_back(PluginEntry{std::move(plugin), {}, std::move(ext_manifest)});
+    plugins_.push_back(
+        PluginEntry{std::move(plugin), {}, std::move(ext_manifest), std::move(install_dir)});
     return true;
 }
 
@@ -214,6 +234,7 @@ auto PluginManager::activate_plugin(const std::string& plugin_id) -> bool
 
     // Create plugin context with full service injection
     PluginContext ctx;
+    ctx.extension_path = entry_it->install_dir.string();
     ctx.event_bus = &event_bus_;
     ctx.config = &config_;
     ctx.register_command_handler =
@@ -588,10 +609,7 @@ void PluginManager::process_contributions(PluginEntry& entry)
         {
             if (!theme.path.empty())
             {
-                // Use the theme path directly — if relative, it should be relative
-                // to the extension's install directory. The scanner resolves paths
-                // when populating the manifest.
-                const std::filesystem::path theme_path{theme.path};
+                const auto theme_path = resolve_contribution_path(entry.install_dir, theme.path);
 
                 if (std::filesystem::exists(theme_path))
                 {
@@ -670,12 +688,45 @@ void PluginManager::process_contributions(PluginEntry& entry)
         MARKAMP_LOG_DEBUG("Registered contributed language: {}", lang.language_id);
     }
 
-    // Grammars → store in contribution registry
+    // Grammars → store in contribution registry and compile via GrammarEngine
     for (const auto& grammar : ext_contrib.grammars)
     {
         contributions_.grammars.push_back(grammar);
         MARKAMP_LOG_DEBUG(
             "Registered contributed grammar: {} ({})", grammar.scope_name, grammar.language);
+
+        if (ext_services_.grammar_engine == nullptr || grammar.path.empty())
+        {
+            continue;
+        }
+        const auto grammar_path = resolve_contribution_path(entry.install_dir, grammar.path);
+        if (!std::filesystem::exists(grammar_path))
+        {
+            MARKAMP_LOG_WARN("Extension grammar path does not exist: {}", grammar_path.string());
+        }
+        else if (!ext_services_.grammar_engine->load_grammar(grammar_path.string()))
+        {
+            MARKAMP_LOG_WARN("Failed to load extension grammar '{}': {}",
+                             grammar.scope_name,
+                             grammar_path.string());
+        }
+        else if (!grammar.language.empty())
+        {
+            // Fenced code blocks name their language by ID or by alias
+            auto* engine = ext_services_.grammar_engine;
+            engine->set_language_scope(grammar.language, grammar.scope_name);
+            for (const auto& lang : contributions_.languages)
+            {
+                if (lang.language_id != grammar.language)
+                {
+                    continue;
+                }
+                for (const auto& alias : lang.aliases)
+                {
+                    engine->set_language_scope(alias, grammar.scope_name);
+                }
+            }
+        }
     }
 
     // Custom editors → store in contribution registry
@@ -3,6 +3,7 @@
 #include "ExtensionManifest.h"
 #include "IPlugin.h"
 
+#include <filesystem>
 #include <functional>
 #include <memory>
 #include <string>
@@ -79,8 +80,12 @@ public:
     auto register_plugin(std::unique_ptr<IPlugin> plugin) -> bool;
 
     /// Register a plugin with an associated ExtensionManifest for
-    /// lazy activation and dependency resolution.
-    auto register_plugin(std::unique_ptr<IPlugin> plugin, ExtensionManifest ext_manifest) -> bool;
+    /// lazy activation and dependency resolution. `install_dir` is the
+    /// directory the extension lives in; relative contribution paths
+    /// (grammars, themes) in the manifest are resolved against it.
+    auto register_plugin(std::unique_ptr<IPlugin> plugin,
+                         ExtensionManifest ext_manifest,
+                         std::filesystem::path install_dir = {}) -> bool;
 
     /// Unregister a plugin by ID. Deactivates it first if active.
     void unregister_plugin(const std::string& plugin_id);
@@ -273,6 +278,7 @@ private:
         std::unique_ptr<IPlugin> plugin;
         std::unordered_map<std::string, std::function<void()>> command_handlers;
         std::optional<ExtensionManifest> ext_manifest; // Phase 4: optional manifest
+        std::filesystem::path install_dir;             // Empty for built-in plugins
     };
 
     std::vector<PluginEntry> plugins_;
@@ -0,0 +1,455 @@
+#include "SearchPattern.h"
+
+#include "IncrementalSearcher.h"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define MARKAMP_SEARCH_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define MARKAMP_SEARCH_AVX2 1
+#endif
+#endif
+
+namespace markamp::core
+{
+
+namespace
+{
+
+[[nodiscard]] auto fold(char character) -> char
+{
+    return (character >= 'A' && character <= 'Z') ? static_cast<char>(character - 'A' + 'a')
+                                                   : character;
+}
+
+[[nodiscard]] auto upper(char character) -> char
+{
+    return (character >= 'a' && character <= 'z') ? static_cast<char>(character - 'a' + 'A')
+                                                   : character;
+}
+
+[[nodiscard]] auto is_word_byte(char character) -> bool
+{
+    return std::isalnum(static_cast<unsigned char>(character)) != 0;
+}
+
+/// A literal needle and the two bytes (both cases) the vector filter tests.
+struct LiteralFilter
+{
+    std::string_view needle; // Folded unless case_sensitive
+    bool case_sensitive{true};
+    char first_lower{0};
+    char first_upper{0};
+    char last_lower{0};
+    char last_upper{0};
+};
+
+[[nodiscard]] auto make_filter(std::string_view needle, bool case_sensitive) -> LiteralFilter
+{
+    LiteralFilter filter{needle, case_sensitive, needle.front(), needle.front(), needle.back(),
+                         needle.back()};
+    if (!case_sensitive)
+    {
+        filter.first_upper = upper(needle.front());
+        filter.last_upper = upper(needle.back());
+    }
+    return filter;
+}
+
+[[nodiscard]] auto equals_at(const char* at, const LiteralFilter& filter) -> bool
+{
+    if (filter.case_sensitive)
+    {
+        return std::memcmp(at, filter.needle.data(), filter.needle.size()) == 0;
+    }
+    for (std::size_t index = 0; index < filter.needle.size(); ++index)
+    {
+        if (fold(at[index]) != filter.needle[index])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// First match at or after `pos` starting no later than `last_start`.
+[[nodiscard]] auto find_scalar(const char* data,
+                               std::size_t pos,
+                               std::size_t last_start,
+                               const LiteralFilter& filter) -> std::size_t
+{
+    if (filter.case_sensitive)
+    {
+        // memchr is vectorized by the C library on every platform we ship
+        while (pos <= last_start)
+        {
+            const auto* found = static_cast<const char*>(
+                std::memchr(data + pos, filter.first_lower, last_start - pos + 1));
+            if (found == nullptr)
+            {
+                return SearchPattern::npos;
+            }
+            pos = static_cast<std::size_t>(found - data);
+            if (equals_at(found, filter))
+            {
+                return pos;
+            }
+            ++pos;
+        }
+        return SearchPattern::npos;
+    }
+    for (; pos <= last_start; ++pos)
+    {
+        if ((data[pos] == filter.first_lower || data[pos] == filter.first_upper) &&
+            equals_at(data + pos, filter))
+        {
+            return pos;
+        }
+    }
+    return SearchPattern::npos;
+}
+
+#if defined(MARKAMP_SEARCH_SSE2)
+
+/// 16 candidate positions per step: a position survives if its byte
+/// matches the needle's first byte and the byte needle.size() - 1 further
+/// matches the last one.
+[[nodiscard]] auto find_sse2(const char* data,
+                             std::size_t pos,
+                             std::size_t last_start,
+                             const LiteralFilter& filter) -> std::size_t
+{
+    constexpr std::size_t kWidth = 16;
+    const std::size_t last_offset = filter.needle.size() - 1;
+    const __m128i first_lower = _mm_set1_epi8(filter.first_lower);
+    const __m128i first_upper = _mm_set1_epi8(filter.first_upper);
+    const __m128i last_lower = _mm_set1_epi8(filter.last_lower);
+    const __m128i last_upper = _mm_set1_epi8(filter.last_upper);
+    for (; pos + kWidth <= last_start + 1; pos += kWidth)
+    {
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        const __m128i tail =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + last_offset));
+        const __m128i first =
+            _mm_or_si128(_mm_cmpeq_epi8(head, first_lower), _mm_cmpeq_epi8(head, first_upper));
+        const __m128i last =
+            _mm_or_si128(_mm_cmpeq_epi8(tail, last_lower), _mm_cmpeq_epi8(tail, last_upper));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(first, last)));
+        while (mask != 0)
+        {
+            const auto candidate = pos + static_cast<std::size_t>(std::countr_zero(mask));
+            if (equals_at(data + candidate, filter))
+            {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return find_scalar(data, pos, last_start, filter);
+}
+
+#endif
+
+#if defined(MARKAMP_SEARCH_AVX2)
+
+/// find_sse2() with 32 positions per step; only called when the CPU
+/// reports AVX2.
+[[nodiscard]] __attribute__((target("avx2"))) auto find_avx2(const char* data,
+                                                             std::size_t pos,
+                                                             std::size_t last_start,
+                                                             const LiteralFilter& filter)
+    -> std::size_t
+{
+    constexpr std::size_t kWidth = 32;
+    const std::size_t last_offset = filter.needle.size() - 1;
+    const __m256i first_lower = _mm256_set1_epi8(filter.first_lower);
+    const __m256i first_upper = _mm256_set1_epi8(filter.first_upper);
+    const __m256i last_lower = _mm256_set1_epi8(filter.last_lower);
+    const __m256i last_upper = _mm256_set1_epi8(filter.last_upper);
+    for (; pos + kWidth <= last_start + 1; pos += kWidth)
+    {
+        const __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        const __m256i tail =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos + last_offset));
+        const __m256i first = _mm256_or_si256(_mm256_cmpeq_epi8(head, first_lower),
+                                              _mm256_cmpeq_epi8(head, first_upper));
+        const __m256i last = _mm256_or_si256(_mm256_cmpeq_epi8(tail, last_lower),
+                                             _mm256_cmpeq_epi8(tail, last_upper));
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(first, last)));
+        while (mask != 0)
+        {
+            const auto candidate = pos + static_cast<std::size_t>(std::countr_zero(mask));
+            if (equals_at(data + candidate, filter))
+            {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return find_scalar(data, pos, last_start, filter);
+}
+
+[[nodiscard]] auto cpu_has_avx2() -> bool
+{
+    static const bool supported = __builtin_cpu_supports("avx2") != 0;
+    return supported;
+}
+
+#endif
+
+#if defined(MARKAMP_SEARCH_SSE2)
+
+/// '\n' count of [begin, end) in 16-byte blocks: per-lane byte counters
+/// are flushed into 64-bit sums before they can wrap.
+[[nodiscard]] auto count_newlines_sse2(const char* begin, const char* end) -> std::size_t
+{
+    constexpr std::ptrdiff_t kWidth = 16;
+    constexpr int kMaxBlocksPerFlush = 255;
+    const __m128i newline = _mm_set1_epi8('\n');
+    std::size_t count = 0;
+    while (end - begin >= kWidth)
+    {
+        __m128i lanes = _mm_setzero_si128();
+        for (int block = 0; block < kMaxBlocksPerFlush && end - begin >= kWidth;
+             ++block, begin += kWidth)
+        {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            lanes = _mm_sub_epi8(lanes, _mm_cmpeq_epi8(bytes, newline)); // cmpeq yields -1
+        }
+        const __m128i sums = _mm_sad_epu8(lanes, _mm_setzero_si128());
+        count += static_cast<std::size_t>(_mm_cvtsi128_si64(sums)) +
+                 static_cast<std::size_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums)));
+    }
+    return count + static_cast<std::size_t>(std::count(begin, end, '\n'));
+}
+
+#endif
+
+#if defined(MARKAMP_SEARCH_AVX2)
+
+/// count_newlines_sse2() in 32-byte blocks.
+[[nodiscard]] __attribute__((target("avx2"))) auto count_newlines_avx2(const char* begin,
+                                                                       const char* end)
+    -> std::size_t
+{
+    constexpr std::ptrdiff_t kWidth = 32;
+    constexpr int kMaxBlocksPerFlush = 255;
+    const __m256i newline = _mm256_set1_epi8('\n');
+    std::size_t count = 0;
+    while (end - begin >= kWidth)
+    {
+        __m256i lanes = _mm256_setzero_si256();
+        for (int block = 0; block < kMaxBlocksPerFlush && end - begin >= kWidth;
+             ++block, begin += kWidth)
+        {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+            lanes = _mm256_sub_epi8(lanes, _mm256_cmpeq_epi8(bytes, newline));
+        }
+        const __m256i sums = _mm256_sad_epu8(lanes, _mm256_setzero_si256());
+        count += static_cast<std::size_t>(_mm256_extract_epi64(sums, 0)) +
+                 static_cast<std::size_t>(_mm256_extract_epi64(sums, 1)) +
+                 static_cast<std::size_t>(_mm256_extract_epi64(sums, 2)) +
+                 static_cast<std::size_t>(_mm256_extract_epi64(sums, 3));
+    }
+    return count + static_cast<std::size_t>(std::count(begin, end, '\n'));
+}
+
+#endif
+
+/// Number of '\n' bytes in [begin, end).
+[[nodiscard]] auto count_newlines(const char* begin, const char* end) -> std::size_t
+{
+#if defined(MARKAMP_SEARCH_AVX2)
+    if (cpu_has_avx2())
+    {
+        return count_newlines_avx2(begin, end);
+    }
+#endif
+#if defined(MARKAMP_SEARCH_SSE2)
+    return count_newlines_sse2(begin, end);
+#else
+    return static_cast<std::size_t>(std::count(begin, end, '\n'));
+#endif
+}
+
+} // anonymous namespace
+
+auto SearchPattern::compile(const SearchConfig& config)
+    -> std::expected<SearchPattern, std::string>
+{
+    SearchPattern pattern;
+    pattern.case_sensitive_ = config.case_sensitive;
+    pattern.whole_word_ = config.whole_word;
+    if (config.use_regex && !config.needle.empty())
+    {
+        auto flags = std::regex::ECMAScript | std::regex::optimize;
+        if (!config.case_sensitive)
+        {
+            flags |= std::regex::icase;
+        }
+        try
+        {
+            pattern.regex_ = std::make_shared<const std::regex>(config.needle, flags);
+        }
+        catch (const std::regex_error& error)
+        {
+            return std::unexpected(std::string("Invalid regular expression: ") + error.what());
+        }
+        return pattern;
+    }
+    pattern.needle_ = config.needle;
+    if (!config.case_sensitive)
+    {
+        std::transform(
+            pattern.needle_.begin(), pattern.needle_.end(), pattern.needle_.begin(), fold);
+    }
+    return pattern;
+}
+
+auto SearchPattern::empty() const noexcept -> bool
+{
+    return regex_ == nullptr && needle_.empty();
+}
+
+auto SearchPattern::spans_lines() const noexcept -> bool
+{
+    return regex_ == nullptr && needle_.find('\n') != std::string::npos;
+}
+
+auto SearchPattern::find(std::string_view text, std::size_t from) const -> SearchHit
+{
+    if (regex_ != nullptr)
+    {
+        return find_regex(text, from);
+    }
+    while (true)
+    {
+        const auto offset = find_literal(text, from);
+        if (offset == npos)
+        {
+            return {npos};
+        }
+        const auto after = offset + needle_.size();
+        if (!whole_word_ || ((offset == 0 || !is_word_byte(text[offset - 1])) &&
+                             (after >= text.size() || !is_word_byte(text[after]))))
+        {
+            return {offset, needle_.size()};
+        }
+        from = offset + 1;
+    }
+}
+
+auto SearchPattern::find_literal(std::string_view text, std::size_t from) const -> std::size_t
+{
+    if (needle_.empty() || text.size() < needle_.size() || from > text.size() - needle_.size())
+    {
+        return npos;
+    }
+    const auto filter = make_filter(needle_, case_sensitive_);
+    const std::size_t last_start = text.size() - needle_.size();
+#if defined(MARKAMP_SEARCH_AVX2)
+    if (cpu_has_avx2())
+    {
+        return find_avx2(text.data(), from, last_start, filter);
+    }
+#endif
+#if defined(MARKAMP_SEARCH_SSE2)
+    return find_sse2(text.data(), from, last_start, filter);
+#else
+    return find_scalar(text.data(), from, last_start, filter);
+#endif
+}
+
+auto SearchPattern::find_regex(std::string_view text, std::size_t from) const -> SearchHit
+{
+    if (from > text.size())
+    {
+        return {npos};
+    }
+    std::size_t line_start = 0;
+    if (from > 0)
+    {
+        const auto newline = text.rfind('\n', from - 1);
+        line_start = newline == npos ? 0 : newline + 1;
+    }
+    while (true)
+    {
+        auto line_end = text.find('\n', from);
+        if (line_end == npos)
+        {
+            line_end = text.size();
+        }
+
+        // Past the line start, the previous byte is real context for \b
+        // and `^` must not match
+        auto flags = std::regex_constants::match_not_null;
+        if (from > line_start)
+        {
+            flags |= std::regex_constants::match_prev_avail;
+        }
+        std::cmatch match;
+        if (std::regex_search(text.data() + from, text.data() + line_end, match, *regex_, flags))
+        {
+            const auto offset = from + static_cast<std::size_t>(match.position(0));
+            const auto length = static_cast<std::size_t>(match.length(0));
+            const auto after = offset + length;
+            if (!whole_word_ || ((offset == 0 || !is_word_byte(text[offset - 1])) &&
+                                 (after >= text.size() || !is_word_byte(text[after]))))
+            {
+                return {offset, length};
+            }
+            from = offset + 1;
+            continue;
+        }
+        if (line_end == text.size())
+        {
+            return {npos};
+        }
+        line_start = line_end + 1;
+        from = line_start;
+    }
+}
+
+auto SearchPattern::find_all(std::string_view text, std::vector<SearchHit>& hits) const
+    -> std::size_t
+{
+    std::size_t line = 0;
+    std::size_t line_start = 0;
+    std::size_t line_end = 0;
+    std::size_t scanned = 0; // Newlines before this offset are counted
+    if (!empty())
+    {
+        for (auto hit = find(text, 0); hit.offset != npos;
+             hit = find(text, regex_ != nullptr ? hit.offset + hit.length : hit.offset + 1))
+        {
+            const auto newlines = count_newlines(text.data() + scanned, text.data() + hit.offset);
+            if (newlines > 0)
+            {
+                line += newlines;
+                line_start = text.rfind('\n', hit.offset - 1) + 1;
+            }
+            scanned = hit.offset;
+            if (hit.offset >= line_end)
+            {
+                line_end = text.find('\n', hit.offset);
+                if (line_end == npos)
+                {
+                    line_end = text.size();
+                }
+            }
+            hit.line = line;
+            hit.line_start = line_start;
+            hit.line_end = line_end;
+            hits.push_back(hit);
+        }
+    }
+    return line + count_newlines(text.data() + scanned, text.data() + text.size());
+}
+
+} // namespace markamp::core
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace markamp::core
+{
+
+struct SearchConfig;
+
+/// One match found by SearchPattern, located within its line.
+struct SearchHit
+{
+    std::size_t offset{0};     // Byte offset of the match in the scanned text
+    std::size_t length{0};     // Match length in bytes
+    std::size_t line{0};       // 0-indexed line number within the scanned text
+    std::size_t line_start{0}; // Offset of the first byte of that line
+    std::size_t line_end{0};   // Offset of the line's '\n' (or the text size)
+};
+
+/// A SearchConfig compiled for scanning text.
+///
+/// Literal needles are located with a vectorized first-byte / last-byte
+/// filter (AVX2 when the CPU has it, SSE2 otherwise on x86-64, memchr or a
+/// plain loop elsewhere) and only the surviving positions are compared in
+/// full. Literal matches may overlap. Case-insensitive matching folds ASCII
+/// only. Regex needles use ECMAScript syntax and are matched one line at a
+/// time, so a regex match never spans lines and `^` / `$` anchor at line
+/// boundaries; empty regex matches are skipped. Whole-word mode rejects
+/// matches touching an alphanumeric byte on either side.
+///
+/// Immutable once compiled; copies share the compiled regex and may scan
+/// concurrently.
+class SearchPattern
+{
+public:
+    /// Compile `config`. Fails only for an invalid regex. An empty needle
+    /// compiles to a pattern that never matches.
+    [[nodiscard]] static auto compile(const SearchConfig& config)
+        -> std::expected<SearchPattern, std::string>;
+
+    /// True if the pattern can never match.
+    [[nodiscard]] auto empty() const noexcept -> bool;
+
+    /// True if a match may contain a newline (a literal needle with '\n').
+    /// Such patterns cannot be searched in line-aligned pieces.
+    [[nodiscard]] auto spans_lines() const noexcept -> bool;
+
+    /// First match starting at or after `from` (offset npos if none). Only
+    /// `offset` and `length` are set.
+    [[nodiscard]] auto find(std::string_view text, std::size_t from) const -> SearchHit;
+
+    /// Append every match in `text` to `hits`, in order, with line
+    /// positions relative to the start of `text`. Returns the number of
+    /// newlines in `text`.
+    auto find_all(std::string_view text, std::vector<SearchHit>& hits) const -> std::size_t;
+
+    static constexpr std::size_t npos = std::string_view::npos;
+
+private:
+    SearchPattern() = default;
+
+    std::string needle_; // Folded when !case_sensitive_
+    bool case_sensitive_{true};
+    bool whole_word_{false};
+    std::shared_ptr<const std::regex> regex_;
+
+    [[nodiscard]] auto find_literal(std::string_view text, std::size_t from) const -> std::size_t;
+    [[nodiscard]] auto find_regex(std::string_view text, std::size_t from) const -> SearchHit;
+};
+
+} // namespace markamp::core
@@ -0,0 +1,136 @@
+#include "StartupTimeline.h"
+
+#include "Profiler.h"
+
+#include <fmt/format.h>
+
+namespace markamp::core
+{
+
+StartupTimeline::StartupTimeline()
+    : origin_(Clock::now())
+{
+}
+
+// ═══════════════════════════════════════════════════════
+// Scope
+// ═══════════════════════════════════════════════════════
+
+StartupTimeline::Scope::Scope(StartupTimeline& timeline, std::string name, StartupPhase phase)
+    : timeline_(timeline)
+    , name_(std::move(name))
+    , phase_(phase)
+    , start_(Clock::now())
+{
+}
+
+StartupTimeline::Scope::~Scope()
+{
+    timeline_.record(std::move(name_), phase_, start_);
+}
+
+auto StartupTimeline::measure(std::string name, StartupPhase phase) -> Scope
+{
+    return Scope(*this, std::move(name), phase);
+}
+
+// ═══════════════════════════════════════════════════════
+// Recording
+// ═══════════════════════════════════════════════════════
+
+void StartupTimeline::record(std::string name, StartupPhase phase, Clock::time_point start)
+{
+    const auto end = Clock::now();
+    StartupStage stage;
+    stage.phase = phase;
+    stage.start_ms = since_origin_ms(start);
+    stage.duration_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    Profiler::instance().record("startup." + name, stage.duration_ms);
+    stage.name = std::move(name);
+
+    const std::lock_guard lock(mutex_);
+    stages_.push_back(std::move(stage));
+}
+
+void StartupTimeline::mark_first_paint()
+{
+    const auto now_ms = since_origin_ms(Clock::now());
+    const std::lock_guard lock(mutex_);
+    if (!first_paint_ms_)
+    {
+        first_paint_ms_ = now_ms;
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// Queries
+// ═══════════════════════════════════════════════════════
+
+auto StartupTimeline::time_to_first_paint_ms() const -> std::optional<double>
+{
+    const std::lock_guard lock(mutex_);
+    return first_paint_ms_;
+}
+
+auto StartupTimeline::critical_path_ms() const -> double
+{
+    const std::lock_guard lock(mutex_);
+    double total = 0.0;
+    for (const auto& stage : stages_)
+    {
+        if (stage.phase == StartupPhase::Critical)
+        {
+            total += stage.duration_ms;
+        }
+    }
+    return total;
+}
+
+auto StartupTimeline::stages() const -> std::vector<StartupStage>
+{
+    const std::lock_guard lock(mutex_);
+    return stages_;
+}
+
+auto StartupTimeline::report() const -> std::string
+{
+    const auto recorded = stages();
+    std::string text = "Startup timeline:\n";
+    for (const auto& stage : recorded)
+    {
+        text += fmt::format("  {:>8.2f} ms  +{:>7.2f} ms  {:<10}  {}\n",
+                            stage.start_ms,
+                            stage.duration_ms,
+                            phase_name(stage.phase),
+                            stage.name);
+    }
+    text += fmt::format("  critical path {:.2f} ms (budget {:.0f} ms)",
+                        critical_path_ms(),
+                        kCriticalPathBudgetMs);
+    if (const auto first_paint = time_to_first_paint_ms())
+    {
+        text += fmt::format(", first paint at {:.2f} ms", *first_paint);
+    }
+    return text;
+}
+
+auto StartupTimeline::phase_name(StartupPhase phase) -> std::string_view
+{
+    switch (phase)
+    {
+        case StartupPhase::Critical:
+            return "critical";
+        case StartupPhase::Background:
+            return "background";
+        case StartupPhase::Deferred:
+            return "deferred";
+    }
+    return "unknown";
+}
+
+auto StartupTimeline::since_origin_ms(Clock::time_point when) const -> double
+{
+    return std::chrono::duration<double, std::milli>(when - origin_).count();
+}
+
+} // namespace markamp::core
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace markamp::core
+{
+
+// ═══════════════════════════════════════════════════════
+// Startup timeline
+// ═══════════════════════════════════════════════════════
+
+/// Where a startup stage runs relative to the first frame.
+enum class StartupPhase
+{
+    Critical,   // Before the main frame is shown
+    Background, // On the deferred startup thread
+    Deferred    // Back on the UI thread, after first paint
+};
+
+/// One timed startup stage. Times are milliseconds since the timeline origin.
+struct StartupStage
+{
+    std::string name;
+    StartupPhase phase{StartupPhase::Critical};
+    double start_ms{0.0};
+    double duration_ms{0.0};
+};
+
+/// Records how long each startup stage takes and when the first frame is
+/// painted. Stages are also recorded in the Profiler as "startup.<name>".
+/// Safe to use from the UI thread and the deferred startup thread.
+///
+/// Pattern implemented: #19 Instrumentation and performance budgets
+class StartupTimeline
+{
+public:
+    /// Time from process start to the first painted frame that the critical
+    /// path (everything before the main frame is shown) may take.
+    static constexpr double kCriticalPathBudgetMs = 250.0;
+
+    using Clock = std::chrono::steady_clock;
+
+    StartupTimeline();
+
+    /// RAII stage timer returned by measure().
+    class Scope
+    {
+    public:
+        Scope(StartupTimeline& timeline, std::string name, StartupPhase phase);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        auto operator=(const Scope&) -> Scope& = delete;
+        Scope(Scope&&) = delete;
+        auto operator=(Scope&&) -> Scope& = delete;
+
+    private:
+        StartupTimeline& timeline_;
+        std::string name_;
+        StartupPhase phase_;
+        Clock::time_point start_;
+    };
+
+    /// Time the enclosing block as one stage.
+    [[nodiscard]] auto measure(std::string name, StartupPhase phase = StartupPhase::Critical)
+        -> Scope;
+
+    /// Record a stage that ran from `start` to now.
+    void record(std::string name, StartupPhase phase, Clock::time_point start);
+
+    /// Mark the first painted frame. Only the first call counts.
+    void mark_first_paint();
+
+    /// Milliseconds from the origin to the first paint, once marked.
+    [[nodiscard]] auto time_to_first_paint_ms() const -> std::optional<double>;
+
+    /// Total duration of the Critical stages.
+    [[nodiscard]] auto critical_path_ms() const -> double;
+
+    /// Every recorded stage, in the order they finished.
+    [[nodiscard]] auto stages() const -> std::vector<StartupStage>;
+
+    /// Multi-line summary: one line per stage, then the totals.
+    [[nodiscard]] auto report() const -> std::string;
+
+    [[nodiscard]] static auto phase_name(StartupPhase phase) -> std::string_view;
+
+private:
+    Clock::time_point origin_;
+
+    mutable std::mutex mutex_;
+    std::vector<StartupStage> stages_;     // GUARDED_BY(mutex_)
+    std::optional<double> first_paint_ms_; // GUARDED_BY(mutex_)
+
+    [[nodiscard]] auto since_origin_ms(Clock::time_point when) const -> double;
+};
+
+} // namespace markamp::core
@@ -1,42 +1,72 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <string_view>
 
 namespace markamp::core
 {
 
-/// Shared HTML escape utility — replaces &, <, >, ", ' with HTML entities.
-/// Used by HtmlRenderer, CodeBlockRenderer, MermaidBlockRenderer, SyntaxHighlighter.
-[[nodiscard]] inline auto escape_html(std::string_view text) -> std::string
+/// Append `text` to `output` with &, <, >, ", ' replaced by HTML entities.
+/// Runs without special characters are copied in one append, so escaping
+/// into a buffer with enough capacity does not allocate.
+inline void append_escaped_html(std::string& output, std::string_view text)
 {
-    std::string result;
-    result.reserve(text.size());
-    for (const char character : text)
+    std::size_t run_start = 0;
+    for (std::size_t index = 0; index < text.size(); ++index)
     {
-        switch (character)
+        std::string_view entity;
+        switch (text[index])
         {
             case '&':
-                result += "&amp;";
+                entity = "&amp;";
                 break;
             case '<':
-                result += "&lt;";
+                entity = "&lt;";
                 break;
             case '>':
-                result += "&gt;";
+                entity = "&gt;";
                 break;
             case '"':
-                result += "&quot;";
+                entity = "&quot;";
                 break;
             case '\'':
-                result += "&#39;";
+                entity = "&#39;";
                 break;
             default:
-                result += character;
-                break;
+                continue;
         }
+        output.append(text.substr(run_start, index - run_start));
+        output.append(entity);
+        run_start = index + 1;
     }
+    output.append(text.substr(run_start));
+}
+
+/// Shared HTML escape utility — replaces &, <, >, ", ' with HTML entities.
+/// Used by HtmlRenderer, CodeBlockRenderer, MermaidBlockRenderer, SyntaxHighlighter.
+[[nodiscard]] inline auto escape_html(std::string_view text) -> std::string
+{
+    std::string result;
+    result.reserve(text.size());
+    append_escaped_html(result, text);
     return result;
 }
 
+/// FNV-1a hash of `text`, continuing from `hash`. Stable across runs and
+/// platforms, so it can name on-disk cache files that survive restarts.
+[[nodiscard]] constexpr auto fnv1a_64(std::string_view text,
+                                      std::uint64_t hash = 14695981039346656037ULL) noexcept
+    -> std::uint64_t
+{
+    constexpr std::uint64_t kPrime = 1099511628211ULL;
+    for (const auto byte : text)
+    {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= kPrime;
+    }
+    return hash;
+}
+
 } // namespace markamp::core
@@ -30,58 +30,90 @@ void SyntaxHighlighter::register_language(LanguageDefinition def)
         alias_map_[alias] = name;
     }
     alias_map_[name] = name; // Self-alias
-    languages_.emplace(std::move(name), std::move(def));
+
+    CompiledLanguage lang;
+    lang.def = std::move(def);
+    lang.words = KeywordTable(lang.def);
+    for (const char delim : lang.def.string_delimiters)
+    {
+        lang.string_delimiter[static_cast<unsigned char>(delim)] = true;
+    }
+    languages_.emplace(std::move(name), std::move(lang));
 }
 
 auto SyntaxHighlighter::tokenize(std::string_view source, const std::string& language)
     -> std::vector<Token>
 {
-    const auto* def = resolve_language(language);
-    if (def == nullptr)
+    const auto soa = tokenize_soa(source, language);
+    std::vector<Token> tokens;
+    tokens.reserve(soa.size());
+    for (size_t i = 0; i < soa.size(); ++i)
     {
-        // Unsupported language: return entire source as single Text token
-        return {{TokenType::Text, std::string(source), 0, source.size()}};
+        tokens.push_back(
+            {soa.types[i], std::string(soa.text(i, source)), soa.starts[i], soa.lengths[i]});
     }
-    return tokenize_with_def(source, *def);
+    return tokens;
 }
 
 auto SyntaxHighlighter::tokenize_soa(std::string_view source, const std::string& language)
     -> TokenArraySoA
 {
-    auto tokens = tokenize(source, language);
     TokenArraySoA soa;
-    soa.reserve(tokens.size());
-    for (const auto& tok : tokens)
+    tokenize_soa(source, language, soa);
+    return soa;
+}
+
+void SyntaxHighlighter::tokenize_soa(std::string_view source,
+                                     const std::string& language,
+                                     TokenArraySoA& out)
+{
+    out.clear();
+    const auto* lang = resolve_language(language);
+    if (lang == nullptr)
     {
-        soa.push_back(tok.type, tok.start, tok.length);
+        // Unsupported language: entire source as a single Text token
+        if (!source.empty())
+        {
+            out.push_back(TokenType::Text, 0, source.size());
+        }
+        return;
     }
-    return soa;
+    tokenize_into(source, *lang, out);
 }
 
 auto SyntaxHighlighter::render_html(std::string_view source, const std::string& language)
     -> std::string
 {
     MARKAMP_PROFILE_SCOPE("SyntaxHighlighter::render_html");
-    auto tokens = tokenize(source, language);
+    TokenArraySoA tokens;
     std::string html;
     html.reserve(source.size() * 2);
+    render_html_into(source, language, html, tokens);
+    return html;
+}
 
-    for (const auto& tok : tokens)
+void SyntaxHighlighter::render_html_into(std::string_view source,
+                                         const std::string& language,
+                                         std::string& output,
+                                         TokenArraySoA& tokens)
+{
+    tokenize_soa(source, language, tokens);
+    for (size_t i = 0; i < tokens.size(); ++i)
     {
-        if (tok.type == TokenType::Whitespace || tok.type == TokenType::Text)
+        const auto type = tokens.types[i];
+        if (type == TokenType::Whitespace || type == TokenType::Text)
         {
-            html += escape_html(tok.text);
+            append_escaped_html(output, tokens.text(i, source));
         }
         else
         {
-            html += "<span class=\"token-";
-            html += token_class(tok.type);
-            html += "\">";
-            html += escape_html(tok.text);
-            html += "</span>";
+            output += "<span class=\"token-";
+            output += token_class(type);
+            output += "\">";
+            append_escaped_html(output, tokens.text(i, source));
+            output += "</span>";
         }
     }
-    return html;
 }
 
 auto SyntaxHighlighter::is_supported(const std::string& language) const -> bool
@@ -89,6 +121,13 @@ auto SyntaxHighlighter::is_supported(const std::string& language) const -> bool
     return resolve_language(language) != nullptr;
 }
 
+auto SyntaxHighlighter::language_definition(const std::string& language) const
+    -> const LanguageDefinition*
+{
+    const auto* lang = resolve_language(language);
+    return lang != nullptr ? &lang->def : nullptr;
+}
+
 auto SyntaxHighlighter::supported_languages() const -> std::vector<std::string>
 {
     std::vector<std::string> names;
@@ -145,7 +184,7 @@ auto SyntaxHighlighter::token_class(TokenType type) -> std::string_view
 // ═══════════════════════════════════════════════════════
 
 auto SyntaxHighlighter::resolve_language(const std::string& name_or_alias) const
-    -> const LanguageDefinition*
+    -> const CompiledLanguage*
 {
     // Try direct lookup
     auto alias_it = alias_map_.find(name_or_alias);
@@ -176,11 +215,12 @@ auto SyntaxHighlighter::resolve_language(const std::string& name_or_alias) const
 // Private: tokenizer
 // ═══════════════════════════════════════════════════════
 
-auto SyntaxHighlighter::tokenize_with_def(std::string_view source, const LanguageDefinition& def)
-    -> std::vector<Token>
+void SyntaxHighlighter::tokenize_into(std::string_view source,
+                                      const CompiledLanguage& lang,
+                                      TokenArraySoA& out) const
 {
-    std::vector<Token> tokens;
-    tokens.reserve(source.size() / 4); // Rough estimate
+    const auto& def = lang.def;
+    out.reserve(out.size() + source.size() / 4); // Rough estimate
 
     size_t pos = 0;
     const size_t len = source.size();
@@ -200,10 +240,7 @@ auto SyntaxHighlighter::tokenize_with_def(std::string_view source, const Languag
             {
                 pos += def.block_comment_end.size();
             }
-            tokens.push_back({TokenType::Comment,
-                              std::string(source.substr(start, pos - start)),
-                              start,
-                              pos - start});
+            out.push_back(TokenType::Comment, start, pos - start);
             continue;
         }
 
@@ -215,10 +252,7 @@ auto SyntaxHighlighter::tokenize_with_def(std::string_view source, const Languag
             {
                 ++pos;
             }
-            tokens.push_back({TokenType::Comment,
-                              std::string(source.substr(start, pos - start)),
-                              start,
-                              pos - start});
+            out.push_back(TokenType::Comment, start, pos - start);
             continue;
         }
 
@@ -226,7 +260,7 @@ auto SyntaxHighlighter::tokenize_with_def(std::string_view source, const Languag
         // Handled by the line_comment check above for bash/python
 
         // 3. String literal
-        if (def.string_delimiters.find(source[pos]) != std::string::npos)
+        if (lang.string_delimiter[static_cast<unsigned char>(source[pos])])
         {
             char delim = source[pos];
             size_t start = pos;
@@ -267,10 +301,7 @@ auto SyntaxHighlighter::tokenize_with_def(std::string_view source, const Languag
                 }
                 ++pos;
             }
-            tokens.push_back({TokenType::String,
-                              std::string(source.substr(start, pos - start)),
-                              start,
-                              pos - start});
+            out.push_back(TokenType::String, start, pos - start);
             continue;
         }
 
@@ -293,10 +324,7 @@ auto SyntaxHighlighter::tokenize_with_def(std::string_view source, const Languag
                 }
                 ++pos;
             }
-            tokens.push_back({TokenType::String,
-                              std::string(source.substr(start, pos - start)),
-                              start,
-                              pos - start});
+            out.push_back(TokenType::String, start, pos - start);
             continue;
         }
 
@@ -311,10 +339,7 @@ auto SyntaxHighlighter::tokenize_with_def(std::string_view source, const Languag
                 {
                     ++pos;
                 }
-                tokens.push_back({TokenType::Preprocessor,
-                                  std::string(source.substr(start, pos - start)),
-                                  start,
-                                  pos - start});
+                out.push_back(TokenType::Preprocessor, start, pos - start);
                 continue;
             }
         }
@@ -349,10 +374,7 @@ auto SyntaxHighlighter::tokenize_with_def(std::string_view source, const Languag
             {
                 ++pos;
             }
-            tokens.push_back({TokenType::Number,
-                              std::string(source.substr(start, pos - start)),
-                              start,
-                              pos - start});
+            out.push_back(TokenType::Number, start, pos - start);
             continue;
         }
 
@@ -370,10 +392,7 @@ auto SyntaxHighlighter::tokenize_with_def(std::string_view source, const Languag
                 {
                     ++pos;
                 }
-                tokens.push_back({TokenType::Attribute,
-                                  std::string(source.substr(start, pos - start)),
-                                  start,
-                                  pos - start});
+                out.push_back(TokenType::Attribute, start, pos - start);
                 continue;
             }
 
@@ -383,9 +402,9 @@ auto SyntaxHighlighter::tokenize_with_def(std::string_view source, const Languag
             {
                 ++pos;
             }
-            std::string id(source.substr(start, pos - start));
-            auto type = classify_identifier(id, source, pos, def);
-            tokens.push_back({type, std::move(id), start, pos - start});
+            const auto type =
+                classify_identifier(source.substr(start, pos - start), source, pos, lang.words);
+            out.push_back(type, start, pos - start);
             continue;
         }
 
@@ -399,17 +418,14 @@ auto SyntaxHighlighter::tokenize_with_def(std::string_view source, const Languag
             {
                 ++pos;
             }
-            tokens.push_back({TokenType::Operator,
-                              std::string(source.substr(start, pos - start)),
-                              start,
-                              pos - start});
+            out.push_back(TokenType::Operator, start, pos - start);
             continue;
         }
 
         // 8. Punctuation
         if (is_punctuation_char(source[pos]))
         {
-            tokens.push_back({TokenType::Punctuation, std::string(1, source[pos]), pos, 1});
+            out.push_back(TokenType::Punctuation, pos, 1);
             ++pos;
             continue;
         }
@@ -422,45 +438,25 @@ auto SyntaxHighlighter::tokenize_with_def(std::string_view source, const Languag
             {
                 ++pos;
             }
-            tokens.push_back({TokenType::Whitespace,
-                              std::string(source.substr(start, pos - start)),
-                              start,
-                              pos - start});
+            out.push_back(TokenType::Whitespace, start, pos - start);
             continue;
         }
 
         // 10. Anything else -> Text
-        tokens.push_back({TokenType::Text, std::string(1, source[pos]), pos, 1});
+        out.push_back(TokenType::Text, pos, 1);
         ++pos;
     }
-
-    return tokens;
 }
 
-auto SyntaxHighlighter::classify_identifier(const std::string& id,
+auto SyntaxHighlighter::classify_identifier(std::string_view id,
                                             std::string_view source,
                                             size_t end_pos,
-                                            const LanguageDefinition& def) -> TokenType
+                                            const KeywordTable& words) -> TokenType
 {
-    // Check keywords
-    for (const auto& kw : def.keywords)
-    {
-        if (id == kw)
-            return TokenType::Keyword;
-    }
-
-    // Check types
-    for (const auto& tp : def.types)
+    // Keywords, types and constants
+    if (const auto reserved = words.lookup(id); reserved != TokenType::Text)
     {
-        if (id == tp)
-            return TokenType::Type;
-    }
-
-    // Check constants
-    for (const auto& ct : def.constants)
-    {
-        if (id == ct)
-            return TokenType::Constant;
+        return reserved;
     }
 
     // Check if ALL_CAPS -> constant
@@ -494,6 +490,230 @@ auto SyntaxHighlighter::classify_identifier(const std::string& id,
     return TokenType::Text;
 }
 
+// ═══════════════════════════════════════════════════════
+// KeywordTable
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+
+constexpr uint64_t kKeywordSeedAttempts = 16;
+constexpr uint32_t kMaxDisplacement = UINT16_MAX;
+
+/// Smallest power of two >= max(value, 1).
+auto power_of_two_at_least(size_t value) -> size_t
+{
+    size_t result = 1;
+    while (result < value)
+    {
+        result *= 2;
+    }
+    return result;
+}
+
+} // namespace
+
+KeywordTable::KeywordTable(const LanguageDefinition& def)
+{
+    struct Word
+    {
+        std::string_view text;
+        TokenType type;
+    };
+    std::vector<Word> words;
+    auto add = [&words](const std::vector<std::string>& list, TokenType type)
+    {
+        for (const auto& word : list)
+        {
+            const bool seen = std::any_of(
+                words.begin(), words.end(), [&word](const Word& w) { return w.text == word; });
+            if (!word.empty() && word.size() <= UINT16_MAX && !seen)
+            {
+                words.push_back({word, type});
+            }
+        }
+    };
+    add(def.keywords, TokenType::Keyword);
+    add(def.types, TokenType::Type);
+    add(def.constants, TokenType::Constant);
+
+    word_count_ = words.size();
+    if (words.empty())
+    {
+        return;
+    }
+
+    std::vector<Slot> entries;
+    entries.reserve(words.size());
+    for (const auto& word : words)
+    {
+        entries.push_back({static_cast<uint32_t>(chars_.size()),
+                           static_cast<uint16_t>(word.text.size()),
+                           word.type});
+        chars_ += word.text;
+        if (word.text.size() < 64)
+        {
+            length_bits_ |= uint64_t{1} << word.text.size();
+        }
+    }
+    auto word_of = [this](const Slot& entry)
+    { return std::string_view(chars_.data() + entry.offset, entry.length); };
+
+    // Load factor <= 1/2, about four words per bucket
+    const auto slot_count = power_of_two_at_least(std::max<size_t>(entries.size() * 2, 8));
+    slot_mask_ = static_cast<uint32_t>(slot_count - 1);
+    bucket_mask_ = static_cast<uint32_t>(power_of_two_at_least((entries.size() + 3) / 4) - 1);
+
+    std::vector<uint64_t> hashes(entries.size());
+    std::vector<std::vector<uint32_t>> buckets(bucket_mask_ + 1);
+    std::vector<uint32_t> order(buckets.size());
+    std::vector<uint32_t> placed;
+    for (seed_ = 1; seed_ <= kKeywordSeedAttempts; ++seed_)
+    {
+        for (auto& bucket : buckets)
+        {
+            bucket.clear();
+        }
+        for (uint32_t i = 0; i < entries.size(); ++i)
+        {
+            hashes[i] = hash(word_of(entries[i]), seed_);
+            buckets[bucket_of(hashes[i])].push_back(i);
+        }
+
+        // Place the fullest buckets first, while the table is emptiest
+        for (uint32_t b = 0; b < order.size(); ++b)
+        {
+            order[b] = b;
+        }
+        std::stable_sort(order.begin(),
+                         order.end(),
+                         [&buckets](uint32_t lhs, uint32_t rhs)
+                         { return buckets[lhs].size() > buckets[rhs].size(); });
+
+        slots_.assign(size_t{slot_mask_} + 1, Slot{});
+        displacements_.assign(buckets.size(), 0);
+        bool all_placed = true;
+        for (const auto b : order)
+        {
+            if (buckets[b].empty())
+            {
+                break;
+            }
+            bool bucket_placed = false;
+            for (uint32_t displacement = 0; displacement <= kMaxDisplacement && !bucket_placed;
+                 ++displacement)
+            {
+                placed.clear();
+                bucket_placed = true;
+                for (const auto i : buckets[b])
+                {
+                    auto& slot = slots_[slot_of(hashes[i], displacement)];
+                    if (slot.length != 0)
+                    {
+                        bucket_placed = false;
+                        break;
+                    }
+                    slot = entries[i];
+                    placed.push_back(slot_of(hashes[i], displacement));
+                }
+                if (bucket_placed)
+                {
+                    displacements_[b] = static_cast<uint16_t>(displacement);
+                }
+                else
+                {
+                    for (const auto index : placed)
+                    {
+                        slots_[index] = Slot{};
+                    }
+                }
+            }
+            if (!bucket_placed)
+            {
+                all_placed = false;
+                break;
+            }
+        }
+        if (all_placed)
+        {
+            return;
+        }
+    }
+
+    // No seed could be displaced (pathological word list): linear probing
+    perfect_ = false;
+    seed_ = 1;
+    slots_.assign(size_t{slot_mask_} + 1, Slot{});
+    displacements_.assign(buckets.size(), 0);
+    for (const auto& entry : entries)
+    {
+        auto index = slot_of(hash(word_of(entry), seed_), 0);
+        while (slots_[index].length != 0)
+        {
+            index = (index + 1) & slot_mask_;
+        }
+        slots_[index] = entry;
+    }
+}
+
+auto KeywordTable::lookup(std::string_view word) const noexcept -> TokenType
+{
+    if (slots_.empty() || word.empty() || word.size() > UINT16_MAX ||
+        (word.size() < 64 && (length_bits_ & (uint64_t{1} << word.size())) == 0))
+    {
+        return TokenType::Text;
+    }
+
+    const auto word_hash = hash(word, seed_);
+    if (perfect_)
+    {
+        const auto& slot = slots_[slot_of(word_hash, displacements_[bucket_of(word_hash)])];
+        return slot_matches(slot, word) ? slot.type : TokenType::Text;
+    }
+    for (auto index = slot_of(word_hash, 0); slots_[index].length != 0;
+         index = (index + 1) & slot_mask_)
+    {
+        if (slot_matches(slots_[index], word))
+        {
+            return slots_[index].type;
+        }
+    }
+    return TokenType::Text;
+}
+
+auto KeywordTable::hash(std::string_view word, uint64_t seed) noexcept -> uint64_t
+{
+    // FNV-1a over a seeded basis, finished with a murmur-style mix
+    uint64_t value = 14695981039346656037ULL ^ (seed * 0x9E3779B97F4A7C15ULL);
+    for (const char ch : word)
+    {
+        value = (value ^ static_cast<unsigned char>(ch)) * 1099511628211ULL;
+    }
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDULL;
+    value ^= value >> 33;
+    return value;
+}
+
+auto KeywordTable::bucket_of(uint64_t hash) const noexcept -> uint32_t
+{
+    return static_cast<uint32_t>(hash >> 32) & bucket_mask_;
+}
+
+auto KeywordTable::slot_of(uint64_t hash, uint32_t displacement) const noexcept -> uint32_t
+{
+    // Double hashing: the low half picks the start, the high half the stride
+    const auto start = static_cast<uint32_t>(hash);
+    const auto stride = static_cast<uint32_t>(hash >> 40) | 1U;
+    return (start + displacement * stride) & slot_mask_;
+}
+
+auto KeywordTable::slot_matches(const Slot& slot, std::string_view word) const noexcept -> bool
+{
+    return slot.length == word.size() &&
+           std::string_view(chars_.data() + slot.offset, slot.length) == word;
+}
+
 // ═══════════════════════════════════════════════════════
 // Helpers
 // ═══════════════════════════════════════════════════════
@@ -519,11 +739,6 @@ auto SyntaxHighlighter::starts_with(std::string_view text, size_t pos, std::stri
     return text.substr(pos, prefix.size()) == prefix;
 }
 
-auto SyntaxHighlighter::escape_html(std::string_view text) -> std::string
-{
-    return core::escape_html(text);
-}
-
 // ═══════════════════════════════════════════════════════
 // Built-in language definitions (15 Tier 1 languages)
 // ═══════════════════════════════════════════════════════
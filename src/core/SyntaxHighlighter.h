@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -81,6 +83,12 @@ struct TokenArraySoA
         return types.empty();
     }
 
+    /// Text of token `index`, viewed in the source it was tokenized from.
+    [[nodiscard]] auto text(size_t index, std::string_view source) const -> std::string_view
+    {
+        return source.substr(starts[index], lengths[index]);
+    }
+
     void clear()
     {
         types.clear();
@@ -111,6 +119,67 @@ struct LanguageDefinition
     bool has_raw_strings{false};     // R"(...)" style
 };
 
+// ═══════════════════════════════════════════════════════
+// Compiled keyword table
+// ═══════════════════════════════════════════════════════
+
+/// Reserved words of one language (keywords, types, constants) compiled
+/// into a perfect hash at registration time.
+///
+/// Construction uses hash-and-displace: words are grouped into small
+/// buckets by one part of their hash, and each bucket gets a displacement
+/// that sends its words to free slots, so the table stays linear in the
+/// number of words. A lookup is one hash of the identifier, one
+/// displacement load and at most one comparison; most non-reserved
+/// identifiers are rejected by length alone. A word listed in several
+/// categories keeps the first one, in the order keywords, types, constants.
+class KeywordTable
+{
+public:
+    KeywordTable() = default;
+    explicit KeywordTable(const LanguageDefinition& def);
+
+    /// Keyword, Type or Constant for a reserved word; Text otherwise.
+    [[nodiscard]] auto lookup(std::string_view word) const noexcept -> TokenType;
+
+    /// Number of distinct reserved words.
+    [[nodiscard]] auto size() const noexcept -> size_t
+    {
+        return word_count_;
+    }
+
+    /// Whether every word has its own slot (false only if no seed could be
+    /// displaced and the table fell back to linear probing).
+    [[nodiscard]] auto is_perfect() const noexcept -> bool
+    {
+        return perfect_;
+    }
+
+private:
+    struct Slot
+    {
+        uint32_t offset{0}; // into chars_
+        uint16_t length{0}; // 0 = empty slot
+        TokenType type{TokenType::Text};
+    };
+
+    std::string chars_; // Every word, back to back
+    std::vector<Slot> slots_;
+    std::vector<uint16_t> displacements_; // One per bucket
+    uint64_t seed_{0};
+    uint32_t slot_mask_{0};
+    uint32_t bucket_mask_{0};
+    uint64_t length_bits_{0}; // Bit n set if some word is n bytes long (n < 64)
+    size_t word_count_{0};
+    bool perfect_{true};
+
+    [[nodiscard]] static auto hash(std::string_view word, uint64_t seed) noexcept -> uint64_t;
+    [[nodiscard]] auto bucket_of(uint64_t hash) const noexcept -> uint32_t;
+    [[nodiscard]] auto slot_of(uint64_t hash, uint32_t displacement) const noexcept -> uint32_t;
+    [[nodiscard]] auto slot_matches(const Slot& slot, std::string_view word) const noexcept
+        -> bool;
+};
+
 // ═══════════════════════════════════════════════════════
 // Syntax highlighter
 // ═══════════════════════════════════════════════════════
@@ -120,24 +189,43 @@ class SyntaxHighlighter
 public:
     SyntaxHighlighter();
 
-    /// Register a language definition.
+    /// Register a language definition; its reserved words are compiled
+    /// into a KeywordTable here.
     void register_language(LanguageDefinition def);
 
-    /// Tokenize source code in the given language.
+    /// Tokenize source code in the given language. Copies every token's
+    /// text; prefer tokenize_soa() when positions are enough.
     [[nodiscard]] auto tokenize(std::string_view source, const std::string& language)
         -> std::vector<Token>;
 
     /// Tokenize into SoA layout for cache-friendly iteration (Pattern #10).
+    /// This is the primary path: tokens are (type, start, length) triples
+    /// and their text is viewed in `source` (TokenArraySoA::text()).
     [[nodiscard]] auto tokenize_soa(std::string_view source, const std::string& language)
         -> TokenArraySoA;
 
+    /// As above, refilling `out` in place. Once `out` has grown to the
+    /// workload, tokenizing allocates nothing.
+    void tokenize_soa(std::string_view source, const std::string& language, TokenArraySoA& out);
+
     /// Render source code as HTML with <span class="token-*"> tags.
     [[nodiscard]] auto render_html(std::string_view source, const std::string& language)
         -> std::string;
 
+    /// As above, appending to `output` and tokenizing into `tokens`. With
+    /// warm buffers, highlighting allocates nothing.
+    void render_html_into(std::string_view source,
+                          const std::string& language,
+                          std::string& output,
+                          TokenArraySoA& tokens);
+
     /// Check if a language is supported.
     [[nodiscard]] auto is_supported(const std::string& language) const -> bool;
 
+    /// Definition of a supported language or alias; nullptr if unsupported.
+    [[nodiscard]] auto language_definition(const std::string& language) const
+        -> const LanguageDefinition*;
+
     /// List all supported language names.
     [[nodiscard]] auto supported_languages() const -> std::vector<std::string>;
 
@@ -145,14 +233,24 @@ public:
     [[nodiscard]] static auto token_class(TokenType type) -> std::string_view;
 
 private:
-    std::unordered_map<std::string, LanguageDefinition> languages_;
+    /// A registered language with its lookup tables.
+    struct CompiledLanguage
+    {
+        LanguageDefinition def;
+        KeywordTable words;
+        std::array<bool, 256> string_delimiter{}; // Indexed by unsigned char
+    };
+
+    std::unordered_map<std::string, CompiledLanguage> languages_;
     std::unordered_map<std::string, std::string> alias_map_; // alias -> canonical name
 
     [[nodiscard]] auto resolve_language(const std::string& name_or_alias) const
-        -> const LanguageDefinition*;
+        -> const CompiledLanguage*;
 
-    [[nodiscard]] auto tokenize_with_def(std::string_view source, const LanguageDefinition& def)
-        -> std::vector<Token>;
+    /// The tokenizer proper: appends every token of `source` to `out`.
+    void tokenize_into(std::string_view source,
+                       const CompiledLanguage& lang,
+                       TokenArraySoA& out) const;
 
     void register_builtin_languages();
 
@@ -162,13 +260,11 @@ private:
     [[nodiscard]] static auto
     starts_with(std::string_view text, size_t pos, std::string_view prefix) -> bool;
 
-    [[nodiscard]] static auto escape_html(std::string_view text) -> std::string;
-
-    // Classify an identifier against the language definition
-    [[nodiscard]] static auto classify_identifier(const std::string& id,
+    // Classify an identifier against the language's reserved words
+    [[nodiscard]] static auto classify_identifier(std::string_view id,
                                                   std::string_view source,
                                                   size_t end_pos,
-                                                  const LanguageDefinition& def) -> TokenType;
+                                                  const KeywordTable& words) -> TokenType;
 };
 
 } // namespace markamp::core
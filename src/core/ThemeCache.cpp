@@ -0,0 +1,653 @@
+#include "ThemeCache.h"
+
+#include "Logger.h"
+#include "StringUtils.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+
+namespace markamp::core
+{
+
+namespace
+{
+
+constexpr std::array<char, 4> kMagic{'M', 'A', 'T', 'C'};
+constexpr std::uint32_t kByteOrderMark = 0x01020304;
+
+/// Blob header. The byte-order mark makes a cache copied between machines
+/// of different endianness read as foreign, so it is rebuilt.
+struct Header
+{
+    std::array<char, 4> magic{kMagic};
+    std::uint32_t version{ThemeCache::kFormatVersion};
+    std::uint32_t count{0};
+    std::uint32_t byte_order{kByteOrderMark};
+};
+static_assert(std::is_trivially_copyable_v<Header>);
+static_assert(sizeof(Header) == 16);
+
+[[nodiscard]] auto is_theme_file(const std::filesystem::path& path) -> bool
+{
+    const auto ext = path.extension();
+    return ext == ".md" || ext == ".json";
+}
+
+[[nodiscard]] auto read_file(const std::filesystem::path& path) -> std::optional<std::string>
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return std::nullopt;
+    }
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// ═══════════════════════════════════════════════════════
+// Theme record codec
+// ═══════════════════════════════════════════════════════
+
+/// Appends fields in host byte order.
+class RecordWriter
+{
+public:
+    explicit RecordWriter(std::string& out)
+        : out_(out)
+    {
+    }
+
+    void field(const Color& color)
+    {
+        out_ += static_cast<char>(color.r);
+        out_ += static_cast<char>(color.g);
+        out_ += static_cast<char>(color.b);
+        out_ += static_cast<char>(color.a);
+    }
+
+    void field(std::uint8_t value)
+    {
+        out_ += static_cast<char>(value);
+    }
+
+    void field(bool value)
+    {
+        field(static_cast<std::uint8_t>(value ? 1 : 0));
+    }
+
+    void field(int value)
+    {
+        const auto fixed = static_cast<std::int32_t>(value);
+        out_.append(reinterpret_cast<const char*>(&fixed), sizeof(fixed));
+    }
+
+    void field(const std::string& text)
+    {
+        field(static_cast<int>(text.size()));
+        out_ += text;
+    }
+
+    void field(const std::optional<std::string>& text)
+    {
+        field(text.has_value());
+        if (text)
+        {
+            field(*text);
+        }
+    }
+
+private:
+    std::string& out_;
+};
+
+/// Reads what RecordWriter wrote. Any overrun marks the reader failed and
+/// leaves the remaining fields untouched.
+class RecordReader
+{
+public:
+    explicit RecordReader(std::string_view in)
+        : in_(in)
+    {
+    }
+
+    void field(Color& color)
+    {
+        if (const auto bytes = take(4); bytes.size() == 4)
+        {
+            color = Color(static_cast<std::uint8_t>(bytes[0]),
+                          static_cast<std::uint8_t>(bytes[1]),
+                          static_cast<std::uint8_t>(bytes[2]),
+                          static_cast<std::uint8_t>(bytes[3]));
+        }
+    }
+
+    void field(std::uint8_t& value)
+    {
+        if (const auto bytes = take(1); bytes.size() == 1)
+        {
+            value = static_cast<std::uint8_t>(bytes[0]);
+        }
+    }
+
+    void field(bool& value)
+    {
+        std::uint8_t byte = 0;
+        field(byte);
+        value = byte != 0;
+    }
+
+    void field(int& value)
+    {
+        std::int32_t fixed = 0;
+        if (const auto bytes = take(sizeof(fixed)); bytes.size() == sizeof(fixed))
+        {
+            std::memcpy(&fixed, bytes.data(), sizeof(fixed));
+            value = fixed;
+        }
+    }
+
+    void field(std::string& text)
+    {
+        int length = 0;
+        field(length);
+        if (length < 0)
+        {
+            failed_ = true;
+            return;
+        }
+        if (const auto bytes = take(static_cast<std::size_t>(length));
+            bytes.size() == static_cast<std::size_t>(length))
+        {
+            text.assign(bytes);
+        }
+    }
+
+    void field(std::optional<std::string>& text)
+    {
+        bool present = false;
+        field(present);
+        if (present)
+        {
+            field(text.emplace());
+        }
+        else
+        {
+            text.reset();
+        }
+    }
+
+    /// True if every field was read and nothing is left over.
+    [[nodiscard]] auto complete() const noexcept -> bool
+    {
+        return !failed_ && position_ == in_.size();
+    }
+
+private:
+    std::string_view in_;
+    std::size_t position_{0};
+    bool failed_{false};
+
+    auto take(std::size_t count) -> std::string_view
+    {
+        if (failed_ || in_.size() - position_ < count)
+        {
+            failed_ = true;
+            return {};
+        }
+        const auto bytes = in_.substr(position_, count);
+        position_ += count;
+        return bytes;
+    }
+};
+
+/// Every Theme field, in record order. Shared by encode and decode so the
+/// two cannot drift apart; bump kFormatVersion when this list changes.
+template <typename ThemeT, typename Codec>
+void transfer(ThemeT& theme, Codec& codec)
+{
+    codec.field(theme.id);
+    codec.field(theme.name);
+
+    auto& colors = theme.colors;
+    codec.field(colors.bg_app);
+    codec.field(colors.bg_panel);
+    codec.field(colors.bg_header);
+    codec.field(colors.bg_input);
+    codec.field(colors.text_main);
+    codec.field(colors.text_muted);
+    codec.field(colors.accent_primary);
+    codec.field(colors.accent_secondary);
+    codec.field(colors.border_light);
+    codec.field(colors.border_dark);
+    codec.field(colors.editor_bg);
+    codec.field(colors.editor_fg);
+    codec.field(colors.editor_selection);
+    codec.field(colors.editor_line_number);
+    codec.field(colors.editor_cursor);
+    codec.field(colors.editor_gutter);
+    codec.field(colors.list_hover);
+    codec.field(colors.list_selected);
+    codec.field(colors.scrollbar_thumb);
+    codec.field(colors.scrollbar_track);
+
+    auto& chrome = theme.chrome;
+    codec.field(chrome.bg_app);
+    codec.field(chrome.bg_panel);
+    codec.field(chrome.bg_header);
+    codec.field(chrome.bg_input);
+    codec.field(chrome.border_light);
+    codec.field(chrome.border_dark);
+    codec.field(chrome.accent_primary);
+    codec.field(chrome.accent_secondary);
+    codec.field(chrome.list_hover);
+    codec.field(chrome.list_selected);
+    codec.field(chrome.scrollbar_thumb);
+    codec.field(chrome.scrollbar_track);
+
+    auto& syntax = theme.syntax;
+    codec.field(syntax.editor_bg);
+    codec.field(syntax.editor_fg);
+    codec.field(syntax.editor_selection);
+    codec.field(syntax.editor_line_number);
+    codec.field(syntax.editor_cursor);
+    codec.field(syntax.editor_gutter);
+    codec.field(syntax.keyword);
+    codec.field(syntax.string_literal);
+    codec.field(syntax.comment);
+    codec.field(syntax.number);
+    codec.field(syntax.type_name);
+    codec.field(syntax.function_name);
+    codec.field(syntax.operator_tok);
+    codec.field(syntax.preprocessor);
+
+    auto& render = theme.render;
+    codec.field(render.heading);
+    codec.field(render.link);
+    codec.field(render.code_bg);
+    codec.field(render.code_fg);
+    codec.field(render.blockquote_border);
+    codec.field(render.blockquote_bg);
+    codec.field(render.table_border);
+    codec.field(render.table_header_bg);
+
+    codec.field(theme.title_bar_gradient.start);
+    codec.field(theme.title_bar_gradient.end);
+    codec.field(theme.neon_edge);
+
+    auto& effects = theme.effects;
+    codec.field(effects.frosted_glass);
+    codec.field(effects.inner_shadow);
+    codec.field(effects.inner_shadow_radius);
+    codec.field(effects.inner_shadow_alpha);
+    codec.field(effects.edge_glow);
+    codec.field(effects.edge_glow_color);
+    codec.field(effects.edge_glow_width);
+    codec.field(effects.edge_glow_alpha);
+    codec.field(effects.vignette);
+    codec.field(effects.vignette_strength);
+    codec.field(effects.surface_blur);
+}
+
+// ═══════════════════════════════════════════════════════
+// Cache building
+// ═══════════════════════════════════════════════════════
+
+/// One entry of a cache being built.
+struct PendingEntry
+{
+    std::int64_t mtime{0};
+    std::uint64_t size{0};
+    std::uint64_t hash{0};
+    std::string source;
+    std::string id;
+    std::string name;
+    std::string record;
+};
+
+[[nodiscard]] auto entry_checksum(std::string_view id,
+                                  std::string_view name,
+                                  std::string_view record) noexcept -> std::uint64_t
+{
+    return fnv1a_64(record, fnv1a_64(name, fnv1a_64(id)));
+}
+
+template <typename Record>
+[[nodiscard]] auto serialize(const std::vector<PendingEntry>& entries) -> std::string
+{
+    Header header;
+    header.count = static_cast<std::uint32_t>(entries.size());
+
+    std::string blob;
+    blob.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    const auto index_start = blob.size();
+    blob.resize(index_start + entries.size() * sizeof(Record));
+
+    auto append = [&blob](const std::string& bytes, std::uint32_t& offset, std::uint32_t& length)
+    {
+        offset = static_cast<std::uint32_t>(blob.size());
+        length = static_cast<std::uint32_t>(bytes.size());
+        blob += bytes;
+    };
+
+    for (std::size_t i = 0; i < entries.size(); ++i)
+    {
+        const auto& entry = entries[i];
+        Record record;
+        record.mtime = entry.mtime;
+        record.size = entry.size;
+        record.hash = entry.hash;
+        record.checksum = entry_checksum(entry.id, entry.name, entry.record);
+        append(entry.source, record.source_offset, record.source_length);
+        append(entry.id, record.id_offset, record.id_length);
+        append(entry.name, record.name_offset, record.name_length);
+        append(entry.record, record.record_offset, record.record_length);
+        std::memcpy(blob.data() + index_start + i * sizeof(Record), &record, sizeof(Record));
+    }
+    return blob;
+}
+
+[[nodiscard]] auto write_atomically(const std::filesystem::path& path, const std::string& bytes)
+    -> bool
+{
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    // Write to a temporary name first so a crash never leaves a torn cache
+    auto temp = path;
+    temp += ".tmp";
+    {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        if (!file.write(bytes.data(), static_cast<std::streamsize>(bytes.size())))
+        {
+            return false;
+        }
+    }
+    std::filesystem::rename(temp, path, error);
+    if (error)
+    {
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+// ═══════════════════════════════════════════════════════
+// Loading
+// ═══════════════════════════════════════════════════════
+
+auto ThemeCache::open(const std::filesystem::path& dir,
+                      const std::filesystem::path& cache_file,
+                      const Parser& parse) -> std::expected<ThemeCache, std::string>
+{
+    static_assert(std::is_trivially_copyable_v<IndexRecord>);
+    static_assert(sizeof(IndexRecord) == 64);
+
+    ThemeCache cache;
+    cache.dir_ = dir;
+    cache.parse_ = parse;
+    std::error_code exists_ec;
+    if (!std::filesystem::exists(dir, exists_ec))
+    {
+        return cache; // No themes directory yet, not an error
+    }
+
+    // Theme files, in a stable order so an unchanged directory matches the index
+    std::vector<std::filesystem::directory_entry> sources;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec))
+    {
+        if (entry.is_regular_file() && is_theme_file(entry.path()))
+        {
+            sources.push_back(entry);
+        }
+    }
+    if (ec)
+    {
+        return std::unexpected("Error reading themes directory: " + ec.message());
+    }
+    std::sort(sources.begin(),
+              sources.end(),
+              [](const auto& lhs, const auto& rhs)
+              { return lhs.path().filename() < rhs.path().filename(); });
+
+    // The previous cache, if it is one of ours
+    std::vector<IndexRecord> previous;
+    if (auto mapped = MappedFile::open(cache_file, 0))
+    {
+        cache.file_ = std::move(*mapped);
+        previous = read_index(cache.file_.bytes());
+    }
+    std::unordered_map<std::string_view, const IndexRecord*> previous_by_source;
+    for (const auto& record : previous)
+    {
+        previous_by_source.emplace(cache.slice(record.source_offset, record.source_length),
+                                   &record);
+    }
+
+    std::vector<PendingEntry> entries;
+    entries.reserve(sources.size());
+    bool changed = previous.size() != sources.size();
+    for (const auto& source : sources)
+    {
+        PendingEntry entry;
+        entry.source = source.path().filename().string();
+        entry.size = static_cast<std::uint64_t>(source.file_size(ec));
+        entry.mtime =
+            static_cast<std::int64_t>(source.last_write_time(ec).time_since_epoch().count());
+
+        const auto found = previous_by_source.find(entry.source);
+        const IndexRecord* cached = found != previous_by_source.end() ? found->second : nullptr;
+        if (cached != nullptr && cached->size == entry.size && cached->mtime == entry.mtime)
+        {
+            entry.hash = cached->hash;
+        }
+        else
+        {
+            const auto content = read_file(source.path());
+            if (!content)
+            {
+                ++cache.stats_.failed;
+                changed = true;
+                continue;
+            }
+            entry.hash = fnv1a_64(*content);
+            changed = true;
+            if (cached == nullptr || cached->size != entry.size || cached->hash != entry.hash)
+            {
+                cached = nullptr; // Content changed: parse it again
+            }
+        }
+
+        if (cached != nullptr && !cache.checksum_matches(*cached))
+        {
+            MARKAMP_LOG_WARN("ThemeCache: corrupt entry for {}, parsing it again", entry.source);
+            cached = nullptr;
+            changed = true;
+        }
+
+        if (cached != nullptr)
+        {
+            entry.id = cache.slice(cached->id_offset, cached->id_length);
+            entry.name = cache.slice(cached->name_offset, cached->name_length);
+            entry.record = cache.slice(cached->record_offset, cached->record_length);
+            ++cache.stats_.reused;
+        }
+        else
+        {
+            auto theme = parse(source.path());
+            if (!theme)
+            {
+                MARKAMP_LOG_WARN("Skipping invalid theme file {}: {}", entry.source, theme.error());
+                ++cache.stats_.failed;
+                continue;
+            }
+            entry.id = theme->id;
+            entry.name = theme->name;
+            encode(*theme, entry.record);
+            ++cache.stats_.parsed;
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    if (!changed)
+    {
+        cache.index_ = std::move(previous);
+        return cache;
+    }
+
+    auto blob = serialize<IndexRecord>(entries);
+    cache.file_ = MappedFile();
+    if (write_atomically(cache_file, blob))
+    {
+        cache.stats_.rewritten = true;
+        if (auto mapped = MappedFile::open(cache_file, 0))
+        {
+            cache.file_ = std::move(*mapped);
+            cache.index_ = read_index(cache.file_.bytes());
+            if (cache.index_.size() == entries.size())
+            {
+                return cache;
+            }
+            cache.file_ = MappedFile();
+        }
+    }
+    else
+    {
+        MARKAMP_LOG_WARN("ThemeCache: cannot write {}", cache_file.string());
+    }
+
+    // Serve the freshly built blob from memory
+    cache.built_ = std::move(blob);
+    cache.index_ = read_index(cache.built_);
+    return cache;
+}
+
+auto ThemeCache::read_index(std::string_view blob) -> std::vector<IndexRecord>
+{
+    Header header;
+    if (blob.size() < sizeof(header))
+    {
+        return {};
+    }
+    std::memcpy(&header, blob.data(), sizeof(header));
+    if (header.magic != kMagic || header.version != kFormatVersion ||
+        header.byte_order != kByteOrderMark ||
+        header.count > (blob.size() - sizeof(header)) / sizeof(IndexRecord))
+    {
+        return {};
+    }
+
+    auto in_bounds = [&blob](std::uint32_t offset, std::uint32_t length)
+    { return offset <= blob.size() && length <= blob.size() - offset; };
+
+    std::vector<IndexRecord> index(header.count);
+    for (std::size_t i = 0; i < index.size(); ++i)
+    {
+        auto& record = index[i];
+        std::memcpy(
+            &record, blob.data() + sizeof(header) + i * sizeof(IndexRecord), sizeof(record));
+        if (!in_bounds(record.source_offset, record.source_length) ||
+            !in_bounds(record.id_offset, record.id_length) ||
+            !in_bounds(record.name_offset, record.name_length) ||
+            !in_bounds(record.record_offset, record.record_length))
+        {
+            return {};
+        }
+    }
+    return index;
+}
+
+// ═══════════════════════════════════════════════════════
+// Queries
+// ═══════════════════════════════════════════════════════
+
+auto ThemeCache::blob() const noexcept -> std::string_view
+{
+    return built_.empty() ? file_.bytes() : std::string_view(built_);
+}
+
+auto ThemeCache::slice(std::uint32_t offset, std::uint32_t length) const -> std::string_view
+{
+    return blob().substr(offset, length);
+}
+
+auto ThemeCache::checksum_matches(const IndexRecord& record) const -> bool
+{
+    return record.checksum == entry_checksum(slice(record.id_offset, record.id_length),
+                                             slice(record.name_offset, record.name_length),
+                                             slice(record.record_offset, record.record_length));
+}
+
+auto ThemeCache::id(std::size_t index) const -> std::string_view
+{
+    return slice(index_[index].id_offset, index_[index].id_length);
+}
+
+auto ThemeCache::name(std::size_t index) const -> std::string_view
+{
+    return slice(index_[index].name_offset, index_[index].name_length);
+}
+
+auto ThemeCache::source(std::size_t index) const -> std::string_view
+{
+    return slice(index_[index].source_offset, index_[index].source_length);
+}
+
+auto ThemeCache::find(std::string_view theme_id) const -> std::optional<std::size_t>
+{
+    for (std::size_t index = 0; index < index_.size(); ++index)
+    {
+        if (id(index) == theme_id)
+        {
+            return index;
+        }
+    }
+    return std::nullopt;
+}
+
+auto ThemeCache::materialize(std::size_t index) const -> std::expected<Theme, std::string>
+{
+    const auto& record = index_[index];
+    if (checksum_matches(record))
+    {
+        return decode(slice(record.record_offset, record.record_length));
+    }
+
+    MARKAMP_LOG_WARN("ThemeCache: corrupt entry for {}, parsing it again", source(index));
+    if (!parse_)
+    {
+        return std::unexpected("Corrupt theme cache record");
+    }
+    return parse_(dir_ / source(index));
+}
+
+// ═══════════════════════════════════════════════════════
+// Record encoding
+// ═══════════════════════════════════════════════════════
+
+void ThemeCache::encode(const Theme& theme, std::string& out)
+{
+    RecordWriter writer(out);
+    transfer(theme, writer);
+}
+
+auto ThemeCache::decode(std::string_view record) -> std::expected<Theme, std::string>
+{
+    Theme theme;
+    RecordReader reader(record);
+    transfer(theme, reader);
+    if (!reader.complete())
+    {
+        return std::unexpected("Corrupt theme cache record");
+    }
+    return theme;
+}
+
+} // namespace markamp::core
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "Theme.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace markamp::core
+{
+
+/// Compiled, memory-mappable cache of the theme files in one directory.
+///
+/// The cache file is a flat binary blob: a header, one fixed-size index
+/// record per theme (source file name, size, mtime and FNV-1a hash, plus
+/// offsets of the id, name and theme record, and an FNV-1a checksum of those
+/// three), then the strings and the records. A record holds every resolved token of a Theme (colors, layers,
+/// gradient, effects), so materializing a theme is a bounds-checked copy
+/// with no YAML or JSON parsing.
+///
+/// open() maps the cache and revalidates each entry against its source
+/// file: same size and mtime reuses the entry; same size but a new mtime
+/// compares the content hash first. Only new or changed files are parsed,
+/// and the cache file is rewritten only if anything changed. A missing,
+/// truncated or foreign cache file is simply rebuilt, and an entry whose
+/// checksum does not match is parsed from its source file again, both by
+/// open() and by materialize().
+///
+/// Pattern implemented: #18 Predictable I/O never on the hot path
+class ThemeCache
+{
+public:
+    static constexpr std::uint32_t kFormatVersion = 2;
+
+    /// Parses one theme source file (Markdown/YAML or JSON).
+    using Parser = std::function<std::expected<Theme, std::string>(const std::filesystem::path&)>;
+
+    struct Stats
+    {
+        std::size_t reused{0}; // Entries taken from the cache file
+        std::size_t parsed{0}; // Source files parsed because they were new or changed
+        std::size_t failed{0}; // Source files that did not parse (not cached)
+        bool rewritten{false}; // Whether the cache file was written
+    };
+
+    ThemeCache() = default;
+
+    /// Load the cache for the theme files in `dir`, refreshing `cache_file`
+    /// if any source changed. Fails only if `dir` cannot be listed; a
+    /// missing directory gives an empty cache.
+    [[nodiscard]] static auto open(const std::filesystem::path& dir,
+                                   const std::filesystem::path& cache_file,
+                                   const Parser& parse) -> std::expected<ThemeCache, std::string>;
+
+    /// Number of cached themes.
+    [[nodiscard]] auto size() const noexcept -> std::size_t
+    {
+        return index_.size();
+    }
+
+    // Index fields of entry `index`, read from the blob without decoding the theme
+    [[nodiscard]] auto id(std::size_t index) const -> std::string_view;
+    [[nodiscard]] auto name(std::size_t index) const -> std::string_view;
+    [[nodiscard]] auto source(std::size_t index) const -> std::string_view; // File name in dir
+
+    /// Index of the entry with theme id `id`.
+    [[nodiscard]] auto find(std::string_view id) const -> std::optional<std::size_t>;
+
+    /// Decode the full Theme of entry `index`, parsing its source file
+    /// instead if the entry fails its checksum.
+    [[nodiscard]] auto materialize(std::size_t index) const -> std::expected<Theme, std::string>;
+
+    /// True if the entries are read straight from a memory mapping.
+    [[nodiscard]] auto is_mapped() const noexcept -> bool
+    {
+        return file_.is_mapped();
+    }
+
+    [[nodiscard]] auto stats() const noexcept -> const Stats&
+    {
+        return stats_;
+    }
+
+    // Theme record encoding (one theme, no index)
+    static void encode(const Theme& theme, std::string& out);
+    [[nodiscard]] static auto decode(std::string_view record) -> std::expected<Theme, std::string>;
+
+private:
+    /// One index record, stored verbatim in the blob.
+    struct IndexRecord
+    {
+        std::int64_t mtime{0};
+        std::uint64_t size{0};
+        std::uint64_t hash{0};     // Of the source file
+        std::uint64_t checksum{0}; // Of the id, name and record in the blob
+        std::uint32_t source_offset{0};
+        std::uint32_t source_length{0};
+        std::uint32_t id_offset{0};
+        std::uint32_t id_length{0};
+        std::uint32_t name_offset{0};
+        std::uint32_t name_length{0};
+        std::uint32_t record_offset{0};
+        std::uint32_t record_length{0};
+    };
+
+    MappedFile file_;
+    std::string built_; // The blob, when the rebuilt cache could not be written and mapped
+    std::vector<IndexRecord> index_;
+    Stats stats_;
+    std::filesystem::path dir_;
+    Parser parse_; // Fallback for entries that fail their checksum
+
+    [[nodiscard]] auto blob() const noexcept -> std::string_view;
+    [[nodiscard]] auto slice(std::uint32_t offset, std::uint32_t length) const -> std::string_view;
+
+    /// True if the id, name and record of `record` are as they were written.
+    [[nodiscard]] auto checksum_matches(const IndexRecord& record) const -> bool;
+
+    /// Validate the header and index of `blob`; empty on any mismatch.
+    [[nodiscard]] static auto read_index(std::string_view blob) -> std::vector<IndexRecord>;
+};
+
+} // namespace markamp::core
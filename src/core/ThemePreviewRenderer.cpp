@@ -0,0 +1,299 @@
+#include "ThemePreviewRenderer.h"
+
+#include "Logger.h"
+#include "StringUtils.h"
+#include "ThemeCache.h"
+
+#include <algorithm>
+#include <exception>
+
+namespace markamp::core
+{
+
+namespace
+{
+
+/// Minimal software canvas: opaque RGB pixels, clipped fills, source-over
+/// blending for translucent theme colors.
+class Canvas
+{
+public:
+    explicit Canvas(ThemePreviewImage& image)
+        : image_(image)
+    {
+    }
+
+    void fill_rect(int left, int top, int width, int height, const Color& color)
+    {
+        const int x0 = std::max(0, left);
+        const int y0 = std::max(0, top);
+        const int x1 = std::min(image_.width, left + width);
+        const int y1 = std::min(image_.height, top + height);
+        for (int y = y0; y < y1; ++y)
+        {
+            for (int x = x0; x < x1; ++x)
+            {
+                blend(x, y, color);
+            }
+        }
+    }
+
+    /// Filled disc centred on (cx, cy), covering the pixels whose centres
+    /// lie within `radius`.
+    void fill_circle(int cx, int cy, int radius, const Color& color)
+    {
+        const int limit = radius * radius;
+        for (int y = std::max(0, cy - radius); y <= std::min(image_.height - 1, cy + radius); ++y)
+        {
+            for (int x = std::max(0, cx - radius); x <= std::min(image_.width - 1, cx + radius);
+                 ++x)
+            {
+                const int dx = x - cx;
+                const int dy = y - cy;
+                if (dx * dx + dy * dy <= limit)
+                {
+                    blend(x, y, color);
+                }
+            }
+        }
+    }
+
+private:
+    void blend(int x, int y, const Color& color)
+    {
+        const auto offset =
+            static_cast<std::size_t>(y) * static_cast<std::size_t>(image_.width) +
+            static_cast<std::size_t>(x);
+        auto* pixel = image_.rgb.data() + offset * 3;
+        if (color.a == 255)
+        {
+            pixel[0] = color.r;
+            pixel[1] = color.g;
+            pixel[2] = color.b;
+            return;
+        }
+        const int alpha = color.a;
+        const auto mix = [alpha](std::uint8_t dst, std::uint8_t src)
+        { return static_cast<std::uint8_t>((src * alpha + dst * (255 - alpha) + 127) / 255); };
+        pixel[0] = mix(pixel[0], color.r);
+        pixel[1] = mix(pixel[1], color.g);
+        pixel[2] = mix(pixel[2], color.b);
+    }
+
+    ThemePreviewImage& image_;
+};
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Construction
+// ═══════════════════════════════════════════════════════
+
+ThemePreviewRenderer::ThemePreviewRenderer(int width, int height, std::size_t max_bytes)
+    : width_(std::max(1, width))
+    , height_(std::max(1, height))
+    , cache_(max_bytes, &ThemePreviewRenderer::image_size)
+{
+}
+
+ThemePreviewRenderer::~ThemePreviewRenderer()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    if (worker_.joinable())
+    {
+        worker_.join();
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// Rendering
+// ═══════════════════════════════════════════════════════
+
+auto ThemePreviewRenderer::content_hash(const Theme& theme) -> std::uint64_t
+{
+    std::string record;
+    ThemeCache::encode(theme, record);
+    return fnv1a_64(record);
+}
+
+auto ThemePreviewRenderer::rasterize(const Theme& theme, int width, int height)
+    -> ThemePreviewImage
+{
+    ThemePreviewImage image;
+    image.width = std::max(1, width);
+    image.height = std::max(1, height);
+    image.rgb.resize(static_cast<std::size_t>(image.width) * static_cast<std::size_t>(image.height) *
+                     3);
+    Canvas canvas(image);
+    const auto& c = theme.colors;
+
+    // Background
+    canvas.fill_rect(0, 0, image.width, image.height, c.bg_app.with_alpha(uint8_t{255}));
+
+    // Header bar with two accent dots and a title bar
+    constexpr int kHeaderHeight = 18;
+    constexpr int kDotY = 7;
+    canvas.fill_rect(0, 0, image.width, kHeaderHeight, c.bg_header);
+    canvas.fill_circle(10, kDotY, 3, c.accent_primary);
+    canvas.fill_circle(20, kDotY, 3, c.accent_secondary);
+    canvas.fill_rect(32, kDotY - 2, 40, 4, c.text_muted);
+
+    // Sidebar with file-tree bars
+    constexpr int kSidebarWidth = 60;
+    const int body_top = kHeaderHeight - 1;
+    const int body_height = image.height - 1 - body_top;
+    canvas.fill_rect(0, body_top, kSidebarWidth, body_height, c.bg_panel);
+    canvas.fill_rect(6, body_top + 8, 36, 3, c.text_muted);
+    canvas.fill_rect(6, body_top + 16, 28, 3, c.text_muted);
+    canvas.fill_rect(6, body_top + 24, 42, 3, c.text_muted);
+
+    // Content: two headings in the primary accent, body lines in text_main
+    const int left = kSidebarWidth + 1;
+    canvas.fill_rect(left, body_top, image.width - left, body_height, c.bg_input);
+    canvas.fill_rect(left + 8, body_top + 8, 80, 4, c.accent_primary);
+    canvas.fill_rect(left + 8, body_top + 18, 120, 3, c.text_main);
+    canvas.fill_rect(left + 8, body_top + 26, 100, 3, c.text_main);
+    canvas.fill_rect(left + 8, body_top + 34, 110, 3, c.text_main);
+    canvas.fill_rect(left + 8, body_top + 42, 60, 3, c.text_main);
+    canvas.fill_rect(left + 8, body_top + 52, 70, 4, c.accent_primary);
+    canvas.fill_rect(left + 8, body_top + 62, 115, 3, c.text_main);
+    canvas.fill_rect(left + 8, body_top + 70, 90, 3, c.text_main);
+
+    return image;
+}
+
+// ═══════════════════════════════════════════════════════
+// Cache and queue
+// ═══════════════════════════════════════════════════════
+
+auto ThemePreviewRenderer::lookup(const std::string& theme_id, std::uint64_t hash) -> Image
+{
+    std::lock_guard lock(mutex_);
+    if (auto* image = cache_.get(cache_key(theme_id, hash)))
+    {
+        ++stats_.hits;
+        return *image;
+    }
+    return nullptr;
+}
+
+auto ThemePreviewRenderer::request(const Theme& theme, std::uint64_t hash) -> bool
+{
+    const auto key = cache_key(theme.id, hash);
+    {
+        std::lock_guard lock(mutex_);
+        if (stopping_ || cache_.get(key) != nullptr || !queued_.insert(key).second)
+        {
+            return false;
+        }
+        jobs_.push_front(Job{key, hash, theme});
+        if (!worker_.joinable())
+        {
+            worker_ = std::thread([this]() { run_worker(); });
+        }
+    }
+    work_cv_.notify_one();
+    return true;
+}
+
+void ThemePreviewRenderer::cancel_pending()
+{
+    std::lock_guard lock(mutex_);
+    stats_.cancelled += jobs_.size();
+    jobs_.clear();
+    queued_.clear();
+    if (!busy_)
+    {
+        idle_cv_.notify_all();
+    }
+}
+
+void ThemePreviewRenderer::set_ready_callback(ReadyCallback callback)
+{
+    std::lock_guard lock(callback_mutex_);
+    on_ready_ = std::move(callback);
+}
+
+void ThemePreviewRenderer::wait_idle()
+{
+    std::unique_lock lock(mutex_);
+    idle_cv_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+}
+
+auto ThemePreviewRenderer::stats() const -> Stats
+{
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+auto ThemePreviewRenderer::cache_key(const std::string& theme_id, std::uint64_t hash)
+    -> std::uint64_t
+{
+    return fnv1a_64(theme_id, hash);
+}
+
+auto ThemePreviewRenderer::image_size(const Image& image) -> std::size_t
+{
+    return image != nullptr ? image->rgb.size() + sizeof(ThemePreviewImage) : 0;
+}
+
+void ThemePreviewRenderer::run_worker()
+{
+    std::unique_lock lock(mutex_);
+    while (true)
+    {
+        work_cv_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+        if (stopping_)
+        {
+            return;
+        }
+        auto job = std::move(jobs_.front());
+        jobs_.pop_front();
+        queued_.erase(job.key);
+        busy_ = true;
+        lock.unlock();
+
+        Image image;
+        try
+        {
+            image =
+                std::make_shared<const ThemePreviewImage>(rasterize(job.theme, width_, height_));
+        }
+        catch (const std::exception& ex)
+        {
+            MARKAMP_LOG_WARN("Theme preview for '{}' failed: {}", job.theme.id, ex.what());
+        }
+
+        const bool stored = image != nullptr;
+        lock.lock();
+        if (stored)
+        {
+            cache_.put(job.key, std::move(image));
+            ++stats_.rendered;
+        }
+        lock.unlock();
+
+        // The listener looks the preview up, so it runs once it is stored
+        if (stored)
+        {
+            std::lock_guard callback_lock(callback_mutex_);
+            if (on_ready_)
+            {
+                on_ready_(job.theme.id, job.hash);
+            }
+        }
+
+        lock.lock();
+        busy_ = false;
+        if (jobs_.empty())
+        {
+            idle_cv_.notify_all();
+        }
+    }
+}
+
+} // namespace markamp::core
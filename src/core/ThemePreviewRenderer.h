@@ -0,0 +1,137 @@
+#pragma once
+
+#include "ChunkedStorage.h"
+#include "Theme.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace markamp::core
+{
+
+/// Opaque pixels of one rendered theme preview, 3 bytes (RGB) per pixel,
+/// row by row — the layout wxImage takes without conversion.
+struct ThemePreviewImage
+{
+    int width{0};
+    int height{0};
+    std::vector<std::uint8_t> rgb;
+};
+
+/// Renders the miniature MarkAmp UI shown on theme gallery cards into
+/// plain pixel buffers on a background thread and keeps them in a
+/// byte-capped LRU.
+///
+/// Previews are keyed by theme id plus a hash of the theme's resolved
+/// content, so an edited or re-imported theme file renders again while an
+/// unchanged one is a hit for as long as the renderer lives. The worker
+/// touches no GUI toolkit: the UI thread turns a finished image into a
+/// bitmap when the ready callback tells it one has arrived.
+///
+/// Pattern implemented: #39 Memory locality — capped render caches
+class ThemePreviewRenderer
+{
+public:
+    using Image = std::shared_ptr<const ThemePreviewImage>;
+
+    /// Called on the worker thread after a preview was stored.
+    using ReadyCallback = std::function<void(const std::string& theme_id, std::uint64_t hash)>;
+
+    static constexpr std::size_t kMaxCacheBytes = static_cast<std::size_t>(16) * 1024 * 1024;
+
+    ThemePreviewRenderer(int width, int height, std::size_t max_bytes = kMaxCacheBytes);
+    ~ThemePreviewRenderer();
+
+    // Non-copyable, non-movable
+    ThemePreviewRenderer(const ThemePreviewRenderer&) = delete;
+    auto operator=(const ThemePreviewRenderer&) -> ThemePreviewRenderer& = delete;
+    ThemePreviewRenderer(ThemePreviewRenderer&&) = delete;
+    auto operator=(ThemePreviewRenderer&&) -> ThemePreviewRenderer& = delete;
+
+    /// Stable hash of everything a theme draws with (FNV-1a of its
+    /// compiled ThemeCache record).
+    [[nodiscard]] static auto content_hash(const Theme& theme) -> std::uint64_t;
+
+    /// Draw the preview of `theme` into a `width` x `height` image.
+    [[nodiscard]] static auto rasterize(const Theme& theme, int width, int height)
+        -> ThemePreviewImage;
+
+    /// The cached preview, or nullptr if it has not been rendered yet.
+    [[nodiscard]] auto lookup(const std::string& theme_id, std::uint64_t hash) -> Image;
+
+    /// Queue `theme` for rendering unless it is cached or already queued.
+    /// Newer requests are rendered first, so the rows scrolled into view
+    /// last appear first. Returns true if a job was queued.
+    auto request(const Theme& theme, std::uint64_t hash) -> bool;
+
+    /// Drop queued jobs that have not started, e.g. rows scrolled away.
+    void cancel_pending();
+
+    /// Replace the ready callback. Blocks while a callback is running, so
+    /// after set_ready_callback(nullptr) returns none will run again.
+    void set_ready_callback(ReadyCallback callback);
+
+    /// Block until no job is queued or being rendered.
+    void wait_idle();
+
+    [[nodiscard]] auto width() const noexcept -> int
+    {
+        return width_;
+    }
+
+    [[nodiscard]] auto height() const noexcept -> int
+    {
+        return height_;
+    }
+
+    struct Stats
+    {
+        std::size_t hits{0};
+        std::size_t rendered{0};
+        std::size_t cancelled{0};
+    };
+
+    [[nodiscard]] auto stats() const -> Stats;
+
+private:
+    struct Job
+    {
+        std::uint64_t key{0};
+        std::uint64_t hash{0};
+        Theme theme;
+    };
+
+    [[nodiscard]] static auto cache_key(const std::string& theme_id, std::uint64_t hash)
+        -> std::uint64_t;
+    [[nodiscard]] static auto image_size(const Image& image) -> std::size_t;
+    void run_worker();
+
+    int width_;
+    int height_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    ByteCappedLRU<std::uint64_t, Image> cache_; // GUARDED_BY(mutex_)
+    std::deque<Job> jobs_;                      // GUARDED_BY(mutex_) Newest first
+    std::unordered_set<std::uint64_t> queued_;  // GUARDED_BY(mutex_) Keys in jobs_
+    bool busy_{false};                          // GUARDED_BY(mutex_) A job is rendering
+    bool stopping_{false};                      // GUARDED_BY(mutex_)
+    Stats stats_;                               // GUARDED_BY(mutex_)
+    std::thread worker_;                        // Started on the first request
+
+    /// Serializes the ready callback against set_ready_callback().
+    std::mutex callback_mutex_;
+    ReadyCallback on_ready_;
+};
+
+} // namespace markamp::core
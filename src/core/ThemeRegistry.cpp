@@ -19,21 +19,76 @@ ThemeRegistry::ThemeRegistry() = default;
 
 auto ThemeRegistry::initialize() -> std::expected<void, std::string>
 {
-    load_builtin_themes();
+    initialize_builtin();
 
-    auto userResult = load_user_themes();
-    if (!userResult)
+    auto user_themes = open_user_theme_cache();
+    if (!user_themes)
     {
-        MARKAMP_LOG_WARN("Could not load user themes: {}", userResult.error());
+        MARKAMP_LOG_WARN("Could not load user themes: {}", user_themes.error());
         // Non-fatal: built-in themes are still available
     }
+    else
+    {
+        add_cached_themes(std::make_shared<const ThemeCache>(std::move(*user_themes)));
+    }
 
     MARKAMP_LOG_INFO("ThemeRegistry: {} themes loaded ({} built-in)",
-                     themes_.size(),
+                     theme_count(),
                      get_builtin_themes().size());
     return {};
 }
 
+void ThemeRegistry::initialize_builtin()
+{
+    if (themes_.empty())
+    {
+        load_builtin_themes();
+    }
+}
+
+void ThemeRegistry::add_user_themes(std::vector<Theme> themes)
+{
+    for (auto& theme : themes)
+    {
+        register_theme(std::move(theme));
+    }
+}
+
+auto ThemeRegistry::open_user_theme_cache() -> std::expected<ThemeCache, std::string>
+{
+    return ThemeCache::open(
+        user_themes_directory(), theme_cache_file(), &ThemeRegistry::parse_theme_file);
+}
+
+void ThemeRegistry::add_cached_themes(std::shared_ptr<const ThemeCache> cache)
+{
+    cache_ = std::move(cache);
+    removed_cached_ids_.clear();
+    if (!cache_)
+    {
+        return;
+    }
+
+    // Built-in ids always shadow cached ones, so register those copies renamed now
+    for (std::size_t index = 0; index < cache_->size(); ++index)
+    {
+        if (is_builtin(std::string(cache_->id(index))))
+        {
+            if (auto theme = cache_->materialize(index))
+            {
+                register_theme(std::move(*theme));
+            }
+        }
+    }
+
+    const auto& stats = cache_->stats();
+    MARKAMP_LOG_INFO("ThemeRegistry: {} cached user themes ({} reused, {} parsed{})",
+                     cache_->size(),
+                     stats.reused,
+                     stats.parsed,
+                     stats.rewritten ? ", cache rewritten" : "");
+}
+
 auto ThemeRegistry::get_theme(const std::string& id) const -> std::optional<Theme>
 {
     auto it =
@@ -42,6 +97,17 @@ auto ThemeRegistry::get_theme(const std::string& id) const -> std::optional<Them
     {
         return *it;
     }
+
+    // Materialize a cached theme only when it is actually needed
+    if (auto index = find_cached(id))
+    {
+        auto theme = cache_->materialize(*index);
+        if (theme)
+        {
+            return std::move(*theme);
+        }
+        MARKAMP_LOG_WARN("Could not load cached theme {}: {}", id, theme.error());
+    }
     return std::nullopt;
 }
 
@@ -65,20 +131,59 @@ auto ThemeRegistry::list_themes() const -> std::vector<ThemeInfo>
         });
     }
 
+    // Cached themes are listed straight from the cache index
+    for (std::size_t index = 0; cache_ && index < cache_->size(); ++index)
+    {
+        auto id = std::string(cache_->id(index));
+        if (find_cached(id) == index)
+        {
+            infos.push_back(ThemeInfo{
+                .id = std::move(id),
+                .name = std::string(cache_->name(index)),
+                .is_builtin = false,
+                .file_path = (user_themes_directory() / cache_->source(index)).string(),
+            });
+        }
+    }
+
     return infos;
 }
 
 auto ThemeRegistry::theme_count() const -> size_t
 {
-    return themes_.size();
+    auto count = themes_.size();
+    for (std::size_t index = 0; cache_ && index < cache_->size(); ++index)
+    {
+        if (find_cached(std::string(cache_->id(index))) == index)
+        {
+            ++count;
+        }
+    }
+    return count;
 }
 
 auto ThemeRegistry::has_theme(const std::string& id) const -> bool
+{
+    return find_loaded(id) || find_cached(id).has_value();
+}
+
+auto ThemeRegistry::find_loaded(const std::string& id) const -> bool
 {
     return std::any_of(
         themes_.begin(), themes_.end(), [&id](const Theme& t) { return t.id == id; });
 }
 
+auto ThemeRegistry::find_cached(const std::string& id) const -> std::optional<std::size_t>
+{
+    if (!cache_ || find_loaded(id) ||
+        std::find(removed_cached_ids_.begin(), removed_cached_ids_.end(), id) !=
+            removed_cached_ids_.end())
+    {
+        return std::nullopt;
+    }
+    return cache_->find(id);
+}
+
 auto ThemeRegistry::is_builtin(const std::string& id) const -> bool
 {
     const auto& builtins = get_builtin_themes();
@@ -92,14 +197,15 @@ void ThemeRegistry::load_builtin_themes()
     themes_.insert(themes_.end(), builtins.begin(), builtins.end());
 }
 
-auto ThemeRegistry::load_user_themes() -> std::expected<void, std::string>
+auto ThemeRegistry::scan_user_themes(const std::filesystem::path& dir)
+    -> std::expected<std::vector<Theme>, std::string>
 {
-    auto dir = user_themes_directory();
+    std::vector<Theme> themes;
     // R20 Fix 9: Use error_code overload — exists() can throw on bad permissions
     std::error_code exists_ec;
     if (!std::filesystem::exists(dir, exists_ec))
     {
-        return {}; // No user themes directory yet, not an error
+        return themes; // No user themes directory yet, not an error
     }
 
     std::error_code ec;
@@ -111,28 +217,15 @@ auto ThemeRegistry::load_user_themes() -> std::expected<void, std::string>
         }
 
         auto ext = entry.path().extension().string();
-        std::expected<Theme, std::string> result = std::unexpected("Unknown file type");
-
-        if (ext == ".json")
-        {
-            // Legacy JSON loading
-            // We can keep the old import_theme for JSON or refactor it.
-            // For now, let's keep the old logic but invoke it here.
-            result = import_theme(entry.path());
-        }
-        else if (ext == ".md")
-        {
-            // New Markdown/YAML loading
-            result = ThemeLoader::load_from_file(entry.path());
-        }
-        else
+        if (ext != ".json" && ext != ".md")
         {
             continue;
         }
 
+        auto result = parse_theme_file(entry.path());
         if (result)
         {
-            themes_.push_back(*result);
+            themes.push_back(std::move(*result));
         }
         else
         {
@@ -147,10 +240,27 @@ auto ThemeRegistry::load_user_themes() -> std::expected<void, std::string>
         return std::unexpected("Error reading user themes directory: " + ec.message());
     }
 
-    return {};
+    return themes;
 }
 
-auto ThemeRegistry::import_theme(const std::filesystem::path& path)
+auto ThemeRegistry::parse_theme_file(const std::filesystem::path& path)
+    -> std::expected<Theme, std::string>
+{
+    const auto ext = path.extension().string();
+    if (ext == ".json")
+    {
+        // Legacy JSON loading
+        return parse_theme_json(path);
+    }
+    if (ext == ".md")
+    {
+        // New Markdown/YAML loading
+        return ThemeLoader::load_from_file(path);
+    }
+    return std::unexpected("Unknown file type: " + path.filename().string());
+}
+
+auto ThemeRegistry::parse_theme_json(const std::filesystem::path& path)
     -> std::expected<Theme, std::string>
 {
     std::ifstream file(path);
@@ -212,6 +322,11 @@ auto ThemeRegistry::import_theme(const std::filesystem::path& path)
         return std::unexpected("Theme validation failed: " + errors.front());
     }
 
+    return theme;
+}
+
+auto ThemeRegistry::register_theme(Theme theme) -> Theme
+{
     // Duplicate handling
     auto existing = std::find_if(
         themes_.begin(), themes_.end(), [&theme](const Theme& t) { return t.id == theme.id; });
@@ -234,6 +349,18 @@ auto ThemeRegistry::import_theme(const std::filesystem::path& path)
     {
         themes_.push_back(theme);
     }
+    return theme;
+}
+
+auto ThemeRegistry::import_theme(const std::filesystem::path& path)
+    -> std::expected<Theme, std::string>
+{
+    auto parsed = parse_theme_json(path);
+    if (!parsed)
+    {
+        return std::unexpected(parsed.error());
+    }
+    auto theme = register_theme(std::move(*parsed));
 
     // Persist to user themes directory
     auto persist_result = persist_theme(theme);
@@ -281,20 +408,40 @@ auto ThemeRegistry::delete_theme(const std::string& id) -> std::expected<void, s
 
     auto it =
         std::find_if(themes_.begin(), themes_.end(), [&id](const Theme& t) { return t.id == id; });
-    if (it == themes_.end())
+    auto cached = cache_ ? cache_->find(id) : std::nullopt;
+    if (cached && std::find(removed_cached_ids_.begin(), removed_cached_ids_.end(), id) !=
+                      removed_cached_ids_.end())
+    {
+        cached.reset();
+    }
+    if (it == themes_.end() && !cached)
     {
         return std::unexpected("Theme not found: " + id);
     }
 
-    themes_.erase(it);
+    std::vector<std::filesystem::path> files;
+    if (it != themes_.end())
+    {
+        themes_.erase(it);
+        files.push_back(user_themes_directory() / (sanitize_filename(id) + ".theme.json"));
+    }
+    if (cached)
+    {
+        // Also drop the cached copy, or it would reappear from the cache
+        removed_cached_ids_.push_back(id);
+        files.push_back(user_themes_directory() / cache_->source(*cached));
+    }
 
-    // Delete persisted file
-    auto file_path = user_themes_directory() / (sanitize_filename(id) + ".theme.json");
-    std::error_code ec;
-    std::filesystem::remove(file_path, ec);
-    if (ec)
+    // Delete persisted files
+    for (const auto& file_path : files)
     {
-        MARKAMP_LOG_WARN("Could not delete theme file {}: {}", file_path.string(), ec.message());
+        std::error_code ec;
+        std::filesystem::remove(file_path, ec);
+        if (ec)
+        {
+            MARKAMP_LOG_WARN(
+                "Could not delete theme file {}: {}", file_path.string(), ec.message());
+        }
     }
 
     MARKAMP_LOG_INFO("ThemeRegistry: deleted theme '{}'", id);
@@ -326,6 +473,11 @@ auto ThemeRegistry::user_themes_directory() -> std::filesystem::path
     return std::filesystem::path("themes");
 }
 
+auto ThemeRegistry::theme_cache_file() -> std::filesystem::path
+{
+    return user_themes_directory().parent_path() / "cache" / "themes.bin";
+}
+
 auto ThemeRegistry::sanitize_filename(const std::string& name) -> std::string
 {
     std::string result;
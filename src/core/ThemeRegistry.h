@@ -1,9 +1,11 @@
 #pragma once
 
 #include "Theme.h"
+#include "ThemeCache.h"
 
 #include <expected>
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -16,9 +18,36 @@ class ThemeRegistry
 public:
     ThemeRegistry();
 
-    /// Load all themes (built-in + user directory).
+    /// Load all themes (built-in + user directory, through the theme cache).
     [[nodiscard]] auto initialize() -> std::expected<void, std::string>;
 
+    /// Load only the built-in themes. Staged startup registers user themes
+    /// later with add_user_themes().
+    void initialize_builtin();
+
+    /// Parse every theme file in `dir` without touching a registry, so it
+    /// can run on a background thread. Invalid files are skipped and logged.
+    [[nodiscard]] static auto scan_user_themes(const std::filesystem::path& dir)
+        -> std::expected<std::vector<Theme>, std::string>;
+
+    /// Register themes returned by scan_user_themes(). Ids clashing with a
+    /// built-in theme are renamed; a user theme with the same id is replaced.
+    void add_user_themes(std::vector<Theme> themes);
+
+    /// Open the compiled cache of the user themes directory (parsing only
+    /// new or changed files). Safe to call off the UI thread.
+    [[nodiscard]] static auto open_user_theme_cache() -> std::expected<ThemeCache, std::string>;
+
+    /// List the themes in `cache` without decoding them; each is decoded by
+    /// get_theme() when it is applied or previewed. Themes already
+    /// registered under the same id take precedence, except that a cached
+    /// theme clashing with a built-in one is registered renamed, as above.
+    void add_cached_themes(std::shared_ptr<const ThemeCache> cache);
+
+    /// Parse one theme file: JSON, or Markdown with YAML frontmatter.
+    [[nodiscard]] static auto parse_theme_file(const std::filesystem::path& path)
+        -> std::expected<Theme, std::string>;
+
     // Query
     [[nodiscard]] auto get_theme(const std::string& id) const -> std::optional<Theme>;
     [[nodiscard]] auto list_themes() const -> std::vector<ThemeInfo>;
@@ -38,13 +67,24 @@ public:
     /// Platform-aware user themes directory.
     [[nodiscard]] static auto user_themes_directory() -> std::filesystem::path;
 
+    /// Compiled theme cache of user_themes_directory().
+    [[nodiscard]] static auto theme_cache_file() -> std::filesystem::path;
+
     /// Sanitize a theme name for use as a filename (lowercase, underscores, no special chars).
     [[nodiscard]] static auto sanitize_filename(const std::string& name) -> std::string;
 
 private:
     std::vector<Theme> themes_;
+    std::shared_ptr<const ThemeCache> cache_;
+    std::vector<std::string> removed_cached_ids_; // Deleted since the cache was opened
     void load_builtin_themes();
-    auto load_user_themes() -> std::expected<void, std::string>;
+    [[nodiscard]] static auto parse_theme_json(const std::filesystem::path& path)
+        -> std::expected<Theme, std::string>;
+    /// Add or replace `theme`; returns it as stored (possibly renamed).
+    auto register_theme(Theme theme) -> Theme;
+    /// Cache index of `id` if it is listed from the cache (not shadowed or deleted).
+    [[nodiscard]] auto find_cached(const std::string& id) const -> std::optional<std::size_t>;
+    [[nodiscard]] auto find_loaded(const std::string& id) const -> bool;
     auto persist_theme(const Theme& theme) -> std::expected<void, std::string>;
     auto generate_unique_id(const std::string& base_id) const -> std::string;
 };
@@ -2,7 +2,9 @@
 
 #include "FileNode.h"
 
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace markamp::core
@@ -126,4 +128,7 @@ struct MarkdownDocument
     [[nodiscard]] auto has_footnotes() const -> bool;
 };
 
+/// Number of whitespace-separated words in `text`.
+[[nodiscard]] auto count_words(std::string_view text) -> std::size_t;
+
 } // namespace markamp::core
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+namespace markamp::core
+{
+
+/// Half-open range [first, last) of cell indices.
+struct CellRange
+{
+    std::size_t first{0};
+    std::size_t last{0};
+
+    [[nodiscard]] constexpr auto empty() const noexcept -> bool
+    {
+        return first >= last;
+    }
+
+    [[nodiscard]] constexpr auto contains(std::size_t index) const noexcept -> bool
+    {
+        return index >= first && index < last;
+    }
+};
+
+/// Top-left corner of a cell in content coordinates.
+struct CellOrigin
+{
+    int x{0};
+    int y{0};
+};
+
+/// Geometry of a grid of equally sized cells laid out row by row, for views
+/// that create widgets only for the cells inside their viewport. The grid
+/// is surrounded by `padding` and cells are separated by `gap`; all values
+/// are pixels.
+///
+/// Pattern implemented: #13 Viewport virtualization
+struct VirtualGrid
+{
+    int cell_width{1};
+    int cell_height{1};
+    int gap{0};
+    int padding{0};
+
+    /// Columns that fit in `viewport_width` (always at least one).
+    [[nodiscard]] constexpr auto columns(int viewport_width) const noexcept -> int
+    {
+        const int available = viewport_width - padding * 2;
+        return std::max(1, (available + gap) / (cell_width + gap));
+    }
+
+    [[nodiscard]] static constexpr auto rows(std::size_t count, int columns) noexcept
+        -> std::size_t
+    {
+        const auto per_row = static_cast<std::size_t>(std::max(1, columns));
+        return (count + per_row - 1) / per_row;
+    }
+
+    /// Height of the whole grid including padding, for the scroll extent.
+    [[nodiscard]] constexpr auto content_height(std::size_t count, int columns) const noexcept
+        -> int
+    {
+        const auto row_count = static_cast<int>(rows(count, columns));
+        if (row_count == 0)
+        {
+            return padding * 2;
+        }
+        return padding * 2 + row_count * cell_height + (row_count - 1) * gap;
+    }
+
+    [[nodiscard]] constexpr auto origin(std::size_t index, int columns) const noexcept
+        -> CellOrigin
+    {
+        const auto per_row = static_cast<std::size_t>(std::max(1, columns));
+        const auto row = static_cast<int>(index / per_row);
+        const auto column = static_cast<int>(index % per_row);
+        return {padding + column * (cell_width + gap), padding + row * (cell_height + gap)};
+    }
+
+    /// Cells of the rows intersecting [scroll_y, scroll_y + viewport_height),
+    /// widened by `overscan_rows` on each side so a short scroll finds the
+    /// next row already built.
+    [[nodiscard]] constexpr auto visible(std::size_t count,
+                                         int columns,
+                                         int scroll_y,
+                                         int viewport_height,
+                                         int overscan_rows = 1) const noexcept -> CellRange
+    {
+        if (count == 0 || viewport_height <= 0)
+        {
+            return {};
+        }
+        const int pitch = cell_height + gap;
+        const int top = std::max(0, scroll_y - padding);
+        const int bottom = std::max(0, scroll_y + viewport_height - padding);
+        const int first_row = std::max(0, top / pitch - overscan_rows);
+        const int last_row = (bottom + pitch - 1) / pitch + overscan_rows;
+
+        const auto per_row = static_cast<std::size_t>(std::max(1, columns));
+        const auto first = std::min(count, static_cast<std::size_t>(first_row) * per_row);
+        const auto last = std::min(count, static_cast<std::size_t>(last_row) * per_row);
+        return {first, last};
+    }
+};
+
+} // namespace markamp::core
@@ -0,0 +1,365 @@
+#include "WorkspaceScanner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <numeric>
+#include <system_error>
+#include <utility>
+
+namespace markamp::core
+{
+
+namespace
+{
+
+auto lowercase(const std::string& text) -> std::string
+{
+    std::string lower = text;
+    std::transform(lower.begin(),
+                   lower.end(),
+                   lower.begin(),
+                   [](unsigned char chr) { return static_cast<char>(std::tolower(chr)); });
+    return lower;
+}
+
+} // anonymous namespace
+
+auto list_directory(const std::filesystem::path& directory) -> DirectoryListing
+{
+    namespace fs = std::filesystem;
+
+    DirectoryListing listing;
+    listing.path = directory.string();
+
+    std::error_code error;
+    fs::directory_iterator iter(directory, fs::directory_options::skip_permission_denied, error);
+    std::vector<FileNode> nodes;
+    for (const fs::directory_iterator end; !error && iter != end; iter.increment(error))
+    {
+        const auto& entry = *iter;
+        std::string name = entry.path().filename().string();
+
+        // Skip hidden files/folders (starting with dot)
+        if (name.empty() || name[0] == '.')
+        {
+            continue;
+        }
+
+        std::error_code type_error;
+        FileNode node;
+        if (entry.is_directory(type_error))
+        {
+            node.type = FileNodeType::Folder;
+            node.children_loaded = false;
+        }
+        else if (entry.is_regular_file(type_error))
+        {
+            node.type = FileNodeType::File;
+        }
+        else
+        {
+            continue;
+        }
+        node.id = entry.path().string();
+        node.name = std::move(name);
+        nodes.push_back(std::move(node));
+    }
+
+    // Folders first, then files, both case-insensitively; keys computed once
+    std::vector<std::string> keys;
+    keys.reserve(nodes.size());
+    for (const auto& node : nodes)
+    {
+        keys.push_back(lowercase(node.name));
+    }
+    std::vector<std::size_t> order(nodes.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::sort(order.begin(),
+              order.end(),
+              [&nodes, &keys](std::size_t left, std::size_t right)
+              {
+                  if (nodes[left].is_folder() != nodes[right].is_folder())
+                  {
+                      return nodes[left].is_folder();
+                  }
+                  return keys[left] < keys[right];
+              });
+
+    listing.children.reserve(nodes.size());
+    for (const auto index : order)
+    {
+        listing.children.push_back(std::move(nodes[index]));
+    }
+    return listing;
+}
+
+// ═══════════════════════════════════════════════════════
+// WorkspaceScanner
+// ═══════════════════════════════════════════════════════
+
+WorkspaceScanner::WorkspaceScanner(std::size_t worker_count)
+{
+    if (worker_count == 0)
+    {
+        worker_count = std::max(1U, std::thread::hardware_concurrency());
+    }
+    queues_.reserve(worker_count);
+    for (std::size_t index = 0; index < worker_count; ++index)
+    {
+        queues_.push_back(std::make_unique<TaskQueue>());
+    }
+    workers_.reserve(worker_count);
+    for (std::size_t index = 0; index < worker_count; ++index)
+    {
+        workers_.emplace_back([this, index]() { worker_loop(index); });
+    }
+}
+
+WorkspaceScanner::~WorkspaceScanner()
+{
+    cancel();
+    {
+        const std::lock_guard lock(wake_mutex_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_all();
+    for (auto& worker : workers_)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+}
+
+void WorkspaceScanner::scan(const std::filesystem::path& root,
+                            BatchCallback on_batch,
+                            CompleteCallback on_complete,
+                            std::size_t prefetch_depth)
+{
+    cancel();
+
+    auto job = std::make_shared<Job>();
+    job->on_batch = std::move(on_batch);
+    job->on_complete = std::move(on_complete);
+    job->outstanding.store(1, std::memory_order_relaxed);
+    {
+        const std::lock_guard lock(job_mutex_);
+        job_ = job;
+    }
+    push(priority_queue_, Task{std::move(job), root, prefetch_depth});
+}
+
+void WorkspaceScanner::expand(const std::string& folder)
+{
+    push_priority(folder, 1);
+}
+
+void WorkspaceScanner::refresh(const std::string& folder)
+{
+    push_priority(folder, 0);
+}
+
+void WorkspaceScanner::push_priority(const std::string& folder, std::size_t depth)
+{
+    std::shared_ptr<Job> job;
+    {
+        const std::lock_guard lock(job_mutex_);
+        job = job_;
+    }
+    if (!job)
+    {
+        return;
+    }
+    job->outstanding.fetch_add(1, std::memory_order_acq_rel);
+    push(priority_queue_, Task{std::move(job), folder, depth});
+}
+
+void WorkspaceScanner::cancel()
+{
+    std::shared_ptr<Job> job;
+    {
+        const std::lock_guard lock(job_mutex_);
+        job = std::exchange(job_, nullptr);
+    }
+    if (!job)
+    {
+        return;
+    }
+    {
+        // Waits out a delivery in progress; later ones see the flag
+        const std::lock_guard lock(job->deliver_mutex);
+        job->cancelled.store(true, std::memory_order_release);
+    }
+
+    // Drop queued work (workers skip cancelled tasks anyway)
+    auto drain = [this](TaskQueue& queue)
+    {
+        const std::lock_guard lock(queue.mutex);
+        queued_.fetch_sub(queue.tasks.size(), std::memory_order_acq_rel);
+        queue.tasks.clear();
+    };
+    drain(priority_queue_);
+    for (auto& queue : queues_)
+    {
+        drain(*queue);
+    }
+}
+
+auto WorkspaceScanner::is_scanning() const -> bool
+{
+    const std::lock_guard lock(job_mutex_);
+    return job_ && job_->outstanding.load(std::memory_order_acquire) > 0;
+}
+
+void WorkspaceScanner::push(TaskQueue& queue, Task task)
+{
+    {
+        const std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    queued_.fetch_add(1, std::memory_order_acq_rel);
+    {
+        // Pairs with the predicate check in worker_loop(): no lost wake-up
+        const std::lock_guard lock(wake_mutex_);
+    }
+    wake_cv_.notify_one();
+}
+
+auto WorkspaceScanner::take_task(std::size_t index, Task& out) -> bool
+{
+    auto take = [this, &out](TaskQueue& queue, bool newest) -> bool
+    {
+        const std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            return false;
+        }
+        if (newest)
+        {
+            out = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            out = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        queued_.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    };
+
+    if (take(priority_queue_, false) || take(*queues_[index], true))
+    {
+        return true;
+    }
+    for (std::size_t offset = 1; offset < queues_.size(); ++offset)
+    {
+        if (take(*queues_[(index + offset) % queues_.size()], false))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkspaceScanner::worker_loop(std::size_t index)
+{
+    PendingBatch batch;
+    while (true)
+    {
+        Task task;
+        if (take_task(index, task))
+        {
+            if (batch.job && batch.job != task.job)
+            {
+                flush(batch);
+            }
+            process(task, index, batch);
+            if (batch.entries >= kBatchEntries ||
+                std::chrono::steady_clock::now() - batch.started >= kBatchInterval)
+            {
+                flush(batch);
+            }
+            continue;
+        }
+
+        // Out of work: hand over what we have before sleeping
+        flush(batch);
+        std::unique_lock lock(wake_mutex_);
+        wake_cv_.wait(lock,
+                      [this]
+                      { return stopping_ || queued_.load(std::memory_order_acquire) > 0; });
+        if (stopping_)
+        {
+            return;
+        }
+    }
+}
+
+void WorkspaceScanner::process(Task& task, std::size_t index, PendingBatch& batch)
+{
+    if (!batch.job)
+    {
+        batch.job = task.job;
+        batch.started = std::chrono::steady_clock::now();
+    }
+    ++batch.tasks_done;
+    if (task.job->cancelled.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    auto listing = list_directory(task.directory);
+    if (task.depth > 0)
+    {
+        for (const auto& child : listing.children)
+        {
+            if (child.is_folder())
+            {
+                task.job->outstanding.fetch_add(1, std::memory_order_acq_rel);
+                push(*queues_[index], Task{task.job, child.id, task.depth - 1});
+            }
+        }
+    }
+    batch.entries += listing.children.size();
+    batch.listings.push_back(std::move(listing));
+}
+
+void WorkspaceScanner::flush(PendingBatch& batch)
+{
+    if (!batch.job)
+    {
+        return;
+    }
+    auto job = std::move(batch.job);
+    const std::size_t done = batch.tasks_done;
+    const std::size_t entries = batch.entries;
+    auto listings = std::move(batch.listings);
+    batch = PendingBatch{};
+
+    if (!listings.empty())
+    {
+        const std::lock_guard lock(job->deliver_mutex);
+        if (!job->cancelled.load(std::memory_order_acquire))
+        {
+            job->entries.fetch_add(entries, std::memory_order_relaxed);
+            if (job->on_batch)
+            {
+                job->on_batch(std::move(listings));
+            }
+        }
+    }
+
+    // Counted down only after delivery, so the last one out sees every batch
+    if (job->outstanding.fetch_sub(done, std::memory_order_acq_rel) == done)
+    {
+        const std::lock_guard lock(job->deliver_mutex);
+        if (!job->cancelled.load(std::memory_order_acquire) && job->on_complete)
+        {
+            job->on_complete(job->entries.load(std::memory_order_relaxed));
+        }
+    }
+}
+
+} // namespace markamp::core
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "FileNode.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace markamp::core
+{
+
+/// List one directory: non-hidden folders and regular files, sorted the way
+/// the file tree shows them. Folders come back with children_loaded false.
+/// Unreadable directories and entries are skipped.
+[[nodiscard]] auto list_directory(const std::filesystem::path& directory) -> DirectoryListing;
+
+/// Walks a workspace on a work-stealing thread pool.
+///
+/// scan() lists the root and every folder up to `prefetch_depth` levels
+/// below it; deeper folders are listed only when expand() asks for them
+/// (when the user opens them), together with one more level so the next
+/// expansion is usually already there. Each worker keeps a deque of
+/// directories: it takes its own newest task (depth-first, which keeps a
+/// subtree on one thread) and steals the oldest task of another worker
+/// when it runs dry. expand() requests jump ahead of queued work.
+///
+/// Listings are delivered in batches of whole directories, from pool
+/// threads but never concurrently, once a worker has gathered
+/// kBatchEntries entries, kBatchInterval has passed, or it runs out of
+/// work. Batches from different workers are not ordered, so a folder's
+/// listing may arrive before its parent's (see HeldListings). The complete
+/// callback runs after the last batch each time the queue drains (again
+/// after later expand() work).
+///
+/// Pattern implemented: #18 Predictable I/O never on the hot path
+class WorkspaceScanner
+{
+public:
+    using BatchCallback = std::function<void(std::vector<DirectoryListing> listings)>;
+    using CompleteCallback = std::function<void(std::size_t entries)>;
+
+    static constexpr std::size_t kDefaultPrefetchDepth = 2;
+    static constexpr std::size_t kBatchEntries = 2048;
+    static constexpr std::chrono::milliseconds kBatchInterval{50};
+
+    /// `worker_count` 0 uses one worker per hardware thread.
+    explicit WorkspaceScanner(std::size_t worker_count = 0);
+    ~WorkspaceScanner();
+
+    // Non-copyable, non-movable
+    WorkspaceScanner(const WorkspaceScanner&) = delete;
+    auto operator=(const WorkspaceScanner&) -> WorkspaceScanner& = delete;
+    WorkspaceScanner(WorkspaceScanner&&) = delete;
+    auto operator=(WorkspaceScanner&&) -> WorkspaceScanner& = delete;
+
+    /// Start scanning `root`, cancelling any previous scan. The root's own
+    /// listing has path == root.string().
+    void scan(const std::filesystem::path& root,
+              BatchCallback on_batch,
+              CompleteCallback on_complete,
+              std::size_t prefetch_depth = kDefaultPrefetchDepth);
+
+    /// List `folder` (and the level below it) ahead of other work. Ignored
+    /// when no scan was started.
+    void expand(const std::string& folder);
+
+    /// List `folder` again ahead of other work, e.g. after a change on disk,
+    /// without the level below. Ignored when no scan was started.
+    void refresh(const std::string& folder);
+
+    /// Stop the current scan. No callback of it runs after this returns;
+    /// must not be called from a callback.
+    void cancel();
+
+    /// True while the current scan has directories queued or undelivered.
+    [[nodiscard]] auto is_scanning() const -> bool;
+
+private:
+    struct Job
+    {
+        BatchCallback on_batch;
+        CompleteCallback on_complete;
+        std::mutex deliver_mutex; // Serializes callbacks and cancel()
+        std::atomic<bool> cancelled{false};
+        std::atomic<std::size_t> outstanding{0}; // Queued or not yet delivered
+        std::atomic<std::size_t> entries{0};
+    };
+
+    struct Task
+    {
+        std::shared_ptr<Job> job;
+        std::filesystem::path directory;
+        std::size_t depth{0}; // Levels still to prefetch below `directory`
+    };
+
+    struct TaskQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    /// A worker's listings not yet handed to the job's callback.
+    struct PendingBatch
+    {
+        std::shared_ptr<Job> job;
+        std::vector<DirectoryListing> listings;
+        std::size_t entries{0};
+        std::size_t tasks_done{0};
+        std::chrono::steady_clock::time_point started{};
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues_; // One per worker
+    TaskQueue priority_queue_;                       // expand() and scan() roots
+    std::atomic<std::size_t> queued_{0};             // Tasks in all queues
+
+    std::vector<std::thread> workers_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    bool stopping_{false}; // GUARDED_BY(wake_mutex_)
+
+    mutable std::mutex job_mutex_;
+    std::shared_ptr<Job> job_; // GUARDED_BY(job_mutex_)
+
+    void worker_loop(std::size_t index);
+    void push(TaskQueue& queue, Task task);
+    void push_priority(const std::string& folder, std::size_t depth);
+    [[nodiscard]] auto take_task(std::size_t index, Task& out) -> bool;
+    void process(Task& task, std::size_t index, PendingBatch& batch);
+    static void flush(PendingBatch& batch);
+};
+
+} // namespace markamp::core
@@ -0,0 +1,1134 @@
+#include "WorkspaceSearchService.h"
+
+#include "Logger.h"
+#include "SearchPattern.h"
+#include "WorkspaceScanner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <unordered_set>
+#include <utility>
+
+namespace markamp::core
+{
+
+namespace
+{
+
+constexpr uint32_t kIndexMagic = 0x5357414D; // "MAWS"
+constexpr uint32_t kIndexVersion = 1;
+constexpr std::size_t kMinCompactDead = 64;
+
+/// ASCII-only lowercase (matches std::tolower in the "C" locale, without
+/// the per-byte locale lookup).
+[[nodiscard]] auto fold(char character) -> char
+{
+    return (character >= 'A' && character <= 'Z') ? static_cast<char>(character - 'A' + 'a')
+                                                   : character;
+}
+
+/// Sorted, unique trigrams of `text` after ASCII case folding. Trigrams
+/// spanning a newline are skipped (a needle never contains one).
+void extract_trigrams(std::string_view text, std::vector<uint32_t>& out)
+{
+    out.clear();
+    if (text.size() < 3)
+    {
+        return;
+    }
+    // One bit per possible trigram: dedupe while scanning, so only the
+    // distinct trigrams (far fewer than positions in real text) get sorted.
+    thread_local std::vector<uint64_t> seen(std::size_t{1} << 18U);
+    auto byte = [&text](std::size_t index) -> uint32_t
+    { return static_cast<unsigned char>(fold(text[index])); };
+    uint32_t window = (byte(0) << 8U) | byte(1);
+    for (std::size_t index = 2; index < text.size(); ++index)
+    {
+        window = ((window << 8U) | byte(index)) & 0xFFFFFFU;
+        if (text[index] == '\n' || text[index - 1] == '\n' || text[index - 2] == '\n')
+        {
+            continue;
+        }
+        auto& word = seen[window >> 6U];
+        const uint64_t bit = uint64_t{1} << (window & 63U);
+        if ((word & bit) == 0)
+        {
+            word |= bit;
+            out.push_back(window);
+        }
+    }
+    for (const auto trigram : out)
+    {
+        seen[trigram >> 6U] = 0;
+    }
+    std::sort(out.begin(), out.end());
+}
+
+/// Size and modification time of a regular file; false if unavailable.
+[[nodiscard]] auto stat_file(const std::string& path, std::uintmax_t& size, std::int64_t& mtime)
+    -> bool
+{
+    std::error_code error;
+    size = std::filesystem::file_size(path, error);
+    if (error)
+    {
+        return false;
+    }
+    const auto time = std::filesystem::last_write_time(path, error);
+    if (error)
+    {
+        return false;
+    }
+    mtime = static_cast<std::int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+[[nodiscard]] auto read_whole_file(const std::string& path, std::string& out) -> bool
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    const auto size = file.tellg();
+    if (size < 0 || static_cast<std::uintmax_t>(size) > WorkspaceSearchService::kMaxFileSize)
+    {
+        return false;
+    }
+    file.seekg(0, std::ios::beg);
+    out.resize(static_cast<std::size_t>(size));
+    file.read(out.data(), size);
+    out.resize(static_cast<std::size_t>(file.gcount()));
+    return true;
+}
+
+void collect_files(const FileNode& node, std::vector<std::string>& paths)
+{
+    if (node.is_file())
+    {
+        paths.push_back(node.id);
+        return;
+    }
+    for (const auto& child : node.children)
+    {
+        collect_files(child, paths);
+    }
+}
+
+/// The non-hidden files and folders under `root`, listed like the file
+/// tree lists them.
+[[nodiscard]] auto list_tree(const std::filesystem::path& root, const CancelToken& cancel)
+    -> FileNode
+{
+    FileNode node;
+    node.id = root.string();
+    node.type = FileNodeType::Folder;
+    node.children = list_directory(root).children;
+    node.children_loaded = true;
+    for (auto& child : node.children)
+    {
+        if (cancel.stop_requested())
+        {
+            break;
+        }
+        if (child.is_folder())
+        {
+            child = list_tree(child.id, cancel);
+        }
+    }
+    return node;
+}
+
+[[nodiscard]] auto is_under(const std::string& path, const std::string& folder) -> bool
+{
+    return path.size() > folder.size() && path.starts_with(folder) &&
+           (path[folder.size()] == '/' || path[folder.size()] == '\\');
+}
+
+// ── Index file encoding ──
+
+void put_u32(std::string& out, uint32_t value)
+{
+    char bytes[4];
+    std::memcpy(bytes, &value, sizeof(bytes));
+    out.append(bytes, sizeof(bytes));
+}
+
+void put_u64(std::string& out, uint64_t value)
+{
+    char bytes[8];
+    std::memcpy(bytes, &value, sizeof(bytes));
+    out.append(bytes, sizeof(bytes));
+}
+
+void put_varint(std::string& out, uint32_t value)
+{
+    while (value >= 0x80U)
+    {
+        out += static_cast<char>((value & 0x7FU) | 0x80U);
+        value >>= 7U;
+    }
+    out += static_cast<char>(value);
+}
+
+/// Bounds-checked reader over a loaded index file.
+class IndexReader
+{
+public:
+    explicit IndexReader(std::string_view data)
+        : data_(data)
+    {
+    }
+
+    [[nodiscard]] auto u32(uint32_t& value) -> bool
+    {
+        return fixed(&value, sizeof(value));
+    }
+
+    [[nodiscard]] auto u64(uint64_t& value) -> bool
+    {
+        return fixed(&value, sizeof(value));
+    }
+
+    [[nodiscard]] auto varint(uint32_t& value) -> bool
+    {
+        value = 0;
+        for (unsigned shift = 0; shift < 35; shift += 7)
+        {
+            if (pos_ >= data_.size())
+            {
+                return false;
+            }
+            const auto byte = static_cast<unsigned char>(data_[pos_++]);
+            value |= static_cast<uint32_t>(byte & 0x7FU) << shift;
+            if ((byte & 0x80U) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] auto bytes(std::size_t count, std::string& out) -> bool
+    {
+        if (count > data_.size() - pos_)
+        {
+            return false;
+        }
+        out.assign(data_.substr(pos_, count));
+        pos_ += count;
+        return true;
+    }
+
+    [[nodiscard]] auto at_end() const -> bool
+    {
+        return pos_ == data_.size();
+    }
+
+private:
+    std::string_view data_;
+    std::size_t pos_{0};
+
+    auto fixed(void* value, std::size_t size) -> bool
+    {
+        if (size > data_.size() - pos_)
+        {
+            return false;
+        }
+        std::memcpy(value, data_.data() + pos_, size);
+        pos_ += size;
+        return true;
+    }
+};
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Worker pool
+// ═══════════════════════════════════════════════════════
+
+WorkspaceSearchService::WorkspaceSearchService(std::size_t worker_count)
+{
+    if (worker_count == 0)
+    {
+        worker_count = std::max(1U, std::thread::hardware_concurrency());
+    }
+    // The thread calling run_parallel() is one of the workers
+    workers_.reserve(worker_count - 1);
+    for (std::size_t index = 1; index < worker_count; ++index)
+    {
+        workers_.emplace_back([this] { worker_loop(); });
+    }
+}
+
+WorkspaceSearchService::~WorkspaceSearchService()
+{
+    stop_tracking();
+    cancel();
+    {
+        std::lock_guard lock(pool_mutex_);
+        pool_stopping_ = true;
+    }
+    pool_cv_.notify_all();
+    for (auto& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+void WorkspaceSearchService::worker_loop()
+{
+    uint64_t seen_generation = 0;
+    while (true)
+    {
+        const std::function<void()>* task = nullptr;
+        {
+            std::unique_lock lock(pool_mutex_);
+            pool_cv_.wait(lock,
+                          [this, seen_generation]
+                          { return pool_stopping_ || pool_generation_ != seen_generation; });
+            if (pool_stopping_)
+            {
+                return;
+            }
+            seen_generation = pool_generation_;
+            task = pool_task_;
+        }
+
+        (*task)();
+
+        std::lock_guard lock(pool_mutex_);
+        if (--pool_active_ == 0)
+        {
+            pool_done_cv_.notify_all();
+        }
+    }
+}
+
+void WorkspaceSearchService::run_parallel(const std::function<void()>& task)
+{
+    std::lock_guard job_lock(job_mutex_);
+    {
+        std::lock_guard lock(pool_mutex_);
+        pool_task_ = &task;
+        pool_active_ = workers_.size();
+        ++pool_generation_;
+    }
+    pool_cv_.notify_all();
+
+    task();
+
+    std::unique_lock lock(pool_mutex_);
+    pool_done_cv_.wait(lock, [this] { return pool_active_ == 0; });
+    pool_task_ = nullptr;
+}
+
+// ═══════════════════════════════════════════════════════
+// Indexing
+// ═══════════════════════════════════════════════════════
+
+auto WorkspaceSearchService::index_file(const std::string& path, IndexedFile& out) -> bool
+{
+    out.path.clear();
+    std::string content;
+    if (!stat_file(path, out.size, out.mtime) || out.size > kMaxFileSize ||
+        !read_whole_file(path, content))
+    {
+        return false;
+    }
+    extract_trigrams(content, out.trigrams);
+    out.path = path;
+    return true;
+}
+
+auto WorkspaceSearchService::index_tree(const FileNode& root, const CancelToken* cancel)
+    -> std::size_t
+{
+    std::vector<std::string> paths;
+    collect_files(root, paths);
+    const std::unordered_set<std::string> in_tree(paths.begin(), paths.end());
+
+    // Stat outside the lock: searches keep running meanwhile
+    struct Stamp
+    {
+        std::uintmax_t size{0};
+        std::int64_t mtime{0};
+        bool ok{false};
+    };
+    std::vector<Stamp> stamps(paths.size());
+    for (std::size_t index = 0; index < paths.size(); ++index)
+    {
+        auto& stamp = stamps[index];
+        stamp.ok = stat_file(paths[index], stamp.size, stamp.mtime);
+    }
+
+    std::vector<std::string> stale;
+    {
+        std::unique_lock lock(index_mutex_);
+        std::vector<std::string> removed;
+        for (const auto& [path, file_id] : file_ids_)
+        {
+            if (!in_tree.contains(path))
+            {
+                removed.push_back(path);
+            }
+        }
+        for (const auto& path : removed)
+        {
+            remove_locked(path);
+        }
+
+        for (std::size_t index = 0; index < paths.size(); ++index)
+        {
+            const auto& stamp = stamps[index];
+            auto found = file_ids_.find(paths[index]);
+            if (!stamp.ok)
+            {
+                if (found != file_ids_.end())
+                {
+                    remove_locked(paths[index]);
+                }
+                continue;
+            }
+            if (found == file_ids_.end() || files_[found->second].size != stamp.size ||
+                files_[found->second].mtime != stamp.mtime)
+            {
+                stale.push_back(paths[index]);
+            }
+        }
+    }
+
+    // Read in batches so only one batch of trigram lists is held at a time
+    std::size_t read = 0;
+    std::vector<IndexedFile> batch;
+    for (std::size_t first = 0; first < stale.size(); first += kIndexBatchSize)
+    {
+        if (cancel != nullptr && cancel->stop_requested())
+        {
+            break;
+        }
+        const auto count = std::min(kIndexBatchSize, stale.size() - first);
+        batch.resize(count);
+        std::atomic<std::size_t> next{0};
+        run_parallel(
+            [&]
+            {
+                for (auto index = next.fetch_add(1); index < count; index = next.fetch_add(1))
+                {
+                    if (!index_file(stale[first + index], batch[index]))
+                    {
+                        MARKAMP_LOG_DEBUG("Workspace search: cannot index {}",
+                                          stale[first + index]);
+                    }
+                }
+            });
+
+        std::unique_lock lock(index_mutex_);
+        read += static_cast<std::size_t>(std::count_if(batch.begin(),
+                                                       batch.end(),
+                                                       [](const IndexedFile& file)
+                                                       { return !file.path.empty(); }));
+        merge_locked(batch);
+    }
+
+    std::unique_lock lock(index_mutex_);
+    maybe_compact_locked();
+    return read;
+}
+
+void WorkspaceSearchService::on_file_changed(const std::string& path)
+{
+    std::vector<IndexedFile> batch(1);
+    const bool indexed = index_file(path, batch.front());
+
+    std::unique_lock lock(index_mutex_);
+    if (indexed)
+    {
+        merge_locked(batch);
+    }
+    else
+    {
+        remove_locked(path);
+    }
+    maybe_compact_locked();
+}
+
+void WorkspaceSearchService::on_file_removed(const std::string& path)
+{
+    std::unique_lock lock(index_mutex_);
+    remove_locked(path);
+    maybe_compact_locked();
+}
+
+// ═══════════════════════════════════════════════════════
+// Workspace tracking
+// ═══════════════════════════════════════════════════════
+
+void WorkspaceSearchService::track_workspace(const std::filesystem::path& root,
+                                             std::filesystem::path index_path)
+{
+    stop_tracking();
+    {
+        std::lock_guard lock(track_mutex_);
+        track_root_ = root.string();
+        track_changes_.clear();
+        track_stopping_ = false;
+    }
+    track_cancel_ = CancelToken{};
+    track_index_path_ = index_path;
+    track_thread_ = std::thread(
+        [this, root, index_path = std::move(index_path)] { track_loop(root, index_path); });
+}
+
+void WorkspaceSearchService::apply_changes(const std::vector<FileChange>& changes)
+{
+    {
+        std::lock_guard lock(track_mutex_);
+        if (track_root_.empty())
+        {
+            return;
+        }
+        for (const auto& change : changes)
+        {
+            // Hidden entries are not in the tree the index was built from
+            const bool hidden =
+                change.kind != FileChangeKind::Renamed &&
+                std::filesystem::path(change.path).filename().string().starts_with('.');
+            if (!hidden && (is_under(change.path, track_root_) ||
+                            (!change.old_path.empty() && is_under(change.old_path, track_root_))))
+            {
+                track_changes_.push_back(change);
+            }
+        }
+    }
+    track_cv_.notify_one();
+}
+
+void WorkspaceSearchService::stop_tracking()
+{
+    if (!track_thread_.joinable())
+    {
+        return;
+    }
+    track_cancel_.request_stop();
+    {
+        std::lock_guard lock(track_mutex_);
+        track_stopping_ = true;
+        track_root_.clear();
+    }
+    track_cv_.notify_one();
+    track_thread_.join();
+
+    if (auto saved = save(track_index_path_); !saved)
+    {
+        MARKAMP_LOG_WARN("Workspace search: {}", saved.error());
+    }
+}
+
+void WorkspaceSearchService::track_loop(std::filesystem::path root,
+                                        std::filesystem::path index_path)
+{
+    const auto cancel = track_cancel_;
+    std::error_code error;
+    if (std::filesystem::exists(index_path, error))
+    {
+        if (auto loaded = load(index_path); !loaded)
+        {
+            MARKAMP_LOG_WARN("Workspace search: rebuilding index: {}", loaded.error());
+        }
+    }
+
+    const auto tree = list_tree(root, cancel);
+    if (cancel.stop_requested())
+    {
+        return;
+    }
+    const auto read = index_tree(tree, &cancel);
+    if (cancel.stop_requested())
+    {
+        return;
+    }
+    MARKAMP_LOG_INFO("Workspace search: {} files indexed, {} re-read", file_count(), read);
+    std::filesystem::create_directories(index_path.parent_path(), error);
+    if (auto saved = save(index_path); !saved)
+    {
+        MARKAMP_LOG_WARN("Workspace search: {}", saved.error());
+    }
+
+    std::vector<FileChange> changes;
+    while (true)
+    {
+        {
+            std::unique_lock lock(track_mutex_);
+            track_cv_.wait(lock, [this] { return track_stopping_ || !track_changes_.empty(); });
+            if (track_stopping_)
+            {
+                return;
+            }
+            changes.swap(track_changes_);
+        }
+        for (const auto& change : changes)
+        {
+            if (cancel.stop_requested())
+            {
+                return;
+            }
+            apply_change(change);
+        }
+        changes.clear();
+    }
+}
+
+void WorkspaceSearchService::apply_change(const FileChange& change)
+{
+    if (change.kind == FileChangeKind::Deleted || change.kind == FileChangeKind::Renamed)
+    {
+        const auto& gone =
+            change.kind == FileChangeKind::Renamed ? change.old_path : change.path;
+        std::unique_lock lock(index_mutex_);
+        if (change.is_directory)
+        {
+            remove_folder_locked(gone);
+        }
+        else
+        {
+            remove_locked(gone);
+        }
+        maybe_compact_locked();
+        if (change.kind == FileChangeKind::Deleted)
+        {
+            return;
+        }
+    }
+
+    if (!change.is_directory)
+    {
+        on_file_changed(change.path);
+        return;
+    }
+    if (change.kind != FileChangeKind::Modified)
+    {
+        // A folder created or moved in: index what it holds
+        std::vector<std::string> paths;
+        collect_files(list_tree(change.path, track_cancel_), paths);
+        for (const auto& path : paths)
+        {
+            on_file_changed(path);
+        }
+    }
+}
+
+void WorkspaceSearchService::merge_locked(std::vector<IndexedFile>& batch)
+{
+    for (auto& file : batch)
+    {
+        if (file.path.empty())
+        {
+            continue;
+        }
+        remove_locked(file.path);
+        const auto file_id = static_cast<uint32_t>(files_.size());
+        file_ids_.emplace(file.path, file_id);
+        for (const auto trigram : file.trigrams)
+        {
+            postings_[trigram].push_back(file_id); // Ids only grow: lists stay sorted
+        }
+        files_.push_back({std::move(file.path), file.size, file.mtime, true});
+        file.trigrams.clear();
+    }
+}
+
+void WorkspaceSearchService::remove_locked(const std::string& path)
+{
+    auto found = file_ids_.find(path);
+    if (found == file_ids_.end())
+    {
+        return;
+    }
+    files_[found->second].live = false;
+    file_ids_.erase(found);
+    ++dead_files_;
+}
+
+void WorkspaceSearchService::remove_folder_locked(const std::string& folder)
+{
+    std::vector<std::string> removed;
+    for (const auto& [path, file_id] : file_ids_)
+    {
+        if (is_under(path, folder))
+        {
+            removed.push_back(path);
+        }
+    }
+    for (const auto& path : removed)
+    {
+        remove_locked(path);
+    }
+}
+
+void WorkspaceSearchService::maybe_compact_locked()
+{
+    if (dead_files_ < kMinCompactDead || dead_files_ < file_ids_.size())
+    {
+        return;
+    }
+
+    constexpr auto kDropped = static_cast<uint32_t>(-1);
+    std::vector<uint32_t> remap(files_.size(), kDropped);
+    std::vector<FileEntry> live_files;
+    live_files.reserve(file_ids_.size());
+    for (std::size_t file_id = 0; file_id < files_.size(); ++file_id)
+    {
+        if (files_[file_id].live)
+        {
+            remap[file_id] = static_cast<uint32_t>(live_files.size());
+            live_files.push_back(std::move(files_[file_id]));
+        }
+    }
+
+    for (auto it = postings_.begin(); it != postings_.end();)
+    {
+        auto& ids = it->second;
+        std::size_t kept = 0;
+        for (const auto file_id : ids)
+        {
+            if (remap[file_id] != kDropped)
+            {
+                ids[kept++] = remap[file_id];
+            }
+        }
+        ids.resize(kept);
+        it = ids.empty() ? postings_.erase(it) : std::next(it);
+    }
+
+    files_ = std::move(live_files);
+    for (auto& [path, file_id] : file_ids_)
+    {
+        file_id = remap[file_id];
+    }
+    dead_files_ = 0;
+}
+
+auto WorkspaceSearchService::file_count() const -> std::size_t
+{
+    std::shared_lock lock(index_mutex_);
+    return file_ids_.size();
+}
+
+auto WorkspaceSearchService::trigram_count() const -> std::size_t
+{
+    std::shared_lock lock(index_mutex_);
+    return postings_.size();
+}
+
+// ═══════════════════════════════════════════════════════
+// Persistence
+// ═══════════════════════════════════════════════════════
+
+auto WorkspaceSearchService::save(const std::filesystem::path& index_path) const
+    -> std::expected<void, std::string>
+{
+    std::string data;
+    {
+        std::shared_lock lock(index_mutex_);
+
+        // Only live files, renumbered densely
+        std::vector<uint32_t> remap(files_.size(), 0);
+        put_u32(data, kIndexMagic);
+        put_u32(data, kIndexVersion);
+        put_u32(data, static_cast<uint32_t>(file_ids_.size()));
+        uint32_t next_id = 0;
+        for (std::size_t file_id = 0; file_id < files_.size(); ++file_id)
+        {
+            const auto& file = files_[file_id];
+            if (!file.live)
+            {
+                continue;
+            }
+            remap[file_id] = next_id++;
+            put_u32(data, static_cast<uint32_t>(file.path.size()));
+            data += file.path;
+            put_u64(data, static_cast<uint64_t>(file.size));
+            put_u64(data, static_cast<uint64_t>(file.mtime));
+        }
+
+        std::vector<uint32_t> trigrams;
+        trigrams.reserve(postings_.size());
+        for (const auto& [trigram, ids] : postings_)
+        {
+            trigrams.push_back(trigram);
+        }
+        std::sort(trigrams.begin(), trigrams.end());
+
+        const auto count_at = data.size();
+        put_u32(data, 0);
+        uint32_t written = 0;
+        std::vector<uint32_t> live_ids;
+        for (const auto trigram : trigrams)
+        {
+            live_ids.clear();
+            for (const auto file_id : postings_.at(trigram))
+            {
+                if (files_[file_id].live)
+                {
+                    live_ids.push_back(remap[file_id]);
+                }
+            }
+            if (live_ids.empty())
+            {
+                continue;
+            }
+            put_u32(data, trigram);
+            put_varint(data, static_cast<uint32_t>(live_ids.size()));
+            uint32_t previous = 0;
+            for (const auto file_id : live_ids)
+            {
+                put_varint(data, file_id - previous); // Ascending: store gaps
+                previous = file_id;
+            }
+            ++written;
+        }
+        std::memcpy(data.data() + count_at, &written, sizeof(written));
+    }
+
+    auto temp_path = index_path;
+    temp_path += ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            return std::unexpected("Cannot write search index: " + temp_path.string());
+        }
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out.good())
+        {
+            return std::unexpected("Failed writing search index: " + temp_path.string());
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temp_path, index_path, error);
+    if (error)
+    {
+        std::filesystem::remove(temp_path, error);
+        return std::unexpected("Cannot replace search index: " + index_path.string());
+    }
+    return {};
+}
+
+auto WorkspaceSearchService::load(const std::filesystem::path& index_path)
+    -> std::expected<void, std::string>
+{
+    std::string data;
+    {
+        std::ifstream in(index_path, std::ios::binary);
+        if (!in.is_open())
+        {
+            std::unique_lock lock(index_mutex_);
+            files_.clear();
+            file_ids_.clear();
+            postings_.clear();
+            dead_files_ = 0;
+            return std::unexpected("Cannot open search index: " + index_path.string());
+        }
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    std::vector<FileEntry> files;
+    std::unordered_map<std::string, uint32_t> file_ids;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+    auto parse = [&]() -> std::expected<void, std::string>
+    {
+        IndexReader reader(data);
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint32_t file_total = 0;
+        if (!reader.u32(magic) || magic != kIndexMagic)
+        {
+            return std::unexpected("Not a workspace search index: " + index_path.string());
+        }
+        if (!reader.u32(version) || version != kIndexVersion)
+        {
+            return std::unexpected("Unsupported search index version: " + index_path.string());
+        }
+        const std::string truncated = "Search index is truncated: " + index_path.string();
+        if (!reader.u32(file_total) || file_total > data.size())
+        {
+            return std::unexpected(truncated);
+        }
+
+        files.resize(file_total);
+        for (uint32_t file_id = 0; file_id < file_total; ++file_id)
+        {
+            auto& file = files[file_id];
+            uint32_t path_length = 0;
+            uint64_t size = 0;
+            uint64_t mtime = 0;
+            if (!reader.u32(path_length) || !reader.bytes(path_length, file.path) ||
+                !reader.u64(size) || !reader.u64(mtime))
+            {
+                return std::unexpected(truncated);
+            }
+            file.size = size;
+            file.mtime = static_cast<std::int64_t>(mtime);
+            if (!file_ids.emplace(file.path, file_id).second)
+            {
+                return std::unexpected("Search index lists a file twice: " + file.path);
+            }
+        }
+
+        uint32_t trigram_total = 0;
+        if (!reader.u32(trigram_total))
+        {
+            return std::unexpected(truncated);
+        }
+        for (uint32_t index = 0; index < trigram_total; ++index)
+        {
+            uint32_t trigram = 0;
+            uint32_t id_count = 0;
+            if (!reader.u32(trigram) || !reader.varint(id_count) || id_count > file_total)
+            {
+                return std::unexpected(truncated);
+            }
+            auto& ids = postings[trigram];
+            ids.reserve(id_count);
+            uint32_t file_id = 0;
+            for (uint32_t entry = 0; entry < id_count; ++entry)
+            {
+                uint32_t gap = 0;
+                if (!reader.varint(gap) || (entry > 0 && gap == 0) || gap >= file_total - file_id)
+                {
+                    return std::unexpected("Search index is corrupt: " + index_path.string());
+                }
+                file_id += gap;
+                ids.push_back(file_id);
+            }
+        }
+        if (!reader.at_end())
+        {
+            return std::unexpected("Search index is corrupt: " + index_path.string());
+        }
+        return {};
+    };
+
+    auto parsed = parse();
+    if (!parsed)
+    {
+        files.clear();
+        file_ids.clear();
+        postings.clear();
+    }
+
+    std::unique_lock lock(index_mutex_);
+    files_ = std::move(files);
+    file_ids_ = std::move(file_ids);
+    postings_ = std::move(postings);
+    dead_files_ = 0;
+    return parsed;
+}
+
+// ═══════════════════════════════════════════════════════
+// Searching
+// ═══════════════════════════════════════════════════════
+
+auto WorkspaceSearchService::candidates_locked(const SearchConfig& config) const
+    -> std::vector<uint32_t>
+{
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> trigrams;
+    if (!config.use_regex)
+    {
+        extract_trigrams(config.needle, trigrams);
+    }
+    if (trigrams.empty())
+    {
+        for (std::size_t file_id = 0; file_id < files_.size(); ++file_id)
+        {
+            if (files_[file_id].live)
+            {
+                candidates.push_back(static_cast<uint32_t>(file_id));
+            }
+        }
+        return candidates;
+    }
+
+    std::vector<const std::vector<uint32_t>*> lists;
+    lists.reserve(trigrams.size());
+    for (const auto trigram : trigrams)
+    {
+        auto found = postings_.find(trigram);
+        if (found == postings_.end())
+        {
+            return candidates;
+        }
+        lists.push_back(&found->second);
+    }
+    // Shortest lists first keep the running intersection small
+    std::sort(lists.begin(),
+              lists.end(),
+              [](const auto* lhs, const auto* rhs) { return lhs->size() < rhs->size(); });
+
+    for (const auto file_id : *lists.front())
+    {
+        if (files_[file_id].live)
+        {
+            candidates.push_back(file_id);
+        }
+    }
+    std::vector<uint32_t> narrowed;
+    for (std::size_t index = 1; index < lists.size() && !candidates.empty(); ++index)
+    {
+        narrowed.clear();
+        std::set_intersection(candidates.begin(),
+                              candidates.end(),
+                              lists[index]->begin(),
+                              lists[index]->end(),
+                              std::back_inserter(narrowed));
+        candidates.swap(narrowed);
+    }
+    return candidates;
+}
+
+auto WorkspaceSearchService::candidate_files(const SearchConfig& config) const
+    -> std::vector<std::string>
+{
+    std::vector<std::string> paths;
+    {
+        std::shared_lock lock(index_mutex_);
+        for (const auto file_id : candidates_locked(config))
+        {
+            paths.push_back(files_[file_id].path);
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+void WorkspaceSearchService::search(SearchConfig config,
+                                    MatchCallback on_match,
+                                    CompleteCallback on_complete)
+{
+    cancel();
+
+    auto version = coalescing_.current_version() + 1;
+    auto cancel_token = coalescing_.submit(version);
+
+    searching_.store(true, std::memory_order_release);
+    search_thread_ = std::thread(
+        [this,
+         cfg = std::move(config),
+         match_cb = std::move(on_match),
+         complete_cb = std::move(on_complete),
+         ver = version,
+         cancel_tok = cancel_token]() mutable
+        {
+            search_worker(
+                cancel_tok, std::move(cfg), std::move(match_cb), std::move(complete_cb), ver);
+        });
+}
+
+void WorkspaceSearchService::cancel()
+{
+    coalescing_.cancel();
+    if (search_thread_.joinable())
+    {
+        search_thread_.join();
+    }
+    searching_.store(false, std::memory_order_release);
+}
+
+auto WorkspaceSearchService::is_searching() const noexcept -> bool
+{
+    return searching_.load(std::memory_order_acquire);
+}
+
+void WorkspaceSearchService::search_worker(CancelToken cancel,
+                                           SearchConfig config,
+                                           MatchCallback on_match,
+                                           CompleteCallback on_complete,
+                                           uint64_t version)
+{
+    auto pattern = SearchPattern::compile(config);
+    if (!pattern)
+    {
+        MARKAMP_LOG_WARN("Workspace search not started: {}", pattern.error());
+        if (on_complete && coalescing_.is_current(version))
+        {
+            on_complete(0);
+        }
+        searching_.store(false, std::memory_order_release);
+        return;
+    }
+
+    std::vector<std::string> paths;
+    {
+        std::shared_lock lock(index_mutex_);
+        for (const auto file_id : candidates_locked(config))
+        {
+            paths.push_back(files_[file_id].path);
+        }
+    }
+
+    std::atomic<std::size_t> next{0};
+    std::atomic<bool> aborted{false};
+    std::mutex callback_mutex;
+    std::size_t total_matches = 0; // GUARDED_BY(callback_mutex)
+    auto stopped = [&]
+    {
+        return aborted.load(std::memory_order_relaxed) || cancel.stop_requested() ||
+               !coalescing_.is_current(version);
+    };
+
+    run_parallel(
+        [&]
+        {
+            std::string content;
+            std::vector<SearchHit> hits;
+            for (auto index = next.fetch_add(1); index < paths.size() && !stopped();
+                 index = next.fetch_add(1))
+            {
+                if (!read_whole_file(paths[index], content))
+                {
+                    continue;
+                }
+                hits.clear();
+                pattern->find_all(content, hits);
+                if (hits.empty())
+                {
+                    continue;
+                }
+
+                // One file's matches are delivered together
+                std::lock_guard lock(callback_mutex);
+                for (const auto& hit : hits)
+                {
+                    if (stopped())
+                    {
+                        return;
+                    }
+                    ++total_matches;
+                    const std::string_view line_content(content.data() + hit.line_start,
+                                                        hit.line_end - hit.line_start);
+                    if (on_match && !on_match(paths[index],
+                                              hit.line,
+                                              hit.offset - hit.line_start,
+                                              line_content))
+                    {
+                        aborted.store(true, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+            }
+        });
+
+    if (on_complete && !cancel.stop_requested() && coalescing_.is_current(version))
+    {
+        on_complete(total_matches);
+    }
+
+    searching_.store(false, std::memory_order_release);
+}
+
+} // namespace markamp::core
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "CoalescingTask.h"
+#include "FileChange.h"
+#include "FileNode.h"
+#include "IncrementalSearcher.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace markamp::core
+{
+
+/// Workspace-wide full-text search backed by a trigram index.
+///
+/// index_tree() reads every file under a FileNode tree (on the worker
+/// pool) and records, per trigram of its ASCII-lowercased text, which
+/// files contain it. A query intersects the posting lists of the needle's
+/// trigrams to get the candidate files, then verifies the candidates in
+/// parallel and streams each file's matches through the callback as soon
+/// as that file is done. Needles shorter than three bytes cannot use the
+/// index and scan every file, as do regex searches. Matching itself is
+/// SearchPattern's, so results agree with IncrementalSearcher.
+///
+/// The index is kept current by on_file_changed() / on_file_removed()
+/// (wire them to file watch callbacks): a changed file is re-read and
+/// appended under a new id while its old id is tombstoned, and tombstones
+/// are compacted away once they outnumber live files. save() / load()
+/// persist the index; index_tree() after load() re-reads only files whose
+/// size or modification time changed. track_workspace() does all of this
+/// for an open workspace on a background thread.
+///
+/// Files larger than kMaxFileSize are neither indexed nor searched.
+///
+/// Pattern implemented: #15 Incremental search with background indexing
+class WorkspaceSearchService
+{
+public:
+    /// Called for each match, serialized but from pool threads, grouped by
+    /// file (files arrive in completion order). `line_content` is only
+    /// valid during the call. Return false to abort the search.
+    using MatchCallback = std::function<bool(const std::string& path,
+                                             std::size_t line,
+                                             std::size_t col,
+                                             std::string_view line_content)>;
+
+    /// Called once when a search finishes without being cancelled.
+    using CompleteCallback = IncrementalSearcher::CompleteCallback;
+
+    /// `worker_count` 0 uses one worker per hardware thread.
+    explicit WorkspaceSearchService(std::size_t worker_count = 0);
+    ~WorkspaceSearchService();
+
+    // Non-copyable, non-movable
+    WorkspaceSearchService(const WorkspaceSearchService&) = delete;
+    auto operator=(const WorkspaceSearchService&) -> WorkspaceSearchService& = delete;
+    WorkspaceSearchService(WorkspaceSearchService&&) = delete;
+    auto operator=(WorkspaceSearchService&&) -> WorkspaceSearchService& = delete;
+
+    // ── Indexing ──
+
+    /// Bring the index in line with the files under `root`: index new and
+    /// modified files and drop files no longer in the tree. Returns the
+    /// number of files read. A fired `cancel` stops between batches, leaving
+    /// the rest for the next call.
+    auto index_tree(const FileNode& root, const CancelToken* cancel = nullptr) -> std::size_t;
+
+    /// A file was created or modified: re-index it.
+    void on_file_changed(const std::string& path);
+
+    /// A file was deleted: drop it from the index.
+    void on_file_removed(const std::string& path);
+
+    /// Write the index to `index_path` (via a temporary file and rename).
+    [[nodiscard]] auto save(const std::filesystem::path& index_path) const
+        -> std::expected<void, std::string>;
+
+    /// Replace the index with one written by save(). On error the index
+    /// is left empty.
+    [[nodiscard]] auto load(const std::filesystem::path& index_path)
+        -> std::expected<void, std::string>;
+
+    // ── Workspace tracking ──
+
+    /// Keep the index of the workspace at `root` current on a background
+    /// thread: load the index saved at `index_path` (if any), index_tree()
+    /// the non-hidden files under `root`, save, then apply the changes
+    /// passed to apply_changes(). Stops tracking the previous workspace
+    /// first.
+    void track_workspace(const std::filesystem::path& root, std::filesystem::path index_path);
+
+    /// Queue file watch changes (e.g. from events::FileSystemChangedEvent)
+    /// for the tracking thread; changes outside the tracked root are
+    /// ignored. Does not block on I/O.
+    void apply_changes(const std::vector<FileChange>& changes);
+
+    /// Stop tracking and save the index to the tracked `index_path`.
+    /// Called by the destructor.
+    void stop_tracking();
+
+    /// Number of indexed files.
+    [[nodiscard]] auto file_count() const -> std::size_t;
+
+    /// Number of distinct trigrams in the index.
+    [[nodiscard]] auto trigram_count() const -> std::size_t;
+
+    // ── Searching ──
+
+    /// Files the index cannot rule out for `config`, sorted by path.
+    [[nodiscard]] auto candidate_files(const SearchConfig& config) const
+        -> std::vector<std::string>;
+
+    /// Start a search on a background thread. Cancels any in-flight search.
+    void search(SearchConfig config, MatchCallback on_match, CompleteCallback on_complete);
+
+    /// Cancel the current search and wait for it to stop.
+    void cancel();
+
+    /// Check if a search is currently running.
+    [[nodiscard]] auto is_searching() const noexcept -> bool;
+
+    static constexpr std::uintmax_t kMaxFileSize = 16 * 1024 * 1024;
+
+private:
+    struct FileEntry
+    {
+        std::string path;
+        std::uintmax_t size{0};
+        std::int64_t mtime{0}; // file_time_type ticks
+        bool live{true};
+    };
+
+    /// A file read and reduced to its trigrams, ready to be merged.
+    struct IndexedFile
+    {
+        std::string path;
+        std::uintmax_t size{0};
+        std::int64_t mtime{0};
+        std::vector<uint32_t> trigrams; // Sorted, unique
+    };
+
+    // Index (GUARDED_BY(index_mutex_)); file ids index files_
+    std::vector<FileEntry> files_;
+    std::unordered_map<std::string, uint32_t> file_ids_; // Live files only
+    std::unordered_map<uint32_t, std::vector<uint32_t>> postings_;
+    std::size_t dead_files_{0};
+    mutable std::shared_mutex index_mutex_;
+
+    // Search
+    CoalescingTask coalescing_;
+    std::thread search_thread_;
+    std::atomic<bool> searching_{false};
+
+    // Workspace tracking (track_workspace)
+    std::thread track_thread_;
+    CancelToken track_cancel_;
+    std::filesystem::path track_index_path_;
+    std::mutex track_mutex_;
+    std::condition_variable track_cv_;
+    std::string track_root_;                // GUARDED_BY(track_mutex_)
+    std::vector<FileChange> track_changes_; // GUARDED_BY(track_mutex_)
+    bool track_stopping_{false};            // GUARDED_BY(track_mutex_)
+
+    // Worker pool: run_parallel() hands one task to every worker
+    std::vector<std::thread> workers_;
+    std::mutex job_mutex_; // One parallel job at a time
+    std::mutex pool_mutex_;
+    std::condition_variable pool_cv_;
+    std::condition_variable pool_done_cv_;
+    const std::function<void()>* pool_task_{nullptr}; // GUARDED_BY(pool_mutex_)
+    uint64_t pool_generation_{0};                      // GUARDED_BY(pool_mutex_)
+    std::size_t pool_active_{0};                       // GUARDED_BY(pool_mutex_)
+    bool pool_stopping_{false};                        // GUARDED_BY(pool_mutex_)
+
+    static constexpr std::size_t kIndexBatchSize = 256;
+
+    void worker_loop();
+    void track_loop(std::filesystem::path root, std::filesystem::path index_path);
+
+    /// Re-index or drop the files one watched change touched.
+    void apply_change(const FileChange& change);
+
+    /// Run `task` on every worker and the calling thread; returns when all
+    /// are done. Tasks split the work between themselves.
+    void run_parallel(const std::function<void()>& task);
+
+    void search_worker(CancelToken cancel,
+                       SearchConfig config,
+                       MatchCallback on_match,
+                       CompleteCallback on_complete,
+                       uint64_t version);
+
+    /// Read `path` and extract its trigrams; false if it cannot be indexed.
+    [[nodiscard]] static auto index_file(const std::string& path, IndexedFile& out) -> bool;
+
+    /// Add files to the index, replacing earlier versions. Requires the
+    /// unique lock.
+    void merge_locked(std::vector<IndexedFile>& batch);
+
+    /// Tombstone a file. Requires the unique lock.
+    void remove_locked(const std::string& path);
+
+    /// Tombstone every file below `folder`. Requires the unique lock.
+    void remove_folder_locked(const std::string& folder);
+
+    /// Drop tombstoned ids once they outnumber live files. Requires the
+    /// unique lock.
+    void maybe_compact_locked();
+
+    /// Ids of live files that may match `config` (all of them for a regex
+    /// or a needle shorter than a trigram). Requires a lock.
+    [[nodiscard]] auto candidates_locked(const SearchConfig& config) const
+        -> std::vector<uint32_t>;
+};
+
+} // namespace markamp::core
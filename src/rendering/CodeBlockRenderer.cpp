@@ -3,6 +3,7 @@
 #include "core/StringUtils.h"
 
 #include <fmt/format.h>
+#include <iterator>
 #include <sstream>
 
 namespace markamp::rendering
@@ -16,10 +17,19 @@ auto CodeBlockRenderer::render(std::string_view source,
 {
     std::string html;
     html.reserve(source.size() * 2 + 512);
+    render_into(html, source, language, highlight_spec);
+    return html;
+}
 
+void CodeBlockRenderer::render_into(std::string& output,
+                                    std::string_view source,
+                                    const std::string& language,
+                                    const std::string& highlight_spec) const
+{
     if (language.empty() && highlight_spec.empty())
     {
-        return render_plain(source);
+        render_plain_into(output, source);
+        return;
     }
 
     // Assign block ID and store source for clipboard copy
@@ -35,53 +45,71 @@ auto CodeBlockRenderer::render(std::string_view source,
     // Parse line highlights
     auto highlight_lines = parse_highlight_spec(highlight_spec);
 
+    auto out = std::back_inserter(output);
+
     // Wrapper div
-    html += fmt::format("<div class=\"code-block-wrapper\" id=\"codeblock-{}\">\n", block_id);
+    fmt::format_to(out, "<div class=\"code-block-wrapper\" id=\"codeblock-{}\">\n", block_id);
 
     // Header with language label + copy button
-    html += "<div class=\"code-block-header\">";
+    output += "<div class=\"code-block-header\">";
     if (!language.empty())
     {
-        html +=
-            fmt::format("<span class=\"language-label\">{}</span>", core::escape_html(language));
+        output += "<span class=\"language-label\">";
+        core::append_escaped_html(output, language);
+        output += "</span>";
     }
     // Copy button
-    html +=
-        fmt::format("<a href=\"markamp://copy/{}\" class=\"copy-btn\" title=\"Copy to clipboard\">"
-                    "\xF0\x9F\x93\x8B</a>", // 📋
-                    block_id);
-    html += "</div>\n";
+    fmt::format_to(out,
+                   "<a href=\"markamp://copy/{}\" class=\"copy-btn\" title=\"Copy to clipboard\">"
+                   "\xF0\x9F\x93\x8B</a>", // 📋
+                   block_id);
+    output += "</div>\n";
 
     // Pre + code with highlighted tokens
-    html += fmt::format("<pre class=\"code-block\"><code class=\"language-{}\">",
-                        core::escape_html(language.empty() ? "text" : language));
+    output += "<pre class=\"code-block\"><code class=\"language-";
+    core::append_escaped_html(output, language.empty() ? "text" : language);
+    output += "\">";
 
-    std::string code_html;
-    if (!language.empty() && highlighter_.is_supported(language))
+    const bool highlighted = !language.empty() && highlighter_.is_supported(language);
+    if (highlight_lines.empty())
     {
-        code_html = highlighter_.render_html(source, language);
+        if (highlighted)
+        {
+            highlighter_.render_html_into(source, language, output, tokens_);
+        }
+        else
+        {
+            core::append_escaped_html(output, source);
+        }
     }
     else
     {
-        code_html = core::escape_html(source);
-    }
-
-    // Apply line highlights if requested
-    if (!highlight_lines.empty())
-    {
-        code_html = apply_line_highlights(code_html, highlight_lines);
+        // Line highlights need the code HTML split by line first
+        std::string code_html;
+        if (highlighted)
+        {
+            highlighter_.render_html_into(source, language, code_html, tokens_);
+        }
+        else
+        {
+            code_html = core::escape_html(source);
+        }
+        output += apply_line_highlights(code_html, highlight_lines);
     }
 
-    html += code_html;
-    html += "</code></pre>\n</div>\n";
-    return html;
+    output += "</code></pre>\n</div>\n";
 }
 
 auto CodeBlockRenderer::render_plain(std::string_view source) const -> std::string
 {
     std::string html;
     html.reserve(source.size() + 256);
+    render_plain_into(html, source);
+    return html;
+}
 
+void CodeBlockRenderer::render_plain_into(std::string& output, std::string_view source) const
+{
     // R20 Fix 33: cap block_sources_ to prevent unbounded memory growth (same as render)
     if (block_sources_.size() >= 10000)
     {
@@ -91,20 +119,19 @@ auto CodeBlockRenderer::render_plain(std::string_view source) const -> std::stri
     int block_id = block_counter_++;
     block_sources_.emplace_back(source);
 
-    html += fmt::format("<div class=\"code-block-wrapper\" id=\"codeblock-{}\">\n", block_id);
-
-    // Header with copy button only
-    html +=
-        fmt::format("<div class=\"code-block-header\">"
-                    "<a href=\"markamp://copy/{}\" class=\"copy-btn\" title=\"Copy to clipboard\">"
-                    "\xF0\x9F\x93\x8B</a>"
-                    "</div>\n",
-                    block_id);
-
-    html += "<pre class=\"code-block\"><code>";
-    html += core::escape_html(source);
-    html += "</code></pre>\n</div>\n";
-    return html;
+    fmt::format_to(std::back_inserter(output),
+                   "<div class=\"code-block-wrapper\" id=\"codeblock-{}\">\n"
+                   // Header with copy button only
+                   "<div class=\"code-block-header\">"
+                   "<a href=\"markamp://copy/{}\" class=\"copy-btn\" title=\"Copy to clipboard\">"
+                   "\xF0\x9F\x93\x8B</a>"
+                   "</div>\n",
+                   block_id,
+                   block_id);
+
+    output += "<pre class=\"code-block\"><code>";
+    core::append_escaped_html(output, source);
+    output += "</code></pre>\n</div>\n";
 }
 
 void CodeBlockRenderer::reset_counter() const
@@ -113,6 +140,17 @@ void CodeBlockRenderer::reset_counter() const
     block_sources_.clear();
 }
 
+void CodeBlockRenderer::register_block_source(std::string_view source) const
+{
+    if (block_sources_.size() >= 10000)
+    {
+        block_sources_.clear();
+        block_counter_ = 0;
+    }
+    ++block_counter_;
+    block_sources_.emplace_back(source);
+}
+
 auto CodeBlockRenderer::get_block_source(int block_id) const -> std::string
 {
     if (block_id >= 0 && block_id < static_cast<int>(block_sources_.size()))
@@ -34,15 +34,41 @@ public:
                               const std::string& language,
                               const std::string& highlight_spec = "") const -> std::string;
 
+    /// Like render(), appending to `output`. Highlighting reuses internal
+    /// token buffers, so a warm call only allocates for the copy-button source.
+    void render_into(std::string& output,
+                     std::string_view source,
+                     const std::string& language,
+                     const std::string& highlight_spec = "") const;
+
     /// Render a code block without language (indented or bare fenced).
     [[nodiscard]] auto render_plain(std::string_view source) const -> std::string;
 
+    /// Like render_plain(), appending to `output`.
+    void render_plain_into(std::string& output, std::string_view source) const;
+
     /// Reset the block counter (call once per full-document render).
     void reset_counter() const;
 
     /// Retrieve stored source for a block ID (for clipboard copy).
     [[nodiscard]] auto get_block_source(int block_id) const -> std::string;
 
+    /// Sources of all blocks rendered since the last reset_counter(), by block ID.
+    [[nodiscard]] auto block_sources() const -> const std::vector<std::string>&
+    {
+        return block_sources_;
+    }
+
+    /// Number of blocks rendered since the last reset_counter().
+    [[nodiscard]] auto block_count() const -> int
+    {
+        return block_counter_;
+    }
+
+    /// Register a block's source without rendering it. Used when a cached
+    /// fragment's HTML is reused so its copy-button IDs stay resolvable.
+    void register_block_source(std::string_view source) const;
+
     /// Parse "{1,3-5}" notation into a set of 1-based line numbers.
     [[nodiscard]] static auto parse_highlight_spec(const std::string& spec) -> std::set<int>;
 
@@ -54,6 +80,7 @@ private:
     mutable core::SyntaxHighlighter highlighter_;
     mutable int block_counter_{0};
     mutable std::vector<std::string> block_sources_;
+    mutable core::TokenArraySoA tokens_; // Reused by every highlighted block
 
     [[nodiscard]] static auto escape_html(std::string_view text) -> std::string;
 
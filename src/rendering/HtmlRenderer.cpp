@@ -1,7 +1,10 @@
 #include "HtmlRenderer.h"
 
 #include "CodeBlockRenderer.h"
+#include "ImageCache.h"
 #include "MermaidBlockRenderer.h"
+#include "core/FlatMarkdown.h"
+#include "core/HtmlSanitizer.h"
 #include "core/IMathRenderer.h"
 #include "core/IMermaidRenderer.h"
 #include "core/Profiler.h"
@@ -12,6 +15,8 @@
 #include <filesystem>
 #include <fmt/format.h>
 #include <fstream>
+#include <iterator>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -198,58 +203,153 @@ auto FootnotePreprocessor::build_section(const std::vector<FootnoteDefinition>&
 // ═══════════════════════════════════════════════════════
 
 auto HtmlRenderer::render(const core::MarkdownDocument& doc) -> std::string
+{
+    std::string output;
+    // Improvement #13: pre-allocate based on total text length estimate
+    size_t estimate = 0;
+    for (const auto& child : doc.root.children)
+    {
+        estimate += child.text_content.size();
+    }
+    output.reserve(std::max(estimate * 4, static_cast<size_t>(512)));
+    render_into(doc, output);
+    return output;
+}
+
+auto HtmlRenderer::render_with_footnotes(const core::MarkdownDocument& doc,
+                                         const std::string& footnote_section) -> std::string
+{
+    std::string output;
+    output.reserve(doc.root.children.size() * 256 + footnote_section.size());
+    render_into(doc, output, nullptr, footnote_section);
+    return output;
+}
+
+auto HtmlRenderer::render(const core::FlatMarkdownDocument& doc) -> std::string
+{
+    return render_with_footnotes(doc, {});
+}
+
+auto HtmlRenderer::render_with_footnotes(const core::FlatMarkdownDocument& doc,
+                                         const std::string& footnote_section) -> std::string
+{
+    std::string output;
+    // Roughly 16 bytes of HTML per node
+    output.reserve(std::max(doc.nodes().size() * 16, static_cast<size_t>(512)) +
+                   footnote_section.size());
+    render_into(doc, output, nullptr, footnote_section);
+    return output;
+}
+
+void HtmlRenderer::render_into(const core::MarkdownDocument& doc,
+                               std::string& output,
+                               const core::HtmlSanitizer* sanitizer,
+                               std::string_view footnote_section)
+{
+    render_document(doc.root, output, sanitizer, footnote_section);
+}
+
+void HtmlRenderer::render_into(const core::FlatMarkdownDocument& doc,
+                               std::string& output,
+                               const core::HtmlSanitizer* sanitizer,
+                               std::string_view footnote_section)
+{
+    render_document(doc.root(), output, sanitizer, footnote_section);
+}
+
+template <typename Node>
+void HtmlRenderer::render_document(const Node& root,
+                                   std::string& output,
+                                   const core::HtmlSanitizer* sanitizer,
+                                   std::string_view footnote_section)
 {
     MARKAMP_PROFILE_SCOPE("HtmlRenderer::render");
+    const auto start = output.size();
     // New stability #34: wrap entire render pipeline in try-catch
     try
     {
         code_renderer_.reset_counter();
         heading_slug_counts_.clear(); // Improvement #6: reset per render
-        std::string output;
-        // Improvement #13: pre-allocate based on total text length estimate
-        size_t estimate = 0;
-        for (const auto& child : doc.root.children)
+        if (sanitizer == nullptr)
+        {
+            render_children(root, output);
+            output += footnote_section;
+            return;
+        }
+
+        // Each top-level block is complete HTML, so it can be sanitized on its own
+        for (const auto& child : core::children_of(root))
         {
-            estimate += child.text_content.size();
+            block_scratch_.clear();
+            render_node(child, block_scratch_);
+            sanitizer->sanitize_into(block_scratch_, output);
         }
-        output.reserve(std::max(estimate * 4, static_cast<size_t>(512)));
-        render_children(doc.root, output);
-        return output;
+        sanitizer->sanitize_into(footnote_section, output);
     }
     catch (const std::exception& ex)
     {
-        return std::string("<!-- render error: ") + ex.what() + " -->";
+        output.resize(start);
+        output += "<!-- render error: ";
+        output += ex.what();
+        output += " -->";
     }
 }
 
-auto HtmlRenderer::render_with_footnotes(const core::MarkdownDocument& doc,
-                                         const std::string& footnote_section) -> std::string
+// ═══════════════════════════════════════════════════════
+// HtmlRenderer — Fragment rendering
+// ═══════════════════════════════════════════════════════
+
+void HtmlRenderer::begin_document()
 {
-    // Improvement #1: wrap in try-catch matching render()
-    try
+    code_renderer_.reset_counter();
+    heading_slug_counts_.clear();
+}
+
+void HtmlRenderer::render_fragment(const core::MdNode& node, std::string& output)
+{
+    // A Document fragment renders its children at the same depth render() would
+    if (node.type == core::MdNodeType::Document)
     {
-        code_renderer_.reset_counter();
-        heading_slug_counts_.clear(); // Improvement #6: reset per render
-        std::string output;
-        output.reserve(doc.root.children.size() * 256 + footnote_section.size());
-        render_children(doc.root, output);
-        if (!footnote_section.empty())
+        render_children(node, output);
+        return;
+    }
+    render_node(node, output);
+}
+
+void HtmlRenderer::skip_fragment(const std::vector<std::string>& heading_slugs,
+                                 const std::vector<std::string>& code_sources)
+{
+    // Mirror the bookkeeping done by render_node for headings and code blocks
+    for (const auto& slug : heading_slugs)
+    {
+        auto it = heading_slug_counts_.find(slug);
+        if (it != heading_slug_counts_.end())
         {
-            output += footnote_section;
+            it->second++;
+        }
+        else
+        {
+            heading_slug_counts_[slug] = 0;
         }
-        return output;
     }
-    catch (const std::exception& ex)
+    for (const auto& source : code_sources)
     {
-        return std::string("<!-- render error: ") + ex.what() + " -->";
+        code_renderer_.register_block_source(source);
     }
 }
 
+auto HtmlRenderer::heading_slug_occurrences(const std::string& slug) const -> int
+{
+    auto it = heading_slug_counts_.find(slug);
+    return it != heading_slug_counts_.end() ? it->second + 1 : 0;
+}
+
 // ═══════════════════════════════════════════════════════
 // Recursive rendering
 // ═══════════════════════════════════════════════════════
 
-void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, int depth)
+template <typename Node>
+void HtmlRenderer::render_node(const Node& node, std::string& output, int depth)
 {
     // Stability #31: cap recursion depth to prevent stack overflow
     if (depth > kMaxRenderDepth)
@@ -259,7 +359,7 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
     }
 
     // New stability #35: cap children count to prevent excessive processing
-    if (node.children.size() > 10000)
+    if (core::children_of(node).size() > 10000)
     {
         output += "<!-- node children limit exceeded -->";
         return;
@@ -283,7 +383,7 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
         {
             // Phase 4 Item 32: Generate heading anchor ID from text content
             std::string heading_text;
-            for (const auto& child : node.children)
+            for (const auto& child : core::children_of(node))
             {
                 heading_text += child.plain_text();
             }
@@ -309,9 +409,9 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
             // Stability #32: clamp heading level to valid range [1, 6]
             int level = std::clamp(node.heading_level, 1, 6);
 
-            output += fmt::format("<h{} id=\"{}\">", level, slug);
+            fmt::format_to(std::back_inserter(output), "<h{} id=\"{}\">", level, slug);
             render_children(node, output, depth + 1);
-            output += fmt::format("</h{}>\n", level);
+            fmt::format_to(std::back_inserter(output), "</h{}>\n", level);
             break;
         }
 
@@ -330,7 +430,8 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
         case MdNodeType::OrderedList:
             if (node.start_number != 1)
             {
-                output += fmt::format("<ol start=\"{}\">\n", node.start_number);
+                fmt::format_to(
+                    std::back_inserter(output), "<ol start=\"{}\">\n", node.start_number);
             }
             else
             {
@@ -350,7 +451,7 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
         case MdNodeType::FencedCodeBlock:
         {
             // Improvement #30: normalize language aliases
-            auto lang = node.language;
+            auto lang = std::string(node.language);
             if (lang == "js")
             {
                 lang = "javascript";
@@ -380,8 +481,9 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
                 lang = "markdown";
             }
 
-            auto hl_spec = CodeBlockRenderer::extract_highlight_spec(node.info_string, lang);
-            output += code_renderer_.render(node.text_content, lang, hl_spec);
+            auto hl_spec = CodeBlockRenderer::extract_highlight_spec(std::string(node.info_string),
+                                                                   lang);
+            code_renderer_.render_into(output, node.text_content, lang, hl_spec);
             break;
         }
 
@@ -396,6 +498,10 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
             else if (mermaid_renderer_ && mermaid_renderer_->is_available())
             {
                 output += mermaid_block.render(node.text_content, *mermaid_renderer_);
+                if (mermaid_block.pending())
+                {
+                    ++pending_placeholders_;
+                }
             }
             else if (mermaid_renderer_ && !mermaid_renderer_->is_available())
             {
@@ -442,14 +548,14 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
             auto style = alignment_style(node.alignment);
             if (!style.empty())
             {
-                output += fmt::format("<{} style=\"{}\">", tag, style);
+                fmt::format_to(std::back_inserter(output), "<{} style=\"{}\">", tag, style);
             }
             else
             {
-                output += fmt::format("<{}>", tag);
+                fmt::format_to(std::back_inserter(output), "<{}>", tag);
             }
             render_children(node, output, depth + 1);
-            output += fmt::format("</{}>", tag);
+            fmt::format_to(std::back_inserter(output), "</{}>", tag);
             break;
         }
 
@@ -460,7 +566,7 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
 
         // --- Inline nodes ---
         case MdNodeType::Text:
-            output += escape_html(node.text_content);
+            core::append_escaped_html(output, node.text_content);
             break;
 
         case MdNodeType::Emphasis:
@@ -488,10 +594,14 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
             break;
 
         case MdNodeType::Link:
-            output += fmt::format("<a href=\"{}\"", escape_html(node.url));
+            output += "<a href=\"";
+            core::append_escaped_html(output, node.url);
+            output += '"';
             if (!node.title.empty())
             {
-                output += fmt::format(" title=\"{}\"", escape_html(node.title));
+                output += " title=\"";
+                core::append_escaped_html(output, node.title);
+                output += '"';
             }
             output += ">";
             render_children(node, output, depth + 1);
@@ -512,8 +622,27 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
             }
             else
             {
-                auto data_uri = encode_image_as_data_uri(resolved);
-                if (data_uri.empty())
+                std::shared_ptr<const std::string> cached_uri;
+                std::string data_uri;
+                bool pending = false;
+                if (image_cache_ != nullptr)
+                {
+                    auto entry = image_cache_->lookup(resolved, image_width_);
+                    cached_uri = std::move(entry.data_uri);
+                    pending = entry.pending;
+                }
+                else
+                {
+                    data_uri = encode_image_as_data_uri(resolved);
+                }
+                const std::string_view src = cached_uri ? *cached_uri : data_uri;
+
+                if (pending)
+                {
+                    ++pending_placeholders_;
+                    output += render_pending_image(alt_text);
+                }
+                else if (src.empty())
                 {
                     output += render_missing_image(node.url, alt_text);
                 }
@@ -522,7 +651,7 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
                     // Improvement #35: lazy loading + #36: responsive sizing
                     output += fmt::format(
                         R"(<img src="{}" alt="{}" loading="lazy" style="max-width:100%;height:auto")",
-                        data_uri,
+                        src,
                         escape_html(alt_text));
                     if (!node.title.empty())
                     {
@@ -564,7 +693,7 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
         {
             // Collect math content from children
             std::string math_content;
-            for (const auto& child : node.children)
+            for (const auto& child : core::children_of(node))
             {
                 math_content += child.text_content;
             }
@@ -581,13 +710,13 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
                 if (is_display)
                 {
                     output += "<div class=\"math-fallback\"><code>";
-                    output += escape_html(math_content);
+                    core::append_escaped_html(output, math_content);
                     output += "</code></div>\n";
                 }
                 else
                 {
                     output += "<code class=\"math-fallback\">";
-                    output += escape_html(math_content);
+                    core::append_escaped_html(output, math_content);
                     output += "</code>";
                 }
             }
@@ -596,15 +725,18 @@ void HtmlRenderer::render_node(const core::MdNode& node, std::string& output, in
 
         // Improvement #2: explicit default case for unhandled node types
         default:
-            output += fmt::format("<!-- unhandled node type {} -->", static_cast<int>(node.type));
+            fmt::format_to(std::back_inserter(output),
+                           "<!-- unhandled node type {} -->",
+                           static_cast<int>(node.type));
             render_children(node, output, depth + 1);
             break;
     }
 }
 
-void HtmlRenderer::render_children(const core::MdNode& node, std::string& output, int depth)
+template <typename Node>
+void HtmlRenderer::render_children(const Node& node, std::string& output, int depth)
 {
-    for (const auto& child : node.children)
+    for (const auto& child : core::children_of(node))
     {
         render_node(child, output, depth);
     }
@@ -620,10 +752,11 @@ auto HtmlRenderer::escape_html(std::string_view text) -> std::string
 }
 
 // Improvement #38: collect plain text from node children (replaces duplicate loops)
-auto HtmlRenderer::collect_plain_text(const core::MdNode& node) -> std::string
+template <typename Node>
+auto HtmlRenderer::collect_plain_text(const Node& node) -> std::string
 {
     std::string result;
-    for (const auto& child : node.children)
+    for (const auto& child : core::children_of(node))
     {
         result += child.plain_text();
     }
@@ -710,6 +843,27 @@ void HtmlRenderer::set_base_path(const std::filesystem::path& base_path)
     base_path_ = base_path;
 }
 
+auto HtmlRenderer::image_stamp(std::string_view url) const -> std::string
+{
+    const auto resolved = resolve_image_path(url);
+    if (resolved.empty())
+    {
+        return {};
+    }
+    std::error_code error;
+    const auto size = std::filesystem::file_size(resolved, error);
+    if (error)
+    {
+        return {};
+    }
+    const auto mtime = std::filesystem::last_write_time(resolved, error);
+    if (error)
+    {
+        return {};
+    }
+    return fmt::format("{}|{}|{}", resolved.string(), mtime.time_since_epoch().count(), size);
+}
+
 auto HtmlRenderer::resolve_image_path(std::string_view url) const -> std::filesystem::path
 {
     auto url_str = std::string(url);
@@ -867,17 +1021,21 @@ auto HtmlRenderer::encode_image_as_data_uri(const std::filesystem::path& image_p
         return {};
     }
 
-    // Base64 encode using MermaidBlockRenderer's encoder
-    // Improvement #17: pre-allocate output string for base64 result
-    auto b64 = MermaidBlockRenderer::base64_encode(data);
+    return encode_data_uri(mime, data);
+}
 
-    std::string result;
-    result.reserve(5 + mime.size() + 8 + b64.size()); // "data:" + mime + ";base64," + b64
-    result += "data:";
-    result += mime;
-    result += ";base64,";
-    result += b64;
-    return result;
+auto HtmlRenderer::render_pending_image(std::string_view alt_text) -> std::string
+{
+    std::string html;
+    html += "<div class=\"image-loading\">";
+    html += "<em>Loading image...</em>";
+    if (!alt_text.empty())
+    {
+        html += "<br>";
+        html += escape_html(alt_text);
+    }
+    html += "</div>";
+    return html;
 }
 
 auto HtmlRenderer::render_missing_image(std::string_view url, std::string_view alt_text)
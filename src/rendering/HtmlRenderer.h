@@ -3,6 +3,7 @@
 #include "CodeBlockRenderer.h"
 #include "core/Types.h"
 
+#include <cstddef>
 #include <filesystem>
 #include <string>
 #include <string_view>
@@ -12,6 +13,8 @@
 
 namespace markamp::core
 {
+class FlatMarkdownDocument;
+class HtmlSanitizer;
 class IMermaidRenderer;
 class IMathRenderer;
 } // namespace markamp::core
@@ -19,6 +22,8 @@ class IMathRenderer;
 namespace markamp::rendering
 {
 
+class ImageCache;
+
 /// Result of footnote pre-processing.
 struct FootnoteResult
 {
@@ -64,6 +69,66 @@ public:
     [[nodiscard]] auto render_with_footnotes(const core::MarkdownDocument& doc,
                                              const std::string& footnote_section) -> std::string;
 
+    /// Render the compact AST; output is identical to the MarkdownDocument
+    /// overloads for the same source.
+    [[nodiscard]] auto render(const core::FlatMarkdownDocument& doc) -> std::string;
+    [[nodiscard]] auto render_with_footnotes(const core::FlatMarkdownDocument& doc,
+                                             const std::string& footnote_section) -> std::string;
+
+    // ── Streaming rendering ──
+
+    /// Render `doc` by appending to `output`, so a caller can reuse one
+    /// buffer across renders (or render after a page prefix it already
+    /// holds). With a `sanitizer`, every top-level block is sanitized as
+    /// soon as it is rendered instead of in a second pass over the whole
+    /// document. `footnote_section` is appended (and sanitized) last.
+    void render_into(const core::MarkdownDocument& doc,
+                     std::string& output,
+                     const core::HtmlSanitizer* sanitizer = nullptr,
+                     std::string_view footnote_section = {});
+    void render_into(const core::FlatMarkdownDocument& doc,
+                     std::string& output,
+                     const core::HtmlSanitizer* sanitizer = nullptr,
+                     std::string_view footnote_section = {});
+
+    // ── Fragment rendering (used by IncrementalRenderer) ──
+
+    /// Reset per-document state (heading slug counts, code block IDs)
+    /// before rendering a document as a sequence of fragments.
+    void begin_document();
+
+    /// Render one top-level node, continuing the current document's
+    /// heading-slug and code-block numbering.
+    void render_fragment(const core::MdNode& node, std::string& output);
+
+    /// Advance per-document state for a fragment whose HTML was reused
+    /// from a cache, so later fragments get the same IDs as a full render.
+    void skip_fragment(const std::vector<std::string>& heading_slugs,
+                       const std::vector<std::string>& code_sources);
+
+    /// Identity of the local image `url` names as it is on disk now: its
+    /// resolved path, modification time and size. Empty for remote, blocked
+    /// or missing images. A fragment embedding the image is stale once this
+    /// changes.
+    [[nodiscard]] auto image_stamp(std::string_view url) const -> std::string;
+
+    /// Number of headings already rendered with this base slug.
+    [[nodiscard]] auto heading_slug_occurrences(const std::string& slug) const -> int;
+
+    /// Placeholders rendered so far for images or diagrams that are still
+    /// being produced in the background. Only ever grows; compare the count
+    /// before and after a render.
+    [[nodiscard]] auto pending_placeholders() const -> std::size_t
+    {
+        return pending_placeholders_;
+    }
+
+    /// Number of code blocks rendered so far in the current document.
+    [[nodiscard]] auto code_block_count() const -> int
+    {
+        return code_renderer_.block_count();
+    }
+
     /// Set optional Mermaid renderer for diagram blocks.
     void set_mermaid_renderer(core::IMermaidRenderer* renderer);
 
@@ -85,6 +150,15 @@ public:
     /// Set base path for resolving relative image paths.
     void set_base_path(const std::filesystem::path& base_path);
 
+    /// Take local image data URIs from `cache` (nullptr: read and encode
+    /// every image on each render). `preview_width` is the preview's width
+    /// in pixels that large images are downscaled to (0: full size).
+    void set_image_cache(ImageCache* cache, int preview_width = 0)
+    {
+        image_cache_ = cache;
+        image_width_ = preview_width;
+    }
+
     /// Access the code block renderer (e.g. for clipboard copy).
     [[nodiscard]] auto code_renderer() const -> const CodeBlockRenderer&
     {
@@ -97,14 +171,23 @@ public:
     [[nodiscard]] static auto mime_for_extension(std::string_view ext) -> std::string_view;
 
 private:
-    void render_node(const core::MdNode& node, std::string& output, int depth = 0);
-    void render_children(const core::MdNode& node, std::string& output, int depth = 0);
+    // Node is core::MdNode or core::FlatMdNode
+    template <typename Node>
+    void render_document(const Node& root,
+                         std::string& output,
+                         const core::HtmlSanitizer* sanitizer,
+                         std::string_view footnote_section);
+    template <typename Node>
+    void render_node(const Node& node, std::string& output, int depth = 0);
+    template <typename Node>
+    void render_children(const Node& node, std::string& output, int depth = 0);
 
     /// Stability #31: max recursion depth for render_node
     static constexpr int kMaxRenderDepth = 100;
 
     /// Improvement #38: collect plain text content from node children.
-    [[nodiscard]] static auto collect_plain_text(const core::MdNode& node) -> std::string;
+    template <typename Node>
+    [[nodiscard]] static auto collect_plain_text(const Node& node) -> std::string;
 
     /// Resolve an image URL to an absolute path, validating security constraints.
     /// Returns empty path if the URL is remote, blocked, or the file doesn't exist.
@@ -115,6 +198,9 @@ private:
     [[nodiscard]] static auto encode_image_as_data_uri(const std::filesystem::path& image_path)
         -> std::string;
 
+    /// Render a placeholder for an image whose downscaled variant is not ready yet.
+    [[nodiscard]] static auto render_pending_image(std::string_view alt_text) -> std::string;
+
     /// Render a missing-image placeholder.
     [[nodiscard]] static auto render_missing_image(std::string_view url, std::string_view alt_text)
         -> std::string;
@@ -124,7 +210,11 @@ private:
     core::IMathRenderer* math_renderer_{nullptr};
     bool math_enabled_{true};
     std::filesystem::path base_path_;
+    ImageCache* image_cache_{nullptr};
+    int image_width_{0};
+    std::size_t pending_placeholders_{0};
     mutable CodeBlockRenderer code_renderer_;
+    std::string block_scratch_; // Unsanitized HTML of the block being rendered
 
     /// Improvement #6: track heading slug usage for uniqueness
     std::unordered_map<std::string, int> heading_slug_counts_;
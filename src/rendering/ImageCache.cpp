@@ -0,0 +1,424 @@
+#include "ImageCache.h"
+
+#include "HtmlRenderer.h"
+#include "MermaidBlockRenderer.h"
+#include "core/Logger.h"
+#include "core/StringUtils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fmt/format.h>
+#include <fstream>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace markamp::rendering
+{
+
+namespace
+{
+
+/// Read a whole file, or std::nullopt if it is missing, empty or too large.
+auto read_file_bytes(const std::filesystem::path& path) -> std::optional<std::string>
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        return std::nullopt;
+    }
+    auto size = file.tellg();
+    if (size <= 0 || static_cast<std::uintmax_t>(size) > ImageCache::kMaxImageFileSize)
+    {
+        return std::nullopt;
+    }
+    file.seekg(0, std::ios::beg);
+    std::string data(static_cast<std::size_t>(size), '\0');
+    if (!file.read(data.data(), size))
+    {
+        return std::nullopt;
+    }
+    return data;
+}
+
+/// Vector formats and animations would lose more than they save.
+auto is_downscalable(std::string_view mime) -> bool
+{
+    return mime == "image/png" || mime == "image/jpeg" || mime == "image/bmp" ||
+           mime == "image/webp";
+}
+
+auto data_uri_size(const std::shared_ptr<const std::string>& data_uri) -> std::size_t
+{
+    return data_uri ? data_uri->size() : 0;
+}
+
+} // namespace
+
+auto encode_data_uri(std::string_view mime, std::string_view bytes) -> std::string
+{
+    // Base64 encode using MermaidBlockRenderer's encoder
+    // Improvement #17: pre-allocate output string for base64 result
+    auto b64 = MermaidBlockRenderer::base64_encode(bytes);
+
+    std::string result;
+    result.reserve(5 + mime.size() + 8 + b64.size()); // "data:" + mime + ";base64," + b64
+    result += "data:";
+    result += mime;
+    result += ";base64,";
+    result += b64;
+    return result;
+}
+
+// ═══════════════════════════════════════════════════════
+// ImageCache
+// ═══════════════════════════════════════════════════════
+
+ImageCache::ImageCache(std::filesystem::path variant_dir,
+                       ImageScaler scaler,
+                       std::size_t max_bytes,
+                       std::uintmax_t max_variant_bytes)
+    : variant_dir_(std::move(variant_dir))
+    , scaler_(std::move(scaler))
+    , max_variant_bytes_(max_variant_bytes)
+    , uris_(max_bytes, &data_uri_size)
+{
+    if (scaler_)
+    {
+        startup_prune_pending_ = !variant_dir_.empty();
+        worker_ = std::thread([this]() { run(); });
+    }
+}
+
+ImageCache::~ImageCache()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    if (worker_.joinable())
+    {
+        worker_.join();
+    }
+}
+
+auto ImageCache::lookup(const std::filesystem::path& image_path, int preview_width) -> Entry
+{
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(image_path, error) || error)
+    {
+        return {};
+    }
+    const auto size = std::filesystem::file_size(image_path, error);
+    if (error || size == 0 || size > kMaxImageFileSize)
+    {
+        return {};
+    }
+    const auto mtime = std::filesystem::last_write_time(image_path, error);
+    if (error)
+    {
+        return {};
+    }
+
+    auto ext = image_path.extension().string();
+    std::transform(
+        ext.begin(), ext.end(), ext.begin(), [](unsigned char ch) { return std::tolower(ch); });
+    const auto mime = HtmlRenderer::mime_for_extension(ext);
+    if (mime.empty())
+    {
+        return {};
+    }
+
+    auto key = fmt::format("{}|{}|{}", image_path.string(), mtime.time_since_epoch().count(), size);
+
+    if (preview_width > 0 && scaler_ && size >= kDownscaleThreshold && is_downscalable(mime))
+    {
+        const auto width = width_bucket(preview_width);
+        auto variant_key = fmt::format("{}|w{}", key, width);
+        bool needs_variant = false;
+        {
+            std::lock_guard lock(mutex_);
+            if (auto data_uri = cached(variant_key))
+            {
+                return {std::move(data_uri), false};
+            }
+            if (in_flight_.contains(variant_key))
+            {
+                return {nullptr, true};
+            }
+            needs_variant = !full_size_.contains(variant_key);
+        }
+
+        if (needs_variant)
+        {
+            const std::string variant_mime = mime == "image/jpeg" ? "image/jpeg" : "image/png";
+            std::filesystem::path variant_file;
+            if (!variant_dir_.empty())
+            {
+                variant_file =
+                    variant_dir_ / fmt::format("{:016x}{}",
+                                               core::fnv1a_64(variant_key),
+                                               variant_mime == "image/jpeg" ? ".jpg" : ".png");
+                if (auto bytes = read_file_bytes(variant_file))
+                {
+                    // The modification time orders variants for pruning
+                    std::error_code touch_error;
+                    std::filesystem::last_write_time(
+                        variant_file, std::filesystem::file_time_type::clock::now(), touch_error);
+                    auto data_uri = std::make_shared<const std::string>(
+                        encode_data_uri(variant_mime, *bytes));
+                    std::lock_guard lock(mutex_);
+                    ++stats_.variants_loaded;
+                    store(variant_key, data_uri);
+                    return {std::move(data_uri), false};
+                }
+            }
+
+            std::lock_guard lock(mutex_);
+            if (in_flight_.insert(variant_key).second)
+            {
+                ++stats_.misses;
+                jobs_.push_back(
+                    {std::move(variant_key), image_path, std::move(variant_file), width,
+                     variant_mime});
+                work_cv_.notify_one();
+            }
+            return {nullptr, true};
+        }
+    }
+
+    {
+        std::lock_guard lock(mutex_);
+        if (auto data_uri = cached(key))
+        {
+            return {std::move(data_uri), false};
+        }
+    }
+
+    auto bytes = read_file_bytes(image_path);
+    if (!bytes)
+    {
+        return {};
+    }
+    auto data_uri = std::make_shared<const std::string>(encode_data_uri(mime, *bytes));
+    std::lock_guard lock(mutex_);
+    store(key, data_uri);
+    return {std::move(data_uri), false};
+}
+
+void ImageCache::set_ready_callback(std::function<void()> callback)
+{
+    std::lock_guard lock(mutex_);
+    ready_callback_ = std::move(callback);
+}
+
+void ImageCache::wait_idle()
+{
+    std::unique_lock lock(mutex_);
+    idle_cv_.wait(lock,
+                  [this]()
+                  { return !startup_prune_pending_ && jobs_.empty() && in_flight_.empty(); });
+}
+
+auto ImageCache::width_bucket(int preview_width) noexcept -> int
+{
+    if (preview_width <= 0)
+    {
+        return 0;
+    }
+    return ((preview_width + kWidthStep - 1) / kWidthStep) * kWidthStep;
+}
+
+auto ImageCache::stats() const -> Stats
+{
+    std::lock_guard lock(mutex_);
+    return stats_;
+}
+
+auto ImageCache::cached_bytes() const -> std::size_t
+{
+    std::lock_guard lock(mutex_);
+    return uris_.current_bytes();
+}
+
+auto ImageCache::cached(const std::string& key) -> DataUri
+{
+    auto* data_uri = uris_.get(key);
+    if (data_uri == nullptr)
+    {
+        return nullptr;
+    }
+    ++stats_.hits;
+    return *data_uri;
+}
+
+void ImageCache::store(const std::string& key, const DataUri& data_uri)
+{
+    ++stats_.misses;
+    uris_.put(key, data_uri);
+}
+
+// ═══════════════════════════════════════════════════════
+// Variant worker
+// ═══════════════════════════════════════════════════════
+
+void ImageCache::run()
+{
+    std::unique_lock lock(mutex_);
+    if (startup_prune_pending_)
+    {
+        // Variants left by earlier sessions
+        lock.unlock();
+        prune_variants();
+        lock.lock();
+        startup_prune_pending_ = false;
+        if (jobs_.empty() && in_flight_.empty())
+        {
+            idle_cv_.notify_all();
+        }
+    }
+    while (true)
+    {
+        work_cv_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+        if (stopping_)
+        {
+            return;
+        }
+
+        auto job = std::move(jobs_.front());
+        jobs_.pop_front();
+
+        lock.unlock();
+        std::optional<std::string> scaled;
+        try
+        {
+            scaled = scaler_(job.source, job.width, job.mime);
+        }
+        catch (const std::exception& ex)
+        {
+            MARKAMP_LOG_WARN("ImageCache: scaling {} failed: {}", job.source.string(), ex.what());
+        }
+        DataUri data_uri;
+        if (scaled)
+        {
+            data_uri = std::make_shared<const std::string>(encode_data_uri(job.mime, *scaled));
+            if (!job.file.empty())
+            {
+                save_variant(job.file, *scaled);
+                variant_dir_bytes_ += scaled->size();
+                if (variant_dir_bytes_ > max_variant_bytes_)
+                {
+                    prune_variants();
+                }
+            }
+        }
+        lock.lock();
+
+        if (data_uri)
+        {
+            ++stats_.variants_scaled;
+            uris_.put(job.key, data_uri);
+        }
+        else
+        {
+            // Not decodable or already narrow enough: embed the original
+            full_size_.insert(job.key);
+        }
+        in_flight_.erase(job.key);
+        auto callback = ready_callback_;
+        if (jobs_.empty() && in_flight_.empty())
+        {
+            idle_cv_.notify_all();
+        }
+
+        if (callback)
+        {
+            lock.unlock();
+            callback();
+            lock.lock();
+        }
+    }
+}
+
+void ImageCache::save_variant(const std::filesystem::path& file, const std::string& bytes)
+{
+    std::error_code error;
+    std::filesystem::create_directories(file.parent_path(), error);
+
+    // Write to a temporary name first so a crash never leaves a torn variant
+    auto temp = file;
+    temp += ".tmp";
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out.write(bytes.data(), static_cast<std::streamsize>(bytes.size())))
+        {
+            MARKAMP_LOG_WARN("ImageCache: cannot write {}", temp.string());
+            return;
+        }
+    }
+    std::filesystem::rename(temp, file, error);
+    if (error)
+    {
+        MARKAMP_LOG_WARN("ImageCache: cannot store {}: {}", file.string(), error.message());
+        std::filesystem::remove(temp, error);
+    }
+}
+
+void ImageCache::prune_variants()
+{
+    struct Variant
+    {
+        std::filesystem::path path;
+        std::filesystem::file_time_type used;
+        std::uintmax_t size{0};
+    };
+    std::vector<Variant> variants;
+    std::uintmax_t total = 0;
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(variant_dir_, error), end; !error && it != end;
+         it.increment(error))
+    {
+        std::error_code entry_error;
+        if (!it->is_regular_file(entry_error))
+        {
+            continue;
+        }
+        const auto size = it->file_size(entry_error);
+        const auto used = it->last_write_time(entry_error);
+        if (entry_error)
+        {
+            continue;
+        }
+        variants.push_back({it->path(), used, size});
+        total += size;
+    }
+
+    std::size_t pruned = 0;
+    if (total > max_variant_bytes_)
+    {
+        std::sort(variants.begin(),
+                  variants.end(),
+                  [](const Variant& lhs, const Variant& rhs) { return lhs.used < rhs.used; });
+        const auto target = max_variant_bytes_ / 4 * 3;
+        for (const auto& variant : variants)
+        {
+            if (total <= target)
+            {
+                break;
+            }
+            if (std::filesystem::remove(variant.path, error))
+            {
+                total -= variant.size;
+                ++pruned;
+            }
+        }
+        MARKAMP_LOG_DEBUG("ImageCache: pruned {} variants from {}", pruned, variant_dir_.string());
+    }
+    variant_dir_bytes_ = total;
+
+    std::lock_guard lock(mutex_);
+    stats_.variants_pruned += pruned;
+}
+
+} // namespace markamp::rendering
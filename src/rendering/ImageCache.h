@@ -0,0 +1,153 @@
+#pragma once
+
+#include "core/ChunkedStorage.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+
+namespace markamp::rendering
+{
+
+/// Build a `data:<mime>;base64,...` URI for `bytes`.
+[[nodiscard]] auto encode_data_uri(std::string_view mime, std::string_view bytes) -> std::string;
+
+/// Decodes the raster image at `source`, scales it to at most `max_width`
+/// pixels wide (keeping the aspect ratio) and re-encodes it as `mime`.
+/// Returns std::nullopt if the image cannot be decoded or is already no
+/// wider than `max_width`. Called on the ImageCache worker thread.
+using ImageScaler = std::function<std::optional<std::string>(
+    const std::filesystem::path& source, int max_width, std::string_view mime)>;
+
+/// Caches the data URIs the preview embeds for local images.
+///
+/// Entries are keyed by (path, mtime, size), so an unchanged image is read
+/// and base64-encoded once instead of on every render, and editing the
+/// image on disk naturally misses. The in-memory cache is capped in bytes.
+///
+/// Images of at least kDownscaleThreshold bytes are embedded as a variant
+/// scaled to the preview width instead of at full resolution. Variants are
+/// produced on a background thread by the ImageScaler and kept in
+/// `variant_dir` across sessions; while one is being produced, lookup()
+/// reports the image as pending and the ready callback fires once it can
+/// be embedded. Widths are bucketed (kWidthStep) so resizing the preview
+/// does not regenerate variants on every pixel. `variant_dir` is capped in
+/// bytes too: when the worker starts, and whenever writing a variant takes
+/// it over the cap, the least recently used variants are deleted.
+///
+/// All members are thread-safe.
+///
+/// Pattern implemented: #39 Memory locality — capped render caches
+class ImageCache
+{
+public:
+    static constexpr std::size_t kDefaultMaxBytes = static_cast<std::size_t>(64) * 1024 * 1024;
+    static constexpr std::uintmax_t kDownscaleThreshold = static_cast<std::uintmax_t>(256) * 1024;
+    static constexpr std::uintmax_t kMaxImageFileSize =
+        static_cast<std::uintmax_t>(10) * 1024 * 1024;
+    static constexpr int kWidthStep = 256;
+    static constexpr std::uintmax_t kDefaultMaxVariantBytes =
+        static_cast<std::uintmax_t>(256) * 1024 * 1024;
+
+    /// @param variant_dir        On-disk cache for downscaled variants; empty
+    ///                           keeps them in memory only.
+    /// @param scaler             Produces downscaled variants; empty embeds
+    ///                           every image at full size.
+    /// @param max_variant_bytes  Cap on the size of `variant_dir`.
+    ImageCache(std::filesystem::path variant_dir,
+               ImageScaler scaler,
+               std::size_t max_bytes = kDefaultMaxBytes,
+               std::uintmax_t max_variant_bytes = kDefaultMaxVariantBytes);
+    ~ImageCache();
+
+    // Non-copyable, non-movable
+    ImageCache(const ImageCache&) = delete;
+    auto operator=(const ImageCache&) -> ImageCache& = delete;
+    ImageCache(ImageCache&&) = delete;
+    auto operator=(ImageCache&&) -> ImageCache& = delete;
+
+    struct Entry
+    {
+        std::shared_ptr<const std::string> data_uri; // nullptr if unreadable or pending
+        bool pending{false};                         // A downscaled variant is being produced
+    };
+
+    /// Data URI for the image at `image_path` shown in a preview
+    /// `preview_width` pixels wide (0: always full size).
+    [[nodiscard]] auto lookup(const std::filesystem::path& image_path, int preview_width)
+        -> Entry;
+
+    /// Called on the worker thread after a pending variant became available
+    /// (or turned out not to be needed), e.g. to schedule a re-render.
+    void set_ready_callback(std::function<void()> callback);
+
+    /// Block until no variant is queued or being produced.
+    void wait_idle();
+
+    /// Round `preview_width` up to the width variants are produced for.
+    [[nodiscard]] static auto width_bucket(int preview_width) noexcept -> int;
+
+    struct Stats
+    {
+        std::size_t hits{0};
+        std::size_t misses{0};
+        std::size_t variants_scaled{0};
+        std::size_t variants_loaded{0}; // Read back from variant_dir
+        std::size_t variants_pruned{0}; // Deleted from variant_dir over the cap
+    };
+
+    [[nodiscard]] auto stats() const -> Stats;
+    [[nodiscard]] auto cached_bytes() const -> std::size_t;
+
+private:
+    using DataUri = std::shared_ptr<const std::string>;
+
+    struct VariantJob
+    {
+        std::string key;
+        std::filesystem::path source;
+        std::filesystem::path file;
+        int width{0};
+        std::string mime;
+    };
+
+    std::filesystem::path variant_dir_;
+    ImageScaler scaler_;
+    std::uintmax_t max_variant_bytes_;
+    std::uintmax_t variant_dir_bytes_{0}; // Worker thread only; as of the last prune
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    core::ByteCappedLRU<std::string, DataUri> uris_; // GUARDED_BY(mutex_)
+    std::deque<VariantJob> jobs_;                    // GUARDED_BY(mutex_)
+    std::unordered_set<std::string> in_flight_;      // GUARDED_BY(mutex_)
+    std::unordered_set<std::string> full_size_;      // GUARDED_BY(mutex_) Variant not needed
+    std::function<void()> ready_callback_;           // GUARDED_BY(mutex_)
+    Stats stats_;                                    // GUARDED_BY(mutex_)
+    bool stopping_{false};                           // GUARDED_BY(mutex_)
+    bool startup_prune_pending_{false};              // GUARDED_BY(mutex_)
+    std::thread worker_;
+
+    [[nodiscard]] auto cached(const std::string& key) -> DataUri;
+    void store(const std::string& key, const DataUri& data_uri);
+    void run();
+    static void save_variant(const std::filesystem::path& file, const std::string& bytes);
+
+    /// Delete the least recently used variants until `variant_dir` is back
+    /// under three quarters of the cap (so a prune is not due on every
+    /// write). Worker thread only.
+    void prune_variants();
+};
+
+} // namespace markamp::rendering
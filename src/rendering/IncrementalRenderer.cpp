@@ -0,0 +1,723 @@
+#include "IncrementalRenderer.h"
+
+#include "core/HtmlSanitizer.h"
+#include "core/Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <exception>
+
+namespace markamp::rendering
+{
+
+// ═══════════════════════════════════════════════════════
+// Line classification helpers
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+
+/// Column width of leading whitespace (tabs advance to the next multiple of 4).
+auto indent_width(std::string_view line) -> std::size_t
+{
+    std::size_t width = 0;
+    for (char ch : line)
+    {
+        if (ch == ' ')
+        {
+            ++width;
+        }
+        else if (ch == '\t')
+        {
+            width += 4 - (width % 4);
+        }
+        else
+        {
+            break;
+        }
+    }
+    return width;
+}
+
+auto strip_indent(std::string_view line) -> std::string_view
+{
+    auto first = line.find_first_not_of(" \t");
+    return first == std::string_view::npos ? std::string_view{} : line.substr(first);
+}
+
+auto is_blank(std::string_view line) -> bool
+{
+    return line.find_first_not_of(" \t\r") == std::string_view::npos;
+}
+
+/// True for bullet ("-", "+", "*") and ordered ("1.", "1)") list markers.
+auto is_list_marker(std::string_view line) -> bool
+{
+    if (indent_width(line) > 3)
+    {
+        return false;
+    }
+    auto body = strip_indent(line);
+    if (body.empty())
+    {
+        return false;
+    }
+
+    auto followed_by_space = [&body](std::size_t pos)
+    { return pos >= body.size() || body[pos] == ' ' || body[pos] == '\t' || body[pos] == '\r'; };
+
+    if (body[0] == '-' || body[0] == '+' || body[0] == '*')
+    {
+        return followed_by_space(1);
+    }
+
+    std::size_t digits = 0;
+    while (digits < body.size() && digits < 9 && body[digits] >= '0' && body[digits] <= '9')
+    {
+        ++digits;
+    }
+    if (digits == 0 || digits >= body.size())
+    {
+        return false;
+    }
+    return (body[digits] == '.' || body[digits] == ')') && followed_by_space(digits + 1);
+}
+
+struct Fence
+{
+    char marker{0};
+    std::size_t length{0};
+};
+
+/// Detect an opening code fence (``` or ~~~, indented at most 3 columns).
+auto open_fence(std::string_view line) -> Fence
+{
+    if (indent_width(line) > 3)
+    {
+        return {};
+    }
+    auto body = strip_indent(line);
+    if (body.empty() || (body[0] != '`' && body[0] != '~'))
+    {
+        return {};
+    }
+    const char marker = body[0];
+    auto run = body.find_first_not_of(marker);
+    auto length = run == std::string_view::npos ? body.size() : run;
+    if (length < 3)
+    {
+        return {};
+    }
+    // Backtick fences may not have backticks in their info string
+    if (marker == '`' && body.find('`', length) != std::string_view::npos)
+    {
+        return {};
+    }
+    return Fence{.marker = marker, .length = length};
+}
+
+auto closes_fence(std::string_view line, const Fence& fence) -> bool
+{
+    if (indent_width(line) > 3)
+    {
+        return false;
+    }
+    auto body = strip_indent(line);
+    auto run = body.find_first_not_of(fence.marker);
+    auto length = run == std::string_view::npos ? body.size() : run;
+    return length >= fence.length && is_blank(body.substr(length));
+}
+
+/// Iterate lines as (line_without_newline, line_start, next_line_start).
+template <typename Fn>
+void for_each_line(std::string_view text, Fn&& callback)
+{
+    std::size_t pos = 0;
+    while (pos < text.size())
+    {
+        auto newline = text.find('\n', pos);
+        auto next = newline == std::string_view::npos ? text.size() : newline + 1;
+        auto end = newline == std::string_view::npos ? text.size() : newline;
+        callback(text.substr(pos, end - pos), pos, next);
+        pos = next;
+    }
+}
+
+/// How an HTML block of CommonMark types 1-5 ends. These blocks run until
+/// their end marker, across blank lines; the other HTML block types end at
+/// a blank line like a paragraph.
+enum class HtmlBlockEnd : std::uint8_t
+{
+    kNone,
+    kRawTag,      // <script>, <pre>, <style>, <textarea> ... matching close tag
+    kComment,     // <!-- ... -->
+    kProcessing,  // <? ... ?>
+    kDeclaration, // <!X ... >
+    kCdata,       // <![CDATA[ ... ]]>
+};
+
+constexpr std::array<std::string_view, 4> kRawTags = {"script", "pre", "style", "textarea"};
+
+auto ascii_lower(char ch) -> char
+{
+    return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch - 'A' + 'a') : ch;
+}
+
+auto starts_with_nocase(std::string_view text, std::string_view prefix) -> bool
+{
+    if (text.size() < prefix.size())
+    {
+        return false;
+    }
+    for (std::size_t idx = 0; idx < prefix.size(); ++idx)
+    {
+        if (ascii_lower(text[idx]) != prefix[idx])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+auto contains_nocase(std::string_view text, std::string_view needle) -> bool
+{
+    for (std::size_t pos = 0; pos + needle.size() <= text.size(); ++pos)
+    {
+        if (starts_with_nocase(text.substr(pos), needle))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Detect the start of an HTML block of types 1-5 (indented at most 3 columns).
+auto open_html_block(std::string_view line) -> HtmlBlockEnd
+{
+    if (indent_width(line) > 3)
+    {
+        return HtmlBlockEnd::kNone;
+    }
+    auto body = strip_indent(line);
+    if (body.size() < 2 || body[0] != '<')
+    {
+        return HtmlBlockEnd::kNone;
+    }
+    if (body.starts_with("<!--"))
+    {
+        return HtmlBlockEnd::kComment;
+    }
+    if (body.starts_with("<![CDATA["))
+    {
+        return HtmlBlockEnd::kCdata;
+    }
+    if (body[1] == '?')
+    {
+        return HtmlBlockEnd::kProcessing;
+    }
+    if (body[1] == '!')
+    {
+        const char next = body.size() > 2 ? ascii_lower(body[2]) : '\0';
+        return next >= 'a' && next <= 'z' ? HtmlBlockEnd::kDeclaration : HtmlBlockEnd::kNone;
+    }
+    for (auto tag : kRawTags)
+    {
+        auto rest = body.substr(1);
+        if (!starts_with_nocase(rest, tag))
+        {
+            continue;
+        }
+        if (rest.size() == tag.size())
+        {
+            return HtmlBlockEnd::kRawTag;
+        }
+        const char after = rest[tag.size()];
+        if (after == ' ' || after == '\t' || after == '\r' || after == '>')
+        {
+            return HtmlBlockEnd::kRawTag;
+        }
+    }
+    return HtmlBlockEnd::kNone;
+}
+
+/// True if `line` contains the end condition of an open HTML block. The
+/// marker may sit anywhere on the line, including the block's first line.
+auto closes_html_block(std::string_view line, HtmlBlockEnd end) -> bool
+{
+    switch (end)
+    {
+        case HtmlBlockEnd::kNone:
+            return true;
+        case HtmlBlockEnd::kRawTag:
+            return std::ranges::any_of(kRawTags,
+                                       [line](std::string_view tag)
+                                       {
+                                           std::string close = "</";
+                                           close.append(tag);
+                                           close += '>';
+                                           return contains_nocase(line, close);
+                                       });
+        case HtmlBlockEnd::kComment:
+            return line.find("-->") != std::string_view::npos;
+        case HtmlBlockEnd::kProcessing:
+            return line.find("?>") != std::string_view::npos;
+        case HtmlBlockEnd::kDeclaration:
+            return line.find('>') != std::string_view::npos;
+        case HtmlBlockEnd::kCdata:
+            return line.find("]]>") != std::string_view::npos;
+    }
+    return true;
+}
+
+/// A construct that swallows every following line, blank or not, until its
+/// end: a fenced code block or an HTML block of types 1-5.
+struct OpenBlock
+{
+    Fence fence;
+    HtmlBlockEnd html{HtmlBlockEnd::kNone};
+
+    [[nodiscard]] auto is_open() const -> bool
+    {
+        return fence.marker != 0 || html != HtmlBlockEnd::kNone;
+    }
+
+    /// Feed a line that belongs to the open block; closes it on its end line.
+    void continue_with(std::string_view line)
+    {
+        if (fence.marker != 0 && closes_fence(line, fence))
+        {
+            fence = {};
+        }
+        else if (html != HtmlBlockEnd::kNone && closes_html_block(line, html))
+        {
+            html = HtmlBlockEnd::kNone;
+        }
+    }
+
+    /// Feed a line outside any open block; opens one if the line starts one
+    /// that does not also end on it.
+    void start_with(std::string_view line)
+    {
+        fence = open_fence(line);
+        if (fence.marker != 0)
+        {
+            return;
+        }
+        html = open_html_block(line);
+        if (html != HtmlBlockEnd::kNone && closes_html_block(line, html))
+        {
+            html = HtmlBlockEnd::kNone;
+        }
+    }
+};
+
+/// Whether `text` ends inside a fence or a type 1-5 HTML block, which would
+/// swallow anything appended to it.
+auto leaves_block_open(std::string_view text) -> bool
+{
+    OpenBlock open;
+    for_each_line(text,
+                  [&open](std::string_view line, std::size_t /*start*/, std::size_t /*next*/)
+                  {
+                      if (open.is_open())
+                      {
+                          open.continue_with(line);
+                      }
+                      else
+                      {
+                          open.start_with(line);
+                      }
+                  });
+    return open.is_open();
+}
+
+/// Link reference definitions ("[label]: url") are document-global in
+/// CommonMark, so every block must see all of them to resolve links.
+auto is_reference_definition(std::string_view line) -> bool
+{
+    if (indent_width(line) > 3)
+    {
+        return false;
+    }
+    auto body = strip_indent(line);
+    if (body.size() < 4 || body[0] != '[' || body[1] == '^')
+    {
+        return false;
+    }
+    auto close = body.find("]:");
+    return close != std::string_view::npos && close > 1;
+}
+
+auto collect_reference_definitions(std::string_view markdown) -> std::string
+{
+    std::string definitions;
+    OpenBlock open;
+    bool take_title_line = false;
+
+    for_each_line(markdown,
+                  [&](std::string_view line, std::size_t /*start*/, std::size_t /*next*/)
+                  {
+                      if (open.is_open())
+                      {
+                          open.continue_with(line);
+                          return;
+                      }
+                      open.start_with(line);
+                      if (open.is_open())
+                      {
+                          take_title_line = false;
+                          return;
+                      }
+
+                      // A title may sit on the line after the destination
+                      if (take_title_line)
+                      {
+                          take_title_line = false;
+                          auto body = strip_indent(line);
+                          if (!body.empty() &&
+                              (body[0] == '"' || body[0] == '\'' || body[0] == '('))
+                          {
+                              definitions.append(line);
+                              definitions += '\n';
+                              return;
+                          }
+                      }
+
+                      if (is_reference_definition(line))
+                      {
+                          definitions.append(line);
+                          definitions += '\n';
+                          take_title_line = true;
+                      }
+                  });
+    return definitions;
+}
+
+/// Record, in render order, the document-wide state a fragment consumes:
+/// heading base slugs (with their prior occurrence counts) and code blocks,
+/// and the on-disk state of the images it embeds.
+void collect_fragment_state(const core::MdNode& node,
+                            const HtmlRenderer& renderer,
+                            std::vector<std::string>& heading_slugs,
+                            std::vector<int>& slug_occurrences,
+                            std::vector<std::string>& code_sources,
+                            std::vector<std::pair<std::string, std::string>>& images)
+{
+    using core::MdNodeType;
+
+    if (node.type == MdNodeType::Heading)
+    {
+        auto slug = HtmlRenderer::slugify(node.plain_text());
+        if (!slug.empty())
+        {
+            auto prior = std::count(heading_slugs.begin(), heading_slugs.end(), slug);
+            slug_occurrences.push_back(renderer.heading_slug_occurrences(slug) +
+                                       static_cast<int>(prior));
+            heading_slugs.push_back(std::move(slug));
+        }
+    }
+    else if (node.type == MdNodeType::CodeBlock || node.type == MdNodeType::FencedCodeBlock)
+    {
+        code_sources.push_back(node.text_content);
+    }
+    else if (node.type == MdNodeType::Image)
+    {
+        images.emplace_back(node.url, renderer.image_stamp(node.url));
+    }
+
+    for (const auto& child : node.children)
+    {
+        collect_fragment_state(
+            child, renderer, heading_slugs, slug_occurrences, code_sources, images);
+    }
+}
+
+} // anonymous namespace
+
+// ═══════════════════════════════════════════════════════
+// Block splitting
+// ═══════════════════════════════════════════════════════
+
+auto split_top_level_blocks(std::string_view markdown) -> std::vector<BlockRange>
+{
+    std::vector<BlockRange> ranges;
+
+    constexpr auto kNoBlock = std::string_view::npos;
+    std::size_t block_start = kNoBlock;
+    std::size_t block_end = 0; // End of the last non-blank line in the open block
+    bool saw_blank = false;
+    bool list_block = false; // A line of the open block starts a list item
+    OpenBlock open;
+
+    for_each_line(markdown,
+                  [&](std::string_view line, std::size_t start, std::size_t next)
+                  {
+                      // Everything up to the closing fence or HTML end marker
+                      // belongs to the open block, blank lines included
+                      if (open.is_open())
+                      {
+                          open.continue_with(line);
+                          block_end = next;
+                          return;
+                      }
+
+                      if (is_blank(line))
+                      {
+                          saw_blank = block_start != kNoBlock;
+                          return;
+                      }
+
+                      if (block_start != kNoBlock && saw_blank)
+                      {
+                          // Indented lines continue list items and indented code;
+                          // list markers continue a loose list. Keeping them in the
+                          // same range is always safe, splitting would not be.
+                          const bool continues =
+                              indent_width(line) > 0 || (list_block && is_list_marker(line));
+                          if (!continues)
+                          {
+                              ranges.push_back({block_start, block_end - block_start});
+                              block_start = kNoBlock;
+                          }
+                      }
+
+                      if (block_start == kNoBlock)
+                      {
+                          block_start = start;
+                          list_block = false;
+                      }
+                      // A list may start mid-block ("para\n- a"); later items
+                      // after a blank line still belong to it
+                      list_block = list_block || is_list_marker(line);
+                      saw_blank = false;
+                      block_end = next;
+                      open.start_with(line);
+                  });
+
+    if (block_start != kNoBlock)
+    {
+        ranges.push_back({block_start, block_end - block_start});
+    }
+    return ranges;
+}
+
+// ═══════════════════════════════════════════════════════
+// IncrementalRenderer
+// ═══════════════════════════════════════════════════════
+
+IncrementalRenderer::IncrementalRenderer(HtmlRenderer& renderer)
+    : renderer_(renderer)
+{
+}
+
+auto IncrementalRenderer::render(std::string_view markdown, const core::CancelToken* cancel)
+    -> std::expected<std::string, std::string>
+{
+    std::string output;
+    output.reserve(std::max(last_output_size_, static_cast<std::size_t>(512)));
+    auto result = render_into(markdown, output, cancel);
+    if (!result.has_value())
+    {
+        return std::unexpected(std::move(result.error()));
+    }
+    return output;
+}
+
+auto IncrementalRenderer::render_into(std::string_view markdown,
+                                      std::string& output,
+                                      const core::CancelToken* cancel)
+    -> std::expected<void, std::string>
+{
+    MARKAMP_PROFILE_SCOPE("IncrementalRenderer::render");
+    const auto start = output.size();
+    try
+    {
+        // Footnote numbering is document-wide, so it runs over the whole text first
+        FootnotePreprocessor footnote_processor;
+        auto footnote_result = footnote_processor.process(markdown);
+        const std::string_view source = footnote_result.processed_markdown;
+
+        auto definitions = collect_reference_definitions(source);
+        if (definitions != reference_definitions_)
+        {
+            reference_definitions_ = std::move(definitions);
+            generation_.bump();
+        }
+
+        const auto ranges = split_top_level_blocks(source);
+
+        renderer_.begin_document();
+        stats_ = Stats{.blocks_total = ranges.size()};
+        last_blocks_.clear();
+        last_blocks_.reserve(ranges.size());
+
+        output.reserve(start + last_output_size_);
+
+        BlockCache next_cache;
+        next_cache.reserve(ranges.size());
+        duplicates_.clear();
+
+        for (const auto& range : ranges)
+        {
+            if (cancel != nullptr && cancel->stop_requested())
+            {
+                // Hand the blocks claimed so far back to the cache
+                cache_.merge(next_cache);
+                output.resize(start);
+                return std::unexpected(std::string(kCancelled));
+            }
+
+            const auto text = source.substr(range.offset, range.length);
+
+            CachedBlock* block = nullptr;
+            bool stale = false;
+            if (auto used = next_cache.find(text); used != next_cache.end())
+            {
+                block = &used->second;
+                if (!is_reusable(*block))
+                {
+                    block = &duplicates_.emplace_back();
+                    stale = true;
+                }
+            }
+            else if (auto cached = cache_.find(text); cached != cache_.end())
+            {
+                auto inserted = next_cache.insert(cache_.extract(cached));
+                block = &inserted.position->second;
+                stale = !is_reusable(*block);
+            }
+            else
+            {
+                block = &next_cache.try_emplace(std::string(text)).first->second;
+                stale = true;
+            }
+
+            if (stale)
+            {
+                auto result = render_block(text, *block);
+                if (!result.has_value())
+                {
+                    output.resize(start);
+                    return std::unexpected(result.error());
+                }
+                ++stats_.blocks_rendered;
+            }
+            else
+            {
+                renderer_.skip_fragment(block->heading_slugs, block->code_sources);
+                ++stats_.blocks_reused;
+            }
+
+            output += block->html;
+            last_blocks_.push_back(&block->document.root);
+        }
+
+        // Blocks not present in this version are dropped with the old map
+        cache_.swap(next_cache);
+
+        if (footnote_result.has_footnotes)
+        {
+            if (sanitizer_ != nullptr)
+            {
+                sanitizer_->sanitize_into(footnote_result.footnote_section_html, output);
+            }
+            else
+            {
+                output += footnote_result.footnote_section_html;
+            }
+        }
+        last_output_size_ = output.size() - start;
+        return {};
+    }
+    catch (const std::exception& ex)
+    {
+        output.resize(start);
+        return std::unexpected(std::string("incremental render failed: ") + ex.what());
+    }
+}
+
+auto IncrementalRenderer::is_reusable(const CachedBlock& block) const -> bool
+{
+    // A pending placeholder is replaced once its image or diagram is ready
+    if (block.pending || block.generation != generation_.current() ||
+        block.first_code_block_id != renderer_.code_block_count())
+    {
+        return false;
+    }
+
+    // Heading IDs get "-N" suffixes from earlier duplicates; an edit above
+    // this block may have shifted them.
+    for (std::size_t idx = 0; idx < block.heading_slugs.size(); ++idx)
+    {
+        const auto& slug = block.heading_slugs[idx];
+        auto prior = std::count(block.heading_slugs.begin(),
+                                block.heading_slugs.begin() + static_cast<std::ptrdiff_t>(idx),
+                                slug);
+        if (renderer_.heading_slug_occurrences(slug) + static_cast<int>(prior) !=
+            block.slug_occurrences[idx])
+        {
+            return false;
+        }
+    }
+
+    // The fragment embeds each local image's data URI; a changed file on
+    // disk needs a fresh one
+    return std::ranges::all_of(block.images,
+                               [this](const auto& image)
+                               { return renderer_.image_stamp(image.first) == image.second; });
+}
+
+auto IncrementalRenderer::render_block(std::string_view text, CachedBlock& block)
+    -> std::expected<void, std::string>
+{
+    std::string with_definitions;
+    std::string_view parse_input = text;
+    // A block ending inside a fence or HTML block would swallow the
+    // definitions as content; such a block runs to the end of the document,
+    // where the full render has nothing after it either.
+    if (!reference_definitions_.empty() && !leaves_block_open(text))
+    {
+        with_definitions.reserve(text.size() + 2 + reference_definitions_.size());
+        with_definitions.append(text);
+        with_definitions += "\n\n";
+        with_definitions += reference_definitions_;
+        parse_input = with_definitions;
+    }
+
+    auto doc_result = parser_.parse(parse_input);
+    if (!doc_result.has_value())
+    {
+        return std::unexpected(doc_result.error());
+    }
+
+    block.document = std::move(*doc_result);
+    block.html.clear();
+    block.heading_slugs.clear();
+    block.slug_occurrences.clear();
+    block.code_sources.clear();
+    block.images.clear();
+    block.first_code_block_id = renderer_.code_block_count();
+    block.generation = generation_.current();
+
+    collect_fragment_state(block.document.root,
+                           renderer_,
+                           block.heading_slugs,
+                           block.slug_occurrences,
+                           block.code_sources,
+                           block.images);
+    const auto pending_before = renderer_.pending_placeholders();
+    if (sanitizer_ == nullptr)
+    {
+        renderer_.render_fragment(block.document.root, block.html);
+    }
+    else
+    {
+        fragment_scratch_.clear();
+        renderer_.render_fragment(block.document.root, fragment_scratch_);
+        sanitizer_->sanitize_into(fragment_scratch_, block.html);
+    }
+    block.pending = renderer_.pending_placeholders() != pending_before;
+    return {};
+}
+
+} // namespace markamp::rendering
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "HtmlRenderer.h"
+#include "core/CoalescingTask.h"
+#include "core/GenerationCounter.h"
+#include "core/Md4cWrapper.h"
+#include "core/Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace markamp::core
+{
+class HtmlSanitizer;
+} // namespace markamp::core
+
+namespace markamp::rendering
+{
+
+/// Byte range of one top-level Markdown block within a document.
+struct BlockRange
+{
+    std::size_t offset{0};
+    std::size_t length{0};
+};
+
+/// Split a document into independently parseable top-level block ranges.
+///
+/// Blocks are separated by blank lines, except where CommonMark would carry
+/// the construct across the blank line: open fences, HTML blocks that run
+/// to an end marker (comments, <pre>, <script>, <style>, <textarea>, <?, <!X,
+/// CDATA), indented continuation lines (list items, indented code) and list
+/// items of a loose list are kept in the same range. Blank separator lines
+/// are not part of any range.
+[[nodiscard]] auto split_top_level_blocks(std::string_view markdown) -> std::vector<BlockRange>;
+
+/// Block-level incremental Markdown → HTML renderer.
+///
+/// Splits the document into top-level blocks and caches each block's parsed
+/// MdNode subtree and HTML fragment, keyed by the block's source text. On the
+/// next render only blocks whose text changed are re-parsed with md4c and
+/// re-rendered; everything else is spliced from the cache. Because ranges are
+/// recomputed on every call, an edit that opens a fence or joins two blocks
+/// simply produces new keys for the affected neighbours.
+///
+/// Cached fragments are only reused when the document-wide state they depend
+/// on (heading slug suffixes, code block IDs, link reference definitions,
+/// renderer configuration generation) matches what a full render would see,
+/// and the local images they embed are unchanged on disk, so the output is
+/// identical to HtmlRenderer::render on the whole document.
+class IncrementalRenderer
+{
+public:
+    /// @param renderer  Renderer used for fragments; its Mermaid/math/base-path
+    ///                  configuration applies. Must outlive this object.
+    explicit IncrementalRenderer(HtmlRenderer& renderer);
+
+    /// Render a full document (footnotes included) to an HTML body.
+    /// When `cancel` is given it is checked between blocks; a cancelled render
+    /// returns kCancelled and keeps the cache intact for the next call.
+    [[nodiscard]] auto render(std::string_view markdown, const core::CancelToken* cancel = nullptr)
+        -> std::expected<std::string, std::string>;
+
+    /// Like render(), but appends the HTML to `output` so one buffer can be
+    /// reused across renders. On error `output` is left as it was.
+    [[nodiscard]] auto render_into(std::string_view markdown,
+                                   std::string& output,
+                                   const core::CancelToken* cancel = nullptr)
+        -> std::expected<void, std::string>;
+
+    /// Sanitize fragments with `sanitizer` (nullptr: emit them as rendered).
+    /// Fragments are cached sanitized, so reused blocks are not sanitized
+    /// again. `sanitizer` must outlive this object.
+    void set_sanitizer(const core::HtmlSanitizer* sanitizer) noexcept
+    {
+        sanitizer_ = sanitizer;
+        generation_.bump();
+    }
+
+    /// Error string returned by render() when the CancelToken fired.
+    static constexpr std::string_view kCancelled = "cancelled";
+
+    /// Drop all cached fragments on the next render (e.g. after the renderer's
+    /// Mermaid, math or base-path configuration changed).
+    void invalidate() noexcept
+    {
+        generation_.bump();
+    }
+
+    /// Counters from the most recent render().
+    struct Stats
+    {
+        std::size_t blocks_total{0};
+        std::size_t blocks_reused{0};
+        std::size_t blocks_rendered{0};
+    };
+
+    [[nodiscard]] auto last_stats() const noexcept -> const Stats&
+    {
+        return stats_;
+    }
+
+    /// Per-block ASTs of the most recent render, in document order.
+    /// Pointers stay valid until the next render() call.
+    [[nodiscard]] auto last_blocks() const noexcept -> const std::vector<const core::MdNode*>&
+    {
+        return last_blocks_;
+    }
+
+    /// Number of cached blocks.
+    [[nodiscard]] auto cache_size() const noexcept -> std::size_t
+    {
+        return cache_.size();
+    }
+
+private:
+    struct CachedBlock
+    {
+        core::MarkdownDocument document;
+        std::string html;
+        std::vector<std::string> heading_slugs;
+        std::vector<int> slug_occurrences;
+        std::vector<std::string> code_sources;
+        std::vector<std::pair<std::string, std::string>> images; // URL, HtmlRenderer::image_stamp
+        int first_code_block_id{0};
+        uint64_t generation{0};
+        bool pending{false}; // Shows a placeholder for an image or diagram still in the works
+    };
+
+    struct TransparentHash
+    {
+        using is_transparent = void;
+        auto operator()(std::string_view text) const noexcept -> std::size_t
+        {
+            return std::hash<std::string_view>{}(text);
+        }
+    };
+
+    using BlockCache =
+        std::unordered_map<std::string, CachedBlock, TransparentHash, std::equal_to<>>;
+
+    [[nodiscard]] auto is_reusable(const CachedBlock& block) const -> bool;
+    [[nodiscard]] auto render_block(std::string_view text, CachedBlock& block)
+        -> std::expected<void, std::string>;
+
+    HtmlRenderer& renderer_;
+    const core::HtmlSanitizer* sanitizer_{nullptr};
+    core::Md4cParser parser_;
+    core::GenerationCounter generation_;
+    BlockCache cache_;
+    std::deque<CachedBlock> duplicates_; // Repeated blocks rendered in a different context
+    std::string reference_definitions_;
+    std::vector<const core::MdNode*> last_blocks_;
+    std::string fragment_scratch_; // Unsanitized HTML of the block being rendered
+    std::size_t last_output_size_{0};
+    Stats stats_;
+};
+
+} // namespace markamp::rendering
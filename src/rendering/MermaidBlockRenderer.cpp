@@ -19,8 +19,14 @@ constexpr std::string_view kBase64Chars =
 auto MermaidBlockRenderer::render(std::string_view mermaid_source, core::IMermaidRenderer& renderer)
     -> std::string
 {
-    auto result = renderer.render(mermaid_source);
+    auto pending = renderer.try_render(mermaid_source);
+    pending_ = !pending.has_value();
+    if (pending_)
+    {
+        return render_pending();
+    }
 
+    auto& result = *pending;
     if (!result)
     {
         return render_error(result.error());
@@ -59,6 +65,11 @@ auto MermaidBlockRenderer::render_unavailable() -> std::string
     return html;
 }
 
+auto MermaidBlockRenderer::render_pending() -> std::string
+{
+    return "<div class=\"mermaid-block\">\n<em>Rendering diagram...</em>\n</div>\n";
+}
+
 auto MermaidBlockRenderer::render_placeholder(std::string_view mermaid_source) -> std::string
 {
     std::string html;
@@ -16,16 +16,27 @@ class MermaidBlockRenderer
 {
 public:
     /// Render a Mermaid diagram source using the given renderer.
-    /// Returns container HTML with the SVG image or error overlay.
+    /// Returns container HTML with the SVG image or error overlay, or a
+    /// pending placeholder while the renderer produces the diagram in the
+    /// background (IMermaidRenderer::try_render).
     [[nodiscard]] auto render(std::string_view mermaid_source, core::IMermaidRenderer& renderer)
         -> std::string;
 
+    /// True if the last render() returned the pending placeholder.
+    [[nodiscard]] auto pending() const -> bool
+    {
+        return pending_;
+    }
+
     /// Render an error overlay with the given message.
     [[nodiscard]] static auto render_error(const std::string& error_message) -> std::string;
 
     /// Render a placeholder when no renderer is available.
     [[nodiscard]] static auto render_unavailable() -> std::string;
 
+    /// Render a placeholder for a diagram that is still being rendered.
+    [[nodiscard]] static auto render_pending() -> std::string;
+
     /// Render a placeholder div with the source stored as data attribute (fallback).
     [[nodiscard]] static auto render_placeholder(std::string_view mermaid_source) -> std::string;
 
@@ -43,6 +54,8 @@ public:
     render_diagnostics(const std::vector<core::MermaidDiagnosticInfo>& diagnostics) -> std::string;
 
 private:
+    bool pending_{false};
+
     /// Escape HTML special characters in text.
     [[nodiscard]] static auto escape_html(std::string_view text) -> std::string;
 
@@ -0,0 +1,211 @@
+#include "PreviewPipeline.h"
+
+#include "core/Profiler.h"
+
+#include <exception>
+
+namespace markamp::rendering
+{
+
+// ═══════════════════════════════════════════════════════
+// PreviewRenderer — thread-confined stages
+// ═══════════════════════════════════════════════════════
+
+PreviewRenderer::PreviewRenderer()
+{
+    incremental_.set_sanitizer(&sanitizer_);
+}
+
+void PreviewRenderer::apply_settings(const PreviewRenderSettings& settings)
+{
+    renderer_.set_mermaid_renderer(settings.mermaid_renderer);
+    renderer_.set_mermaid_enabled(settings.mermaid_enabled);
+    renderer_.set_math_renderer(settings.math_renderer);
+    renderer_.set_base_path(settings.base_path);
+    renderer_.set_image_cache(settings.image_cache, settings.image_width);
+    incremental_enabled_ = settings.incremental;
+    incremental_.invalidate();
+}
+
+auto PreviewRenderer::run(const core::DocumentSnapshot& snapshot,
+                          const core::CancelToken& cancel,
+                          std::string buffer) -> std::optional<RenderedPreview>
+{
+    MARKAMP_PROFILE_SCOPE("PreviewRenderer::run");
+
+    RenderedPreview preview;
+    preview.version = snapshot.version;
+    preview.markdown = snapshot.content;
+    if (!snapshot.content)
+    {
+        return preview;
+    }
+
+    const auto& markdown = *snapshot.content;
+    if (markdown.size() > kMaxContentSize)
+    {
+        preview.error = "Content too large to render (> 10MB)";
+        return preview;
+    }
+
+    // Stability #21: wrap entire render pipeline in try-catch
+    try
+    {
+        // Blocks are sanitized (defense-in-depth) as they are rendered
+        preview.body_html = std::move(buffer);
+        preview.body_html.clear();
+        std::expected<void, std::string> rendered;
+        if (incremental_enabled_)
+        {
+            // Re-parse and re-render only the top-level blocks that changed
+            rendered = incremental_.render_into(markdown, preview.body_html, &cancel);
+            if (!rendered.has_value() && rendered.error() == IncrementalRenderer::kCancelled)
+            {
+                return std::nullopt;
+            }
+        }
+        else
+        {
+            auto full = render_full(markdown, preview.body_html, cancel);
+            if (!full.has_value())
+            {
+                return std::nullopt;
+            }
+            rendered = std::move(*full);
+        }
+
+        if (!rendered.has_value())
+        {
+            preview.body_html.clear();
+            preview.error = std::move(rendered.error());
+            return preview;
+        }
+        if (cancel.stop_requested())
+        {
+            return std::nullopt;
+        }
+
+        preview.code_block_sources = renderer_.code_renderer().block_sources();
+    }
+    catch (const std::exception& ex)
+    {
+        preview.body_html.clear();
+        preview.error = std::string("Rendering failed: ") + ex.what();
+    }
+    return preview;
+}
+
+auto PreviewRenderer::render_full(const std::string& markdown,
+                                  std::string& output,
+                                  const core::CancelToken& cancel)
+    -> std::optional<std::expected<void, std::string>>
+{
+    // Pre-process footnotes (md4c doesn't support them natively)
+    FootnotePreprocessor footnote_processor;
+    auto footnote_result = footnote_processor.process(markdown);
+    if (cancel.stop_requested())
+    {
+        return std::nullopt;
+    }
+
+    auto doc_result = parser_.parse(footnote_result.processed_markdown);
+    if (!doc_result.has_value())
+    {
+        return std::unexpected(doc_result.error());
+    }
+    if (cancel.stop_requested())
+    {
+        return std::nullopt;
+    }
+
+    renderer_.render_into(
+        *doc_result, output, &sanitizer_, footnote_result.footnote_section_html);
+    return std::expected<void, std::string>{};
+}
+
+// ═══════════════════════════════════════════════════════
+// PreviewPipeline — UI thread ⇄ worker
+// ═══════════════════════════════════════════════════════
+
+PreviewPipeline::PreviewPipeline(ResultNotifier on_result_ready)
+    : pipeline_([this](const core::DocumentSnapshot& snapshot, core::CancelToken cancel)
+                { return process(snapshot, std::move(cancel)); },
+                std::move(on_result_ready))
+{
+}
+
+void PreviewPipeline::set_settings(PreviewRenderSettings settings)
+{
+    std::lock_guard lock(settings_mutex_);
+    settings_ = std::move(settings);
+    ++settings_generation_;
+}
+
+void PreviewPipeline::invalidate()
+{
+    std::lock_guard lock(settings_mutex_);
+    ++settings_generation_;
+}
+
+auto PreviewPipeline::submit(std::shared_ptr<const std::string> markdown) -> uint64_t
+{
+    core::DocumentSnapshot snapshot;
+    snapshot.version = ++latest_version_;
+    snapshot.content = std::move(markdown);
+    pipeline_.submit(std::move(snapshot));
+    return latest_version_;
+}
+
+void PreviewPipeline::recycle(std::string buffer)
+{
+    std::lock_guard lock(buffers_mutex_);
+    if (spare_buffers_.size() < kMaxSpareBuffers && buffer.capacity() != 0)
+    {
+        spare_buffers_.push_back(std::move(buffer));
+    }
+}
+
+auto PreviewPipeline::take_latest() -> std::optional<RenderedPreview>
+{
+    std::optional<RenderedPreview> newest;
+    RenderedPreview preview;
+    while (pipeline_.try_get_result(preview))
+    {
+        if (!newest || preview.version > newest->version)
+        {
+            newest = std::move(preview);
+        }
+    }
+
+    // Drop results from generations that were superseded after they started
+    if (newest && newest->version < latest_version_)
+    {
+        return std::nullopt;
+    }
+    return newest;
+}
+
+auto PreviewPipeline::process(const core::DocumentSnapshot& snapshot, core::CancelToken cancel)
+    -> std::optional<RenderedPreview>
+{
+    {
+        std::lock_guard lock(settings_mutex_);
+        if (applied_generation_ != settings_generation_)
+        {
+            renderer_.apply_settings(settings_);
+            applied_generation_ = settings_generation_;
+        }
+    }
+    std::string buffer;
+    {
+        std::lock_guard lock(buffers_mutex_);
+        if (!spare_buffers_.empty())
+        {
+            buffer = std::move(spare_buffers_.back());
+            spare_buffers_.pop_back();
+        }
+    }
+    return renderer_.run(snapshot, cancel, std::move(buffer));
+}
+
+} // namespace markamp::rendering
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "HtmlRenderer.h"
+#include "IncrementalRenderer.h"
+#include "core/AsyncPipeline.h"
+#include "core/DocumentSnapshot.h"
+#include "core/HtmlSanitizer.h"
+#include "core/Md4cWrapper.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace markamp::core
+{
+class IMermaidRenderer;
+class IMathRenderer;
+} // namespace markamp::core
+
+namespace markamp::rendering
+{
+
+class ImageCache;
+
+/// Result of one preview pipeline run, handed to the UI thread.
+struct RenderedPreview
+{
+    uint64_t version{0};                         // DocumentSnapshot::version it was built from
+    std::shared_ptr<const std::string> markdown; // Source text (kept for re-render and export)
+    std::string body_html;                       // Sanitized body HTML; empty on error
+    std::string error;                           // Non-empty if parsing or rendering failed
+    std::vector<std::string> code_block_sources; // Indexed by markamp://copy/{id}
+};
+
+/// Renderer configuration set on the UI thread and applied by the worker.
+struct PreviewRenderSettings
+{
+    std::filesystem::path base_path;
+    core::IMermaidRenderer* mermaid_renderer{nullptr};
+    core::IMathRenderer* math_renderer{nullptr};
+    ImageCache* image_cache{nullptr}; // Thread-safe; shared with the UI thread
+    int image_width{0};               // Preview width large images are scaled to
+    bool mermaid_enabled{true};
+    bool incremental{true};
+};
+
+/// The preview stages (footnotes → parse → render → sanitize) for a single
+/// thread. Not thread-safe: owned by the PreviewPipeline worker, or used
+/// directly for synchronous rendering and tests.
+class PreviewRenderer
+{
+public:
+    PreviewRenderer();
+
+    /// Reconfigure the renderer; drops cached incremental fragments.
+    void apply_settings(const PreviewRenderSettings& settings);
+
+    /// Run all stages for a snapshot. Returns std::nullopt if `cancel` fired
+    /// between stages; parse/render failures are reported via `error`.
+    /// The HTML is rendered and sanitized straight into `buffer` (reusing
+    /// its capacity), which becomes the result's body_html.
+    [[nodiscard]] auto run(const core::DocumentSnapshot& snapshot,
+                           const core::CancelToken& cancel,
+                           std::string buffer = {}) -> std::optional<RenderedPreview>;
+
+    /// Stability #23: documents larger than this are rejected, not rendered.
+    static constexpr std::size_t kMaxContentSize = static_cast<std::size_t>(10) * 1024 * 1024;
+
+private:
+    [[nodiscard]] auto render_full(const std::string& markdown,
+                                   std::string& output,
+                                   const core::CancelToken& cancel)
+        -> std::optional<std::expected<void, std::string>>;
+
+    HtmlRenderer renderer_;
+    IncrementalRenderer incremental_{renderer_};
+    core::Md4cParser parser_;
+    core::HtmlSanitizer sanitizer_;
+    bool incremental_enabled_{true};
+};
+
+/// Runs the Markdown preview pipeline on a background AsyncPipeline worker.
+///
+/// The UI thread submits snapshots and later calls take_latest() (typically
+/// from the notifier passed to the constructor, marshalled back with
+/// CallAfter). Submissions coalesce latest-wins, the worker checks for
+/// cancellation between stages, and results older than the most recent
+/// submission are dropped so a slow render never overwrites a newer one.
+class PreviewPipeline
+{
+public:
+    using ResultNotifier = std::function<void()>;
+
+    /// @param on_result_ready  Called on the worker thread when a result is queued.
+    explicit PreviewPipeline(ResultNotifier on_result_ready = {});
+    ~PreviewPipeline() = default;
+
+    PreviewPipeline(const PreviewPipeline&) = delete;
+    auto operator=(const PreviewPipeline&) -> PreviewPipeline& = delete;
+    PreviewPipeline(PreviewPipeline&&) = delete;
+    auto operator=(PreviewPipeline&&) -> PreviewPipeline& = delete;
+
+    /// Replace the renderer configuration (applied before the next job).
+    void set_settings(PreviewRenderSettings settings);
+
+    /// Force the next job to re-render every block (e.g. theme change).
+    void invalidate();
+
+    /// Queue a render of `markdown`. Returns the snapshot version assigned.
+    auto submit(std::shared_ptr<const std::string> markdown) -> uint64_t;
+
+    /// Hand back a displayed result's body_html once it is no longer needed;
+    /// the worker renders the next result into its capacity.
+    void recycle(std::string buffer);
+
+    /// Mark every in-flight job as stale without submitting new work.
+    void discard_pending() noexcept
+    {
+        ++latest_version_;
+    }
+
+    /// Drain queued results and return the newest one, or std::nullopt if
+    /// nothing arrived or it belongs to a superseded submission.
+    [[nodiscard]] auto take_latest() -> std::optional<RenderedPreview>;
+
+    /// Version of the most recent submission (or discard).
+    [[nodiscard]] auto latest_version() const noexcept -> uint64_t
+    {
+        return latest_version_;
+    }
+
+private:
+    [[nodiscard]] auto process(const core::DocumentSnapshot& snapshot, core::CancelToken cancel)
+        -> std::optional<RenderedPreview>;
+
+    // UI thread
+    uint64_t latest_version_{0};
+
+    // Shared: settings handed from the UI thread to the worker
+    std::mutex settings_mutex_;
+    PreviewRenderSettings settings_;  // GUARDED_BY(settings_mutex_)
+    uint64_t settings_generation_{1}; // GUARDED_BY(settings_mutex_)
+
+    // Shared: consumed body_html buffers handed back by the UI thread
+    static constexpr std::size_t kMaxSpareBuffers = 2;
+    std::mutex buffers_mutex_;
+    std::vector<std::string> spare_buffers_; // GUARDED_BY(buffers_mutex_)
+
+    // Worker thread
+    PreviewRenderer renderer_;
+    uint64_t applied_generation_{0};
+
+    // Declared last: the worker starts after, and is joined before, everything above
+    core::AsyncPipeline<core::DocumentSnapshot, RenderedPreview> pipeline_;
+};
+
+} // namespace markamp::rendering
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <wx/stc/stc.h>
+
+#include <utility>
+
+namespace markamp::ui
+{
+
+/// Counted reference to a Scintilla document: the text, undo history,
+/// styling, fold levels and save point of one open file.
+///
+/// Any number of editors can show a document (SetDocPointer() takes its own
+/// reference); copies of the handle share it and the last reference frees
+/// it. `owner` only routes the reference-count calls and must outlive the
+/// handle. Obtain handles from EditorPanel::CreateDocument().
+class EditorDocument
+{
+public:
+    EditorDocument() = default;
+
+    /// Adopt a reference the caller already holds, e.g. from CreateDocument().
+    EditorDocument(wxStyledTextCtrl* owner, void* document) noexcept
+        : owner_(owner)
+        , document_(document)
+    {
+    }
+
+    ~EditorDocument()
+    {
+        reset();
+    }
+
+    EditorDocument(const EditorDocument& other)
+        : owner_(other.owner_)
+        , document_(other.document_)
+    {
+        if (document_ != nullptr)
+        {
+            owner_->AddRefDocument(document_);
+        }
+    }
+
+    auto operator=(const EditorDocument& other) -> EditorDocument&
+    {
+        EditorDocument copy(other);
+        swap(copy);
+        return *this;
+    }
+
+    EditorDocument(EditorDocument&& other) noexcept
+        : owner_(std::exchange(other.owner_, nullptr))
+        , document_(std::exchange(other.document_, nullptr))
+    {
+    }
+
+    auto operator=(EditorDocument&& other) noexcept -> EditorDocument&
+    {
+        EditorDocument moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+
+    void swap(EditorDocument& other) noexcept
+    {
+        std::swap(owner_, other.owner_);
+        std::swap(document_, other.document_);
+    }
+
+    /// Drop this reference.
+    void reset() noexcept
+    {
+        if (document_ != nullptr)
+        {
+            owner_->ReleaseDocument(document_);
+        }
+        owner_ = nullptr;
+        document_ = nullptr;
+    }
+
+    /// The Scintilla document pointer (for SetDocPointer / comparisons).
+    [[nodiscard]] auto get() const noexcept -> void*
+    {
+        return document_;
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return document_ != nullptr;
+    }
+
+private:
+    wxStyledTextCtrl* owner_{nullptr};
+    void* document_{nullptr};
+};
+
+} // namespace markamp::ui
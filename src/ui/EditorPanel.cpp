@@ -4,6 +4,7 @@
 #include "ImagePreviewPopover.h"
 #include "LinkPreviewPopover.h"
 #include "TableEditorOverlay.h"
+#include "core/AsyncHighlighter.h"
 #include "core/BuiltInPlugins.h"
 #include "core/Config.h"
 #include "core/Events.h"
@@ -12,12 +13,16 @@
 
 #include <wx/button.h>
 #include <wx/datetime.h>
+#include <wx/dcclient.h>
+#include <wx/dcmemory.h>
+#include <wx/image.h>
 #include <wx/numdlg.h>
 #include <wx/sizer.h>
 #include <wx/stattext.h>
 #include <wx/textctrl.h>
 #include <wx/tglbtn.h>
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <numeric>
@@ -64,6 +69,16 @@ EditorPanel::~EditorPanel()
     debounce_timer_.Stop();
     format_bar_timer_.Stop();
     auto_save_timer_.Stop();
+
+    // Join the highlighter worker before the members its callback touches go away
+    code_highlighter_.reset();
+
+    // Outstanding snapshot handles must not call back into this panel
+    if (content_snapshot_)
+    {
+        content_snapshot_->expire();
+    }
+    SetDecorationSource(nullptr, {});
 }
 
 // ═══════════════════════════════════════════════════════
@@ -74,8 +89,19 @@ void EditorPanel::SetContent(const std::string& content)
 {
     // Stability #19: stop debounce timer to prevent stale content events
     debounce_timer_.Stop();
+    if (streaming_content_)
+    {
+        streaming_content_ = false;
+        editor_->SetReadOnly(readonly_before_streaming_);
+        editor_->SetUndoCollection(true);
+    }
 
+    // Reported as one full replacement rather than delete-all + insert-all deltas
+    replacing_content_ = true;
     editor_->SetText(wxString::FromUTF8(content));
+    replacing_content_ = false;
+    decorations_.reset(static_cast<std::size_t>(editor_->GetLineCount()));
+    ResetMinimap();
     editor_->EmptyUndoBuffer();
     editor_->SetSavePoint();
     editor_->GotoPos(0);
@@ -87,9 +113,84 @@ void EditorPanel::SetContent(const std::string& content)
     ApplyLargeFileOptimizations(line_count);
 }
 
+void EditorPanel::BeginStreamedContent()
+{
+    debounce_timer_.Stop();
+    if (!streaming_content_)
+    {
+        readonly_before_streaming_ = editor_->GetReadOnly();
+        streaming_content_ = true;
+    }
+
+    // Pieces are appended raw (no wxString round trip) and without undo history
+    replacing_content_ = true;
+    editor_->SetUndoCollection(false);
+    editor_->SetReadOnly(false);
+    editor_->ClearAll();
+    editor_->SetReadOnly(true);
+}
+
+void EditorPanel::AppendStreamedContent(std::string_view utf8)
+{
+    if (!streaming_content_ || utf8.empty())
+    {
+        return;
+    }
+    editor_->SetReadOnly(false);
+    editor_->AppendTextRaw(utf8.data(), static_cast<int>(utf8.size()));
+    editor_->SetReadOnly(true);
+    if (show_line_numbers_)
+    {
+        UpdateLineNumberMargin();
+    }
+}
+
+void EditorPanel::EndStreamedContent()
+{
+    if (!streaming_content_)
+    {
+        return;
+    }
+    streaming_content_ = false;
+    replacing_content_ = false;
+    editor_->SetReadOnly(readonly_before_streaming_);
+    editor_->SetUndoCollection(true);
+    editor_->EmptyUndoBuffer();
+    editor_->SetSavePoint();
+    UpdateLineNumberMargin();
+    decorations_.reset(static_cast<std::size_t>(editor_->GetLineCount()));
+    ResetMinimap();
+
+    const int line_count = editor_->GetLineCount();
+    ApplyLargeFileOptimizations(line_count);
+
+    // One content-changed event for the whole text (pending_full_replace_)
+    debounce_timer_.StartOnce(line_count > large_file_threshold_ ? kDebounceMaxMs : kDebounceMs);
+}
+
 auto EditorPanel::GetContent() const -> std::string
 {
-    return editor_->GetText().ToStdString();
+    // One copy of the UTF-8 bytes; no wxString round trip
+    return GetTextView().to_string();
+}
+
+auto EditorPanel::GetContentSnapshot() -> std::shared_ptr<const core::LazyDocumentSnapshot>
+{
+    if (!content_snapshot_ || content_snapshot_->version() != document_version_)
+    {
+        const uint64_t version = document_version_;
+        content_snapshot_ = std::make_shared<core::LazyDocumentSnapshot>(
+            version,
+            [this, version]() -> std::shared_ptr<const std::string>
+            {
+                if (editor_ == nullptr || document_version_ != version)
+                {
+                    return nullptr;
+                }
+                return GetTextView().snapshot();
+            });
+    }
+    return content_snapshot_;
 }
 
 auto EditorPanel::IsModified() const -> bool
@@ -102,6 +203,146 @@ void EditorPanel::ClearModified()
     editor_->SetSavePoint();
 }
 
+// ═══════════════════════════════════════════════════════
+// Zero-copy text access
+// ═══════════════════════════════════════════════════════
+
+auto EditorPanel::GetTextView() const -> core::DocumentTextView
+{
+    const char* text = editor_->GetCharacterPointer();
+    return {std::string_view(text, static_cast<std::size_t>(editor_->GetLength())),
+            document_version_,
+            &document_version_};
+}
+
+auto EditorPanel::GetTextRangeView(int start, int end) const -> core::DocumentTextView
+{
+    const int length = editor_->GetLength();
+    start = std::clamp(start, 0, length);
+    end = std::clamp(end, start, length);
+    const auto first_line = static_cast<std::size_t>(editor_->LineFromPosition(start));
+    if (start == end)
+    {
+        return {std::string_view{}, document_version_, &document_version_, first_line};
+    }
+    const char* text = editor_->GetRangePointer(start, end - start);
+    return {std::string_view(text, static_cast<std::size_t>(end - start)),
+            document_version_,
+            &document_version_,
+            first_line};
+}
+
+auto EditorPanel::GetLinesView(int first_line, int last_line) const -> core::DocumentTextView
+{
+    const int line_count = editor_->GetLineCount();
+    const int start = editor_->PositionFromLine(std::clamp(first_line, 0, line_count));
+    const int end = last_line >= line_count ? editor_->GetLength()
+                                            : editor_->PositionFromLine(std::max(last_line, 0));
+    return GetTextRangeView(start, end);
+}
+
+// ═══════════════════════════════════════════════════════
+// Documents
+// ═══════════════════════════════════════════════════════
+
+auto EditorPanel::CreateDocument() -> EditorDocument
+{
+    // Scintilla hands out the new document with one reference, adopted here
+    return {editor_, editor_->CreateDocument()};
+}
+
+void EditorPanel::ShowDocument(const EditorDocument& document)
+{
+    if (!document || document.get() == editor_->GetDocPointer())
+    {
+        return;
+    }
+
+    debounce_timer_.Stop();
+    if (streaming_content_)
+    {
+        // Read-only and undo collection belong to the document being left
+        streaming_content_ = false;
+        replacing_content_ = false;
+        editor_->SetReadOnly(readonly_before_streaming_);
+        editor_->SetUndoCollection(true);
+    }
+
+    editor_->SetDocPointer(document.get());
+
+    // Subscribers see the other text as one replacement
+    ++document_version_;
+    if (content_snapshot_)
+    {
+        content_snapshot_->expire();
+        content_snapshot_.reset();
+    }
+    pending_deltas_.clear();
+    pending_delta_bytes_ = 0;
+    pending_full_replace_ = true;
+
+    const int line_count = editor_->GetLineCount();
+    decorations_.reset(static_cast<std::size_t>(line_count));
+    ResetMinimap();
+    UpdateLineNumberMargin();
+
+    // Lexer state lives in the document: one shown before keeps its styles,
+    // a new one starts without a lexer
+    ApplyLargeFileOptimizations(line_count);
+    if (!container_lexing_ && line_count <= large_file_threshold_ &&
+        editor_->GetLexer() != wxSTC_LEX_MARKDOWN)
+    {
+        SetupMarkdownLexer();
+        ConfigureFoldMargin();
+    }
+}
+
+auto EditorPanel::GetDocumentText(const EditorDocument& document) -> std::string
+{
+    if (!document)
+    {
+        return {};
+    }
+    if (document.get() == editor_->GetDocPointer())
+    {
+        return GetContent();
+    }
+    auto* reader = AttachDocumentReader(document);
+    std::string text(reader->GetCharacterPointer(),
+                     static_cast<std::size_t>(reader->GetLength()));
+    core::TextCopyCounter::record(text.size());
+    reader->SetDocPointer(nullptr);
+    return text;
+}
+
+void EditorPanel::SetDocumentSavePoint(const EditorDocument& document)
+{
+    if (!document)
+    {
+        return;
+    }
+    if (document.get() == editor_->GetDocPointer())
+    {
+        editor_->SetSavePoint();
+        return;
+    }
+    auto* reader = AttachDocumentReader(document);
+    reader->SetSavePoint();
+    reader->SetDocPointer(nullptr);
+}
+
+auto EditorPanel::AttachDocumentReader(const EditorDocument& document) -> wxStyledTextCtrl*
+{
+    if (document_reader_ == nullptr)
+    {
+        document_reader_ = new wxStyledTextCtrl(this, wxID_ANY, wxDefaultPosition, wxSize(0, 0));
+        document_reader_->Hide();
+    }
+    // Detached again with SetDocPointer(nullptr), which gives it an empty document
+    document_reader_->SetDocPointer(document.get());
+    return document_reader_;
+}
+
 // ═══════════════════════════════════════════════════════
 // Cursor
 // ═══════════════════════════════════════════════════════
@@ -349,6 +590,7 @@ void EditorPanel::LoadPreferences(core::Config& config)
     bracket_matching_ = config.get_bool("editor.bracket_matching", true);
     auto_indent_ = config.get_bool("editor.auto_indent", true);
     large_file_threshold_ = config.get_int("editor.large_file_threshold", kLargeFileThreshold);
+    large_file_code_highlighting_ = config.get_bool("editor.large_file_code_highlighting", true);
     indentation_guides_ = config.get_bool("editor.indentation_guides", true);
     code_folding_ = config.get_bool("editor.code_folding", true);
     show_whitespace_ = config.get_bool("editor.show_whitespace", false);
@@ -447,6 +689,7 @@ void EditorPanel::SavePreferences(core::Config& config) const
     config.set("editor.bracket_matching", bracket_matching_);
     config.set("editor.auto_indent", auto_indent_);
     config.set("editor.large_file_threshold", large_file_threshold_);
+    config.set("editor.large_file_code_highlighting", large_file_code_highlighting_);
     config.set("editor.indentation_guides", indentation_guides_);
     config.set("editor.code_folding", code_folding_);
     config.set("editor.show_whitespace", show_whitespace_);
@@ -683,6 +926,7 @@ void EditorPanel::OnThemeChanged(const core::Theme& new_theme)
 {
     ThemeAwareWindow::OnThemeChanged(new_theme);
     ApplyThemeToEditor();
+    UpdateMinimapPalette();
 }
 
 // ═══════════════════════════════════════════════════════
@@ -698,7 +942,9 @@ void EditorPanel::CreateEditor()
 
     // Bind events
     editor_->Bind(wxEVT_STC_CHANGE, &EditorPanel::OnEditorChange, this);
+    editor_->Bind(wxEVT_STC_MODIFIED, &EditorPanel::OnEditorModified, this);
     editor_->Bind(wxEVT_STC_UPDATEUI, &EditorPanel::OnEditorUpdateUI, this);
+    editor_->Bind(wxEVT_STC_STYLENEEDED, &EditorPanel::OnStyleNeeded, this);
     editor_->Bind(wxEVT_STC_CHARADDED, &EditorPanel::OnCharAdded, this);
     editor_->Bind(wxEVT_KEY_DOWN, &EditorPanel::OnKeyDown, this);
     editor_->Bind(wxEVT_MOUSEWHEEL, &EditorPanel::OnMouseWheel, this);
@@ -834,6 +1080,7 @@ void EditorPanel::ConfigureEditorDefaults()
 
     // Phase 2: syntax indicator overlays
     SetupSyntaxIndicators();
+    decorations_.reset(static_cast<std::size_t>(editor_->GetLineCount()));
 }
 
 void EditorPanel::SetupMarkdownLexer()
@@ -909,12 +1156,23 @@ void EditorPanel::ApplyLargeFileOptimizations(int line_count)
 {
     if (line_count > large_file_threshold_)
     {
-        // Disable syntax highlighting for very large files
-        editor_->SetLexer(wxSTC_LEX_NULL);
+        if (large_file_code_highlighting_)
+        {
+            // Markdown lexing stays off, but fenced code keeps its colours
+            EnableContainerLexing();
+        }
+        else
+        {
+            // Disable syntax highlighting for very large files
+            DisableContainerLexing();
+            editor_->SetLexer(wxSTC_LEX_NULL);
+        }
         // Maximize rendering cache
         editor_->SetLayoutCache(wxSTC_CACHE_DOCUMENT);
-        // Enable idle styling — style incrementally without blocking UI
-        editor_->SetIdleStyling(wxSTC_IDLESTYLING_ALL);
+        // Enable idle styling — style incrementally without blocking UI.
+        // Container styling follows the viewport instead (see StyleCodeLines).
+        editor_->SetIdleStyling(container_lexing_ ? wxSTC_IDLESTYLING_NONE
+                                                  : wxSTC_IDLESTYLING_ALL);
         // Disable bracket matching for performance
         bracket_matching_ = false;
         // Disable code folding for large files
@@ -926,11 +1184,63 @@ void EditorPanel::ApplyLargeFileOptimizations(int line_count)
     else
     {
         // Ensure normal mode
+        DisableContainerLexing();
         editor_->SetLayoutCache(wxSTC_CACHE_PAGE);
         editor_->SetIdleStyling(wxSTC_IDLESTYLING_NONE);
     }
 }
 
+void EditorPanel::EnableContainerLexing()
+{
+    if (!code_highlighter_)
+    {
+        // Results are applied on the UI thread, in the order they were produced
+        code_highlighter_ = std::make_unique<core::AsyncHighlighter>(
+            [this](core::HighlightResult result)
+            {
+                CallAfter([this, result = std::move(result)]()
+                          { OnCodeHighlightReady(result); });
+            });
+        code_highlighter_->set_grammar_engine(grammar_engine_);
+    }
+
+    container_lexing_ = true;
+    editor_->SetLexer(wxSTC_LEX_CONTAINER);
+    const auto version = code_highlighter_->set_markdown(GetContentSnapshot()->content());
+    code_highlight_cache_.reset(static_cast<std::size_t>(editor_->GetLineCount()), version);
+
+    // Drop the styles of the previous lexer; visible lines come back via STYLENEEDED
+    editor_->StartStyling(0);
+}
+
+void EditorPanel::set_grammar_engine(const core::GrammarEngine* grammars)
+{
+    grammar_engine_ = grammars;
+    if (code_highlighter_)
+    {
+        code_highlighter_->set_grammar_engine(grammars);
+    }
+    if (container_lexing_)
+    {
+        // Re-lex so fences in newly contributed languages pick up colours
+        EnableContainerLexing();
+    }
+}
+
+void EditorPanel::DisableContainerLexing()
+{
+    if (!container_lexing_)
+    {
+        return;
+    }
+    // The worker is kept: its versions keep increasing, so results still
+    // queued for this mode are recognised as stale if it is re-enabled
+    container_lexing_ = false;
+    code_highlight_cache_.reset(0, code_highlighter_ ? code_highlighter_->version() : 0);
+    SetupMarkdownLexer();
+    editor_->Colourise(0, -1);
+}
+
 // ═══════════════════════════════════════════════════════
 // Phase 2: Syntax overlay highlighting
 // ═══════════════════════════════════════════════════════
@@ -964,37 +1274,17 @@ void EditorPanel::SetupSyntaxIndicators()
 
     // Phase 3 — Indicator 7: Trailing whitespace — squiggle underline
     editor_->IndicatorSetStyle(kIndicatorTrailingWS, wxSTC_INDIC_SQUIGGLE);
-}
 
-void EditorPanel::ClearSyntaxOverlays()
-{
-    // New stability #4: guard against null editor
-    if (editor_ == nullptr)
-        return;
+    // Indicator 8: Extension decorations (DecorationService) — roundbox
+    editor_->IndicatorSetStyle(kIndicatorExtension, wxSTC_INDIC_ROUNDBOX);
+    editor_->IndicatorSetAlpha(kIndicatorExtension, 40);
+    editor_->IndicatorSetOutlineAlpha(kIndicatorExtension, 90);
 
-    auto doc_len = editor_->GetLength();
-    for (int ind = kIndicatorYamlFrontmatter; ind <= kIndicatorBlockquoteNest; ++ind)
-    {
-        editor_->SetIndicatorCurrent(ind);
-        editor_->IndicatorClearRange(0, doc_len);
-    }
+    ApplyOverlayColors();
 }
 
-void EditorPanel::ApplySyntaxOverlays()
+void EditorPanel::ApplyOverlayColors()
 {
-    // New stability #5: guard against null editor
-    if (editor_ == nullptr || !syntax_overlays_enabled_)
-    {
-        return;
-    }
-
-    // Skip for large files
-    if (editor_->GetLineCount() > large_file_threshold_)
-    {
-        return;
-    }
-
-    // Apply themed indicator colors
     auto accent = theme_engine().color(core::ThemeColorToken::AccentPrimary);
     auto accent2 = theme_engine().color(core::ThemeColorToken::AccentSecondary);
     auto muted = theme_engine().color(core::ThemeColorToken::TextMuted);
@@ -1005,247 +1295,138 @@ void EditorPanel::ApplySyntaxOverlays()
     editor_->IndicatorSetForeground(kIndicatorFootnote, accent2);
     editor_->IndicatorSetForeground(kIndicatorHtmlTag, border);
     editor_->IndicatorSetForeground(kIndicatorBlockquoteNest, accent2);
-
-    ClearSyntaxOverlays();
-
-    // New stability #39: wrap Highlight* calls in try-catch for safety
-    try
-    {
-        HighlightYamlFrontmatter();
-        HighlightTaskCheckboxes();
-        HighlightFootnoteReferences();
-        HighlightInlineHtmlTags();
-        HighlightBlockquoteNesting();
-    }
-    catch (const std::exception&)
-    {
-        // Overlay highlighting failed — silently continue
-    }
+    editor_->IndicatorSetForeground(kIndicatorWordHighlight, accent2);
+    editor_->IndicatorSetForeground(kIndicatorTrailingWS, accent);
+    editor_->IndicatorSetForeground(kIndicatorExtension, accent2);
 }
 
-void EditorPanel::HighlightYamlFrontmatter()
+void EditorPanel::UpdateDecorations()
 {
-    // YAML frontmatter: starts at line 0 with "---" and ends at next "---"
-    if (editor_->GetLineCount() < 3)
+    // New stability #5: guard against null editor
+    if (editor_ == nullptr)
     {
         return;
     }
 
-    auto first_line = editor_->GetLine(0).ToStdString();
-    // Trim trailing newline/whitespace
-    while (!first_line.empty() &&
-           (first_line.back() == '\n' || first_line.back() == '\r' || first_line.back() == ' '))
+    const int caret = editor_->GetCurrentPos();
+    decorations_.set_caret_line(static_cast<std::size_t>(editor_->LineFromPosition(caret)));
+    decorations_.set_trailing_whitespace(trailing_ws_visible_);
+
+    // Phase 3 Item 26: occurrences of the word under the caret
+    std::string word;
+    const int word_start = editor_->WordStartPosition(caret, true);
+    const int word_end = editor_->WordEndPosition(caret, true);
+    if (word_start < word_end)
     {
-        first_line.pop_back();
+        word.assign(GetTextRangeView(word_start, word_end).text());
     }
+    decorations_.set_highlight_word(std::move(word));
 
-    if (first_line != "---")
+    const auto first =
+        static_cast<std::size_t>(editor_->DocLineFromVisible(editor_->GetFirstVisibleLine()));
+    const auto last = first + static_cast<std::size_t>(editor_->LinesOnScreen()) + 1;
+    // Lines are borrowed from the editor's buffer; nothing edits it meanwhile
+    const auto lines = decorations_.update(first,
+                                           last,
+                                           [this](std::size_t line)
+                                           {
+                                               const auto row = static_cast<int>(line);
+                                               return GetLinesView(row, row + 1).text();
+                                           });
+    if (lines.empty())
     {
         return;
     }
 
-    // Find closing ---
-    int end_line = -1;
-    int line_count = editor_->GetLineCount();
-    for (int line_idx = 1; line_idx < std::min(line_count, 100); ++line_idx) // scan max 100 lines
+    // Each reported line replaces all of its overlay indicators
+    for (const auto& decorated : lines)
     {
-        auto line_text = editor_->GetLine(line_idx).ToStdString();
-        while (!line_text.empty() &&
-               (line_text.back() == '\n' || line_text.back() == '\r' || line_text.back() == ' '))
+        const int line = static_cast<int>(decorated.line);
+        const int line_start = editor_->PositionFromLine(line);
+        const int next_start = editor_->PositionFromLine(line + 1);
+        const int line_length =
+            (next_start > line_start ? next_start : editor_->GetLength()) - line_start;
+        for (int ind = kIndicatorYamlFrontmatter; ind <= kIndicatorExtension; ++ind)
         {
-            line_text.pop_back();
+            editor_->SetIndicatorCurrent(ind);
+            editor_->IndicatorClearRange(line_start, line_length);
         }
-        if (line_text == "---")
+
+        for (const auto& run : decorated.runs)
         {
-            end_line = line_idx;
-            break;
+            const int indicator = OverlayIndicator(run.style_id);
+            if (indicator < 0 || static_cast<int>(run.start) >= line_length)
+            {
+                continue;
+            }
+            const int length =
+                std::min(static_cast<int>(run.length), line_length - static_cast<int>(run.start));
+            editor_->SetIndicatorCurrent(indicator);
+            editor_->IndicatorFillRange(line_start + static_cast<int>(run.start), length);
         }
     }
+}
 
-    if (end_line < 0)
+auto EditorPanel::OverlayIndicator(uint16_t style_id) const -> int
+{
+    if (style_id >= core::DecorationEngine::kExtensionStyleBase)
     {
-        return;
+        return kIndicatorExtension;
     }
-
-    int start_pos = 0;
-    int end_pos = editor_->GetLineEndPosition(end_line) + 1; // include the newline
-    if (end_pos > editor_->GetLength())
+    switch (static_cast<core::OverlayKind>(style_id))
     {
-        end_pos = editor_->GetLength();
+        case core::OverlayKind::WordHighlight:
+            return kIndicatorWordHighlight;
+        case core::OverlayKind::TrailingWhitespace:
+            return kIndicatorTrailingWS;
+        default:
+            break;
     }
-
-    editor_->SetIndicatorCurrent(kIndicatorYamlFrontmatter);
-    editor_->IndicatorFillRange(start_pos, end_pos - start_pos);
-}
-
-void EditorPanel::HighlightTaskCheckboxes()
-{
-    // Match patterns: "- [ ]" and "- [x]" (case-insensitive x)
-    editor_->SetIndicatorCurrent(kIndicatorTaskCheckbox);
-
-    int doc_len = editor_->GetLength();
-    int line_count = editor_->GetLineCount();
-
-    for (int line_idx = 0; line_idx < line_count; ++line_idx)
+    if (!syntax_overlays_enabled_)
     {
-        auto line_text = editor_->GetLine(line_idx).ToStdString();
-        // Look for "- [ ]" or "- [x]" or "- [X]"
-        size_t search_pos = 0;
-        while (search_pos < line_text.size())
-        {
-            // Skip leading whitespace
-            size_t check_start = line_text.find("- [", search_pos);
-            if (check_start == std::string::npos)
-            {
-                break;
-            }
-            // Verify the pattern is complete: "- [ ]" or "- [x]" or "- [X]"
-            if (check_start + 5 <= line_text.size())
-            {
-                char checkbox_char = line_text[check_start + 3];
-                if ((checkbox_char == ' ' || checkbox_char == 'x' || checkbox_char == 'X') &&
-                    line_text[check_start + 4] == ']')
-                {
-                    int abs_pos =
-                        editor_->PositionFromLine(line_idx) + static_cast<int>(check_start);
-                    if (abs_pos + 5 <= doc_len)
-                    {
-                        editor_->IndicatorFillRange(abs_pos, 5);
-                    }
-                }
-            }
-            search_pos = check_start + 3;
-        }
+        return -1;
     }
-}
-
-void EditorPanel::HighlightFootnoteReferences()
-{
-    // Match pattern: "[^identifier]" — not at start of line (inline reference)
-    editor_->SetIndicatorCurrent(kIndicatorFootnote);
-
-    int doc_len = editor_->GetLength();
-    int line_count = editor_->GetLineCount();
-
-    for (int line_idx = 0; line_idx < line_count; ++line_idx)
+    switch (static_cast<core::OverlayKind>(style_id))
     {
-        auto line_text = editor_->GetLine(line_idx).ToStdString();
-        size_t search_pos = 0;
-        while (search_pos < line_text.size())
-        {
-            size_t fn_start = line_text.find("[^", search_pos);
-            if (fn_start == std::string::npos)
-            {
-                break;
-            }
-            size_t fn_end = line_text.find(']', fn_start + 2);
-            if (fn_end == std::string::npos)
-            {
-                break;
-            }
-            int length = static_cast<int>(fn_end - fn_start + 1);
-            int abs_pos = editor_->PositionFromLine(line_idx) + static_cast<int>(fn_start);
-            if (abs_pos + length <= doc_len)
-            {
-                editor_->IndicatorFillRange(abs_pos, length);
-            }
-            search_pos = fn_end + 1;
-        }
+        case core::OverlayKind::YamlFrontmatter:
+            return kIndicatorYamlFrontmatter;
+        case core::OverlayKind::TaskCheckbox:
+            return kIndicatorTaskCheckbox;
+        case core::OverlayKind::Footnote:
+            return kIndicatorFootnote;
+        case core::OverlayKind::HtmlTag:
+            return kIndicatorHtmlTag;
+        case core::OverlayKind::BlockquoteNest:
+            return kIndicatorBlockquoteNest;
+        default:
+            return -1;
     }
 }
 
-void EditorPanel::HighlightInlineHtmlTags()
+void EditorPanel::SetDecorationSource(core::DecorationService* service, std::string file_uri)
 {
-    // Match pattern: "<tagname>" or "</tagname>" or "<tagname attr>" — simple HTML tags
-    editor_->SetIndicatorCurrent(kIndicatorHtmlTag);
-
-    int doc_len = editor_->GetLength();
-    int line_count = editor_->GetLineCount();
-
-    for (int line_idx = 0; line_idx < line_count; ++line_idx)
+    if (decoration_service_ != nullptr)
     {
-        auto line_text = editor_->GetLine(line_idx).ToStdString();
-        size_t search_pos = 0;
-        while (search_pos < line_text.size())
-        {
-            size_t tag_start = line_text.find('<', search_pos);
-            if (tag_start == std::string::npos)
-            {
-                break;
-            }
-            size_t tag_end = line_text.find('>', tag_start + 1);
-            if (tag_end == std::string::npos)
-            {
-                break;
-            }
-            // Validate it looks like a tag (starts with letter or /)
-            if (tag_start + 1 < line_text.size())
-            {
-                char first = line_text[tag_start + 1];
-                if (std::isalpha(static_cast<unsigned char>(first)) || first == '/')
-                {
-                    int length = static_cast<int>(tag_end - tag_start + 1);
-                    int abs_pos = editor_->PositionFromLine(line_idx) + static_cast<int>(tag_start);
-                    if (abs_pos + length <= doc_len)
-                    {
-                        editor_->IndicatorFillRange(abs_pos, length);
-                    }
-                }
-            }
-            search_pos = tag_end + 1;
-        }
+        decoration_service_->remove_listener(decoration_listener_id_);
     }
-}
-
-void EditorPanel::HighlightBlockquoteNesting()
-{
-    // Highlight lines starting with "> > " etc. with increasing visual distinction
-    editor_->SetIndicatorCurrent(kIndicatorBlockquoteNest);
-
-    int line_count = editor_->GetLineCount();
-    int doc_len = editor_->GetLength();
-
-    for (int line_idx = 0; line_idx < line_count; ++line_idx)
+    decoration_service_ = service;
+    decoration_uri_ = std::move(file_uri);
+    if (decoration_service_ == nullptr)
     {
-        auto line_text = editor_->GetLine(line_idx).ToStdString();
-
-        // Count nesting depth (consecutive '>' characters)
-        int depth = 0;
-        size_t char_pos = 0;
-        while (char_pos < line_text.size())
-        {
-            if (line_text[char_pos] == '>')
-            {
-                ++depth;
-                ++char_pos;
-                // Skip optional space after >
-                if (char_pos < line_text.size() && line_text[char_pos] == ' ')
-                {
-                    ++char_pos;
-                }
-            }
-            else if (line_text[char_pos] == ' ')
-            {
-                ++char_pos; // skip leading whitespace
-            }
-            else
-            {
-                break;
-            }
-        }
+        return;
+    }
 
-        // Only highlight when nesting depth >= 2
-        if (depth >= 2)
+    decoration_listener_id_ = decoration_service_->on_change(
+        [this](const std::string& changed_uri)
         {
-            int line_start = editor_->PositionFromLine(line_idx);
-            // Highlight the '>' markers portion
-            int marker_len = static_cast<int>(char_pos);
-            if (line_start + marker_len <= doc_len)
+            if (changed_uri == decoration_uri_)
             {
-                editor_->IndicatorFillRange(line_start, marker_len);
+                decorations_.set_extension_decorations(*decoration_service_, decoration_uri_);
+                UpdateDecorations();
             }
-        }
-    }
+        });
+    decorations_.set_extension_decorations(*decoration_service_, decoration_uri_);
+    UpdateDecorations();
 }
 
 // ═══════════════════════════════════════════════════════
@@ -1386,67 +1567,6 @@ void EditorPanel::SelectNextOccurrence()
     }
 }
 
-void EditorPanel::HighlightWordUnderCursor()
-{
-    int pos = editor_->GetCurrentPos();
-    int word_start = editor_->WordStartPosition(pos, true);
-    int word_end = editor_->WordEndPosition(pos, true);
-
-    if (word_start == word_end)
-    {
-        ClearWordHighlights();
-        last_highlighted_word_.clear();
-        return;
-    }
-
-    auto word = editor_->GetTextRange(word_start, word_end).ToStdString();
-
-    // Avoid re-highlighting the same word
-    if (word == last_highlighted_word_)
-    {
-        return;
-    }
-
-    ClearWordHighlights();
-    last_highlighted_word_ = word;
-
-    // Skip very short words (single chars flood the view)
-    if (word.size() < 2)
-    {
-        return;
-    }
-
-    // Themed indicator color
-    auto accent2 = theme_engine().color(core::ThemeColorToken::AccentSecondary);
-    editor_->IndicatorSetForeground(kIndicatorWordHighlight, accent2);
-
-    editor_->SetIndicatorCurrent(kIndicatorWordHighlight);
-
-    // Search for all occurrences
-    editor_->SetTargetStart(0);
-    editor_->SetTargetEnd(editor_->GetLength());
-    editor_->SetSearchFlags(wxSTC_FIND_MATCHCASE | wxSTC_FIND_WHOLEWORD);
-
-    int safety = 0;
-    while (editor_->SearchInTarget(wxString::FromUTF8(word)) != wxSTC_INVALID_POSITION &&
-           safety < 10000)
-    {
-        int start = editor_->GetTargetStart();
-        int end = editor_->GetTargetEnd();
-        editor_->IndicatorFillRange(start, end - start);
-
-        editor_->SetTargetStart(end);
-        editor_->SetTargetEnd(editor_->GetLength());
-        ++safety;
-    }
-}
-
-void EditorPanel::ClearWordHighlights()
-{
-    editor_->SetIndicatorCurrent(kIndicatorWordHighlight);
-    editor_->IndicatorClearRange(0, editor_->GetLength());
-}
-
 void EditorPanel::HandleSmartHome()
 {
     int pos = editor_->GetCurrentPos();
@@ -1466,59 +1586,10 @@ void EditorPanel::HandleSmartHome()
     }
 }
 
-void EditorPanel::HighlightTrailingWhitespace()
-{
-    editor_->SetIndicatorCurrent(kIndicatorTrailingWS);
-    editor_->IndicatorClearRange(0, editor_->GetLength());
-
-    auto error_color = theme_engine().color(core::ThemeColorToken::AccentPrimary);
-    editor_->IndicatorSetForeground(kIndicatorTrailingWS, error_color);
-
-    int line_count = editor_->GetLineCount();
-    int doc_len = editor_->GetLength();
-    int current_line = editor_->LineFromPosition(editor_->GetCurrentPos());
-
-    for (int line_idx = 0; line_idx < line_count; ++line_idx)
-    {
-        // Skip the line the cursor is on (don't distract while typing)
-        if (line_idx == current_line)
-        {
-            continue;
-        }
-
-        int line_end_pos = editor_->GetLineEndPosition(line_idx);
-        int line_start_pos = editor_->PositionFromLine(line_idx);
-
-        // Scan backwards from line end to find trailing whitespace
-        int ws_start = line_end_pos;
-        while (ws_start > line_start_pos)
-        {
-            char prev = static_cast<char>(editor_->GetCharAt(ws_start - 1));
-            if (prev == ' ' || prev == '\t')
-            {
-                --ws_start;
-            }
-            else
-            {
-                break;
-            }
-        }
-
-        if (ws_start < line_end_pos && ws_start + (line_end_pos - ws_start) <= doc_len)
-        {
-            editor_->IndicatorFillRange(ws_start, line_end_pos - ws_start);
-        }
-    }
-}
-
 void EditorPanel::SetTrailingWhitespace(bool enabled)
 {
     trailing_ws_visible_ = enabled;
-    if (!enabled)
-    {
-        editor_->SetIndicatorCurrent(kIndicatorTrailingWS);
-        editor_->IndicatorClearRange(0, editor_->GetLength());
-    }
+    UpdateDecorations();
 }
 
 auto EditorPanel::GetTrailingWhitespace() const -> bool
@@ -1778,6 +1849,34 @@ void EditorPanel::ApplyThemeToEditor()
     editor_->StyleSetBackground(wxSTC_MARKDOWN_CODEBK, panel_bg);
     editor_->StyleSetFont(wxSTC_MARKDOWN_CODEBK, mono_font);
 
+    // Fenced code in large files (container lexer; styles follow core::TokenType)
+    auto syntax = [this](core::ThemeColorToken token) { return theme_engine().color(token); };
+    const std::array<std::pair<core::TokenType, wxColour>, 10> code_colours{{
+        {core::TokenType::Keyword, syntax(core::ThemeColorToken::SyntaxKeyword)},
+        {core::TokenType::String, syntax(core::ThemeColorToken::SyntaxString)},
+        {core::TokenType::Number, syntax(core::ThemeColorToken::SyntaxNumber)},
+        {core::TokenType::Comment, syntax(core::ThemeColorToken::SyntaxComment)},
+        {core::TokenType::Operator, syntax(core::ThemeColorToken::SyntaxOperator)},
+        {core::TokenType::Function, syntax(core::ThemeColorToken::SyntaxFunction)},
+        {core::TokenType::Type, syntax(core::ThemeColorToken::SyntaxType)},
+        {core::TokenType::Preprocessor, syntax(core::ThemeColorToken::SyntaxPreprocessor)},
+        {core::TokenType::Constant, syntax(core::ThemeColorToken::SyntaxNumber)},
+        {core::TokenType::Tag, syntax(core::ThemeColorToken::SyntaxKeyword)},
+    }};
+    for (int style = kCodeStyleBase; style <= kFenceMarkerStyle; ++style)
+    {
+        editor_->StyleSetForeground(style, fg);
+        editor_->StyleSetBackground(style, panel_bg);
+        editor_->StyleSetEOLFilled(style, true);
+    }
+    for (const auto& [type, colour] : code_colours)
+    {
+        editor_->StyleSetForeground(kCodeStyleBase + static_cast<int>(type), colour);
+    }
+    editor_->StyleSetFont(kCodeStyleBase + static_cast<int>(core::TokenType::Comment),
+                          mono_italic);
+    editor_->StyleSetForeground(kFenceMarkerStyle, muted);
+
     // Links — clickable hotspot (Item 14)
     editor_->StyleSetForeground(wxSTC_MARKDOWN_LINK, accent2);
     editor_->StyleSetUnderline(wxSTC_MARKDOWN_LINK, true);
@@ -1887,6 +1986,7 @@ void EditorPanel::ApplyThemeToEditor()
         }
     }
 
+    ApplyOverlayColors();
     editor_->Refresh();
 }
 
@@ -1915,7 +2015,7 @@ void EditorPanel::UpdateLineNumberMargin()
 void EditorPanel::OnEditorChange(wxStyledTextEvent& /*event*/)
 {
     // Stability #1: guard against null editor during teardown
-    if (editor_ == nullptr)
+    if (editor_ == nullptr || streaming_content_)
     {
         return;
     }
@@ -1937,7 +2037,7 @@ void EditorPanel::OnEditorChange(wxStyledTextEvent& /*event*/)
 
 // QoL Item 10: Status Bar Stats -> Moved to DebounceTimer to avoid lag
 
-void EditorPanel::OnEditorUpdateUI(wxStyledTextEvent& /*event*/)
+void EditorPanel::OnEditorUpdateUI(wxStyledTextEvent& event)
 {
     // Stability #2: guard against null editor during teardown
     if (editor_ == nullptr)
@@ -1945,6 +2045,12 @@ void EditorPanel::OnEditorUpdateUI(wxStyledTextEvent& /*event*/)
         return;
     }
 
+    // Large files: style code highlighting that arrived while lines were off-screen
+    if (container_lexing_ && (event.GetUpdated() & wxSTC_UPDATE_V_SCROLL) != 0)
+    {
+        RestyleDirtyCodeLines();
+    }
+
     // Publish cursor position
     core::events::CursorPositionChangedEvent evt;
     evt.line = GetCursorLine();
@@ -1958,21 +2064,16 @@ void EditorPanel::OnEditorUpdateUI(wxStyledTextEvent& /*event*/)
         CheckBracketMatch();
     }
 
-    // Phase 2: refresh syntax overlay indicators
-    ApplySyntaxOverlays();
+    // Phase 2 / Phase 3 Items 26 and 29: syntax overlays, word occurrences
+    // and trailing whitespace, for the lines that need them near the viewport
+    UpdateDecorations();
 
-    // Phase 3 Item 26: highlight all occurrences of word under cursor
-    HighlightWordUnderCursor();
+    // Phase 6D: scrolled, edited or restyled minimap rows
+    UpdateMinimapContent();
 
     // QoL Item 10: Status Bar Stats -> Moved to DebounceTimer to avoid lag
     // CalculateAndPublishStats();
 
-    // Phase 3 Item 29: trailing whitespace visualization
-    if (trailing_ws_visible_)
-    {
-        HighlightTrailingWhitespace();
-    }
-
     // Phase 5: Show/hide floating format bar based on selection
     {
         int sel_len = std::abs(editor_->GetSelectionEnd() - editor_->GetSelectionStart());
@@ -2307,6 +2408,107 @@ void EditorPanel::OnMouseWheel(wxMouseEvent& event)
     }
 }
 
+void EditorPanel::OnEditorModified(wxStyledTextEvent& event)
+{
+    event.Skip();
+
+    const int mod_type = event.GetModificationType();
+    if ((mod_type & wxSTC_MOD_CHANGESTYLE) != 0 && minimap_visible_)
+    {
+        // Lexer or container styling changed: those minimap tiles are stale
+        const int first = editor_->LineFromPosition(event.GetPosition());
+        const int last = editor_->LineFromPosition(event.GetPosition() + event.GetLength());
+        minimap_renderer_.invalidate_lines(static_cast<std::size_t>(first),
+                                           static_cast<std::size_t>(last) + 1);
+    }
+    if ((mod_type & (wxSTC_MOD_INSERTTEXT | wxSTC_MOD_DELETETEXT)) == 0)
+    {
+        return;
+    }
+
+    ++document_version_;
+    if (content_snapshot_)
+    {
+        // Handles nobody pulled yet can no longer produce their version
+        content_snapshot_->expire();
+        content_snapshot_.reset();
+    }
+
+    // Content replacements reset the decoration engine once they are done
+    if (!replacing_content_)
+    {
+        const auto line = static_cast<std::size_t>(editor_->LineFromPosition(event.GetPosition()));
+        decorations_.on_lines_changed(line, event.GetLinesAdded());
+        if (minimap_visible_)
+        {
+            minimap_renderer_.on_lines_changed(line, event.GetLinesAdded());
+        }
+    }
+
+    if (container_lexing_ && !replacing_content_)
+    {
+        // Keep cached code tokens on the lines they belong to until re-lexed
+        const int position = event.GetPosition();
+        const int line = editor_->LineFromPosition(position);
+        if (event.GetLinesAdded() != 0)
+        {
+            code_highlight_cache_.on_lines_changed(static_cast<std::size_t>(line),
+                                                   event.GetLinesAdded());
+        }
+        else
+        {
+            const auto length = static_cast<std::ptrdiff_t>(event.GetLength());
+            code_highlight_cache_.on_columns_changed(
+                static_cast<std::size_t>(line),
+                static_cast<std::size_t>(position - editor_->PositionFromLine(line)),
+                (mod_type & wxSTC_MOD_INSERTTEXT) != 0 ? length : -length);
+        }
+    }
+
+    if (replacing_content_)
+    {
+        pending_full_replace_ = true;
+        pending_deltas_.clear();
+        pending_delta_bytes_ = 0;
+        return;
+    }
+
+    core::TextDelta delta;
+    delta.offset = static_cast<std::size_t>(event.GetPosition());
+    if ((mod_type & wxSTC_MOD_INSERTTEXT) != 0)
+    {
+        // Notified after the insertion: the text is in the buffer already
+        const int position = event.GetPosition();
+        delta.inserted_text = GetTextRangeView(position, position + event.GetLength()).to_string();
+    }
+    else
+    {
+        delta.removed_length = static_cast<std::size_t>(event.GetLength());
+    }
+
+    // Every edit reaches the crash journal, even when subscribers are only
+    // told about a full replacement
+    core::events::EditorTextEditedEvent edited_evt;
+    edited_evt.version = document_version_;
+    edited_evt.delta = std::move(delta);
+    event_bus_.publish_fast(edited_evt);
+    if (pending_full_replace_)
+    {
+        return;
+    }
+    delta = std::move(edited_evt.delta);
+
+    pending_delta_bytes_ += delta.inserted_text.size();
+    if (pending_deltas_.size() >= kMaxPendingDeltas || pending_delta_bytes_ > kMaxPendingDeltaBytes)
+    {
+        pending_full_replace_ = true;
+        pending_deltas_.clear();
+        pending_delta_bytes_ = 0;
+        return;
+    }
+    pending_deltas_.push_back(std::move(delta));
+}
+
 void EditorPanel::OnDebounceTimer(wxTimerEvent& /*event*/)
 {
     // Stability #7: guard and protect against exceptions during timer callback
@@ -2317,10 +2519,27 @@ void EditorPanel::OnDebounceTimer(wxTimerEvent& /*event*/)
 
     try
     {
+        // Deltas since the last publish; the text itself is pulled on demand
         core::events::EditorContentChangedEvent evt;
-        evt.content = GetContent();
+        evt.version = document_version_;
+        evt.full_replace = pending_full_replace_;
+        evt.deltas = std::move(pending_deltas_);
+        evt.snapshot = GetContentSnapshot();
+        pending_deltas_.clear();
+        pending_delta_bytes_ = 0;
+        pending_full_replace_ = false;
         event_bus_.publish_fast(evt);
 
+        // Large files: re-lex the edited code blocks from the same snapshot
+        if (container_lexing_ && code_highlight_cache_.has_unsent_edit())
+        {
+            if (auto content = evt.snapshot->content())
+            {
+                code_highlight_cache_.mark_sent(code_highlighter_->update_markdown(
+                    std::move(content), code_highlight_cache_.unsent_edit()));
+            }
+        }
+
         // QoL Item 10: Status Bar Stats
         CalculateAndPublishStats();
     }
@@ -2330,6 +2549,137 @@ void EditorPanel::OnDebounceTimer(wxTimerEvent& /*event*/)
     }
 }
 
+// ═══════════════════════════════════════════════════════
+// Large-file fenced code highlighting (container lexer)
+// ═══════════════════════════════════════════════════════
+
+void EditorPanel::OnStyleNeeded(wxStyledTextEvent& event)
+{
+    if (editor_ == nullptr)
+    {
+        return;
+    }
+
+    // Scintilla asks for styles up to the end of what it is about to paint
+    const int first_line = editor_->LineFromPosition(editor_->GetEndStyled());
+    const int last_line = editor_->LineFromPosition(event.GetPosition());
+    StyleCodeLines(static_cast<std::size_t>(first_line), static_cast<std::size_t>(last_line) + 1);
+}
+
+void EditorPanel::OnCodeHighlightReady(const core::HighlightResult& result)
+{
+    if (editor_ == nullptr || !container_lexing_)
+    {
+        return;
+    }
+
+    const auto [first, last] = code_highlight_cache_.apply(result);
+    if (first >= last)
+    {
+        return;
+    }
+
+    // Restyle near the viewport now; lines Scintilla has not styled yet are
+    // picked up by OnStyleNeeded, the rest stay dirty until scrolled to
+    const auto range = CodePrefetchRange();
+    const auto styled_end =
+        static_cast<std::size_t>(editor_->LineFromPosition(editor_->GetEndStyled()));
+    const auto restyle_first = std::max(first, range.start_line);
+    const auto restyle_last = std::min({last, range.end_line, styled_end});
+    if (restyle_first < restyle_last)
+    {
+        StyleCodeLines(restyle_first, restyle_last);
+    }
+}
+
+void EditorPanel::StyleCodeLines(std::size_t first_line, std::size_t last_line)
+{
+    const auto line_count = static_cast<std::size_t>(editor_->GetLineCount());
+    last_line = std::min(last_line, line_count);
+    if (first_line >= last_line)
+    {
+        return;
+    }
+
+    auto line_start = [this, line_count](std::size_t line)
+    {
+        return line < line_count ? editor_->PositionFromLine(static_cast<int>(line))
+                                 : editor_->GetLength();
+    };
+
+    // One style byte per document byte, written with a single SetStyleBytes
+    const int range_start = line_start(first_line);
+    std::string styles(static_cast<std::size_t>(line_start(last_line) - range_start), '\0');
+    for (auto line = first_line; line < last_line; ++line)
+    {
+        const auto begin = static_cast<std::size_t>(line_start(line) - range_start);
+        const auto end = static_cast<std::size_t>(line_start(line + 1) - range_start);
+        const auto& cached = code_highlight_cache_.line(line);
+
+        char base = 0;
+        if (cached.kind == core::HighlightLineKind::FenceMarker)
+        {
+            base = static_cast<char>(kFenceMarkerStyle);
+        }
+        else if (cached.kind == core::HighlightLineKind::Code)
+        {
+            base = static_cast<char>(kCodeStyleBase);
+        }
+        std::fill(styles.begin() + static_cast<std::ptrdiff_t>(begin),
+                  styles.begin() + static_cast<std::ptrdiff_t>(end),
+                  base);
+
+        for (const auto& token : cached.tokens)
+        {
+            const auto token_begin = std::min(begin + token.start, end);
+            const auto token_end = std::min(token_begin + token.length, end);
+            std::fill(styles.begin() + static_cast<std::ptrdiff_t>(token_begin),
+                      styles.begin() + static_cast<std::ptrdiff_t>(token_end),
+                      static_cast<char>(kCodeStyleBase + static_cast<int>(token.type)));
+        }
+    }
+    code_highlight_cache_.mark_clean(first_line, last_line);
+
+    editor_->StartStyling(range_start);
+    editor_->SetStyleBytes(static_cast<int>(styles.size()), styles.data());
+}
+
+void EditorPanel::RestyleDirtyCodeLines()
+{
+    const auto range = CodePrefetchRange();
+    const auto styled_end =
+        static_cast<std::size_t>(editor_->LineFromPosition(editor_->GetEndStyled()));
+    const auto last = std::min(range.end_line, styled_end);
+
+    // Restyle each run of consecutive dirty lines in one call
+    auto line = range.start_line;
+    while (line < last)
+    {
+        if (!code_highlight_cache_.is_dirty(line))
+        {
+            ++line;
+            continue;
+        }
+        auto run_end = line + 1;
+        while (run_end < last && code_highlight_cache_.is_dirty(run_end))
+        {
+            ++run_end;
+        }
+        StyleCodeLines(line, run_end);
+        line = run_end;
+    }
+}
+
+auto EditorPanel::CodePrefetchRange() const -> rendering::PrefetchManager::PrefetchRange
+{
+    rendering::ViewportState viewport;
+    viewport.first_visible_line =
+        static_cast<std::size_t>(editor_->DocLineFromVisible(editor_->GetFirstVisibleLine()));
+    viewport.visible_line_count = static_cast<std::size_t>(editor_->LinesOnScreen());
+    return code_prefetch_.compute_range(viewport,
+                                        static_cast<std::size_t>(editor_->GetLineCount()));
+}
+
 // ═══════════════════════════════════════════════════════
 // Bracket matching
 // ═══════════════════════════════════════════════════════
@@ -3394,12 +3744,13 @@ void EditorPanel::CalculateAndPublishStats()
     // Word count calculation
     // Simple iteration or regex. For speed, simpler is better.
     // Scintilla doesn't give word count directly.
-    std::string text = editor_->GetText().ToStdString();
+    // Read in place; counting words needs no copy of the text
+    const auto view = GetTextView();
 
     // Simple word count: counting transitions from space to non-space
     int words = 0;
     bool in_word = false;
-    for (char c : text)
+    for (char c : view.text())
     {
         bool is_space = std::isspace(static_cast<unsigned char>(c));
         if (!is_space && !in_word)
@@ -3955,39 +4306,21 @@ void EditorPanel::CreateMinimap()
         return;
     }
 
-    minimap_ = new wxStyledTextCtrl(this, wxID_ANY);
-
-    // Read-only, no visible chrome
-    minimap_->SetReadOnly(true);
-    minimap_->SetUseHorizontalScrollBar(false);
-    minimap_->SetUseVerticalScrollBar(false);
-    minimap_->SetMarginWidth(0, 0);
-    minimap_->SetMarginWidth(1, 0);
-    minimap_->SetMarginWidth(2, 0);
-
-    // Very small font for overview
-    minimap_->StyleSetSize(wxSTC_STYLE_DEFAULT, 1);
-    minimap_->StyleClearAll();
+    // A plain window painted from minimap_buffer_; no second text control
+    minimap_ = new wxWindow(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxBORDER_NONE);
+    minimap_->SetBackgroundStyle(wxBG_STYLE_PAINT);
 
     // Fixed width
-    minimap_->SetMinSize(wxSize(120, -1));
-    minimap_->SetMaxSize(wxSize(120, -1));
+    minimap_->SetMinSize(wxSize(kMinimapWidth, -1));
+    minimap_->SetMaxSize(wxSize(kMinimapWidth, -1));
 
-    // Disable caret
-    minimap_->SetCaretWidth(0);
-
-    // No cursor in minimap
+    // Clicking jumps to a line
     minimap_->SetCursor(wxCURSOR_HAND);
 
-    // Click handler
+    minimap_->Bind(wxEVT_PAINT, &EditorPanel::OnMinimapPaint, this);
+    minimap_->Bind(wxEVT_SIZE, &EditorPanel::OnMinimapSize, this);
     minimap_->Bind(wxEVT_LEFT_DOWN, &EditorPanel::OnMinimapClick, this);
 
-    // Theme: match editor bg/fg
-    const auto& theme_colors = theme().colors;
-    minimap_->StyleSetBackground(wxSTC_STYLE_DEFAULT, theme_colors.bg_app.to_wx_colour());
-    minimap_->StyleSetForeground(wxSTC_STYLE_DEFAULT, theme_colors.text_muted.to_wx_colour());
-    minimap_->StyleClearAll();
-
     // Add to sizer
     auto sizer = GetSizer();
     if (sizer != nullptr)
@@ -4010,8 +4343,8 @@ void EditorPanel::ToggleMinimap()
 
     if (minimap_visible_)
     {
-        UpdateMinimapContent();
         minimap_->Show();
+        UpdateMinimapPalette();
     }
     else
     {
@@ -4025,55 +4358,203 @@ void EditorPanel::ToggleMinimap()
     }
 }
 
-void EditorPanel::UpdateMinimapContent()
+void EditorPanel::ResetMinimap()
+{
+    if (minimap_ == nullptr || !minimap_visible_)
+    {
+        return; // Edits are not tracked while hidden; showing it resets it
+    }
+    minimap_renderer_.reset(static_cast<std::size_t>(editor_->GetLineCount()));
+    minimap_buffer_stale_ = true;
+    UpdateMinimapContent();
+}
+
+void EditorPanel::UpdateMinimapPalette()
 {
     if (minimap_ == nullptr || editor_ == nullptr || !minimap_visible_)
     {
         return;
     }
 
-    auto content = editor_->GetText().ToStdString();
+    // Line bars take the foreground colour of each editor style
+    std::vector<core::Color> palette;
+    palette.reserve(kMinimapStyleCount);
+    for (int style = 0; style < kMinimapStyleCount; ++style)
+    {
+        const wxColour colour = editor_->StyleGetForeground(style);
+        palette.emplace_back(colour.Red(), colour.Green(), colour.Blue());
+    }
+    minimap_renderer_.set_geometry(std::clamp(minimap_max_column_, 1, kMinimapWidth),
+                                   minimap_scale_);
+    minimap_renderer_.set_palette(std::move(palette), theme().colors.bg_app);
+    ResetMinimap();
+}
 
-    minimap_->SetReadOnly(false);
-    minimap_->SetText(content);
-    minimap_->SetReadOnly(true);
+void EditorPanel::UpdateMinimapContent()
+{
+    if (minimap_ == nullptr || editor_ == nullptr || !minimap_visible_)
+    {
+        return;
+    }
+    const wxSize size = minimap_->GetClientSize();
+    if (size.GetWidth() <= 0 || size.GetHeight() <= 0)
+    {
+        return;
+    }
+    if (!minimap_buffer_.IsOk() || minimap_buffer_.GetWidth() != size.GetWidth() ||
+        minimap_buffer_.GetHeight() != size.GetHeight())
+    {
+        minimap_buffer_ = wxBitmap(size.GetWidth(), size.GetHeight());
+        minimap_blit_.initialize(size.GetWidth(), size.GetHeight());
+        minimap_buffer_stale_ = true;
+    }
 
     // Scroll minimap proportionally to the editor's scroll position
-    int first_line = editor_->GetFirstVisibleLine();
-    int total_lines = editor_->GetLineCount();
-    int minimap_total = minimap_->GetLineCount();
+    const auto first_line =
+        static_cast<std::size_t>(editor_->DocLineFromVisible(editor_->GetFirstVisibleLine()));
+    const int top = minimap_renderer_.scroll_top(
+        first_line, static_cast<std::size_t>(editor_->LinesOnScreen()), size.GetHeight());
+    const int dy = top - minimap_top_;
+    const auto [dirty_first, dirty_last] = minimap_renderer_.take_dirty_lines();
 
-    if (total_lines > 0)
+    if (minimap_buffer_stale_ || minimap_blit_.is_full_repaint_needed(0, dy))
+    {
+        PaintMinimapRows(top, 0, size.GetHeight());
+        minimap_buffer_stale_ = false;
+    }
+    else
     {
-        int minimap_line = first_line * minimap_total / total_lines;
-        minimap_->SetFirstVisibleLine(minimap_line);
+        if (dy != 0)
+        {
+            // Shift the rows still on screen; compose only the revealed strip
+            const int kept_height = size.GetHeight() - std::abs(dy);
+            const wxRect kept_rect(0, std::max(dy, 0), size.GetWidth(), kept_height);
+            const wxBitmap kept = minimap_buffer_.GetSubBitmap(kept_rect);
+            {
+                wxMemoryDC dc(minimap_buffer_);
+                dc.DrawBitmap(kept, 0, std::max(-dy, 0));
+            }
+            minimap_blit_.record_scroll(0, dy);
+            const auto revealed = minimap_blit_.compute_revealed_rect(dy);
+            PaintMinimapRows(top + revealed.top, revealed.top, revealed.height());
+        }
+
+        // Edited or restyled lines that are on screen
+        const int line_height = minimap_renderer_.line_height();
+        const int row_first = std::max(top, static_cast<int>(dirty_first) * line_height);
+        const int row_last =
+            std::min(top + size.GetHeight(), static_cast<int>(dirty_last) * line_height);
+        if (row_first < row_last)
+        {
+            PaintMinimapRows(row_first, row_first - top, row_last - row_first);
+        }
     }
+    minimap_top_ = top;
+    minimap_->Refresh(false);
 }
 
-void EditorPanel::OnMinimapClick(wxMouseEvent& event)
+void EditorPanel::PaintMinimapRows(int first_row, int buffer_row, int row_count)
 {
-    if (minimap_ == nullptr || editor_ == nullptr)
+    if (row_count <= 0)
     {
-        event.Skip();
         return;
     }
 
-    // Get click position in minimap coordinates
-    int click_y = event.GetPosition().y;
-    int minimap_height = minimap_->GetClientSize().GetHeight();
+    // Lexer styles are computed lazily: style the tiles about to be drawn
+    // (their restyle notifications land before the tiles render)
+    if (!container_lexing_)
+    {
+        constexpr auto kTileLines = core::MinimapRenderer::kTileLines;
+        const auto last_line = minimap_renderer_.line_at(first_row + row_count - 1);
+        const auto tiles_end = std::min(minimap_renderer_.line_count(),
+                                        (last_line / kTileLines + 1) * kTileLines);
+        const int end_position = tiles_end >= minimap_renderer_.line_count()
+                                     ? editor_->GetLength()
+                                     : editor_->PositionFromLine(static_cast<int>(tiles_end));
+        if (editor_->GetEndStyled() < end_position)
+        {
+            editor_->Colourise(editor_->GetEndStyled(), end_position);
+        }
+    }
+
+    const auto strip = minimap_renderer_.paint_rows(
+        first_row,
+        row_count,
+        [this](std::size_t line)
+        {
+            core::MinimapRenderer::Line result;
+            const int row = static_cast<int>(line);
+            result.text = GetLinesView(row, row + 1).text();
+
+            // (character, style) byte pairs; runs of equal style
+            const int start = editor_->PositionFromLine(row);
+            const wxMemoryBuffer styled =
+                editor_->GetStyledText(start, start + static_cast<int>(result.text.size()));
+            const auto* bytes = static_cast<const unsigned char*>(styled.GetData());
+            const auto length = std::min(styled.GetDataLen() / 2, result.text.size());
+            for (std::size_t pos = 0; pos < length; ++pos)
+            {
+                const auto style = static_cast<uint16_t>(bytes[pos * 2 + 1]);
+                if (!result.runs.empty() && result.runs.back().style_id == style)
+                {
+                    ++result.runs.back().length;
+                }
+                else
+                {
+                    result.runs.push_back(core::StyleRun{static_cast<uint32_t>(pos), 1, style});
+                }
+            }
+            return result;
+        });
+
+    wxImage image(strip.width, strip.height, false);
+    std::copy(strip.rgb.begin(), strip.rgb.end(), image.GetData());
+    wxMemoryDC dc(minimap_buffer_);
+    const wxColour background = theme().colors.bg_app.to_wx_colour();
+    dc.SetPen(*wxTRANSPARENT_PEN);
+    dc.SetBrush(wxBrush(background));
+    dc.DrawRectangle(strip.width, buffer_row, minimap_buffer_.GetWidth() - strip.width, row_count);
+    dc.DrawBitmap(wxBitmap(image), 0, buffer_row);
+}
 
-    if (minimap_height <= 0)
+void EditorPanel::OnMinimapPaint(wxPaintEvent& /*event*/)
+{
+    wxPaintDC dc(minimap_);
+    if (!minimap_buffer_.IsOk())
+    {
+        dc.SetBackground(wxBrush(theme().colors.bg_app.to_wx_colour()));
+        dc.Clear();
+        return;
+    }
+    dc.DrawBitmap(minimap_buffer_, 0, 0);
+
+    // Outline the lines the editor shows
+    const int line_height = minimap_renderer_.line_height();
+    const int first_line = editor_->DocLineFromVisible(editor_->GetFirstVisibleLine());
+    const int slider_top = first_line * line_height - minimap_top_;
+    const int slider_height = std::max(2, editor_->LinesOnScreen() * line_height);
+    dc.SetPen(wxPen(theme().colors.text_muted.to_wx_colour()));
+    dc.SetBrush(*wxTRANSPARENT_BRUSH);
+    dc.DrawRectangle(0, slider_top, minimap_buffer_.GetWidth(), slider_height);
+}
+
+void EditorPanel::OnMinimapSize(wxSizeEvent& event)
+{
+    event.Skip();
+    UpdateMinimapContent();
+}
+
+void EditorPanel::OnMinimapClick(wxMouseEvent& event)
+{
+    if (minimap_ == nullptr || editor_ == nullptr)
     {
         event.Skip();
         return;
     }
 
-    // Calculate proportional position
-    double fraction = static_cast<double>(click_y) / static_cast<double>(minimap_height);
-    int total_lines = editor_->GetLineCount();
-    // New stability #17: clamp target line to valid range
-    int target_line =
-        std::clamp(static_cast<int>(fraction * total_lines), 0, std::max(0, total_lines - 1));
+    // The line under the click, in content rows
+    const auto target = minimap_renderer_.line_at(minimap_top_ + event.GetPosition().y);
+    const int target_line = static_cast<int>(target);
 
     // Scroll editor to the target line, centering it
     int visible_lines = editor_->LinesOnScreen();
@@ -4517,7 +4998,7 @@ void EditorPanel::UpdateSelectionCount()
     // Count occurrences of selected text in document
     int count = 0;
     size_t search_pos = 0;
-    auto full_text = editor_->GetText().ToStdString();
+    const auto full_text = GetTextView().text();
     // New stability #14: use size_t consistently to prevent integer overflow
     while (true)
     {
@@ -5751,6 +6232,7 @@ void EditorPanel::ToggleMinimapVisibility()
     {
         minimap_->Show(minimap_visible_);
         Layout();
+        UpdateMinimapPalette();
     }
 }
 
@@ -1,18 +1,31 @@
 #pragma once
 
+#include "EditorDocument.h"
 #include "ThemeAwareWindow.h"
+#include "core/DecorationEngine.h"
+#include "core/DocumentTextView.h"
 #include "core/EventBus.h"
 #include "core/Events.h"
+#include "core/HighlightLineCache.h"
+#include "core/MinimapRenderer.h"
 #include "core/ThemeEngine.h"
+#include "rendering/PrefetchManager.h"
+#include "rendering/ScrollBlit.h"
 
+#include <wx/bitmap.h>
 #include <wx/stc/stc.h>
 #include <wx/timer.h>
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 class wxTextCtrl;
 class wxStaticText;
@@ -29,6 +42,7 @@ namespace markamp::core
 {
 class Config;
 class FeatureRegistry;
+class GrammarEngine;
 } // namespace markamp::core
 
 namespace markamp::ui
@@ -54,9 +68,57 @@ public:
     // ── Content management ──
     void SetContent(const std::string& content);
     [[nodiscard]] auto GetContent() const -> std::string;
+
+    /// Fill the editor in pieces (large files opened off the UI thread):
+    /// Begin clears it and makes it read-only, each Append adds UTF-8 text
+    /// that does not split a character, and End restores editing and reports
+    /// the whole text as one replacement, like SetContent.
+    void BeginStreamedContent();
+    void AppendStreamedContent(std::string_view utf8);
+    void EndStreamedContent();
+    [[nodiscard]] auto IsStreamingContent() const -> bool
+    {
+        return streaming_content_;
+    }
     [[nodiscard]] auto IsModified() const -> bool;
+
+    /// Incremented on every text insertion or deletion.
+    [[nodiscard]] auto GetDocumentVersion() const -> uint64_t
+    {
+        return document_version_;
+    }
+
+    /// Shared handle to the text at the current version; the copy out of
+    /// Scintilla happens at most once, when the first consumer pulls it.
+    [[nodiscard]] auto GetContentSnapshot() -> std::shared_ptr<const core::LazyDocumentSnapshot>;
     void ClearModified();
 
+    // ── Zero-copy text access ──
+    // Views borrow Scintilla's buffer and turn invalid at the next edit.
+    /// The whole document; makes the buffer contiguous (once per edit).
+    [[nodiscard]] auto GetTextView() const -> core::DocumentTextView;
+
+    /// Bytes [start, end); only makes that range contiguous.
+    [[nodiscard]] auto GetTextRangeView(int start, int end) const -> core::DocumentTextView;
+
+    /// Lines [first_line, last_line), including their line endings.
+    [[nodiscard]] auto GetLinesView(int first_line, int last_line) const
+        -> core::DocumentTextView;
+
+    // ── Documents (one per open file, swapped in without copying text) ──
+    /// A new, empty document; shown once passed to ShowDocument().
+    [[nodiscard]] auto CreateDocument() -> EditorDocument;
+
+    /// Show `document` with its own text, undo history, styling and folds.
+    /// Reported to content subscribers as one replacement, like SetContent.
+    void ShowDocument(const EditorDocument& document);
+
+    /// Text of `document`, which need not be the one shown.
+    [[nodiscard]] auto GetDocumentText(const EditorDocument& document) -> std::string;
+
+    /// Mark `document` unmodified, e.g. after it was saved in the background.
+    void SetDocumentSavePoint(const EditorDocument& document);
+
     // ── Cursor ──
     [[nodiscard]] auto GetCursorLine() const -> int;
     [[nodiscard]] auto GetCursorColumn() const -> int;
@@ -136,6 +198,10 @@ public:
     [[nodiscard]] auto GetAutoTrimTrailingWhitespace() const -> bool;
     void TrimTrailingWhitespace();
 
+    /// Show the extension decorations `service` holds for `file_uri`
+    /// (nullptr detaches). Re-applied whenever the service reports changes.
+    void SetDecorationSource(core::DecorationService* service, std::string file_uri);
+
     // ── Phase 5: Snippets & Session ──
     /// A reusable snippet. The body may contain a cursor placeholder `$0`.
     struct Snippet
@@ -165,6 +231,10 @@ public:
         feature_registry_ = registry;
     }
 
+    /// Inject the extension grammars used to colour fenced code in languages
+    /// without a built-in lexer (large-file mode only).
+    void set_grammar_engine(const core::GrammarEngine* grammars);
+
     // ── Phase 6D: Minimap ──
     void ToggleMinimap();
 
@@ -410,6 +480,10 @@ public:
     static constexpr int kFoldMarginWidth = 14;
     static constexpr int kFoldMarginIndex = 2;
 
+    // Container-lexer styles for fenced code in large files (after STYLE_* 32–39)
+    static constexpr int kCodeStyleBase = 40; // + core::TokenType
+    static constexpr int kFenceMarkerStyle = kCodeStyleBase + 16;
+
     // Phase 2: Indicator indices for overlay syntax highlighting
     static constexpr int kIndicatorFind = 0;            // find/replace highlights
     static constexpr int kIndicatorYamlFrontmatter = 1; // YAML frontmatter block
@@ -419,6 +493,7 @@ public:
     static constexpr int kIndicatorBlockquoteNest = 5;  // nested blockquote depth
     static constexpr int kIndicatorWordHighlight = 6;   // word under cursor occurrences
     static constexpr int kIndicatorTrailingWS = 7;      // trailing whitespace
+    static constexpr int kIndicatorExtension = 8;       // extension decorations
 
 protected:
     void OnThemeChanged(const core::Theme& new_theme) override;
@@ -441,6 +516,22 @@ private:
     // ── Debounce timer ──
     wxTimer debounce_timer_;
 
+    // ── Change tracking (published as deltas with EditorContentChangedEvent) ──
+    uint64_t document_version_{0};
+    std::vector<core::TextDelta> pending_deltas_;
+    std::size_t pending_delta_bytes_{0};
+    bool pending_full_replace_{false};
+    bool replacing_content_{false};
+    bool streaming_content_{false};
+    bool readonly_before_streaming_{false};
+    std::shared_ptr<core::LazyDocumentSnapshot> content_snapshot_;
+    // Never shown; borrows documents that are not in editor_ to read them
+    wxStyledTextCtrl* document_reader_{nullptr};
+    auto AttachDocumentReader(const EditorDocument& document) -> wxStyledTextCtrl*;
+    // Beyond these a batch is sent as full_replace; subscribers pull the snapshot
+    static constexpr std::size_t kMaxPendingDeltas = 1024;
+    static constexpr std::size_t kMaxPendingDeltaBytes = static_cast<std::size_t>(1024) * 1024;
+
     // ── Configuration state ──
     core::events::WrapMode wrap_mode_{core::events::WrapMode::Word};
     bool show_line_numbers_{true};
@@ -454,6 +545,16 @@ private:
     int tab_size_{kDefaultTabSize};
     int edge_column_{kDefaultEdgeColumn};
     int large_file_threshold_{kLargeFileThreshold};
+    bool large_file_code_highlighting_{true};
+
+    // ── Large-file fenced code highlighting (container lexer) ──
+    // Code blocks are tokenized on the AsyncHighlighter worker; results are
+    // styled only near the viewport, the rest when it scrolls into range.
+    bool container_lexing_{false};
+    const core::GrammarEngine* grammar_engine_{nullptr};
+    std::unique_ptr<core::AsyncHighlighter> code_highlighter_;
+    core::HighlightLineCache code_highlight_cache_;
+    rendering::PrefetchManager code_prefetch_;
 
     // ── Setup ──
     void CreateEditor();
@@ -470,24 +571,21 @@ private:
     void ConfigureWhitespace();
     void ConfigureIndentGuides();
     void ApplyLargeFileOptimizations(int line_count);
+    void EnableContainerLexing();
+    void DisableContainerLexing();
 
     // ── Phase 2: Syntax overlay painting ──
     void SetupSyntaxIndicators();
-    void ApplySyntaxOverlays();
-    void ClearSyntaxOverlays();
-    void HighlightYamlFrontmatter();
-    void HighlightTaskCheckboxes();
-    void HighlightFootnoteReferences();
-    void HighlightInlineHtmlTags();
-    void HighlightBlockquoteNesting();
+    void ApplyOverlayColors();
+
+    /// Apply the overlays the decoration engine reports for the viewport.
+    void UpdateDecorations();
+    [[nodiscard]] auto OverlayIndicator(uint16_t style_id) const -> int;
 
     // ── Phase 3: Behavior methods ──
     void HandleSmartPairCompletion(int char_added);
     void SelectNextOccurrence();
-    void HighlightWordUnderCursor();
-    void ClearWordHighlights();
     void HandleSmartHome();
-    void HighlightTrailingWhitespace();
     void UpdateStickyScrollHeading();
 
     // ── Phase 5: Snippet helpers ──
@@ -495,6 +593,7 @@ private:
 
     // ── Event handlers ──
     void OnEditorChange(wxStyledTextEvent& event);
+    void OnEditorModified(wxStyledTextEvent& event);
     void OnEditorUpdateUI(wxStyledTextEvent& event);
     void OnCharAdded(wxStyledTextEvent& event);
     void OnKeyDown(wxKeyEvent& event);
@@ -502,6 +601,13 @@ private:
     void OnRightDown(wxMouseEvent& event); // R4 Fix 1
     void ShowEditorContextMenu();          // R4 Fix 1
     void OnDebounceTimer(wxTimerEvent& event);
+    void OnStyleNeeded(wxStyledTextEvent& event);
+
+    // ── Large-file code highlighting helpers ──
+    void OnCodeHighlightReady(const core::HighlightResult& result);
+    void StyleCodeLines(std::size_t first_line, std::size_t last_line);
+    void RestyleDirtyCodeLines();
+    [[nodiscard]] auto CodePrefetchRange() const -> rendering::PrefetchManager::PrefetchRange;
 
     // ── Bracket matching helpers ──
     void CheckBracketMatch();
@@ -538,11 +644,14 @@ private:
 
     // ── Phase 2: Syntax overlays state ──
     bool syntax_overlays_enabled_{true};
+    core::DecorationEngine decorations_;
+    core::DecorationService* decoration_service_{nullptr};
+    std::string decoration_uri_;
+    std::size_t decoration_listener_id_{0};
 
     // ── Phase 3: Behavior state ──
     bool trailing_ws_visible_{true};
     bool auto_trim_trailing_ws_{false};
-    std::string last_highlighted_word_;
 
     // ── Phase 5: Contextual Inline Tools state ──
     FloatingFormatBar* format_bar_{nullptr};
@@ -572,10 +681,25 @@ private:
     void OnFormatBarTimer(wxTimerEvent& event);
 
     // ── Phase 6D: Minimap ──
-    wxStyledTextCtrl* minimap_{nullptr};
+    // Line bars painted from cached tiles; minimap_buffer_ holds the rows on
+    // screen and is shifted on scroll, so only revealed or edited rows are
+    // composed again
+    static constexpr int kMinimapWidth = 120;
+    static constexpr int kMinimapStyleCount = kFenceMarkerStyle + 1;
+    wxWindow* minimap_{nullptr};
     bool minimap_visible_{false};
+    core::MinimapRenderer minimap_renderer_;
+    rendering::ScrollBlit minimap_blit_;
+    wxBitmap minimap_buffer_;
+    int minimap_top_{0}; // Content row at the top of minimap_buffer_
+    bool minimap_buffer_stale_{true};
     void CreateMinimap();
+    void ResetMinimap();
+    void UpdateMinimapPalette();
     void UpdateMinimapContent();
+    void PaintMinimapRows(int first_row, int buffer_row, int row_count);
+    void OnMinimapPaint(wxPaintEvent& event);
+    void OnMinimapSize(wxSizeEvent& event);
     void OnMinimapClick(wxMouseEvent& event);
 
     // ── VS Code Improvements state ──
@@ -90,10 +90,59 @@ void FileTreeCtrl::SetFileTree(const std::vector<core::FileNode>& roots)
     };
     sort_recursive(roots_);
 
+    node_index_.clear();
+    core::index_file_tree(roots_, node_index_);
+    held_listings_.clear();
+    requested_folders_.clear();
+
+    UpdateVirtualHeight();
+    Refresh();
+}
+
+void FileTreeCtrl::ApplyDirectoryListings(std::vector<core::DirectoryListing> listings)
+{
+    bool changed = false;
+    for (auto& listing : listings)
+    {
+        if (!workspace_root_.empty() && listing.path == workspace_root_)
+        {
+            // Top level of the workspace (already sorted by the scanner);
+            // a re-list after a change on disk keeps expanded folders
+            core::merge_file_nodes(roots_, std::move(listing.children), node_index_);
+            core::apply_held_listings(roots_, node_index_, held_listings_);
+            changed = true;
+        }
+        else if (core::apply_directory_listing(node_index_, listing, held_listings_))
+        {
+            requested_folders_.erase(listing.path);
+            changed = true;
+        }
+    }
+    if (!changed)
+    {
+        return;
+    }
+
+    if (!filter_text_.empty())
+    {
+        ApplyFilter(filter_text_);
+        return;
+    }
     UpdateVirtualHeight();
     Refresh();
 }
 
+auto FileTreeCtrl::HasListedFolder(const std::string& folder_id) const -> bool
+{
+    if (!workspace_root_.empty() && folder_id == workspace_root_)
+    {
+        return true;
+    }
+    const auto found = node_index_.find(folder_id);
+    return found != node_index_.end() && found->second->is_folder() &&
+           found->second->children_loaded;
+}
+
 void FileTreeCtrl::SetActiveFileId(const std::string& file_id)
 {
     if (active_file_id_ != file_id)
@@ -169,6 +218,11 @@ void FileTreeCtrl::SetOnFileOpen(FileOpenCallback callback)
     on_file_open_ = std::move(callback);
 }
 
+void FileTreeCtrl::SetOnFolderExpand(FolderExpandCallback callback)
+{
+    on_folder_expand_ = std::move(callback);
+}
+
 void FileTreeCtrl::SetWorkspaceRoot(const std::string& root_path)
 {
     workspace_root_ = root_path;
@@ -282,12 +336,23 @@ void FileTreeCtrl::OnPaint(wxPaintEvent& /*event*/)
     // Font
     dc.SetFont(theme_engine().font(core::ThemeFontToken::MonoRegular));
 
-    int y_offset = -scroll_offset_;
-    for (const auto& node : roots_)
+    // Draw only the rows that intersect the viewport
+    const auto first_row = static_cast<std::size_t>(std::max(0, scroll_offset_ / kRowHeight));
+    const auto last_row = std::min(
+        rows_.size(),
+        static_cast<std::size_t>(std::max(0, (scroll_offset_ + sz.GetHeight()) / kRowHeight + 1)));
+    const std::string focused_id = GetFocusedNodeId();
+    for (std::size_t index = first_row; index < last_row; ++index)
     {
-        if (node.filter_visible)
+        const auto& row = rows_[index];
+        const int row_top = static_cast<int>(index) * kRowHeight - scroll_offset_;
+        if (row.kind == core::FileTreeRowKind::Node)
         {
-            DrawNode(dc, node, 0, y_offset);
+            DrawNodeRow(dc, *row.node, row.depth, row_top, focused_id);
+        }
+        else
+        {
+            DrawPlaceholderRow(dc, row, row_top);
         }
     }
 }
@@ -340,344 +405,326 @@ void FileTreeCtrl::LoadIcons()
     icon_chevron_down_ = load_svg("chevron-down");
 }
 
-void FileTreeCtrl::DrawNode(wxDC& dc, const core::FileNode& node, int depth, int& y_offset)
+void FileTreeCtrl::DrawNodeRow(wxDC& dc,
+                               const core::FileNode& node,
+                               int depth,
+                               int row_top,
+                               const std::string& focused_id)
 {
-    auto sz = GetClientSize();
-    int row_top = y_offset;
-    int row_w = sz.GetWidth();
+    const int row_w = GetClientSize().GetWidth();
+
+    // VS Code style layout:
+    // [Indent] [Twistie] [Icon] [Text]
+    // Twistie is always present in the slot, but only drawn for folders.
+    // Icon is always present.
+
+    int content_x = kLeftPadding + depth * kIndentWidth;
+    int twistie_x = content_x;
+    int icon_x = twistie_x + kTwistieSize;
+    int text_x = icon_x + kIconSize + kIconTextGap;
+
+    // Centering vertically
+    int text_y = row_top + (kRowHeight - dc.GetCharHeight()) / 2;
+    int icon_y = row_top + (kRowHeight - kIconSize) / 2;
+    int twistie_y = row_top + (kRowHeight - kTwistieSize) / 2;
+
+    bool is_selected = (node.id == active_file_id_);
+    bool is_hovered = (node.id == hovered_node_id_);
 
-    // Only draw if the row is visible
-    if (row_top + kRowHeight > 0 && row_top < sz.GetHeight())
+    // Fix 6: Draw indent guide lines (VS Code style vertical lines at each indent level)
+    if (depth > 0)
     {
-        // VS Code style layout:
-        // [Indent] [Twistie] [Icon] [Text]
-        // Twistie is always present in the slot, but only drawn for folders.
-        // Icon is always present.
-
-        int content_x = kLeftPadding + depth * kIndentWidth;
-        int twistie_x = content_x;
-        int icon_x = twistie_x + kTwistieSize;
-        int text_x = icon_x + kIconSize + kIconTextGap;
-
-        // Centering vertically
-        int text_y = row_top + (kRowHeight - dc.GetCharHeight()) / 2;
-        int icon_y = row_top + (kRowHeight - kIconSize) / 2;
-        int twistie_y = row_top + (kRowHeight - kTwistieSize) / 2;
-
-        bool is_selected = (node.id == active_file_id_);
-        bool is_hovered = (node.id == hovered_node_id_);
-
-        // Fix 6: Draw indent guide lines (VS Code style vertical lines at each indent level)
-        if (depth > 0)
+        dc.SetPen(wxPen(
+            theme_engine().color(core::ThemeColorToken::BorderLight).ChangeLightness(90), 1));
+        for (int guide_depth = 1; guide_depth <= depth; ++guide_depth)
         {
-            dc.SetPen(wxPen(
-                theme_engine().color(core::ThemeColorToken::BorderLight).ChangeLightness(90), 1));
-            for (int guide_depth = 1; guide_depth <= depth; ++guide_depth)
-            {
-                const int guide_x = kLeftPadding + guide_depth * kIndentWidth - (kIndentWidth / 2);
-                dc.DrawLine(guide_x, row_top, guide_x, row_top + kRowHeight);
-            }
+            const int guide_x = kLeftPadding + guide_depth * kIndentWidth - (kIndentWidth / 2);
+            dc.DrawLine(guide_x, row_top, guide_x, row_top + kRowHeight);
         }
+    }
 
-        // Row background
-        // VS Code uses full row selection
-        if (is_selected)
-        {
-            dc.SetBrush(wxBrush(theme_engine()
-                                    .color(core::ThemeColorToken::AccentPrimary)
-                                    .ChangeLightness(180))); // Lighter accent
-            dc.SetPen(*wxTRANSPARENT_PEN);
-            dc.DrawRectangle(0, row_top, row_w, kRowHeight);
+    // Row background
+    // VS Code uses full row selection
+    if (is_selected)
+    {
+        dc.SetBrush(wxBrush(theme_engine()
+                                .color(core::ThemeColorToken::AccentPrimary)
+                                .ChangeLightness(180))); // Lighter accent
+        dc.SetPen(*wxTRANSPARENT_PEN);
+        dc.DrawRectangle(0, row_top, row_w, kRowHeight);
+
+        // R16 Fix 25: 2px accent left border on selected row
+        dc.SetBrush(wxBrush(theme_engine().color(core::ThemeColorToken::AccentPrimary)));
+        dc.DrawRectangle(0, row_top, 2, kRowHeight);
+    }
+    else if (is_hovered)
+    {
+        // R20 Fix 23: Full-width hover row highlight with distinct color
+        dc.SetBrush(wxBrush(theme_engine()
+                                .color(core::ThemeColorToken::BgPanel)
+                                .ChangeLightness(112))); // Slightly brighter for hover
+        dc.SetPen(*wxTRANSPARENT_PEN);
+        dc.DrawRectangle(0, row_top, row_w, kRowHeight);
+    }
 
-            // R16 Fix 25: 2px accent left border on selected row
-            dc.SetBrush(wxBrush(theme_engine().color(core::ThemeColorToken::AccentPrimary)));
-            dc.DrawRectangle(0, row_top, 2, kRowHeight);
-        }
-        else if (is_hovered)
-        {
-            // R20 Fix 23: Full-width hover row highlight with distinct color
-            dc.SetBrush(wxBrush(theme_engine()
-                                    .color(core::ThemeColorToken::BgPanel)
-                                    .ChangeLightness(112))); // Slightly brighter for hover
-            dc.SetPen(*wxTRANSPARENT_PEN);
-            dc.DrawRectangle(0, row_top, row_w, kRowHeight);
-        }
+    // R16 Fix 26: Faint bottom border on each row
+    dc.SetPen(
+        wxPen(theme_engine().color(core::ThemeColorToken::BorderLight).ChangeLightness(95), 1));
+    dc.DrawLine(content_x, row_top + kRowHeight - 1, row_w, row_top + kRowHeight - 1);
 
-        // R16 Fix 26: Faint bottom border on each row
-        dc.SetPen(
-            wxPen(theme_engine().color(core::ThemeColorToken::BorderLight).ChangeLightness(95), 1));
-        dc.DrawLine(content_x, row_top + kRowHeight - 1, row_w, row_top + kRowHeight - 1);
+    // R3 Fix 3: Focus ring for keyboard navigation
+    if (node.id == focused_id)
+    {
+        dc.SetBrush(*wxTRANSPARENT_BRUSH);
+        wxPen focus_pen(theme_engine().color(core::ThemeColorToken::AccentPrimary),
+                        1,
+                        wxPENSTYLE_SHORT_DASH);
+        dc.SetPen(focus_pen);
+        dc.DrawRectangle(1, row_top + 1, row_w - 2, kRowHeight - 2);
+    }
 
-        // R3 Fix 3: Focus ring for keyboard navigation
-        if (node.id == GetFocusedNodeId())
+    // 1. Draw Twistie (Chevron) - LEFT ALIGNED now
+    if (node.is_folder())
+    {
+        wxBitmapBundle* chevron_bundle = node.is_open ? &icon_chevron_down_ : &icon_chevron_right_;
+        if (chevron_bundle && chevron_bundle->IsOk())
         {
-            dc.SetBrush(*wxTRANSPARENT_BRUSH);
-            wxPen focus_pen(theme_engine().color(core::ThemeColorToken::AccentPrimary),
-                            1,
-                            wxPENSTYLE_SHORT_DASH);
-            dc.SetPen(focus_pen);
-            dc.DrawRectangle(1, row_top + 1, row_w - 2, kRowHeight - 2);
+            // Draw chevron slightly smaller or centered in the 16px slot
+            wxBitmap bitmap = chevron_bundle->GetBitmap(wxSize(kTwistieSize, kTwistieSize));
+            dc.DrawBitmap(bitmap, twistie_x, twistie_y, true);
         }
+    }
 
-        // 1. Draw Twistie (Chevron) - LEFT ALIGNED now
-        if (node.is_folder())
+    // 2. Draw Icon
+    wxBitmapBundle* icon_bundle = nullptr;
+    if (node.is_folder())
+    {
+        icon_bundle = node.is_open ? &icon_folder_open_ : &icon_folder_;
+    }
+    else
+    {
+        // Fix 5: Expanded text-file extension check for common editable formats
+        const auto& name = node.name;
+        const auto has_ext = [&name](const char* ext)
         {
-            wxBitmapBundle* chevron_bundle =
-                node.is_open ? &icon_chevron_down_ : &icon_chevron_right_;
-            if (chevron_bundle && chevron_bundle->IsOk())
-            {
-                // Draw chevron slightly smaller or centered in the 16px slot
-                wxBitmap bitmap = chevron_bundle->GetBitmap(wxSize(kTwistieSize, kTwistieSize));
-                dc.DrawBitmap(bitmap, twistie_x, twistie_y, true);
-            }
-        }
-
-        // 2. Draw Icon
-        wxBitmapBundle* icon_bundle = nullptr;
-        if (node.is_folder())
+            return name.size() >= std::strlen(ext) &&
+                   name.compare(name.size() - std::strlen(ext), std::strlen(ext), ext) == 0;
+        };
+        if (has_ext(".md") || has_ext(".txt") || has_ext(".json") || has_ext(".yml") ||
+            has_ext(".yaml") || has_ext(".toml") || has_ext(".xml") || has_ext(".html") ||
+            has_ext(".htm") || has_ext(".css") || has_ext(".js") || has_ext(".ts") ||
+            has_ext(".jsx") || has_ext(".tsx") || has_ext(".sh") || has_ext(".py") ||
+            has_ext(".rb") || has_ext(".go") || has_ext(".rs") || has_ext(".c") ||
+            has_ext(".cpp") || has_ext(".h") || has_ext(".hpp") || has_ext(".java") ||
+            has_ext(".swift") || has_ext(".kt") || has_ext(".cfg") || has_ext(".ini") ||
+            has_ext(".env") || has_ext(".log") || has_ext(".csv") || has_ext(".sql"))
         {
-            icon_bundle = node.is_open ? &icon_folder_open_ : &icon_folder_;
+            icon_bundle = &icon_file_text_;
         }
         else
         {
-            // Fix 5: Expanded text-file extension check for common editable formats
-            const auto& name = node.name;
-            const auto has_ext = [&name](const char* ext)
-            {
-                return name.size() >= std::strlen(ext) &&
-                       name.compare(name.size() - std::strlen(ext), std::strlen(ext), ext) == 0;
-            };
-            if (has_ext(".md") || has_ext(".txt") || has_ext(".json") || has_ext(".yml") ||
-                has_ext(".yaml") || has_ext(".toml") || has_ext(".xml") || has_ext(".html") ||
-                has_ext(".htm") || has_ext(".css") || has_ext(".js") || has_ext(".ts") ||
-                has_ext(".jsx") || has_ext(".tsx") || has_ext(".sh") || has_ext(".py") ||
-                has_ext(".rb") || has_ext(".go") || has_ext(".rs") || has_ext(".c") ||
-                has_ext(".cpp") || has_ext(".h") || has_ext(".hpp") || has_ext(".java") ||
-                has_ext(".swift") || has_ext(".kt") || has_ext(".cfg") || has_ext(".ini") ||
-                has_ext(".env") || has_ext(".log") || has_ext(".csv") || has_ext(".sql"))
-            {
-                icon_bundle = &icon_file_text_;
-            }
-            else
-            {
-                icon_bundle = &icon_file_;
-            }
+            icon_bundle = &icon_file_;
         }
+    }
 
-        if (icon_bundle && icon_bundle->IsOk())
+    if (icon_bundle && icon_bundle->IsOk())
+    {
+        wxBitmap bitmap = icon_bundle->GetBitmap(wxSize(kIconSize, kIconSize));
+        dc.DrawBitmap(bitmap, icon_x, icon_y, true);
+    }
+
+    // R20 Fix 22: File icon color tint by extension
+    if (node.is_file())
+    {
+        const auto& fname = node.name;
+        wxColour ext_color;
+        auto ends_with = [&fname](const char* ext) -> bool
+        {
+            return fname.size() >= std::strlen(ext) &&
+                   fname.compare(fname.size() - std::strlen(ext), std::strlen(ext), ext) == 0;
+        };
+        if (ends_with(".md") || ends_with(".txt"))
         {
-            wxBitmap bitmap = icon_bundle->GetBitmap(wxSize(kIconSize, kIconSize));
-            dc.DrawBitmap(bitmap, icon_x, icon_y, true);
+            ext_color = wxColour(100, 149, 237); // cornflower blue
         }
-
-        // R20 Fix 22: File icon color tint by extension
-        if (node.is_file())
+        else if (ends_with(".json") || ends_with(".yml") || ends_with(".yaml"))
         {
-            const auto& fname = node.name;
-            wxColour ext_color;
-            auto ends_with = [&fname](const char* ext) -> bool
-            {
-                return fname.size() >= std::strlen(ext) &&
-                       fname.compare(fname.size() - std::strlen(ext), std::strlen(ext), ext) == 0;
-            };
-            if (ends_with(".md") || ends_with(".txt"))
-            {
-                ext_color = wxColour(100, 149, 237); // cornflower blue
-            }
-            else if (ends_with(".json") || ends_with(".yml") || ends_with(".yaml"))
-            {
-                ext_color = wxColour(230, 200, 50); // yellow
-            }
-            else if (ends_with(".cpp") || ends_with(".h") || ends_with(".hpp") || ends_with(".c"))
-            {
-                ext_color = wxColour(150, 100, 200); // purple
-            }
-            else if (ends_with(".js") || ends_with(".ts") || ends_with(".jsx") || ends_with(".tsx"))
-            {
-                ext_color = wxColour(80, 200, 120); // green
-            }
-            else if (ends_with(".html") || ends_with(".htm") || ends_with(".css"))
-            {
-                ext_color = wxColour(255, 140, 60); // orange
-            }
-            else if (ends_with(".py") || ends_with(".rb") || ends_with(".go") || ends_with(".rs"))
-            {
-                ext_color = wxColour(220, 100, 100); // red-ish
-            }
-            // Draw a small 4px colored dot next to the icon as extension indicator
-            if (ext_color.IsOk())
-            {
-                dc.SetBrush(wxBrush(ext_color));
-                dc.SetPen(*wxTRANSPARENT_PEN);
-                dc.DrawCircle(icon_x + kIconSize + 1, icon_y + kIconSize - 2, 3);
-            }
+            ext_color = wxColour(230, 200, 50); // yellow
         }
-
-        // 3. Draw Text
-        // Fix 4: Distinct colors for selected vs hovered vs normal
-        if (is_selected)
+        else if (ends_with(".cpp") || ends_with(".h") || ends_with(".hpp") || ends_with(".c"))
         {
-            dc.SetTextForeground(
-                theme_engine().color(core::ThemeColorToken::AccentPrimary).ChangeLightness(80));
+            ext_color = wxColour(150, 100, 200); // purple
         }
-        else if (is_hovered)
+        else if (ends_with(".js") || ends_with(".ts") || ends_with(".jsx") || ends_with(".tsx"))
         {
-            dc.SetTextForeground(theme_engine().color(core::ThemeColorToken::TextMain));
+            ext_color = wxColour(80, 200, 120); // green
         }
-        else
+        else if (ends_with(".html") || ends_with(".htm") || ends_with(".css"))
+        {
+            ext_color = wxColour(255, 140, 60); // orange
+        }
+        else if (ends_with(".py") || ends_with(".rb") || ends_with(".go") || ends_with(".rs"))
         {
-            dc.SetTextForeground(theme_engine().color(core::ThemeColorToken::TextMuted));
+            ext_color = wxColour(220, 100, 100); // red-ish
         }
+        // Draw a small 4px colored dot next to the icon as extension indicator
+        if (ext_color.IsOk())
+        {
+            dc.SetBrush(wxBrush(ext_color));
+            dc.SetPen(*wxTRANSPARENT_PEN);
+            dc.DrawCircle(icon_x + kIconSize + 1, icon_y + kIconSize - 2, 3);
+        }
+    }
 
-        // Truncate text with ellipsis if it overflows
-        int max_text_width = row_w - text_x - kLeftPadding;
-        wxString display_name = node.name;
-        auto text_extent = dc.GetTextExtent(display_name);
-        if (text_extent.GetWidth() > max_text_width && max_text_width > 0)
+    // 3. Draw Text
+    // Fix 4: Distinct colors for selected vs hovered vs normal
+    if (is_selected)
+    {
+        dc.SetTextForeground(
+            theme_engine().color(core::ThemeColorToken::AccentPrimary).ChangeLightness(80));
+    }
+    else if (is_hovered)
+    {
+        dc.SetTextForeground(theme_engine().color(core::ThemeColorToken::TextMain));
+    }
+    else
+    {
+        dc.SetTextForeground(theme_engine().color(core::ThemeColorToken::TextMuted));
+    }
+
+    // Truncate text with ellipsis if it overflows
+    int max_text_width = row_w - text_x - kLeftPadding;
+    wxString display_name = node.name;
+    auto text_extent = dc.GetTextExtent(display_name);
+    if (text_extent.GetWidth() > max_text_width && max_text_width > 0)
+    {
+        // Simple ellipsis truncation
+        while (display_name.length() > 1)
         {
-            // Simple ellipsis truncation
-            while (display_name.length() > 1)
+            display_name = display_name.Left(display_name.length() - 1);
+            if (dc.GetTextExtent(display_name + "...").GetWidth() <= max_text_width)
             {
-                display_name = display_name.Left(display_name.length() - 1);
-                if (dc.GetTextExtent(display_name + "...").GetWidth() <= max_text_width)
-                {
-                    display_name += "...";
-                    break;
-                }
+                display_name += "...";
+                break;
             }
         }
-        // R20 Fix 24: Bold matched filter characters in file names
-        if (!filter_text_.empty() && !node.is_folder())
+    }
+    // R20 Fix 24: Bold matched filter characters in file names
+    if (!filter_text_.empty() && !node.is_folder())
+    {
+        // Find the match position in display_name (case-insensitive)
+        std::string lower_display;
+        for (char ch : display_name.ToStdString())
         {
-            // Find the match position in display_name (case-insensitive)
-            std::string lower_display;
-            for (char ch : display_name.ToStdString())
-            {
-                lower_display += static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
-            }
-            std::string lower_filter = filter_text_;
-            std::transform(lower_filter.begin(),
-                           lower_filter.end(),
-                           lower_filter.begin(),
-                           [](unsigned char chr) { return static_cast<char>(std::tolower(chr)); });
-            auto match_pos = lower_display.find(lower_filter);
-            if (match_pos != std::string::npos)
-            {
-                // Draw text in segments: before, match (bold), after
-                auto font_normal = dc.GetFont();
-                wxFont font_bold = font_normal;
-                font_bold.SetWeight(wxFONTWEIGHT_BOLD);
+            lower_display += static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+        }
+        std::string lower_filter = filter_text_;
+        std::transform(lower_filter.begin(),
+                       lower_filter.end(),
+                       lower_filter.begin(),
+                       [](unsigned char chr) { return static_cast<char>(std::tolower(chr)); });
+        auto match_pos = lower_display.find(lower_filter);
+        if (match_pos != std::string::npos)
+        {
+            // Draw text in segments: before, match (bold), after
+            auto font_normal = dc.GetFont();
+            wxFont font_bold = font_normal;
+            font_bold.SetWeight(wxFONTWEIGHT_BOLD);
 
-                wxString before_text = display_name.Left(match_pos);
-                wxString match_text = display_name.Mid(match_pos, lower_filter.size());
-                wxString after_text = display_name.Mid(match_pos + lower_filter.size());
+            wxString before_text = display_name.Left(match_pos);
+            wxString match_text = display_name.Mid(match_pos, lower_filter.size());
+            wxString after_text = display_name.Mid(match_pos + lower_filter.size());
 
-                int draw_x = text_x;
-                if (!before_text.empty())
-                {
-                    dc.DrawText(before_text, draw_x, text_y);
-                    draw_x += dc.GetTextExtent(before_text).GetWidth();
-                }
-                dc.SetFont(font_bold);
-                dc.SetTextForeground(theme_engine().color(core::ThemeColorToken::AccentPrimary));
-                dc.DrawText(match_text, draw_x, text_y);
-                draw_x += dc.GetTextExtent(match_text).GetWidth();
-                dc.SetFont(font_normal);
-                dc.SetTextForeground(is_selected ? theme_engine()
-                                                       .color(core::ThemeColorToken::AccentPrimary)
-                                                       .ChangeLightness(80)
-                                     : is_hovered
-                                         ? theme_engine().color(core::ThemeColorToken::TextMain)
-                                         : theme_engine().color(core::ThemeColorToken::TextMuted));
-                if (!after_text.empty())
-                {
-                    dc.DrawText(after_text, draw_x, text_y);
-                }
+            int draw_x = text_x;
+            if (!before_text.empty())
+            {
+                dc.DrawText(before_text, draw_x, text_y);
+                draw_x += dc.GetTextExtent(before_text).GetWidth();
             }
-            else
+            dc.SetFont(font_bold);
+            dc.SetTextForeground(theme_engine().color(core::ThemeColorToken::AccentPrimary));
+            dc.DrawText(match_text, draw_x, text_y);
+            draw_x += dc.GetTextExtent(match_text).GetWidth();
+            dc.SetFont(font_normal);
+            dc.SetTextForeground(is_selected ? theme_engine()
+                                                   .color(core::ThemeColorToken::AccentPrimary)
+                                                   .ChangeLightness(80)
+                                 : is_hovered
+                                     ? theme_engine().color(core::ThemeColorToken::TextMain)
+                                     : theme_engine().color(core::ThemeColorToken::TextMuted));
+            if (!after_text.empty())
             {
-                dc.DrawText(display_name, text_x, text_y);
+                dc.DrawText(after_text, draw_x, text_y);
             }
         }
         else
         {
             dc.DrawText(display_name, text_x, text_y);
         }
+    }
+    else
+    {
+        dc.DrawText(display_name, text_x, text_y);
+    }
 
-        // R5 Fix 14: Draw file metadata (size or child count) right-aligned in muted text
+    // R5 Fix 14: Draw file metadata (size or child count) right-aligned in muted text
+    {
+        std::string meta_text;
+        if (node.is_file())
         {
-            std::string meta_text;
-            if (node.is_file())
+            try
             {
-                try
+                const auto fsize = std::filesystem::file_size(node.id);
+                if (fsize < 1024)
                 {
-                    const auto fsize = std::filesystem::file_size(node.id);
-                    if (fsize < 1024)
-                    {
-                        meta_text = std::to_string(fsize) + " B";
-                    }
-                    else if (fsize < 1024 * 1024)
-                    {
-                        meta_text = std::to_string(fsize / 1024) + " KB";
-                    }
-                    else
-                    {
-                        meta_text = std::to_string(fsize / (1024 * 1024)) + " MB";
-                    }
+                    meta_text = std::to_string(fsize) + " B";
                 }
-                catch (const std::filesystem::filesystem_error& /*err*/)
+                else if (fsize < 1024 * 1024)
                 {
-                    // Untitled file — no size
+                    meta_text = std::to_string(fsize / 1024) + " KB";
                 }
-            }
-            else
-            {
-                const auto child_count = node.children.size();
-                meta_text = std::to_string(child_count) + (child_count == 1 ? " item" : " items");
-            }
-
-            if (!meta_text.empty())
-            {
-                dc.SetTextForeground(
-                    theme_engine().color(core::ThemeColorToken::TextMuted).ChangeLightness(85));
-                auto meta_extent = dc.GetTextExtent(meta_text);
-                int meta_x = row_w - meta_extent.GetWidth() - kLeftPadding;
-                if (meta_x > text_x + 40) // only draw if there's room
+                else
                 {
-                    dc.DrawText(meta_text, meta_x, text_y);
+                    meta_text = std::to_string(fsize / (1024 * 1024)) + " MB";
                 }
             }
-        }
-
-        // Chevron for folders (right-aligned)
-        // OBSOLETE: Chevron is now left-aligned and drawn above.
-    }
-
-    y_offset += kRowHeight;
-
-    // Draw children if folder is open
-    if (node.is_folder() && node.is_open)
-    {
-        bool has_visible_children = false;
-        for (const auto& child : node.children)
-        {
-            if (child.filter_visible)
+            catch (const std::filesystem::filesystem_error& /*err*/)
             {
-                has_visible_children = true;
-                DrawNode(dc, child, depth + 1, y_offset);
+                // Untitled file — no size
             }
         }
+        else if (node.children_loaded)
+        {
+            const auto child_count = node.children.size();
+            meta_text = std::to_string(child_count) + (child_count == 1 ? " item" : " items");
+        }
 
-        // Fix 8: Show placeholder for empty open folders
-        if (!has_visible_children)
+        if (!meta_text.empty())
         {
-            int empty_x = kLeftPadding + (depth + 1) * kIndentWidth + kTwistieSize;
-            int empty_y = y_offset + (kRowHeight - dc.GetCharHeight()) / 2;
-            dc.SetTextForeground(theme_engine().color(core::ThemeColorToken::TextMuted));
-            dc.DrawText("(empty)", empty_x, empty_y);
-            y_offset += kRowHeight;
+            dc.SetTextForeground(
+                theme_engine().color(core::ThemeColorToken::TextMuted).ChangeLightness(85));
+            auto meta_extent = dc.GetTextExtent(meta_text);
+            int meta_x = row_w - meta_extent.GetWidth() - kLeftPadding;
+            if (meta_x > text_x + 40) // only draw if there's room
+            {
+                dc.DrawText(meta_text, meta_x, text_y);
+            }
         }
     }
+
+    // Chevron for folders (right-aligned)
+    // OBSOLETE: Chevron is now left-aligned and drawn above.
+}
+
+void FileTreeCtrl::DrawPlaceholderRow(wxDC& dc, const core::FileTreeRow& row, int row_top)
+{
+    // Fix 8: Show placeholder for empty open folders (and ones still loading)
+    const int text_x = kLeftPadding + row.depth * kIndentWidth + kTwistieSize;
+    const int text_y = row_top + (kRowHeight - dc.GetCharHeight()) / 2;
+    dc.SetTextForeground(theme_engine().color(core::ThemeColorToken::TextMuted));
+    dc.DrawText(row.kind == core::FileTreeRowKind::Loading ? "Loading..." : "(empty)",
+                text_x,
+                text_y);
 }
 
 // --- Interaction ---
@@ -834,81 +881,56 @@ void FileTreeCtrl::OnMouseLeave(wxMouseEvent& /*event*/)
 
 auto FileTreeCtrl::HitTest(const wxPoint& point) -> HitResult
 {
-    int y_offset = -scroll_offset_;
-    return HitTestRecursive(point, roots_, 0, y_offset);
-}
-
-auto FileTreeCtrl::HitTestRecursive(const wxPoint& point,
-                                    std::vector<core::FileNode>& nodes,
-                                    int depth,
-                                    int& y_offset) -> HitResult
-{
-    for (auto& node : nodes)
+    const int content_y = point.y + scroll_offset_;
+    if (point.y < 0 || content_y < 0)
     {
-        if (!node.filter_visible)
-        {
-            continue;
-        }
-
-        int row_top = y_offset;
-        y_offset += kRowHeight;
-
-        if (point.y >= row_top && point.y < row_top + kRowHeight)
-        {
-            bool on_chevron = false;
-            if (node.is_folder())
-            {
-                // VS Code style: Click anywhere on the twistie area to toggle
-                // Twistie is at: kLeftPadding + depth * kIndentWidth
-                int twistie_x = kLeftPadding + depth * kIndentWidth;
-
-                // Allow clicking slightly wider area for usability?
-                // VS Code allows clicking the icon to select, twistie to toggle.
-                // Twistie width is 16px.
-
-                on_chevron = (point.x >= twistie_x && point.x < twistie_x + kTwistieSize);
-            }
-            return {&node, on_chevron};
-        }
-
-        if (node.is_folder() && node.is_open)
-        {
-            auto result = HitTestRecursive(point, node.children, depth + 1, y_offset);
-            if (result.node != nullptr)
-            {
-                return result;
-            }
-        }
+        return {nullptr, false};
+    }
+    const auto index = static_cast<std::size_t>(content_y / kRowHeight);
+    if (index >= rows_.size() || rows_[index].kind != core::FileTreeRowKind::Node)
+    {
+        return {nullptr, false};
     }
 
-    return {nullptr, false};
+    const auto& row = rows_[index];
+    bool on_chevron = false;
+    if (row.node->is_folder())
+    {
+        // VS Code style: the twistie (16px at kLeftPadding + depth * kIndentWidth) toggles
+        const int twistie_x = kLeftPadding + row.depth * kIndentWidth;
+        on_chevron = (point.x >= twistie_x && point.x < twistie_x + kTwistieSize);
+    }
+    return {row.node, on_chevron};
 }
 
 // --- Scrolling ---
 
 void FileTreeCtrl::UpdateVirtualHeight()
 {
-    // Count visible nodes
-    std::function<int(const std::vector<core::FileNode>&)> count_visible;
-    count_visible = [&](const std::vector<core::FileNode>& nodes) -> int
+    // Flatten the open part of the tree; paint and hit-test index into it
+    std::vector<core::FileNode*> unloaded_open;
+    core::flatten_file_tree(roots_, rows_, &unloaded_open);
+    visible_nodes_.clear();
+    for (const auto& row : rows_)
     {
-        int count = 0;
-        for (const auto& node : nodes)
+        if (row.kind == core::FileTreeRowKind::Node)
         {
-            if (!node.filter_visible)
-            {
-                continue;
-            }
-            count += 1;
-            if (node.is_folder() && node.is_open)
-            {
-                count += count_visible(node.children);
-            }
+            visible_nodes_.push_back(row.node);
         }
-        return count;
-    };
+    }
+    virtual_height_ = static_cast<int>(rows_.size()) * kRowHeight;
+
+    const int max_scroll = std::max(0, virtual_height_ - GetClientSize().GetHeight());
+    scroll_offset_ = std::min(scroll_offset_, max_scroll);
 
-    virtual_height_ = count_visible(roots_) * kRowHeight;
+    // Opened folders the workspace scan has not listed yet: ask for them once
+    for (const auto* folder : unloaded_open)
+    {
+        if (on_folder_expand_ && requested_folders_.insert(folder->id).second)
+        {
+            on_folder_expand_(*folder);
+        }
+    }
 }
 
 void FileTreeCtrl::OnScroll(wxMouseEvent& event)
@@ -1533,26 +1555,7 @@ void FileTreeCtrl::OnKeyDown(wxKeyEvent& event)
 
 auto FileTreeCtrl::GetVisibleNodes() -> std::vector<core::FileNode*>
 {
-    std::vector<core::FileNode*> result;
-    CollectVisibleNodes(result, roots_);
-    return result;
-}
-
-void FileTreeCtrl::CollectVisibleNodes(std::vector<core::FileNode*>& result,
-                                       std::vector<core::FileNode>& nodes)
-{
-    for (auto& node : nodes)
-    {
-        if (!node.filter_visible)
-        {
-            continue;
-        }
-        result.push_back(&node);
-        if (node.is_folder() && node.is_open)
-        {
-            CollectVisibleNodes(result, node.children);
-        }
-    }
+    return visible_nodes_;
 }
 
 // Fix 3: Find the parent folder index in the visible node list
@@ -1709,34 +1712,12 @@ void markamp::ui::FileTreeCtrl::OnTypeAheadTimerExpired(wxTimerEvent& /*event*/)
 // R3 Fix 3: Return the id of the node with keyboard focus
 auto markamp::ui::FileTreeCtrl::GetFocusedNodeId() const -> std::string
 {
-    if (focused_node_index_ < 0)
+    if (focused_node_index_ < 0 ||
+        focused_node_index_ >= static_cast<int>(visible_nodes_.size()))
     {
         return {};
     }
-    // We need a const version of GetVisibleNodes; build inline
-    std::vector<const core::FileNode*> nodes;
-    std::function<void(const std::vector<core::FileNode>&)> collect;
-    collect = [&](const std::vector<core::FileNode>& src)
-    {
-        for (const auto& node : src)
-        {
-            if (!node.filter_visible)
-            {
-                continue;
-            }
-            nodes.push_back(&node);
-            if (node.is_folder() && node.is_open)
-            {
-                collect(node.children);
-            }
-        }
-    };
-    collect(roots_);
-    if (focused_node_index_ < static_cast<int>(nodes.size()))
-    {
-        return nodes[static_cast<size_t>(focused_node_index_)]->id;
-    }
-    return {};
+    return visible_nodes_[static_cast<size_t>(focused_node_index_)]->id;
 }
 
 // R3 Fix 2: Expand ancestor folders so that a given node_id becomes visible
@@ -3,6 +3,7 @@
 #include "ThemeAwareWindow.h"
 #include "core/EventBus.h"
 #include "core/FileNode.h"
+#include "core/FileTreeRows.h"
 #include "core/ThemeEngine.h"
 
 #include <wx/bitmap.h>
@@ -13,6 +14,7 @@
 
 #include <functional>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 namespace markamp::ui
@@ -25,6 +27,13 @@ public:
 
     // Data
     void SetFileTree(const std::vector<core::FileNode>& roots);
+    /// Attach folder contents from a workspace scan, or re-list folders
+    /// that changed on disk. The listing of the workspace root itself
+    /// becomes the top level.
+    void ApplyDirectoryListings(std::vector<core::DirectoryListing> listings);
+    /// True when the folder is the workspace root or a folder in the tree
+    /// whose contents have been listed (so a change inside it is visible).
+    [[nodiscard]] auto HasListedFolder(const std::string& folder_id) const -> bool;
     void SetActiveFileId(const std::string& file_id);
     void EnsureNodeVisible(const std::string& node_id);
     void CollapseAllNodes(); // R4 Fix 15
@@ -36,8 +45,11 @@ public:
     // Callbacks
     using FileSelectCallback = std::function<void(const core::FileNode&)>;
     using FileOpenCallback = std::function<void(const core::FileNode&)>;
+    /// Called once when a folder whose contents were not scanned is opened
+    using FolderExpandCallback = std::function<void(const core::FileNode&)>;
     void SetOnFileSelect(FileSelectCallback callback);
     void SetOnFileOpen(FileOpenCallback callback);
+    void SetOnFolderExpand(FolderExpandCallback callback);
 
     // Workspace root for relative path calculation
     void SetWorkspaceRoot(const std::string& root_path);
@@ -54,9 +66,14 @@ protected:
     void OnThemeChanged(const core::Theme& new_theme) override;
 
 private:
-    // Rendering
+    // Rendering: only the rows inside the viewport are drawn
     void OnPaint(wxPaintEvent& event);
-    void DrawNode(wxDC& dc, const core::FileNode& node, int depth, int& y_offset);
+    void DrawNodeRow(wxDC& dc,
+                     const core::FileNode& node,
+                     int depth,
+                     int row_top,
+                     const std::string& focused_id);
+    void DrawPlaceholderRow(wxDC& dc, const core::FileTreeRow& row, int row_top);
 
     // Icons
     void LoadIcons();
@@ -82,8 +99,6 @@ private:
     // Keyboard navigation
     int focused_node_index_{-1};
     auto GetVisibleNodes() -> std::vector<core::FileNode*>;
-    void CollectVisibleNodes(std::vector<core::FileNode*>& result,
-                             std::vector<core::FileNode>& nodes);
     auto FindParentIndex(const std::vector<core::FileNode*>& visible, int child_index) -> int;
     [[nodiscard]] auto GetFocusedNodeId() const -> std::string;
 
@@ -102,12 +117,9 @@ private:
         bool on_chevron{false};
     };
     auto HitTest(const wxPoint& point) -> HitResult;
-    auto HitTestRecursive(const wxPoint& point,
-                          std::vector<core::FileNode>& nodes,
-                          int depth,
-                          int& y_offset) -> HitResult;
 
-    // Scrolling
+    // Scrolling; UpdateVirtualHeight() also rebuilds the flattened rows and
+    // must follow every change to the tree or to open / filter state
     void UpdateVirtualHeight();
     void OnScroll(wxMouseEvent& event);
 
@@ -117,6 +129,12 @@ private:
 
     // State
     std::vector<core::FileNode> roots_;
+    core::FileNodeIndex node_index_;
+    core::HeldListings held_listings_; // Listings that arrived before their parent's
+    std::vector<core::FileTreeRow> rows_;
+    std::vector<core::FileNode*> visible_nodes_; // rows_ without placeholders
+    std::unordered_set<std::string> requested_folders_;
+    FolderExpandCallback on_folder_expand_;
     std::string active_file_id_;
     std::string hovered_node_id_;
     std::string filter_text_;
@@ -16,7 +16,9 @@
 #include "core/FeatureRegistry.h"
 #include "core/Logger.h"
 #include "core/SampleFiles.h"
+#include "core/StringUtils.h"
 
+#include <wx/app.h>
 #include <wx/button.h>
 #include <wx/clipbrd.h>
 #include <wx/dcbuffer.h>
@@ -24,8 +26,11 @@
 #include <wx/msgdlg.h>
 #include <wx/sizer.h>
 
+#include <fmt/format.h>
+
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cmath>
 #include <fstream>
 
@@ -47,6 +52,7 @@ LayoutManager::LayoutManager(wxWindow* parent,
     , mermaid_renderer_(mermaid_renderer)
     , math_renderer_(math_renderer)
     , sidebar_anim_timer_(this)
+    , open_stream_timer_(this)
 {
     RestoreLayoutState();
     CreateLayout();
@@ -76,7 +82,6 @@ LayoutManager::LayoutManager(wxWindow* parent,
                 auto buf_it = file_buffers_.find(active_file_path_);
                 if (buf_it != file_buffers_.end())
                 {
-                    buf_it->second.content = evt.content;
                     buf_it->second.is_modified = true;
                     if (tab_bar_ != nullptr)
                     {
@@ -86,11 +91,16 @@ LayoutManager::LayoutManager(wxWindow* parent,
             }
         });
 
+    text_edited_sub_ = event_bus_.subscribe<core::events::EditorTextEditedEvent>(
+        [this](const core::events::EditorTextEditedEvent& evt)
+        { JournalEdit(evt.version, evt.delta); });
+
     // Auto-save timer
     Bind(wxEVT_TIMER, &LayoutManager::OnAutoSaveTimer, this, auto_save_timer_.GetId());
 
     // Bind animation timer
     Bind(wxEVT_TIMER, &LayoutManager::OnSidebarAnimTimer, this, sidebar_anim_timer_.GetId());
+    Bind(wxEVT_TIMER, &LayoutManager::OnOpenStreamTimer, this, open_stream_timer_.GetId());
 
     // Start auto-save
     StartAutoSave();
@@ -1692,9 +1702,54 @@ LayoutManager::LayoutManager(wxWindow* parent,
 
 void LayoutManager::SaveFile(const std::string& path)
 {
-    if (split_view_)
+    const auto buf_it = file_buffers_.find(path);
+    if (buf_it != file_buffers_.end() && buf_it->second.loading)
+    {
+        // The editor holds only part of the file until streaming finishes
+        MARKAMP_LOG_WARN("Not saving {} while it is still loading", path);
+        return;
+    }
+    auto* editor = split_view_ != nullptr ? split_view_->GetEditorPanel() : nullptr;
+    if (path == active_file_path_ || buf_it == file_buffers_.end())
+    {
+        if (split_view_)
+        {
+            split_view_->SaveFile(path);
+        }
+    }
+    else if (editor != nullptr && buf_it->second.document)
+    {
+        // A background tab: write its own document, not the one on screen
+        std::ofstream out(path);
+        if (!out.is_open())
+        {
+            MARKAMP_LOG_ERROR("Failed to save file: {}", path);
+            return;
+        }
+        out << editor->GetDocumentText(buf_it->second.document);
+        out.close();
+        editor->SetDocumentSavePoint(buf_it->second.document);
+        buf_it->second.is_modified = false;
+        if (tab_bar_ != nullptr)
+        {
+            tab_bar_->SetTabModified(path, false);
+        }
+        MARKAMP_LOG_INFO("Saved file: {}", path);
+    }
+
+    // Our own write is not an external change
+    if (buf_it != file_buffers_.end())
     {
-        split_view_->SaveFile(path);
+        std::error_code time_error;
+        const auto written = std::filesystem::last_write_time(path, time_error);
+        if (!time_error)
+        {
+            if (written != buf_it->second.last_write_time)
+            {
+                edit_journal_.discard(path); // The edits are in the file now
+            }
+            buf_it->second.last_write_time = written;
+        }
     }
 }
 
@@ -1799,6 +1854,16 @@ void LayoutManager::CreateLayout()
             }
         });
 
+    // Folders the workspace scan left unlisted are listed when opened
+    file_tree_->SetOnFolderExpand(
+        [this](const core::FileNode& folder)
+        {
+            if (workspace_scanner_ != nullptr)
+            {
+                workspace_scanner_->expand(folder.id);
+            }
+        });
+
     // Wire file select callback — single-click opens file (Fix 2)
     file_tree_->SetOnFileSelect(
         [this](const core::FileNode& node)
@@ -1974,6 +2039,226 @@ void LayoutManager::setFileTree(const std::vector<core::FileNode>& roots)
     }
 }
 
+void LayoutManager::OpenWorkspaceFolder(const std::string& root_path)
+{
+    SetWorkspaceRoot(root_path);
+    if (file_tree_ != nullptr)
+    {
+        file_tree_->SetFileTree({});
+    }
+    scanned_files_ = 0;
+    scanned_folders_ = 0;
+    listed_counts_.clear();
+    UpdateFileCountLabel(true);
+
+    // Watch before scanning so nothing changed in between goes unseen
+    EnsureFileWatcher();
+    workspace_watch_.cancel();
+    if (auto watch = file_watcher_->watch(root_path, true))
+    {
+        workspace_watch_ = std::move(*watch);
+    }
+    else
+    {
+        MARKAMP_LOG_WARN("Workspace changes will not be tracked: {}", watch.error());
+    }
+
+    if (workspace_scanner_ == nullptr)
+    {
+        workspace_scanner_ = std::make_unique<core::WorkspaceScanner>();
+    }
+    // Batches of an earlier scan may still be queued for the UI thread
+    const uint64_t generation = ++workspace_scan_generation_;
+    workspace_scanner_->scan(
+        root_path,
+        [this, generation](std::vector<core::DirectoryListing> listings)
+        {
+            CallAfter([this, generation, listings = std::move(listings)]() mutable
+                      { OnWorkspaceListings(generation, std::move(listings)); });
+        },
+        [this, generation](std::size_t entries)
+        {
+            CallAfter(
+                [this, generation, entries]()
+                {
+                    if (generation == workspace_scan_generation_)
+                    {
+                        UpdateFileCountLabel(false);
+                        MARKAMP_LOG_DEBUG("Workspace scan idle: {} entries listed", entries);
+                    }
+                });
+        });
+    MARKAMP_LOG_INFO("Scanning workspace: {}", root_path);
+
+    if (workspace_search_ == nullptr)
+    {
+        workspace_search_ = std::make_unique<core::WorkspaceSearchService>();
+    }
+    workspace_search_->track_workspace(
+        root_path,
+        core::Config::config_directory() / "cache" / "search" /
+            fmt::format("{:016x}.idx", core::fnv1a_64(root_path)));
+}
+
+void LayoutManager::OnWorkspaceListings(uint64_t generation,
+                                        std::vector<core::DirectoryListing> listings)
+{
+    if (generation != workspace_scan_generation_)
+    {
+        return;
+    }
+    for (const auto& listing : listings)
+    {
+        const auto folders = static_cast<std::size_t>(
+            std::count_if(listing.children.begin(),
+                          listing.children.end(),
+                          [](const core::FileNode& child) { return child.is_folder(); }));
+        auto& counted = listed_counts_[listing.path];
+        scanned_files_ += listing.children.size() - folders;
+        scanned_folders_ += folders;
+        scanned_files_ -= counted.first;
+        scanned_folders_ -= counted.second;
+        counted = {listing.children.size() - folders, folders};
+    }
+    if (file_tree_ != nullptr)
+    {
+        file_tree_->ApplyDirectoryListings(std::move(listings));
+    }
+    UpdateFileCountLabel(workspace_scanner_ != nullptr && workspace_scanner_->is_scanning());
+}
+
+void LayoutManager::EnsureFileWatcher()
+{
+    if (file_watcher_ != nullptr)
+    {
+        return;
+    }
+    file_watcher_ = std::make_unique<core::FileWatcherService>(event_bus_);
+    // Batches are queued on the bus from the watcher thread; make sure the
+    // idle handler that drains it runs even when the app is otherwise idle
+    file_watcher_->set_wake_callback([]() { wxWakeUpIdle(); });
+    file_changes_sub_ = event_bus_.subscribe<core::events::FileSystemChangedEvent>(
+        [this](const core::events::FileSystemChangedEvent& evt)
+        { OnFileSystemChanged(evt.changes); });
+}
+
+void LayoutManager::WatchOpenFile(const std::string& path)
+{
+    if (path.rfind("untitled:", 0) == 0)
+    {
+        return;
+    }
+    EnsureFileWatcher();
+    // The folder, not the file: saving via a temporary and a rename
+    // replaces the file
+    auto watch = file_watcher_->watch(std::filesystem::path(path).parent_path(), false);
+    if (!watch)
+    {
+        MARKAMP_LOG_WARN("Changes to {} will not be detected: {}", path, watch.error());
+        return;
+    }
+    open_file_watches_[path] = std::move(*watch);
+}
+
+void LayoutManager::OnFileSystemChanged(const std::vector<core::FileChange>& changes)
+{
+    if (workspace_search_ != nullptr)
+    {
+        workspace_search_->apply_changes(changes);
+    }
+
+    const auto parent_of = [](const std::string& path)
+    { return std::filesystem::path(path).parent_path().string(); };
+
+    bool active_changed = false;
+    std::vector<std::string> stale_folders;
+    for (const auto& change : changes)
+    {
+        // Open tabs: the active one is checked now, others when shown
+        const auto buf_it = file_buffers_.find(change.path);
+        if (buf_it != file_buffers_.end() && !buf_it->second.loading)
+        {
+            if (change.kind == core::FileChangeKind::Deleted)
+            {
+                MARKAMP_LOG_WARN("Open file was deleted on disk: {}", change.path);
+            }
+            else if (change.path == active_file_path_)
+            {
+                active_changed = true;
+            }
+            else
+            {
+                buf_it->second.changed_on_disk = true;
+            }
+        }
+        if (change.kind == core::FileChangeKind::Renamed &&
+            file_buffers_.contains(change.old_path))
+        {
+            MARKAMP_LOG_WARN("Open file was moved on disk: {} -> {}", change.old_path, change.path);
+        }
+
+        // File tree: re-list the folders whose entries came or went
+        if (change.kind == core::FileChangeKind::Modified)
+        {
+            if (change.is_directory)
+            {
+                stale_folders.push_back(change.path);
+            }
+            continue;
+        }
+        stale_folders.push_back(parent_of(change.path));
+        if (change.kind == core::FileChangeKind::Renamed)
+        {
+            stale_folders.push_back(parent_of(change.old_path));
+        }
+        if (change.kind != core::FileChangeKind::Created && change.is_directory)
+        {
+            // A folder that went away no longer adds to the file count
+            const auto& gone = change.kind == core::FileChangeKind::Renamed ? change.old_path
+                                                                           : change.path;
+            const auto counted = listed_counts_.find(gone);
+            if (counted != listed_counts_.end())
+            {
+                scanned_files_ -= counted->second.first;
+                scanned_folders_ -= counted->second.second;
+                listed_counts_.erase(counted);
+            }
+        }
+    }
+
+    std::sort(stale_folders.begin(), stale_folders.end());
+    stale_folders.erase(std::unique(stale_folders.begin(), stale_folders.end()),
+                        stale_folders.end());
+    if (workspace_scanner_ != nullptr && file_tree_ != nullptr)
+    {
+        for (const auto& folder : stale_folders)
+        {
+            // Folders the tree has not listed yet will be read fresh anyway
+            if (file_tree_->HasListedFolder(folder))
+            {
+                workspace_scanner_->refresh(folder);
+            }
+        }
+    }
+
+    if (active_changed)
+    {
+        // Prompts; keep the modal dialog out of the bus dispatch
+        CallAfter([this]() { CheckExternalFileChanges(); });
+    }
+}
+
+void LayoutManager::UpdateFileCountLabel(bool scanning)
+{
+    if (file_count_label_ == nullptr)
+    {
+        return;
+    }
+    // Counts cover the folders listed so far; unopened deep folders are not
+    file_count_label_->SetLabel(wxString::Format(
+        "%zu files, %zu folders%s", scanned_files_, scanned_folders_, scanning ? "..." : ""));
+}
+
 // Fix 15: Forward workspace root to file tree for relative path computation
 void LayoutManager::SetWorkspaceRoot(const std::string& root_path)
 {
@@ -2270,6 +2555,41 @@ void LayoutManager::SetExtensionServices(core::IExtensionManagementService* mgmt
     ext_gallery_service_ = gallery_service;
 }
 
+void LayoutManager::SetGrammarEngine(const core::GrammarEngine* grammars)
+{
+    if (split_view_ != nullptr)
+    {
+        split_view_->set_grammar_engine(grammars);
+    }
+}
+
+void LayoutManager::SetDecorationService(core::DecorationService* decorations)
+{
+    decoration_service_ = decorations;
+    UpdateDecorationSource();
+}
+
+void LayoutManager::UpdateDecorationSource()
+{
+    auto* editor = split_view_ != nullptr ? split_view_->GetEditorPanel() : nullptr;
+    if (editor == nullptr || decoration_service_ == nullptr)
+    {
+        return;
+    }
+
+    // Extensions address documents by URI; untitled buffers already are one
+    std::string uri;
+    if (active_file_path_.rfind("untitled:", 0) == 0)
+    {
+        uri = active_file_path_;
+    }
+    else if (!active_file_path_.empty())
+    {
+        uri = "file://" + active_file_path_;
+    }
+    editor->SetDecorationSource(decoration_service_, std::move(uri));
+}
+
 // --- Multi-file tab management ---
 
 void LayoutManager::OpenFileInTab(const std::string& path)
@@ -2282,47 +2602,26 @@ void LayoutManager::OpenFileInTab(const std::string& path)
     }
 
     // Save current editor state before switching
-    if (!active_file_path_.empty() && split_view_ != nullptr)
-    {
-        auto buf_it = file_buffers_.find(active_file_path_);
-        if (buf_it != file_buffers_.end())
-        {
-            auto* editor = split_view_->GetEditorPanel();
-            if (editor != nullptr)
-            {
-                buf_it->second.content = editor->GetContent();
-                auto session = editor->GetSessionState();
-                buf_it->second.cursor_position = session.cursor_position;
-                buf_it->second.first_visible_line = session.first_visible_line;
-            }
-        }
-    }
+    StashActiveEditorState();
 
-    // Read file content
-    std::string content;
-    try
+    // Large files are read and handed to the editor in the background
+    std::error_code size_error;
+    const auto on_disk_size = std::filesystem::file_size(path, size_error);
+    if (!size_error && on_disk_size >= kAsyncOpenThreshold)
     {
-        std::ifstream file_stream(path);
-        if (file_stream.is_open())
-        {
-            content.assign(std::istreambuf_iterator<char>(file_stream),
-                           std::istreambuf_iterator<char>());
-        }
-        else
-        {
-            MARKAMP_LOG_ERROR("Failed to open file: {}", path);
-            return;
-        }
+        StartAsyncOpen(path);
+        return;
     }
-    catch (const std::exception& ex)
+
+    // Read file content (mapped, BOM stripped, UTF-16 / Latin-1 converted)
+    auto document = core::load_document(path);
+    if (!document)
     {
-        MARKAMP_LOG_ERROR("Error reading file {}: {}", path, ex.what());
+        MARKAMP_LOG_ERROR("Failed to open file: {}", document.error());
         return;
     }
-
     // Store in buffer
     FileBuffer buffer;
-    buffer.content = content;
     buffer.is_modified = false;
     buffer.cursor_position = 0;
     buffer.first_visible_line = 0;
@@ -2334,7 +2633,9 @@ void LayoutManager::OpenFileInTab(const std::string& path)
     {
         MARKAMP_LOG_WARN("Could not get last write time for {}: {}", path, ex.what());
     }
-    file_buffers_[path] = std::move(buffer);
+    auto& stored = file_buffers_[path];
+    stored = std::move(buffer);
+    WatchOpenFile(path);
 
     // Extract display name from path
     const std::string display_name = std::filesystem::path(path).filename().string();
@@ -2352,12 +2653,16 @@ void LayoutManager::OpenFileInTab(const std::string& path)
         auto* editor = split_view_->GetEditorPanel();
         if (editor != nullptr)
         {
-            editor->SetContent(content);
+            stored.document = editor->CreateDocument();
+            editor->ShowDocument(stored.document);
+            editor->SetContent(std::string((*document)->text()));
             editor->ClearModified();
+            RecoverEdits(path);
             // R3 Fix 9: Deferred focus so Select All works immediately
             CallAfter([editor]() { editor->SetFocus(); });
         }
     }
+    UpdateDecorationSource();
 
     // R2 Fix 13: Update status bar filename
     if (statusbar_panel_ != nullptr)
@@ -2412,7 +2717,7 @@ void LayoutManager::OpenFileInTab(const std::string& path)
         }
 
         // R4 Fix 9: Detect EOL mode from file content
-        if (content.find("\r\n") != std::string::npos)
+        if ((*document)->has_crlf)
         {
             statusbar_panel_->set_eol_mode("CRLF");
         }
@@ -2425,6 +2730,238 @@ void LayoutManager::OpenFileInTab(const std::string& path)
     MARKAMP_LOG_INFO("Opened file in tab: {}", path);
 }
 
+void LayoutManager::StashActiveEditorState()
+{
+    if (active_file_path_.empty() || split_view_ == nullptr)
+    {
+        return;
+    }
+    auto buf_it = file_buffers_.find(active_file_path_);
+    if (buf_it == file_buffers_.end())
+    {
+        return;
+    }
+    if (streaming_open_ && streaming_open_->path == active_file_path_)
+    {
+        // Partly streamed: keep the whole text rather than what is shown
+        DetachStreamingOpen();
+        return;
+    }
+    if (buf_it->second.loading)
+    {
+        return; // Still being read; the editor has none of it yet
+    }
+
+    // The text stays in the buffer's document; only the view state is kept
+    auto* editor = split_view_->GetEditorPanel();
+    if (editor != nullptr)
+    {
+        auto session = editor->GetSessionState();
+        buf_it->second.cursor_position = session.cursor_position;
+        buf_it->second.first_visible_line = session.first_visible_line;
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// Asynchronous open of large files
+// ═══════════════════════════════════════════════════════
+
+void LayoutManager::StartAsyncOpen(const std::string& path)
+{
+    FileBuffer buffer;
+    buffer.loading = true;
+    try
+    {
+        buffer.last_write_time = std::filesystem::last_write_time(path);
+    }
+    catch (const std::filesystem::filesystem_error& ex)
+    {
+        MARKAMP_LOG_WARN("Could not get last write time for {}: {}", path, ex.what());
+    }
+    auto& stored = file_buffers_[path];
+    stored = std::move(buffer);
+    WatchOpenFile(path);
+
+    const std::string display_name = std::filesystem::path(path).filename().string();
+    if (tab_bar_ != nullptr)
+    {
+        tab_bar_->AddTab(path, display_name);
+    }
+
+    active_file_path_ = path;
+    if (split_view_ != nullptr)
+    {
+        auto* editor = split_view_->GetEditorPanel();
+        if (editor != nullptr)
+        {
+            // Empty and read-only until the text arrives
+            stored.document = editor->CreateDocument();
+            editor->ShowDocument(stored.document);
+            editor->BeginStreamedContent();
+        }
+    }
+    UpdateDecorationSource();
+    if (statusbar_panel_ != nullptr)
+    {
+        statusbar_panel_->set_filename(display_name);
+        statusbar_panel_->set_progress(true, "Opening " + display_name);
+    }
+
+    // Callbacks run on the loader thread; hop to the UI thread
+    document_loaders_[path] = std::make_unique<core::DocumentLoader>(
+        path,
+        [this, path](std::shared_ptr<const core::LoadedDocument> document)
+        {
+            CallAfter([this, path, document = std::move(document)]()
+                      { OnDocumentLoaded(path, document); });
+        },
+        [this, path](std::string error)
+        {
+            CallAfter([this, path, error = std::move(error)]()
+                      { OnDocumentLoadFailed(path, error); });
+        });
+
+    MARKAMP_LOG_INFO("Opening large file in background: {}", path);
+}
+
+void LayoutManager::OnDocumentLoaded(const std::string& path,
+                                     std::shared_ptr<const core::LoadedDocument> document)
+{
+    document_loaders_.erase(path);
+    auto buf_it = file_buffers_.find(path);
+    if (buf_it == file_buffers_.end() || !buf_it->second.loading)
+    {
+        return; // Closed while loading
+    }
+
+    auto* editor = split_view_ != nullptr ? split_view_->GetEditorPanel() : nullptr;
+    if (path != active_file_path_ || editor == nullptr)
+    {
+        // In a background tab: SwitchToTab streams it in when shown
+        buf_it->second.pending_text = std::move(document);
+        buf_it->second.loading = false;
+        if (statusbar_panel_ != nullptr && !streaming_open_)
+        {
+            statusbar_panel_->set_progress(false, "");
+        }
+        return;
+    }
+
+    if (statusbar_panel_ != nullptr)
+    {
+        statusbar_panel_->set_eol_mode(document->has_crlf ? "CRLF" : "LF");
+        statusbar_panel_->set_file_size(document->file.bytes().size());
+    }
+    editor->BeginStreamedContent();
+    streaming_open_ = StreamingOpen{path, std::move(document), 0};
+    open_stream_timer_.Start(kStreamIntervalMs);
+}
+
+void LayoutManager::OnDocumentLoadFailed(const std::string& path, const std::string& error)
+{
+    document_loaders_.erase(path);
+    MARKAMP_LOG_ERROR("Failed to open file: {}", error);
+    if (statusbar_panel_ != nullptr)
+    {
+        statusbar_panel_->set_progress(false, "");
+    }
+
+    auto buf_it = file_buffers_.find(path);
+    if (buf_it != file_buffers_.end() && buf_it->second.loading)
+    {
+        buf_it->second.loading = false;
+        CloseTab(path);
+    }
+}
+
+void LayoutManager::OnOpenStreamTimer(wxTimerEvent& /*event*/)
+{
+    auto* editor = split_view_ != nullptr ? split_view_->GetEditorPanel() : nullptr;
+    if (!streaming_open_ || editor == nullptr || streaming_open_->path != active_file_path_)
+    {
+        DetachStreamingOpen();
+        return;
+    }
+
+    // Append whole chunks until this tick's budget is spent
+    const auto text = streaming_open_->document->text();
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(kStreamFrameBudgetMs);
+    auto& offset = streaming_open_->offset;
+    do
+    {
+        const auto end = core::next_text_chunk_end(text, offset, kStreamChunkBytes);
+        editor->AppendStreamedContent(text.substr(offset, end - offset));
+        offset = end;
+    } while (offset < text.size() && std::chrono::steady_clock::now() < deadline);
+
+    if (offset < text.size())
+    {
+        if (statusbar_panel_ != nullptr)
+        {
+            const auto percent = offset * 100 / text.size();
+            statusbar_panel_->set_progress(
+                true,
+                "Opening " + std::filesystem::path(streaming_open_->path).filename().string() +
+                    " " + std::to_string(percent) + "%");
+        }
+        return;
+    }
+    FinishStreamingOpen();
+}
+
+void LayoutManager::FinishStreamingOpen()
+{
+    open_stream_timer_.Stop();
+    if (!streaming_open_)
+    {
+        return;
+    }
+
+    auto* editor = split_view_ != nullptr ? split_view_->GetEditorPanel() : nullptr;
+    if (editor != nullptr)
+    {
+        editor->EndStreamedContent();
+        editor->ClearModified();
+        CallAfter([editor]() { editor->SetFocus(); });
+    }
+    auto buf_it = file_buffers_.find(streaming_open_->path);
+    if (buf_it != file_buffers_.end())
+    {
+        buf_it->second.loading = false;
+    }
+    if (statusbar_panel_ != nullptr)
+    {
+        statusbar_panel_->set_progress(false, "");
+    }
+    MARKAMP_LOG_INFO("Opened file in tab: {}", streaming_open_->path);
+    const auto opened_path = std::move(streaming_open_->path);
+    streaming_open_.reset();
+    RecoverEdits(opened_path);
+}
+
+void LayoutManager::DetachStreamingOpen()
+{
+    open_stream_timer_.Stop();
+    if (!streaming_open_)
+    {
+        return;
+    }
+
+    // Leaving the tab mid-stream: streamed again from the start when shown
+    auto buf_it = file_buffers_.find(streaming_open_->path);
+    if (buf_it != file_buffers_.end())
+    {
+        buf_it->second.pending_text = std::move(streaming_open_->document);
+        buf_it->second.loading = false;
+    }
+    if (statusbar_panel_ != nullptr)
+    {
+        statusbar_panel_->set_progress(false, "");
+    }
+    streaming_open_.reset();
+}
+
 void LayoutManager::CloseTab(const std::string& path)
 {
     const auto buf_it = file_buffers_.find(path);
@@ -2457,9 +2994,18 @@ void LayoutManager::CloseTab(const std::string& path)
             SaveFile(path);
         }
     }
+    edit_journal_.discard(path);
+
+    // Stop any background open of this file
+    document_loaders_.erase(path);
+    if (streaming_open_ && streaming_open_->path == path)
+    {
+        DetachStreamingOpen();
+    }
 
     // Remove from buffer
     file_buffers_.erase(buf_it);
+    open_file_watches_.erase(path);
 
     // Remove tab (TabBar handles activating adjacent tab)
     if (tab_bar_ != nullptr)
@@ -2490,9 +3036,9 @@ void LayoutManager::CloseTab(const std::string& path)
             auto* editor = split_view_->GetEditorPanel();
             if (editor != nullptr)
             {
-                editor->SetContent("");
-                editor->ClearModified();
+                editor->ShowDocument(editor->CreateDocument());
             }
+            UpdateDecorationSource();
 
             // R2 Fix 12: Return to startup screen when all tabs close
             core::events::ShowStartupRequestEvent startup_evt;
@@ -2511,21 +3057,7 @@ void LayoutManager::SwitchToTab(const std::string& path)
     }
 
     // Save current editor state
-    if (!active_file_path_.empty() && split_view_ != nullptr)
-    {
-        auto buf_it = file_buffers_.find(active_file_path_);
-        if (buf_it != file_buffers_.end())
-        {
-            auto* editor = split_view_->GetEditorPanel();
-            if (editor != nullptr)
-            {
-                buf_it->second.content = editor->GetContent();
-                auto session = editor->GetSessionState();
-                buf_it->second.cursor_position = session.cursor_position;
-                buf_it->second.first_visible_line = session.first_visible_line;
-            }
-        }
-    }
+    StashActiveEditorState();
 
     // Load target file from buffer
     const auto buf_it = file_buffers_.find(path);
@@ -2547,23 +3079,42 @@ void LayoutManager::SwitchToTab(const std::string& path)
     if (split_view_ != nullptr)
     {
         auto* editor = split_view_->GetEditorPanel();
+        auto& buffer = buf_it->second;
+        if (editor != nullptr && !buffer.document)
+        {
+            buffer.document = editor->CreateDocument();
+        }
         if (editor != nullptr)
         {
-            editor->SetContent(buf_it->second.content);
+            // O(1): the document keeps its text, undo history and styling
+            editor->ShowDocument(buffer.document);
+        }
+
+        if (editor != nullptr && buffer.loading)
+        {
+            // Still being read; OnDocumentLoaded streams it in
+            editor->BeginStreamedContent();
+        }
+        else if (editor != nullptr && buffer.pending_text)
+        {
+            // Read in the background, or left mid-stream
+            editor->BeginStreamedContent();
+            streaming_open_ = StreamingOpen{path, std::move(buffer.pending_text), 0};
+            buffer.loading = true;
+            open_stream_timer_.Start(kStreamIntervalMs);
+        }
+        else if (editor != nullptr)
+        {
             EditorPanel::SessionState restore_state;
-            restore_state.cursor_position = buf_it->second.cursor_position;
-            restore_state.first_visible_line = buf_it->second.first_visible_line;
+            restore_state.cursor_position = buffer.cursor_position;
+            restore_state.first_visible_line = buffer.first_visible_line;
             editor->RestoreSessionState(restore_state);
 
-            if (!buf_it->second.is_modified)
-            {
-                editor->ClearModified();
-            }
-
             // R3 Fix 9: Deferred focus on tab switch
             CallAfter([editor]() { editor->SetFocus(); });
         }
     }
+    UpdateDecorationSource();
 
     // Fix 7: Sync file tree selection with active tab
     // R4 Fix 12: Auto-reveal file in sidebar
@@ -2573,6 +3124,12 @@ void LayoutManager::SwitchToTab(const std::string& path)
         file_tree_->EnsureNodeVisible(path);
     }
 
+    // Written on disk while in the background: offer a reload once shown
+    if (buf_it->second.changed_on_disk)
+    {
+        CallAfter([this]() { CheckExternalFileChanges(); });
+    }
+
     // R3 Fix 14: Update breadcrumb bar with file path segments
     // R4 Fix 19: Handle Untitled files in breadcrumb
     if (breadcrumb_bar_ != nullptr)
@@ -2604,7 +3161,17 @@ void LayoutManager::SwitchToTab(const std::string& path)
 
     // Fix 13: Publish content changed event to refresh preview panel
     core::events::EditorContentChangedEvent content_evt;
-    content_evt.content = buf_it->second.content;
+    content_evt.full_replace = true;
+    auto* switched_editor = split_view_ != nullptr ? split_view_->GetEditorPanel() : nullptr;
+    if (switched_editor != nullptr)
+    {
+        content_evt.version = switched_editor->GetDocumentVersion();
+        content_evt.snapshot = switched_editor->GetContentSnapshot();
+    }
+    else
+    {
+        content_evt.snapshot = core::LazyDocumentSnapshot::from_content(content_evt.version, {});
+    }
     event_bus_.publish(content_evt);
 
     // Fix 16: Update status bar cursor position on tab switch
@@ -2725,8 +3292,17 @@ void LayoutManager::SaveActiveFileAs()
         {
             FileBuffer new_buf = std::move(buf_it->second);
             new_buf.is_modified = false;
+            std::error_code time_error;
+            const auto written = std::filesystem::last_write_time(new_path, time_error);
+            if (!time_error)
+            {
+                new_buf.last_write_time = written;
+            }
             file_buffers_.erase(buf_it);
             file_buffers_[new_path] = std::move(new_buf);
+            edit_journal_.discard(active_file_path_);
+            open_file_watches_.erase(active_file_path_);
+            WatchOpenFile(new_path);
         }
 
         // Update tab
@@ -2738,6 +3314,7 @@ void LayoutManager::SaveActiveFileAs()
         }
 
         active_file_path_ = new_path;
+        UpdateDecorationSource();
     }
 }
 
@@ -2781,25 +3358,113 @@ void LayoutManager::StopAutoSave()
 
 void LayoutManager::OnAutoSaveTimer(wxTimerEvent& /*event*/)
 {
+    auto* editor = split_view_ != nullptr ? split_view_->GetEditorPanel() : nullptr;
+    if (editor == nullptr)
+    {
+        return;
+    }
+    // Edits are journaled as they happen; rewrite the journals that have
+    // logged more than their document holds as one checkpoint each
     for (auto& [path, buffer] : file_buffers_)
     {
-        if (buffer.is_modified)
+        if (buffer.document && !buffer.loading && edit_journal_.needs_checkpoint(path))
         {
-            const std::string draft_path = path + ".markamp-draft";
-            try
-            {
-                std::ofstream draft(draft_path);
-                if (draft.is_open())
-                {
-                    draft << buffer.content;
-                    MARKAMP_LOG_DEBUG("Auto-saved draft: {}", draft_path);
-                }
-            }
-            catch (const std::exception& ex)
+            edit_journal_.checkpoint(path,
+                                     std::make_shared<const std::string>(
+                                         editor->GetDocumentText(buffer.document)));
+            MARKAMP_LOG_DEBUG("Compacted edit journal: {}", path);
+        }
+    }
+}
+
+void LayoutManager::JournalEdit(std::uint64_t version, const core::TextDelta& delta)
+{
+    const auto buf_it = file_buffers_.find(active_file_path_);
+    if (buf_it == file_buffers_.end() || buf_it->second.loading ||
+        active_file_path_.rfind("untitled:", 0) == 0)
+    {
+        return;
+    }
+
+    if (!edit_journal_.is_open(active_file_path_))
+    {
+        // The first edit since the file was opened or saved applies to the
+        // file on disk, unless someone else has rewritten it since
+        const auto base = core::JournalBase::of(active_file_path_);
+        if (!base ||
+            base->mtime != buf_it->second.last_write_time.time_since_epoch().count())
+        {
+            auto* editor = split_view_ != nullptr ? split_view_->GetEditorPanel() : nullptr;
+            if (editor != nullptr)
             {
-                MARKAMP_LOG_WARN("Auto-save failed for {}: {}", path, ex.what());
+                edit_journal_.checkpoint(
+                    active_file_path_,
+                    std::make_shared<const std::string>(editor->GetContent()));
             }
+            return; // This edit is in the checkpoint
         }
+        edit_journal_.start(active_file_path_, *base);
+    }
+    edit_journal_.append(active_file_path_, version, delta);
+}
+
+void LayoutManager::RecoverEdits(const std::string& path)
+{
+    std::error_code exists_error;
+    if (!std::filesystem::exists(core::EditJournal::journal_path(path), exists_error))
+    {
+        return;
+    }
+    auto* editor = split_view_ != nullptr ? split_view_->GetEditorPanel() : nullptr;
+    const auto buf_it = file_buffers_.find(path);
+    if (editor == nullptr || buf_it == file_buffers_.end())
+    {
+        return;
+    }
+
+    // Left behind by a crash, or by quitting without saving or discarding
+    auto recovered = core::EditJournal::recover(path);
+    if (!recovered)
+    {
+        MARKAMP_LOG_WARN("Cannot recover unsaved edits: {}", recovered.error());
+        edit_journal_.discard(path);
+        return;
+    }
+    if (recovered->text == editor->GetTextView().text())
+    {
+        edit_journal_.discard(path);
+        return;
+    }
+
+    const std::string display_name = std::filesystem::path(path).filename().string();
+    const int result = wxMessageBox(
+        wxString::Format("'%s' has unsaved changes from a previous session. Recover them?",
+                         display_name),
+        "Recover Unsaved Changes",
+        wxYES_NO | wxICON_QUESTION,
+        this);
+    if (result != wxYES)
+    {
+        edit_journal_.discard(path);
+        return;
+    }
+
+    auto text = std::make_shared<const std::string>(std::move(recovered->text));
+    editor->SetContent(*text);
+    edit_journal_.checkpoint(path, std::move(text));
+    buf_it->second.is_modified = true;
+    if (tab_bar_ != nullptr)
+    {
+        tab_bar_->SetTabModified(path, true);
+    }
+    MARKAMP_LOG_INFO("Recovered {} unsaved edits to {}", recovered->edits, path);
+}
+
+void LayoutManager::DiscardEditJournals()
+{
+    for (const auto& [path, buffer] : file_buffers_)
+    {
+        edit_journal_.discard(path);
     }
 }
 
@@ -2813,10 +3478,11 @@ void LayoutManager::CheckExternalFileChanges()
     }
 
     auto buf_it = file_buffers_.find(active_file_path_);
-    if (buf_it == file_buffers_.end())
+    if (buf_it == file_buffers_.end() || buf_it->second.loading)
     {
         return;
     }
+    buf_it->second.changed_on_disk = false;
 
     try
     {
@@ -2840,7 +3506,6 @@ void LayoutManager::CheckExternalFileChanges()
                     std::string content((std::istreambuf_iterator<char>(file_stream)),
                                         std::istreambuf_iterator<char>());
 
-                    buf_it->second.content = content;
                     buf_it->second.is_modified = false;
                     buf_it->second.last_write_time = current_write_time;
 
@@ -2913,7 +3578,7 @@ void LayoutManager::RevertActiveFile()
     }
 
     auto buf_it = file_buffers_.find(active_file_path_);
-    if (buf_it == file_buffers_.end())
+    if (buf_it == file_buffers_.end() || buf_it->second.loading)
     {
         return;
     }
@@ -2930,8 +3595,8 @@ void LayoutManager::RevertActiveFile()
         content.assign(std::istreambuf_iterator<char>(file_stream),
                        std::istreambuf_iterator<char>());
 
-        buf_it->second.content = content;
         buf_it->second.is_modified = false;
+        edit_journal_.discard(active_file_path_);
 
         // Reload into editor
         if (split_view_ != nullptr)
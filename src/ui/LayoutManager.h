@@ -1,9 +1,16 @@
 #pragma once
 
+#include "EditorDocument.h"
 #include "ThemeAwareWindow.h"
+#include "core/DocumentLoader.h"
+#include "core/DocumentSnapshot.h"
+#include "core/EditJournal.h"
 #include "core/EventBus.h"
 #include "core/FileNode.h"
+#include "core/FileWatcher.h"
 #include "core/ThemeEngine.h"
+#include "core/WorkspaceScanner.h"
+#include "core/WorkspaceSearchService.h"
 
 #include <wx/notebook.h>
 #include <wx/sizer.h>
@@ -12,15 +19,22 @@
 #include <wx/textctrl.h>
 #include <wx/timer.h>
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace markamp::core
 {
 class Config;
+class DecorationService;
 class FeatureRegistry;
+class GrammarEngine;
 class IMermaidRenderer;
 class IMathRenderer;
 } // namespace markamp::core
@@ -78,6 +92,8 @@ public:
     // Data
     void setFileTree(const std::vector<core::FileNode>& roots);
     void SetWorkspaceRoot(const std::string& root_path);
+    /// Show `root_path` in the file tree, scanning it in the background
+    void OpenWorkspaceFolder(const std::string& root_path);
     void SaveFile(const std::string& path);
 
     // Multi-file tab management (QoL features 1-5)
@@ -97,11 +113,15 @@ public:
     void RevertActiveFile();
     void CloseAllTabs();
 
+    // Unsaved edits were abandoned on purpose: nothing to recover next time
+    void DiscardEditJournals();
+
     // Auto-save (feature 12)
     void StartAutoSave();
     void StopAutoSave();
 
-    // File reload (feature 13)
+    // File reload (feature 13); run when the file watcher reports the
+    // active file changed, or on switching to a tab changed in the background
     void CheckExternalFileChanges();
 
     // Sidebar control
@@ -121,6 +141,9 @@ public:
     [[nodiscard]] auto GetSidebarMode() const -> SidebarMode;
     void SetExtensionServices(core::IExtensionManagementService* mgmt_service,
                               core::IExtensionGalleryService* gallery_service);
+    void SetGrammarEngine(const core::GrammarEngine* grammars);
+    /// Show `decorations` for the active file in the editor (nullptr detaches).
+    void SetDecorationService(core::DecorationService* decorations);
 
     static constexpr int kDefaultSidebarWidth = 256;
     static constexpr int kMinSidebarWidth = 180;
@@ -207,21 +230,59 @@ private:
     // Multi-file state
     struct FileBuffer
     {
-        std::string content;
+        // Text, undo history and styling; shown by pointer swap on tab switch
+        EditorDocument document;
+        // Read but not (fully) in `document` yet; streamed in when shown
+        std::shared_ptr<const core::LoadedDocument> pending_text;
         bool is_modified{false};
         int cursor_position{0};
         int first_visible_line{0};
         std::filesystem::file_time_type last_write_time{};
+        // Opened asynchronously and not read yet, or being streamed into `document`
+        bool loading{false};
+        // Written by someone else while in a background tab; checked on switch
+        bool changed_on_disk{false};
     };
     std::unordered_map<std::string, FileBuffer> file_buffers_;
     std::string active_file_path_;
 
+    void StashActiveEditorState();
+
+    // Extension decorations follow the active file (not owned)
+    core::DecorationService* decoration_service_{nullptr};
+    void UpdateDecorationSource();
+
+    // Large files are read off the UI thread and appended to the editor a
+    // few chunks per timer tick, so opening one never blocks a frame
+    static constexpr std::uintmax_t kAsyncOpenThreshold =
+        static_cast<std::uintmax_t>(4) * 1024 * 1024;
+    static constexpr std::size_t kStreamChunkBytes = static_cast<std::size_t>(256) * 1024;
+    static constexpr int kStreamFrameBudgetMs = 8;
+    static constexpr int kStreamIntervalMs = 16;
+    struct StreamingOpen
+    {
+        std::string path;
+        std::shared_ptr<const core::LoadedDocument> document;
+        std::size_t offset{0};
+    };
+    std::optional<StreamingOpen> streaming_open_;
+    std::unordered_map<std::string, std::unique_ptr<core::DocumentLoader>> document_loaders_;
+    wxTimer open_stream_timer_;
+    void StartAsyncOpen(const std::string& path);
+    void OnDocumentLoaded(const std::string& path,
+                          std::shared_ptr<const core::LoadedDocument> document);
+    void OnDocumentLoadFailed(const std::string& path, const std::string& error);
+    void OnOpenStreamTimer(wxTimerEvent& event);
+    void FinishStreamingOpen();
+    void DetachStreamingOpen();
+
     // Event subscriptions for tabs
     core::Subscription tab_switched_sub_;
     core::Subscription tab_close_sub_;
     core::Subscription tab_save_sub_;
     core::Subscription tab_save_as_sub_;
     core::Subscription content_changed_sub_;
+    core::Subscription text_edited_sub_;
     core::Subscription file_reload_sub_;
     core::Subscription goto_line_sub_;
 
@@ -350,13 +411,44 @@ private:
     core::Subscription convert_eol_crlf_sub_;
     // R14: workspace_refresh and open_folder handled in MainFrame
 
-    // Auto-save
+    // Auto-save: every edit to a file is appended to its crash journal as
+    // it happens; the timer only compacts journals that outgrew their file
+    core::EditJournal edit_journal_;
     wxTimer auto_save_timer_;
     static constexpr int kAutoSaveIntervalMs = 30000; // 30 seconds
     void OnAutoSaveTimer(wxTimerEvent& event);
+    void JournalEdit(std::uint64_t version, const core::TextDelta& delta);
+    void RecoverEdits(const std::string& path);
 
     // Sidebar custom painting
     void OnSidebarPaint(wxPaintEvent& event);
+
+    // Watches on the workspace and on the folders of open files. Changes
+    // arrive batched on the bus, so the tree and tabs update incrementally
+    // and nothing polls the disk while idle.
+    std::unique_ptr<core::FileWatcherService> file_watcher_;
+    core::Subscription workspace_watch_;
+    std::unordered_map<std::string, core::Subscription> open_file_watches_;
+    core::Subscription file_changes_sub_;
+    void EnsureFileWatcher();
+    void WatchOpenFile(const std::string& path);
+    void OnFileSystemChanged(const std::vector<core::FileChange>& changes);
+
+    // Full-text index of the workspace, persisted under the config cache
+    // and kept current from the watcher's batches on its own thread
+    std::unique_ptr<core::WorkspaceSearchService> workspace_search_;
+
+    // Workspace scan; listings reach the file tree in batches via CallAfter.
+    // Declared last so it stops (and stops calling back) before anything else
+    // is destroyed.
+    uint64_t workspace_scan_generation_{0};
+    std::size_t scanned_files_{0};
+    std::size_t scanned_folders_{0};
+    // Entries each listed folder contributed, so a re-list is not counted twice
+    std::unordered_map<std::string, std::pair<std::size_t, std::size_t>> listed_counts_;
+    void OnWorkspaceListings(uint64_t generation, std::vector<core::DirectoryListing> listings);
+    void UpdateFileCountLabel(bool scanning);
+    std::unique_ptr<core::WorkspaceScanner> workspace_scanner_;
 };
 
 } // namespace markamp::ui
@@ -263,6 +263,22 @@ MainFrame::MainFrame(const wxString& title,
     MARKAMP_LOG_INFO("MainFrame created: {}x{} (frameless)", size.GetWidth(), size.GetHeight());
 }
 
+void MainFrame::SetGrammarEngine(const markamp::core::GrammarEngine* grammars)
+{
+    if (layout_ != nullptr)
+    {
+        layout_->SetGrammarEngine(grammars);
+    }
+}
+
+void MainFrame::SetDecorationService(markamp::core::DecorationService* decorations)
+{
+    if (layout_ != nullptr)
+    {
+        layout_->SetDecorationService(decorations);
+    }
+}
+
 void MainFrame::onClose(wxCloseEvent& event)
 {
     MARKAMP_LOG_INFO("MainFrame closing.");
@@ -284,7 +300,11 @@ void MainFrame::onClose(wxCloseEvent& event)
         {
             layout_->SaveActiveFile();
         }
-        // wxNO = discard and close
+        else
+        {
+            // wxNO = discard and close
+            layout_->DiscardEditJournals();
+        }
     }
 
     // Save keybindings before closing
@@ -1560,11 +1580,9 @@ void MainFrame::createMenuBar()
                 else
                 {
                     // Direct open
-                    std::vector<core::FileNode> nodes;
-                    scanDirectory(evt.path, nodes);
                     if (layout_ != nullptr)
                     {
-                        layout_->setFileTree(nodes);
+                        layout_->OpenWorkspaceFolder(evt.path);
                         showEditor();
                         // Add to recent workspaces
                         if (recent_workspaces_ != nullptr)
@@ -1578,11 +1596,9 @@ void MainFrame::createMenuBar()
         subscriptions_.push_back(event_bus_->subscribe<core::events::WorkspaceOpenRequestEvent>(
             [this](const core::events::WorkspaceOpenRequestEvent& evt)
             {
-                std::vector<core::FileNode> nodes;
-                scanDirectory(evt.path, nodes);
                 if (layout_ != nullptr)
                 {
-                    layout_->setFileTree(nodes);
+                    layout_->OpenWorkspaceFolder(evt.path);
                     showEditor();
                     // Add/Bump in recent workspaces
                     if (recent_workspaces_ != nullptr)
@@ -1626,14 +1642,10 @@ void MainFrame::onOpenFolder(wxCommandEvent& /*event*/)
     wxString path = dlg.GetPath();
     MARKAMP_LOG_INFO("Opening folder: {}", path.ToStdString());
 
-    std::vector<core::FileNode> nodes;
-    scanDirectory(path.ToStdString(), nodes);
-
     if (layout_ != nullptr)
     {
-        layout_->setFileTree(nodes);
-        // Fix 15: Set workspace root for relative path computation
-        layout_->SetWorkspaceRoot(path.ToStdString());
+        // Fix 15: Also sets the workspace root for relative path computation
+        layout_->OpenWorkspaceFolder(path.ToStdString());
         showEditor();
 
         // R3 Fix 12: Store workspace folder name for window title
@@ -1647,76 +1659,6 @@ void MainFrame::onOpenFolder(wxCommandEvent& /*event*/)
     }
 }
 
-void MainFrame::scanDirectory(const std::string& path, std::vector<core::FileNode>& out_nodes)
-{
-    namespace fs = std::filesystem;
-
-    try
-    {
-        if (!fs::exists(path) || !fs::is_directory(path))
-        {
-            return;
-        }
-
-        // Separate folders and files for sorting
-        std::vector<core::FileNode> folders;
-        std::vector<core::FileNode> files;
-
-        for (const auto& entry : fs::directory_iterator(path))
-        {
-            const auto& p = entry.path();
-            std::string name = p.filename().string();
-
-            // Skip hidden files/folders (starting with dot)
-            if (name.empty() || name[0] == '.')
-            {
-                continue;
-            }
-
-            core::FileNode node;
-            node.id = p.string();
-            node.name = name;
-            node.is_open = false; // Collapsed by default
-
-            if (entry.is_directory())
-            {
-                node.type = core::FileNodeType::Folder;
-                // Recursively scan directories
-                scanDirectory(p.string(), node.children);
-                folders.push_back(node);
-            }
-            else if (entry.is_regular_file())
-            {
-                node.type = core::FileNodeType::File;
-                files.push_back(node);
-            }
-        }
-
-        // Sort: folders first, then files, both alphabetically
-        auto sort_func = [](const core::FileNode& a, const core::FileNode& b)
-        {
-            // Case-insensitive sort
-            std::string sa = a.name;
-            std::string sb = b.name;
-            std::transform(sa.begin(), sa.end(), sa.begin(), ::tolower);
-            std::transform(sb.begin(), sb.end(), sb.begin(), ::tolower);
-            return sa < sb;
-        };
-
-        std::sort(folders.begin(), folders.end(), sort_func);
-        std::sort(files.begin(), files.end(), sort_func);
-
-        // Merge
-        out_nodes.reserve(out_nodes.size() + folders.size() + files.size());
-        out_nodes.insert(out_nodes.end(), folders.begin(), folders.end());
-        out_nodes.insert(out_nodes.end(), files.begin(), files.end());
-    }
-    catch (const std::exception& e)
-    {
-        MARKAMP_LOG_ERROR("Failed to scan directory {}: {}", path, e.what());
-    }
-}
-
 void MainFrame::showStartupScreen()
 {
     if (layout_ != nullptr)
@@ -19,7 +19,9 @@ class IMermaidRenderer;
 class IMathRenderer;
 class ThemeEngine;
 class RecentWorkspaces;
+class DecorationService;
 class FeatureRegistry;
+class GrammarEngine;
 } // namespace markamp::core
 
 namespace markamp::ui
@@ -45,6 +47,12 @@ public:
               markamp::core::IMermaidRenderer* mermaid_renderer = nullptr,
               markamp::core::IMathRenderer* math_renderer = nullptr);
 
+    /// Hand the extension grammars to the editor once plugins are active.
+    void SetGrammarEngine(const markamp::core::GrammarEngine* grammars);
+
+    /// Hand the extension decoration service to the editor once plugins are active.
+    void SetDecorationService(markamp::core::DecorationService* decorations);
+
 private:
     // Core references (owned by MarkAmpApp)
     markamp::core::EventBus* event_bus_;
@@ -82,7 +90,6 @@ private:
 
     // Opening folder
     void onOpenFolder(wxCommandEvent& event);
-    void scanDirectory(const std::string& path, std::vector<core::FileNode>& out_nodes);
 
     // DPI reporting
     void logDpiInfo();
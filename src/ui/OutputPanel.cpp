@@ -18,7 +18,9 @@ OutputPanel::OutputPanel()
 OutputPanel::OutputPanel(wxWindow* parent, core::OutputChannelService* service)
     : wxPanel(parent, wxID_ANY)
     , service_(service)
+    , flush_timer_(this)
 {
+    Bind(wxEVT_TIMER, &OutputPanel::OnFlushTimer, this, flush_timer_.GetId());
     CreateLayout();
     if (service_ != nullptr)
     {
@@ -31,6 +33,12 @@ OutputPanel::OutputPanel(wxWindow* parent, core::OutputChannelService* service)
     RefreshContent();
 }
 
+OutputPanel::~OutputPanel()
+{
+    Unsubscribe();
+    flush_timer_.Stop();
+}
+
 void OutputPanel::CreateLayout()
 {
     auto* sizer = new wxBoxSizer(wxVERTICAL);
@@ -111,8 +119,97 @@ void OutputPanel::RefreshContent()
         }
     }
 
-    // Update text content
-    text_area_->SetValue(wxString(active_content()));
+    // Reload the text from the start of what the channel retains
+    Subscribe();
+    text_area_->Clear();
+    cursor_ = {};
+    FlushOutput();
+}
+
+void OutputPanel::Subscribe()
+{
+    if (text_area_ == nullptr || subscribed_channel_ == active_channel_)
+    {
+        return;
+    }
+    Unsubscribe();
+
+    auto* channel = service_ != nullptr && !active_channel_.empty()
+                        ? service_->get_channel(active_channel_)
+                        : nullptr;
+    if (channel == nullptr)
+    {
+        return;
+    }
+    listener_id_ =
+        channel->on_change([this](const core::OutputChannel& /*channel*/,
+                                  const core::OutputChange& /*change*/) { OnChannelOutput(); });
+    subscribed_channel_ = active_channel_;
+}
+
+void OutputPanel::Unsubscribe()
+{
+    if (subscribed_channel_.empty())
+    {
+        return;
+    }
+    // The channel may have been removed from the service meanwhile
+    if (auto* channel = service_ != nullptr ? service_->get_channel(subscribed_channel_) : nullptr)
+    {
+        channel->remove_content_listener(listener_id_);
+    }
+    subscribed_channel_.clear();
+}
+
+void OutputPanel::OnChannelOutput()
+{
+    // Only the first notification of a frame schedules work; the rest are
+    // picked up by the same flush
+    if (flush_pending_.exchange(true))
+    {
+        return;
+    }
+    CallAfter(
+        [this]()
+        {
+            if (!flush_timer_.IsRunning())
+            {
+                flush_timer_.StartOnce(kFlushIntervalMs);
+            }
+        });
+}
+
+void OutputPanel::OnFlushTimer(wxTimerEvent& /*event*/)
+{
+    FlushOutput();
+}
+
+void OutputPanel::FlushOutput()
+{
+    flush_pending_ = false;
+    if (text_area_ == nullptr || service_ == nullptr || active_channel_.empty())
+    {
+        return;
+    }
+    auto* channel = service_->get_channel(active_channel_);
+    if (channel == nullptr)
+    {
+        return;
+    }
+
+    auto delta = channel->read_since(cursor_);
+    if (delta.reset)
+    {
+        text_area_->SetValue(wxString::FromUTF8(delta.text));
+    }
+    else if (!delta.text.empty())
+    {
+        text_area_->AppendText(wxString::FromUTF8(delta.text));
+    }
+    else
+    {
+        return;
+    }
 
     if (auto_scroll_)
     {
@@ -135,6 +232,7 @@ void OutputPanel::ApplyTheme(const wxColour& bg_colour, const wxColour& fg_colou
 
 void OutputPanel::set_service(core::OutputChannelService* service)
 {
+    Unsubscribe();
     service_ = service;
     if (service_ != nullptr)
     {
@@ -144,6 +242,10 @@ void OutputPanel::set_service(core::OutputChannelService* service)
             active_channel_ = names.front();
         }
     }
+    if (text_area_ != nullptr)
+    {
+        RefreshContent();
+    }
 }
 
 auto OutputPanel::active_channel() const -> const std::string&
@@ -154,6 +256,10 @@ auto OutputPanel::active_channel() const -> const std::string&
 void OutputPanel::set_active_channel(const std::string& channel_name)
 {
     active_channel_ = channel_name;
+    if (text_area_ != nullptr)
+    {
+        RefreshContent();
+    }
 }
 
 auto OutputPanel::channel_names() const -> std::vector<std::string>
@@ -5,7 +5,10 @@
 #include <wx/choice.h>
 #include <wx/panel.h>
 #include <wx/textctrl.h>
+#include <wx/timer.h>
 
+#include <atomic>
+#include <cstddef>
 #include <functional>
 #include <string>
 #include <vector>
@@ -19,6 +22,11 @@ namespace markamp::ui
 ///
 /// Dual-purpose: default constructor for unit-test data-only mode;
 /// wxWindow* constructor for real UI rendering.
+///
+/// The text view follows the active channel incrementally: change
+/// notifications only mark the panel dirty, and at most once per frame it
+/// appends what was written since its OutputCursor. It reloads the view
+/// only when the channel trimmed or cleared text it was showing.
 class OutputPanel : public wxPanel
 {
 public:
@@ -27,6 +35,15 @@ public:
 
     /// UI constructor with rendering support.
     OutputPanel(wxWindow* parent, core::OutputChannelService* service);
+    ~OutputPanel() override;
+
+    OutputPanel(const OutputPanel&) = delete;
+    auto operator=(const OutputPanel&) -> OutputPanel& = delete;
+    OutputPanel(OutputPanel&&) = delete;
+    auto operator=(OutputPanel&&) -> OutputPanel& = delete;
+
+    /// Longest wait between an append and its appearance in the view.
+    static constexpr int kFlushIntervalMs = 16;
 
     /// Set the output channel service to read from.
     void set_service(core::OutputChannelService* service);
@@ -66,6 +83,17 @@ private:
     void CreateLayout();
     void OnChannelChanged(wxCommandEvent& event);
 
+    /// Listen to the active channel (UI mode only), dropping the old listener.
+    void Subscribe();
+    void Unsubscribe();
+
+    /// Called from the appending thread: schedule one flush per frame.
+    void OnChannelOutput();
+    void OnFlushTimer(wxTimerEvent& event);
+
+    /// Append what the active channel gained since the last flush.
+    void FlushOutput();
+
     core::OutputChannelService* service_{nullptr};
     std::string active_channel_;
     bool auto_scroll_{true};
@@ -73,6 +101,13 @@ private:
     // UI controls (null in data-only / test mode)
     wxChoice* channel_selector_{nullptr};
     wxTextCtrl* text_area_{nullptr};
+
+    // Incremental rendering of the active channel
+    wxTimer flush_timer_;
+    core::OutputCursor cursor_;
+    std::string subscribed_channel_;
+    std::size_t listener_id_{0};
+    std::atomic<bool> flush_pending_{false};
 };
 
 } // namespace markamp::ui
@@ -4,19 +4,61 @@
 #include "core/Config.h"
 #include "core/Events.h"
 #include "core/IMermaidRenderer.h"
+#include "core/MarkdownParser.h"
 #include "core/Profiler.h"
 #include "rendering/HtmlRenderer.h"
 
 #include <wx/clipbrd.h>
+#include <wx/image.h>
+#include <wx/log.h>
+#include <wx/mstream.h>
 #include <wx/sizer.h>
 
+#include <algorithm>
 #include <fmt/format.h>
 #include <fstream>
+#include <iterator>
+#include <optional>
 #include <spdlog/spdlog.h>
+#include <string_view>
 
 namespace markamp::ui
 {
 
+namespace
+{
+
+/// rendering::ImageScaler backed by wxImage (safe off the UI thread; the
+/// image handlers are registered by MainFrame before any preview exists).
+auto scale_image_with_wx(const std::filesystem::path& source,
+                         int max_width,
+                         std::string_view mime) -> std::optional<std::string>
+{
+    wxLogNull suppress_decode_errors;
+    wxImage image;
+    if (!image.LoadFile(wxString::FromUTF8(source.string())) || !image.IsOk() ||
+        image.GetWidth() <= max_width)
+    {
+        return std::nullopt;
+    }
+
+    const auto height = static_cast<int>(static_cast<long long>(image.GetHeight()) * max_width /
+                                         image.GetWidth());
+    image.Rescale(max_width, std::max(height, 1), wxIMAGE_QUALITY_HIGH);
+
+    const auto type = mime == "image/jpeg" ? wxBITMAP_TYPE_JPEG : wxBITMAP_TYPE_PNG;
+    wxMemoryOutputStream stream;
+    if (!image.SaveFile(stream, type))
+    {
+        return std::nullopt;
+    }
+    std::string bytes(stream.GetLength(), '\0');
+    stream.CopyTo(bytes.data(), bytes.size());
+    return bytes;
+}
+
+} // namespace
+
 // ═══════════════════════════════════════════════════════
 // Construction
 // ═══════════════════════════════════════════════════════
@@ -39,8 +81,29 @@ PreviewPanel::PreviewPanel(wxWindow* parent,
     if (config)
     {
         render_debounce_ms_ = config->get_int("preview.render_debounce_ms", 300);
+        render_settings_.incremental = config->get_bool("preview.incremental_render", true);
     }
 
+    // Image data URIs are cached across renders; downscaled variants of large
+    // images are produced off-thread and kept next to the config
+    image_cache_ = std::make_unique<rendering::ImageCache>(
+        core::Config::config_directory() / "cache" / "images", &scale_image_with_wx);
+    image_cache_->set_ready_callback(
+        [this]() { CallAfter(&PreviewPanel::OnDeferredContentReady); });
+    if (mermaid_renderer_ != nullptr)
+    {
+        mermaid_listener_ = mermaid_renderer_->add_ready_listener(
+            [this]() { CallAfter(&PreviewPanel::OnDeferredContentReady); });
+    }
+
+    // Background render worker; results are marshalled back with CallAfter
+    render_settings_.mermaid_renderer = mermaid_renderer_;
+    render_settings_.math_renderer = math_renderer_;
+    render_settings_.image_cache = image_cache_.get();
+    render_pipeline_ = std::make_unique<rendering::PreviewPipeline>(
+        [this]() { CallAfter(&PreviewPanel::OnRenderResultReady); });
+    render_pipeline_->set_settings(render_settings_);
+
     // Layout: single wxHtmlWindow filling the panel
     auto* sizer = new wxBoxSizer(wxVERTICAL);
 
@@ -131,7 +194,8 @@ PreviewPanel::PreviewPanel(wxWindow* parent,
     content_changed_sub_ = event_bus_.subscribe<core::events::EditorContentChangedEvent>(
         [this](const core::events::EditorContentChangedEvent& evt)
         {
-            pending_content_ = evt.content;
+            // Text is pulled when the debounce fires, not per notification
+            pending_snapshot_ = evt.snapshot;
             render_timer_.Start(render_debounce_ms_, wxTIMER_ONE_SHOT);
         });
 
@@ -158,6 +222,14 @@ PreviewPanel::~PreviewPanel()
     // Improvement #11: set destroyed flag before stopping timers
     destroyed_ = true;
 
+    // Join the render worker before members it reports back to go away
+    render_pipeline_.reset();
+    image_cache_.reset();
+    if (mermaid_renderer_ != nullptr)
+    {
+        mermaid_renderer_->remove_ready_listener(mermaid_listener_);
+    }
+
     // Stability #30: stop all timers to prevent callbacks into destroyed members
     render_timer_.Stop();
     resize_timer_.Stop();
@@ -172,16 +244,19 @@ void PreviewPanel::SetMarkdownContent(const std::string& markdown)
 {
     // Cancel any pending debounced render
     render_timer_.Stop();
-    pending_content_.clear();
+    pending_snapshot_.reset();
 
-    RenderContent(markdown);
+    RenderContent(std::make_shared<const std::string>(markdown));
 }
 
 void PreviewPanel::Clear()
 {
     render_timer_.Stop();
-    pending_content_.clear();
-    last_rendered_content_.clear();
+    pending_snapshot_.reset();
+    last_rendered_content_.reset();
+    submitted_content_.reset();
+    code_block_sources_.clear();
+    render_pipeline_->discard_pending();
     if (html_view_ != nullptr)
     {
         html_view_->SetPage("<html><body></body></html>");
@@ -408,7 +483,7 @@ img {{
     max-width: 100%;
     height: auto;
 }}
-.image-missing {{
+.image-missing, .image-loading {{
     border: 1px dashed {border};
     padding: 16px;
     text-align: center;
@@ -719,6 +794,13 @@ code {{
 // ═══════════════════════════════════════════════════════
 
 auto PreviewPanel::GenerateFullHtml(const std::string& body_html) const -> std::string
+{
+    std::string page;
+    AppendFullHtml(page, body_html);
+    return page;
+}
+
+void PreviewPanel::AppendFullHtml(std::string& page, std::string_view body_html) const
 {
     const auto& col = theme().colors;
 
@@ -726,7 +808,10 @@ auto PreviewPanel::GenerateFullHtml(const std::string& body_html) const -> std::
     // progressive enhancement, but the critical colors MUST be set via
     // legacy <body> attributes (bgcolor, text, link) that wxHtmlWindow
     // reliably honours.
-    return fmt::format(R"(<!DOCTYPE html>
+    const auto& css = GenerateCSS();
+    page.reserve(page.size() + css.size() + body_html.size() + 256);
+    fmt::format_to(std::back_inserter(page),
+                   R"(<!DOCTYPE html>
 <html>
 <head>
 <meta charset="utf-8">
@@ -738,96 +823,96 @@ auto PreviewPanel::GenerateFullHtml(const std::string& body_html) const -> std::
 {}
 </body>
 </html>)",
-                       GenerateCSS(),
-                       col.bg_app.to_hex(),
-                       col.text_main.to_hex(),
-                       col.accent_primary.to_hex(),
-                       body_html);
+                   css,
+                   col.bg_app.to_hex(),
+                   col.text_main.to_hex(),
+                   col.accent_primary.to_hex(),
+                   body_html);
 }
 
 // ═══════════════════════════════════════════════════════
 // Rendering pipeline
 // ═══════════════════════════════════════════════════════
 
-void PreviewPanel::RenderContent(const std::string& markdown)
+void PreviewPanel::RenderContent(std::shared_ptr<const std::string> markdown)
 {
     MARKAMP_PROFILE_SCOPE("PreviewPanel::RenderContent");
-    if (markdown == last_rendered_content_)
+    if (submitted_content_ &&
+        (markdown == submitted_content_ || *markdown == *submitted_content_))
     {
         return; // No change
     }
 
     // Stability #23: reject unreasonably large content (> 10MB)
-    constexpr size_t kMaxContentSize = 10 * 1024 * 1024;
-    if (markdown.size() > kMaxContentSize)
+    if (markdown->size() > rendering::PreviewRenderer::kMaxContentSize)
     {
         DisplayError("Content too large to render (> 10MB)");
         return;
     }
 
-    // Stability #21: wrap entire render pipeline in try-catch
-    try
-    {
-        // Save scroll position
-        int scroll_x = 0;
-        int scroll_y = 0;
-        if (html_view_ != nullptr)
-        {
-            html_view_->GetViewStart(&scroll_x, &scroll_y);
-        }
+    // Parse, render and sanitize happen on the worker; see OnRenderResultReady
+    submitted_content_ = std::move(markdown);
+    render_pipeline_->submit(submitted_content_);
+}
 
-        // Parse markdown (handles footnote preprocessing internally)
-        auto doc_result = parser_.parse(markdown);
-        if (!doc_result.has_value())
-        {
-            DisplayError(doc_result.error());
-            return;
-        }
+void PreviewPanel::RerenderCurrentContent()
+{
+    // Prefer an in-flight submission over what is currently displayed
+    auto content = submitted_content_ ? submitted_content_ : last_rendered_content_;
+    if (content)
+    {
+        render_pipeline_->submit(std::move(content));
+    }
+}
 
-        // Improvement #21: lazy renderer config — only reconfigure if renderers changed
-        renderer_.set_mermaid_renderer(mermaid_renderer_);
-        renderer_.set_math_renderer(math_renderer_);
-        if (!base_path_.empty())
-        {
-            renderer_.set_base_path(base_path_);
-        }
+void PreviewPanel::OnRenderResultReady()
+{
+    if (destroyed_ || html_view_ == nullptr)
+    {
+        return;
+    }
 
-        // Render with footnotes (using data from parser result)
-        std::string body_html;
-        if (doc_result->has_footnotes_)
-        {
-            body_html =
-                renderer_.render_with_footnotes(*doc_result, doc_result->footnote_section_html);
-        }
-        else
-        {
-            body_html = renderer_.render(*doc_result);
-        }
+    // Stale generations (superseded by a newer submission) come back empty
+    auto result = render_pipeline_->take_latest();
+    if (!result.has_value())
+    {
+        return;
+    }
 
-        // Sanitize HTML output (defense-in-depth)
-        auto safe_html = sanitizer_.sanitize(body_html);
+    if (!result->error.empty())
+    {
+        DisplayError(result->error);
+        return;
+    }
 
-        // Improvement 25: cache for DisplayError reuse
-        last_rendered_html_ = safe_html;
+    // Stability #21: keep a failing SetPage from escaping the event loop
+    try
+    {
+        // Improvement 25: cache for DisplayError reuse; the previous body's
+        // capacity goes back to the worker for the next render
+        render_pipeline_->recycle(std::move(last_rendered_html_));
+        last_rendered_html_ = std::move(result->body_html);
+        code_block_sources_ = std::move(result->code_block_sources);
+        last_rendered_content_ = std::move(result->markdown);
 
-        // Generate full HTML and display
-        auto full_html = GenerateFullHtml(safe_html);
-        if (html_view_ != nullptr)
-        {
-            // Freeze to avoid flicker during content replacement
-            html_view_->Freeze();
-            html_view_->SetPage(full_html);
+        // Save scroll position
+        int scroll_x = 0;
+        int scroll_y = 0;
+        html_view_->GetViewStart(&scroll_x, &scroll_y);
 
-            // Restore scroll position
-            html_view_->Scroll(scroll_x, scroll_y);
-            html_view_->Thaw();
-        }
+        // Freeze to avoid flicker during content replacement
+        html_view_->Freeze();
+        page_html_.clear();
+        AppendFullHtml(page_html_, last_rendered_html_);
+        html_view_->SetPage(page_html_);
 
-        last_rendered_content_ = markdown;
+        // Restore scroll position
+        html_view_->Scroll(scroll_x, scroll_y);
+        html_view_->Thaw();
     }
     catch (const std::exception& ex)
     {
-        spdlog::error("PreviewPanel::RenderContent exception: {}", ex.what());
+        spdlog::error("PreviewPanel::OnRenderResultReady exception: {}", ex.what());
         DisplayError(fmt::format("Rendering failed: {}", ex.what()));
     }
 }
@@ -863,13 +948,16 @@ void PreviewPanel::OnRenderTimer(wxTimerEvent& /*event*/)
         return;
 
     // New stability #23 (adjusted): guard against state issues during timer callback
-    if (html_view_ == nullptr || pending_content_.empty())
+    if (html_view_ == nullptr || !pending_snapshot_)
         return;
 
-    // Improvement #8: save content before clearing, retry on failure
-    auto content = std::move(pending_content_);
-    pending_content_.clear();
-    RenderContent(content);
+    // Superseded handles yield nullptr; the newer notification restarts the timer
+    auto snapshot = std::move(pending_snapshot_);
+    pending_snapshot_.reset();
+    if (auto content = snapshot->content())
+    {
+        RenderContent(std::move(content));
+    }
 }
 
 void PreviewPanel::OnLinkClicked(wxHtmlLinkEvent& event)
@@ -891,7 +979,11 @@ void PreviewPanel::OnLinkClicked(wxHtmlLinkEvent& event)
             spdlog::warn("PreviewPanel: invalid copy block ID: {}", block_id_str);
             return;
         }
-        auto source = renderer_.code_renderer().get_block_source(block_id);
+        std::string source;
+        if (block_id >= 0 && static_cast<size_t>(block_id) < code_block_sources_.size())
+        {
+            source = code_block_sources_[static_cast<size_t>(block_id)];
+        }
         if (!source.empty())
         {
             if (wxTheClipboard->Open())
@@ -937,11 +1029,13 @@ void PreviewPanel::OnSize(wxSizeEvent& event)
 {
     event.Skip();
 
+    UpdateImageWidth();
+
     // Bevel overlay disabled — it blocks the preview on macOS
     // (bevel_overlay_ is hidden, no repositioning needed)
 
     // Improvement 24: debounce content re-render during resize drag
-    if (!last_rendered_content_.empty())
+    if (last_rendered_content_)
     {
         resize_timer_.Start(kResizeDebounceMs, wxTIMER_ONE_SHOT);
     }
@@ -957,12 +1051,38 @@ void PreviewPanel::OnResizeTimer(wxTimerEvent& /*event*/)
         return;
 
     // New stability #22: guard against null html_view_ during resize
-    if (html_view_ == nullptr || last_rendered_content_.empty())
+    if (html_view_ == nullptr || !last_rendered_content_)
+        return;
+
+    RerenderCurrentContent();
+}
+
+void PreviewPanel::UpdateImageWidth()
+{
+    if (render_pipeline_ == nullptr)
+    {
+        return;
+    }
+
+    // Variants are sized in physical pixels so HiDPI previews stay sharp
+    const auto width = static_cast<int>(GetClientSize().GetWidth() * GetContentScaleFactor());
+    const auto bucket = rendering::ImageCache::width_bucket(width);
+    if (bucket != render_settings_.image_width)
+    {
+        render_settings_.image_width = bucket;
+        render_pipeline_->set_settings(render_settings_);
+    }
+}
+
+void PreviewPanel::OnDeferredContentReady()
+{
+    if (destroyed_ || html_view_ == nullptr)
+    {
         return;
+    }
 
-    auto content = last_rendered_content_;
-    last_rendered_content_.clear(); // Force re-render
-    RenderContent(content);
+    // Only the blocks showing a loading placeholder are rendered again
+    RerenderCurrentContent();
 }
 
 // ═══════════════════════════════════════════════════════
@@ -1028,16 +1148,16 @@ void PreviewPanel::OnThemeChanged(const core::Theme& new_theme)
 
     // Invalidate cached CSS on theme change
     cached_css_.clear();
+    // Mermaid diagrams are rendered with theme colours
+    render_pipeline_->invalidate();
 
     // Re-render with new theme CSS (immediate, not debounced)
     // New stability #26: wrap re-render in try-catch to prevent theme change crash
-    if (!last_rendered_content_.empty())
+    if (last_rendered_content_)
     {
         try
         {
-            auto content = last_rendered_content_;
-            last_rendered_content_.clear(); // Force re-render
-            RenderContent(content);
+            RerenderCurrentContent();
         }
         catch (const std::exception&)
         {
@@ -1061,13 +1181,11 @@ void PreviewPanel::SetZoomLevel(int level)
     // Clear cache and re-render
     // New stability #27: wrap re-render in try-catch to prevent zoom crash
     cached_css_.clear();
-    if (!last_rendered_content_.empty())
+    if (last_rendered_content_)
     {
         try
         {
-            auto content = last_rendered_content_;
-            last_rendered_content_.clear();
-            RenderContent(content);
+            RerenderCurrentContent();
         }
         catch (const std::exception&)
         {
@@ -1198,7 +1316,7 @@ void PreviewPanel::set_scroll_sync_enabled(bool enabled)
 
 auto PreviewPanel::ExportHtml(const std::filesystem::path& output_path) const -> bool
 {
-    if (last_rendered_content_.empty())
+    if (!last_rendered_content_)
     {
         return false;
     }
@@ -1208,7 +1326,7 @@ auto PreviewPanel::ExportHtml(const std::filesystem::path& output_path) const ->
     {
         // Re-render to get the full HTML
         rendering::FootnotePreprocessor footnote_proc;
-        auto footnote_result = footnote_proc.process(last_rendered_content_);
+        auto footnote_result = footnote_proc.process(*last_rendered_content_);
 
         core::MarkdownParser parser;
         auto doc_result = parser.parse(footnote_result.processed_markdown);
@@ -1267,6 +1385,12 @@ auto PreviewPanel::ExportHtml(const std::filesystem::path& output_path) const ->
 
 void PreviewPanel::set_base_path(const std::filesystem::path& base_path)
 {
+    if (base_path_ != base_path)
+    {
+        // Relative image paths resolve differently now
+        render_settings_.base_path = base_path;
+        render_pipeline_->set_settings(render_settings_);
+    }
     base_path_ = base_path;
 }
 
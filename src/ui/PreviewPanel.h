@@ -1,17 +1,21 @@
 #pragma once
 
 #include "ThemeAwareWindow.h"
+#include "core/DocumentSnapshot.h"
 #include "core/EventBus.h"
-#include "core/HtmlSanitizer.h"
-#include "core/MarkdownParser.h"
 #include "core/Types.h"
-#include "rendering/HtmlRenderer.h"
+#include "rendering/ImageCache.h"
+#include "rendering/PreviewPipeline.h"
 
 #include <wx/html/htmlwin.h>
 #include <wx/timer.h>
 
+#include <cstddef>
 #include <filesystem>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace markamp::core
 {
@@ -62,6 +66,7 @@ public:
     // CSS/HTML generation (public for testing)
     [[nodiscard]] auto GenerateCSS() const -> std::string;
     [[nodiscard]] auto GenerateFullHtml(const std::string& body_html) const -> std::string;
+    void AppendFullHtml(std::string& page, std::string_view body_html) const;
 
     // Base path for image resolution
     void set_base_path(const std::filesystem::path& base_path);
@@ -69,7 +74,8 @@ public:
     /// Enable or disable Mermaid diagram rendering (feature guard forwarding).
     void set_mermaid_enabled(bool enabled)
     {
-        renderer_.set_mermaid_enabled(enabled);
+        render_settings_.mermaid_enabled = enabled;
+        render_pipeline_->set_settings(render_settings_);
     }
 
 protected:
@@ -79,24 +85,30 @@ private:
     core::EventBus& event_bus_;
     wxHtmlWindow* html_view_{nullptr};
     BevelPanel* bevel_overlay_{nullptr};
-    core::MarkdownParser parser_;
-    core::HtmlSanitizer sanitizer_;
 
     // Base path for relative image resolution
     std::filesystem::path base_path_;
 
-    // Rendering pipeline
-    void RenderContent(const std::string& markdown);
+    // Rendering pipeline: parse/render/sanitize run on a background worker;
+    // the UI thread only submits snapshots and displays finished pages.
+    void RenderContent(std::shared_ptr<const std::string> markdown);
+    void RerenderCurrentContent();
+    void OnRenderResultReady();
     void DisplayError(const std::string& error_message);
+    std::unique_ptr<rendering::ImageCache> image_cache_; // Outlives render_pipeline_
+    std::unique_ptr<rendering::PreviewPipeline> render_pipeline_;
+    rendering::PreviewRenderSettings render_settings_;
+    std::shared_ptr<const std::string> submitted_content_;
+    std::vector<std::string> code_block_sources_; // From the displayed render, for copy links
 
     // Debouncing
     int render_debounce_ms_{300};
     wxTimer render_timer_;
-    std::string pending_content_;
-    std::string last_rendered_content_;
+    std::shared_ptr<const core::LazyDocumentSnapshot> pending_snapshot_;
+    std::shared_ptr<const std::string> last_rendered_content_;
     mutable std::string cached_css_;
     std::string last_rendered_html_;   // Improvement 25: cached HTML body for DisplayError
-    rendering::HtmlRenderer renderer_; // Improvement 11: reused across renders
+    std::string page_html_;            // Reused buffer for the page passed to SetPage
     core::IMermaidRenderer* mermaid_renderer_{nullptr};
     core::IMathRenderer* math_renderer_{nullptr};
     void OnRenderTimer(wxTimerEvent& event);
@@ -106,6 +118,13 @@ private:
     wxTimer resize_timer_;
     void OnResizeTimer(wxTimerEvent& event);
 
+    // Large images are embedded downscaled to the preview width
+    void UpdateImageWidth();
+
+    // An image variant or Mermaid diagram rendered in the background landed
+    void OnDeferredContentReady();
+    std::size_t mermaid_listener_{0}; // IMermaidRenderer::add_ready_listener handle
+
     // Improvement #11: guard against timer firing after destruction
     bool destroyed_{false};
 
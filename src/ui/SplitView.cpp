@@ -82,7 +82,7 @@ SplitView::SplitView(wxWindow* parent,
     // --- Subscribe to content changes for heading index ---
     content_sub_ = event_bus_.subscribe<core::events::EditorContentChangedEvent>(
         [this](const core::events::EditorContentChangedEvent& evt)
-        { RebuildHeadingIndex(evt.content); });
+        { heading_source_ = evt.snapshot; });
 
     // --- Subscribe to focus mode toggle ---
     focus_mode_sub_ = event_bus_.subscribe<core::events::FocusModeChangedEvent>(
@@ -418,26 +418,41 @@ auto SplitView::GetScrollSyncMode() const -> core::events::ScrollSyncMode
     return scroll_sync_mode_;
 }
 
-void SplitView::RebuildHeadingIndex(const std::string& content)
+void SplitView::RebuildHeadingIndex(std::string_view content) const
 {
     heading_positions_.clear();
 
     // Find lines starting with # (markdown headings)
-    std::istringstream stream(content);
-    std::string line;
     int line_num = 0;
-    while (std::getline(stream, line))
+    std::size_t line_start = 0;
+    while (line_start < content.size())
     {
-        if (!line.empty() && line[0] == '#')
+        if (content[line_start] == '#')
         {
             heading_positions_.push_back(line_num);
         }
+        const auto line_end = content.find('\n', line_start);
+        if (line_end == std::string_view::npos)
+        {
+            break;
+        }
+        line_start = line_end + 1;
         ++line_num;
     }
 }
 
 auto SplitView::FindNearestHeading(int editor_line) const -> int
 {
+    if (heading_source_)
+    {
+        // Expired handles keep the previous index until the next notification
+        if (auto content = heading_source_->content())
+        {
+            RebuildHeadingIndex(*content);
+        }
+        heading_source_.reset();
+    }
+
     if (heading_positions_.empty())
     {
         return -1;
@@ -511,6 +526,14 @@ void SplitView::set_feature_registry(core::FeatureRegistry* registry)
     }
 }
 
+void SplitView::set_grammar_engine(const core::GrammarEngine* grammars)
+{
+    if (editor_panel_ != nullptr)
+    {
+        editor_panel_->set_grammar_engine(grammars);
+    }
+}
+
 void SplitView::set_mermaid_enabled(bool enabled)
 {
     if (preview_panel_ != nullptr)
@@ -6,13 +6,16 @@
 
 #include <wx/timer.h>
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace markamp::core
 {
 class Config;
 class FeatureRegistry;
+class GrammarEngine;
 class IMermaidRenderer;
 class IMathRenderer;
 } // namespace markamp::core
@@ -76,6 +79,9 @@ public:
     /// Inject FeatureRegistry for feature-guard checks (forwards to EditorPanel).
     void set_feature_registry(core::FeatureRegistry* registry);
 
+    /// Inject extension grammars for fenced code colouring (forwards to EditorPanel).
+    void set_grammar_engine(const core::GrammarEngine* grammars);
+
     /// Enable or disable Mermaid rendering (forwards to PreviewPanel).
     void set_mermaid_enabled(bool enabled);
 
@@ -119,7 +125,9 @@ private:
 
     // Scroll sync
     core::events::ScrollSyncMode scroll_sync_mode_{core::events::ScrollSyncMode::Proportional};
-    std::vector<int> heading_positions_; // editor line numbers of headings
+    mutable std::vector<int> heading_positions_; // editor line numbers of headings
+    // Built on first lookup after a change, not on every content notification
+    mutable std::shared_ptr<const core::LazyDocumentSnapshot> heading_source_;
 
     // Divider dragging
     bool is_dragging_{false};
@@ -166,7 +174,7 @@ private:
     void RestoreEditorState(const EditorState& state);
 
     // Heading index for scroll sync
-    void RebuildHeadingIndex(const std::string& content);
+    void RebuildHeadingIndex(std::string_view content) const;
     auto FindNearestHeading(int editor_line) const -> int;
 
     // Event subscriptions
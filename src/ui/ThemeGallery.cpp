@@ -7,20 +7,40 @@
 #include <wx/dcbuffer.h>
 #include <wx/filedlg.h>
 #include <wx/graphics.h>
+#include <wx/image.h>
 #include <wx/msgdlg.h>
 #include <wx/sizer.h>
 #include <wx/srchctrl.h>
 #include <wx/stattext.h>
 
 #include <algorithm>
+#include <ranges>
 
 namespace markamp::ui
 {
 
 namespace
 {
-constexpr int kMinCardWidth = 250;
 constexpr int kErrorTimerMs = 5000;
+constexpr int kEmptyLabelTop = 40;
+
+auto to_lower(std::string text) -> std::string
+{
+    std::transform(text.begin(),
+                   text.end(),
+                   text.begin(),
+                   [](unsigned char character)
+                   { return static_cast<char>(std::tolower(character)); });
+    return text;
+}
+
+/// Wrap rendered preview pixels in a bitmap (UI thread only).
+auto to_bitmap(const core::ThemePreviewImage& image) -> wxBitmap
+{
+    wxImage wx_image(image.width, image.height, false);
+    std::copy(image.rgb.begin(), image.rgb.end(), wx_image.GetData());
+    return wxBitmap(wx_image);
+}
 } // namespace
 
 // ═══════════════════════════════════════════════════════
@@ -39,7 +59,14 @@ ThemeGallery::ThemeGallery(wxWindow* parent,
     , theme_engine_(theme_engine)
     , registry_(registry)
     , error_timer_(this)
+    , preview_renderer_(ThemePreviewCard::kPreviewImageWidth,
+                        ThemePreviewCard::kPreviewImageHeight)
 {
+    // Finished previews are handed to the UI thread; CallAfter is thread-safe
+    preview_renderer_.set_ready_callback(
+        [this](const std::string& theme_id, uint64_t hash)
+        { CallAfter([this, theme_id, hash]() { OnPreviewReady(theme_id, hash); }); });
+
     // Size: 896px wide, 80% of parent height
     int parent_height = parent != nullptr ? parent->GetSize().GetHeight() : 700;
     int dialog_height = static_cast<int>(static_cast<double>(parent_height) * 0.8);
@@ -71,10 +98,16 @@ ThemeGallery::ThemeGallery(wxWindow* parent,
     // Event bindings
     Bind(wxEVT_CLOSE_WINDOW, &ThemeGallery::OnClose, this);
     Bind(wxEVT_CHAR_HOOK, &ThemeGallery::OnKeyDown, this);
-    Bind(wxEVT_SIZE, &ThemeGallery::OnSize, this);
     Bind(wxEVT_TIMER, &ThemeGallery::OnErrorTimer, this, error_timer_.GetId());
 }
 
+ThemeGallery::~ThemeGallery()
+{
+    // No more CallAfter() from the worker once this returns
+    preview_renderer_.set_ready_callback(nullptr);
+    preview_renderer_.cancel_pending();
+}
+
 // ═══════════════════════════════════════════════════════
 // Public API
 // ═══════════════════════════════════════════════════════
@@ -91,9 +124,7 @@ auto ThemeGallery::GetSelectedThemeId() const -> std::string
 
 auto ThemeGallery::CalculateColumns(int available_width) -> int
 {
-    int card_width = ThemePreviewCard::kCardWidth;
-    int gap = kCardGap;
-    return std::max(1, (available_width + gap) / (card_width + gap));
+    return kGrid.columns(available_width + kGridPadding * 2);
 }
 
 auto ThemeGallery::ExportFilename(const std::string& theme_name) -> std::string
@@ -242,66 +273,243 @@ void ThemeGallery::CreateGrid()
 
     const auto& t = theme_engine_.current_theme();
     grid_panel_->SetBackgroundColour(wxColour(t.colors.bg_app.to_rgba_string()));
+
+    // R21 Fix 27: Empty state illustration when no themes match filter
+    empty_label_ = new wxStaticText(grid_panel_,
+                                    wxID_ANY,
+                                    "No themes found",
+                                    wxDefaultPosition,
+                                    wxDefaultSize,
+                                    wxALIGN_CENTRE_HORIZONTAL | wxST_NO_AUTORESIZE);
+    auto font = empty_label_->GetFont();
+    font.SetPointSize(13);
+    font.SetStyle(wxFONTSTYLE_ITALIC);
+    empty_label_->SetFont(font);
+    empty_label_->SetForegroundColour(theme_engine_.color(core::ThemeColorToken::TextMuted));
+    empty_label_->Hide();
+
+    // Cards are created for the visible rows only, so every scroll or
+    // resize re-checks which rows those are
+    grid_panel_->Bind(wxEVT_SIZE, &ThemeGallery::OnGridSize, this);
+    for (const auto event_type : {wxEVT_SCROLLWIN_TOP,
+                                  wxEVT_SCROLLWIN_BOTTOM,
+                                  wxEVT_SCROLLWIN_LINEUP,
+                                  wxEVT_SCROLLWIN_LINEDOWN,
+                                  wxEVT_SCROLLWIN_PAGEUP,
+                                  wxEVT_SCROLLWIN_PAGEDOWN,
+                                  wxEVT_SCROLLWIN_THUMBTRACK,
+                                  wxEVT_SCROLLWIN_THUMBRELEASE})
+    {
+        grid_panel_->Bind(event_type, &ThemeGallery::OnGridScroll, this);
+    }
 }
 
 void ThemeGallery::PopulateGrid()
 {
-    // Clear existing cards
+    // Only the list of themes is read here; full Theme data is fetched from
+    // the registry for the cards that become visible
+    themes_ = theme_engine_.available_themes();
+
+    // Themes may have been replaced: rebind every card. Unchanged themes
+    // hash the same and find their preview in the renderer's cache.
     for (auto* card : preview_cards_)
     {
-        card->Destroy();
+        card->Hide();
+        spare_cards_.push_back(card);
     }
     preview_cards_.clear();
+    preview_hashes_.clear();
+
+    ApplyFilter();
+    UpdateVisibleCards();
+}
+
+void ThemeGallery::ApplyFilter()
+{
+    // R18 Fix 34: Case-insensitive substring filter on theme names
+    const std::string lower_filter = to_lower(filter_text_);
+    shown_.clear();
+    shown_.reserve(themes_.size());
+    for (std::size_t index = 0; index < themes_.size(); ++index)
+    {
+        if (lower_filter.empty() ||
+            to_lower(themes_[index].name).find(lower_filter) != std::string::npos)
+        {
+            shown_.push_back(index);
+        }
+    }
+}
 
-    // Calculate columns
-    int available_width = grid_panel_->GetClientSize().GetWidth() - kGridPadding * 2;
-    if (available_width < kMinCardWidth)
+void ThemeGallery::ScheduleVisibleUpdate()
+{
+    // Coalesce bursts of scroll and size events into one update, run after
+    // the scrolled window has applied the new position
+    if (update_pending_)
     {
-        available_width = kDialogWidth - kGridPadding * 2;
+        return;
     }
-    int columns = CalculateColumns(available_width);
+    update_pending_ = true;
+    CallAfter(
+        [this]()
+        {
+            update_pending_ = false;
+            UpdateVisibleCards();
+        });
+}
 
-    auto* grid_sizer = new wxGridSizer(columns, kCardGap, kCardGap);
+void ThemeGallery::UpdateVisibleCards()
+{
+    if (grid_panel_ == nullptr)
+    {
+        return;
+    }
 
-    auto themes = theme_engine_.available_themes();
-    std::string original_theme_id = theme_engine_.current_theme().id;
+    wxSize viewport = grid_panel_->GetClientSize();
+    if (viewport.GetWidth() < ThemePreviewCard::kCardWidth)
+    {
+        // Not laid out yet: assume the default dialog width
+        viewport.SetWidth(kDialogWidth);
+    }
+    const int columns = kGrid.columns(viewport.GetWidth());
+    grid_panel_->SetVirtualSize(viewport.GetWidth(), kGrid.content_height(shown_.size(), columns));
 
-    // Collect full Theme data by temporarily applying each theme
-    std::vector<core::Theme> all_themes;
-    all_themes.reserve(themes.size());
+    const int scroll_y = grid_panel_->CalcUnscrolledPosition(wxPoint(0, 0)).y;
+    const auto range = kGrid.visible(shown_.size(), columns, scroll_y, viewport.GetHeight());
 
-    // Track which themes are built-in
-    std::vector<bool> builtin_flags;
-    builtin_flags.reserve(themes.size());
+    // Cards still showing a visible theme stay put with their bitmap; the
+    // rest are parked and rebound to the themes scrolled into view
+    std::unordered_map<std::string, ThemePreviewCard*> bound;
+    for (auto* card : preview_cards_)
+    {
+        bound.emplace(card->GetThemeId(), card);
+    }
+    preview_cards_.clear();
 
-    for (const auto& info : themes)
+    std::vector<ThemePreviewCard*> slots(range.last - range.first, nullptr);
+    for (auto position = range.first; position < range.last; ++position)
+    {
+        const auto iter = bound.find(themes_[shown_[position]].id);
+        if (iter != bound.end())
+        {
+            slots[position - range.first] = iter->second;
+            bound.erase(iter);
+        }
+    }
+    for (auto& [theme_id, card] : bound)
     {
-        theme_engine_.apply_theme(info.id);
-        all_themes.push_back(theme_engine_.current_theme());
-        builtin_flags.push_back(info.is_builtin);
+        card->Hide();
+        spare_cards_.push_back(card);
     }
 
-    // Restore original theme
-    theme_engine_.apply_theme(original_theme_id);
+    // Rows scrolled away no longer need their previews
+    preview_renderer_.cancel_pending();
 
-    // Create cards with full theme data
-    for (size_t i = 0; i < all_themes.size(); ++i)
+    const std::string& current_id = theme_engine_.current_theme().id;
+    std::vector<const core::Theme*> misses;
+    for (auto position = range.first; position < range.last; ++position)
     {
-        const auto& theme = all_themes[i];
-        bool is_active = (theme.id == original_theme_id);
-        bool is_builtin = builtin_flags[i];
-        auto* card = new ThemePreviewCard(grid_panel_, theme, is_active, is_builtin);
-        card->SetOnClick([this](const std::string& id) { OnThemeCardClicked(id); });
-        card->SetOnExport([this](const std::string& id) { OnExportTheme(id); });
-        card->SetOnDelete([this](const std::string& id) { OnDeleteTheme(id); });
+        const auto& info = themes_[shown_[position]];
+        auto* card = slots[position - range.first];
+        if (card != nullptr)
+        {
+            card->SetActive(info.id == current_id);
+        }
+        else
+        {
+            auto theme = registry_.get_theme(info.id);
+            if (!theme.has_value())
+            {
+                continue;
+            }
+            card = TakeCard(*theme, info.id == current_id, info.is_builtin);
+        }
+
+        const auto origin = kGrid.origin(position, columns);
+        card->SetPosition(grid_panel_->CalcScrolledPosition(wxPoint(origin.x, origin.y)));
+        card->Show();
         preview_cards_.push_back(card);
-        grid_sizer->Add(card, 0, wxALL, 0);
+        BindPreview(card, misses);
+    }
+
+    // Newest requests render first: queue bottom-up so the top row is first
+    for (const auto* theme : std::views::reverse(misses))
+    {
+        preview_renderer_.request(*theme, preview_hashes_[theme->id]);
     }
 
-    auto* outer_sizer = new wxBoxSizer(wxVERTICAL);
-    outer_sizer->Add(grid_sizer, 0, wxALL, kGridPadding);
-    grid_panel_->SetSizer(outer_sizer);
-    grid_panel_->FitInside();
+    const bool show_empty = shown_.empty() && !filter_text_.empty();
+    if (show_empty)
+    {
+        empty_label_->SetSize(0, kEmptyLabelTop, viewport.GetWidth(), wxDefaultCoord);
+    }
+    empty_label_->Show(show_empty);
+}
+
+auto ThemeGallery::TakeCard(const core::Theme& theme, bool is_active, bool is_builtin)
+    -> ThemePreviewCard*
+{
+    if (!spare_cards_.empty())
+    {
+        auto* card = spare_cards_.back();
+        spare_cards_.pop_back();
+        card->SetTheme(theme, is_active, is_builtin);
+        return card;
+    }
+
+    auto* card = new ThemePreviewCard(grid_panel_, theme, is_active, is_builtin);
+    card->SetOnClick([this](const std::string& id) { OnThemeCardClicked(id); });
+    card->SetOnExport([this](const std::string& id) { OnExportTheme(id); });
+    card->SetOnDelete([this](const std::string& id) { OnDeleteTheme(id); });
+    return card;
+}
+
+void ThemeGallery::BindPreview(ThemePreviewCard* card, std::vector<const core::Theme*>& misses)
+{
+    if (card->HasPreview())
+    {
+        return;
+    }
+
+    const auto& theme = card->GetTheme();
+    auto hash_iter = preview_hashes_.find(theme.id);
+    if (hash_iter == preview_hashes_.end())
+    {
+        hash_iter =
+            preview_hashes_.emplace(theme.id, core::ThemePreviewRenderer::content_hash(theme))
+                .first;
+    }
+
+    if (auto image = preview_renderer_.lookup(theme.id, hash_iter->second))
+    {
+        card->SetPreview(to_bitmap(*image));
+        return;
+    }
+    misses.push_back(&theme);
+}
+
+void ThemeGallery::OnPreviewReady(const std::string& theme_id, uint64_t hash)
+{
+    const auto hash_iter = preview_hashes_.find(theme_id);
+    if (hash_iter == preview_hashes_.end() || hash_iter->second != hash)
+    {
+        return; // The theme changed since the preview was requested
+    }
+    for (auto* card : preview_cards_)
+    {
+        if (card->GetThemeId() == theme_id && !card->HasPreview())
+        {
+            if (auto image = preview_renderer_.lookup(theme_id, hash))
+            {
+                card->SetPreview(to_bitmap(*image));
+            }
+        }
+    }
+}
+
+auto ThemeGallery::FindTheme(const std::string& theme_id) const -> const core::ThemeInfo*
+{
+    const auto iter = std::ranges::find(themes_, theme_id, &core::ThemeInfo::id);
+    return iter != themes_.end() ? &*iter : nullptr;
 }
 
 void ThemeGallery::UpdateActiveIndicators()
@@ -317,8 +525,10 @@ void ThemeGallery::RefreshThemeCount()
 {
     if (theme_count_label_ != nullptr)
     {
-        auto theme_count = theme_engine_.available_themes().size();
-        wxString count_text = wxString::Format("Viewing %zu installed themes", theme_count);
+        const wxString count_text =
+            filter_text_.empty()
+                ? wxString::Format("Viewing %zu installed themes", themes_.size())
+                : wxString::Format("Showing %zu of %zu themes", shown_.size(), themes_.size());
         theme_count_label_->SetLabel(count_text);
     }
 }
@@ -399,13 +609,9 @@ void ThemeGallery::OnExportTheme(const std::string& theme_id)
 {
     // Find theme name for default filename
     std::string default_name;
-    for (const auto& card : preview_cards_)
+    if (const auto* info = FindTheme(theme_id))
     {
-        if (card->GetThemeId() == theme_id)
-        {
-            default_name = ExportFilename(card->GetThemeName());
-            break;
-        }
+        default_name = ExportFilename(info->name);
     }
 
     if (default_name.empty())
@@ -441,13 +647,9 @@ void ThemeGallery::OnDeleteTheme(const std::string& theme_id)
 {
     // Find theme name for the confirmation message
     std::string theme_name = theme_id;
-    for (const auto& card : preview_cards_)
+    if (const auto* info = FindTheme(theme_id))
     {
-        if (card->GetThemeId() == theme_id)
-        {
-            theme_name = card->GetThemeName();
-            break;
-        }
+        theme_name = info->name;
     }
 
     // Confirmation dialog
@@ -519,33 +721,16 @@ void ThemeGallery::OnImportClicked(wxCommandEvent& /*event*/)
     }
 }
 
-void ThemeGallery::OnSize(wxSizeEvent& event)
+void ThemeGallery::OnGridSize(wxSizeEvent& event)
 {
-    // Recalculate grid columns on resize
-    if (grid_panel_ != nullptr && !preview_cards_.empty())
-    {
-        int available_width = grid_panel_->GetClientSize().GetWidth() - kGridPadding * 2;
-        int columns = CalculateColumns(available_width);
-
-        auto* sizer = grid_panel_->GetSizer();
-        if (sizer != nullptr)
-        {
-            // Find the grid sizer (first child of the outer sizer)
-            auto* outer = dynamic_cast<wxBoxSizer*>(sizer);
-            if (outer != nullptr && outer->GetItemCount() > 0)
-            {
-                auto* grid =
-                    dynamic_cast<wxGridSizer*>(outer->GetItem(static_cast<size_t>(0))->GetSizer());
-                if (grid != nullptr)
-                {
-                    grid->SetCols(columns);
-                    grid_panel_->FitInside();
-                    grid_panel_->Layout();
-                }
-            }
-        }
-    }
+    // The column count may change with the width
+    ScheduleVisibleUpdate();
+    event.Skip();
+}
 
+void ThemeGallery::OnGridScroll(wxScrollWinEvent& event)
+{
+    ScheduleVisibleUpdate();
     event.Skip();
 }
 
@@ -556,66 +741,12 @@ void ThemeGallery::OnErrorTimer(wxTimerEvent& /*event*/)
 
 void ThemeGallery::FilterCards(const std::string& filter_text)
 {
-    // R18 Fix 34: Case-insensitive substring filter on theme names
-    std::string lower_filter = filter_text;
-    std::transform(lower_filter.begin(),
-                   lower_filter.end(),
-                   lower_filter.begin(),
-                   [](unsigned char character)
-                   { return static_cast<char>(std::tolower(character)); });
-
-    size_t visible_count = 0;
-    for (auto* card : preview_cards_)
-    {
-        if (lower_filter.empty())
-        {
-            card->Show();
-            ++visible_count;
-            continue;
-        }
-        std::string name = card->GetThemeName();
-        std::transform(name.begin(),
-                       name.end(),
-                       name.begin(),
-                       [](unsigned char character)
-                       { return static_cast<char>(std::tolower(character)); });
-
-        const bool matches = (name.find(lower_filter) != std::string::npos);
-        card->Show(matches);
-        if (matches)
-        {
-            ++visible_count;
-        }
-    }
-
-    // Update count label
-    if (theme_count_label_ != nullptr)
-    {
-        const wxString count_text =
-            wxString::Format("Showing %zu of %zu themes", visible_count, preview_cards_.size());
-        theme_count_label_->SetLabel(count_text);
-    }
+    filter_text_ = filter_text;
+    ApplyFilter();
+    RefreshThemeCount();
 
-    // R21 Fix 27: Empty state illustration when no themes match filter
-    if (visible_count == 0 && !lower_filter.empty())
-    {
-        auto* empty_label = new wxStaticText(grid_panel_,
-                                             wxID_ANY,
-                                             "No themes found",
-                                             wxDefaultPosition,
-                                             wxDefaultSize,
-                                             wxALIGN_CENTRE_HORIZONTAL);
-        auto font = empty_label->GetFont();
-        font.SetPointSize(13);
-        font.SetStyle(wxFONTSTYLE_ITALIC);
-        empty_label->SetFont(font);
-        auto muted = theme_engine_.color(core::ThemeColorToken::TextMuted);
-        empty_label->SetForegroundColour(muted);
-        grid_panel_->GetSizer()->Add(empty_label, 0, wxALIGN_CENTER | wxTOP, 40);
-    }
-
-    grid_panel_->FitInside();
-    grid_panel_->Layout();
+    grid_panel_->Scroll(0, 0);
+    UpdateVisibleCards();
 }
 
 } // namespace markamp::ui
@@ -2,7 +2,9 @@
 
 #include "ThemePreviewCard.h"
 #include "core/ThemeEngine.h"
+#include "core/ThemePreviewRenderer.h"
 #include "core/ThemeRegistry.h"
+#include "core/VirtualGrid.h"
 
 #include <wx/dialog.h>
 #include <wx/scrolwin.h>
@@ -10,7 +12,10 @@
 #include <wx/stattext.h>
 #include <wx/timer.h>
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace markamp::ui
@@ -19,10 +24,22 @@ namespace markamp::ui
 /// Modal theme gallery dialog that displays all available themes as
 /// miniature live preview cards. Supports instant theme selection,
 /// theme import/export, and responsive grid layout.
+///
+/// The grid is virtual: it lists every theme but only the rows in (or one
+/// row beyond) the viewport have a ThemePreviewCard, and cards scrolled out
+/// of view are rebound to the themes scrolled in. Card miniatures are
+/// rendered by a core::ThemePreviewRenderer worker, keyed by theme id and
+/// content hash; a card shows a placeholder until its bitmap arrives.
 class ThemeGallery : public wxDialog
 {
 public:
     ThemeGallery(wxWindow* parent, core::ThemeEngine& theme_engine, core::ThemeRegistry& registry);
+    ~ThemeGallery() override;
+
+    ThemeGallery(const ThemeGallery&) = delete;
+    auto operator=(const ThemeGallery&) -> ThemeGallery& = delete;
+    ThemeGallery(ThemeGallery&&) = delete;
+    auto operator=(ThemeGallery&&) -> ThemeGallery& = delete;
 
     /// Show the gallery as a modal dialog.
     void ShowGallery();
@@ -42,6 +59,10 @@ public:
     static constexpr int kHeaderHeight = 72;
     static constexpr int kToolbarHeight = 48;
 
+    /// Card layout of the grid.
+    static constexpr core::VirtualGrid kGrid{
+        ThemePreviewCard::kCardWidth, ThemePreviewCard::kCardHeight, kCardGap, kGridPadding};
+
 private:
     core::ThemeEngine& theme_engine_;
     core::ThemeRegistry& registry_;
@@ -52,18 +73,39 @@ private:
     wxScrolledWindow* grid_panel_{nullptr};
     wxStaticText* theme_count_label_{nullptr};
     wxStaticText* error_label_{nullptr};
+    wxStaticText* empty_label_{nullptr};
     wxTimer error_timer_;
-    std::vector<ThemePreviewCard*> preview_cards_;
     wxSearchCtrl* search_ctrl_{nullptr}; // R18 Fix 34
 
     // State
     std::string selected_theme_id_;
+    std::string filter_text_;
+
+    // Virtual grid
+    std::vector<core::ThemeInfo> themes_;          // Every installed theme, in order
+    std::vector<std::size_t> shown_;               // Indices into themes_ passing the filter
+    std::vector<ThemePreviewCard*> preview_cards_; // Cards of the visible rows
+    std::vector<ThemePreviewCard*> spare_cards_;   // Hidden, ready to be rebound
+    bool update_pending_{false};
+
+    /// Content hash of each theme bound to a card, to match finished previews.
+    std::unordered_map<std::string, uint64_t> preview_hashes_;
+
+    core::ThemePreviewRenderer preview_renderer_;
 
     // Layout
     void CreateHeader();
     void CreateToolbar();
     void CreateGrid();
     void PopulateGrid();
+    void ApplyFilter();
+    void ScheduleVisibleUpdate();
+    void UpdateVisibleCards();
+    [[nodiscard]] auto TakeCard(const core::Theme& theme, bool is_active, bool is_builtin)
+        -> ThemePreviewCard*;
+    void BindPreview(ThemePreviewCard* card, std::vector<const core::Theme*>& misses);
+    void OnPreviewReady(const std::string& theme_id, uint64_t hash);
+    [[nodiscard]] auto FindTheme(const std::string& theme_id) const -> const core::ThemeInfo*;
     void UpdateActiveIndicators();
     void RefreshThemeCount();
     void ShowError(const std::string& message);
@@ -76,7 +118,8 @@ private:
     void OnExportTheme(const std::string& theme_id);
     void OnDeleteTheme(const std::string& theme_id);
     void OnImportClicked(wxCommandEvent& event);
-    void OnSize(wxSizeEvent& event);
+    void OnGridSize(wxSizeEvent& event);
+    void OnGridScroll(wxScrollWinEvent& event);
     void OnErrorTimer(wxTimerEvent& event);
 
     // R18 Fix 34: Theme search filter
@@ -42,6 +42,27 @@ ThemePreviewCard::ThemePreviewCard(wxWindow* parent,
 // Public API
 // ═══════════════════════════════════════════════════════
 
+void ThemePreviewCard::SetTheme(const core::Theme& theme, bool is_active, bool is_builtin)
+{
+    theme_ = theme;
+    is_active_ = is_active;
+    is_builtin_ = is_builtin;
+    is_hovered_ = false;
+    preview_ = wxNullBitmap;
+    Refresh();
+}
+
+void ThemePreviewCard::SetPreview(const wxBitmap& preview)
+{
+    preview_ = preview;
+    Refresh();
+}
+
+auto ThemePreviewCard::HasPreview() const -> bool
+{
+    return preview_.IsOk();
+}
+
 void ThemePreviewCard::SetActive(bool active)
 {
     is_active_ = active;
@@ -53,6 +74,11 @@ auto ThemePreviewCard::IsActive() const -> bool
     return is_active_;
 }
 
+auto ThemePreviewCard::GetTheme() const -> const core::Theme&
+{
+    return theme_;
+}
+
 auto ThemePreviewCard::GetThemeId() const -> std::string
 {
     return theme_.id;
@@ -207,7 +233,14 @@ void ThemePreviewCard::OnPaint(wxPaintEvent& /*event*/)
                         kBorderWidth,
                         size.GetWidth() - kBorderWidth * 2,
                         kPreviewHeight - kBorderWidth);
-    DrawMiniPreview(dc, preview_area);
+    if (preview_.IsOk())
+    {
+        dc.DrawBitmap(preview_, preview_area.GetTopLeft());
+    }
+    else
+    {
+        DrawPlaceholder(dc, preview_area);
+    }
 
     // Footer area
     wxRect footer_area(kBorderWidth,
@@ -223,74 +256,20 @@ void ThemePreviewCard::OnPaint(wxPaintEvent& /*event*/)
     }
 }
 
-void ThemePreviewCard::DrawMiniPreview(wxDC& dc, const wxRect& area)
+void ThemePreviewCard::DrawPlaceholder(wxDC& dc, const wxRect& area)
 {
     const auto& c = theme_.colors;
 
-    // Background
+    // Just the layout blocks; the detailed miniature arrives as a bitmap
     dc.SetPen(*wxTRANSPARENT_PEN);
     dc.SetBrush(wxBrush(wxColour(c.bg_app.to_rgba_string())));
     dc.DrawRectangle(area);
 
-    // ---- Header bar (top 18px) ----
-    wxRect header_rect(area.GetLeft(), area.GetTop(), area.GetWidth(), 18);
     dc.SetBrush(wxBrush(wxColour(c.bg_header.to_rgba_string())));
-    dc.DrawRectangle(header_rect);
-
-    // Two colored dots in header
-    int dot_y = header_rect.GetTop() + 7;
-    dc.SetBrush(wxBrush(wxColour(c.accent_primary.to_rgba_string())));
-    dc.DrawCircle(area.GetLeft() + 10, dot_y, 3);
-    dc.SetBrush(wxBrush(wxColour(c.accent_secondary.to_rgba_string())));
-    dc.DrawCircle(area.GetLeft() + 20, dot_y, 3);
-
-    // Small text bar in header
-    dc.SetBrush(wxBrush(wxColour(c.text_muted.to_rgba_string())));
-    dc.DrawRectangle(area.GetLeft() + 32, dot_y - 2, 40, 4);
+    dc.DrawRectangle(area.GetLeft(), area.GetTop(), area.GetWidth(), 18);
 
-    // ---- Body (below header) ----
-    int body_top = header_rect.GetBottom();
-    int body_height = area.GetBottom() - body_top;
-
-    // Sidebar (left 60px)
-    int sidebar_width = 60;
-    wxRect sidebar_rect(area.GetLeft(), body_top, sidebar_width, body_height);
     dc.SetBrush(wxBrush(wxColour(c.bg_panel.to_rgba_string())));
-    dc.DrawRectangle(sidebar_rect);
-
-    // Sidebar text bars
-    dc.SetBrush(wxBrush(wxColour(c.text_muted.to_rgba_string())));
-    dc.DrawRectangle(sidebar_rect.GetLeft() + 6, body_top + 8, 36, 3);
-    dc.DrawRectangle(sidebar_rect.GetLeft() + 6, body_top + 16, 28, 3);
-    dc.DrawRectangle(sidebar_rect.GetLeft() + 6, body_top + 24, 42, 3);
-
-    // ---- Content area (right of sidebar) ----
-    int content_left = area.GetLeft() + sidebar_width + 1;
-    int content_width = area.GetWidth() - sidebar_width - 1;
-
-    // Content background
-    dc.SetBrush(wxBrush(wxColour(c.bg_input.to_rgba_string())));
-    dc.DrawRectangle(content_left, body_top, content_width, body_height);
-
-    // Heading line (accent_primary)
-    dc.SetBrush(wxBrush(wxColour(c.accent_primary.to_rgba_string())));
-    dc.DrawRectangle(content_left + 8, body_top + 8, 80, 4);
-
-    // Body text lines (text_main)
-    dc.SetBrush(wxBrush(wxColour(c.text_main.to_rgba_string())));
-    dc.DrawRectangle(content_left + 8, body_top + 18, 120, 3);
-    dc.DrawRectangle(content_left + 8, body_top + 26, 100, 3);
-    dc.DrawRectangle(content_left + 8, body_top + 34, 110, 3);
-    dc.DrawRectangle(content_left + 8, body_top + 42, 60, 3);
-
-    // Second heading
-    dc.SetBrush(wxBrush(wxColour(c.accent_primary.to_rgba_string())));
-    dc.DrawRectangle(content_left + 8, body_top + 52, 70, 4);
-
-    // More body lines
-    dc.SetBrush(wxBrush(wxColour(c.text_main.to_rgba_string())));
-    dc.DrawRectangle(content_left + 8, body_top + 62, 115, 3);
-    dc.DrawRectangle(content_left + 8, body_top + 70, 90, 3);
+    dc.DrawRectangle(area.GetLeft(), area.GetTop() + 17, 60, area.GetHeight() - 18);
 }
 
 void ThemePreviewCard::DrawFooter(wxDC& dc, const wxRect& area)
@@ -2,6 +2,7 @@
 
 #include "core/Theme.h"
 
+#include <wx/bitmap.h>
 #include <wx/panel.h>
 
 #include <functional>
@@ -10,16 +11,29 @@
 namespace markamp::ui
 {
 
-/// A custom-drawn card that renders a miniature MarkAmp UI preview using a
+/// A custom-drawn card that shows a miniature MarkAmp UI preview in a
 /// theme's own colors, with an active checkmark badge, hover border
 /// highlight, and click/export/delete callbacks.
+///
+/// The miniature itself is a bitmap rendered off the UI thread by
+/// core::ThemePreviewRenderer; until SetPreview() delivers it the card
+/// paints a flat placeholder. ThemeGallery recycles cards as they scroll
+/// out of view by rebinding them with SetTheme().
 class ThemePreviewCard : public wxPanel
 {
 public:
     ThemePreviewCard(wxWindow* parent, const core::Theme& theme, bool is_active, bool is_builtin);
 
+    /// Show another theme, dropping the current preview bitmap.
+    void SetTheme(const core::Theme& theme, bool is_active, bool is_builtin);
+
+    /// Show the rendered miniature (kPreviewImageWidth x kPreviewImageHeight).
+    void SetPreview(const wxBitmap& preview);
+    [[nodiscard]] auto HasPreview() const -> bool;
+
     void SetActive(bool active);
     [[nodiscard]] auto IsActive() const -> bool;
+    [[nodiscard]] auto GetTheme() const -> const core::Theme&;
     [[nodiscard]] auto GetThemeId() const -> std::string;
     [[nodiscard]] auto GetThemeName() const -> std::string;
     [[nodiscard]] auto IsBuiltin() const -> bool;
@@ -39,8 +53,13 @@ public:
     static constexpr int kBorderWidth = 2;
     static constexpr int kBadgeSize = 20;
 
+    // Size of the miniature inside the border
+    static constexpr int kPreviewImageWidth = kCardWidth - kBorderWidth * 2;
+    static constexpr int kPreviewImageHeight = kPreviewHeight - kBorderWidth;
+
 private:
     core::Theme theme_;
+    wxBitmap preview_;
     bool is_active_{false};
     bool is_builtin_{false};
     bool is_hovered_{false};
@@ -49,7 +68,7 @@ private:
 
     // Painting
     void OnPaint(wxPaintEvent& event);
-    void DrawMiniPreview(wxDC& dc, const wxRect& area);
+    void DrawPlaceholder(wxDC& dc, const wxRect& area);
     void DrawFooter(wxDC& dc, const wxRect& area);
     void DrawActiveIndicator(wxDC& dc);
     void DrawExportButton(wxDC& dc, const wxRect& area);
@@ -1,17 +1,77 @@
+#include "core/DocumentSnapshot.h"
+#include "core/DocumentTextView.h"
 #include "core/HtmlSanitizer.h"
 #include "core/MarkdownParser.h"
+#include "core/Md4cWrapper.h"
 #include "core/Profiler.h"
 #include "rendering/HtmlRenderer.h"
+#include "rendering/IncrementalRenderer.h"
 
 #include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
 #include <sstream>
 #include <string>
+#include <string_view>
+
+// ═══════════════════════════════════════════════════════
+// Allocation counting
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+std::atomic<std::size_t> g_allocations{0};
+} // namespace
+
+auto operator new(std::size_t size) -> void*
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+auto operator new(std::size_t size, const std::nothrow_t& /*tag*/) noexcept -> void*
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t /*size*/) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t& /*tag*/) noexcept
+{
+    std::free(memory);
+}
 
 namespace
 {
 
+/// Heap allocations made while running `work`.
+template <typename Work>
+auto count_allocations(Work&& work) -> std::size_t
+{
+    const auto before = g_allocations.load(std::memory_order_relaxed);
+    work();
+    return g_allocations.load(std::memory_order_relaxed) - before;
+}
+
 /// Generate realistic mixed-content markdown with the given number of lines.
 auto generate_markdown(int line_count) -> std::string
 {
@@ -58,6 +118,21 @@ auto generate_markdown(int line_count) -> std::string
     return oss.str();
 }
 
+/// Heap bytes of an MdNode tree beyond the root object itself.
+auto tree_bytes(const markamp::core::MdNode& node) -> std::size_t
+{
+    auto heap = [](const std::string& text)
+    { return text.capacity() > std::string().capacity() ? text.capacity() + 1 : 0; };
+    std::size_t bytes = heap(node.text_content) + heap(node.language) + heap(node.info_string) +
+                        heap(node.url) + heap(node.title) +
+                        node.children.capacity() * sizeof(markamp::core::MdNode);
+    for (const auto& child : node.children)
+    {
+        bytes += tree_bytes(child);
+    }
+    return bytes;
+}
+
 } // namespace
 
 // ═══════════════════════════════════════════════════════
@@ -97,6 +172,81 @@ TEST_CASE("Benchmark: Markdown parse 10000 lines", "[benchmark][parse]")
     };
 }
 
+TEST_CASE("Benchmark: Edit one line in 10000", "[benchmark][parse][incremental]")
+{
+    auto markdown = generate_markdown(10000);
+    // Line 5003 is a plain paragraph; toggling one word edits exactly one block
+    auto edited = markdown;
+    auto pos = edited.find("for line 5003.");
+    REQUIRE(pos != std::string::npos);
+    edited.replace(pos, 3, "FOR");
+
+    markamp::core::MarkdownParser parser;
+    markamp::rendering::HtmlRenderer full_renderer;
+    bool flip = false;
+
+    BENCHMARK("full_reparse_edit_one_line_10000")
+    {
+        flip = !flip;
+        auto doc = parser.parse(flip ? edited : markdown);
+        return full_renderer.render(*doc);
+    };
+
+    markamp::rendering::HtmlRenderer block_renderer;
+    markamp::rendering::IncrementalRenderer incremental(block_renderer);
+    REQUIRE(incremental.render(markdown).has_value());
+    REQUIRE(incremental.render(edited).has_value());
+    CHECK(incremental.last_stats().blocks_rendered == 1);
+
+    flip = true;
+    BENCHMARK("incremental_edit_one_line_10000")
+    {
+        flip = !flip;
+        return incremental.render(flip ? edited : markdown);
+    };
+}
+
+// ═══════════════════════════════════════════════════════
+// Flat AST Benchmarks
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("Benchmark: MdNode tree vs flat AST", "[benchmark][parse][flat_markdown]")
+{
+    // WARN lines report the AST memory and one timed parse per size
+    markamp::core::Md4cParser parser;
+    for (const int lines : {10000, 100000})
+    {
+        const auto markdown = generate_markdown(lines);
+
+        auto start = std::chrono::steady_clock::now();
+        auto tree = parser.parse(markdown);
+        const std::chrono::duration<double, std::milli> tree_time =
+            std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        auto flat = parser.parse_flat(markdown);
+        const std::chrono::duration<double, std::milli> flat_time =
+            std::chrono::steady_clock::now() - start;
+
+        REQUIRE(tree.has_value());
+        REQUIRE(flat.has_value());
+        WARN(lines << " lines: MdNode tree "
+                   << (sizeof(markamp::core::MdNode) + tree_bytes(tree->root)) / 1024 << " KB in "
+                   << tree_time.count() << " ms, flat " << flat->memory_bytes() / 1024 << " KB in "
+                   << flat_time.count() << " ms");
+    }
+
+    const auto markdown = generate_markdown(100000);
+    BENCHMARK("parse_tree_100000_lines")
+    {
+        return parser.parse(markdown)->root.children.size();
+    };
+    BENCHMARK("parse_flat_100000_lines")
+    {
+        return parser.parse_flat(markdown)->nodes().size();
+    };
+}
+
 // ═══════════════════════════════════════════════════════
 // HTML Render Benchmarks
 // ═══════════════════════════════════════════════════════
@@ -193,6 +343,54 @@ TEST_CASE("Benchmark: HtmlSanitizer 1K lines", "[benchmark][sanitizer]")
     };
 }
 
+TEST_CASE("Benchmark: Streamed render vs render + sanitize", "[benchmark][render][sanitizer]")
+{
+    // WARN reports allocations and time for one warm render of each kind
+    auto markdown = generate_markdown(10000);
+    markamp::core::MarkdownParser parser;
+    auto doc = parser.parse(markdown);
+    REQUIRE(doc.has_value());
+
+    markamp::rendering::HtmlRenderer renderer;
+    markamp::core::HtmlSanitizer sanitizer;
+    std::string output;
+    renderer.render_into(*doc, output, &sanitizer);
+
+    std::string copied;
+    auto start = std::chrono::steady_clock::now();
+    const auto copying_allocations =
+        count_allocations([&] { copied = sanitizer.sanitize(renderer.render(*doc)); });
+    const std::chrono::duration<double, std::milli> copying_time =
+        std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    const auto streamed_allocations = count_allocations(
+        [&]
+        {
+            output.clear();
+            renderer.render_into(*doc, output, &sanitizer);
+        });
+    const std::chrono::duration<double, std::milli> streamed_time =
+        std::chrono::steady_clock::now() - start;
+
+    CHECK(output == copied);
+    WARN("10000 lines: render + sanitize " << copying_allocations << " allocations in "
+                                           << copying_time.count() << " ms, streamed "
+                                           << streamed_allocations << " allocations in "
+                                           << streamed_time.count() << " ms");
+
+    BENCHMARK("render_sanitize_10000_lines")
+    {
+        return sanitizer.sanitize(renderer.render(*doc)).size();
+    };
+    BENCHMARK("render_into_reused_buffer_10000_lines")
+    {
+        output.clear();
+        renderer.render_into(*doc, output, &sanitizer);
+        return output.size();
+    };
+}
+
 // ═══════════════════════════════════════════════════════
 // Footnote Preprocessor Benchmarks (Improvement 29)
 // ═══════════════════════════════════════════════════════
@@ -212,3 +410,67 @@ TEST_CASE("Benchmark: FootnotePreprocessor 1K lines", "[benchmark][footnote]")
         return processor.process(markdown);
     };
 }
+
+// ═══════════════════════════════════════════════════════
+// Editor Text Access Benchmarks
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("Benchmark: Text bytes copied per keystroke", "[benchmark][copy]")
+{
+    using markamp::core::DocumentTextView;
+    using markamp::core::TextCopyCounter;
+
+    // What EditorPanel does for one typed character: record the insertion
+    // as a delta, count words for the status bar, and offer a lazy snapshot
+    // that the preview may pull
+    std::string buffer = generate_markdown(10000);
+    uint64_t version = 0;
+    const auto position = buffer.size() / 2;
+
+    auto keystroke = [&](bool preview_pulls) -> int
+    {
+        buffer.insert(position, "x");
+        ++version;
+        const DocumentTextView view(buffer, version, &version);
+        const DocumentTextView inserted(
+            std::string_view(buffer).substr(position, 1), version, &version);
+        const auto delta = inserted.to_string();
+
+        int words = 0;
+        bool in_word = false;
+        for (const char chr : view.text())
+        {
+            const bool is_space = std::isspace(static_cast<unsigned char>(chr)) != 0;
+            words += !is_space && !in_word ? 1 : 0;
+            in_word = !is_space;
+        }
+
+        const markamp::core::LazyDocumentSnapshot snapshot(
+            version, [&]() { return DocumentTextView(buffer, version, &version).snapshot(); });
+        if (preview_pulls)
+        {
+            static_cast<void>(snapshot.content());
+        }
+        return words + static_cast<int>(delta.size());
+    };
+
+    auto bytes_copied = [&](bool preview_pulls)
+    {
+        const auto before = TextCopyCounter::bytes();
+        static_cast<void>(keystroke(preview_pulls));
+        return TextCopyCounter::bytes() - before;
+    };
+
+    // Only the typed character is copied unless someone needs the text
+    const auto without_preview = bytes_copied(false);
+    const auto with_preview = bytes_copied(true);
+    INFO("Bytes copied per keystroke: " << without_preview << " (no preview), " << with_preview
+                                        << " (preview pulls the snapshot)");
+    CHECK(without_preview == 1);
+    CHECK(with_preview == 1 + buffer.size());
+
+    BENCHMARK("keystroke_text_access_10000_lines")
+    {
+        return keystroke(false);
+    };
+}
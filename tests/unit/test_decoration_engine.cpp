@@ -0,0 +1,269 @@
+#include "core/DecorationEngine.h"
+#include "core/DecorationService.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace markamp::core;
+
+namespace
+{
+
+/// Lines with their endings, as the editor hands them out.
+struct Document
+{
+    std::vector<std::string> lines;
+    std::size_t reads{0};
+
+    auto reader() -> DecorationEngine::LineText
+    {
+        return [this](std::size_t line)
+        {
+            ++reads;
+            return line < lines.size() ? std::string_view(lines[line]) : std::string_view{};
+        };
+    }
+};
+
+auto kinds(const std::vector<StyleRun>& runs) -> std::vector<OverlayKind>
+{
+    std::vector<OverlayKind> result;
+    for (const auto& run : runs)
+    {
+        result.push_back(static_cast<OverlayKind>(run.style_id));
+    }
+    return result;
+}
+
+auto find_line(const std::vector<LineDecorations>& lines, std::size_t line)
+    -> const LineDecorations*
+{
+    for (const auto& decorated : lines)
+    {
+        if (decorated.line == line)
+        {
+            return &decorated;
+        }
+    }
+    return nullptr;
+}
+
+auto numbered_document(std::size_t count) -> Document
+{
+    Document doc;
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        doc.lines.push_back("line " + std::to_string(index) + "\n");
+    }
+    return doc;
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Line scanning
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("DecorationEngine: scans the built-in overlays of a line", "[decoration]")
+{
+    const auto runs = DecorationEngine::scan_line("- [x] see[^1] <b>bold</b>  \r\n");
+    CHECK(kinds(runs) == std::vector<OverlayKind>{OverlayKind::TaskCheckbox,
+                                                  OverlayKind::Footnote,
+                                                  OverlayKind::HtmlTag,
+                                                  OverlayKind::HtmlTag,
+                                                  OverlayKind::TrailingWhitespace});
+    REQUIRE(runs.size() == 5);
+    CHECK(runs[0].start == 0);
+    CHECK(runs[0].length == 5);
+    CHECK(runs[1].start == 9);
+    CHECK(runs[1].length == 4);
+    CHECK(runs[4].start == 25);
+    CHECK(runs[4].length == 2);
+
+    const auto quote = DecorationEngine::scan_line("> > nested\n");
+    REQUIRE(quote.size() == 1);
+    CHECK(quote[0].style_id == static_cast<uint16_t>(OverlayKind::BlockquoteNest));
+    CHECK(quote[0].length == 4);
+
+    CHECK(DecorationEngine::scan_line("> single\n").empty());
+    CHECK(DecorationEngine::scan_line("a < b and 3 > 2\n").empty());
+}
+
+TEST_CASE("DecorationEngine: word occurrences are whole-word and case-sensitive", "[decoration]")
+{
+    std::vector<StyleRun> runs;
+    DecorationEngine::find_word("foo food foo_bar Foo (foo)", "foo", runs);
+    REQUIRE(runs.size() == 2);
+    CHECK(runs[0].start == 0);
+    CHECK(runs[1].start == 22);
+}
+
+// ═══════════════════════════════════════════════════════
+// Viewport updates
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("DecorationEngine: only the viewport and its margin are decorated", "[decoration]")
+{
+    auto doc = numbered_document(20'000);
+    DecorationEngine engine;
+    engine.reset(doc.lines.size());
+
+    const auto first = engine.update(10'000, 10'060, doc.reader());
+    CHECK(first.size() == 60 + 2 * DecorationEngine::kViewportMargin);
+    CHECK(first.front().line == 10'000 - DecorationEngine::kViewportMargin);
+    CHECK(doc.reads == first.size() + 1); // Plus line 0 for the frontmatter check
+
+    // Caret moves without edits touch nothing
+    doc.reads = 0;
+    CHECK(engine.update(10'000, 10'060, doc.reader()).empty());
+    CHECK(doc.reads == 0);
+
+    // A short scroll decorates only the newly exposed lines
+    const auto scrolled = engine.update(10'010, 10'070, doc.reader());
+    CHECK(scrolled.size() == 10);
+    CHECK(scrolled.front().line == 10'070 + DecorationEngine::kViewportMargin - 10);
+}
+
+TEST_CASE("DecorationEngine: edits invalidate only the touched lines", "[decoration]")
+{
+    auto doc = numbered_document(500);
+    DecorationEngine engine;
+    engine.reset(doc.lines.size());
+    static_cast<void>(engine.update(200, 260, doc.reader()));
+    const auto scanned = engine.stats().lines_scanned;
+
+    // Type trailing spaces on line 230
+    doc.lines[230] = "line 230  \n";
+    engine.on_lines_changed(230, 0);
+    engine.set_caret_line(100);
+    auto changed = engine.update(200, 260, doc.reader());
+    REQUIRE(changed.size() == 1);
+    CHECK(changed[0].line == 230);
+    CHECK(kinds(changed[0].runs) == std::vector<OverlayKind>{OverlayKind::TrailingWhitespace});
+    CHECK(engine.stats().lines_scanned == scanned + 1);
+
+    // Split line 210: the lines below keep their cached decorations
+    doc.lines[210] = "li\n";
+    doc.lines.insert(doc.lines.begin() + 211, "ne 210\n");
+    engine.on_lines_changed(210, 1);
+    changed = engine.update(200, 260, doc.reader());
+    REQUIRE(changed.size() == 2);
+    CHECK(changed[0].line == 210);
+    CHECK(changed[1].line == 211);
+
+    // Join them again
+    doc.lines[210] = "line 210\n";
+    doc.lines.erase(doc.lines.begin() + 211);
+    engine.on_lines_changed(210, -1);
+    changed = engine.update(200, 260, doc.reader());
+    REQUIRE(changed.size() == 1);
+    CHECK(changed[0].line == 210);
+    CHECK(engine.line_count() == 500);
+}
+
+TEST_CASE("DecorationEngine: trailing whitespace is hidden on the caret line", "[decoration]")
+{
+    Document doc{{"one  \n", "two  \n", "three\n"}};
+    DecorationEngine engine;
+    engine.reset(doc.lines.size());
+    engine.set_caret_line(0);
+
+    auto lines = engine.update(0, 3, doc.reader());
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[0].runs.empty());
+    CHECK(lines[1].runs.size() == 1);
+
+    // Moving the caret re-emits the two lines involved
+    engine.set_caret_line(1);
+    lines = engine.update(0, 3, doc.reader());
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[0].runs.size() == 1);
+    CHECK(lines[1].runs.empty());
+
+    engine.set_trailing_whitespace(false);
+    lines = engine.update(0, 3, doc.reader());
+    CHECK(lines.size() == 3);
+    CHECK(lines[0].runs.empty());
+}
+
+TEST_CASE("DecorationEngine: a new highlight word re-emits the viewport", "[decoration]")
+{
+    Document doc{{"alpha beta\n", "beta gamma\n", "delta\n"}};
+    DecorationEngine engine;
+    engine.reset(doc.lines.size());
+    static_cast<void>(engine.update(0, 3, doc.reader()));
+
+    engine.set_highlight_word("beta");
+    auto lines = engine.update(0, 3, doc.reader());
+    REQUIRE(lines.size() == 3);
+    CHECK(kinds(lines[0].runs) == std::vector<OverlayKind>{OverlayKind::WordHighlight});
+    CHECK(lines[0].runs[0].start == 6);
+    CHECK(lines[1].runs[0].start == 0);
+    CHECK(lines[2].runs.empty());
+
+    // Same word: nothing to do; too short: cleared like no word
+    engine.set_highlight_word("beta");
+    CHECK(engine.update(0, 3, doc.reader()).empty());
+    engine.set_highlight_word("a");
+    lines = engine.update(0, 3, doc.reader());
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[0].runs.empty());
+}
+
+TEST_CASE("DecorationEngine: YAML frontmatter spans whole lines", "[decoration]")
+{
+    Document doc{{"---\n", "title: x\n", "---\n", "body\n"}};
+    DecorationEngine engine;
+    engine.reset(doc.lines.size());
+
+    auto lines = engine.update(0, 4, doc.reader());
+    REQUIRE(lines.size() == 4);
+    for (std::size_t line = 0; line < 3; ++line)
+    {
+        REQUIRE(lines[line].runs.size() == 1);
+        CHECK(lines[line].runs[0].style_id == static_cast<uint16_t>(OverlayKind::YamlFrontmatter));
+        CHECK(lines[line].runs[0].length == doc.lines[line].size());
+    }
+    CHECK(lines[3].runs.empty());
+
+    // Breaking the closing fence removes the block
+    doc.lines[2] = "--\n";
+    engine.on_lines_changed(2, 0);
+    lines = engine.update(0, 4, doc.reader());
+    REQUIRE(lines.size() == 3);
+    CHECK(lines[0].runs.empty());
+}
+
+// ═══════════════════════════════════════════════════════
+// Extension decorations
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("DecorationEngine: extension decorations take the same path", "[decoration]")
+{
+    Document doc{{"first line\n", "second\n", "third\n"}};
+    DecorationService service;
+    const auto handle = service.create_decoration_type({});
+    service.set_decorations("file:///a.md", handle, {{0, 6, 1, 3, ""}});
+
+    DecorationEngine engine;
+    engine.reset(doc.lines.size());
+    static_cast<void>(engine.update(0, 3, doc.reader()));
+    engine.set_extension_decorations(service, "file:///a.md");
+
+    const auto lines = engine.update(0, 3, doc.reader());
+    const auto* first = find_line(lines, 0);
+    const auto* second = find_line(lines, 1);
+    REQUIRE(first != nullptr);
+    REQUIRE(second != nullptr);
+    REQUIRE(first->runs.size() == 1);
+    CHECK(first->runs[0].style_id == DecorationEngine::kExtensionStyleBase + handle);
+    CHECK(first->runs[0].start == 6);
+    CHECK(first->runs[0].length == doc.lines[0].size() - 6); // To the end of the line
+    REQUIRE(second->runs.size() == 1);
+    CHECK(second->runs[0].start == 0);
+    CHECK(second->runs[0].length == 3);
+    CHECK(find_line(lines, 2)->runs.empty());
+}
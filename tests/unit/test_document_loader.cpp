@@ -0,0 +1,380 @@
+#include "core/DocumentLoader.h"
+#include "core/EncodingDetector.h"
+#include "core/MappedFile.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace markamp::core;
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/// A scratch file, removed on destruction.
+class TempFile
+{
+public:
+    TempFile(const std::string& name, std::string_view content)
+        : path_(fs::temp_directory_path() / ("markamp_doc_loader_" + name))
+    {
+        std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+
+    ~TempFile()
+    {
+        std::error_code error;
+        fs::remove(path_, error);
+    }
+
+    TempFile(const TempFile&) = delete;
+    auto operator=(const TempFile&) -> TempFile& = delete;
+
+    [[nodiscard]] auto path() const -> const fs::path&
+    {
+        return path_;
+    }
+
+private:
+    fs::path path_;
+};
+
+auto make_text(std::size_t lines) -> std::string
+{
+    std::string text;
+    for (std::size_t line = 0; line < lines; ++line)
+    {
+        text += "Line " + std::to_string(line) + " with caf\xC3\xA9 and \xE2\x82\xAC signs\n";
+    }
+    return text;
+}
+
+/// Wait for a DocumentLoader callback.
+struct LoadResult
+{
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    bool done{false};
+    std::shared_ptr<const LoadedDocument> document;
+    std::string error;
+
+    void set(std::shared_ptr<const LoadedDocument> loaded, std::string message)
+    {
+        const std::lock_guard lock(mutex);
+        document = std::move(loaded);
+        error = std::move(message);
+        done = true;
+        done_cv.notify_all();
+    }
+
+    auto wait() -> bool
+    {
+        std::unique_lock lock(mutex);
+        return done_cv.wait_for(lock, std::chrono::seconds(10), [this] { return done; });
+    }
+};
+
+} // anonymous namespace
+
+// ═══════════════════════════════════════════════════════
+// MappedFile
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("MappedFile: mapped and read files have the same bytes", "[document_loader]")
+{
+    const auto content = make_text(2000);
+    const TempFile file("bytes.md", content);
+
+    auto mapped = MappedFile::open(file.path(), 0);
+    auto read = MappedFile::open(file.path(), content.size() + 1);
+    REQUIRE(mapped.has_value());
+    REQUIRE(read.has_value());
+    REQUIRE_FALSE(read->is_mapped());
+#if defined(__unix__) || defined(__APPLE__)
+    REQUIRE(mapped->is_mapped());
+#endif
+    REQUIRE(mapped->bytes() == content);
+    REQUIRE(read->bytes() == content);
+
+    SECTION("Moving keeps the view valid")
+    {
+        const auto* data = mapped->bytes().data();
+        MappedFile moved = std::move(*mapped);
+        REQUIRE(moved.bytes().data() == data);
+        REQUIRE(moved.bytes() == content);
+    }
+}
+
+TEST_CASE("MappedFile: empty and missing files", "[document_loader]")
+{
+    const TempFile empty("empty.md", "");
+    auto opened = MappedFile::open(empty.path(), 0);
+    REQUIRE(opened.has_value());
+    REQUIRE(opened->bytes().empty());
+
+    auto missing = MappedFile::open(fs::temp_directory_path() / "markamp_doc_loader_missing.md");
+    REQUIRE_FALSE(missing.has_value());
+    REQUIRE(missing.error().find("Cannot open file") != std::string::npos);
+}
+
+// ═══════════════════════════════════════════════════════
+// Encoding helpers
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("EncodingDetector: bom_length and to_utf8", "[document_loader]")
+{
+    REQUIRE(bom_length("\xEF\xBB\xBFhi", Encoding::Utf8Bom) == 3);
+    REQUIRE(bom_length("\xFF\xFEh\0", Encoding::Utf16LE) == 2);
+    REQUIRE(bom_length("plain", Encoding::Ascii) == 0);
+    REQUIRE(bom_length("\xEF", Encoding::Utf8Bom) == 0);
+
+    using namespace std::string_view_literals;
+    REQUIRE(to_utf8("h\0i\0"sv, Encoding::Utf16LE) == "hi");
+    REQUIRE(to_utf8("\0h\0i"sv, Encoding::Utf16BE) == "hi");
+    // U+20AC and U+1F600 (surrogate pair)
+    REQUIRE(to_utf8("\xAC\x20\x3D\xD8\x00\xDE"sv, Encoding::Utf16LE) ==
+            "\xE2\x82\xAC\xF0\x9F\x98\x80");
+    // Lone surrogate and odd trailing byte become U+FFFD
+    REQUIRE(to_utf8("\x00\xD8x"sv, Encoding::Utf16LE) == "\xEF\xBF\xBD\xEF\xBF\xBD");
+    REQUIRE(to_utf8("caf\xE9", Encoding::Unknown) == "caf\xC3\xA9");
+    REQUIRE(to_utf8("same", Encoding::Utf8) == "same");
+}
+
+// ═══════════════════════════════════════════════════════
+// load_document
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("load_document: UTF-8 text is used in place", "[document_loader]")
+{
+    const auto content = make_text(100);
+    const TempFile file("bom.md", "\xEF\xBB\xBF" + content);
+
+    auto document = load_document(file.path(), 0);
+    REQUIRE(document.has_value());
+    const auto& loaded = **document;
+    REQUIRE(loaded.encoding.encoding == Encoding::Utf8Bom);
+    REQUIRE(loaded.bom_bytes == 3);
+    REQUIRE(loaded.text() == content);
+    REQUIRE(loaded.converted.empty());
+
+    // No copy: the text is a view of the file's bytes
+    const auto bytes = loaded.file.bytes();
+    REQUIRE(loaded.text().data() == bytes.data() + 3);
+    REQUIRE_FALSE(loaded.has_crlf);
+}
+
+TEST_CASE("load_document: UTF-16 and Latin-1 are converted", "[document_loader]")
+{
+    using namespace std::string_view_literals;
+
+    SECTION("UTF-16 LE")
+    {
+        const TempFile file("utf16le.md", "\xFF\xFE#\0 \0T\0i\0\r\0\n\0"sv);
+        auto document = load_document(file.path());
+        REQUIRE(document.has_value());
+        REQUIRE((*document)->encoding.encoding == Encoding::Utf16LE);
+        REQUIRE((*document)->text() == "# Ti\r\n");
+        REQUIRE((*document)->has_crlf);
+    }
+
+    SECTION("UTF-16 BE")
+    {
+        const TempFile file("utf16be.md", "\xFE\xFF\0#\0 \0\xE9"sv);
+        auto document = load_document(file.path());
+        REQUIRE(document.has_value());
+        REQUIRE((*document)->text() == "# \xC3\xA9");
+    }
+
+    SECTION("Latin-1")
+    {
+        const TempFile file("latin1.md", "caf\xE9\n");
+        auto document = load_document(file.path());
+        REQUIRE(document.has_value());
+        REQUIRE((*document)->encoding.encoding == Encoding::Unknown);
+        REQUIRE((*document)->text() == "caf\xC3\xA9\n");
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// next_text_chunk_end
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("next_text_chunk_end: pieces cover the text on safe boundaries", "[document_loader]")
+{
+    const auto text = make_text(500);
+    constexpr std::size_t kMaxBytes = 300;
+
+    std::string joined;
+    std::size_t offset = 0;
+    std::size_t pieces = 0;
+    while (offset < text.size())
+    {
+        const auto end = next_text_chunk_end(text, offset, kMaxBytes);
+        REQUIRE(end > offset);
+        REQUIRE(end - offset <= kMaxBytes);
+        if (end < text.size())
+        {
+            // Lines are shorter than half the window, so pieces end on newlines
+            REQUIRE(text[end - 1] == '\n');
+        }
+        joined.append(text, offset, end - offset);
+        offset = end;
+        ++pieces;
+    }
+    REQUIRE(joined == text);
+    REQUIRE(pieces > text.size() / kMaxBytes);
+}
+
+TEST_CASE("next_text_chunk_end: never splits a UTF-8 sequence", "[document_loader]")
+{
+    // One long line of 3-byte characters
+    std::string text;
+    for (int index = 0; index < 1000; ++index)
+    {
+        text += "\xE2\x82\xAC";
+    }
+
+    for (const std::size_t max_bytes : {1UL, 2UL, 4UL, 100UL, 1000UL})
+    {
+        std::size_t offset = 0;
+        while (offset < text.size())
+        {
+            const auto end = next_text_chunk_end(text, offset, max_bytes);
+            REQUIRE(end > offset);
+            REQUIRE((end - offset) % 3 == 0);
+            REQUIRE(end - offset <= std::max<std::size_t>(max_bytes, 3));
+            offset = end;
+        }
+    }
+
+    REQUIRE(next_text_chunk_end(text, text.size(), 10) == text.size());
+    REQUIRE(next_text_chunk_end("short", 0, 100) == 5);
+}
+
+// ═══════════════════════════════════════════════════════
+// DocumentLoader
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("DocumentLoader: delivers the document off the calling thread", "[document_loader]")
+{
+    const auto content = make_text(5000);
+    const TempFile file("async.md", content);
+
+    LoadResult result;
+    const auto caller = std::this_thread::get_id();
+    std::thread::id callback_thread;
+    DocumentLoader loader(
+        file.path(),
+        [&](std::shared_ptr<const LoadedDocument> document)
+        {
+            callback_thread = std::this_thread::get_id();
+            result.set(std::move(document), {});
+        },
+        [&](std::string error) { result.set(nullptr, std::move(error)); });
+
+    REQUIRE(result.wait());
+    REQUIRE(result.error.empty());
+    REQUIRE(result.document != nullptr);
+    REQUIRE(result.document->text() == content);
+    REQUIRE(callback_thread != caller);
+
+    loader.cancel();
+    REQUIRE(loader.is_complete());
+}
+
+TEST_CASE("DocumentLoader: holds large files in memory, not mapped", "[document_loader]")
+{
+    // A mapping would fault if the file were truncated while streaming
+    const auto content = make_text(60000); // Above MappedFile::kDefaultMapThreshold
+    REQUIRE(content.size() > MappedFile::kDefaultMapThreshold);
+    const TempFile file("unmapped.md", content);
+
+    LoadResult result;
+    DocumentLoader loader(
+        file.path(),
+        [&](std::shared_ptr<const LoadedDocument> document)
+        { result.set(std::move(document), {}); },
+        [&](std::string error) { result.set(nullptr, std::move(error)); });
+
+    REQUIRE(result.wait());
+    REQUIRE(result.document != nullptr);
+    REQUIRE_FALSE(result.document->file.is_mapped());
+
+    // Shrinking the file leaves the delivered text intact
+    fs::resize_file(file.path(), 0);
+    REQUIRE(result.document->text() == content);
+}
+
+TEST_CASE("DocumentLoader: reports errors and honours cancel", "[document_loader]")
+{
+    SECTION("Missing file")
+    {
+        LoadResult result;
+        DocumentLoader loader(
+            fs::temp_directory_path() / "markamp_doc_loader_missing.md",
+            [&](std::shared_ptr<const LoadedDocument> document)
+            { result.set(std::move(document), {}); },
+            [&](std::string error) { result.set(nullptr, std::move(error)); });
+        REQUIRE(result.wait());
+        REQUIRE(result.document == nullptr);
+        REQUIRE_FALSE(result.error.empty());
+    }
+
+    SECTION("No callback after cancel")
+    {
+        const TempFile file("cancel.md", make_text(100));
+        for (int attempt = 0; attempt < 20; ++attempt)
+        {
+            std::atomic<int> calls{0};
+            DocumentLoader loader(
+                file.path(),
+                [&](std::shared_ptr<const LoadedDocument> /*document*/) { ++calls; },
+                [&](std::string /*error*/) { ++calls; });
+            loader.cancel();
+            const int after_cancel = calls.load();
+            REQUIRE(after_cancel <= 1);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            REQUIRE(calls.load() == after_cancel);
+            REQUIRE(loader.is_complete());
+        }
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// Benchmarks
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("Benchmark: load_document vs stream read", "[.][benchmark][document_loader]")
+{
+    const auto content = make_text(1'500'000); // ~64 MB
+    const TempFile file("bench.md", content);
+
+    BENCHMARK("istreambuf_iterator read")
+    {
+        std::ifstream stream(file.path());
+        return std::string(std::istreambuf_iterator<char>(stream),
+                           std::istreambuf_iterator<char>())
+            .size();
+    };
+
+    BENCHMARK("load_document (mapped)")
+    {
+        return (*load_document(file.path()))->text().size();
+    };
+}
@@ -0,0 +1,92 @@
+#include "core/DocumentTextView.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace markamp::core;
+
+// ═══════════════════════════════════════════════════════
+// DocumentTextView
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("DocumentTextView: borrows the text until the document changes", "[text_view]")
+{
+    std::string buffer = "# Title\n\nBody\n";
+    uint64_t version = 7;
+    const DocumentTextView view(buffer, version, &version);
+
+    REQUIRE(view.valid());
+    CHECK(view.text().data() == buffer.data()); // No copy
+    CHECK(view.size() == buffer.size());
+    CHECK(view.version() == 7);
+
+    ++version;
+    CHECK_FALSE(view.valid());
+    CHECK(view.text().empty());
+    CHECK(view.snapshot() == nullptr);
+
+    const DocumentTextView unbound;
+    CHECK_FALSE(unbound.valid());
+}
+
+TEST_CASE("DocumentTextView: snapshots are the one counted copy", "[text_view]")
+{
+    const std::string buffer(1000, 'a');
+    const uint64_t version = 1;
+    const DocumentTextView view(buffer, version, &version);
+
+    const auto bytes_before = TextCopyCounter::bytes();
+    const auto copies_before = TextCopyCounter::copies();
+    const auto snapshot = view.snapshot();
+    REQUIRE(snapshot != nullptr);
+    CHECK(*snapshot == buffer);
+    CHECK(snapshot->data() != buffer.data());
+    CHECK(TextCopyCounter::bytes() - bytes_before == 1000);
+    CHECK(TextCopyCounter::copies() - copies_before == 1);
+
+    // Reading through the view costs nothing
+    static_cast<void>(view.text().find('b'));
+    CHECK(TextCopyCounter::bytes() - bytes_before == 1000);
+}
+
+// ═══════════════════════════════════════════════════════
+// Line iteration
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("DocumentTextView: lines keep their endings", "[text_view]")
+{
+    const std::string buffer = "one\r\ntwo\n\nlast";
+    const uint64_t version = 1;
+    const DocumentTextView view(buffer, version, &version, 10);
+
+    std::vector<std::string_view> lines;
+    std::vector<std::size_t> numbers;
+    for (auto iter = view.lines(); iter.has_next();)
+    {
+        const auto span = iter.next();
+        lines.push_back(span.as_string_view());
+        numbers.push_back(span.logical_line);
+    }
+    CHECK(lines == std::vector<std::string_view>{"one\r\n", "two\n", "\n", "last"});
+    CHECK(numbers == std::vector<std::size_t>{10, 11, 12, 13});
+    CHECK(lines[0].data() == buffer.data());
+}
+
+TEST_CASE("DocumentTextView: a trailing newline ends the last line", "[text_view]")
+{
+    const std::string buffer = "a\nb\n";
+    const uint64_t version = 1;
+    const DocumentTextView view(buffer, version, &version);
+
+    auto iter = view.lines();
+    CHECK(iter.next().as_string_view() == "a\n");
+    CHECK(iter.next().as_string_view() == "b\n");
+    CHECK_FALSE(iter.has_next());
+    CHECK(iter.next().empty());
+
+    const DocumentTextView empty(std::string_view{}, version, &version);
+    CHECK_FALSE(empty.lines().has_next());
+}
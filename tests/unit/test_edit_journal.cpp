@@ -0,0 +1,193 @@
+#include "core/EditJournal.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+
+using namespace markamp::core;
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/// A scratch document and its journal, both removed on destruction.
+class TempDocument
+{
+public:
+    TempDocument(const std::string& name, std::string_view content)
+        : path_(fs::temp_directory_path() / ("markamp_edit_journal_" + name))
+    {
+        std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+
+    ~TempDocument()
+    {
+        std::error_code error;
+        fs::remove(path_, error);
+        fs::remove(EditJournal::journal_path(path_), error);
+    }
+
+    TempDocument(const TempDocument&) = delete;
+    auto operator=(const TempDocument&) -> TempDocument& = delete;
+
+    [[nodiscard]] auto path() const -> const fs::path&
+    {
+        return path_;
+    }
+
+private:
+    fs::path path_;
+};
+
+auto insert(std::size_t offset, std::string text) -> TextDelta
+{
+    return TextDelta{.offset = offset, .removed_length = 0, .inserted_text = std::move(text)};
+}
+
+auto remove(std::size_t offset, std::size_t length) -> TextDelta
+{
+    return TextDelta{.offset = offset, .removed_length = length, .inserted_text = {}};
+}
+
+auto journal_size(const fs::path& document) -> std::uintmax_t
+{
+    std::error_code error;
+    const auto size = fs::file_size(EditJournal::journal_path(document), error);
+    return error ? 0 : size;
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Logging and replay
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("EditJournal: edits replay onto the file on disk", "[edit_journal]")
+{
+    const TempDocument doc("replay.md", "# Title\n\nBody\n");
+    {
+        EditJournal journal;
+        journal.start(doc.path(), *JournalBase::of(doc.path()));
+        CHECK(journal.is_open(doc.path()));
+        journal.append(doc.path(), 1, insert(7, " one"));
+        journal.append(doc.path(), 2, remove(0, 2));
+        journal.append(doc.path(), 3, insert(0, "## "));
+        journal.flush();
+        CHECK(journal.stats().records == 3);
+        CHECK(journal.stats().syncs >= 1);
+    }
+
+    const auto recovered = EditJournal::recover(doc.path());
+    REQUIRE(recovered.has_value());
+    CHECK(recovered->text == "## Title one\n\nBody\n");
+    CHECK(recovered->edits == 3);
+    CHECK(recovered->version == 3);
+}
+
+TEST_CASE("EditJournal: journal size follows what was typed", "[edit_journal]")
+{
+    const TempDocument doc("proportional.md", std::string(4 * 1024 * 1024, 'x'));
+    EditJournal journal;
+    journal.start(doc.path(), *JournalBase::of(doc.path()));
+    for (std::size_t key = 0; key < 100; ++key)
+    {
+        journal.append(doc.path(), key + 1, insert(key, "a"));
+    }
+    journal.flush();
+
+    // 100 one-byte edits: a few KB, nothing like the 4 MB document
+    CHECK(journal.stats().bytes_written < 8 * 1024);
+    CHECK(journal_size(doc.path()) == journal.stats().bytes_written);
+    CHECK_FALSE(journal.needs_checkpoint(doc.path()));
+}
+
+TEST_CASE("EditJournal: a torn last record is dropped", "[edit_journal]")
+{
+    const TempDocument doc("torn.md", "abc");
+    {
+        EditJournal journal;
+        journal.start(doc.path(), *JournalBase::of(doc.path()));
+        journal.append(doc.path(), 1, insert(3, "def"));
+        journal.append(doc.path(), 2, insert(6, "ghi"));
+    }
+
+    // A crash mid-write: the second edit record loses its last bytes
+    const auto journal_file = EditJournal::journal_path(doc.path());
+    fs::resize_file(journal_file, fs::file_size(journal_file) - 2);
+
+    const auto recovered = EditJournal::recover(doc.path());
+    REQUIRE(recovered.has_value());
+    CHECK(recovered->text == "abcdef");
+    CHECK(recovered->edits == 1);
+}
+
+TEST_CASE("EditJournal: a file changed on disk is not replayed onto", "[edit_journal]")
+{
+    const TempDocument doc("changed.md", "before");
+    {
+        EditJournal journal;
+        journal.start(doc.path(), *JournalBase::of(doc.path()));
+        journal.append(doc.path(), 1, insert(0, "x"));
+    }
+    {
+        std::ofstream out(doc.path(), std::ios::binary | std::ios::trunc);
+        out << "rewritten elsewhere";
+    }
+    CHECK_FALSE(EditJournal::recover(doc.path()).has_value());
+}
+
+// ═══════════════════════════════════════════════════════
+// Checkpoints and discarding
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("EditJournal: checkpoints compact the journal", "[edit_journal]")
+{
+    const TempDocument doc("checkpoint.md", "seed");
+    EditJournal journal;
+    journal.start(doc.path(), *JournalBase::of(doc.path()));
+
+    // Past kCompactMinBytes of typing in a small document
+    std::string text = "seed";
+    const std::string chunk(64 * 1024, 'y');
+    for (std::size_t edit = 0; edit < 17; ++edit)
+    {
+        journal.append(doc.path(), edit + 1, insert(text.size(), chunk));
+        text += chunk;
+    }
+    REQUIRE(journal.needs_checkpoint(doc.path()));
+
+    journal.checkpoint(doc.path(), std::make_shared<const std::string>(text));
+    CHECK_FALSE(journal.needs_checkpoint(doc.path()));
+    journal.append(doc.path(), 18, remove(0, 4));
+    journal.flush();
+    CHECK(journal.stats().checkpoints == 1);
+    CHECK(journal_size(doc.path()) < text.size() + 1024);
+
+    const auto recovered = EditJournal::recover(doc.path());
+    REQUIRE(recovered.has_value());
+    CHECK(recovered->text == text.substr(4));
+    CHECK(recovered->edits == 1);
+    CHECK(recovered->version == 18);
+}
+
+TEST_CASE("EditJournal: discarding deletes the journal", "[edit_journal]")
+{
+    const TempDocument doc("discard.md", "text");
+    EditJournal journal;
+    journal.start(doc.path(), *JournalBase::of(doc.path()));
+    journal.append(doc.path(), 1, insert(0, "more "));
+    journal.discard(doc.path());
+    journal.append(doc.path(), 2, insert(0, "ignored"));
+    journal.flush();
+
+    CHECK_FALSE(journal.is_open(doc.path()));
+    CHECK_FALSE(fs::exists(EditJournal::journal_path(doc.path())));
+    CHECK_FALSE(EditJournal::recover(doc.path()).has_value());
+}
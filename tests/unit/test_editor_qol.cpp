@@ -1,4 +1,5 @@
 #include "core/Config.h"
+#include "core/DecorationService.h"
 #include "core/EventBus.h"
 #include "core/ThemeEngine.h"
 #include "ui/EditorPanel.h"
@@ -107,5 +108,33 @@ TEST_CASE("EditorPanel QoL Features", "[editor][qol]")
         REQUIRE(text.find(":") != std::string::npos);
     }
 
+    SECTION("Extension decorations show up as indicator ranges")
+    {
+        editor->SetContent("first line\nsecond\n");
+        markamp::core::DecorationService service;
+        const auto handle = service.create_decoration_type({});
+        editor->SetDecorationSource(&service, "file:///doc.md");
+
+        // From line 0 column 6 to line 1 column 3; other files are ignored
+        service.set_decorations("file:///doc.md", handle, {{0, 6, 1, 3, ""}});
+        service.set_decorations("file:///other.md", handle, {{0, 0, 0, 5, ""}});
+
+        auto* stc = editor->GetStyledTextCtrl();
+        constexpr int kIndicator = markamp::ui::EditorPanel::kIndicatorExtension;
+        CHECK(stc->IndicatorValueAt(kIndicator, 5) == 0);
+        CHECK(stc->IndicatorValueAt(kIndicator, 6) != 0);
+        CHECK(stc->IndicatorValueAt(kIndicator, 9) != 0);
+        const int second_line = stc->PositionFromLine(1);
+        CHECK(stc->IndicatorValueAt(kIndicator, second_line) != 0);
+        CHECK(stc->IndicatorValueAt(kIndicator, second_line + 2) != 0);
+        CHECK(stc->IndicatorValueAt(kIndicator, second_line + 3) == 0);
+
+        // Clearing the file's decorations removes the ranges
+        service.clear_file_decorations("file:///doc.md");
+        CHECK(stc->IndicatorValueAt(kIndicator, 6) == 0);
+
+        editor->SetDecorationSource(nullptr, {});
+    }
+
     frame->Destroy();
 }
@@ -1,14 +1,20 @@
 #include "core/Config.h"
 #include "core/EncodingDetector.h"
 #include "core/EventBus.h"
+#include "core/Events.h"
 #include "core/FileNode.h"
 #include "core/FileSystem.h"
+#include "core/FileWatcher.h"
 #include "core/RecentFiles.h"
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <thread>
 
 using namespace markamp::core;
 
@@ -391,7 +397,8 @@ TEST_CASE("FileSystem watch subscription lifecycle", "[filesystem]")
     tmp.write("watched.md", "initial");
 
     EventBus bus;
-    FileSystem fs(bus);
+    FileWatcherService watcher(bus);
+    FileSystem fs(bus, &watcher);
 
     bool called = false;
     {
@@ -399,8 +406,54 @@ TEST_CASE("FileSystem watch subscription lifecycle", "[filesystem]")
         // sub is alive here
     }
     // sub destroyed — watch should be removed
-    // (We can't easily test the timer polling, but we can verify subscription management)
-    REQUIRE_FALSE(called); // callback not invoked (no polling tick happened)
+    REQUIRE_FALSE(called); // callback not invoked (no change was delivered)
+}
+
+TEST_CASE("FileSystem watch delivers changes to the watched file only", "[filesystem]")
+{
+    TempDir tmp;
+    tmp.write("watched.md", "initial");
+
+    EventBus bus;
+    FileWatcherService watcher(bus);
+    FileSystem fs(bus, &watcher);
+
+    // The app watching the same folder shares the service, not the events
+    auto folder_watch = watcher.watch(tmp.path, false);
+    REQUIRE(folder_watch.has_value());
+    int batches = 0;
+    auto batch_sub = bus.subscribe<events::FileSystemChangedEvent>(
+        [&batches, target = (tmp.path / "watched.md").string()](
+            const events::FileSystemChangedEvent& event)
+        {
+            batches += static_cast<int>(std::count_if(event.changes.begin(),
+                                                      event.changes.end(),
+                                                      [&target](const FileChange& change)
+                                                      { return change.path == target; }));
+        });
+
+    int calls = 0;
+    auto sub = fs.watch_file(tmp.path / "watched.md", [&calls]() { ++calls; });
+    tmp.write("neighbour.md", "other");
+    tmp.write("watched.md", "changed");
+
+    // Changes arrive as queued bus events, drained like the app's idle loop
+    auto drain_for = [&bus](int rounds, const std::function<bool()>& done)
+    {
+        for (int round = 0; round < rounds && !done(); ++round)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            bus.process_queued();
+        }
+    };
+    drain_for(300, [&calls]() { return calls > 0; });
+    REQUIRE(calls == 1);
+    CHECK(batches == 1);
+
+    sub.cancel();
+    tmp.write("watched.md", "again");
+    drain_for(30, []() { return false; });
+    REQUIRE(calls == 1);
 }
 
 // ═══════════════════════════════════════════════════════
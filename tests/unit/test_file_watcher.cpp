@@ -0,0 +1,396 @@
+#include "core/EventBus.h"
+#include "core/Events.h"
+#include "core/FileWatcher.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace markamp::core;
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/// A scratch directory, removed on destruction.
+class TempTree
+{
+public:
+    explicit TempTree(const std::string& name)
+        : root_(fs::temp_directory_path() / ("markamp_watch_" + name))
+    {
+        fs::remove_all(root_);
+        fs::create_directories(root_);
+    }
+
+    ~TempTree()
+    {
+        std::error_code error;
+        fs::remove_all(root_, error);
+    }
+
+    TempTree(const TempTree&) = delete;
+    auto operator=(const TempTree&) -> TempTree& = delete;
+
+    void write(const std::string& relative, const std::string& text = "x") const
+    {
+        const auto path = root_ / relative;
+        fs::create_directories(path.parent_path());
+        std::ofstream out(path);
+        out << text;
+    }
+
+    [[nodiscard]] auto path(const std::string& relative = {}) const -> std::string
+    {
+        return relative.empty() ? root_.string() : (root_ / relative).string();
+    }
+
+private:
+    fs::path root_;
+};
+
+auto has_change(const std::vector<FileChange>& changes,
+                FileChangeKind kind,
+                const std::string& path) -> bool
+{
+    return std::any_of(changes.begin(),
+                       changes.end(),
+                       [&](const FileChange& change)
+                       { return change.kind == kind && change.path == path; });
+}
+
+/// Predicate for collect(): `path` was reported with `kind`.
+auto saw(FileChangeKind kind, std::string path)
+    -> std::function<bool(const std::vector<FileChange>&)>
+{
+    return [kind, path = std::move(path)](const std::vector<FileChange>& seen)
+    { return has_change(seen, kind, path); };
+}
+
+/// Wait on `backend` until `done` holds for what it reported, or 3 s pass.
+auto collect(IFileWatcherBackend& backend,
+             const std::function<bool(const std::vector<FileChange>&)>& done)
+    -> std::vector<FileChange>
+{
+    std::vector<FileChange> changes;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (!done(changes) && std::chrono::steady_clock::now() < deadline)
+    {
+        backend.wait(std::chrono::milliseconds(50), changes);
+    }
+    return changes;
+}
+
+/// Drain the bus until the batches published so far satisfy `done`.
+auto collect_batches(EventBus& bus,
+                     const std::function<bool(const std::vector<FileChange>&)>& done,
+                     std::chrono::milliseconds limit = std::chrono::seconds(3))
+    -> std::vector<std::vector<FileChange>>
+{
+    std::vector<std::vector<FileChange>> batches;
+    std::vector<FileChange> all;
+    auto sub = bus.subscribe<events::FileSystemChangedEvent>(
+        [&](const events::FileSystemChangedEvent& event)
+        {
+            batches.push_back(event.changes);
+            all.insert(all.end(), event.changes.begin(), event.changes.end());
+        });
+    const auto deadline = std::chrono::steady_clock::now() + limit;
+    while (!done(all) && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        bus.process_queued();
+    }
+    return batches;
+}
+
+} // anonymous namespace
+
+// ═══════════════════════════════════════════════════════
+// FileChangeCoalescer
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("FileChangeCoalescer folds changes per path", "[file_watcher]")
+{
+    FileChangeCoalescer coalescer;
+
+    SECTION("created then modified is a creation")
+    {
+        coalescer.add({FileChangeKind::Created, "/w/a.md", {}, false});
+        coalescer.add({FileChangeKind::Modified, "/w/a.md", {}, false});
+        coalescer.add({FileChangeKind::Modified, "/w/a.md", {}, false});
+        const auto changes = coalescer.take();
+        REQUIRE(changes.size() == 1);
+        REQUIRE(changes[0].kind == FileChangeKind::Created);
+        REQUIRE(coalescer.empty());
+    }
+
+    SECTION("created then deleted is nothing")
+    {
+        coalescer.add({FileChangeKind::Created, "/w/tmp", {}, false});
+        coalescer.add({FileChangeKind::Modified, "/w/tmp", {}, false});
+        coalescer.add({FileChangeKind::Deleted, "/w/tmp", {}, false});
+        REQUIRE(coalescer.empty());
+        REQUIRE(coalescer.take().empty());
+    }
+
+    SECTION("deleted then created is a modification")
+    {
+        coalescer.add({FileChangeKind::Deleted, "/w/a.md", {}, false});
+        coalescer.add({FileChangeKind::Created, "/w/a.md", {}, false});
+        const auto changes = coalescer.take();
+        REQUIRE(changes.size() == 1);
+        REQUIRE(changes[0].kind == FileChangeKind::Modified);
+    }
+
+    SECTION("atomic save through a temporary file")
+    {
+        coalescer.add({FileChangeKind::Created, "/w/.a.md.tmp", {}, false});
+        coalescer.add({FileChangeKind::Modified, "/w/.a.md.tmp", {}, false});
+        coalescer.add({FileChangeKind::Renamed, "/w/a.md", "/w/.a.md.tmp", false});
+        const auto changes = coalescer.take();
+        REQUIRE(changes.size() == 1);
+        REQUIRE(changes[0].kind == FileChangeKind::Created);
+        REQUIRE(changes[0].path == "/w/a.md");
+    }
+
+    SECTION("chained renames collapse")
+    {
+        coalescer.add({FileChangeKind::Renamed, "/w/b.md", "/w/a.md", false});
+        coalescer.add({FileChangeKind::Modified, "/w/b.md", {}, false});
+        coalescer.add({FileChangeKind::Renamed, "/w/c.md", "/w/b.md", false});
+        auto changes = coalescer.take();
+        REQUIRE(changes.size() == 1);
+        REQUIRE(changes[0].kind == FileChangeKind::Renamed);
+        REQUIRE(changes[0].old_path == "/w/a.md");
+        REQUIRE(changes[0].path == "/w/c.md");
+
+        coalescer.add({FileChangeKind::Renamed, "/w/b.md", "/w/a.md", false});
+        coalescer.add({FileChangeKind::Renamed, "/w/a.md", "/w/b.md", false});
+        changes = coalescer.take();
+        REQUIRE(changes.size() == 1);
+        REQUIRE(changes[0].kind == FileChangeKind::Modified);
+        REQUIRE(changes[0].path == "/w/a.md");
+    }
+
+    SECTION("renamed then deleted deletes the original")
+    {
+        coalescer.add({FileChangeKind::Renamed, "/w/b.md", "/w/a.md", false});
+        coalescer.add({FileChangeKind::Deleted, "/w/b.md", {}, false});
+        const auto changes = coalescer.take();
+        REQUIRE(changes.size() == 1);
+        REQUIRE(changes[0].kind == FileChangeKind::Deleted);
+        REQUIRE(changes[0].path == "/w/a.md");
+    }
+
+    SECTION("order of first appearance is kept")
+    {
+        coalescer.add({FileChangeKind::Modified, "/w/2", {}, false});
+        coalescer.add({FileChangeKind::Created, "/w/1", {}, false});
+        coalescer.add({FileChangeKind::Modified, "/w/2", {}, false});
+        coalescer.add({FileChangeKind::Deleted, "/w/3", {}, false});
+        const auto changes = coalescer.take();
+        REQUIRE(changes.size() == 3);
+        REQUIRE(changes[0].path == "/w/2");
+        REQUIRE(changes[1].path == "/w/1");
+        REQUIRE(changes[2].path == "/w/3");
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// Backends
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("inotify backend reports create, modify, delete and rename", "[file_watcher]")
+{
+    auto backend = make_inotify_watcher_backend();
+    if (!backend)
+    {
+        SKIP("inotify not available");
+    }
+    TempTree tree("inotify_basic");
+    tree.write("keep.md");
+    REQUIRE(backend->add_watch(tree.path(), false).has_value());
+
+    tree.write("new.md");
+    auto changes = collect(*backend, saw(FileChangeKind::Created, tree.path("new.md")));
+    REQUIRE(has_change(changes, FileChangeKind::Created, tree.path("new.md")));
+
+    tree.write("keep.md", "changed");
+    changes = collect(*backend, saw(FileChangeKind::Modified, tree.path("keep.md")));
+    REQUIRE(has_change(changes, FileChangeKind::Modified, tree.path("keep.md")));
+
+    fs::rename(tree.path("new.md"), tree.path("renamed.md"));
+    changes = collect(*backend, [](const auto& seen) { return !seen.empty(); });
+    REQUIRE(changes.size() == 1);
+    REQUIRE(changes[0].kind == FileChangeKind::Renamed);
+    REQUIRE(changes[0].old_path == tree.path("new.md"));
+    REQUIRE(changes[0].path == tree.path("renamed.md"));
+
+    fs::remove(tree.path("renamed.md"));
+    changes = collect(*backend, saw(FileChangeKind::Deleted, tree.path("renamed.md")));
+    REQUIRE(has_change(changes, FileChangeKind::Deleted, tree.path("renamed.md")));
+
+    // Moving out of the watched folder is a deletion
+    TempTree outside("inotify_outside");
+    fs::rename(tree.path("keep.md"), outside.path("keep.md"));
+    changes = collect(*backend, saw(FileChangeKind::Deleted, tree.path("keep.md")));
+    REQUIRE(has_change(changes, FileChangeKind::Deleted, tree.path("keep.md")));
+}
+
+TEST_CASE("inotify backend watches new folders of recursive roots", "[file_watcher]")
+{
+    auto backend = make_inotify_watcher_backend();
+    if (!backend)
+    {
+        SKIP("inotify not available");
+    }
+    TempTree tree("inotify_recursive");
+    tree.write("docs/guide/intro.md");
+    tree.write(".git/HEAD");
+    REQUIRE(backend->add_watch(tree.path(), true).has_value());
+    std::vector<FileChange> setup;
+    backend->wait(std::chrono::milliseconds(0), setup); // Walks the tree
+    REQUIRE(setup.empty());
+
+    SECTION("existing folders are watched, hidden ones are not")
+    {
+        tree.write("docs/guide/intro.md", "edited");
+        tree.write(".git/HEAD", "edited");
+        auto changes =
+            collect(*backend, saw(FileChangeKind::Modified, tree.path("docs/guide/intro.md")));
+        REQUIRE(has_change(changes, FileChangeKind::Modified, tree.path("docs/guide/intro.md")));
+        REQUIRE_FALSE(has_change(changes, FileChangeKind::Modified, tree.path(".git/HEAD")));
+    }
+
+    SECTION("folders created later are watched, and their contents reported")
+    {
+        fs::create_directories(tree.path("notes/2024"));
+        tree.write("notes/2024/jan.md");
+        auto changes =
+            collect(*backend, saw(FileChangeKind::Created, tree.path("notes/2024/jan.md")));
+        REQUIRE(has_change(changes, FileChangeKind::Created, tree.path("notes")));
+        REQUIRE(has_change(changes, FileChangeKind::Created, tree.path("notes/2024/jan.md")));
+
+        tree.write("notes/2024/feb.md");
+        changes = collect(*backend, saw(FileChangeKind::Created, tree.path("notes/2024/feb.md")));
+        REQUIRE(has_change(changes, FileChangeKind::Created, tree.path("notes/2024/feb.md")));
+    }
+
+    SECTION("renamed folders keep reporting under their new name")
+    {
+        fs::rename(tree.path("docs"), tree.path("manual"));
+        auto changes = collect(*backend, [](const auto& seen) { return !seen.empty(); });
+        REQUIRE(changes.size() == 1);
+        REQUIRE(changes[0].kind == FileChangeKind::Renamed);
+        REQUIRE(changes[0].is_directory);
+
+        tree.write("manual/guide/intro.md", "edited");
+        changes =
+            collect(*backend, saw(FileChangeKind::Modified, tree.path("manual/guide/intro.md")));
+        REQUIRE(has_change(changes, FileChangeKind::Modified, tree.path("manual/guide/intro.md")));
+    }
+
+    SECTION("removed watches go quiet")
+    {
+        backend->remove_watch(tree.path());
+        tree.write("docs/guide/intro.md", "edited");
+        tree.write("late.md");
+        std::vector<FileChange> changes;
+        backend->wait(std::chrono::milliseconds(200), changes);
+        REQUIRE(changes.empty());
+    }
+}
+
+TEST_CASE("polling backend reports differences between polls", "[file_watcher]")
+{
+    auto backend = make_polling_watcher_backend(std::chrono::milliseconds(20));
+    TempTree tree("polling");
+    tree.write("a.md");
+    tree.write("sub/b.md");
+    REQUIRE(backend->add_watch(tree.path(), true).has_value());
+    REQUIRE_FALSE(backend->add_watch(tree.path("a.md"), false).has_value());
+
+    tree.write("sub/c.md");
+    fs::remove(tree.path("a.md"));
+    const auto changes = collect(
+        *backend,
+        [&](const auto& seen)
+        {
+            return has_change(seen, FileChangeKind::Created, tree.path("sub/c.md")) &&
+                   has_change(seen, FileChangeKind::Deleted, tree.path("a.md"));
+        });
+    REQUIRE(has_change(changes, FileChangeKind::Created, tree.path("sub/c.md")));
+    REQUIRE(has_change(changes, FileChangeKind::Deleted, tree.path("a.md")));
+}
+
+// ═══════════════════════════════════════════════════════
+// FileWatcherService
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("FileWatcherService publishes one debounced batch per burst", "[file_watcher]")
+{
+    EventBus bus;
+    FileWatcherService service(bus);
+    TempTree tree("service_burst");
+
+    auto watch = service.watch(tree.path(), true);
+    REQUIRE(watch.has_value());
+
+    std::atomic<int> wakes{0};
+    service.set_wake_callback([&wakes]() { ++wakes; });
+
+    // A save storm: one file rewritten many times, a scratch file come and gone
+    for (int round = 0; round < 20; ++round)
+    {
+        tree.write("draft.md", "round " + std::to_string(round));
+    }
+    tree.write("scratch.tmp");
+    fs::remove(tree.path("scratch.tmp"));
+
+    const auto batches = collect_batches(bus, saw(FileChangeKind::Created, tree.path("draft.md")));
+    REQUIRE(batches.size() == 1);
+    REQUIRE(batches[0].size() == 1);
+    REQUIRE(batches[0][0].kind == FileChangeKind::Created);
+    REQUIRE(batches[0][0].path == tree.path("draft.md"));
+
+    // The wake-up follows the queued batch
+    for (int spin = 0; spin < 100 && wakes.load() == 0; ++spin)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    REQUIRE(wakes.load() == 1);
+}
+
+TEST_CASE("FileWatcherService shares watches between subscriptions", "[file_watcher]")
+{
+    EventBus bus;
+    FileWatcherService service(bus, make_file_watcher_backend(), std::chrono::milliseconds(20));
+    TempTree tree("service_shared");
+
+    auto first = service.watch(tree.path(), false);
+    auto second = service.watch(tree.path() + "/", false);
+    REQUIRE(first.has_value());
+    REQUIRE(second.has_value());
+    REQUIRE_FALSE(service.watch(tree.path("missing"), false).has_value());
+
+    first->cancel();
+    tree.write("one.md");
+    auto batches = collect_batches(bus, saw(FileChangeKind::Created, tree.path("one.md")));
+    REQUIRE(batches.size() == 1);
+
+    second->cancel();
+    tree.write("two.md");
+    batches =
+        collect_batches(bus, [](const auto&) { return false; }, std::chrono::milliseconds(300));
+    REQUIRE(batches.empty());
+}
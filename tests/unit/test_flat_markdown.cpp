@@ -0,0 +1,196 @@
+#include "core/FlatMarkdown.h"
+#include "core/Md4cWrapper.h"
+#include "core/Types.h"
+#include "rendering/HtmlRenderer.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace markamp::core;
+
+namespace
+{
+
+/// True when `text` lies inside `source` (i.e. was not copied).
+auto points_into(std::string_view text, std::string_view source) -> bool
+{
+    return !text.empty() && text.data() >= source.data() &&
+           text.data() + text.size() <= source.data() + source.size();
+}
+
+auto leaf(MdNodeType type, std::string_view text = {}) -> FlatMdNode
+{
+    FlatMdNode node;
+    node.type = type;
+    node.text_content = text;
+    return node;
+}
+
+const std::string kSample = R"(# Title with *emphasis*
+
+First paragraph with a [link](https://example.com "Example") and `inline code`.
+Second line of the same paragraph.
+
+## Tasks
+
+- [x] done item
+- [ ] open item
+- plain item
+
+```cpp {2}
+int main()
+{
+    return 0;
+}
+```
+
+```mermaid
+graph TD; A-->B;
+```
+
+![diagram](images/missing.png "A title")
+
+# Title with *emphasis*
+)";
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// FlatMarkdownBuilder
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("FlatMarkdownBuilder: subtrees are contiguous ranges", "[flat_markdown]")
+{
+    const std::string source = "Hello world";
+    FlatMarkdownBuilder builder(source);
+    builder.open(leaf(MdNodeType::Paragraph));
+    builder.add(leaf(MdNodeType::Text, std::string_view(source).substr(0, 5)));
+    builder.open(leaf(MdNodeType::Emphasis));
+    builder.add(leaf(MdNodeType::Text, std::string_view(source).substr(5)));
+    builder.close();
+    builder.close();
+    builder.open(leaf(MdNodeType::HorizontalRule));
+    auto document = builder.finish();
+
+    const auto nodes = document.nodes();
+    REQUIRE(nodes.size() == 6);
+    CHECK(document.root().descendants == 5);
+    CHECK(nodes[1].descendants == 3); // Paragraph
+    CHECK(nodes[3].descendants == 1); // Emphasis
+    CHECK(nodes[5].descendants == 0); // Closed by finish()
+
+    std::vector<MdNodeType> top_level;
+    for (const auto& child : document.root().children())
+    {
+        top_level.push_back(child.type);
+    }
+    CHECK(top_level == std::vector{MdNodeType::Paragraph, MdNodeType::HorizontalRule});
+    CHECK(nodes[1].children().size() == 2);
+    CHECK(nodes[5].children().empty());
+    CHECK(document.root().plain_text() == "Hello world");
+    CHECK(document.find_all(MdNodeType::Text).size() == 2);
+}
+
+TEST_CASE("FlatMarkdownBuilder: text outside the source is copied", "[flat_markdown]")
+{
+    const std::string source = "abc\ndef\n";
+    FlatMarkdownBuilder builder(source);
+    const auto view = std::string_view(source);
+
+    CHECK(builder.stable_text(view.substr(4, 3)).data() == source.data() + 4);
+    std::string temporary = "temporary";
+    const auto copied = builder.stable_text(temporary);
+    temporary.assign("overwritten");
+    CHECK(copied == "temporary");
+
+    SECTION("runs continuing the source stay one view")
+    {
+        builder.open(leaf(MdNodeType::FencedCodeBlock));
+        builder.append_text(view.substr(0, 3));
+        builder.append_text("\n"); // Static newline, as md4c emits it
+        builder.append_text(view.substr(4, 3));
+        const auto& block = builder.close();
+        CHECK(block.text_content == "abc\ndef");
+        CHECK(block.text_content.data() == source.data());
+    }
+
+    SECTION("runs that do not continue the source are joined in the arena")
+    {
+        builder.open(leaf(MdNodeType::CodeBlock));
+        builder.append_text(view.substr(0, 3));
+        builder.append_text("\r\n");
+        builder.append_text(view.substr(4, 3));
+        const auto& block = builder.close();
+        CHECK(block.text_content == "abc\r\ndef");
+        CHECK_FALSE(points_into(block.text_content, source));
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// Md4cParser::parse_flat
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("parse_flat renders the same HTML as parse", "[flat_markdown]")
+{
+    Md4cParser parser;
+    auto tree = parser.parse(kSample);
+    auto flat = parser.parse_flat(kSample);
+    REQUIRE(tree.has_value());
+    REQUIRE(flat.has_value());
+
+    markamp::rendering::HtmlRenderer renderer;
+    const auto expected = renderer.render(*tree);
+    CHECK(renderer.render(*flat) == expected);
+    CHECK(renderer.render_with_footnotes(*flat, "<section>notes</section>") ==
+          renderer.render_with_footnotes(*tree, "<section>notes</section>"));
+}
+
+TEST_CASE("parse_flat document helpers match MarkdownDocument", "[flat_markdown]")
+{
+    Md4cParser parser;
+    auto tree = parser.parse(kSample);
+    auto flat = parser.parse_flat(kSample);
+    REQUIRE(tree.has_value());
+    REQUIRE(flat.has_value());
+
+    CHECK(flat->word_count() == tree->word_count());
+    CHECK(flat->heading_count() == tree->heading_count());
+    CHECK(flat->has_mermaid() == tree->has_mermaid());
+    CHECK(flat->has_task_lists() == tree->has_task_lists());
+    CHECK(flat->has_tables() == tree->has_tables());
+    for (auto type : {MdNodeType::Text, MdNodeType::Link, MdNodeType::ListItem, MdNodeType::Image})
+    {
+        CHECK(flat->find_all(type).size() == tree->root.find_all(type).size());
+    }
+
+    REQUIRE(flat->mermaid_blocks.size() == tree->mermaid_blocks.size());
+    for (std::size_t index = 0; index < tree->mermaid_blocks.size(); ++index)
+    {
+        CHECK(flat->mermaid_blocks[index] == tree->mermaid_blocks[index]);
+    }
+    REQUIRE(flat->code_languages.size() == tree->code_languages.size());
+    for (std::size_t index = 0; index < tree->code_languages.size(); ++index)
+    {
+        CHECK(flat->code_languages[index] == tree->code_languages[index]);
+    }
+}
+
+TEST_CASE("parse_flat references the source instead of copying text", "[flat_markdown]")
+{
+    Md4cParser parser;
+    auto flat = parser.parse_flat(kSample);
+    REQUIRE(flat.has_value());
+
+    for (const auto* text : flat->find_all(MdNodeType::Text))
+    {
+        CHECK(points_into(text->text_content, kSample));
+    }
+    const auto links = flat->find_all(MdNodeType::Link);
+    REQUIRE(links.size() == 1);
+    CHECK(points_into(links.front()->url, kSample));
+    CHECK(links.front()->title == "Example");
+}
@@ -0,0 +1,557 @@
+#include "core/GrammarEngine.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace markamp::core;
+
+namespace
+{
+
+// Trimmed-down Markdown grammar in the shape of VS Code's markdown.tmLanguage.json:
+// Oniguruma-only syntax, nested repositories, back-referenced fence ends,
+// begin/while blockquotes and an include of another grammar.
+constexpr const char* kMarkdownGrammar = R"json({
+    "name": "Markdown",
+    "scopeName": "text.html.markdown",
+    "patterns": [
+        { "include": "#heading" },
+        { "include": "#fenced_code_demo" },
+        { "include": "#fenced_code" },
+        { "include": "#blockquote" },
+        { "include": "#list" },
+        { "include": "#html_comment" },
+        { "include": "#inline" }
+    ],
+    "repository": {
+        "heading": {
+            "match": "(?:^|\\G)[ ]{0,3}(#{1,6})\\s+(.*?)(?:\\s+#+)?\\s*$",
+            "name": "markup.heading.markdown",
+            "captures": {
+                "1": { "name": "punctuation.definition.heading.markdown" },
+                "2": { "name": "entity.name.section.markdown" }
+            }
+        },
+        "fenced_code_demo": {
+            "begin": "(^|\\G)(\\s*)(`{3,}|~{3,})\\s*(?i:(demo))\\b.*$",
+            "end": "(^|\\G)(\\2)(\\3)\\s*$",
+            "name": "markup.fenced_code.block.markdown",
+            "contentName": "meta.embedded.block.demo",
+            "beginCaptures": {
+                "3": { "name": "punctuation.definition.markdown" },
+                "4": { "name": "fenced_code.block.language.markdown" }
+            },
+            "endCaptures": { "3": { "name": "punctuation.definition.markdown" } },
+            "patterns": [ { "include": "source.demo" } ]
+        },
+        "fenced_code": {
+            "begin": "(^|\\G)(\\s*)(`{3,}|~{3,})\\s*([\\w+#-]*).*$",
+            "end": "(^|\\G)(\\2)(\\3)\\s*$",
+            "name": "markup.fenced_code.block.markdown",
+            "contentName": "meta.embedded.block",
+            "beginCaptures": {
+                "3": { "name": "punctuation.definition.markdown" },
+                "4": { "name": "fenced_code.block.language.markdown" }
+            },
+            "endCaptures": { "3": { "name": "punctuation.definition.markdown" } }
+        },
+        "blockquote": {
+            "begin": "(^|\\G)[ ]{0,3}(>) ?",
+            "while": "(^|\\G)\\s*(>) ?",
+            "name": "markup.quote.markdown",
+            "captures": { "2": { "name": "punctuation.definition.quote.begin.markdown" } },
+            "patterns": [ { "include": "$self" } ]
+        },
+        "list": {
+            "match": "(?x) ^ [ ]{0,3} ([*+-]) [ ]  # bullet",
+            "captures": { "1": { "name": "punctuation.definition.list.begin.markdown" } }
+        },
+        "html_comment": {
+            "begin": "<!--",
+            "end": "--\\s*>",
+            "name": "comment.block.html",
+            "captures": { "0": { "name": "punctuation.definition.comment.html" } }
+        },
+        "inline": {
+            "patterns": [
+                { "include": "#bold" },
+                { "include": "#italic" },
+                { "include": "#raw" },
+                { "include": "#link" },
+                { "include": "#entity" }
+            ],
+            "repository": {
+                "bold": {
+                    "match": "(\\*\\*|__)(?=\\S)(.+?\\S)\\1",
+                    "name": "markup.bold.markdown",
+                    "captures": { "1": { "name": "punctuation.definition.bold.markdown" } }
+                },
+                "italic": {
+                    "match": "(?<!\\w)(\\*|_)(?=\\S)(.+?)(?<=\\S)\\1",
+                    "name": "markup.italic.markdown",
+                    "captures": { "1": { "name": "punctuation.definition.italic.markdown" } }
+                },
+                "raw": {
+                    "match": "(`+)((?:[^`]|(?!(?<!`)\\1(?!`))`)*+)(\\1)",
+                    "name": "markup.inline.raw.string.markdown",
+                    "captures": {
+                        "1": { "name": "punctuation.definition.raw.markdown" },
+                        "3": { "name": "punctuation.definition.raw.markdown" }
+                    }
+                },
+                "link": {
+                    "match": "(\\[)((?<text>[^\\]]*))(\\])(\\()([^)\\s]*)(\\))",
+                    "name": "meta.link.inline.markdown",
+                    "captures": {
+                        "2": { "name": "string.other.link.title.markdown" },
+                        "6": { "name": "markup.underline.link.markdown" }
+                    }
+                },
+                "entity": {
+                    "match": "&(?:#x\\h+|#\\d+|[a-zA-Z]+);",
+                    "name": "constant.character.entity.markdown"
+                }
+            }
+        }
+    }
+})json";
+
+constexpr const char* kDemoGrammar = R"json({
+    "scopeName": "source.demo",
+    "patterns": [
+        { "match": "\\b(let|if|else)\\b", "name": "keyword.control.demo" },
+        { "match": "\\b\\d+\\b", "name": "constant.numeric.demo" }
+    ]
+})json";
+
+constexpr const char* kMarkdown = "text.html.markdown";
+
+void load_markdown_grammar(GrammarEngine& engine)
+{
+    REQUIRE(engine.load_grammar_json(kMarkdownGrammar));
+}
+
+/// Scope of the token covering byte `offset`, or "" if none does.
+auto scope_at(const std::vector<GrammarToken>& tokens, int offset) -> std::string
+{
+    for (const auto& token : tokens)
+    {
+        if (token.start_index <= offset && offset < token.end_index)
+        {
+            return token.scope;
+        }
+    }
+    return {};
+}
+
+/// Tokens are contiguous and cover the line exactly.
+auto covers_line(const std::vector<GrammarToken>& tokens, std::string_view line) -> bool
+{
+    int pos = 0;
+    for (const auto& token : tokens)
+    {
+        if (token.start_index != pos || token.end_index <= token.start_index)
+        {
+            return false;
+        }
+        pos = token.end_index;
+    }
+    return pos == static_cast<int>(line.size());
+}
+
+/// Tokenize `lines` in order from the start of the document.
+auto tokenize_document(const GrammarEngine& engine, const std::vector<std::string>& lines)
+    -> std::vector<GrammarLineResult>
+{
+    std::vector<GrammarLineResult> results;
+    GrammarState state;
+    for (const auto& line : lines)
+    {
+        results.push_back(engine.tokenize_line(kMarkdown, line, state));
+        state = results.back().end_state;
+    }
+    return results;
+}
+
+auto as_views(const std::vector<std::string>& lines) -> std::vector<std::string_view>
+{
+    return {lines.begin(), lines.end()};
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Loading
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("GrammarEngine: loads grammars from JSON and files", "[grammar]")
+{
+    GrammarEngine engine;
+    REQUIRE(engine.load_grammar_json(kMarkdownGrammar, "markdown.tmLanguage.json"));
+
+    const auto* grammar = engine.get_grammar(kMarkdown);
+    REQUIRE(grammar != nullptr);
+    CHECK(grammar->name == "Markdown");
+    CHECK(grammar->path == "markdown.tmLanguage.json");
+    CHECK(grammar->rules != nullptr);
+
+    SECTION("from a file")
+    {
+        const auto path =
+            std::filesystem::temp_directory_path() / "markamp_test_demo.tmLanguage.json";
+        {
+            std::ofstream out(path);
+            out << kDemoGrammar;
+        }
+        REQUIRE(engine.load_grammar(path.string()));
+        std::filesystem::remove(path);
+
+        REQUIRE(engine.grammars().size() == 2);
+        CHECK(engine.get_grammar("source.demo")->path == path.string());
+    }
+
+    SECTION("rejects missing files, invalid JSON and grammars without a scope")
+    {
+        CHECK_FALSE(engine.load_grammar("/nonexistent/grammar.tmLanguage.json"));
+        CHECK_FALSE(engine.load_grammar_json("{ not json"));
+        CHECK_FALSE(engine.load_grammar_json(R"({"patterns": []})"));
+        CHECK(engine.grammars().size() == 1);
+    }
+
+    SECTION("a grammar with the same scope replaces the earlier one")
+    {
+        REQUIRE(engine.load_grammar_json(R"({
+            "scopeName": "text.html.markdown",
+            "patterns": [ { "match": "x", "name": "x.test" } ]
+        })"));
+        REQUIRE(engine.grammars().size() == 1);
+        CHECK(scope_at(engine.tokenize_line(kMarkdown, "# x"), 2) == "x.test");
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// Tokenization
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("GrammarEngine: match rules paint captures over the rule scope", "[grammar]")
+{
+    GrammarEngine engine;
+    load_markdown_grammar(engine);
+
+    const std::string line = "## Section title";
+    const auto tokens = engine.tokenize_line(kMarkdown, line);
+    REQUIRE(covers_line(tokens, line));
+    CHECK(scope_at(tokens, 0) == "punctuation.definition.heading.markdown");
+    CHECK(scope_at(tokens, 1) == "punctuation.definition.heading.markdown");
+    CHECK(scope_at(tokens, 2) == "markup.heading.markdown");
+    CHECK(scope_at(tokens, 3) == "entity.name.section.markdown");
+    CHECK(scope_at(tokens, 15) == "entity.name.section.markdown");
+
+    const std::string prose = "Some **bold** and [a link](https://example.com) text";
+    const auto inline_tokens = engine.tokenize_line(kMarkdown, prose);
+    REQUIRE(covers_line(inline_tokens, prose));
+    CHECK(scope_at(inline_tokens, 0) == kMarkdown);
+    CHECK(scope_at(inline_tokens, 5) == "punctuation.definition.bold.markdown");
+    CHECK(scope_at(inline_tokens, 8) == "markup.bold.markdown");
+    CHECK(scope_at(inline_tokens, 19) == "string.other.link.title.markdown");
+    CHECK(scope_at(inline_tokens, 30) == "markup.underline.link.markdown");
+    CHECK(scope_at(inline_tokens, 18) == "meta.link.inline.markdown");
+}
+
+TEST_CASE("GrammarEngine: Oniguruma-only syntax is translated", "[grammar]")
+{
+    GrammarEngine engine;
+    load_markdown_grammar(engine);
+
+    // (?x) extended mode with a comment
+    const auto list = engine.tokenize_line(kMarkdown, "- item");
+    CHECK(scope_at(list, 0) == "punctuation.definition.list.begin.markdown");
+
+    // Lookbehind dropped
+    const auto italic = engine.tokenize_line(kMarkdown, "an *emphasised* word");
+    CHECK(scope_at(italic, 3) == "punctuation.definition.italic.markdown");
+    CHECK(scope_at(italic, 6) == "markup.italic.markdown");
+
+    // Possessive quantifier and nested lookaround with a back-reference
+    const auto raw = engine.tokenize_line(kMarkdown, "call `f()` now");
+    CHECK(scope_at(raw, 5) == "punctuation.definition.raw.markdown");
+    CHECK(scope_at(raw, 7) == "markup.inline.raw.string.markdown");
+    CHECK(scope_at(raw, 11) == kMarkdown);
+
+    // \h
+    const auto entity = engine.tokenize_line(kMarkdown, "a &#x1F600; b");
+    CHECK(scope_at(entity, 4) == "constant.character.entity.markdown");
+}
+
+TEST_CASE("GrammarEngine: begin/end rules carry state across lines", "[grammar]")
+{
+    GrammarEngine engine;
+    load_markdown_grammar(engine);
+
+    const std::vector<std::string> lines = {
+        "```python",
+        "**not bold** in code",
+        "````",
+        "~~~",
+        "```",
+        "**bold** again",
+    };
+    const auto results = tokenize_document(engine, lines);
+
+    CHECK(scope_at(results[0].tokens, 0) == "punctuation.definition.markdown");
+    CHECK(scope_at(results[0].tokens, 3) == "fenced_code.block.language.markdown");
+    CHECK(results[0].end_state.depth() == 1);
+
+    // Inside the fence only the content scope applies
+    REQUIRE(results[1].tokens.size() == 1);
+    CHECK(results[1].tokens[0].scope == "meta.embedded.block");
+
+    // The end pattern is bound to the opening fence: ```` and ~~~ do not close it
+    CHECK(results[2].end_state.depth() == 1);
+    CHECK(results[3].end_state.depth() == 1);
+    CHECK(scope_at(results[4].tokens, 0) == "punctuation.definition.markdown");
+    CHECK(results[4].end_state.depth() == 0);
+    CHECK(results[4].end_state == GrammarState{});
+
+    CHECK(scope_at(results[5].tokens, 3) == "markup.bold.markdown");
+}
+
+TEST_CASE("GrammarEngine: begin/end rules can open and close within a line", "[grammar]")
+{
+    GrammarEngine engine;
+    load_markdown_grammar(engine);
+
+    const std::string line = "a <!-- note --> b <!-- open";
+    const auto result = engine.tokenize_line(kMarkdown, line, GrammarState{});
+    REQUIRE(covers_line(result.tokens, line));
+    CHECK(scope_at(result.tokens, 0) == kMarkdown);
+    CHECK(scope_at(result.tokens, 2) == "punctuation.definition.comment.html");
+    CHECK(scope_at(result.tokens, 8) == "comment.block.html");
+    CHECK(scope_at(result.tokens, 12) == "punctuation.definition.comment.html");
+    CHECK(scope_at(result.tokens, 16) == kMarkdown);
+    CHECK(result.end_state.depth() == 1);
+
+    const auto next = engine.tokenize_line(kMarkdown, "still -- > out", result.end_state);
+    CHECK(scope_at(next.tokens, 0) == "comment.block.html");
+    CHECK(scope_at(next.tokens, 12) == kMarkdown);
+    CHECK(next.end_state.depth() == 0);
+}
+
+TEST_CASE("GrammarEngine: begin/while rules close when the condition fails", "[grammar]")
+{
+    GrammarEngine engine;
+    load_markdown_grammar(engine);
+
+    const std::vector<std::string> lines = {
+        "> quoted **bold**",
+        "> # nested heading",
+        ">> deeper",
+        "plain text",
+    };
+    const auto results = tokenize_document(engine, lines);
+
+    CHECK(scope_at(results[0].tokens, 0) == "punctuation.definition.quote.begin.markdown");
+    CHECK(scope_at(results[0].tokens, 2) == "markup.quote.markdown");
+    CHECK(scope_at(results[0].tokens, 11) == "markup.bold.markdown");
+    CHECK(results[0].end_state.depth() == 1);
+
+    // The while match consumes the marker; $self then sees the rest as a line
+    CHECK(scope_at(results[1].tokens, 0) == "punctuation.definition.quote.begin.markdown");
+    CHECK(scope_at(results[1].tokens, 2) == "punctuation.definition.heading.markdown");
+
+    CHECK(results[2].end_state.depth() == 2);
+    CHECK(results[3].tokens.size() == 1);
+    CHECK(results[3].tokens[0].scope == kMarkdown);
+    CHECK(results[3].end_state.depth() == 0);
+}
+
+TEST_CASE("GrammarEngine: includes resolve other loaded grammars", "[grammar]")
+{
+    GrammarEngine engine;
+    load_markdown_grammar(engine);
+    const std::vector<std::string> lines = {"```demo", "let x = 42", "```"};
+
+    // Not loaded yet: the block is plain content
+    auto results = tokenize_document(engine, lines);
+    REQUIRE(results[1].tokens.size() == 1);
+    CHECK(results[1].tokens[0].scope == "meta.embedded.block.demo");
+
+    REQUIRE(engine.load_grammar_json(kDemoGrammar));
+    results = tokenize_document(engine, lines);
+    CHECK(scope_at(results[1].tokens, 0) == "keyword.control.demo");
+    CHECK(scope_at(results[1].tokens, 3) == "meta.embedded.block.demo");
+    CHECK(scope_at(results[1].tokens, 8) == "constant.numeric.demo");
+    CHECK(results[2].end_state.depth() == 0);
+}
+
+TEST_CASE("GrammarEngine: language IDs map to loaded grammars", "[grammar]")
+{
+    GrammarEngine engine;
+    engine.set_language_scope("Demo", "source.demo");
+
+    // Mapped, but the grammar is not loaded yet
+    CHECK(engine.scope_for_language("demo").empty());
+
+    REQUIRE(engine.load_grammar_json(kDemoGrammar));
+    CHECK(engine.scope_for_language("demo") == "source.demo");
+    CHECK(engine.scope_for_language("DEMO") == "source.demo");
+    CHECK(engine.scope_for_language("other").empty());
+}
+
+TEST_CASE("GrammarEngine: degenerate grammars terminate", "[grammar]")
+{
+    GrammarEngine engine;
+    REQUIRE(engine.load_grammar_json(R"json({
+        "scopeName": "source.loop",
+        "patterns": [
+            { "include": "#self_loop" },
+            { "match": "(?=x)", "name": "empty.match" },
+            { "begin": "(?=y)", "end": "", "name": "empty.block" },
+            { "begin": "\\{", "end": "\\}", "name": "nested.block",
+              "patterns": [ { "include": "$self" } ] },
+            { "match": "\\p{Lu}", "name": "unsupported.pattern" }
+        ],
+        "repository": {
+            "self_loop": { "patterns": [ { "include": "#self_loop" }, { "include": "$base" } ] }
+        }
+    })json"));
+
+    for (const std::string line : {"axb", "ayb", "xyxy", "Abc"})
+    {
+        const auto result = engine.tokenize_line("source.loop", line, GrammarState{});
+        CHECK(covers_line(result.tokens, line));
+    }
+
+    // Nesting is capped
+    const std::string braces(GrammarEngine::kMaxStackDepth * 2, '{');
+    const auto deep = engine.tokenize_line("source.loop", braces, GrammarState{});
+    CHECK(covers_line(deep.tokens, braces));
+    CHECK(deep.end_state.depth() == GrammarEngine::kMaxStackDepth);
+}
+
+TEST_CASE("GrammarEngine: overlong lines get one token and keep the state", "[grammar]")
+{
+    GrammarEngine engine;
+    load_markdown_grammar(engine);
+
+    const auto open = engine.tokenize_line(kMarkdown, "<!--", GrammarState{});
+    const std::string line(GrammarEngine::kMaxLineLength + 1, '*');
+    const auto result = engine.tokenize_line(kMarkdown, line, open.end_state);
+    REQUIRE(result.tokens.size() == 1);
+    CHECK(result.tokens[0].end_index == static_cast<int>(line.size()));
+    CHECK(result.tokens[0].scope == "comment.block.html");
+    CHECK(result.end_state == open.end_state);
+}
+
+// ═══════════════════════════════════════════════════════
+// Incremental re-tokenization
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("GrammarEngine: retokenize stops once line states converge", "[grammar]")
+{
+    GrammarEngine engine;
+    load_markdown_grammar(engine);
+
+    std::vector<std::string> lines;
+    for (int index = 0; index < 200; ++index)
+    {
+        lines.push_back("Paragraph line " + std::to_string(index) + " with *emphasis*");
+    }
+    lines[100] = "```cpp";
+    lines[101] = "int main() {}";
+    lines[102] = "```";
+
+    std::vector<GrammarLine> cache;
+    REQUIRE(engine.retokenize(kMarkdown, as_views(lines), 0, 0, cache) == lines.size());
+    REQUIRE(cache.size() == lines.size());
+    CHECK(cache[101].tokens[0].scope == "meta.embedded.block");
+
+    SECTION("an edit that keeps the state re-tokenizes one line")
+    {
+        lines[50] = "Edited **text**";
+        cache[50].valid = false;
+        CHECK(engine.retokenize(kMarkdown, as_views(lines), 50, 51, cache) == 51);
+        CHECK(scope_at(cache[50].tokens, 9) == "markup.bold.markdown");
+    }
+
+    SECTION("opening a fence re-tokenizes until the states converge")
+    {
+        lines[50] = "```";
+        cache[50].valid = false;
+        // "```cpp" is now inside our block, which is open with the same
+        // end pattern as the old block was after it: the states converge there
+        CHECK(engine.retokenize(kMarkdown, as_views(lines), 50, 51, cache) == 101);
+
+        CHECK(cache[60].tokens.size() == 1);
+        CHECK(cache[60].tokens[0].scope == "meta.embedded.block");
+        CHECK(cache[100].end_state.depth() == 1);
+        CHECK(cache[102].end_state.depth() == 0);
+        CHECK(cache[103].tokens[0].scope == kMarkdown);
+
+        // Matches a from-scratch pass
+        const auto fresh = tokenize_document(engine, lines);
+        for (std::size_t index = 0; index < lines.size(); ++index)
+        {
+            INFO("line " << index);
+            CHECK(cache[index].end_state == fresh[index].end_state);
+            CHECK(cache[index].tokens.size() == fresh[index].tokens.size());
+        }
+    }
+
+    SECTION("invalid lines just before the edit are re-tokenized first")
+    {
+        cache[10].valid = false;
+        cache[11].valid = false;
+        CHECK(engine.retokenize(kMarkdown, as_views(lines), 12, 13, cache) == 13);
+        CHECK(cache[10].valid);
+    }
+}
+
+TEST_CASE("GrammarEngine: Markdown lines/sec", "[.][benchmark][grammar]")
+{
+    GrammarEngine engine;
+    load_markdown_grammar(engine);
+
+    const std::vector<std::string> block = {
+        "# Heading with `code`",
+        "",
+        "Some paragraph text with **bold**, *italic* and a [link](https://example.com).",
+        "More prose &amp; an entity, plus `inline code` and __strong__ words.",
+        "- list item one",
+        "- list item *two* with [ref](#anchor)",
+        "> quoted **text** continues",
+        "> over two lines",
+        "```cpp",
+        "int main() { return 0; }",
+        "```",
+        "<!-- a comment -->",
+        "Closing paragraph without any markup at all, just words.",
+    };
+    std::vector<std::string> lines;
+    while (lines.size() < 20000)
+    {
+        lines.insert(lines.end(), block.begin(), block.end());
+    }
+    const auto views = as_views(lines);
+    const auto label = std::to_string(lines.size()) + " lines";
+
+    BENCHMARK(label + " full tokenize")
+    {
+        std::vector<GrammarLine> cache;
+        return engine.retokenize(kMarkdown, views, 0, 0, cache);
+    };
+
+    std::vector<GrammarLine> cache;
+    engine.retokenize(kMarkdown, views, 0, 0, cache);
+    BENCHMARK(label + " single-line edit")
+    {
+        cache[lines.size() / 2].valid = false;
+        return engine.retokenize(kMarkdown, views, lines.size() / 2, lines.size() / 2 + 1, cache);
+    };
+}
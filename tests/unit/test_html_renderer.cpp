@@ -2,6 +2,7 @@
 #include "core/Md4cWrapper.h"
 #include "core/Types.h"
 #include "rendering/HtmlRenderer.h"
+#include "rendering/IncrementalRenderer.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
@@ -590,3 +591,187 @@ A --> B;
     // Most critically: no heading-anchor '#' leaking
     REQUIRE_THAT(html, !ContainsSubstring("heading-anchor"));
 }
+
+// ═══════════════════════════════════════════════════════
+// IncrementalRenderer — block-level re-parse
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+
+constexpr std::string_view kIncrementalDoc = R"(# Guide
+
+Intro paragraph with a footnote[^1].
+
+## Setup
+
+- step one
+
+- step two
+  continued
+
+```bash
+echo one
+
+echo two
+```
+
+| A | B |
+|---|---|
+| 1 | 2 |
+
+## Setup
+
+See [the docs][docs] for details.
+
+[docs]: https://example.com/docs
+
+[^1]: Footnote text.
+)";
+
+} // namespace
+
+TEST_CASE("split_top_level_blocks keeps fences and loose lists together",
+          "[html_renderer][incremental]")
+{
+    std::string_view md = "para\n\n```\na\n\nb\n```\n\n- x\n\n- y\n\ntail\n";
+    auto ranges = split_top_level_blocks(md);
+    REQUIRE(ranges.size() == 4);
+    CHECK(md.substr(ranges[0].offset, ranges[0].length) == "para\n");
+    CHECK(md.substr(ranges[1].offset, ranges[1].length) == "```\na\n\nb\n```\n");
+    CHECK(md.substr(ranges[2].offset, ranges[2].length) == "- x\n\n- y\n");
+    CHECK(md.substr(ranges[3].offset, ranges[3].length) == "tail\n");
+}
+
+TEST_CASE("split_top_level_blocks keeps HTML blocks open until their end marker",
+          "[html_renderer][incremental]")
+{
+    std::string_view md = "<!-- note\n\nstill note -->\n\n<PRE>\nx\n\ny\n</pre>\n\n"
+                          "<div>\n\ntail\n";
+    auto ranges = split_top_level_blocks(md);
+    REQUIRE(ranges.size() == 4);
+    CHECK(md.substr(ranges[0].offset, ranges[0].length) == "<!-- note\n\nstill note -->\n");
+    CHECK(md.substr(ranges[1].offset, ranges[1].length) == "<PRE>\nx\n\ny\n</pre>\n");
+    // Other HTML blocks end at a blank line
+    CHECK(md.substr(ranges[2].offset, ranges[2].length) == "<div>\n");
+    CHECK(md.substr(ranges[3].offset, ranges[3].length) == "tail\n");
+
+    // An HTML block closed on its own line does not swallow what follows
+    std::string_view closed = "<!-- one line -->\n\npara\n";
+    CHECK(split_top_level_blocks(closed).size() == 2);
+}
+
+TEST_CASE("IncrementalRenderer output matches a full render", "[html_renderer][incremental]")
+{
+    HtmlRenderer renderer;
+    IncrementalRenderer incremental(renderer);
+
+    auto html = incremental.render(kIncrementalDoc);
+    REQUIRE(html.has_value());
+    CHECK(*html == render_with_footnotes(kIncrementalDoc));
+    CHECK_THAT(*html, ContainsSubstring("<h2 id=\"setup-1\">"));
+    CHECK_THAT(*html, ContainsSubstring("href=\"https://example.com/docs\""));
+    CHECK(incremental.last_stats().blocks_reused == 0);
+}
+
+TEST_CASE("IncrementalRenderer matches a full render across HTML blocks",
+          "[html_renderer][incremental]")
+{
+    constexpr std::string_view md = "Intro\n\n<!--\n\nhidden [docs]\n\n-->\n\n"
+                                    "<pre>\nraw\n\nstill raw\n</pre>\n\n"
+                                    "After [docs].\n\n[docs]: https://example.com/docs\n";
+    HtmlRenderer renderer;
+    IncrementalRenderer incremental(renderer);
+
+    auto html = incremental.render(md);
+    REQUIRE(html.has_value());
+    CHECK(*html == render_with_footnotes(md));
+}
+
+TEST_CASE("IncrementalRenderer matches a full render for lists opened mid-block",
+          "[html_renderer][incremental]")
+{
+    HtmlRenderer renderer;
+    IncrementalRenderer incremental(renderer);
+
+    // The list interrupts a paragraph or follows a heading; the item after
+    // the blank line belongs to the same loose list
+    for (const std::string_view md : {"para\n- a\n\n- b\n", "# H\n- a\n\n- b\n"})
+    {
+        CAPTURE(md);
+        auto ranges = split_top_level_blocks(md);
+        CHECK(ranges.size() == 1);
+        auto html = incremental.render(md);
+        REQUIRE(html.has_value());
+        CHECK(*html == render_with_footnotes(md));
+        CHECK_THAT(*html, ContainsSubstring("<p>b</p>"));
+    }
+}
+
+TEST_CASE("IncrementalRenderer keeps definitions out of an unterminated fence",
+          "[html_renderer][incremental]")
+{
+    constexpr std::string_view md = "See [docs].\n\n[docs]: https://example.com/docs\n\n"
+                                    "```\ncode\n\nmore code\n";
+    HtmlRenderer renderer;
+    IncrementalRenderer incremental(renderer);
+
+    auto html = incremental.render(md);
+    REQUIRE(html.has_value());
+    CHECK(*html == render_with_footnotes(md));
+    CHECK_THAT(*html, ContainsSubstring("href=\"https://example.com/docs\""));
+    CHECK_THAT(*html, !ContainsSubstring("[docs]: https://example.com/docs"));
+}
+
+TEST_CASE("IncrementalRenderer re-renders only the edited block", "[html_renderer][incremental]")
+{
+    HtmlRenderer renderer;
+    IncrementalRenderer incremental(renderer);
+    REQUIRE(incremental.render(kIncrementalDoc).has_value());
+
+    std::string edited(kIncrementalDoc);
+    edited.replace(edited.find("Intro paragraph"), 5, "First");
+
+    auto html = incremental.render(edited);
+    REQUIRE(html.has_value());
+    CHECK(*html == render_with_footnotes(edited));
+    CHECK(incremental.last_stats().blocks_rendered == 1);
+    CHECK(incremental.last_stats().blocks_reused == incremental.last_stats().blocks_total - 1);
+}
+
+TEST_CASE("IncrementalRenderer refreshes cached blocks whose IDs shifted",
+          "[html_renderer][incremental]")
+{
+    HtmlRenderer renderer;
+    IncrementalRenderer incremental(renderer);
+    REQUIRE(incremental.render(kIncrementalDoc).has_value());
+
+    SECTION("duplicate heading inserted above")
+    {
+        std::string edited(kIncrementalDoc);
+        edited.insert(edited.find("Intro paragraph"), "## Setup\n\n");
+        auto html = incremental.render(edited);
+        REQUIRE(html.has_value());
+        CHECK(*html == render_with_footnotes(edited));
+        CHECK_THAT(*html, ContainsSubstring("<h2 id=\"setup-2\">"));
+    }
+
+    SECTION("code block inserted above")
+    {
+        std::string edited(kIncrementalDoc);
+        edited.insert(edited.find("Intro paragraph"), "```cpp\nint x;\n```\n\n");
+        auto html = incremental.render(edited);
+        REQUIRE(html.has_value());
+        CHECK(*html == render_with_footnotes(edited));
+        CHECK(renderer.code_renderer().get_block_source(1) == "echo one\n\necho two\n");
+    }
+
+    SECTION("reference definition changed")
+    {
+        std::string edited(kIncrementalDoc);
+        edited.replace(edited.find("example.com/docs"), 11, "example.org");
+        auto html = incremental.render(edited);
+        REQUIRE(html.has_value());
+        CHECK(*html == render_with_footnotes(edited));
+    }
+}
@@ -0,0 +1,230 @@
+#include "core/HtmlSanitizer.h"
+#include "core/Md4cWrapper.h"
+#include "rendering/HtmlRenderer.h"
+#include "rendering/IncrementalRenderer.h"
+#include "rendering/PreviewPipeline.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+
+using namespace markamp::core;
+using namespace markamp::rendering;
+using Catch::Matchers::ContainsSubstring;
+
+// ═══════════════════════════════════════════════════════
+// Allocation counting
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+std::atomic<std::size_t> g_allocations{0};
+} // namespace
+
+auto operator new(std::size_t size) -> void*
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+auto operator new(std::size_t size, const std::nothrow_t& /*tag*/) noexcept -> void*
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t /*size*/) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t& /*tag*/) noexcept
+{
+    std::free(memory);
+}
+
+namespace
+{
+
+/// Heap allocations made while running `work`.
+template <typename Work>
+auto count_allocations(Work&& work) -> std::size_t
+{
+    const auto before = g_allocations.load(std::memory_order_relaxed);
+    work();
+    return g_allocations.load(std::memory_order_relaxed) - before;
+}
+
+auto parse(std::string_view markdown) -> MarkdownDocument
+{
+    Md4cParser parser;
+    auto document = parser.parse(markdown);
+    REQUIRE(document.has_value());
+    return std::move(*document);
+}
+
+/// Roughly `lines` lines of prose: paragraphs, emphasis, links, code spans, lists.
+auto make_prose(std::size_t lines) -> std::string
+{
+    std::string markdown;
+    for (std::size_t line = 0; line < lines; line += 5)
+    {
+        markdown += "Some *emphasised* text with a [link](https://example.com/page \"Title\")\n"
+                    "and `inline code` plus <angle> & \"quoted\" characters.\n\n"
+                    "- first item\n- second item\n\n";
+    }
+    return markdown;
+}
+
+/// Prose with a heading and a code block every few lines.
+const std::string kUnsafe = R"md(# Title
+
+Paragraph with *emphasis* and a [link](https://example.com).
+
+<div onclick="steal()">raw <script>alert(1)</script> html</div>
+
+- [x] task
+)md";
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Sanitizer
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("HtmlSanitizer: sanitize_into appends the same output as sanitize", "[html_stream]")
+{
+    HtmlSanitizer sanitizer;
+    for (const std::string_view html :
+         {R"html(<p onclick="x()">Hi</p><script>alert(1)</script>)html",
+          R"html(<a href=" JavaScript:alert(1)" title='t'>x</a>)html",
+          R"html(<img src="data:image/svg+xml;base64,AA" alt=a>)html",
+          R"html(<td style="background: URL(x)">c</td><td style="text-align: left">d</td>)html",
+          R"html(<input type="checkbox" checked disabled /><input type="text">)html",
+          R"html(<span class="JavaScript-thing">s</span><!-- comment --><br/>)html",
+          "plain text without tags",
+          "broken <tag without end"})
+    {
+        std::string output = "prefix|";
+        sanitizer.sanitize_into(html, output);
+        CHECK(output == "prefix|" + sanitizer.sanitize(html));
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// HtmlRenderer::render_into
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("HtmlRenderer: render_into appends to the caller's buffer", "[html_stream]")
+{
+    const auto document = parse(kUnsafe);
+    HtmlRenderer renderer;
+    const auto expected = renderer.render(document);
+
+    std::string output = "<body>";
+    renderer.render_into(document, output);
+    CHECK(output == "<body>" + expected);
+
+    output.clear();
+    renderer.render_into(document, output, nullptr, "<section>notes</section>");
+    CHECK(output == renderer.render_with_footnotes(document, "<section>notes</section>"));
+}
+
+TEST_CASE("HtmlRenderer: render_into sanitizes blocks as they are emitted", "[html_stream]")
+{
+    const auto document = parse(kUnsafe);
+    HtmlRenderer renderer;
+    HtmlSanitizer sanitizer;
+    const std::string footnotes =
+        R"html(<section class="footnotes"><a onclick="x()">1</a></section>)html";
+
+    std::string output;
+    renderer.render_into(document, output, &sanitizer, footnotes);
+    CHECK(output == sanitizer.sanitize(renderer.render_with_footnotes(document, footnotes)));
+    CHECK(output.find("<script") == std::string::npos);
+    CHECK(output.find("onclick") == std::string::npos);
+    CHECK_THAT(output, ContainsSubstring("<h1 id=\"title\">Title</h1>"));
+}
+
+TEST_CASE("HtmlRenderer: rendering into a warm buffer allocates independently of size",
+          "[html_stream]")
+{
+    const auto small = parse(make_prose(1'000));
+    const auto large = parse(make_prose(10'000));
+    HtmlRenderer renderer;
+    HtmlSanitizer sanitizer;
+
+    std::string output;
+    renderer.render_into(large, output, &sanitizer); // Warm the buffers up
+
+    auto render_warm = [&](const MarkdownDocument& document)
+    {
+        return count_allocations(
+            [&]
+            {
+                output.clear();
+                renderer.render_into(document, output, &sanitizer);
+            });
+    };
+    // Only per-render bookkeeping (the profiler scope) allocates, not per block
+    CHECK(render_warm(small) <= 8);
+    CHECK(render_warm(large) <= 8);
+}
+
+// ═══════════════════════════════════════════════════════
+// IncrementalRenderer and PreviewRenderer
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("IncrementalRenderer: fragments are cached sanitized", "[html_stream]")
+{
+    HtmlRenderer renderer;
+    HtmlSanitizer sanitizer;
+    IncrementalRenderer incremental(renderer);
+    incremental.set_sanitizer(&sanitizer);
+
+    std::string first;
+    REQUIRE(incremental.render_into(kUnsafe, first).has_value());
+    CHECK(first.find("<script") == std::string::npos);
+
+    HtmlRenderer reference;
+    std::string expected;
+    reference.render_into(parse(kUnsafe), expected, &sanitizer);
+    CHECK(first == expected);
+
+    std::string second = "<body>";
+    REQUIRE(incremental.render_into(kUnsafe, second).has_value());
+    CHECK(second == "<body>" + first);
+    CHECK(incremental.last_stats().blocks_reused == incremental.last_stats().blocks_total);
+}
+
+TEST_CASE("PreviewRenderer: renders into the buffer it is given", "[html_stream][pipeline]")
+{
+    PreviewRenderer preview;
+    DocumentSnapshot snapshot;
+    snapshot.version = 1;
+    snapshot.content = std::make_shared<const std::string>(kUnsafe);
+    const CancelToken cancel;
+
+    std::string buffer;
+    buffer.reserve(64 * 1024);
+    const auto* const storage = buffer.data();
+    auto result = preview.run(snapshot, cancel, std::move(buffer));
+    REQUIRE(result.has_value());
+    CHECK(result->body_html.data() == storage);
+    CHECK_THAT(result->body_html, ContainsSubstring("<h1 id=\"title\">"));
+    CHECK(result->body_html.find("<script") == std::string::npos);
+}
@@ -0,0 +1,376 @@
+#include "core/Md4cWrapper.h"
+#include "rendering/HtmlRenderer.h"
+#include "rendering/ImageCache.h"
+#include "rendering/IncrementalRenderer.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace markamp::rendering;
+using Catch::Matchers::ContainsSubstring;
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/// A scratch directory, removed on destruction.
+class TempDir
+{
+public:
+    explicit TempDir(const std::string& name)
+        : root_(fs::temp_directory_path() / ("markamp_images_" + name))
+    {
+        fs::remove_all(root_);
+        fs::create_directories(root_);
+    }
+
+    ~TempDir()
+    {
+        std::error_code error;
+        fs::remove_all(root_, error);
+    }
+
+    TempDir(const TempDir&) = delete;
+    auto operator=(const TempDir&) -> TempDir& = delete;
+
+    auto write(const std::string& name, const std::string& bytes) const -> fs::path
+    {
+        const auto path = root_ / name;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << bytes;
+        return path;
+    }
+
+    [[nodiscard]] auto root() const -> const fs::path&
+    {
+        return root_;
+    }
+
+private:
+    fs::path root_;
+};
+
+/// Content large enough to be downscaled.
+auto large_image_bytes() -> std::string
+{
+    return std::string(static_cast<std::size_t>(ImageCache::kDownscaleThreshold), 'P');
+}
+
+auto render_markdown(HtmlRenderer& renderer, std::string_view markdown) -> std::string
+{
+    markamp::core::Md4cParser parser;
+    auto document = parser.parse(markdown);
+    REQUIRE(document.has_value());
+    return renderer.render(*document);
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Full-size data URIs
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("ImageCache: repeated lookups reuse the encoded data URI", "[image_cache]")
+{
+    TempDir dir("reuse");
+    const auto image = dir.write("a.png", "PNGDATA");
+    ImageCache cache({}, {});
+
+    auto first = cache.lookup(image, 800);
+    REQUIRE(first.data_uri != nullptr);
+    CHECK_FALSE(first.pending);
+    CHECK(*first.data_uri == encode_data_uri("image/png", "PNGDATA"));
+
+    auto second = cache.lookup(image, 800);
+    CHECK(second.data_uri == first.data_uri);
+    CHECK(cache.stats().hits == 1);
+    CHECK(cache.stats().misses == 1);
+}
+
+TEST_CASE("ImageCache: changed images are re-encoded", "[image_cache]")
+{
+    TempDir dir("changed");
+    const auto image = dir.write("a.jpg", "old");
+    ImageCache cache({}, {});
+    auto before = cache.lookup(image, 0);
+    REQUIRE(before.data_uri != nullptr);
+
+    dir.write("a.jpg", "newer");
+    fs::last_write_time(image, fs::last_write_time(image) + std::chrono::seconds(2));
+
+    auto after = cache.lookup(image, 0);
+    REQUIRE(after.data_uri != nullptr);
+    CHECK(*after.data_uri == encode_data_uri("image/jpeg", "newer"));
+    CHECK(cache.stats().misses == 2);
+}
+
+TEST_CASE("ImageCache: unreadable and unknown files yield no data URI", "[image_cache]")
+{
+    TempDir dir("invalid");
+    ImageCache cache({}, {});
+
+    CHECK(cache.lookup(dir.root() / "missing.png", 0).data_uri == nullptr);
+    CHECK(cache.lookup(dir.write("notes.txt", "text"), 0).data_uri == nullptr);
+    CHECK(cache.lookup(dir.write("empty.png", ""), 0).data_uri == nullptr);
+    CHECK(cache.lookup(dir.root(), 0).data_uri == nullptr);
+}
+
+TEST_CASE("ImageCache: memory use stays within the byte cap", "[image_cache]")
+{
+    TempDir dir("cap");
+    const std::size_t cap = 4096;
+    ImageCache cache({}, {}, cap);
+
+    for (int index = 0; index < 10; ++index)
+    {
+        const auto name = "img" + std::to_string(index) + ".png";
+        const auto image = dir.write(name, std::string(1000, 'x'));
+        REQUIRE(cache.lookup(image, 0).data_uri != nullptr);
+        CHECK(cache.cached_bytes() <= cap);
+    }
+    CHECK(cache.cached_bytes() > 0);
+}
+
+// ═══════════════════════════════════════════════════════
+// Downscaled variants
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("ImageCache: width buckets", "[image_cache]")
+{
+    CHECK(ImageCache::width_bucket(0) == 0);
+    CHECK(ImageCache::width_bucket(1) == ImageCache::kWidthStep);
+    CHECK(ImageCache::width_bucket(ImageCache::kWidthStep) == ImageCache::kWidthStep);
+    CHECK(ImageCache::width_bucket(ImageCache::kWidthStep + 1) == 2 * ImageCache::kWidthStep);
+}
+
+TEST_CASE("ImageCache: large images are embedded as a scaled variant", "[image_cache]")
+{
+    TempDir dir("variant");
+    const auto image = dir.write("photo.png", large_image_bytes());
+    const auto variants = dir.root() / "variants";
+
+    std::atomic<int> scaled{0};
+    std::atomic<int> scaled_width{0};
+    std::atomic<int> ready{0};
+    auto scaler = [&](const fs::path& /*source*/, int max_width, std::string_view mime)
+        -> std::optional<std::string>
+    {
+        ++scaled;
+        scaled_width = max_width;
+        CHECK(mime == "image/png");
+        return std::string("small");
+    };
+
+    {
+        ImageCache cache(variants, scaler);
+        cache.set_ready_callback([&]() { ++ready; });
+
+        auto pending = cache.lookup(image, 700);
+        CHECK(pending.pending);
+        CHECK(pending.data_uri == nullptr);
+        cache.wait_idle();
+
+        auto done = cache.lookup(image, 700);
+        CHECK_FALSE(done.pending);
+        REQUIRE(done.data_uri != nullptr);
+        CHECK(*done.data_uri == encode_data_uri("image/png", "small"));
+        CHECK(scaled == 1);
+        CHECK(scaled_width == ImageCache::width_bucket(700));
+        CHECK(cache.stats().variants_scaled == 1);
+
+        // Full size stays available for previews without a width (export)
+        auto full = cache.lookup(image, 0);
+        REQUIRE(full.data_uri != nullptr);
+        CHECK(full.data_uri->size() > done.data_uri->size());
+    }
+    CHECK(ready >= 1);
+
+    // A new session reads the variant back from disk instead of rescaling
+    ImageCache reopened(variants, scaler);
+    auto reloaded = reopened.lookup(image, 700);
+    CHECK_FALSE(reloaded.pending);
+    REQUIRE(reloaded.data_uri != nullptr);
+    CHECK(*reloaded.data_uri == encode_data_uri("image/png", "small"));
+    CHECK(scaled == 1);
+    CHECK(reopened.stats().variants_loaded == 1);
+}
+
+TEST_CASE("ImageCache: the variant directory is pruned to its byte cap", "[image_cache]")
+{
+    TempDir dir("prune");
+    const auto variants = dir.root() / "variants";
+    fs::create_directories(variants);
+
+    // Four old variants, least recently used first
+    const auto now = fs::file_time_type::clock::now();
+    for (int index = 0; index < 4; ++index)
+    {
+        const auto path = variants / ("old" + std::to_string(index) + ".png");
+        std::ofstream(path, std::ios::binary) << std::string(100, 'v');
+        fs::last_write_time(path, now - std::chrono::hours(4 - index));
+    }
+    auto scaler = [](const fs::path&, int, std::string_view) -> std::optional<std::string>
+    { return std::string(150, 's'); };
+
+    // At startup: down to three quarters of the cap, oldest first
+    ImageCache cache(variants, scaler, ImageCache::kDefaultMaxBytes, 300);
+    cache.wait_idle();
+    CHECK_FALSE(fs::exists(variants / "old0.png"));
+    CHECK_FALSE(fs::exists(variants / "old1.png"));
+    CHECK(fs::exists(variants / "old2.png"));
+    CHECK(fs::exists(variants / "old3.png"));
+    CHECK(cache.stats().variants_pruned == 2);
+
+    // A new variant takes the directory over the cap again
+    CHECK(cache.lookup(dir.write("photo.png", large_image_bytes()), 700).pending);
+    cache.wait_idle();
+    CHECK_FALSE(fs::exists(variants / "old2.png"));
+    CHECK_FALSE(fs::exists(variants / "old3.png"));
+    CHECK(cache.stats().variants_pruned == 4);
+    std::size_t remaining = 0;
+    for (const auto& entry : fs::directory_iterator(variants))
+    {
+        remaining += entry.is_regular_file() ? 1 : 0;
+    }
+    CHECK(remaining == 1);
+}
+
+TEST_CASE("ImageCache: images the scaler declines are embedded at full size", "[image_cache]")
+{
+    TempDir dir("declined");
+    const auto image = dir.write("narrow.jpeg", large_image_bytes());
+    std::atomic<int> calls{0};
+    ImageCache cache({},
+                     [&](const fs::path&, int, std::string_view) -> std::optional<std::string>
+                     {
+                         ++calls;
+                         return std::nullopt;
+                     });
+
+    CHECK(cache.lookup(image, 500).pending);
+    cache.wait_idle();
+
+    auto entry = cache.lookup(image, 500);
+    CHECK_FALSE(entry.pending);
+    REQUIRE(entry.data_uri != nullptr);
+    CHECK(entry.data_uri->starts_with("data:image/jpeg;base64,"));
+    CHECK(cache.lookup(image, 500).data_uri == entry.data_uri);
+    CHECK(calls == 1);
+}
+
+TEST_CASE("ImageCache: small and vector images are never scaled", "[image_cache]")
+{
+    TempDir dir("unscaled");
+    std::atomic<int> calls{0};
+    ImageCache cache({},
+                     [&](const fs::path&, int, std::string_view) -> std::optional<std::string>
+                     {
+                         ++calls;
+                         return std::string("small");
+                     });
+
+    CHECK_FALSE(cache.lookup(dir.write("icon.png", "tiny"), 500).pending);
+    CHECK_FALSE(cache.lookup(dir.write("diagram.svg", large_image_bytes()), 500).pending);
+    CHECK_FALSE(cache.lookup(dir.write("anim.gif", large_image_bytes()), 500).pending);
+    cache.wait_idle();
+    CHECK(calls == 0);
+}
+
+// ═══════════════════════════════════════════════════════
+// HtmlRenderer integration
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("HtmlRenderer: images come from the image cache", "[image_cache][html_renderer]")
+{
+    TempDir dir("renderer");
+    dir.write("small.png", "PNGDATA");
+    dir.write("large.png", large_image_bytes());
+    ImageCache cache({},
+                     [](const fs::path&, int, std::string_view) -> std::optional<std::string>
+                     { return std::string("small"); });
+
+    HtmlRenderer renderer;
+    renderer.set_base_path(dir.root());
+    renderer.set_image_cache(&cache, 640);
+
+    auto html = render_markdown(renderer, "![logo](small.png)\n\n![photo](large.png)\n");
+    CHECK_THAT(html, ContainsSubstring(encode_data_uri("image/png", "PNGDATA")));
+    CHECK_THAT(html, ContainsSubstring("image-loading"));
+
+    cache.wait_idle();
+    html = render_markdown(renderer, "![logo](small.png)\n\n![photo](large.png)\n");
+    CHECK_THAT(html, ContainsSubstring(encode_data_uri("image/png", "small")));
+    CHECK(html.find("image-loading") == std::string::npos);
+    CHECK(cache.stats().hits >= 1);
+}
+
+TEST_CASE("IncrementalRenderer: an image changed on disk re-renders its block",
+          "[image_cache][html_renderer]")
+{
+    TempDir dir("incremental");
+    const auto image = dir.write("logo.png", "PNGDATA");
+    ImageCache cache({}, {});
+
+    HtmlRenderer renderer;
+    renderer.set_base_path(dir.root());
+    renderer.set_image_cache(&cache);
+    IncrementalRenderer incremental(renderer);
+
+    constexpr std::string_view md = "Intro\n\n![logo](logo.png)\n";
+    auto html = incremental.render(md);
+    REQUIRE(html.has_value());
+    CHECK_THAT(*html, ContainsSubstring(encode_data_uri("image/png", "PNGDATA")));
+
+    // Unchanged text and image: both blocks are reused
+    REQUIRE(incremental.render(md).has_value());
+    CHECK(incremental.last_stats().blocks_reused == 2);
+
+    dir.write("logo.png", "NEWPNGDATA");
+    fs::last_write_time(image, fs::last_write_time(image) + std::chrono::seconds(1));
+    html = incremental.render(md);
+    REQUIRE(html.has_value());
+    CHECK_THAT(*html, ContainsSubstring(encode_data_uri("image/png", "NEWPNGDATA")));
+    CHECK(incremental.last_stats().blocks_reused == 1);
+    CHECK(incremental.last_stats().blocks_rendered == 1);
+}
+
+TEST_CASE("IncrementalRenderer: only blocks with a pending placeholder re-render",
+          "[image_cache][html_renderer]")
+{
+    TempDir dir("incremental_pending");
+    dir.write("large.png", large_image_bytes());
+    ImageCache cache({},
+                     [](const fs::path&, int, std::string_view) -> std::optional<std::string>
+                     { return std::string("small"); });
+
+    HtmlRenderer renderer;
+    renderer.set_base_path(dir.root());
+    renderer.set_image_cache(&cache, 640);
+    IncrementalRenderer incremental(renderer);
+
+    constexpr std::string_view md = "Intro\n\n![photo](large.png)\n\nOutro\n";
+    auto html = incremental.render(md);
+    REQUIRE(html.has_value());
+    CHECK_THAT(*html, ContainsSubstring("image-loading"));
+    CHECK(renderer.pending_placeholders() == 1);
+
+    // The variant is ready: the placeholder block is replaced without an
+    // invalidate(), the text around it is reused
+    cache.wait_idle();
+    html = incremental.render(md);
+    REQUIRE(html.has_value());
+    CHECK_THAT(*html, ContainsSubstring(encode_data_uri("image/png", "small")));
+    CHECK(html->find("image-loading") == std::string::npos);
+    CHECK(incremental.last_stats().blocks_rendered == 1);
+    CHECK(incremental.last_stats().blocks_reused == 2);
+
+    REQUIRE(incremental.render(md).has_value());
+    CHECK(incremental.last_stats().blocks_reused == 3);
+}
@@ -0,0 +1,385 @@
+#include "core/IncrementalSearcher.h"
+#include "core/SearchPattern.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace markamp::core;
+
+namespace
+{
+
+using Match = std::tuple<std::size_t, std::size_t, std::string>; // line, column, line text
+
+struct SearchResult
+{
+    std::vector<Match> matches;
+    std::size_t total{0};
+};
+
+/// Run a search to completion (or until `limit` matches were delivered).
+auto run_search(IncrementalSearcher& searcher,
+                std::string content,
+                SearchConfig config,
+                std::size_t limit = static_cast<std::size_t>(-1)) -> SearchResult
+{
+    SearchResult result;
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    bool done = false;
+    searcher.search(
+        std::move(content),
+        std::move(config),
+        [&](std::size_t line, std::size_t col, std::string_view line_content)
+        {
+            result.matches.emplace_back(line, col, std::string(line_content));
+            return result.matches.size() < limit;
+        },
+        [&](std::size_t total)
+        {
+            std::lock_guard lock(mutex);
+            result.total = total;
+            done = true;
+            done_cv.notify_all();
+        });
+    std::unique_lock lock(mutex);
+    REQUIRE(done_cv.wait_for(lock, std::chrono::seconds(30), [&] { return done; }));
+    lock.unlock();
+    searcher.cancel();
+    return result;
+}
+
+auto lower(char character) -> char
+{
+    return (character >= 'A' && character <= 'Z') ? static_cast<char>(character - 'A' + 'a')
+                                                   : character;
+}
+
+auto is_word(char character) -> bool
+{
+    return std::isalnum(static_cast<unsigned char>(character)) != 0;
+}
+
+/// Byte-by-byte reference for literal search (the pre-SIMD algorithm).
+auto naive_search(std::string_view content, const SearchConfig& config) -> std::vector<Match>
+{
+    std::vector<Match> matches;
+    const std::string_view needle = config.needle;
+    std::size_t line = 0;
+    std::size_t line_start = 0;
+    for (std::size_t pos = 0; pos < content.size(); ++pos)
+    {
+        if (pos > 0 && content[pos - 1] == '\n')
+        {
+            ++line;
+            line_start = pos;
+        }
+        if (needle.empty() || pos + needle.size() > content.size())
+        {
+            continue;
+        }
+        bool equal = true;
+        for (std::size_t index = 0; index < needle.size() && equal; ++index)
+        {
+            equal = config.case_sensitive
+                        ? content[pos + index] == needle[index]
+                        : lower(content[pos + index]) == lower(needle[index]);
+        }
+        if (!equal)
+        {
+            continue;
+        }
+        const auto after = pos + needle.size();
+        if (config.whole_word && ((pos > 0 && is_word(content[pos - 1])) ||
+                                  (after < content.size() && is_word(content[after]))))
+        {
+            continue;
+        }
+        auto line_end = content.find('\n', line_start);
+        if (line_end == std::string_view::npos)
+        {
+            line_end = content.size();
+        }
+        matches.emplace_back(
+            line, pos - line_start, std::string(content.substr(line_start, line_end - line_start)));
+    }
+    return matches;
+}
+
+/// Markdown-ish text with `needle` sprinkled in at varying columns.
+auto make_corpus(std::size_t lines, std::string_view needle) -> std::string
+{
+    std::string text;
+    for (std::size_t line = 0; line < lines; ++line)
+    {
+        if (line % 40 == 0)
+        {
+            text += "## Section " + std::to_string(line / 40) + "\n";
+            continue;
+        }
+        text += "Some *markdown* text with `code` and a [link](https://example.com) ";
+        text.append(line % 23, 'x');
+        if (line % 7 == 0)
+        {
+            text += line % 2 == 0 ? std::string(needle) : std::string(" Needle");
+            text += line % 3 == 0 ? "s" : " tail";
+        }
+        text += '\n';
+    }
+    return text;
+}
+
+} // anonymous namespace
+
+// ═══════════════════════════════════════════════════════
+// SearchPattern
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("SearchPattern: SIMD filter agrees with a byte-by-byte scan", "[search][simd]")
+{
+    // Needle lengths and positions straddle every 16- and 32-byte block edge
+    for (std::size_t length = 1; length <= 40; ++length)
+    {
+        std::string needle;
+        for (std::size_t index = 0; index < length; ++index)
+        {
+            needle += static_cast<char>('a' + (index * 7) % 26);
+        }
+        std::string text(200, '.');
+        for (std::size_t pos = 0; pos + length <= text.size(); pos += 13)
+        {
+            text.replace(pos, length, needle);
+        }
+        text[text.size() - 1] = '\n';
+        text.replace(text.size() - length, length, needle); // Flush with the end
+
+        for (const bool case_sensitive : {true, false})
+        {
+            SearchConfig config{.needle = needle, .case_sensitive = case_sensitive};
+            if (!case_sensitive)
+            {
+                config.needle[0] = static_cast<char>(config.needle[0] - 'a' + 'A');
+            }
+            auto pattern = SearchPattern::compile(config);
+            REQUIRE(pattern.has_value());
+            std::vector<SearchHit> hits;
+            pattern->find_all(text, hits);
+            const auto expected = naive_search(text, config);
+            REQUIRE(hits.size() == expected.size());
+            for (std::size_t index = 0; index < hits.size(); ++index)
+            {
+                CHECK(hits[index].line == std::get<0>(expected[index]));
+                CHECK(hits[index].offset - hits[index].line_start == std::get<1>(expected[index]));
+            }
+        }
+    }
+}
+
+TEST_CASE("SearchPattern: literal matching rules", "[search]")
+{
+    auto count = [](std::string_view text, SearchConfig config)
+    {
+        auto pattern = SearchPattern::compile(config);
+        REQUIRE(pattern.has_value());
+        std::vector<SearchHit> hits;
+        pattern->find_all(text, hits);
+        return hits.size();
+    };
+
+    CHECK(count("aaaa", {.needle = "aa"}) == 3); // Overlapping
+    CHECK(count("Foo foo FOO", {.needle = "foo"}) == 1);
+    CHECK(count("Foo foo FOO", {.needle = "foo", .case_sensitive = false}) == 3);
+    CHECK(count("cat concat cat_ cat", {.needle = "cat", .whole_word = true}) == 3);
+    // Only ASCII folds: "é" does not match "É"
+    CHECK(count("\xC3\xA9t\xC3\xA9 \xC3\x89T\xC3\x89",
+                {.needle = "\xC3\xA9", .case_sensitive = false}) == 2);
+    CHECK(count("anything", {.needle = ""}) == 0);
+}
+
+TEST_CASE("SearchPattern: regex matches line by line", "[search][regex]")
+{
+    const std::string text = "# Title\nbody text\n## Sub #1\nfoo12 xfoo3 FOO4\n";
+    auto hits_for = [&text](SearchConfig config)
+    {
+        config.use_regex = true;
+        auto pattern = SearchPattern::compile(config);
+        REQUIRE(pattern.has_value());
+        std::vector<SearchHit> hits;
+        REQUIRE(pattern->find_all(text, hits) == 4);
+        return hits;
+    };
+
+    // `^` anchors at every line start, never mid-line
+    auto headings = hits_for({.needle = "^#+ "});
+    REQUIRE(headings.size() == 2);
+    CHECK(headings[0].line == 0);
+    CHECK(headings[1].line == 2);
+    CHECK(headings[1].length == 3);
+
+    auto words = hits_for({.needle = R"(\bfoo\d+)", .case_sensitive = false});
+    REQUIRE(words.size() == 2);
+    CHECK(words[0].offset - words[0].line_start == 0);
+    CHECK(words[1].offset - words[1].line_start == 12);
+
+    CHECK(hits_for({.needle = "t$"}).size() == 1);   // "body text"
+    CHECK(hits_for({.needle = "x*"}).size() == 2);   // "text", "xfoo3"; empty matches skipped
+    CHECK(hits_for({.needle = ".\n."}).empty());     // Never spans lines
+    CHECK(hits_for({.needle = "foo\\d+", .whole_word = true}).size() == 1);
+
+    auto invalid = SearchPattern::compile({.needle = "(unclosed", .use_regex = true});
+    CHECK_FALSE(invalid.has_value());
+}
+
+// ═══════════════════════════════════════════════════════
+// IncrementalSearcher
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("IncrementalSearcher: delivers matches with line and column", "[search]")
+{
+    IncrementalSearcher searcher;
+    auto result = run_search(searcher, "alpha beta\ngamma beta\n\nbeta", {.needle = "beta"});
+    REQUIRE(result.total == 3);
+    REQUIRE(result.matches.size() == 3);
+    CHECK(result.matches[0] == Match{0, 6, "alpha beta"});
+    CHECK(result.matches[1] == Match{1, 6, "gamma beta"});
+    CHECK(result.matches[2] == Match{3, 0, "beta"});
+}
+
+TEST_CASE("IncrementalSearcher: chunked parallel scan matches a serial scan", "[search]")
+{
+    const auto corpus = make_corpus(5000, "needle");
+    for (const auto& config : {SearchConfig{.needle = "needle"},
+                               SearchConfig{.needle = "needle", .case_sensitive = false},
+                               SearchConfig{.needle = "needle", .whole_word = true},
+                               SearchConfig{.needle = "x"}})
+    {
+        const auto expected = naive_search(corpus, config);
+        REQUIRE_FALSE(expected.empty());
+
+        // Tiny chunks force hundreds of out-of-order completions
+        IncrementalSearcher parallel(4, 1024);
+        auto result = run_search(parallel, corpus, config);
+        CHECK(result.total == expected.size());
+        CHECK(result.matches == expected);
+
+        IncrementalSearcher serial(1);
+        CHECK(run_search(serial, corpus, config).matches == expected);
+    }
+}
+
+TEST_CASE("IncrementalSearcher: regex search across chunks", "[search][regex]")
+{
+    const auto corpus = make_corpus(2000, "needle");
+    IncrementalSearcher searcher(3, 512);
+    auto result =
+        run_search(searcher, corpus, {.needle = R"(^## Section (\d+)$)", .use_regex = true});
+    REQUIRE(result.total == 50);
+    for (std::size_t index = 0; index < result.matches.size(); ++index)
+    {
+        CHECK(std::get<0>(result.matches[index]) == index * 40);
+        CHECK(std::get<2>(result.matches[index]) == "## Section " + std::to_string(index));
+    }
+}
+
+TEST_CASE("IncrementalSearcher: needle spanning lines", "[search]")
+{
+    IncrementalSearcher searcher(4, 4);
+    auto result = run_search(searcher, "one\ntwo\none\ntwo\n", {.needle = "e\nt"});
+    REQUIRE(result.total == 2);
+    CHECK(result.matches[0] == Match{0, 2, "one"});
+    CHECK(result.matches[1] == Match{2, 2, "one"});
+}
+
+TEST_CASE("IncrementalSearcher: returning false stops delivery", "[search]")
+{
+    const auto corpus = make_corpus(5000, "needle");
+    IncrementalSearcher searcher(4, 1024);
+    auto result = run_search(searcher, corpus, {.needle = "needle"}, 5);
+    CHECK(result.matches.size() == 5);
+    CHECK(result.total == 5);
+    const auto expected = naive_search(corpus, {.needle = "needle"});
+    CHECK(result.matches == std::vector<Match>(expected.begin(), expected.begin() + 5));
+}
+
+TEST_CASE("IncrementalSearcher: invalid regex completes with no matches", "[search][regex]")
+{
+    IncrementalSearcher searcher;
+    auto result = run_search(searcher, "text", {.needle = "[", .use_regex = true});
+    CHECK(result.total == 0);
+    CHECK(result.matches.empty());
+}
+
+TEST_CASE("IncrementalSearcher: new search cancels the previous one", "[search]")
+{
+    const auto corpus = make_corpus(20000, "needle");
+    IncrementalSearcher searcher(2, 4096);
+    std::atomic<int> first_completions{0};
+    searcher.search(
+        corpus,
+        {.needle = "x"},
+        [](std::size_t, std::size_t, std::string_view) { return true; },
+        [&first_completions](std::size_t) { ++first_completions; });
+    auto result = run_search(searcher, corpus, {.needle = "Section 7\n"});
+    CHECK(result.total == 1);
+    CHECK_FALSE(searcher.is_searching());
+    CHECK(first_completions.load() <= 1); // Finished before the cancel, or never
+}
+
+// ═══════════════════════════════════════════════════════
+// Benchmark
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("IncrementalSearcher — GB/s on 500 MB of Markdown", "[.][benchmark][search]")
+{
+    // Divide the corpus size by the mean time for GB/s; the WARN lines
+    // report one timed pass per mode directly
+    std::string corpus;
+    {
+        const auto block = make_corpus(4000, "needle");
+        corpus.reserve(500U * 1024U * 1024U + block.size());
+        while (corpus.size() < 500U * 1024U * 1024U)
+        {
+            corpus += block;
+        }
+    }
+    const double gigabytes = static_cast<double>(corpus.size()) / 1e9;
+
+    IncrementalSearcher serial(1);
+    IncrementalSearcher parallel;
+    const std::vector<std::pair<std::string, SearchConfig>> modes = {
+        {"rare literal", {.needle = "## Section 99\n"}},
+        {"rare literal, ignore case", {.needle = "## SECTION 99\n", .case_sensitive = false}},
+        {"common literal, whole word", {.needle = "needle", .whole_word = true}},
+        {"regex", {.needle = R"(^## Section 9\d$)", .use_regex = true}},
+    };
+    for (const auto& [label, config] : modes)
+    {
+        for (auto* searcher : {&serial, &parallel})
+        {
+            const auto name = label + (searcher == &serial ? " (1 thread)" : " (all threads)");
+            auto content = corpus; // Copied outside the timed region
+            const auto start = std::chrono::steady_clock::now();
+            const auto total = run_search(*searcher, std::move(content), config).total;
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            WARN(name << ": " << gigabytes / elapsed.count() << " GB/s (" << total
+                      << " matches delivered)");
+        }
+    }
+
+    BENCHMARK("rare literal (all threads)")
+    {
+        return run_search(parallel, corpus, modes[0].second).total;
+    };
+}
@@ -0,0 +1,308 @@
+#include "core/Md4cWrapper.h"
+#include "core/MermaidRenderer.h"
+#include "rendering/HtmlRenderer.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// The fake mmdc is a POSIX shell script
+#ifndef _WIN32
+
+using markamp::core::MermaidRenderer;
+using Catch::Matchers::ContainsSubstring;
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/// A scratch directory holding a fake `mmdc` that logs each run.
+///
+/// The fake writes an SVG echoing the diagram source and the configured
+/// theme, with a script tag and an event handler the renderer must strip.
+/// Diagrams containing "fail" exit with status 1.
+class FakeMmdc
+{
+public:
+    explicit FakeMmdc(const std::string& name, std::string_view delay_seconds = "0")
+        : root_(fs::temp_directory_path() / ("markamp_mermaid_" + name))
+    {
+        fs::remove_all(root_);
+        fs::create_directories(root_);
+
+        std::ofstream script(command());
+        script << "#!/bin/sh\n"
+                  "while [ $# -gt 0 ]; do\n"
+                  "  case \"$1\" in\n"
+                  "    -i) in=\"$2\"; shift ;;\n"
+                  "    -o) out=\"$2\"; shift ;;\n"
+                  "    -c) cfg=\"$2\"; shift ;;\n"
+                  "  esac\n"
+                  "  shift\n"
+                  "done\n"
+               << "echo run >> \"" << log_path().string() << "\"\n"
+               << "sleep " << delay_seconds << "\n"
+               << "if grep -q fail \"$in\"; then exit 1; fi\n"
+                  "theme=$(sed -n 's/.*\"theme\": \"\\([a-z]*\\)\".*/\\1/p' \"$cfg\")\n"
+                  "printf '<svg data-theme=\"%s\" onclick=\"x()\"><text>%s</text>"
+                  "<script>bad()</script></svg>' \"$theme\" \"$(cat \"$in\")\" > \"$out\"\n";
+        script.close();
+        fs::permissions(command(), fs::perms::owner_all, fs::perm_options::add);
+    }
+
+    ~FakeMmdc()
+    {
+        std::error_code error;
+        fs::remove_all(root_, error);
+    }
+
+    FakeMmdc(const FakeMmdc&) = delete;
+    auto operator=(const FakeMmdc&) -> FakeMmdc& = delete;
+
+    [[nodiscard]] auto command() const -> std::string
+    {
+        return (root_ / "mmdc").string();
+    }
+
+    [[nodiscard]] auto cache_dir() const -> fs::path
+    {
+        return root_ / "cache";
+    }
+
+    [[nodiscard]] auto root() const -> const fs::path&
+    {
+        return root_;
+    }
+
+    /// Number of times the fake was run.
+    [[nodiscard]] auto invocations() const -> int
+    {
+        std::ifstream log(log_path());
+        int runs = 0;
+        for (std::string line; std::getline(log, line);)
+        {
+            ++runs;
+        }
+        return runs;
+    }
+
+private:
+    [[nodiscard]] auto log_path() const -> fs::path
+    {
+        return root_ / "runs.log";
+    }
+
+    fs::path root_;
+};
+
+const std::string kDiagram = "graph TD; A-->B;";
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Rendering and caching
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("MermaidRenderer: renders through mmdc and sanitizes the SVG", "[mermaid_cache]")
+{
+    FakeMmdc mmdc("render");
+    MermaidRenderer renderer({}, mmdc.command());
+    REQUIRE(renderer.is_available());
+
+    auto svg = renderer.render(kDiagram);
+    REQUIRE(svg.has_value());
+    CHECK_THAT(*svg, ContainsSubstring("<text>graph TD; A-->B;</text>"));
+    CHECK_THAT(*svg, ContainsSubstring("data-theme=\"dark\""));
+    CHECK(svg->find("<script") == std::string::npos);
+    CHECK(svg->find("onclick") == std::string::npos);
+
+    CHECK(renderer.render(kDiagram) == svg);
+    CHECK(mmdc.invocations() == 1);
+    CHECK(renderer.stats().memory_hits == 1);
+}
+
+TEST_CASE("MermaidRenderer: the on-disk cache survives a restart", "[mermaid_cache]")
+{
+    FakeMmdc mmdc("restart");
+    std::string first_svg;
+    {
+        MermaidRenderer first(mmdc.cache_dir(), mmdc.command());
+        auto svg = first.render(kDiagram);
+        REQUIRE(svg.has_value());
+        first_svg = *svg;
+    }
+
+    MermaidRenderer second(mmdc.cache_dir(), mmdc.command());
+    auto svg = second.render(kDiagram);
+    REQUIRE(svg.has_value());
+    CHECK(*svg == first_svg);
+    CHECK(mmdc.invocations() == 1);
+    CHECK(second.stats().disk_hits == 1);
+}
+
+TEST_CASE("MermaidRenderer: the theme is part of the cache key", "[mermaid_cache]")
+{
+    FakeMmdc mmdc("theme");
+    MermaidRenderer renderer(mmdc.cache_dir(), mmdc.command());
+    REQUIRE(renderer.render(kDiagram).has_value());
+
+    renderer.set_diagram_theme("forest");
+    auto forest = renderer.render(kDiagram);
+    REQUIRE(forest.has_value());
+    CHECK_THAT(*forest, ContainsSubstring("data-theme=\"forest\""));
+    CHECK(mmdc.invocations() == 2);
+
+    // Switching back does not re-render, in this session or the next
+    renderer.set_diagram_theme("dark");
+    auto dark = renderer.render(kDiagram);
+    REQUIRE(dark.has_value());
+    CHECK_THAT(*dark, ContainsSubstring("data-theme=\"dark\""));
+
+    MermaidRenderer restarted(mmdc.cache_dir(), mmdc.command());
+    restarted.set_diagram_theme("forest");
+    CHECK(restarted.render(kDiagram) == forest);
+    CHECK(mmdc.invocations() == 2);
+}
+
+TEST_CASE("MermaidRenderer: failed renders are not written to disk", "[mermaid_cache]")
+{
+    FakeMmdc mmdc("failure");
+    const std::string broken = "graph fail";
+    {
+        MermaidRenderer renderer(mmdc.cache_dir(), mmdc.command());
+        CHECK_FALSE(renderer.render(broken).has_value());
+        CHECK_FALSE(renderer.render(broken).has_value());
+        CHECK(mmdc.invocations() == 1);
+    }
+
+    MermaidRenderer restarted(mmdc.cache_dir(), mmdc.command());
+    CHECK_FALSE(restarted.render(broken).has_value());
+    CHECK(mmdc.invocations() == 2);
+}
+
+TEST_CASE("MermaidRenderer: the on-disk cache drops the least recently used SVGs",
+          "[mermaid_cache]")
+{
+    FakeMmdc mmdc("prune");
+    const std::array<std::string, 4> diagrams{
+        "graph TD; A-->B;", "graph TD; B-->C;", "graph TD; C-->D;", "graph TD; D-->E;"};
+
+    // Render the first three and age them: C-->D newest, B-->C oldest
+    std::vector<fs::path> files;
+    {
+        MermaidRenderer renderer(mmdc.cache_dir(), mmdc.command());
+        const auto now = fs::file_time_type::clock::now();
+        for (int i = 0; i < 3; ++i)
+        {
+            REQUIRE(renderer.render(diagrams[static_cast<size_t>(i)]).has_value());
+            for (const auto& entry : fs::directory_iterator(mmdc.cache_dir()))
+            {
+                if (std::find(files.begin(), files.end(), entry.path()) == files.end())
+                {
+                    files.push_back(entry.path());
+                }
+            }
+            REQUIRE(files.size() == static_cast<size_t>(i) + 1);
+        }
+        fs::last_write_time(files[0], now - std::chrono::hours(2));
+        fs::last_write_time(files[1], now - std::chrono::hours(3));
+        fs::last_write_time(files[2], now - std::chrono::hours(1));
+    }
+    const auto svg_bytes = fs::file_size(files[0]);
+
+    // Room for two and a half SVGs; reading B-->C back makes it the newest
+    MermaidRenderer renderer(mmdc.cache_dir(), mmdc.command(), 1, svg_bytes * 5 / 2);
+    REQUIRE(renderer.render(diagrams[1]).has_value());
+    CHECK(renderer.stats().disk_hits == 1);
+    REQUIRE(renderer.render(diagrams[3]).has_value());
+
+    CHECK(renderer.stats().disk_pruned == 2);
+    CHECK_FALSE(fs::exists(files[0]));
+    CHECK(fs::exists(files[1]));
+    CHECK_FALSE(fs::exists(files[2]));
+    CHECK(mmdc.invocations() == 4);
+}
+
+// ═══════════════════════════════════════════════════════
+// Process pool
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("MermaidRenderer: try_render renders misses in parallel in the background",
+          "[mermaid_cache]")
+{
+    FakeMmdc mmdc("pool", "0.5");
+    MermaidRenderer renderer(mmdc.cache_dir(), mmdc.command(), 4);
+    std::atomic<int> ready{0};
+    const auto listener = renderer.add_ready_listener([&ready]() { ++ready; });
+
+    const std::array<std::string, 4> diagrams{
+        "graph TD; A-->B;", "graph TD; B-->C;", "graph TD; C-->D;", "graph TD; D-->E;"};
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& diagram : diagrams)
+    {
+        CHECK_FALSE(renderer.try_render(diagram).has_value());
+    }
+    CHECK_FALSE(renderer.try_render(diagrams[0]).has_value()); // Still pending, not queued twice
+    renderer.wait_idle();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Four half-second renders take two seconds one after another
+    CHECK(elapsed < std::chrono::milliseconds(1500));
+    CHECK(ready == 4);
+    CHECK(mmdc.invocations() == 4);
+    for (const auto& diagram : diagrams)
+    {
+        auto result = renderer.try_render(diagram);
+        REQUIRE(result.has_value());
+        CHECK_THAT(result->value(), ContainsSubstring(diagram));
+    }
+
+    renderer.remove_ready_listener(listener);
+    CHECK_FALSE(renderer.try_render("graph LR; X-->Y;").has_value());
+    renderer.wait_idle();
+    CHECK(ready == 4);
+}
+
+TEST_CASE("MermaidRenderer: is_available looks mmdc up without running it", "[mermaid_cache]")
+{
+    FakeMmdc mmdc("detect");
+    CHECK(MermaidRenderer({}, mmdc.command()).is_available());
+    CHECK_FALSE(MermaidRenderer({}, (mmdc.root() / "missing").string()).is_available());
+    CHECK_FALSE(MermaidRenderer({}, "markamp-no-such-mmdc").is_available());
+
+    const std::string saved_path = std::getenv("PATH") != nullptr ? std::getenv("PATH") : "";
+    ::setenv("PATH", (mmdc.root().string() + ":" + saved_path).c_str(), 1);
+    CHECK(MermaidRenderer({}, "mmdc").is_available());
+    ::setenv("PATH", saved_path.c_str(), 1);
+
+    CHECK(mmdc.invocations() == 0);
+}
+
+TEST_CASE("HtmlRenderer: pending Mermaid diagrams show a placeholder", "[mermaid_cache]")
+{
+    FakeMmdc mmdc("preview");
+    MermaidRenderer mermaid(mmdc.cache_dir(), mmdc.command());
+    markamp::rendering::HtmlRenderer renderer;
+    renderer.set_mermaid_renderer(&mermaid);
+
+    markamp::core::Md4cParser parser;
+    auto document = parser.parse("```mermaid\n" + kDiagram + "\n```\n");
+    REQUIRE(document.has_value());
+
+    CHECK_THAT(renderer.render(*document), ContainsSubstring("Rendering diagram"));
+    mermaid.wait_idle();
+    CHECK_THAT(renderer.render(*document), ContainsSubstring("data:image/svg+xml;base64,"));
+    CHECK(mmdc.invocations() == 1);
+}
+
+#endif // _WIN32
@@ -0,0 +1,184 @@
+#include "core/MinimapRenderer.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace markamp::core;
+
+namespace
+{
+
+constexpr Color kBackground{0, 0, 0};
+constexpr Color kText{200, 200, 200};
+constexpr Color kHeading{255, 0, 0};
+
+/// A document with one style run per line: style 1 on lines starting '#'.
+struct Document
+{
+    std::vector<std::string> lines;
+    std::size_t reads{0};
+
+    auto source() -> MinimapRenderer::LineSource
+    {
+        return [this](std::size_t line)
+        {
+            ++reads;
+            MinimapRenderer::Line result;
+            if (line < lines.size())
+            {
+                result.text = lines[line];
+                const uint16_t style = lines[line].starts_with('#') ? 1 : 0;
+                result.runs.push_back(
+                    StyleRun{0, static_cast<uint32_t>(lines[line].size()), style});
+            }
+            return result;
+        };
+    }
+};
+
+auto make_renderer(std::size_t line_count) -> MinimapRenderer
+{
+    MinimapRenderer renderer;
+    renderer.set_geometry(40, 2);
+    renderer.set_palette({kText, kHeading}, kBackground);
+    renderer.reset(line_count);
+    return renderer;
+}
+
+auto pixel(const MinimapImage& image, int column, int row) -> Color
+{
+    const auto* rgb =
+        image.rgb.data() + (static_cast<std::size_t>(row) * image.width + column) * 3;
+    return Color{rgb[0], rgb[1], rgb[2]};
+}
+
+auto same(Color lhs, Color rhs) -> bool
+{
+    return lhs.r == rhs.r && lhs.g == rhs.g && lhs.b == rhs.b;
+}
+
+auto numbered_document(std::size_t count) -> Document
+{
+    Document doc;
+    for (std::size_t index = 0; index < count; ++index)
+    {
+        doc.lines.push_back("line " + std::to_string(index) + "\n");
+    }
+    return doc;
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Rasterization
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("MinimapRenderer: lines are bars of style colours", "[minimap]")
+{
+    Document doc{{"# Title\n", "\tab c\n", "\xC3\xA9t\xC3\xA9\n"}};
+    auto renderer = make_renderer(doc.lines.size());
+
+    const auto image = renderer.paint_rows(0, 8, doc.source());
+    REQUIRE(image.width == 40);
+    REQUIRE(image.height == 8);
+
+    // "# Title": both rows of the line, whitespace left empty
+    CHECK(same(pixel(image, 0, 0), kHeading));
+    CHECK(same(pixel(image, 0, 1), kHeading));
+    CHECK(same(pixel(image, 1, 0), kBackground));
+    CHECK(same(pixel(image, 6, 0), kHeading));
+    CHECK(same(pixel(image, 7, 0), kBackground));
+
+    // A tab advances to the next multiple of kTabColumns
+    CHECK(same(pixel(image, 3, 2), kBackground));
+    CHECK(same(pixel(image, MinimapRenderer::kTabColumns, 2), kText));
+
+    // Multi-byte characters take one column
+    CHECK(same(pixel(image, 2, 4), kText));
+    CHECK(same(pixel(image, 3, 4), kBackground));
+
+    // Past the last line
+    CHECK(same(pixel(image, 0, 6), kBackground));
+}
+
+TEST_CASE("MinimapRenderer: scroll position follows the editor", "[minimap]")
+{
+    auto renderer = make_renderer(1000); // 2000 rows
+    CHECK(renderer.scroll_top(0, 50, 500) == 0);
+    CHECK(renderer.scroll_top(950, 50, 500) == 1500);
+    CHECK(renderer.scroll_top(475, 50, 500) == 750);
+    CHECK(renderer.line_at(1501) == 750);
+
+    auto small = make_renderer(10);
+    CHECK(small.scroll_top(5, 5, 500) == 0);
+    CHECK(small.line_at(100'000) == 9);
+}
+
+// ═══════════════════════════════════════════════════════
+// Tile cache
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("MinimapRenderer: only the tiles in view are rendered", "[minimap]")
+{
+    auto doc = numbered_document(100'000);
+    auto renderer = make_renderer(doc.lines.size());
+
+    // 500 rows of 2 px lines starting mid-tile: five tiles
+    const int tile_rows = static_cast<int>(MinimapRenderer::kTileLines) * 2;
+    static_cast<void>(renderer.paint_rows(tile_rows * 100 + 100, 500, doc.source()));
+    CHECK(renderer.stats().tiles_rendered == 5);
+    CHECK(doc.reads == 5 * MinimapRenderer::kTileLines);
+
+    // Scrolling by a few rows reuses them
+    static_cast<void>(renderer.paint_rows(tile_rows * 100 + 110, 500, doc.source()));
+    CHECK(renderer.stats().tiles_rendered == 5);
+    CHECK(renderer.cache_bytes() <= MinimapRenderer::kMaxCacheBytes);
+}
+
+TEST_CASE("MinimapRenderer: edits re-render only the touched tiles", "[minimap]")
+{
+    auto doc = numbered_document(1000);
+    auto renderer = make_renderer(doc.lines.size());
+    const int tile_rows = static_cast<int>(MinimapRenderer::kTileLines) * 2;
+    static_cast<void>(renderer.paint_rows(0, tile_rows * 4, doc.source()));
+    static_cast<void>(renderer.take_dirty_lines());
+    REQUIRE(renderer.stats().tiles_rendered == 4);
+
+    // In-line edit on line 70 (tile 1)
+    doc.lines[70] = "# heading\n";
+    renderer.on_lines_changed(70, 0);
+    CHECK(renderer.take_dirty_lines() == std::pair<std::size_t, std::size_t>{70, 71});
+    auto image = renderer.paint_rows(0, tile_rows * 4, doc.source());
+    CHECK(renderer.stats().tiles_rendered == 5);
+    CHECK(same(pixel(image, 0, 140), kHeading));
+
+    // Inserting a line on line 200 (tile 3) moves everything below it
+    doc.lines.insert(doc.lines.begin() + 201, "new\n");
+    renderer.on_lines_changed(200, 1);
+    CHECK(renderer.line_count() == 1001);
+    CHECK(renderer.take_dirty_lines() == std::pair<std::size_t, std::size_t>{200, 1001});
+    static_cast<void>(renderer.paint_rows(0, tile_rows * 4, doc.source()));
+    CHECK(renderer.stats().tiles_rendered == 6);
+
+    // Restyled lines re-render their tile
+    renderer.invalidate_lines(10, 20);
+    static_cast<void>(renderer.paint_rows(0, tile_rows * 4, doc.source()));
+    CHECK(renderer.stats().tiles_rendered == 7);
+    CHECK(renderer.take_dirty_lines() == std::pair<std::size_t, std::size_t>{10, 20});
+    CHECK(renderer.take_dirty_lines() == std::pair<std::size_t, std::size_t>{0, 0});
+}
+
+TEST_CASE("MinimapRenderer: the tile cache stays under its byte cap", "[minimap]")
+{
+    auto doc = numbered_document(20'000);
+    MinimapRenderer renderer(256 * 1024);
+    renderer.set_geometry(120, 2);
+    renderer.reset(doc.lines.size());
+
+    static_cast<void>(renderer.paint_rows(0, renderer.content_height(), doc.source()));
+    CHECK(renderer.cache_bytes() <= 256 * 1024);
+    CHECK(renderer.stats().tiles_rendered ==
+          (doc.lines.size() + MinimapRenderer::kTileLines - 1) / MinimapRenderer::kTileLines);
+}
@@ -0,0 +1,186 @@
+#include "core/ChunkedStorage.h"
+#include "core/OutputChannelService.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace markamp::core;
+
+namespace
+{
+
+auto numbered_line(int index) -> std::string
+{
+    return "line " + std::to_string(index);
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// ChunkedRingBuffer
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("ChunkedRingBuffer: appends across chunks and drops from the front", "[output]")
+{
+    ChunkedRingBuffer<8> ring;
+    ring.append("abcdefghij");
+    ring.append("klmnopqrst");
+    REQUIRE(ring.size() == 20);
+    CHECK(ring.chunk_count() == 3);
+    CHECK(ring.read(6, 6) == "ghijkl");
+
+    ring.drop_front(9);
+    CHECK(ring.size() == 11);
+    CHECK(ring.chunk_count() == 2); // The first chunk is freed
+    CHECK(ring.read(0, 100) == "jklmnopqrst");
+
+    std::vector<std::string> spans;
+    ring.for_each_span(1, 8, [&spans](std::string_view span) { spans.emplace_back(span); });
+    CHECK(spans == std::vector<std::string>{"klmnop", "qr"});
+
+    ring.drop_front(100);
+    CHECK(ring.empty());
+    CHECK(ring.chunk_count() == 0);
+    ring.append("xyz");
+    CHECK(ring.read(0, 3) == "xyz");
+}
+
+// ═══════════════════════════════════════════════════════
+// OutputChannel
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("OutputChannel: change notifications carry the appended range", "[output]")
+{
+    OutputChannel channel("Build");
+    std::vector<OutputChange> changes;
+    channel.on_change([&changes](const OutputChannel&, const OutputChange& change)
+                      { changes.push_back(change); });
+
+    channel.append("abc");
+    channel.append_line("de");
+    REQUIRE(changes.size() == 2);
+    CHECK(changes[1].begin == 3);
+    CHECK(changes[1].end == 6);
+    CHECK(changes[1].first_retained == 0);
+    CHECK_FALSE(changes[1].cleared);
+
+    channel.clear();
+    REQUIRE(changes.size() == 3);
+    CHECK(changes[2].cleared);
+    CHECK(changes[2].first_retained == 6);
+    CHECK(channel.content().empty());
+
+    channel.append("f");
+    CHECK(changes.back().begin == 6);
+    CHECK(channel.end_offset() == 7);
+}
+
+TEST_CASE("OutputChannel: readers catch up with only the new text", "[output]")
+{
+    OutputChannel channel("Log");
+    OutputCursor cursor;
+
+    channel.append_line("one");
+    auto delta = channel.read_since(cursor);
+    CHECK_FALSE(delta.reset);
+    CHECK(delta.text == "one\n");
+
+    channel.append_line("two");
+    channel.append("thr");
+    delta = channel.read_since(cursor);
+    CHECK_FALSE(delta.reset);
+    CHECK(delta.text == "two\nthr");
+    CHECK(channel.read_since(cursor).text.empty());
+
+    // Clearing what the reader shows resets it
+    channel.clear();
+    delta = channel.read_since(cursor);
+    CHECK(delta.reset);
+    CHECK(delta.text.empty());
+    channel.append("ee");
+    CHECK(channel.read_since(cursor).text == "ee");
+}
+
+TEST_CASE("OutputChannel: the line cap trims whole lines to a low-water mark", "[output]")
+{
+    OutputChannel channel("Chatty", OutputLimits{0, 100});
+    OutputCursor cursor;
+
+    for (int index = 0; index < 100; ++index)
+    {
+        channel.append_line(numbered_line(index));
+    }
+    CHECK(channel.line_count() == 100);
+    CHECK(channel.start_offset() == 0);
+    static_cast<void>(channel.read_since(cursor));
+
+    channel.append_line(numbered_line(100));
+    CHECK(channel.line_count() == 75);
+    CHECK(channel.content().starts_with(numbered_line(26) + "\n"));
+
+    // The reader lost the front of what it showed
+    const auto delta = channel.read_since(cursor);
+    CHECK(delta.reset);
+    CHECK(delta.text == channel.content());
+
+    // Headroom: the next 25 lines append without trimming
+    for (int index = 101; index < 126; ++index)
+    {
+        channel.append_line(numbered_line(index));
+    }
+    CHECK(channel.line_count() == 100);
+    CHECK_FALSE(channel.read_since(cursor).reset);
+}
+
+TEST_CASE("OutputChannel: the byte cap bounds memory for hours of output", "[output]")
+{
+    constexpr std::size_t kMaxBytes = 64 * 1024;
+    OutputChannel channel("Extension", OutputLimits{kMaxBytes, 0});
+    std::size_t notifications = 0;
+    std::uint64_t appended = 0;
+    channel.on_content_change([&notifications](const OutputChannel&) { ++notifications; });
+
+    const std::string line(99, 'x');
+    for (int index = 0; index < 20'000; ++index)
+    {
+        channel.append_line(line);
+        appended += line.size() + 1;
+        REQUIRE(channel.size() <= kMaxBytes);
+    }
+    CHECK(notifications == 20'000);
+    CHECK(channel.end_offset() == appended);
+    CHECK(channel.size() >= kMaxBytes / 2);
+    CHECK(channel.content().front() == 'x'); // Trimmed on a line boundary
+    CHECK(channel.line_count() == channel.size() / 100);
+}
+
+TEST_CASE("OutputChannel: a single line over the byte cap is cut", "[output]")
+{
+    OutputChannel channel("Blob", OutputLimits{100, 0});
+    // Two-byte UTF-8 characters, no newline
+    std::string text;
+    for (int index = 0; index < 100; ++index)
+    {
+        text += "\xC3\xA9";
+    }
+    channel.append(text);
+
+    const auto content = channel.content();
+    CHECK(content.size() <= 100);
+    CHECK(content.size() % 2 == 0); // Not cut inside a character
+    CHECK(channel.end_offset() == text.size());
+
+    channel.set_limits(OutputLimits{10, 0});
+    CHECK(channel.size() <= 10);
+}
+
+TEST_CASE("OutputChannelService: default limits apply to new channels", "[output]")
+{
+    OutputChannelService service;
+    service.set_default_limits(OutputLimits{1024, 10});
+    auto* channel = service.create_channel("Capped");
+    CHECK(channel->limits().max_bytes == 1024);
+    CHECK(channel->limits().max_lines == 10);
+}
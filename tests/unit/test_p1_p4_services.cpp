@@ -515,10 +515,10 @@ TEST_CASE("EnvironmentService: overrides for testing", "[p3][environment]")
 }
 
 // ══════════════════════════════════════════
-// P3: GrammarEngine Stub (Gap 8)
+// P3: GrammarEngine (Gap 8)
 // ══════════════════════════════════════════
 
-TEST_CASE("GrammarEngine: stub returns defaults", "[p3][grammar]")
+TEST_CASE("GrammarEngine: returns defaults before any grammar loads", "[p3][grammar]")
 {
     GrammarEngine engine;
 
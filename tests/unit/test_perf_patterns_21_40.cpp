@@ -11,16 +11,25 @@
 ///   #28 GlyphAdvanceCache     #38 IMECompositionOverlay
 ///   #29 DoubleBufferedPaint   #39 ChunkedStorage
 ///   #30 ScrollBlit            #40 CompilerHints
+///
+/// Plus B-tree PieceTable (#3) scaling tests that exercise the 100k-edit
+/// sessions the #23 TextSpan iterators and #38 IME overlay sit on top of,
+/// and the AsyncHighlighter (#5) Markdown mode that feeds the editor's
+/// fenced code colouring off-thread.
 
 #include "core/AdaptiveThrottle.h"
+#include "core/AsyncHighlighter.h"
 #include "core/AsyncPipeline.h"
 #include "core/ChunkedStorage.h"
 #include "core/CompilerHints.h"
 #include "core/FrameBudgetToken.h"
 #include "core/GenerationCounter.h"
+#include "core/GrammarEngine.h"
 #include "core/GraphemeBoundaryCache.h"
+#include "core/HighlightLineCache.h"
 #include "core/IMECompositionOverlay.h"
 #include "core/InputPriorityDispatcher.h"
+#include "core/PieceTable.h"
 #include "core/StableLineId.h"
 #include "core/StyleRunStore.h"
 #include "core/TextSpan.h"
@@ -33,10 +42,18 @@
 #include "rendering/ScrollBlit.h"
 #include "rendering/SelectionPainter.h"
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 using namespace markamp::core;
 using namespace markamp::rendering;
@@ -1229,3 +1246,597 @@ TEST_CASE("CompilerHints — hot/cold attributes compile", "[compiler][p40]")
     cold_function();
     REQUIRE(true);
 }
+
+// ═══════════════════════════════════════════════════════
+// #3 PieceTable — B-tree scaling and snapshots
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+
+auto reference_line_start(const std::string& text, std::size_t line) -> std::size_t
+{
+    if (line == 0)
+    {
+        return 0;
+    }
+    std::size_t seen = 0;
+    for (std::size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '\n' && ++seen == line)
+        {
+            return i + 1;
+        }
+    }
+    return text.size();
+}
+
+/// Apply `edits` random inserts/erases (3:1) to a 1 MB document.
+void run_random_edits(PieceTable& table, int edits, std::mt19937& rng)
+{
+    for (int i = 0; i < edits; ++i)
+    {
+        const auto offset = rng() % (table.size() + 1);
+        if (i % 4 == 3)
+        {
+            table.erase(offset, 3);
+        }
+        else
+        {
+            table.insert(offset, "ab\n");
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("PieceTable — random edits match std::string", "[piecetable][p3]")
+{
+    std::mt19937 rng(1234);
+    std::string reference;
+    for (int i = 0; i < 2000; ++i)
+    {
+        reference += "line " + std::to_string(i) + "\n";
+    }
+    PieceTable table(reference);
+
+    for (int step = 0; step < 5000; ++step)
+    {
+        const auto offset = rng() % (reference.size() + 1);
+        if (rng() % 3 != 0)
+        {
+            const std::string text = (rng() % 5 == 0) ? "x\ny" : std::string(1 + rng() % 4, 'q');
+            table.insert(offset, text);
+            reference.insert(offset, text);
+        }
+        else
+        {
+            const auto count = static_cast<std::size_t>(rng() % 40);
+            table.erase(offset, count);
+            if (offset < reference.size())
+            {
+                reference.erase(offset, count);
+            }
+        }
+    }
+
+    REQUIRE(table.text() == reference);
+    REQUIRE(table.size() == reference.size());
+    REQUIRE(table.line_count() ==
+            static_cast<std::size_t>(std::count(reference.begin(), reference.end(), '\n')) + 1);
+
+    for (int probe = 0; probe < 200; ++probe)
+    {
+        const auto line = rng() % table.line_count();
+        REQUIRE(table.line_start(line) == reference_line_start(reference, line));
+
+        const auto offset = rng() % reference.size();
+        REQUIRE(table.at(offset) == reference[offset]);
+        REQUIRE(table.line_of_offset(offset) ==
+                static_cast<std::size_t>(std::count(
+                    reference.begin(), reference.begin() + static_cast<std::ptrdiff_t>(offset), '\n')));
+        REQUIRE(table.substr(offset, 50) == reference.substr(offset, 50));
+    }
+}
+
+TEST_CASE("PieceTable — line queries", "[piecetable][p3]")
+{
+    PieceTable table("alpha\nbeta\ngamma");
+    table.insert(6, "inserted\n");
+
+    REQUIRE(table.line_count() == 4);
+    REQUIRE(table.line(0) == "alpha");
+    REQUIRE(table.line(1) == "inserted");
+    REQUIRE(table.line(2) == "beta");
+    REQUIRE(table.line(3) == "gamma");
+    REQUIRE(table.line(4).empty());
+    REQUIRE(table.line_start(2) == 15);
+    REQUIRE(table.line_of_offset(15) == 2);
+    REQUIRE(table.line_of_offset(table.size()) == 3);
+}
+
+TEST_CASE("PieceTable — typing coalesces into one piece", "[piecetable][p3]")
+{
+    PieceTable table("# Title\n");
+    for (char c : std::string("hello world"))
+    {
+        table.insert(table.size(), std::string_view(&c, 1));
+    }
+    REQUIRE(table.text() == "# Title\nhello world");
+    REQUIRE(table.piece_count() == 2);
+}
+
+TEST_CASE("PieceTable — snapshot is isolated from later edits", "[piecetable][p3]")
+{
+    PieceTable table("Hello World");
+    auto frozen = table.snapshot();
+
+    table.insert(5, ", Beautiful");
+    table.erase(0, 1);
+    REQUIRE(table.text() == "ello, Beautiful World");
+    REQUIRE(frozen.text() == "Hello World");
+
+    // Editing the snapshot does not leak back either
+    frozen.insert(0, ">> ");
+    REQUIRE(frozen.text() == ">> Hello World");
+    REQUIRE(table.text() == "ello, Beautiful World");
+}
+
+TEST_CASE("PieceTable — snapshot readable on another thread while editing", "[piecetable][p3]")
+{
+    PieceTable table(std::string(100000, 'b'));
+    auto frozen = table.snapshot();
+    const auto expected = frozen.text();
+
+    bool consistent = true;
+    std::thread reader(
+        [&]()
+        {
+            for (int i = 0; i < 50 && consistent; ++i)
+            {
+                consistent = frozen.text() == expected && frozen.line_count() == 1;
+            }
+        });
+
+    std::mt19937 rng(7);
+    for (int i = 0; i < 20000; ++i)
+    {
+        table.insert(rng() % table.size(), "cd\n");
+    }
+    reader.join();
+
+    REQUIRE(consistent);
+    REQUIRE(table.size() == 100000 + 20000 * 3);
+}
+
+TEST_CASE("PieceTable — 100k edits keep the tree shallow", "[piecetable][p3]")
+{
+    std::mt19937 rng(99);
+    PieceTable table(std::string(static_cast<std::size_t>(1) << 20, 'a'));
+    run_random_edits(table, 100000, rng);
+
+    // 75k inserts of 3 bytes, 25k erases of up to 3 bytes
+    REQUIRE(table.size() >= (static_cast<std::size_t>(1) << 20) + 75000 * 3 - 25000 * 3);
+    REQUIRE(table.piece_count() > 100000);
+    // log_16(pieces) + 1 with a generous margin; a linear layout would not fit
+    REQUIRE(table.tree_height() <= 6);
+    REQUIRE(table.line_start(table.line_count() - 1) <= table.size());
+}
+
+TEST_CASE("PieceTable — edit scaling benchmark", "[.][benchmark][piecetable][p3]")
+{
+    const std::string document(static_cast<std::size_t>(1) << 20, 'a');
+
+    BENCHMARK("10k random edits")
+    {
+        std::mt19937 rng(1);
+        PieceTable table(document);
+        run_random_edits(table, 10000, rng);
+        return table.size();
+    };
+
+    BENCHMARK("100k random edits")
+    {
+        std::mt19937 rng(1);
+        PieceTable table(document);
+        run_random_edits(table, 100000, rng);
+        return table.size();
+    };
+
+    std::mt19937 rng(1);
+    PieceTable edited(document);
+    run_random_edits(edited, 100000, rng);
+
+    BENCHMARK("line_start after 100k edits")
+    {
+        std::size_t sum = 0;
+        for (std::size_t line = 0; line < edited.line_count(); line += 97)
+        {
+            sum += edited.line_start(line);
+        }
+        return sum;
+    };
+
+    BENCHMARK("substr 4KB after 100k edits")
+    {
+        return edited.substr(edited.size() / 2, 4096).size();
+    };
+
+    BENCHMARK("snapshot after 100k edits")
+    {
+        return edited.snapshot().size();
+    };
+}
+
+// ═══════════════════════════════════════════════════════
+// #5 AsyncHighlighter — fenced code in Markdown mode
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+
+/// Collects AsyncHighlighter results delivered on its worker thread.
+class ResultSink
+{
+public:
+    auto callback() -> AsyncHighlighter::ResultCallback
+    {
+        return [this](HighlightResult result)
+        {
+            std::lock_guard lock(mutex_);
+            results_.push_back(std::move(result));
+        };
+    }
+
+    /// Wait for the result tagged `version` (partial passes may come first).
+    auto wait_for(uint64_t version) -> std::optional<HighlightResult>
+    {
+        for (int attempt = 0; attempt < 500; ++attempt)
+        {
+            {
+                std::lock_guard lock(mutex_);
+                for (const auto& result : results_)
+                {
+                    if (result.version == version)
+                    {
+                        return result;
+                    }
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return std::nullopt;
+    }
+
+    /// Take every result delivered so far, in delivery order.
+    auto drain() -> std::vector<HighlightResult>
+    {
+        std::lock_guard lock(mutex_);
+        return std::exchange(results_, {});
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<HighlightResult> results_;
+};
+
+auto shared_text(std::string text) -> std::shared_ptr<const std::string>
+{
+    return std::make_shared<const std::string>(std::move(text));
+}
+
+} // namespace
+
+TEST_CASE("AsyncHighlighter — Markdown mode tokenizes fenced code per line", "[highlighter][p5]")
+{
+    ResultSink sink;
+    AsyncHighlighter highlighter(sink.callback());
+
+    const auto version = highlighter.set_markdown(
+        shared_text("# Title\n\n```cpp\nreturn x + 42;\n```\nprose with return\n~~~\nreturn\n~~~\n"));
+    auto result = sink.wait_for(version);
+    REQUIRE(result.has_value());
+
+    using Kind = HighlightLineKind;
+    REQUIRE(result->start_line == 0);
+    REQUIRE(result->end_line == 10);
+    REQUIRE(result->line_kinds == std::vector<Kind>{Kind::Markdown,
+                                                   Kind::Markdown,
+                                                   Kind::FenceMarker,
+                                                   Kind::Code,
+                                                   Kind::FenceMarker,
+                                                   Kind::Markdown,
+                                                   Kind::FenceMarker,
+                                                   Kind::Code,
+                                                   Kind::FenceMarker,
+                                                   Kind::Markdown});
+
+    // Starts are relative to the line; prose and unlabelled fences are not tokenized
+    const auto& code = result->tokens[3];
+    REQUIRE_FALSE(code.empty());
+    REQUIRE(code.front().type == TokenType::Keyword);
+    REQUIRE(code.front().start == 0);
+    REQUIRE(code.front().length == 6);
+    REQUIRE(std::ranges::any_of(code,
+                                [](const Token& token)
+                                { return token.type == TokenType::Number && token.start == 11; }));
+    REQUIRE(result->tokens[5].empty());
+    REQUIRE(result->tokens[7].empty());
+}
+
+TEST_CASE("AsyncHighlighter — edits re-lex only the enclosing block", "[highlighter][p5]")
+{
+    ResultSink sink;
+    AsyncHighlighter highlighter(sink.callback());
+
+    std::string text = "intro\n```cpp\nreturn a;\n```\n";
+    for (int i = 0; i < 500; ++i)
+    {
+        text += "paragraph line\n";
+    }
+    text += "```python\ndef f():\n    return 1\n```\ntail\n";
+    const auto first_version = highlighter.set_markdown(shared_text(text));
+    REQUIRE(sink.wait_for(first_version).has_value());
+
+    SECTION("editing inside a block stops after its closing fence")
+    {
+        // Line 2 "return a;" -> "return b;"
+        auto edited = text;
+        edited.replace(edited.find("return a;"), 9, "return b;");
+        const auto version = highlighter.update_markdown(shared_text(edited), LineEdit{2, 3, 0});
+
+        auto result = sink.wait_for(version);
+        REQUIRE(result.has_value());
+        REQUIRE(result->start_line == 1); // Opening fence
+        REQUIRE(result->end_line == 4);   // Through the closing fence
+        REQUIRE(result->tokens[1].front().type == TokenType::Keyword);
+    }
+
+    SECTION("inserted lines shift the converged states")
+    {
+        // Two new prose lines after line 0; the python block moves down by two
+        auto edited = text;
+        edited.insert(edited.find('\n') + 1, "new one\nnew two\n");
+        const auto version = highlighter.update_markdown(shared_text(edited), LineEdit{1, 3, 2});
+
+        auto result = sink.wait_for(version);
+        REQUIRE(result.has_value());
+        REQUIRE(result->start_line == 1);
+        REQUIRE(result->end_line == 6); // Converged after the cpp block
+
+        // A later edit inside the python block still finds its opening fence
+        auto again = edited;
+        again.replace(again.find("return 1"), 8, "return 2");
+        const auto python_return = 508;
+        const auto next = highlighter.update_markdown(
+            shared_text(again), LineEdit{python_return, python_return + 1, 0});
+        auto block = sink.wait_for(next);
+        REQUIRE(block.has_value());
+        REQUIRE(block->start_line == python_return - 2);
+        REQUIRE(block->end_line == python_return + 2);
+    }
+
+    SECTION("opening a fence recolours everything below it")
+    {
+        auto edited = text;
+        edited.insert(edited.find("paragraph"), "```\n");
+        const auto version = highlighter.update_markdown(shared_text(edited), LineEdit{4, 5, 1});
+
+        auto result = sink.wait_for(version);
+        REQUIRE(result.has_value());
+        REQUIRE(result->start_line == 4);
+        REQUIRE(result->line_kinds.front() == HighlightLineKind::FenceMarker);
+        REQUIRE(result->line_kinds[1] == HighlightLineKind::Code);
+        // The python block's closing fence now closes the new block
+        REQUIRE(result->end_line > 505);
+    }
+}
+
+TEST_CASE("AsyncHighlighter — cache matches a full re-lex after rapid edits",
+          "[highlighter][p5]")
+{
+    std::mt19937 rng(5);
+    std::vector<std::string> lines;
+    for (int i = 0; i < 4000; ++i)
+    {
+        lines.emplace_back(i % 40 == 0 ? "```cpp" : (i % 40 == 10 ? "```" : "return a + 1;"));
+    }
+    auto joined = [&lines]()
+    {
+        std::string text;
+        for (const auto& line : lines)
+        {
+            text += line;
+            text += '\n';
+        }
+        text.pop_back();
+        return shared_text(std::move(text));
+    };
+
+    ResultSink sink;
+    AsyncHighlighter highlighter(sink.callback());
+    HighlightLineCache cache;
+    cache.reset(lines.size(), highlighter.set_markdown(joined()));
+
+    // Edits race the worker; results are applied in order as they arrive
+    const std::vector<std::string> replacements{"```cpp", "```", "~~~python", "def f():", "text"};
+    uint64_t last_sent = 0;
+    for (int edit = 0; edit < 300; ++edit)
+    {
+        const auto line = rng() % (lines.size() - 1);
+        switch (rng() % 3)
+        {
+        case 0:
+            lines[line] = replacements[rng() % replacements.size()];
+            cache.on_columns_changed(line, 0, 0);
+            break;
+        case 1:
+            lines.insert(lines.begin() + static_cast<std::ptrdiff_t>(line) + 1,
+                         replacements[rng() % replacements.size()]);
+            cache.on_lines_changed(line, 1);
+            break;
+        default:
+            lines.erase(lines.begin() + static_cast<std::ptrdiff_t>(line) + 1);
+            cache.on_lines_changed(line, -1);
+            break;
+        }
+        if (edit % 3 == 0)
+        {
+            last_sent = highlighter.update_markdown(joined(), cache.unsent_edit());
+            cache.mark_sent(last_sent);
+        }
+        for (const auto& result : sink.drain())
+        {
+            (void)cache.apply(result);
+        }
+    }
+    last_sent = highlighter.update_markdown(joined(), cache.unsent_edit());
+    cache.mark_sent(last_sent);
+    REQUIRE(sink.wait_for(last_sent).has_value());
+    for (const auto& result : sink.drain())
+    {
+        (void)cache.apply(result);
+    }
+
+    ResultSink reference_sink;
+    AsyncHighlighter reference(reference_sink.callback());
+    auto full = reference_sink.wait_for(reference.set_markdown(joined()));
+    REQUIRE(full.has_value());
+    REQUIRE(cache.line_count() == lines.size());
+    REQUIRE(full->line_kinds.size() == lines.size());
+    for (std::size_t line = 0; line < lines.size(); ++line)
+    {
+        INFO("line " << line);
+        REQUIRE(cache.line(line).kind == full->line_kinds[line]);
+        REQUIRE(cache.line(line).tokens.size() == full->tokens[line].size());
+    }
+}
+
+TEST_CASE("AsyncHighlighter — extension grammars colour unknown fence languages",
+          "[highlighter][p5]")
+{
+    GrammarEngine grammars;
+    REQUIRE(grammars.load_grammar_json(R"json({
+        "scopeName": "source.demo",
+        "patterns": [
+            { "match": "\\b(let|if)\\b", "name": "keyword.control.demo" },
+            { "match": "\\b\\d+\\b", "name": "constant.numeric.demo" },
+            { "begin": "/\\*", "end": "\\*/", "name": "comment.block.demo" }
+        ]
+    })json"));
+    grammars.set_language_scope("demo", "source.demo");
+
+    ResultSink sink;
+    AsyncHighlighter highlighter(sink.callback());
+    highlighter.set_grammar_engine(&grammars);
+
+    const auto version =
+        highlighter.set_markdown(shared_text("```demo\nlet x = 42 /* a\nb */ if\n```\n"));
+    auto result = sink.wait_for(version);
+    REQUIRE(result.has_value());
+
+    const auto& first = result->tokens[1];
+    REQUIRE(first.size() == 3);
+    CHECK(first[0].type == TokenType::Keyword);
+    CHECK(first[0].start == 0);
+    CHECK(first[1].type == TokenType::Number);
+    CHECK(first[1].start == 8);
+    CHECK(first[2].type == TokenType::Comment);
+
+    // The block comment carries into the next line
+    const auto& second = result->tokens[2];
+    REQUIRE(second.size() == 2);
+    CHECK(second[0].type == TokenType::Comment);
+    CHECK(second[0].start == 0);
+    CHECK(second[0].length == 4);
+    CHECK(second[1].type == TokenType::Keyword);
+}
+
+TEST_CASE("LineEdit — merged edits cover both ranges", "[highlighter][p5]")
+{
+    // Line 10 edited, then (in the new numbering) lines 6-8 deleted after line 5
+    const LineEdit first{10, 11, 0};
+    const LineEdit second{5, 6, -3};
+    const auto merged = first.merged_with(second);
+    REQUIRE(merged.first_line == 5);
+    REQUIRE(merged.end_line == 8);
+    REQUIRE(merged.line_delta == -3);
+    REQUIRE(merged.old_end_line() == 11);
+
+    // Insertions above an edit move its end down
+    const auto grown = LineEdit{4, 5, 0}.merged_with(LineEdit{0, 3, 2});
+    REQUIRE(grown.first_line == 0);
+    REQUIRE(grown.end_line == 7);
+    REQUIRE(grown.old_end_line() == 5);
+}
+
+TEST_CASE("HighlightLineCache — maps stale results through later edits", "[highlighter][p5]")
+{
+    HighlightLineCache cache;
+    cache.reset(6, 1);
+
+    HighlightResult result;
+    result.version = 2;
+    result.start_line = 0;
+    result.end_line = 6;
+    result.line_kinds.assign(6, HighlightLineKind::Code);
+    result.tokens.resize(6);
+    for (std::size_t line = 0; line < 6; ++line)
+    {
+        result.tokens[line].push_back(Token{TokenType::Keyword, {}, line, 1});
+    }
+
+    // Version 2 was sent, then two lines were inserted after line 1
+    cache.on_lines_changed(0, 0);
+    REQUIRE(cache.has_unsent_edit());
+    cache.mark_sent(2);
+    REQUIRE_FALSE(cache.has_unsent_edit());
+    cache.on_lines_changed(1, 2);
+    REQUIRE(cache.line_count() == 8);
+    REQUIRE(cache.unsent_edit().line_delta == 2);
+
+    const auto [first, last] = cache.apply(result);
+    REQUIRE(first == 0);
+    REQUIRE(last == 8);
+
+    // Line 1 was edited after version 2 and keeps no stale tokens
+    REQUIRE(cache.line(0).tokens.front().start == 0);
+    REQUIRE(cache.line(1).tokens.empty());
+    REQUIRE(cache.line(2).tokens.empty());
+    REQUIRE(cache.line(4).tokens.front().start == 2); // Old line 2
+    REQUIRE(cache.line(7).tokens.front().start == 5); // Old line 5
+    REQUIRE(cache.is_dirty(7));
+
+    cache.mark_clean(0, 8);
+    REQUIRE_FALSE(cache.is_dirty(7));
+
+    // Results from before the last reset are ignored
+    cache.reset(3, 5);
+    REQUIRE(cache.apply(result) == std::pair<std::size_t, std::size_t>{0, 0});
+    REQUIRE(cache.line(0).kind == HighlightLineKind::Markdown);
+}
+
+TEST_CASE("HighlightLineCache — in-line edits keep tokens aligned", "[highlighter][p5]")
+{
+    HighlightLineCache cache;
+    cache.reset(1, 1);
+
+    HighlightResult result;
+    result.version = 1;
+    result.end_line = 1;
+    result.line_kinds = {HighlightLineKind::Code};
+    result.tokens = {{Token{TokenType::Keyword, {}, 0, 6}, Token{TokenType::Number, {}, 10, 2}}};
+    (void)cache.apply(result);
+
+    cache.on_columns_changed(0, 8, 3); // Typed three bytes between the tokens
+    REQUIRE(cache.line(0).tokens[0].start == 0);
+    REQUIRE(cache.line(0).tokens[1].start == 13);
+
+    cache.on_columns_changed(0, 2, -2); // Deleted inside the keyword
+    REQUIRE(cache.line(0).tokens[0].length == 4);
+    REQUIRE(cache.line(0).tokens[1].start == 11);
+
+    cache.on_columns_changed(0, 0, -4); // Deleted the rest of it
+    REQUIRE(cache.line(0).tokens.size() == 1);
+    REQUIRE(cache.line(0).tokens[0].start == 7);
+}
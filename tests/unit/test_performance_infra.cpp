@@ -267,6 +267,56 @@ TEST_CASE("SnapshotStore — publish and consume", "[snapshot]")
     }
 }
 
+TEST_CASE("LazyDocumentSnapshot — materialises once on demand", "[snapshot]")
+{
+    int producer_calls = 0;
+    LazyDocumentSnapshot handle(7,
+                                [&producer_calls]()
+                                {
+                                    ++producer_calls;
+                                    return std::make_shared<const std::string>("# Doc");
+                                });
+
+    REQUIRE(handle.version() == 7);
+    REQUIRE_FALSE(handle.is_materialized());
+    REQUIRE(producer_calls == 0);
+
+    auto first = handle.get();
+    auto second = handle.get();
+    REQUIRE(producer_calls == 1);
+    REQUIRE(first == second);
+    REQUIRE(first->version == 7);
+    REQUIRE(*handle.content() == "# Doc");
+
+    // Expiring after materialisation keeps the shared snapshot
+    handle.expire();
+    REQUIRE(handle.get() == first);
+}
+
+TEST_CASE("LazyDocumentSnapshot — expired before pull yields nullptr", "[snapshot]")
+{
+    int producer_calls = 0;
+    LazyDocumentSnapshot handle(1,
+                                [&producer_calls]()
+                                {
+                                    ++producer_calls;
+                                    return std::make_shared<const std::string>("stale");
+                                });
+    handle.expire();
+
+    REQUIRE(handle.get() == nullptr);
+    REQUIRE(handle.content() == nullptr);
+    REQUIRE(producer_calls == 0);
+}
+
+TEST_CASE("LazyDocumentSnapshot — from_content is already materialised", "[snapshot]")
+{
+    auto handle = LazyDocumentSnapshot::from_content(3, "text");
+    REQUIRE(handle->is_materialized());
+    REQUIRE(*handle->content() == "text");
+    REQUIRE(handle->get()->version == 3);
+}
+
 // ═══════════════════════════════════════════════════════
 // FrameHistogram tests
 // ═══════════════════════════════════════════════════════
@@ -2,11 +2,14 @@
 #include "core/EventBus.h"
 #include "core/Events.h"
 #include "core/ExtensionManifest.h"
+#include "core/GrammarEngine.h"
 #include "core/IPlugin.h"
 #include "core/PluginManager.h"
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <filesystem>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <vector>
@@ -332,3 +335,42 @@ TEST_CASE("PluginManager V2: unregister cleans up pending", "[plugin-manager-v2]
     REQUIRE(mgr.plugin_count() == 0);
     REQUIRE_FALSE(mgr.is_pending_activation("pub.lazy-ext"));
 }
+
+TEST_CASE("PluginManager V2: grammar paths resolve against the install directory",
+          "[plugin-manager-v2]")
+{
+    namespace fs = std::filesystem;
+
+    // An installed extension somewhere other than the working directory
+    const auto install_dir = fs::temp_directory_path() / "markamp_test_grammar_extension";
+    fs::create_directories(install_dir / "syntaxes");
+    {
+        std::ofstream out(install_dir / "syntaxes" / "demo.tmLanguage.json");
+        out << R"({"scopeName": "source.markamp-demo",
+                   "patterns": [ { "match": "demo", "name": "keyword.demo" } ]})";
+    }
+    REQUIRE_FALSE(fs::exists("syntaxes/demo.tmLanguage.json"));
+
+    EventBus bus;
+    Config cfg;
+    PluginManager mgr(bus, cfg);
+    GrammarEngine grammar_engine;
+    PluginManager::ExtensionServices services;
+    services.grammar_engine = &grammar_engine;
+    mgr.set_extension_services(services);
+
+    auto em = make_ext_manifest("grammar-ext", "pub");
+    em.contributes.grammars.push_back(ExtensionGrammar{
+        .language = "demo",
+        .scope_name = "source.markamp-demo",
+        .path = "./syntaxes/demo.tmLanguage.json",
+    });
+    mgr.register_plugin(make_test_plugin("pub.grammar-ext"), std::move(em), install_dir);
+    REQUIRE(mgr.activate_plugin("pub.grammar-ext"));
+
+    const auto* grammar = grammar_engine.get_grammar("source.markamp-demo");
+    REQUIRE(grammar != nullptr);
+    CHECK(grammar->path == (install_dir / "syntaxes" / "demo.tmLanguage.json").string());
+
+    fs::remove_all(install_dir);
+}
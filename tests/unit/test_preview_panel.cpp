@@ -2,11 +2,16 @@
 #include "core/Theme.h"
 #include "core/Types.h"
 #include "rendering/HtmlRenderer.h"
+#include "rendering/PreviewPipeline.h"
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <fmt/format.h>
+#include <memory>
+#include <thread>
 
 using namespace markamp::core;
 using Catch::Matchers::ContainsSubstring;
@@ -390,3 +395,134 @@ A --> B;
     REQUIRE_THAT(html, ContainsSubstring("mermaid-block"));
     REQUIRE_THAT(html, ContainsSubstring("checkbox"));
 }
+
+// ═══════════════════════════════════════════════════════
+// Background preview pipeline
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+
+auto make_snapshot(uint64_t version, std::string text) -> DocumentSnapshot
+{
+    DocumentSnapshot snapshot;
+    snapshot.version = version;
+    snapshot.content = std::make_shared<const std::string>(std::move(text));
+    return snapshot;
+}
+
+auto wait_for_latest(markamp::rendering::PreviewPipeline& pipeline)
+    -> std::optional<markamp::rendering::RenderedPreview>
+{
+    for (int attempt = 0; attempt < 200; ++attempt)
+    {
+        if (auto result = pipeline.take_latest())
+        {
+            return result;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+TEST_CASE("PreviewRenderer: renders sanitized HTML and code block sources", "[preview][pipeline]")
+{
+    markamp::rendering::PreviewRenderer renderer;
+    renderer.apply_settings({});
+
+    auto result = renderer.run(
+        make_snapshot(7, "# Title\n\n<script>alert(1)</script>\n\n```cpp\nint x;\n```\n"),
+        CancelToken{});
+
+    REQUIRE(result.has_value());
+    REQUIRE(result->version == 7);
+    REQUIRE(result->error.empty());
+    REQUIRE_THAT(result->body_html, ContainsSubstring("<h1 id=\"title\">"));
+    REQUIRE_FALSE(result->body_html.find("<script>") != std::string::npos);
+    REQUIRE(result->code_block_sources.size() == 1);
+    REQUIRE_THAT(result->code_block_sources[0], ContainsSubstring("int x;"));
+}
+
+TEST_CASE("PreviewRenderer: incremental and full paths agree", "[preview][pipeline]")
+{
+    const std::string markdown = "# A\n\nText[^1].\n\n[^1]: Note\n\n## A\n\n- one\n- two\n";
+
+    markamp::rendering::PreviewRenderer incremental;
+    incremental.apply_settings({});
+    markamp::rendering::PreviewRenderer full;
+    markamp::rendering::PreviewRenderSettings settings;
+    settings.incremental = false;
+    full.apply_settings(settings);
+
+    auto lhs = incremental.run(make_snapshot(1, markdown), CancelToken{});
+    auto rhs = full.run(make_snapshot(1, markdown), CancelToken{});
+    REQUIRE(lhs.has_value());
+    REQUIRE(rhs.has_value());
+    REQUIRE(lhs->body_html == rhs->body_html);
+}
+
+TEST_CASE("PreviewRenderer: cancelled token yields no result", "[preview][pipeline]")
+{
+    markamp::rendering::PreviewRenderer renderer;
+    renderer.apply_settings({});
+
+    CancelToken cancel;
+    cancel.request_stop();
+    REQUIRE_FALSE(renderer.run(make_snapshot(1, "# Title\n"), cancel).has_value());
+}
+
+TEST_CASE("PreviewRenderer: oversized content reports an error", "[preview][pipeline]")
+{
+    markamp::rendering::PreviewRenderer renderer;
+    renderer.apply_settings({});
+
+    auto result = renderer.run(
+        make_snapshot(1, std::string(markamp::rendering::PreviewRenderer::kMaxContentSize + 1, 'a')),
+        CancelToken{});
+    REQUIRE(result.has_value());
+    REQUIRE_FALSE(result->error.empty());
+    REQUIRE(result->body_html.empty());
+}
+
+TEST_CASE("PreviewPipeline: renders off-thread and notifies", "[preview][pipeline]")
+{
+    std::atomic<int> notifications{0};
+    markamp::rendering::PreviewPipeline pipeline([&notifications]() { ++notifications; });
+
+    auto version = pipeline.submit(std::make_shared<const std::string>("Hello **world**\n"));
+    auto result = wait_for_latest(pipeline);
+
+    REQUIRE(result.has_value());
+    REQUIRE(result->version == version);
+    REQUIRE(notifications.load() >= 1);
+    REQUIRE_THAT(result->body_html, ContainsSubstring("<strong>world</strong>"));
+    REQUIRE(*result->markdown == "Hello **world**\n");
+}
+
+TEST_CASE("PreviewPipeline: only the latest submission is delivered", "[preview][pipeline]")
+{
+    markamp::rendering::PreviewPipeline pipeline;
+
+    for (int i = 0; i < 20; ++i)
+    {
+        pipeline.submit(std::make_shared<const std::string>(fmt::format("# Revision {}\n", i)));
+    }
+    auto result = wait_for_latest(pipeline);
+
+    REQUIRE(result.has_value());
+    REQUIRE(result->version == pipeline.latest_version());
+    REQUIRE_THAT(result->body_html, ContainsSubstring("Revision 19"));
+}
+
+TEST_CASE("PreviewPipeline: discard_pending drops in-flight results", "[preview][pipeline]")
+{
+    markamp::rendering::PreviewPipeline pipeline;
+
+    pipeline.submit(std::make_shared<const std::string>("# Stale\n"));
+    pipeline.discard_pending();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    REQUIRE_FALSE(pipeline.take_latest().has_value());
+}
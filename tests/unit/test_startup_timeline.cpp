@@ -0,0 +1,252 @@
+#include "core/BuiltInPlugins.h"
+#include "core/Config.h"
+#include "core/DeferredStartup.h"
+#include "core/EventBus.h"
+#include "core/FeatureRegistry.h"
+#include "core/PluginManager.h"
+#include "core/StartupTimeline.h"
+#include "core/ThemeEngine.h"
+#include "core/ThemeRegistry.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_string.hpp>
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace markamp::core;
+using Catch::Matchers::ContainsSubstring;
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/// A temporary directory of `count` valid JSON user themes.
+class UserThemeDir
+{
+public:
+    UserThemeDir(const std::string& name, int count)
+        : root_(fs::temp_directory_path() / ("markamp_startup_" + name))
+    {
+        fs::remove_all(root_);
+        fs::create_directories(root_);
+
+        ThemeRegistry registry;
+        registry.initialize_builtin();
+        auto base = registry.get_theme(registry.list_themes().front().id);
+        REQUIRE(base.has_value());
+        for (int index = 0; index < count; ++index)
+        {
+            Theme theme = *base;
+            theme.id = "user-theme-" + std::to_string(index);
+            theme.name = "User Theme " + std::to_string(index);
+            const nlohmann::json json = theme;
+            std::ofstream(root_ / (theme.id + ".json")) << json.dump(2);
+        }
+        std::ofstream(root_ / "broken.json") << "{ not json";
+    }
+
+    ~UserThemeDir()
+    {
+        std::error_code error;
+        fs::remove_all(root_, error);
+    }
+
+    UserThemeDir(const UserThemeDir&) = delete;
+    auto operator=(const UserThemeDir&) -> UserThemeDir& = delete;
+
+    [[nodiscard]] auto path() const -> const fs::path&
+    {
+        return root_;
+    }
+
+private:
+    fs::path root_;
+};
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// StartupTimeline
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("StartupTimeline: records stages with their phase", "[startup]")
+{
+    StartupTimeline timeline;
+    {
+        auto stage = timeline.measure("config");
+    }
+    {
+        auto stage = timeline.measure("services", StartupPhase::Background);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    const auto stages = timeline.stages();
+    REQUIRE(stages.size() == 2);
+    CHECK(stages[0].name == "config");
+    CHECK(stages[0].phase == StartupPhase::Critical);
+    CHECK(stages[1].name == "services");
+    CHECK(stages[1].phase == StartupPhase::Background);
+    CHECK(stages[1].duration_ms >= 5.0);
+    CHECK(stages[1].start_ms >= stages[0].start_ms);
+
+    // Background work does not count towards the critical path
+    CHECK(timeline.critical_path_ms() == stages[0].duration_ms);
+    CHECK_THAT(timeline.report(), ContainsSubstring("background"));
+}
+
+TEST_CASE("StartupTimeline: only the first paint is recorded", "[startup]")
+{
+    StartupTimeline timeline;
+    CHECK_FALSE(timeline.time_to_first_paint_ms().has_value());
+
+    timeline.mark_first_paint();
+    const auto first = timeline.time_to_first_paint_ms();
+    REQUIRE(first.has_value());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    timeline.mark_first_paint();
+    CHECK(timeline.time_to_first_paint_ms() == first);
+    CHECK_THAT(timeline.report(), ContainsSubstring("first paint"));
+}
+
+// ═══════════════════════════════════════════════════════
+// DeferredStartup
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("DeferredStartup: runs tasks in order off the calling thread", "[startup]")
+{
+    StartupTimeline timeline;
+    const auto caller = std::this_thread::get_id();
+    std::vector<std::string> order;
+    std::atomic<bool> off_thread{true};
+    std::atomic<bool> completed{false};
+
+    DeferredStartup deferred(timeline);
+    for (const std::string name : {"first", "throws", "second"})
+    {
+        deferred.add(name,
+                     [&, name]()
+                     {
+                         off_thread = off_thread && std::this_thread::get_id() != caller;
+                         order.push_back(name);
+                         if (name == "throws")
+                         {
+                             throw std::runtime_error("task failed");
+                         }
+                     });
+    }
+    CHECK_FALSE(deferred.started());
+
+    deferred.start([&completed]() { completed = true; });
+    deferred.add("late", [&order]() { order.emplace_back("late"); });
+    deferred.wait();
+
+    CHECK(deferred.finished());
+    CHECK(completed);
+    CHECK(off_thread);
+    CHECK(order == std::vector<std::string>{"first", "throws", "second"});
+
+    const auto stages = timeline.stages();
+    REQUIRE(stages.size() == 3);
+    CHECK(stages[2].name == "second");
+    CHECK(stages[2].phase == StartupPhase::Background);
+}
+
+// ═══════════════════════════════════════════════════════
+// User themes
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("ThemeRegistry: user themes are scanned apart from registration", "[startup][theme]")
+{
+    UserThemeDir dir("scan", 3);
+    auto scanned = ThemeRegistry::scan_user_themes(dir.path());
+    REQUIRE(scanned.has_value());
+    CHECK(scanned->size() == 3); // broken.json is skipped
+
+    ThemeRegistry registry;
+    registry.initialize_builtin();
+    const auto builtin_count = registry.theme_count();
+    registry.add_user_themes(*scanned);
+    registry.add_user_themes(*scanned); // Same ids replace, not duplicate
+    CHECK(registry.theme_count() == builtin_count + 3);
+    CHECK(registry.has_theme("user-theme-2"));
+    CHECK_FALSE(registry.is_builtin("user-theme-2"));
+
+    CHECK(ThemeRegistry::scan_user_themes(dir.path() / "missing")->empty());
+}
+
+// ═══════════════════════════════════════════════════════
+// Critical path budget
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("Startup: the critical path fits the first-paint budget", "[startup]")
+{
+    // The same core stages MarkAmpApp::OnInit runs before showing the frame,
+    // with a large user theme directory left to the deferred thread.
+    UserThemeDir dir("budget", 200);
+    StartupTimeline timeline;
+
+    std::unique_ptr<EventBus> bus;
+    std::unique_ptr<Config> config;
+    std::unique_ptr<ThemeRegistry> registry;
+    std::unique_ptr<ThemeEngine> engine;
+    std::unique_ptr<FeatureRegistry> features;
+    std::unique_ptr<PluginManager> plugins;
+    {
+        auto stage = timeline.measure("event_bus");
+        bus = std::make_unique<EventBus>();
+    }
+    {
+        auto stage = timeline.measure("config");
+        config = std::make_unique<Config>();
+    }
+    {
+        auto stage = timeline.measure("themes");
+        registry = std::make_unique<ThemeRegistry>();
+        registry->initialize_builtin();
+        engine = std::make_unique<ThemeEngine>(*bus, *registry);
+    }
+    {
+        auto stage = timeline.measure("plugins");
+        features = std::make_unique<FeatureRegistry>(*bus, *config);
+        plugins = std::make_unique<PluginManager>(*bus, *config);
+        register_builtin_plugins(*plugins, *features);
+    }
+
+    std::vector<Theme> user_themes;
+    DeferredStartup deferred(timeline);
+    deferred.add("user_themes",
+                 [&user_themes, &dir]()
+                 {
+                     if (auto scanned = ThemeRegistry::scan_user_themes(dir.path()))
+                     {
+                         user_themes = std::move(*scanned);
+                     }
+                 });
+    timeline.mark_first_paint();
+    deferred.start();
+
+    const auto first_paint = timeline.time_to_first_paint_ms();
+    REQUIRE(first_paint.has_value());
+    INFO(timeline.report());
+    CHECK(*first_paint < StartupTimeline::kCriticalPathBudgetMs);
+    CHECK(timeline.critical_path_ms() <= *first_paint);
+
+    deferred.wait();
+    {
+        auto stage = timeline.measure("activate_plugins", StartupPhase::Deferred);
+        registry->add_user_themes(std::move(user_themes));
+        plugins->activate_all();
+    }
+    CHECK(registry->has_theme("user-theme-199"));
+    CHECK(plugins->plugin_count() == 7);
+}
@@ -174,10 +174,17 @@ TEST_CASE("EventBus delivers EditorContentChangedEvent for word counting", "[sta
 
     auto subscription = bus.subscribe<markamp::core::events::EditorContentChangedEvent>(
         [&](const markamp::core::events::EditorContentChangedEvent& evt)
-        { word_count_result = count_words(evt.content); });
+        {
+            auto content = evt.content();
+            REQUIRE(content != nullptr);
+            word_count_result = count_words(*content);
+        });
 
     markamp::core::events::EditorContentChangedEvent evt;
-    evt.content = "The quick brown fox jumps over the lazy dog";
+    evt.version = 1;
+    evt.full_replace = true;
+    evt.snapshot = markamp::core::LazyDocumentSnapshot::from_content(
+        1, "The quick brown fox jumps over the lazy dog");
     bus.publish(evt);
 
     REQUIRE(word_count_result == 9);
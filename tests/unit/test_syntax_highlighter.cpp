@@ -3,9 +3,17 @@
 #include "rendering/CodeBlockRenderer.h"
 #include "rendering/HtmlRenderer.h"
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 using namespace markamp::core;
 using namespace markamp::rendering;
 using Catch::Matchers::ContainsSubstring;
@@ -633,3 +641,358 @@ TEST_CASE("Go: keywords and constants", "[syntax][go]")
     CHECK(found_var);
     CHECK(found_nil);
 }
+
+// ═══════════════════════════════════════════════════════
+// Compiled keyword tables & allocation-free tokenization
+// ═══════════════════════════════════════════════════════
+
+namespace
+{
+
+/// One representative snippet per built-in language.
+auto language_samples() -> const std::vector<std::pair<std::string, std::string>>&
+{
+    static const std::vector<std::pair<std::string, std::string>> samples = {
+        {"javascript",
+         "import { readFile } from 'fs';\n"
+         "export async function load(path, options = {}) {\n"
+         "  const text = await readFile(path, 'utf8'); // read\n"
+         "  if (text === null || typeof text !== 'string') { return undefined; }\n"
+         "  return text.split('\\n').map((line, i) => `${i}: ${line}`);\n"
+         "}\n"},
+        {"typescript",
+         "interface Options { retries: number; verbose?: boolean }\n"
+         "export class Loader<T> implements Iterable<T> {\n"
+         "  private readonly items: Array<T> = [];\n"
+         "  constructor(public name: string, opts: Options) { super(); }\n"
+         "  async *[Symbol.iterator](): Promise<void> { yield* this.items; }\n"
+         "}\n"},
+        {"python",
+         "@dataclass\n"
+         "class Worker(Base):\n"
+         "    def run(self, jobs: list[int]) -> None:\n"
+         "        for job in jobs:  # process each\n"
+         "            if job is None or not isinstance(job, int):\n"
+         "                raise ValueError(\"bad job %d\" % job)\n"
+         "            yield lambda x: x * 2 + 0x1F\n"},
+        {"c",
+         "#include <stdio.h>\n"
+         "static const int MAX_ITEMS = 128;\n"
+         "typedef struct node { struct node* next; unsigned long value; } node_t;\n"
+         "int sum(const node_t* head) {\n"
+         "    long total = 0; /* running total */\n"
+         "    while (head != NULL) { total += head->value; head = head->next; }\n"
+         "    return (int)total;\n"
+         "}\n"},
+        {"cpp",
+         "#include <vector>\n"
+         "namespace app {\n"
+         "template <typename T> class Buffer final : public Base {\n"
+         "public:\n"
+         "    explicit Buffer(std::size_t n) noexcept : data_(n) {}\n"
+         "    [[nodiscard]] auto size() const -> std::size_t { return data_.size(); }\n"
+         "    virtual ~Buffer() override = default; // dtor\n"
+         "private:\n"
+         "    std::vector<T> data_; bool dirty_{false}; double ratio_ = 1.5e3;\n"
+         "};\n"
+         "} // namespace app\n"},
+        {"rust",
+         "use std::collections::HashMap;\n"
+         "pub struct Cache<'a> { map: HashMap<&'a str, Vec<u8>> }\n"
+         "impl<'a> Cache<'a> {\n"
+         "    pub fn get(&self, key: &str) -> Option<&Vec<u8>> {\n"
+         "        match self.map.get(key) { Some(v) => Some(v), None => None } // lookup\n"
+         "    }\n"
+         "    fn len(&self) -> usize {\n"
+         "        let mut n: usize = 0; for _ in self.map.iter() { n += 1; } n\n"
+         "    }\n"
+         "}\n"},
+        {"go",
+         "package main\n"
+         "import \"fmt\"\n"
+         "type Server struct { addr string; port int }\n"
+         "func (s *Server) Start(ctx context.Context) error {\n"
+         "    for i := 0; i < 10; i++ { go func() { defer wg.Done() }() }\n"
+         "    if s == nil { return fmt.Errorf(\"nil server\") } // guard\n"
+         "    select { case <-ctx.Done(): return nil; default: }\n"
+         "    return nil\n"
+         "}\n"},
+        {"java",
+         "package com.example;\n"
+         "public final class Counter implements Runnable {\n"
+         "    private static final int LIMIT = 100;\n"
+         "    private volatile long count = 0L;\n"
+         "    @Override public synchronized void run() {\n"
+         "        for (int i = 0; i < LIMIT; i++) {\n"
+         "            if (count > 0) { count++; } else { throw new IllegalStateException(); }\n"
+         "        }\n"
+         "    }\n"
+         "}\n"},
+        {"csharp",
+         "using System.Linq;\n"
+         "namespace App {\n"
+         "    public sealed class Repo<T> where T : class {\n"
+         "        private readonly List<T> _items = new List<T>();\n"
+         "        public async Task<int> CountAsync(string filter) {\n"
+         "            var n = await Task.Run(() => _items.Count(x => x != null)); // count\n"
+         "            return n > 0 ? n : default;\n"
+         "        }\n"
+         "    }\n"
+         "}\n"},
+        {"html",
+         "<!-- page header -->\n"
+         "<div class=\"header\" id=\"top\">\n"
+         "  <a href=\"/index.html\" title='Home'>Home</a>\n"
+         "  <img src=\"logo.png\" alt=\"logo\" width=\"32\" height=\"32\">\n"
+         "  <script type=\"module\" src=\"app.js\"></script>\n"
+         "</div>\n"},
+        {"css",
+         "/* layout */\n"
+         "body { margin: 0; padding: 0 1rem; font-family: \"Inter\", sans-serif; }\n"
+         "a { color: inherit; text-decoration: none; }\n"
+         ".card:hover > .title { color: #ff8800; transform: scale(1.05); }\n"
+         "@media (max-width: 600px) { .grid { display: flex; border: none; width: auto; } }\n"},
+        {"json",
+         "{\n"
+         "  \"name\": \"mark-amp\", \"version\": \"1.2.3\", \"private\": true,\n"
+         "  \"tags\": [\"editor\", \"markdown\"], \"count\": 42, \"ratio\": 0.75,\n"
+         "  \"nested\": { \"enabled\": false, \"value\": null }\n"
+         "}\n"},
+        {"yaml",
+         "# build config\n"
+         "name: ci\n"
+         "on:\n"
+         "  push:\n"
+         "    branches: [main, release]\n"
+         "jobs:\n"
+         "  build:\n"
+         "    runs-on: ubuntu-latest\n"
+         "    enabled: true\n"
+         "    retries: 3\n"},
+        {"sql",
+         "-- active users\n"
+         "SELECT u.id, u.name, COUNT(o.id) AS orders\n"
+         "FROM users u LEFT JOIN orders o ON o.user_id = u.id\n"
+         "WHERE u.active = TRUE AND u.created_at > '2024-01-01'\n"
+         "GROUP BY u.id, u.name HAVING COUNT(o.id) > 5 ORDER BY orders DESC LIMIT 10;\n"},
+        {"bash",
+         "#!/bin/bash\n"
+         "set -euo pipefail\n"
+         "for file in \"$@\"; do\n"
+         "  if [ -f \"$file\" ]; then\n"
+         "    echo \"processing $file\" # log\n"
+         "    local count=$(wc -l < \"$file\")\n"
+         "  else\n"
+         "    return 1\n"
+         "  fi\n"
+         "done\n"},
+    };
+    return samples;
+}
+
+/// Reserved-word lookup as the tokenizer did it before KeywordTable: a
+/// scan of each list in turn, keywords first.
+auto linear_lookup(const LanguageDefinition& def, std::string_view word) -> TokenType
+{
+    const auto listed = [word](const std::vector<std::string>& words)
+    { return std::find(words.begin(), words.end(), word) != words.end(); };
+    if (listed(def.keywords))
+    {
+        return TokenType::Keyword;
+    }
+    if (listed(def.types))
+    {
+        return TokenType::Type;
+    }
+    if (listed(def.constants))
+    {
+        return TokenType::Constant;
+    }
+    return TokenType::Text;
+}
+
+/// `sample` repeated to at least `min_bytes`.
+auto repeat_sample(const std::string& sample, std::size_t min_bytes) -> std::string
+{
+    std::string text;
+    text.reserve(min_bytes + sample.size());
+    while (text.size() < min_bytes)
+    {
+        text += sample;
+    }
+    return text;
+}
+
+} // namespace
+
+TEST_CASE("KeywordTable: classifies reserved words like the definition lists", "[syntax][keywords]")
+{
+    LanguageDefinition def{.name = "test",
+                           .keywords = {"if", "else", "return", "class", "for"},
+                           .types = {"int", "String", "class"},
+                           .constants = {"true", "null", "int"}};
+    const KeywordTable table(def);
+
+    CHECK(table.size() == 9);
+    CHECK(table.is_perfect());
+    CHECK(table.lookup("if") == TokenType::Keyword);
+    CHECK(table.lookup("return") == TokenType::Keyword);
+    CHECK(table.lookup("String") == TokenType::Type);
+    CHECK(table.lookup("null") == TokenType::Constant);
+
+    // First category wins, as with a keywords-types-constants scan
+    CHECK(table.lookup("class") == TokenType::Keyword);
+    CHECK(table.lookup("int") == TokenType::Type);
+
+    // Near misses are not reserved
+    CHECK(table.lookup("") == TokenType::Text);
+    CHECK(table.lookup("i") == TokenType::Text);
+    CHECK(table.lookup("iff") == TokenType::Text);
+    CHECK(table.lookup("returns") == TokenType::Text);
+    CHECK(table.lookup("Return") == TokenType::Text);
+    CHECK(table.lookup("string") == TokenType::Text);
+    CHECK(table.lookup("nul") == TokenType::Text);
+    CHECK(KeywordTable{}.lookup("if") == TokenType::Text);
+}
+
+TEST_CASE("KeywordTable: large word lists still hash perfectly", "[syntax][keywords]")
+{
+    LanguageDefinition def{.name = "generated"};
+    for (int i = 0; i < 2000; ++i)
+    {
+        def.keywords.push_back("kw" + std::to_string(i));
+    }
+    const KeywordTable table(def);
+
+    REQUIRE(table.size() == 2000);
+    CHECK(table.is_perfect());
+    for (int i = 0; i < 2000; ++i)
+    {
+        REQUIRE(table.lookup("kw" + std::to_string(i)) == TokenType::Keyword);
+        REQUIRE(table.lookup("kx" + std::to_string(i)) == TokenType::Text);
+    }
+}
+
+TEST_CASE("tokenize_soa matches tokenize for every built-in language", "[syntax][soa]")
+{
+    SyntaxHighlighter hl;
+    for (const auto& [language, sample] : language_samples())
+    {
+        INFO(language);
+        REQUIRE(hl.is_supported(language));
+
+        const auto tokens = hl.tokenize(sample, language);
+        const auto soa = hl.tokenize_soa(sample, language);
+        REQUIRE(soa.size() == tokens.size());
+
+        size_t covered = 0;
+        bool found_reserved = false;
+        for (size_t i = 0; i < soa.size(); ++i)
+        {
+            REQUIRE(soa.types[i] == tokens[i].type);
+            REQUIRE(soa.starts[i] == tokens[i].start);
+            REQUIRE(soa.lengths[i] == tokens[i].length);
+            REQUIRE(soa.text(i, sample) == tokens[i].text);
+
+            // Tokens tile the source without gaps
+            REQUIRE(soa.starts[i] == covered);
+            covered += soa.lengths[i];
+
+            found_reserved = found_reserved || soa.types[i] == TokenType::Keyword ||
+                             soa.types[i] == TokenType::Type ||
+                             soa.types[i] == TokenType::Constant;
+        }
+        CHECK(covered == sample.size());
+        CHECK((found_reserved || language == "html")); // HTML has no reserved words
+    }
+}
+
+TEST_CASE("tokenize_soa reuses the caller's buffers", "[syntax][soa]")
+{
+    SyntaxHighlighter hl;
+    const auto text = repeat_sample(language_samples().front().second, 16 * 1024);
+
+    TokenArraySoA out;
+    hl.tokenize_soa(text, "javascript", out);
+    const auto count = out.size();
+    const auto* types = out.types.data();
+    const auto* starts = out.starts.data();
+    REQUIRE(count > 0);
+
+    hl.tokenize_soa(text, "javascript", out);
+    CHECK(out.size() == count);
+    CHECK(out.types.data() == types);
+    CHECK(out.starts.data() == starts);
+
+    // Unsupported languages yield one Text token; empty input yields none
+    hl.tokenize_soa("hello", "brainfuck", out);
+    REQUIRE(out.size() == 1);
+    CHECK(out.types[0] == TokenType::Text);
+    CHECK(out.lengths[0] == 5);
+    hl.tokenize_soa("", "javascript", out);
+    CHECK(out.empty());
+}
+
+TEST_CASE("SyntaxHighlighter — tokens/sec per language", "[.][benchmark][syntax]")
+{
+    // Divide the token count in each name by the mean time for tokens/sec
+    SyntaxHighlighter hl;
+    for (const auto& [language, sample] : language_samples())
+    {
+        const auto text = repeat_sample(sample, 256 * 1024);
+        TokenArraySoA out;
+        hl.tokenize_soa(text, language, out);
+        const auto label = language + " (" + std::to_string(out.size()) + " tokens)";
+
+        BENCHMARK(label + " tokenize")
+        {
+            return hl.tokenize(text, language).size();
+        };
+
+        BENCHMARK(label + " tokenize_soa")
+        {
+            hl.tokenize_soa(text, language, out);
+            return out.size();
+        };
+
+        // The reserved-word lookup alone, against the linear scan it replaced
+        const auto* def = hl.language_definition(language);
+        REQUIRE(def != nullptr);
+        const KeywordTable table(*def);
+        std::vector<std::string_view> words;
+        for (std::size_t i = 0; i < out.size(); ++i)
+        {
+            const auto token = out.text(i, text);
+            if (!token.empty() && (std::isalpha(static_cast<unsigned char>(token[0])) != 0 ||
+                                   token[0] == '_'))
+            {
+                words.push_back(token);
+            }
+        }
+        for (const auto word : words)
+        {
+            REQUIRE(table.lookup(word) == linear_lookup(*def, word));
+        }
+        const auto words_label = language + " (" + std::to_string(words.size()) + " words)";
+
+        BENCHMARK(words_label + " linear keyword scan")
+        {
+            std::size_t reserved = 0;
+            for (const auto word : words)
+            {
+                reserved += linear_lookup(*def, word) != TokenType::Text ? 1 : 0;
+            }
+            return reserved;
+        };
+
+        BENCHMARK(words_label + " KeywordTable lookup")
+        {
+            std::size_t reserved = 0;
+            for (const auto word : words)
+            {
+                reserved += table.lookup(word) != TokenType::Text ? 1 : 0;
+            }
+            return reserved;
+        };
+    }
+}
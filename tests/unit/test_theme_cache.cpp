@@ -0,0 +1,276 @@
+#include "core/BuiltInThemes.h"
+#include "core/ThemeCache.h"
+#include "core/ThemeRegistry.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+using namespace markamp::core;
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/// A scratch themes directory with a cache file beside it.
+class ThemeDir
+{
+public:
+    explicit ThemeDir(const std::string& name)
+        : root_(fs::temp_directory_path() / ("markamp_theme_cache_" + name))
+    {
+        fs::remove_all(root_);
+        fs::create_directories(themes());
+    }
+
+    ~ThemeDir()
+    {
+        std::error_code error;
+        fs::remove_all(root_, error);
+    }
+
+    ThemeDir(const ThemeDir&) = delete;
+    auto operator=(const ThemeDir&) -> ThemeDir& = delete;
+
+    [[nodiscard]] auto themes() const -> fs::path
+    {
+        return root_ / "themes";
+    }
+
+    [[nodiscard]] auto cache_file() const -> fs::path
+    {
+        return root_ / "cache" / "themes.bin";
+    }
+
+    /// Write a JSON theme derived from the first built-in theme.
+    void write(const std::string& id, const std::string& name) const
+    {
+        Theme theme = get_builtin_themes().front();
+        theme.id = id;
+        theme.name = name;
+        const nlohmann::json json = theme;
+        std::ofstream(themes() / (id + ".json")) << json.dump(2);
+    }
+
+    /// Open the cache, counting how many files had to be parsed.
+    [[nodiscard]] auto open(int& parses) const -> ThemeCache
+    {
+        auto cache = ThemeCache::open(themes(),
+                                      cache_file(),
+                                      [&parses](const fs::path& path)
+                                      {
+                                          ++parses;
+                                          return ThemeRegistry::parse_theme_file(path);
+                                      });
+        REQUIRE(cache.has_value());
+        return std::move(*cache);
+    }
+
+private:
+    fs::path root_;
+};
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Record encoding
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("ThemeCache: records round-trip every theme token", "[theme_cache]")
+{
+    for (const auto& builtin : get_builtin_themes())
+    {
+        std::string record;
+        ThemeCache::encode(builtin, record);
+        auto decoded = ThemeCache::decode(record);
+        REQUIRE(decoded.has_value());
+        CHECK(*decoded == builtin);
+    }
+
+    Theme styled = get_builtin_themes().back();
+    styled.title_bar_gradient.start = "#112233";
+    styled.title_bar_gradient.end = "#445566";
+    styled.neon_edge = true;
+    styled.effects.edge_glow = true;
+    styled.effects.edge_glow_color = Color(1, 2, 3, 4);
+    styled.effects.edge_glow_width = 3;
+    styled.effects.vignette_strength = 200;
+    styled.syntax.keyword = Color(9, 8, 7);
+
+    std::string record;
+    ThemeCache::encode(styled, record);
+    auto decoded = ThemeCache::decode(record);
+    REQUIRE(decoded.has_value());
+    CHECK(*decoded == styled);
+
+    CHECK_FALSE(ThemeCache::decode(std::string_view(record).substr(0, record.size() - 1)));
+    CHECK_FALSE(ThemeCache::decode(record + "x"));
+}
+
+// ═══════════════════════════════════════════════════════
+// Validation against the source files
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("ThemeCache: an unchanged directory is served without parsing", "[theme_cache]")
+{
+    ThemeDir dir("unchanged");
+    for (int index = 0; index < 5; ++index)
+    {
+        dir.write("cached-" + std::to_string(index), "Cached " + std::to_string(index));
+    }
+
+    int parses = 0;
+    {
+        const auto first = dir.open(parses);
+        CHECK(first.size() == 5);
+        CHECK(first.stats().parsed == 5);
+        CHECK(first.stats().rewritten);
+        CHECK(parses == 5);
+    }
+
+    parses = 0;
+    const auto second = dir.open(parses);
+    CHECK(parses == 0);
+    CHECK(second.stats().reused == 5);
+    CHECK_FALSE(second.stats().rewritten);
+#ifndef _WIN32
+    CHECK(second.is_mapped());
+#endif
+
+    const auto index = second.find("cached-3");
+    REQUIRE(index.has_value());
+    CHECK(second.name(*index) == "Cached 3");
+    CHECK(second.source(*index) == "cached-3.json");
+    auto theme = second.materialize(*index);
+    REQUIRE(theme.has_value());
+    auto parsed = ThemeRegistry::parse_theme_file(dir.themes() / "cached-3.json");
+    REQUIRE(parsed.has_value());
+    CHECK(*theme == *parsed);
+}
+
+TEST_CASE("ThemeCache: only new, changed and removed files are revalidated", "[theme_cache]")
+{
+    ThemeDir dir("changes");
+    dir.write("alpha", "Alpha");
+    dir.write("beta", "Beta");
+    dir.write("gamma", "Gamma");
+    int parses = 0;
+    static_cast<void>(dir.open(parses));
+
+    SECTION("edited content is parsed again")
+    {
+        dir.write("beta", "Beta Edited");
+        parses = 0;
+        const auto cache = dir.open(parses);
+        CHECK(parses == 1);
+        CHECK(cache.stats().reused == 2);
+        CHECK(cache.name(*cache.find("beta")) == "Beta Edited");
+    }
+
+    SECTION("a touched but identical file keeps its entry")
+    {
+        const auto path = dir.themes() / "gamma.json";
+        fs::last_write_time(path, fs::last_write_time(path) + std::chrono::seconds(5));
+        parses = 0;
+        const auto cache = dir.open(parses);
+        CHECK(parses == 0);
+        CHECK(cache.stats().rewritten); // The new mtime is recorded
+        parses = 0;
+        CHECK_FALSE(dir.open(parses).stats().rewritten);
+    }
+
+    SECTION("added and removed files")
+    {
+        fs::remove(dir.themes() / "alpha.json");
+        dir.write("delta", "Delta");
+        parses = 0;
+        const auto cache = dir.open(parses);
+        CHECK(parses == 1);
+        CHECK(cache.size() == 3);
+        CHECK_FALSE(cache.find("alpha").has_value());
+        CHECK(cache.find("delta").has_value());
+    }
+
+    SECTION("a corrupt cache file is rebuilt")
+    {
+        std::ofstream(dir.cache_file(), std::ios::trunc) << "MATC garbage";
+        parses = 0;
+        const auto cache = dir.open(parses);
+        CHECK(parses == 3);
+        CHECK(cache.size() == 3);
+    }
+
+    SECTION("a corrupt entry fails its checksum and is parsed again")
+    {
+        // The record starts with the id and name fields; flip a color after them
+        std::string bytes;
+        {
+            std::ifstream in(dir.cache_file(), std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        const auto record_id = bytes.rfind("beta");
+        REQUIRE(record_id != std::string::npos);
+        const auto color = record_id + 4 + sizeof(std::int32_t) + 4;
+        REQUIRE(bytes.compare(color - 4, 4, "Beta") == 0);
+        bytes[color] = static_cast<char>(~bytes[color]);
+        std::ofstream(dir.cache_file(), std::ios::binary | std::ios::trunc) << bytes;
+
+        parses = 0;
+        const auto cache = dir.open(parses);
+        CHECK(parses == 1);
+        CHECK(cache.stats().reused == 2);
+        CHECK(cache.stats().rewritten);
+        auto theme = cache.materialize(*cache.find("beta"));
+        REQUIRE(theme.has_value());
+        auto parsed = ThemeRegistry::parse_theme_file(dir.themes() / "beta.json");
+        REQUIRE(parsed.has_value());
+        CHECK(*theme == *parsed);
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// ThemeRegistry integration
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("ThemeRegistry: cached themes are listed without being decoded", "[theme_cache]")
+{
+    ThemeDir dir("registry");
+    dir.write("night-owl", "Night Owl");
+    dir.write("paper", "Paper");
+    const auto clashing_id = get_builtin_themes().front().id;
+    dir.write(clashing_id, "Clash");
+
+    int parses = 0;
+    auto cache = std::make_shared<const ThemeCache>(dir.open(parses));
+
+    ThemeRegistry registry;
+    registry.initialize_builtin();
+    const auto builtin_count = registry.theme_count();
+    registry.add_cached_themes(cache);
+
+    // The clashing theme is registered renamed; the others stay in the cache
+    CHECK(registry.theme_count() == builtin_count + 3);
+    CHECK(registry.has_theme("night-owl"));
+    const auto infos = registry.list_themes();
+    const auto owl = std::find_if(
+        infos.begin(), infos.end(), [](const ThemeInfo& info) { return info.id == "night-owl"; });
+    REQUIRE(owl != infos.end());
+    CHECK(owl->name == "Night Owl");
+    CHECK_FALSE(owl->is_builtin);
+    REQUIRE(owl->file_path.has_value());
+    CHECK(fs::path(*owl->file_path).filename() == "night-owl.json");
+
+    auto theme = registry.get_theme("night-owl");
+    REQUIRE(theme.has_value());
+    CHECK(theme->name == "Night Owl");
+    CHECK(registry.get_theme(clashing_id)->name == get_builtin_themes().front().name);
+}
@@ -0,0 +1,203 @@
+#include "core/BuiltInThemes.h"
+#include "core/ThemePreviewRenderer.h"
+#include "core/VirtualGrid.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace markamp::core;
+
+namespace
+{
+
+constexpr int kPreviewWidth = 276;
+constexpr int kPreviewHeight = 110;
+
+/// RGB of pixel (x, y).
+auto pixel(const ThemePreviewImage& image, int x, int y) -> Color
+{
+    const auto offset = (static_cast<std::size_t>(y) * image.width + x) * 3;
+    return {image.rgb[offset], image.rgb[offset + 1], image.rgb[offset + 2]};
+}
+
+auto opaque(const Color& color) -> Color
+{
+    return color.with_alpha(uint8_t{255});
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// VirtualGrid
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("VirtualGrid: columns and content height", "[theme_preview]")
+{
+    const VirtualGrid grid{280, 160, 24, 24};
+
+    // Same formula as ThemeGallery::CalculateColumns on the padded width
+    CHECK(grid.columns(896) == 2);
+    CHECK(grid.columns(48 + 280 * 3 + 24 * 2) == 3);
+    CHECK(grid.columns(100) == 1);
+
+    CHECK(VirtualGrid::rows(0, 3) == 0);
+    CHECK(VirtualGrid::rows(7, 3) == 3);
+    CHECK(grid.content_height(0, 3) == 48);
+    CHECK(grid.content_height(7, 3) == 48 + 3 * 160 + 2 * 24);
+
+    const auto origin = grid.origin(4, 3);
+    CHECK(origin.x == 24 + 280 + 24);
+    CHECK(origin.y == 24 + 160 + 24);
+}
+
+TEST_CASE("VirtualGrid: only rows in the viewport are visible", "[theme_preview]")
+{
+    const VirtualGrid grid{280, 160, 24, 24};
+    constexpr std::size_t kCount = 500;
+    constexpr int kColumns = 3;
+
+    const auto top = grid.visible(kCount, kColumns, 0, 400, 0);
+    CHECK(top.first == 0);
+    CHECK(top.last == 9); // Rows 0-2 intersect [0, 400)
+
+    // Scrolled to row 100 with one overscan row on each side
+    const int scroll = grid.origin(300, kColumns).y;
+    const auto middle = grid.visible(kCount, kColumns, scroll, 400);
+    CHECK(middle.first == 297);
+    CHECK(middle.contains(300));
+    CHECK(middle.last - middle.first <= 5 * kColumns);
+
+    const auto bottom = grid.visible(kCount, kColumns, grid.content_height(kCount, kColumns), 400);
+    CHECK(bottom.last == kCount);
+    CHECK(grid.visible(0, kColumns, 0, 400).empty());
+    CHECK(grid.visible(kCount, kColumns, 0, 0).empty());
+}
+
+// ═══════════════════════════════════════════════════════
+// ThemePreviewRenderer
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("ThemePreviewRenderer: rasterizes the miniature UI", "[theme_preview]")
+{
+    const auto& theme = get_builtin_themes().front();
+    const auto image = ThemePreviewRenderer::rasterize(theme, kPreviewWidth, kPreviewHeight);
+
+    REQUIRE(image.width == kPreviewWidth);
+    REQUIRE(image.height == kPreviewHeight);
+    REQUIRE(image.rgb.size() == static_cast<std::size_t>(kPreviewWidth * kPreviewHeight * 3));
+
+    const auto& colors = theme.colors;
+    CHECK(pixel(image, 150, 2) == opaque(colors.bg_header));      // Header bar
+    CHECK(pixel(image, 10, 7) == opaque(colors.accent_primary));  // First dot
+    CHECK(pixel(image, 55, 100) == opaque(colors.bg_panel));      // Sidebar
+    CHECK(pixel(image, 60, 60) == opaque(colors.bg_app));         // Gap after the sidebar
+    CHECK(pixel(image, 250, 100) == opaque(colors.bg_input));     // Content
+    CHECK(pixel(image, 71, 26) == opaque(colors.accent_primary)); // First heading
+}
+
+TEST_CASE("ThemePreviewRenderer: content hash follows the theme", "[theme_preview]")
+{
+    Theme theme = get_builtin_themes().front();
+    const auto hash = ThemePreviewRenderer::content_hash(theme);
+    CHECK(ThemePreviewRenderer::content_hash(theme) == hash);
+
+    theme.colors.accent_primary = Color(1, 2, 3);
+    CHECK(ThemePreviewRenderer::content_hash(theme) != hash);
+}
+
+TEST_CASE("ThemePreviewRenderer: renders off-thread and caches by id and hash", "[theme_preview]")
+{
+    ThemePreviewRenderer renderer(kPreviewWidth, kPreviewHeight);
+    const auto& themes = get_builtin_themes();
+
+    std::mutex ready_mutex;
+    std::vector<std::string> ready;
+    std::atomic<bool> found_on_ready{true};
+    renderer.set_ready_callback(
+        [&](const std::string& theme_id, std::uint64_t hash)
+        {
+            // The preview is already stored when listeners hear about it
+            found_on_ready = found_on_ready && renderer.lookup(theme_id, hash) != nullptr;
+            const std::lock_guard lock(ready_mutex);
+            ready.push_back(theme_id);
+        });
+
+    for (const auto& theme : themes)
+    {
+        const auto hash = ThemePreviewRenderer::content_hash(theme);
+        CHECK(renderer.lookup(theme.id, hash) == nullptr);
+        renderer.request(theme, hash);
+    }
+    renderer.wait_idle();
+
+    CHECK(found_on_ready);
+    CHECK(ready.size() == themes.size());
+    CHECK(renderer.stats().rendered == themes.size());
+
+    const auto& first = themes.front();
+    const auto hash = ThemePreviewRenderer::content_hash(first);
+    const auto cached = renderer.lookup(first.id, hash);
+    REQUIRE(cached != nullptr);
+    CHECK(cached->rgb == ThemePreviewRenderer::rasterize(first, kPreviewWidth, kPreviewHeight).rgb);
+
+    // A cached preview is not queued again; a changed theme file is
+    CHECK_FALSE(renderer.request(first, hash));
+    CHECK(renderer.lookup(first.id, hash + 1) == nullptr);
+    CHECK(renderer.request(first, hash + 1));
+    renderer.wait_idle();
+    CHECK(renderer.stats().rendered == themes.size() + 1);
+}
+
+TEST_CASE("ThemePreviewRenderer: cancelled requests are not rendered", "[theme_preview]")
+{
+    ThemePreviewRenderer renderer(kPreviewWidth, kPreviewHeight);
+    const auto& themes = get_builtin_themes();
+
+    // Hold the worker in the callback of the first job while more queue up
+    std::atomic<bool> released{false};
+    renderer.set_ready_callback(
+        [&released](const std::string&, std::uint64_t)
+        {
+            while (!released)
+            {
+                std::this_thread::yield();
+            }
+        });
+
+    for (const auto& theme : themes)
+    {
+        renderer.request(theme, ThemePreviewRenderer::content_hash(theme));
+    }
+    renderer.cancel_pending();
+    released = true;
+    renderer.wait_idle();
+
+    const auto stats = renderer.stats();
+    CHECK(stats.rendered + stats.cancelled == themes.size());
+    CHECK(stats.rendered < themes.size());
+}
+
+TEST_CASE("ThemePreviewRenderer: the cache is capped in bytes", "[theme_preview]")
+{
+    constexpr std::size_t kImageBytes = kPreviewWidth * kPreviewHeight * 3;
+    ThemePreviewRenderer renderer(kPreviewWidth, kPreviewHeight, kImageBytes * 2 + 1024);
+
+    Theme theme = get_builtin_themes().front();
+    std::vector<std::uint64_t> hashes;
+    for (int index = 0; index < 4; ++index)
+    {
+        theme.id = "capped-" + std::to_string(index);
+        hashes.push_back(ThemePreviewRenderer::content_hash(theme));
+        renderer.request(theme, hashes.back());
+        renderer.wait_idle();
+    }
+
+    CHECK(renderer.lookup("capped-0", hashes[0]) == nullptr);
+    CHECK(renderer.lookup("capped-3", hashes[3]) != nullptr);
+}
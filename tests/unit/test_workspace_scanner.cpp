@@ -0,0 +1,557 @@
+#include "core/FileTreeRows.h"
+#include "core/WorkspaceScanner.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace markamp::core;
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/// A scratch directory tree, removed on destruction.
+class TempTree
+{
+public:
+    explicit TempTree(const std::string& name)
+        : root_(fs::temp_directory_path() / ("markamp_ws_scan_" + name))
+    {
+        fs::remove_all(root_);
+        fs::create_directories(root_);
+    }
+
+    ~TempTree()
+    {
+        std::error_code error;
+        fs::remove_all(root_, error);
+    }
+
+    TempTree(const TempTree&) = delete;
+    auto operator=(const TempTree&) -> TempTree& = delete;
+
+    void file(const std::string& relative)
+    {
+        const auto path = root_ / relative;
+        fs::create_directories(path.parent_path());
+        std::ofstream out(path);
+        out << "x";
+    }
+
+    void folder(const std::string& relative)
+    {
+        fs::create_directories(root_ / relative);
+    }
+
+    [[nodiscard]] auto path(const std::string& relative = {}) const -> std::string
+    {
+        return relative.empty() ? root_.string() : (root_ / relative).string();
+    }
+
+private:
+    fs::path root_;
+};
+
+/// `width` folders and files per level, `depth` levels deep.
+void build_tree(TempTree& tree, const std::string& prefix, int width, int depth)
+{
+    for (int index = 0; index < width; ++index)
+    {
+        tree.file(prefix + "file" + std::to_string(index) + ".md");
+        if (depth > 1)
+        {
+            const auto folder = prefix + "dir" + std::to_string(index) + "/";
+            tree.folder(folder);
+            build_tree(tree, folder, width, depth - 1);
+        }
+    }
+}
+
+/// Collects everything a scan delivers.
+struct ScanLog
+{
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    std::unordered_map<std::string, DirectoryListing> listings;
+    std::size_t batches{0};
+    std::size_t completions{0};
+    std::size_t reported_entries{0};
+    bool listing_after_complete{false};
+
+    auto on_batch()
+    {
+        return [this](std::vector<DirectoryListing> batch)
+        {
+            const std::lock_guard lock(mutex);
+            ++batches;
+            for (auto& listing : batch)
+            {
+                listing_after_complete = listing_after_complete || completions > 0;
+                listings[listing.path] = std::move(listing);
+            }
+        };
+    }
+
+    auto on_complete()
+    {
+        return [this](std::size_t entries)
+        {
+            const std::lock_guard lock(mutex);
+            ++completions;
+            reported_entries = entries;
+            done_cv.notify_all();
+        };
+    }
+
+    auto wait_for_completions(std::size_t count) -> bool
+    {
+        std::unique_lock lock(mutex);
+        return done_cv.wait_for(
+            lock, std::chrono::seconds(20), [this, count] { return completions >= count; });
+    }
+};
+
+auto names(const std::vector<FileNode>& nodes) -> std::vector<std::string>
+{
+    std::vector<std::string> result;
+    for (const auto& node : nodes)
+    {
+        result.push_back(node.name);
+    }
+    return result;
+}
+
+auto make_folder(const std::string& id, std::vector<FileNode> children, bool open) -> FileNode
+{
+    FileNode node;
+    node.id = id;
+    node.name = id;
+    node.type = FileNodeType::Folder;
+    node.children = std::move(children);
+    node.is_open = open;
+    return node;
+}
+
+auto make_file(const std::string& id) -> FileNode
+{
+    FileNode node;
+    node.id = id;
+    node.name = id;
+    return node;
+}
+
+} // anonymous namespace
+
+// ═══════════════════════════════════════════════════════
+// list_directory
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("list_directory: folders first, case-insensitive, hidden skipped", "[workspace_scanner]")
+{
+    TempTree tree("list");
+    tree.file("b.md");
+    tree.file("A.md");
+    tree.file(".hidden.md");
+    tree.folder("zeta");
+    tree.folder("Alpha");
+    tree.folder(".git");
+
+    const auto listing = list_directory(tree.path());
+    REQUIRE(listing.path == tree.path());
+    REQUIRE(names(listing.children) == std::vector<std::string>{"Alpha", "zeta", "A.md", "b.md"});
+    REQUIRE(listing.children[0].is_folder());
+    REQUIRE_FALSE(listing.children[0].children_loaded);
+    REQUIRE(listing.children[2].is_file());
+    REQUIRE(listing.children[2].id == (fs::path(tree.path()) / "A.md").string());
+
+    REQUIRE(list_directory(tree.path("missing")).children.empty());
+}
+
+// ═══════════════════════════════════════════════════════
+// WorkspaceScanner
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("WorkspaceScanner: lists the prefetch depth, then folders on expand or refresh",
+          "[workspace_scanner]")
+{
+    TempTree tree("depth");
+    build_tree(tree, "", 3, 4); // root + 3 levels of folders
+
+    WorkspaceScanner scanner(3);
+    ScanLog log;
+    scanner.scan(tree.path(), log.on_batch(), log.on_complete(), 1);
+    REQUIRE(log.wait_for_completions(1));
+
+    {
+        const std::lock_guard lock(log.mutex);
+        // Root and its 3 folders; nothing deeper
+        REQUIRE(log.listings.size() == 4);
+        REQUIRE(log.listings.count(tree.path()) == 1);
+        REQUIRE(log.listings.count(tree.path("dir0")) == 1);
+        REQUIRE(log.listings.count(tree.path("dir0/dir0")) == 0);
+        REQUIRE(log.listings[tree.path()].children.size() == 6);
+        REQUIRE(log.reported_entries == 6 + 3 * 6);
+        REQUIRE_FALSE(log.listing_after_complete);
+    }
+    REQUIRE_FALSE(scanner.is_scanning());
+
+    // Expanding lists the folder and the level below it
+    scanner.expand(tree.path("dir1/dir2"));
+    REQUIRE(log.wait_for_completions(2));
+    std::size_t listed = 0;
+    {
+        const std::lock_guard lock(log.mutex);
+        REQUIRE(log.listings.count(tree.path("dir1/dir2")) == 1);
+        REQUIRE(log.listings.count(tree.path("dir1/dir2/dir0")) == 1);
+        REQUIRE(log.listings[tree.path("dir1/dir2/dir0")].children.size() == 3); // Files only
+        listed = log.listings.size();
+    }
+
+    // Refreshing lists just the folder, as it is now
+    tree.file("dir0/added.md");
+    scanner.refresh(tree.path("dir0"));
+    REQUIRE(log.wait_for_completions(3));
+    const std::lock_guard lock(log.mutex);
+    REQUIRE(log.listings.size() == listed);
+    REQUIRE(log.listings[tree.path("dir0")].children.size() == 7);
+}
+
+TEST_CASE("WorkspaceScanner: a deep scan matches a recursive walk", "[workspace_scanner]")
+{
+    TempTree tree("full");
+    build_tree(tree, "", 4, 4);
+
+    std::size_t expected_entries = 0;
+    for (const auto& entry : fs::recursive_directory_iterator(tree.path()))
+    {
+        (void)entry;
+        ++expected_entries;
+    }
+
+    for (const std::size_t workers : {1UL, 4UL})
+    {
+        WorkspaceScanner scanner(workers);
+        ScanLog log;
+        scanner.scan(tree.path(), log.on_batch(), log.on_complete(), 16);
+        REQUIRE(log.wait_for_completions(1));
+
+        const std::lock_guard lock(log.mutex);
+        REQUIRE(log.reported_entries == expected_entries);
+        std::size_t delivered = 0;
+        for (const auto& [path, listing] : log.listings)
+        {
+            delivered += listing.children.size();
+        }
+        REQUIRE(delivered == expected_entries);
+        REQUIRE(log.listings.size() == 1 + 4 + 16 + 64);
+    }
+}
+
+TEST_CASE("WorkspaceScanner: a new scan cancels the old one", "[workspace_scanner]")
+{
+    TempTree first("cancel_a");
+    build_tree(first, "", 5, 4);
+    TempTree second("cancel_b");
+    second.file("only.md");
+
+    WorkspaceScanner scanner(2);
+    ScanLog old_log;
+    scanner.scan(first.path(), old_log.on_batch(), old_log.on_complete(), 16);
+
+    ScanLog new_log;
+    scanner.scan(second.path(), new_log.on_batch(), new_log.on_complete(), 16);
+    std::size_t old_batches = 0;
+    std::size_t old_completions = 0; // A small tree can finish before scan() returns
+    {
+        const std::lock_guard lock(old_log.mutex);
+        old_batches = old_log.batches;
+        old_completions = old_log.completions;
+    }
+    REQUIRE(new_log.wait_for_completions(1));
+
+    {
+        const std::lock_guard lock(new_log.mutex);
+        REQUIRE(new_log.listings.size() == 1);
+        REQUIRE(names(new_log.listings[second.path()].children) ==
+                std::vector<std::string>{"only.md"});
+    }
+    // Nothing from the cancelled scan after the new one started
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const std::lock_guard lock(old_log.mutex);
+    REQUIRE(old_log.batches == old_batches);
+    REQUIRE(old_log.completions == old_completions);
+}
+
+// ═══════════════════════════════════════════════════════
+// Flattened rows
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("flatten_file_tree: rows follow open folders and the filter", "[workspace_scanner]")
+{
+    std::vector<FileNode> roots;
+    roots.push_back(make_folder("docs", {make_file("a.md"), make_file("b.md")}, true));
+    roots.push_back(make_folder("closed", {make_file("c.md")}, false));
+    roots.push_back(make_folder("empty", {}, true));
+    roots.push_back(make_file("readme.md"));
+    auto lazy = make_folder("lazy", {}, true);
+    lazy.children_loaded = false;
+    roots.push_back(lazy);
+
+    std::vector<FileTreeRow> rows;
+    std::vector<FileNode*> unloaded;
+    flatten_file_tree(roots, rows, &unloaded);
+
+    REQUIRE(rows.size() == 9);
+    REQUIRE(rows[0].node->id == "docs");
+    REQUIRE(rows[1].node->id == "a.md");
+    REQUIRE(rows[1].depth == 1);
+    REQUIRE(rows[3].node->id == "closed");
+    REQUIRE(rows[4].node->id == "empty");
+    REQUIRE(rows[5].kind == FileTreeRowKind::Empty);
+    REQUIRE(rows[5].depth == 1);
+    REQUIRE(rows[6].node->id == "readme.md");
+    REQUIRE(rows[8].kind == FileTreeRowKind::Loading);
+    REQUIRE(unloaded.size() == 1);
+    REQUIRE(unloaded[0]->id == "lazy");
+
+    // Filtered-out nodes have no row
+    roots[0].children[0].filter_visible = false;
+    flatten_file_tree(roots, rows);
+    REQUIRE(rows.size() == 8);
+    REQUIRE(rows[1].node->id == "b.md");
+}
+
+TEST_CASE("apply_directory_listing: fills unloaded folders", "[workspace_scanner]")
+{
+    TempTree tree("apply");
+    tree.file("sub/inner.md");
+    tree.folder("sub/nested");
+
+    auto root = list_directory(tree.path());
+    std::vector<FileNode> roots = std::move(root.children);
+    FileNodeIndex index;
+    index_file_tree(roots, index);
+    REQUIRE(index.size() == 1);
+
+    auto* sub = index.at(tree.path("sub"));
+    sub->is_open = true;
+    auto listing = list_directory(tree.path("sub"));
+    REQUIRE(apply_directory_listing(index, listing));
+    REQUIRE(sub->children_loaded);
+    REQUIRE(sub->is_open);
+    REQUIRE(names(sub->children) == std::vector<std::string>{"nested", "inner.md"});
+    REQUIRE(index.count(tree.path("sub/inner.md")) == 1);
+
+    // Unknown: ignored
+    DirectoryListing unknown{tree.path("nowhere"), {}};
+    REQUIRE_FALSE(apply_directory_listing(index, unknown));
+}
+
+TEST_CASE("apply_directory_listing: re-lists loaded folders in place", "[workspace_scanner]")
+{
+    TempTree tree("relist");
+    tree.file("sub/inner.md");
+    tree.file("sub/nested/deep.md");
+    tree.file("sub/gone/old.md");
+
+    auto root = list_directory(tree.path());
+    std::vector<FileNode> roots = std::move(root.children);
+    FileNodeIndex index;
+    index_file_tree(roots, index);
+    auto* sub = index.at(tree.path("sub"));
+    sub->is_open = true;
+    for (const auto* folder : {"sub", "sub/nested", "sub/gone"})
+    {
+        auto listing = list_directory(tree.path(folder));
+        REQUIRE(apply_directory_listing(index, listing));
+    }
+    index.at(tree.path("sub/nested"))->is_open = true;
+    const auto* deep = index.at(tree.path("sub/nested/deep.md"));
+
+    // On disk: one folder removed, a file added
+    fs::remove_all(tree.path("sub/gone"));
+    tree.file("sub/added.md");
+    auto refreshed = list_directory(tree.path("sub"));
+    REQUIRE(apply_directory_listing(index, refreshed));
+
+    REQUIRE(sub->is_open);
+    REQUIRE(names(sub->children) == std::vector<std::string>{"nested", "added.md", "inner.md"});
+    const auto* nested = index.at(tree.path("sub/nested"));
+    REQUIRE(nested->is_open);
+    REQUIRE(nested->children_loaded);
+    REQUIRE(index.at(tree.path("sub/nested/deep.md")) == deep);
+    REQUIRE(index.count(tree.path("sub/added.md")) == 1);
+    REQUIRE(index.count(tree.path("sub/gone")) == 0);
+    REQUIRE(index.count(tree.path("sub/gone/old.md")) == 0);
+
+    // Top-level listings merge the same way
+    tree.file("top.md");
+    merge_file_nodes(roots, list_directory(tree.path()).children, index);
+    REQUIRE(names(roots) == std::vector<std::string>{"sub", "top.md"});
+    REQUIRE(roots[0].is_open);
+    REQUIRE(index.at(tree.path("sub")) == &roots[0]);
+    REQUIRE(index.at(tree.path("sub/nested/deep.md")) == deep);
+}
+
+TEST_CASE("apply_directory_listing: holds listings that arrive before their parent's",
+          "[workspace_scanner]")
+{
+    TempTree tree("held");
+    tree.file("sub/nested/deep/leaf.md");
+    tree.file("sub/inner.md");
+
+    auto root = list_directory(tree.path());
+    std::vector<FileNode> roots = std::move(root.children);
+    FileNodeIndex index;
+    index_file_tree(roots, index);
+    HeldListings held;
+
+    // Deepest first: neither folder is known yet
+    auto deep = list_directory(tree.path("sub/nested/deep"));
+    REQUIRE_FALSE(apply_directory_listing(index, deep, held));
+    auto nested = list_directory(tree.path("sub/nested"));
+    REQUIRE_FALSE(apply_directory_listing(index, nested, held));
+    REQUIRE(held.size() == 2);
+
+    // The parent brings both in
+    auto sub = list_directory(tree.path("sub"));
+    REQUIRE(apply_directory_listing(index, sub, held));
+    REQUIRE(held.empty());
+    REQUIRE(index.at(tree.path("sub/nested"))->children_loaded);
+    REQUIRE(index.at(tree.path("sub/nested/deep"))->children_loaded);
+    REQUIRE(index.count(tree.path("sub/nested/deep/leaf.md")) == 1);
+
+    // Held listings wait for a top-level merge too
+    tree.file("later/note.md");
+    auto later = list_directory(tree.path("later"));
+    REQUIRE_FALSE(apply_directory_listing(index, later, held));
+    merge_file_nodes(roots, list_directory(tree.path()).children, index);
+    REQUIRE(apply_held_listings(roots, index, held));
+    REQUIRE(held.empty());
+    REQUIRE(index.at(tree.path("later"))->children_loaded);
+}
+
+TEST_CASE("apply_directory_listing: a parallel scan loads every prefetched folder",
+          "[workspace_scanner]")
+{
+    TempTree tree("delivery");
+    build_tree(tree, "", 6, 4); // 6 + 36 + 216 folders
+
+    WorkspaceScanner scanner(4);
+    std::vector<DirectoryListing> delivered;
+    std::mutex mutex;
+    ScanLog log;
+    auto record = log.on_batch();
+    scanner.scan(
+        tree.path(),
+        [&](std::vector<DirectoryListing> batch)
+        {
+            {
+                const std::lock_guard lock(mutex);
+                for (const auto& listing : batch)
+                {
+                    delivered.push_back(listing);
+                }
+            }
+            record(std::move(batch));
+        },
+        log.on_complete(),
+        2);
+    REQUIRE(log.wait_for_completions(1));
+
+    // Apply in delivery order, as the file tree does
+    const std::lock_guard lock(mutex);
+    std::vector<FileNode> roots;
+    FileNodeIndex index;
+    HeldListings held;
+    for (auto& listing : delivered)
+    {
+        if (listing.path == tree.path())
+        {
+            merge_file_nodes(roots, std::move(listing.children), index);
+            apply_held_listings(roots, index, held);
+        }
+        else
+        {
+            [[maybe_unused]] const bool applied = apply_directory_listing(index, listing, held);
+        }
+    }
+
+    REQUIRE(held.empty());
+    std::size_t loaded = 0;
+    for (const auto& [id, node] : index)
+    {
+        loaded += node->is_folder() && node->children_loaded ? 1 : 0;
+    }
+    REQUIRE(loaded == 6 + 36);
+}
+
+// ═══════════════════════════════════════════════════════
+// Benchmarks
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("Benchmark: workspace scan and row flattening", "[.][benchmark][workspace_scanner]")
+{
+    TempTree tree("bench");
+    build_tree(tree, "", 8, 5); // ~42k entries
+
+    BENCHMARK("recursive_directory_iterator (old walk)")
+    {
+        std::size_t count = 0;
+        for (const auto& entry : fs::recursive_directory_iterator(tree.path()))
+        {
+            count += entry.is_regular_file() ? 1 : 0;
+        }
+        return count;
+    };
+
+    BENCHMARK("WorkspaceScanner full scan")
+    {
+        WorkspaceScanner scanner;
+        ScanLog log;
+        scanner.scan(tree.path(), log.on_batch(), log.on_complete(), 16);
+        log.wait_for_completions(1);
+        return log.reported_entries;
+    };
+
+    // A fully loaded tree with one folder open: rows depend on what is open
+    WorkspaceScanner scanner;
+    ScanLog log;
+    scanner.scan(tree.path(), log.on_batch(), log.on_complete(), 16);
+    log.wait_for_completions(1);
+    std::vector<FileNode> roots = std::move(log.listings[tree.path()].children);
+    FileNodeIndex index;
+    index_file_tree(roots, index);
+    // Parents before children: a path sorts after its ancestors' paths
+    std::vector<std::string> folders;
+    for (const auto& [path, listing] : log.listings)
+    {
+        folders.push_back(path);
+    }
+    std::sort(folders.begin(), folders.end());
+    for (const auto& folder : folders)
+    {
+        [[maybe_unused]] const bool applied = apply_directory_listing(index, log.listings[folder]);
+    }
+    roots[0].is_open = true;
+
+    BENCHMARK("flatten_file_tree (one folder open)")
+    {
+        std::vector<FileTreeRow> rows;
+        flatten_file_tree(roots, rows);
+        return rows.size();
+    };
+}
@@ -0,0 +1,484 @@
+#include "core/WorkspaceSearchService.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace markamp::core;
+
+namespace
+{
+
+namespace fs = std::filesystem;
+
+/// A scratch workspace directory, removed on destruction.
+class TempWorkspace
+{
+public:
+    explicit TempWorkspace(const std::string& name)
+        : root_(fs::temp_directory_path() / ("markamp_ws_search_" + name))
+    {
+        fs::remove_all(root_);
+        fs::create_directories(root_);
+    }
+
+    ~TempWorkspace()
+    {
+        std::error_code error;
+        fs::remove_all(root_, error);
+    }
+
+    TempWorkspace(const TempWorkspace&) = delete;
+    auto operator=(const TempWorkspace&) -> TempWorkspace& = delete;
+
+    auto write(const std::string& relative, const std::string& content) -> std::string
+    {
+        const auto path = root_ / relative;
+        fs::create_directories(path.parent_path());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << content;
+        return path.string();
+    }
+
+    [[nodiscard]] auto path(const std::string& relative) const -> std::string
+    {
+        return (root_ / relative).string();
+    }
+
+    [[nodiscard]] auto root() const -> const fs::path&
+    {
+        return root_;
+    }
+
+    /// FileNode tree of the directory, shaped like FileSystem::scan_directory_to_tree().
+    [[nodiscard]] auto tree() const -> FileNode
+    {
+        return scan(root_);
+    }
+
+private:
+    fs::path root_;
+
+    static auto scan(const fs::path& dir) -> FileNode
+    {
+        FileNode node;
+        node.id = dir.string();
+        node.name = dir.filename().string();
+        node.type = FileNodeType::Folder;
+        for (const auto& entry : fs::directory_iterator(dir))
+        {
+            if (entry.is_directory())
+            {
+                node.children.push_back(scan(entry.path()));
+            }
+            else if (entry.path().extension() == ".md")
+            {
+                FileNode file;
+                file.id = entry.path().string();
+                file.name = entry.path().filename().string();
+                file.type = FileNodeType::File;
+                node.children.push_back(std::move(file));
+            }
+        }
+        return node;
+    }
+};
+
+struct Found
+{
+    std::string path;
+    std::size_t line{0};
+    std::size_t col{0};
+    std::string context;
+};
+
+/// Run a search to completion and collect what it streamed.
+struct SearchRun
+{
+    std::vector<Found> matches;
+    std::optional<std::size_t> total;
+};
+
+auto run_search(WorkspaceSearchService& service,
+                SearchConfig config,
+                std::size_t stop_after = static_cast<std::size_t>(-1)) -> SearchRun
+{
+    SearchRun run;
+    std::mutex mutex;
+    std::condition_variable done_cv;
+    bool done = false;
+    service.search(
+        std::move(config),
+        [&](const std::string& path, std::size_t line, std::size_t col, std::string_view context)
+        {
+            std::lock_guard lock(mutex);
+            run.matches.push_back({path, line, col, std::string(context)});
+            return run.matches.size() < stop_after;
+        },
+        [&](std::size_t total)
+        {
+            std::lock_guard lock(mutex);
+            run.total = total;
+            done = true;
+            done_cv.notify_all();
+        });
+    {
+        std::unique_lock lock(mutex);
+        done_cv.wait_for(lock, std::chrono::seconds(10), [&] { return done; });
+    }
+    service.cancel();
+    std::sort(run.matches.begin(),
+              run.matches.end(),
+              [](const Found& lhs, const Found& rhs)
+              {
+                  return std::tie(lhs.path, lhs.line, lhs.col) <
+                         std::tie(rhs.path, rhs.line, rhs.col);
+              });
+    return run;
+}
+
+auto needle(const std::string& text, bool case_sensitive = true, bool whole_word = false)
+    -> SearchConfig
+{
+    SearchConfig config;
+    config.needle = text;
+    config.case_sensitive = case_sensitive;
+    config.whole_word = whole_word;
+    return config;
+}
+
+} // namespace
+
+// ═══════════════════════════════════════════════════════
+// Index and query
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("WorkspaceSearchService: posting lists narrow the candidate files", "[workspace_search]")
+{
+    TempWorkspace workspace("candidates");
+    const auto alpha = workspace.write("alpha.md", "# Alpha\nThe quick brown fox.\n");
+    const auto beta = workspace.write("docs/beta.md", "Lazy dogs sleep.\nQuick thinking.\n");
+    workspace.write("docs/deep/gamma.md", "Nothing to see here.\n");
+
+    WorkspaceSearchService service(2);
+    REQUIRE(service.index_tree(workspace.tree()) == 3);
+    CHECK(service.file_count() == 3);
+    CHECK(service.trigram_count() > 0);
+
+    CHECK(service.candidate_files(needle("brown fox")) == std::vector<std::string>{alpha});
+    // Trigrams are case-folded, so case-insensitive queries use the index too
+    CHECK(service.candidate_files(needle("QUICK", false)) ==
+          std::vector<std::string>{alpha, beta});
+    CHECK(service.candidate_files(needle("zebra")).empty());
+
+    // Too short for a trigram: every file is a candidate
+    CHECK(service.candidate_files(needle("og")).size() == 3);
+
+    // Re-indexing an unchanged tree reads nothing
+    CHECK(service.index_tree(workspace.tree()) == 0);
+}
+
+TEST_CASE("WorkspaceSearchService: search streams verified matches", "[workspace_search]")
+{
+    TempWorkspace workspace("search");
+    const auto notes = workspace.write("notes.md", "first line\nsecond Target line\ntarget\n");
+    const auto other = workspace.write("sub/other.md", "no match\nTargets everywhere\n");
+    workspace.write("sub/none.md", "nothing relevant\n");
+
+    WorkspaceSearchService service(4);
+    service.index_tree(workspace.tree());
+
+    SECTION("case-sensitive")
+    {
+        const auto run = run_search(service, needle("Target"));
+        REQUIRE(run.total == 2u);
+        REQUIRE(run.matches.size() == 2);
+        CHECK(run.matches[0].path == notes);
+        CHECK(run.matches[0].line == 1);
+        CHECK(run.matches[0].col == 7);
+        CHECK(run.matches[0].context == "second Target line");
+        CHECK(run.matches[1].path == other);
+        CHECK(run.matches[1].line == 1);
+        CHECK(run.matches[1].col == 0);
+    }
+
+    SECTION("case-insensitive")
+    {
+        const auto run = run_search(service, needle("target", false));
+        REQUIRE(run.total == 3u);
+        CHECK(run.matches[1].path == notes);
+        CHECK(run.matches[1].line == 2);
+        CHECK(run.matches[1].context == "target");
+    }
+
+    SECTION("whole word")
+    {
+        const auto run = run_search(service, needle("target", false, true));
+        REQUIRE(run.total == 2u);
+        CHECK(run.matches[0].path == notes);
+        CHECK(run.matches[1].path == notes);
+    }
+
+    SECTION("regex scans every file")
+    {
+        auto config = needle(R"(^[Tt]arget)");
+        config.use_regex = true;
+        CHECK(service.candidate_files(config).size() == 3);
+        const auto run = run_search(service, config);
+        REQUIRE(run.total == 2u);
+        CHECK(run.matches[0].path == notes);
+        CHECK(run.matches[0].line == 2);
+        CHECK(run.matches[1].path == other);
+    }
+
+    SECTION("the callback can stop the search")
+    {
+        const auto run = run_search(service, needle("t", false), 2);
+        CHECK(run.matches.size() == 2);
+    }
+
+    SECTION("no candidates completes with zero matches")
+    {
+        const auto run = run_search(service, needle("absent words"));
+        CHECK(run.total == 0u);
+        CHECK(run.matches.empty());
+    }
+}
+
+// ═══════════════════════════════════════════════════════
+// Incremental updates
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("WorkspaceSearchService: watch events keep the index current", "[workspace_search]")
+{
+    TempWorkspace workspace("updates");
+    const auto doc = workspace.write("doc.md", "original wording\n");
+    const auto keep = workspace.write("keep.md", "stable content\n");
+
+    WorkspaceSearchService service(2);
+    service.index_tree(workspace.tree());
+    REQUIRE(service.candidate_files(needle("original")) == std::vector<std::string>{doc});
+
+    workspace.write("doc.md", "revised wording\n");
+    service.on_file_changed(doc);
+    CHECK(service.candidate_files(needle("original")).empty());
+    CHECK(service.candidate_files(needle("revised")) == std::vector<std::string>{doc});
+    CHECK(service.file_count() == 2);
+
+    const auto added = workspace.write("new/added.md", "revised again\n");
+    service.on_file_changed(added);
+    CHECK(service.candidate_files(needle("revised")) == std::vector<std::string>{doc, added});
+
+    service.on_file_removed(doc);
+    CHECK(service.candidate_files(needle("revised")) == std::vector<std::string>{added});
+    CHECK(service.file_count() == 2);
+
+    // A change event for a deleted file drops it too
+    fs::remove(added);
+    service.on_file_changed(added);
+    CHECK(service.candidate_files(needle("revised")).empty());
+
+    // Many rewrites compact the tombstones without losing live files
+    for (int round = 0; round < 200; ++round)
+    {
+        workspace.write("doc.md", "round " + std::to_string(round) + " text\n");
+        service.on_file_changed(doc);
+    }
+    CHECK(service.file_count() == 2);
+    CHECK(service.candidate_files(needle("round 199")) == std::vector<std::string>{doc});
+    CHECK(service.candidate_files(needle("stable")) == std::vector<std::string>{keep});
+    CHECK(run_search(service, needle("round 198")).total == 0u);
+    CHECK(run_search(service, needle("round 199")).total == 1u);
+}
+
+TEST_CASE("WorkspaceSearchService: index_tree drops files that left the tree", "[workspace_search]")
+{
+    TempWorkspace workspace("tree_sync");
+    workspace.write("a.md", "shared phrase\n");
+    const auto b_path = workspace.write("b.md", "shared phrase\n");
+
+    WorkspaceSearchService service(1);
+    service.index_tree(workspace.tree());
+    REQUIRE(service.candidate_files(needle("shared")).size() == 2);
+
+    fs::remove(workspace.path("a.md"));
+    CHECK(service.index_tree(workspace.tree()) == 0);
+    CHECK(service.candidate_files(needle("shared")) == std::vector<std::string>{b_path});
+}
+
+TEST_CASE("WorkspaceSearchService: track_workspace follows watch changes and saves",
+          "[workspace_search]")
+{
+    TempWorkspace workspace("tracked");
+    TempWorkspace cache("tracked_cache");
+    const auto doc = workspace.write("doc.md", "tracked original\n");
+    workspace.write(".hidden/secret.md", "tracked hidden\n");
+    const auto index_path = cache.root() / "search" / "workspace.idx";
+
+    // Poll the background thread's progress
+    auto eventually = [](const std::function<bool()>& condition)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!condition() && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return condition();
+    };
+
+    {
+        WorkspaceSearchService service(2);
+        service.track_workspace(workspace.root(), index_path);
+        REQUIRE(eventually([&] { return service.file_count() == 1; }));
+        CHECK(service.candidate_files(needle("tracked")) == std::vector<std::string>{doc});
+
+        const auto added = workspace.write("notes/added.md", "tracked addition\n");
+        workspace.write("doc.md", "rewritten\n");
+        service.apply_changes({{FileChangeKind::Created, workspace.path("notes"), {}, true},
+                               {FileChangeKind::Modified, doc, {}, false},
+                               {FileChangeKind::Modified, "/elsewhere/x.md", {}, false}});
+        REQUIRE(eventually([&] { return service.file_count() == 2; }));
+        REQUIRE(eventually([&]
+                           { return service.candidate_files(needle("rewritten")).size() == 1; }));
+        CHECK(service.candidate_files(needle("tracked")) == std::vector<std::string>{added});
+
+        fs::remove_all(workspace.path("notes"));
+        service.apply_changes({{FileChangeKind::Deleted, workspace.path("notes"), {}, true}});
+        REQUIRE(eventually([&] { return service.file_count() == 1; }));
+    } // Saves on destruction
+
+    WorkspaceSearchService restored(1);
+    REQUIRE(restored.load(index_path).has_value());
+    CHECK(restored.file_count() == 1);
+    CHECK(restored.candidate_files(needle("rewritten")) == std::vector<std::string>{doc});
+}
+
+// ═══════════════════════════════════════════════════════
+// Persistence
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("WorkspaceSearchService: the index round-trips through disk", "[workspace_search]")
+{
+    TempWorkspace workspace("persist");
+    const auto one = workspace.write("one.md", "persistent trigram index\n");
+    const auto two = workspace.write("two.md", "another trigram file\n");
+    const auto index_path = workspace.root() / "search.idx";
+
+    {
+        WorkspaceSearchService service(2);
+        service.index_tree(workspace.tree());
+        service.on_file_changed(two); // Leaves a tombstone behind
+        REQUIRE(service.save(index_path).has_value());
+    }
+
+    WorkspaceSearchService restored(2);
+    REQUIRE(restored.load(index_path).has_value());
+    CHECK(restored.file_count() == 2);
+    CHECK(restored.candidate_files(needle("trigram")) == std::vector<std::string>{one, two});
+    CHECK(restored.candidate_files(needle("persistent")) == std::vector<std::string>{one});
+
+    // Only files changed since the save are re-read
+    workspace.write("two.md", "changed while closed\n");
+    fs::last_write_time(two, fs::last_write_time(two) + std::chrono::seconds(5));
+    CHECK(restored.index_tree(workspace.tree()) == 1);
+    CHECK(restored.candidate_files(needle("trigram")) == std::vector<std::string>{one});
+    CHECK(restored.candidate_files(needle("closed")) == std::vector<std::string>{two});
+}
+
+TEST_CASE("WorkspaceSearchService: damaged index files are rejected", "[workspace_search]")
+{
+    TempWorkspace workspace("corrupt");
+    workspace.write("one.md", "some words here\n");
+    const auto index_path = workspace.root() / "search.idx";
+
+    WorkspaceSearchService service(1);
+    service.index_tree(workspace.tree());
+    REQUIRE(service.save(index_path).has_value());
+
+    std::string bytes;
+    {
+        std::ifstream in(index_path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto write_index = [&](const std::string& data)
+    {
+        std::ofstream out(index_path, std::ios::binary | std::ios::trunc);
+        out << data;
+    };
+
+    WorkspaceSearchService loaded(1);
+    CHECK_FALSE(loaded.load(workspace.root() / "missing.idx").has_value());
+
+    write_index(bytes.substr(0, bytes.size() - 3));
+    CHECK_FALSE(loaded.load(index_path).has_value());
+    CHECK(loaded.file_count() == 0);
+
+    write_index("not an index at all");
+    CHECK_FALSE(loaded.load(index_path).has_value());
+
+    write_index(bytes);
+    CHECK(loaded.load(index_path).has_value());
+    CHECK(loaded.file_count() == 1);
+}
+
+// ═══════════════════════════════════════════════════════
+// Benchmark
+// ═══════════════════════════════════════════════════════
+
+TEST_CASE("WorkspaceSearchService: index build and query over 5k files",
+          "[.][benchmark][workspace_search]")
+{
+    TempWorkspace workspace("bench");
+    const std::vector<std::string> words = {"markdown", "preview", "render",  "theme",
+                                            "search",   "index",   "trigram", "editor",
+                                            "sidebar",  "plugin",  "mermaid", "table"};
+    for (int file = 0; file < 5000; ++file)
+    {
+        std::string content = "# Document " + std::to_string(file) + "\n\n";
+        for (int line = 0; line < 60; ++line)
+        {
+            for (int word = 0; word < 10; ++word)
+            {
+                content += words[static_cast<std::size_t>((file * 7 + line * 3 + word) % 12)];
+                content += ' ';
+            }
+            content += '\n';
+        }
+        content += "unique-token-" + std::to_string(file) + "\n";
+        workspace.write("dir" + std::to_string(file % 50) + "/doc" + std::to_string(file) + ".md",
+                        content);
+    }
+    const auto tree = workspace.tree();
+
+    BENCHMARK("index 5k files")
+    {
+        WorkspaceSearchService service;
+        return service.index_tree(tree);
+    };
+
+    WorkspaceSearchService service;
+    service.index_tree(tree);
+
+    BENCHMARK("rare needle (index narrows to 1 file)")
+    {
+        return run_search(service, needle("unique-token-4321")).total;
+    };
+
+    BENCHMARK("common needle (all files verified)")
+    {
+        return run_search(service, needle("trigram index", false)).total;
+    };
+}